@@ -3,8 +3,13 @@
 #include "user_channel/channel_layer.hpp"
 
 #include <arpa/inet.h>
+#include <sys/inotify.h>
+#include <unistd.h>
 
+#include <array>
 #include <boost/process/child.hpp>
+#include <cerrno>
+#include <filesystem>
 #include <fstream>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
@@ -94,6 +99,96 @@ std::pair<std::vector<uint8_t>, std::vector<uint8_t>> getCipherRecords()
     return std::make_pair(cipherRecords, supportedAlgorithmRecords);
 }
 
+namespace
+{
+
+int configWatchFd = -1;
+bool configWatched = false;
+
+/** @brief watches the cipher suite file, which is replaced by a new one
+ *         rather than written in place, so the directory is watched
+ */
+void watchConfigFile()
+{
+    configWatched = true;
+    configWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (configWatchFd < 0)
+    {
+        log<level::ERR>("Failed to create cipher suites inotify instance",
+                        entry("ERRNO=%d", errno));
+        return;
+    }
+    std::string dir = std::filesystem::path(configFile).parent_path();
+    if (inotify_add_watch(configWatchFd, dir.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0)
+    {
+        log<level::ERR>("Failed to watch channel cipher suites file",
+                        entry("DIR=%s", dir.c_str()), entry("ERRNO=%d", errno));
+        close(configWatchFd);
+        configWatchFd = -1;
+    }
+}
+
+/** @brief checks the pending events for a change of the cipher suite file
+ *
+ *  @return true if the file changed; without a watch the records read
+ *          first are kept, as the file only changes with the firmware
+ */
+bool configFileChanged()
+{
+    if (configWatchFd < 0)
+    {
+        return false;
+    }
+    std::string fileName = std::filesystem::path(configFile).filename();
+    bool changed = false;
+    alignas(inotify_event) std::array<char, 1024> events;
+    ssize_t size;
+    while ((size = read(configWatchFd, events.data(), events.size())) > 0)
+    {
+        for (ssize_t pos = 0; pos < size;)
+        {
+            auto event =
+                reinterpret_cast<const inotify_event*>(events.data() + pos);
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len && fileName == event->name))
+            {
+                changed = true;
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+} // namespace
+
+/** @brief Get the supported Cipher records, parsed from the JSON file once
+ *         and again only after the file changed
+ *
+ * @return pair of vector containing 1. all the cipher suite records. 2.
+ * Algorithms supported
+ */
+const std::pair<std::vector<uint8_t>, std::vector<uint8_t>>&
+    getCachedCipherRecords()
+{
+    static std::pair<std::vector<uint8_t>, std::vector<uint8_t>> records;
+    static bool recordInit = false;
+
+    if (!configWatched)
+    {
+        // watch before the first read so no change can be missed
+        watchConfigFile();
+    }
+    if (configFileChanged() || !recordInit)
+    {
+        recordInit = false;
+        records = getCipherRecords();
+        recordInit = true;
+    }
+    return records;
+}
+
 } // namespace cipher
 
 /** @brief this command is used to look up what authentication, integrity,
@@ -117,10 +212,6 @@ ipmi::RspType<uint8_t,             // Channel Number
                            uint6_t listIndex, uint1_t reserved2,
                            uint1_t algoSelectBit)
 {
-    static std::vector<uint8_t> cipherRecords;
-    static std::vector<uint8_t> supportedAlgorithms;
-    static auto recordInit = false;
-
     uint8_t rspChannel = ipmi::convertCurrentChannelNum(
         static_cast<uint8_t>(channelNumber), ctx->channel);
 
@@ -135,22 +226,18 @@ ipmi::RspType<uint8_t,             // Channel Number
         return ipmi::response(ccPayloadTypeNotSupported);
     }
 
-    if (!recordInit)
+    const std::pair<std::vector<uint8_t>, std::vector<uint8_t>>* cached;
+    try
     {
-        try
-        {
-            std::tie(cipherRecords, supportedAlgorithms) =
-                cipher::getCipherRecords();
-            recordInit = true;
-        }
-        catch (const std::exception& e)
-        {
-            return ipmi::responseUnspecifiedError();
-        }
+        cached = &cipher::getCachedCipherRecords();
+    }
+    catch (const std::exception& e)
+    {
+        return ipmi::responseUnspecifiedError();
     }
 
     const std::vector<uint8_t>& records =
-        algoSelectBit ? cipherRecords : supportedAlgorithms;
+        algoSelectBit ? cached->first : cached->second;
     static constexpr auto respSize = 16;
 
     // Session support is available in active LAN channels.
@@ -9,13 +9,10 @@
 #include <ipmid/api.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
-#include <phosphor-logging/log.hpp>
 #include <string>
 #include <xyz/openbmc_project/Common/error.hpp>
 
 using phosphor::logging::commit;
-using phosphor::logging::level;
-using phosphor::logging::log;
 using sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
 
 static bool lastCallSuccessful = false;
@@ -39,43 +36,35 @@ void reportError()
     commit<InternalFailure>();
 }
 
-ipmi::RspType<> ipmiAppResetWatchdogTimer()
+ipmi::RspType<> ipmiAppResetWatchdogTimer(ipmi::Context::ptr ctx)
 {
-    try
-    {
-        WatchdogService wd_service;
-
-        // Notify the caller if we haven't initialized our timer yet
-        // so it can configure actions and timeouts
-        if (!wd_service.getInitialized())
-        {
-            lastCallSuccessful = true;
-
-            constexpr uint8_t ccWatchdogNotInit = 0x80;
-            return ipmi::response(ccWatchdogNotInit);
-        }
-
-        // The ipmi standard dictates we enable the watchdog during reset
-        wd_service.resetTimeRemaining(true);
-        lastCallSuccessful = true;
-        return ipmi::responseSuccess();
-    }
-    catch (const InternalFailure& e)
+    // This is the host heartbeat, it is answered from the resident mirror of
+    // the watchdog properties and costs a single asynchronous method call
+    bool initialized = false;
+    if (WatchdogService::getInitialized(ctx, initialized))
     {
         reportError();
         return ipmi::responseUnspecifiedError();
     }
-    catch (const std::exception& e)
+
+    // Notify the caller if we haven't initialized our timer yet
+    // so it can configure actions and timeouts
+    if (!initialized)
     {
-        const std::string e_str = std::string("wd_reset: ") + e.what();
-        log<level::ERR>(e_str.c_str());
-        return ipmi::responseUnspecifiedError();
+        lastCallSuccessful = true;
+
+        constexpr uint8_t ccWatchdogNotInit = 0x80;
+        return ipmi::response(ccWatchdogNotInit);
     }
-    catch (...)
+
+    // The ipmi standard dictates we enable the watchdog during reset
+    if (WatchdogService::resetTimeRemaining(ctx, true))
     {
-        log<level::ERR>("wd_reset: Unknown Error");
+        reportError();
         return ipmi::responseUnspecifiedError();
     }
+    lastCallSuccessful = true;
+    return ipmi::responseSuccess();
 }
 
 static constexpr uint8_t wd_dont_stop = 0x1 << 6;
@@ -182,6 +171,7 @@ static constexpr uint8_t wdExpirationFlagReservedBit7 = 0x7;
 /**@brief The Set Watchdog Timer ipmi command.
  *
  * @param
+ * - ctx
  * - timerUse
  * - dontStopTimer
  * - dontLog
@@ -193,8 +183,9 @@ static constexpr uint8_t wdExpirationFlagReservedBit7 = 0x7;
  * @return completion code on success.
  **/
 ipmi::RspType<>
-    ipmiSetWatchdogTimer(uint3_t timerUse, uint3_t reserved, bool dontStopTimer,
-                         bool dontLog, uint3_t timeoutAction, uint1_t reserved1,
+    ipmiSetWatchdogTimer(ipmi::Context::ptr ctx, uint3_t timerUse,
+                         uint3_t reserved, bool dontStopTimer, bool dontLog,
+                         uint3_t timeoutAction, uint1_t reserved1,
                          uint3_t preTimeoutInterrupt, uint1_t reserved2,
                          uint8_t preTimeoutInterval,
                          std::bitset<8> expFlagValue, uint16_t initialCountdown)
@@ -217,61 +208,42 @@ ipmi::RspType<>
         return ipmi::responseInvalidFieldRequest();
     }
 
-    timerNotLogFlags = dontLog;
-    timerPreTimeoutInterrupt = preTimeoutInterrupt;
-
+    WatchdogService::Settings settings;
     try
     {
-        WatchdogService wd_service;
         // Stop the timer if the don't stop bit is not set
-        if (!(dontStopTimer))
-        {
-            wd_service.setEnabled(false);
-        }
+        settings.stop = !dontStopTimer;
 
         // Set the action based on the request
         const auto ipmi_action = static_cast<IpmiAction>(
             static_cast<uint8_t>(timeoutAction) & wd_timeout_action_mask);
-        wd_service.setExpireAction(ipmiActionToWdAction(ipmi_action));
+        settings.expireAction = ipmiActionToWdAction(ipmi_action);
 
         const auto ipmiTimerUse = types::enum_cast<IpmiTimerUse>(timerUse);
-        wd_service.setTimerUse(ipmiTimerUseToWdTimerUse(ipmiTimerUse));
-
-        wd_service.setExpiredTimerUse(WatchdogService::TimerUse::Reserved);
-
-        timerUseExpirationFlags &= ~expFlagValue;
-
-        // Set the new interval and the time remaining deci -> mill seconds
-        const uint64_t interval = initialCountdown * 100;
-        wd_service.setInterval(interval);
-        wd_service.resetTimeRemaining(false);
-
-        // Mark as initialized so that future resets behave correctly
-        wd_service.setInitialized(true);
-
-        lastCallSuccessful = true;
-        return ipmi::responseSuccess();
+        settings.timerUse = ipmiTimerUseToWdTimerUse(ipmiTimerUse);
     }
     catch (const std::domain_error&)
     {
         return ipmi::responseInvalidFieldRequest();
     }
-    catch (const InternalFailure& e)
+
+    // Set the new interval and the time remaining deci -> mill seconds
+    settings.interval = initialCountdown * 100;
+
+    timerNotLogFlags = dontLog;
+    timerPreTimeoutInterrupt = preTimeoutInterrupt;
+
+    // The whole configuration is applied in one batch of calls
+    if (WatchdogService::setTimer(ctx, settings))
     {
         reportError();
         return ipmi::responseUnspecifiedError();
     }
-    catch (const std::exception& e)
-    {
-        const std::string e_str = std::string("wd_set: ") + e.what();
-        log<level::ERR>(e_str.c_str());
-        return ipmi::responseUnspecifiedError();
-    }
-    catch (...)
-    {
-        log<level::ERR>("wd_set: Unknown Error");
-        return ipmi::responseUnspecifiedError();
-    }
+
+    timerUseExpirationFlags &= ~expFlagValue;
+
+    lastCallSuccessful = true;
+    return ipmi::responseSuccess();
 }
 
 /** @brief Converts a DBUS Watchdog Action to IPMI defined action
@@ -371,71 +343,54 @@ ipmi::RspType<uint3_t, // timerUse - timer use
               uint16_t,       // initial Countdown - Little Endian (deciseconds)
               uint16_t        // present Countdown - Little Endian (deciseconds)
               >
-    ipmiGetWatchdogTimer()
+    ipmiGetWatchdogTimer(ipmi::Context::ptr ctx)
 {
     uint16_t presentCountdown = 0;
     uint8_t pretimeout = 0;
 
-    try
+    WatchdogService::Properties wd_prop;
+    if (WatchdogService::getProperties(ctx, wd_prop))
     {
-        WatchdogService wd_service;
-        WatchdogService::Properties wd_prop = wd_service.getProperties();
+        reportError();
+        return ipmi::responseUnspecifiedError();
+    }
 
-        // Build and return the response
-        // Interval and timeRemaining need converted from milli -> deci seconds
-        uint16_t initialCountdown = htole16(wd_prop.interval / 100);
+    // Build and return the response
+    // Interval and timeRemaining need converted from milli -> deci seconds
+    uint16_t initialCountdown = htole16(wd_prop.interval / 100);
 
-        if (wd_prop.expiredTimerUse != WatchdogService::TimerUse::Reserved)
-        {
-            timerUseExpirationFlags.set(static_cast<uint8_t>(
-                wdTimerUseToIpmiTimerUse(wd_prop.expiredTimerUse)));
-        }
+    if (wd_prop.expiredTimerUse != WatchdogService::TimerUse::Reserved)
+    {
+        timerUseExpirationFlags.set(static_cast<uint8_t>(
+            wdTimerUseToIpmiTimerUse(wd_prop.expiredTimerUse)));
+    }
 
-        if (wd_prop.enabled)
+    if (wd_prop.enabled)
+    {
+        presentCountdown = htole16(wd_prop.timeRemaining / 100);
+    }
+    else
+    {
+        if (wd_prop.expiredTimerUse == WatchdogService::TimerUse::Reserved)
         {
-            presentCountdown = htole16(wd_prop.timeRemaining / 100);
+            presentCountdown = initialCountdown;
         }
         else
         {
-            if (wd_prop.expiredTimerUse == WatchdogService::TimerUse::Reserved)
-            {
-                presentCountdown = initialCountdown;
-            }
-            else
-            {
-                presentCountdown = 0;
-                // Automatically clear it whenever a timer expiration occurs.
-                timerNotLogFlags = false;
-            }
+            presentCountdown = 0;
+            // Automatically clear it whenever a timer expiration occurs.
+            timerNotLogFlags = false;
         }
+    }
 
-        // TODO: Do something about having pretimeout support
-        pretimeout = 0;
+    // TODO: Do something about having pretimeout support
+    pretimeout = 0;
 
-        lastCallSuccessful = true;
-        return ipmi::responseSuccess(
-            types::enum_cast<uint3_t>(
-                wdTimerUseToIpmiTimerUse(wd_prop.timerUse)),
-            0, wd_prop.enabled, timerNotLogFlags,
-            types::enum_cast<uint3_t>(
-                wdActionToIpmiAction(wd_prop.expireAction)),
-            0, timerPreTimeoutInterrupt, 0, pretimeout, timerUseExpirationFlags,
-            initialCountdown, presentCountdown);
-    }
-    catch (const InternalFailure& e)
-    {
-        reportError();
-        return ipmi::responseUnspecifiedError();
-    }
-    catch (const std::exception& e)
-    {
-        const std::string e_str = std::string("wd_get: ") + e.what();
-        log<level::ERR>(e_str.c_str());
-        return ipmi::responseUnspecifiedError();
-    }
-    catch (...)
-    {
-        log<level::ERR>("wd_get: Unknown Error");
-        return ipmi::responseUnspecifiedError();
-    }
+    lastCallSuccessful = true;
+    return ipmi::responseSuccess(
+        types::enum_cast<uint3_t>(wdTimerUseToIpmiTimerUse(wd_prop.timerUse)),
+        0, wd_prop.enabled, timerNotLogFlags,
+        types::enum_cast<uint3_t>(wdActionToIpmiAction(wd_prop.expireAction)),
+        0, timerPreTimeoutInterrupt, 0, pretimeout, timerUseExpirationFlags,
+        initialCountdown, presentCountdown);
 }
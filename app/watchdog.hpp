@@ -3,12 +3,15 @@
 #include <ipmid/api.hpp>
 
 /** @brief The RESET watchdog IPMI command.
+ *
+ *  @param[in] ctx - ipmi context of the request
  */
-ipmi::RspType<> ipmiAppResetWatchdogTimer();
+ipmi::RspType<> ipmiAppResetWatchdogTimer(ipmi::Context::ptr ctx);
 
 /**@brief The setWatchdogTimer ipmi command.
  *
  * @param
+ * - ctx
  * - timerUse
  * - dontStopTimer
  * - dontLog
@@ -20,12 +23,14 @@ ipmi::RspType<> ipmiAppResetWatchdogTimer();
  * @return completion code on success.
  **/
 ipmi::RspType<> ipmiSetWatchdogTimer(
-    uint3_t timerUse, uint3_t reserved, bool dontStopTimer, bool dontLog,
-    uint3_t timeoutAction, uint1_t reserved1, uint3_t preTimeoutInterrupt,
-    uint1_t reserved2, uint8_t preTimeoutInterval, std::bitset<8> expFlagValue,
-    uint16_t initialCountdown);
+    ipmi::Context::ptr ctx, uint3_t timerUse, uint3_t reserved,
+    bool dontStopTimer, bool dontLog, uint3_t timeoutAction, uint1_t reserved1,
+    uint3_t preTimeoutInterrupt, uint1_t reserved2, uint8_t preTimeoutInterval,
+    std::bitset<8> expFlagValue, uint16_t initialCountdown);
 
 /**@brief The getWatchdogTimer ipmi command.
+ *
+ * @param[in] ctx - ipmi context of the request
  *
  * @return
  * - timerUse
@@ -42,4 +47,4 @@ ipmi::RspType<uint3_t, uint3_t, bool, bool,       // timerUse
               uint16_t, // initial Countdown - Little Endian (deciseconds)
               uint16_t  // present Countdown - Little Endian (deciseconds)
               >
-    ipmiGetWatchdogTimer();
+    ipmiGetWatchdogTimer(ipmi::Context::ptr ctx);
@@ -1,22 +1,20 @@
 #include "watchdog_service.hpp"
 
+#include <boost/asio/steady_timer.hpp>
 #include <exception>
 #include <ipmid/api.hpp>
-#include <phosphor-logging/elog-errors.hpp>
-#include <phosphor-logging/elog.hpp>
+#include <memory>
 #include <phosphor-logging/log.hpp>
-#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/message.hpp>
-#include <stdexcept>
 #include <string>
-#include <xyz/openbmc_project/Common/error.hpp>
+#include <utility>
+#include <vector>
 #include <xyz/openbmc_project/State/Watchdog/server.hpp>
 
-using phosphor::logging::elog;
 using phosphor::logging::entry;
 using phosphor::logging::level;
 using phosphor::logging::log;
-using sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
 using sdbusplus::xyz::openbmc_project::State::server::convertForMessage;
 using sdbusplus::xyz::openbmc_project::State::server::Watchdog;
 
@@ -24,177 +22,296 @@ static constexpr char wd_path[] = "/xyz/openbmc_project/watchdog/host0";
 static constexpr char wd_intf[] = "xyz.openbmc_project.State.Watchdog";
 static constexpr char prop_intf[] = "org.freedesktop.DBus.Properties";
 
-ipmi::ServiceCache WatchdogService::wd_service(wd_intf, wd_path);
+namespace
+{
 
-WatchdogService::WatchdogService() : bus(ipmid_get_sd_bus_connection())
+/** @brief resident copy of the host watchdog properties
+ *
+ *  Host agents send Reset Watchdog Timer as a heartbeat, so its check of
+ *  the Initialized property is answered from this copy instead of a D-Bus
+ *  Get. The copy is read with one GetAll on first use and kept current by
+ *  PropertiesChanged, it is dropped when the watchdog service goes away.
+ *  TimeRemaining is not signalled, Get Watchdog Timer still reads it live
+ *  and refreshes the copy with the same reply.
+ */
+struct Mirror
 {
-}
+    std::string service;
+    ipmi::PropertyMap properties;
+    std::unique_ptr<sdbusplus::bus::match_t> changedMatch;
+    std::unique_ptr<sdbusplus::bus::match_t> ownerMatch;
+};
+
+Mirror mirror;
 
-void WatchdogService::resetTimeRemaining(bool enableWatchdog)
+void dropMirror()
 {
-    bool wasValid = wd_service.isValid(bus);
-    auto request = wd_service.newMethodCall(bus, wd_intf, "ResetTimeRemaining");
-    request.append(enableWatchdog);
-    auto response = bus.call(request);
-    if (response.is_method_error())
-    {
-        wd_service.invalidate();
-        if (wasValid)
+    mirror.service.clear();
+    mirror.properties.clear();
+    // a match can't be destroyed from its own callback
+    post_work([]() {
+        if (mirror.service.empty())
         {
-            // Retry the request once in case the cached service was stale
-            return resetTimeRemaining(enableWatchdog);
+            mirror.ownerMatch.reset();
         }
-        log<level::ERR>(
-            "WatchdogService: Method error resetting time remaining",
-            entry("ENABLE_WATCHDOG=%d", !!enableWatchdog));
-        elog<InternalFailure>();
+    });
+}
+
+void updateMirror(const std::string& key, ipmi::Value&& value)
+{
+    if (!mirror.service.empty())
+    {
+        mirror.properties[key] = std::move(value);
     }
 }
 
-WatchdogService::Properties WatchdogService::getProperties()
+boost::system::error_code loadMirror(ipmi::Context::ptr ctx)
 {
-    bool wasValid = wd_service.isValid(bus);
-    auto request = wd_service.newMethodCall(bus, prop_intf, "GetAll");
-    request.append(wd_intf);
-    auto response = bus.call(request);
-    if (response.is_method_error())
-    {
-        wd_service.invalidate();
-        if (wasValid)
-        {
-            // Retry the request once in case the cached service was stale
-            return getProperties();
-        }
-        log<level::ERR>("WatchdogService: Method error getting properties");
-        elog<InternalFailure>();
+    if (!mirror.service.empty())
+    {
+        return {};
     }
-    try
+    if (!mirror.changedMatch)
     {
-        std::map<std::string, std::variant<bool, uint64_t, std::string>>
-            properties;
-        response.read(properties);
-        Properties wd_prop;
-        wd_prop.initialized = std::get<bool>(properties.at("Initialized"));
-        wd_prop.enabled = std::get<bool>(properties.at("Enabled"));
-        wd_prop.expireAction = Watchdog::convertActionFromString(
-            std::get<std::string>(properties.at("ExpireAction")));
-        wd_prop.timerUse = Watchdog::convertTimerUseFromString(
-            std::get<std::string>(properties.at("CurrentTimerUse")));
-        wd_prop.expiredTimerUse = Watchdog::convertTimerUseFromString(
-            std::get<std::string>(properties.at("ExpiredTimerUse")));
+        mirror.changedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            *getSdBus(),
+            sdbusplus::bus::match::rules::propertiesChanged(wd_path, wd_intf),
+            [](sdbusplus::message::message& msg) {
+                std::string interface;
+                ipmi::PropertyMap changed;
+                try
+                {
+                    msg.read(interface, changed);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                for (auto& [name, value] : changed)
+                {
+                    updateMirror(name, std::move(value));
+                }
+            });
+    }
 
-        wd_prop.interval = std::get<uint64_t>(properties.at("Interval"));
-        wd_prop.timeRemaining =
-            std::get<uint64_t>(properties.at("TimeRemaining"));
-        return wd_prop;
+    std::string service;
+    ipmi::PropertyMap properties;
+    boost::system::error_code ec =
+        ipmi::getService(ctx, wd_intf, wd_path, service);
+    if (!ec)
+    {
+        ec = ipmi::getAllDbusProperties(ctx, service, wd_path, wd_intf,
+                                        properties);
     }
-    catch (const std::exception& e)
+    if (ec)
     {
-        log<level::ERR>("WatchdogService: Decode error in get properties",
-                        entry("ERROR=%s", e.what()),
-                        entry("REPLY_SIG=%s", response.get_signature()));
-        elog<InternalFailure>();
+        log<level::ERR>("WatchdogService: Failed to read properties",
+                        entry("ERROR=%s", ec.message().c_str()));
+        return ec;
     }
-
-    // Needed instead of elog<InternalFailure>() since the compiler can't
-    // deduce the that elog<>() always throws
-    throw std::runtime_error(
-        "WatchdogService: Should not reach end of getProperties");
+    mirror.service = std::move(service);
+    mirror.properties = std::move(properties);
+    mirror.ownerMatch = std::make_unique<sdbusplus::bus::match_t>(
+        *getSdBus(),
+        sdbusplus::bus::match::rules::nameOwnerChanged(mirror.service),
+        [](sdbusplus::message::message&) { dropMirror(); });
+    return {};
 }
 
-template <typename T>
-T WatchdogService::getProperty(const std::string& key)
+/** @brief a call of a batch sent to the watchdog service, a property Set
+ *         or ResetTimeRemaining when the property name is empty
+ */
+using BatchCall = std::pair<std::string, ipmi::Value>;
+
+/** @brief sends the calls at once and waits for all the replies
+ *
+ *  The calls leave on the same connection in order and phosphor-watchdog
+ *  handles them in that order, so the batch costs one round trip and no
+ *  other request to the watchdog is handled in between.
+ *
+ *  @return the first error of the batch
+ */
+boost::system::error_code sendBatch(ipmi::Context::ptr ctx,
+                                    const std::vector<BatchCall>& calls)
 {
-    bool wasValid = wd_service.isValid(bus);
-    auto request = wd_service.newMethodCall(bus, prop_intf, "Get");
-    request.append(wd_intf, key);
-    auto response = bus.call(request);
-    if (response.is_method_error())
-    {
-        wd_service.invalidate();
-        if (wasValid)
+    boost::system::error_code ec = loadMirror(ctx);
+    if (ec)
+    {
+        return ec;
+    }
+    boost::asio::steady_timer done(
+        *getIoContext(), boost::asio::steady_timer::time_point::max());
+    size_t pending = calls.size();
+    for (const auto& [property, value] : calls)
+    {
+        auto reply = [&ec, &pending,
+                      &done](const boost::system::error_code& e) {
+            if (e && !ec)
+            {
+                ec = e;
+            }
+            if (--pending == 0)
+            {
+                done.cancel();
+            }
+        };
+        if (property.empty())
         {
-            // Retry the request once in case the cached service was stale
-            return getProperty<T>(key);
+            ctx->bus->async_method_call(std::move(reply), mirror.service,
+                                        wd_path, wd_intf, "ResetTimeRemaining",
+                                        std::get<bool>(value));
+        }
+        else
+        {
+            ctx->bus->async_method_call(std::move(reply), mirror.service,
+                                        wd_path, prop_intf, "Set", wd_intf,
+                                        property, value);
         }
-        log<level::ERR>("WatchdogService: Method error getting property",
-                        entry("PROPERTY=%s", key.c_str()));
-        elog<InternalFailure>();
     }
-    try
+    if (pending)
     {
-        std::variant<T> value;
-        response.read(value);
-        return std::get<T>(value);
+        boost::system::error_code waitEc;
+        done.async_wait(ctx->yield[waitEc]);
     }
-    catch (const std::exception& e)
+    if (ec)
     {
-        log<level::ERR>("WatchdogService: Decode error in get property",
-                        entry("PROPERTY=%s", key.c_str()),
-                        entry("ERROR=%s", e.what()),
-                        entry("REPLY_SIG=%s", response.get_signature()));
-        elog<InternalFailure>();
+        return ec;
     }
-
-    // Needed instead of elog<InternalFailure>() since the compiler can't
-    // deduce the that elog<>() always throws
-    throw std::runtime_error(
-        "WatchdogService: Should not reach end of getProperty");
-}
-
-template <typename T>
-void WatchdogService::setProperty(const std::string& key, const T& val)
-{
-    bool wasValid = wd_service.isValid(bus);
-    auto request = wd_service.newMethodCall(bus, prop_intf, "Set");
-    request.append(wd_intf, key, std::variant<T>(val));
-    auto response = bus.call(request);
-    if (response.is_method_error())
-    {
-        wd_service.invalidate();
-        if (wasValid)
+    // a request that follows can be handled before the signals arrive
+    for (const auto& [property, value] : calls)
+    {
+        if (!property.empty())
         {
-            // Retry the request once in case the cached service was stale
-            setProperty(key, val);
-            return;
+            updateMirror(property, ipmi::Value(value));
         }
-        log<level::ERR>("WatchdogService: Method error setting property",
-                        entry("PROPERTY=%s", key.c_str()));
-        elog<InternalFailure>();
     }
+    return {};
 }
 
-bool WatchdogService::getInitialized()
+/** @brief sends a batch, once more if it failed since the service may have
+ *         been replaced before its signal was seen
+ */
+boost::system::error_code sendBatchRetry(ipmi::Context::ptr ctx,
+                                         const std::vector<BatchCall>& calls)
 {
-    return getProperty<bool>("Initialized");
+    boost::system::error_code ec = sendBatch(ctx, calls);
+    if (ec)
+    {
+        dropMirror();
+        ec = sendBatch(ctx, calls);
+    }
+    return ec;
 }
 
-void WatchdogService::setInitialized(bool initialized)
-{
-    setProperty("Initialized", initialized);
-}
+} // namespace
 
-void WatchdogService::setEnabled(bool enabled)
+boost::system::error_code
+    WatchdogService::resetTimeRemaining(ipmi::Context::ptr ctx,
+                                        bool enableWatchdog)
 {
-    setProperty("Enabled", enabled);
+    boost::system::error_code ec =
+        sendBatchRetry(ctx, {{"", enableWatchdog}});
+    if (ec)
+    {
+        log<level::ERR>(
+            "WatchdogService: Method error resetting time remaining",
+            entry("ENABLE_WATCHDOG=%d", !!enableWatchdog),
+            entry("ERROR=%s", ec.message().c_str()));
+    }
+    return ec;
 }
 
-void WatchdogService::setExpireAction(Action expireAction)
+boost::system::error_code
+    WatchdogService::setTimer(ipmi::Context::ptr ctx, const Settings& settings)
 {
-    setProperty("ExpireAction", convertForMessage(expireAction));
-}
+    std::vector<BatchCall> calls;
+    if (settings.stop)
+    {
+        calls.emplace_back("Enabled", false);
+    }
+    calls.emplace_back("ExpireAction",
+                       convertForMessage(settings.expireAction));
+    calls.emplace_back("CurrentTimerUse", convertForMessage(settings.timerUse));
+    calls.emplace_back("ExpiredTimerUse",
+                       convertForMessage(TimerUse::Reserved));
+    calls.emplace_back("Interval", settings.interval);
+    calls.emplace_back("", false);
+    // Mark as initialized so that future resets behave correctly
+    calls.emplace_back("Initialized", true);
 
-void WatchdogService::setTimerUse(TimerUse timerUse)
-{
-    setProperty("CurrentTimerUse", convertForMessage(timerUse));
+    boost::system::error_code ec = sendBatchRetry(ctx, calls);
+    if (ec)
+    {
+        log<level::ERR>("WatchdogService: Method error setting timer",
+                        entry("ERROR=%s", ec.message().c_str()));
+    }
+    return ec;
 }
 
-void WatchdogService::setExpiredTimerUse(TimerUse timerUse)
+boost::system::error_code
+    WatchdogService::getProperties(ipmi::Context::ptr ctx,
+                                   Properties& wd_prop)
 {
-    setProperty("ExpiredTimerUse", convertForMessage(timerUse));
+    boost::system::error_code ec = loadMirror(ctx);
+    ipmi::PropertyMap properties;
+    if (!ec)
+    {
+        ec = ipmi::getAllDbusProperties(ctx, mirror.service, wd_path, wd_intf,
+                                        properties);
+    }
+    if (ec)
+    {
+        dropMirror();
+        log<level::ERR>("WatchdogService: Method error getting properties",
+                        entry("ERROR=%s", ec.message().c_str()));
+        return ec;
+    }
+    try
+    {
+        wd_prop.initialized = std::get<bool>(properties.at("Initialized"));
+        wd_prop.enabled = std::get<bool>(properties.at("Enabled"));
+        wd_prop.expireAction = Watchdog::convertActionFromString(
+            std::get<std::string>(properties.at("ExpireAction")));
+        wd_prop.timerUse = Watchdog::convertTimerUseFromString(
+            std::get<std::string>(properties.at("CurrentTimerUse")));
+        wd_prop.expiredTimerUse = Watchdog::convertTimerUseFromString(
+            std::get<std::string>(properties.at("ExpiredTimerUse")));
+
+        wd_prop.interval = std::get<uint64_t>(properties.at("Interval"));
+        wd_prop.timeRemaining =
+            std::get<uint64_t>(properties.at("TimeRemaining"));
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("WatchdogService: Decode error in get properties",
+                        entry("ERROR=%s", e.what()));
+        return boost::system::errc::make_error_code(
+            boost::system::errc::bad_message);
+    }
+    mirror.properties = std::move(properties);
+    return {};
 }
 
-void WatchdogService::setInterval(uint64_t interval)
+boost::system::error_code
+    WatchdogService::getInitialized(ipmi::Context::ptr ctx, bool& initialized)
 {
-    setProperty("Interval", interval);
+    boost::system::error_code ec = loadMirror(ctx);
+    if (ec)
+    {
+        return ec;
+    }
+    const bool* value = nullptr;
+    auto it = mirror.properties.find("Initialized");
+    if (it != mirror.properties.end())
+    {
+        value = std::get_if<bool>(&it->second);
+    }
+    if (value == nullptr)
+    {
+        log<level::ERR>("WatchdogService: Initialized property missing");
+        return boost::system::errc::make_error_code(
+            boost::system::errc::no_message);
+    }
+    initialized = *value;
+    return {};
 }
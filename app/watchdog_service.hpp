@@ -1,30 +1,33 @@
 #pragma once
 #include <ipmid/utils.hpp>
-#include <sdbusplus/bus.hpp>
 #include <xyz/openbmc_project/State/Watchdog/server.hpp>
 
 /** @class WatchdogService
  *  @brief Access to the running OpenBMC watchdog implementation.
  *  @details Easy accessor for servers that implement the
- *  xyz.openbmc_project.State.Watchdog DBus API.
+ *  xyz.openbmc_project.State.Watchdog DBus API. The calls are made from the
+ *  coroutine of an IPMI request, which yields while they are in flight.
  */
 class WatchdogService
 {
   public:
-    WatchdogService();
-
     using Action =
         sdbusplus::xyz::openbmc_project::State::server::Watchdog::Action;
     using TimerUse =
         sdbusplus::xyz::openbmc_project::State::server::Watchdog::TimerUse;
 
-    /** @brief Resets the time remaining on the watchdog.
-     *         Equivalent to setTimeRemaining(getInterval()).
+    /** @brief Resets the time remaining on the watchdog with a single
+     *         asynchronous call to the service known from the resident
+     *         mirror of the watchdog properties.
      *         Optionally enables the watchdog.
      *
+     *  @param[in] ctx - ipmi context of the request
      *  @param[in] enableWatchdog - Should the call also enable the watchdog
+     *
+     *  @return error code of the call
      */
-    void resetTimeRemaining(bool enableWatchdog);
+    static boost::system::error_code resetTimeRemaining(ipmi::Context::ptr ctx,
+                                                        bool enableWatchdog);
 
     /** @brief Contains a copy of the properties enumerated by the
      *         watchdog service.
@@ -41,76 +44,50 @@ class WatchdogService
     };
 
     /** @brief Retrieves a copy of the currently set properties on the
-     *         host watchdog
+     *         host watchdog with one GetAll
      *
-     *  @return A populated WatchdogProperties struct
-     */
-    Properties getProperties();
-
-    /** @brief Get the value of the initialized property on the host
-     *         watchdog
+     *  @param[in] ctx - ipmi context of the request
+     *  @param[out] wd_prop - A populated WatchdogProperties struct
      *
-     *  @return The value of the property
+     *  @return error code of the call
      */
-    bool getInitialized();
+    static boost::system::error_code getProperties(ipmi::Context::ptr ctx,
+                                                   Properties& wd_prop);
 
-    /** @brief Sets the value of the initialized property on the host
-     *         watchdog
+    /** @brief Get the value of the initialized property from the resident
+     *         mirror of the host watchdog properties. The mirror is read
+     *         once and then kept current by PropertiesChanged.
      *
-     *  @param[in] initialized - The new initializedvalue
-     */
-    void setInitialized(bool initialized);
-
-    /** @brief Sets the value of the enabled property on the host watchdog
+     *  @param[in] ctx - ipmi context, used when the mirror is loaded
+     *  @param[out] initialized - The value of the property
      *
-     *  @param[in] enabled - The new enabled value
+     *  @return error code, set if the mirror could not be loaded
      */
-    void setEnabled(bool enabled);
+    static boost::system::error_code getInitialized(ipmi::Context::ptr ctx,
+                                                    bool& initialized);
 
-    /** @brief Sets the value of the expireAction property on the host watchdog
-     *
-     *  @param[in] expireAction - The new expireAction value
-     */
-    void setExpireAction(Action expireAction);
-
-    /** @brief Sets the value of the timerUse property on the host watchdog
-     *
-     *  @param[in] timerUse - The new timerUse value
-     */
-    void setTimerUse(TimerUse timerUse);
-
-    /** @brief Sets the value of the ExpiredTimerUse property on the host
-     * watchdog
-     *
-     *  @param[in] timerUse - The new timerUse value
-     */
-    void setExpiredTimerUse(TimerUse timerUse);
+    /** @brief The timer configuration written by Set Watchdog Timer */
+    struct Settings
+    {
+        bool stop;           //!< disable the watchdog before configuring it
+        Action expireAction; //!< the action taken at expiration
+        TimerUse timerUse;   //!< the new timer use
+        uint64_t interval;   //!< the new interval in milliseconds
+    };
 
-    /** @brief Sets the value of the interval property on the host watchdog
+    /** @brief Configures the host watchdog in a single batch
      *
-     *  @param[in] interval - The new interval value
-     */
-    void setInterval(uint64_t interval);
-
-  private:
-    /** @brief sdbusplus handle */
-    sdbusplus::bus::bus bus;
-    /** @brief The name of the mapped host watchdog service */
-    static ipmi::ServiceCache wd_service;
-
-    /** @brief Gets the value of the property on the host watchdog
+     *  The watchdog is optionally stopped, then the expire action, the
+     *  timer use and the interval are set, the expired timer use is
+     *  cleared, the time remaining is reset without enabling the watchdog
+     *  and the watchdog is marked as initialized. The calls are sent at
+     *  once and handled by the watchdog service in that order.
      *
-     *  @param[in] key - The name of the property
-     *  @return The value of the property
-     */
-    template <typename T>
-    T getProperty(const std::string& key);
-
-    /** @brief Sets the value of the property on the host watchdog
+     *  @param[in] ctx - ipmi context of the request
+     *  @param[in] settings - the timer configuration
      *
-     *  @param[in] key - The name of the property
-     *  @param[in] val - The new value
+     *  @return error code of the first failed call
      */
-    template <typename T>
-    void setProperty(const std::string& key, const T& val);
+    static boost::system::error_code setTimer(ipmi::Context::ptr ctx,
+                                              const Settings& settings);
 };
@@ -15,6 +15,7 @@
 #include <app/watchdog.hpp>
 #include <apphandler.hpp>
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
@@ -24,11 +25,15 @@
 #include <ipmid/sessionhelper.hpp>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
+#include <limits>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/message/types.hpp>
+#include <set>
 #include <string>
 #include <sys_info_param.hpp>
 #include <tuple>
@@ -63,18 +68,32 @@ using BMC = sdbusplus::xyz::openbmc_project::State::server::BMC;
 namespace fs = std::filesystem;
 
 #ifdef ENABLE_I2C_WHITELIST_CHECK
-typedef struct
+static constexpr size_t maxWRWhitelistDataSize = 144;
+
+/** @brief a whitelist filter, with the masks already applied to the
+ *         slave address and the write data
+ */
+struct i2cMasterWRWhitelist
 {
-    uint8_t busId;
     uint8_t slaveAddr;
     uint8_t slaveAddrMask;
-    std::vector<uint8_t> data;
-    std::vector<uint8_t> dataMask;
-} i2cMasterWRWhitelist;
+    uint8_t dataSize;
+    /** @brief shortest write that matches: past the write data, the masked
+     *         filter data must be zero
+     */
+    uint8_t minWriteSize;
+    std::array<uint8_t, maxWRWhitelistDataSize> data;
+    std::array<uint8_t, maxWRWhitelistDataSize> dataMask;
+};
+
+/** @brief the whitelist filters, indexed by bus id */
+using i2cMasterWRWhitelistIndex =
+    std::array<std::vector<i2cMasterWRWhitelist>,
+               std::numeric_limits<uint8_t>::max() + 1>;
 
-static std::vector<i2cMasterWRWhitelist>& getWRWhitelist()
+static i2cMasterWRWhitelistIndex& getWRWhitelist()
 {
-    static std::vector<i2cMasterWRWhitelist> wrWhitelist;
+    static i2cMasterWRWhitelistIndex wrWhitelist;
     return wrWhitelist;
 }
 
@@ -193,17 +212,96 @@ bool getCurrentBmcState()
                BMC::BMCState::Ready;
 }
 
+/** @brief BMC readiness reported in Get Device ID, read on first use and
+ *         then kept current by the PropertiesChanged signal of the BMC
+ *         state interface. Unset when nothing provides the interface.
+ */
+static std::optional<bool> bmcReady;
+static bool bmcReadyKnown = false;
+static std::unique_ptr<sdbusplus::bus::match_t> bmcStateMatch;
+
 bool getCurrentBmcStateWithFallback(const bool fallbackAvailability)
 {
-    try
+    if (!bmcStateMatch)
+    {
+        using namespace sdbusplus::bus::match::rules;
+        bmcStateMatch = std::make_unique<sdbusplus::bus::match_t>(
+            *getSdBus(),
+            type::signal() + member("PropertiesChanged") +
+                interface("org.freedesktop.DBus.Properties") +
+                argN(0, bmc_state_interface),
+            [](sdbusplus::message::message& msg) {
+                std::string intf;
+                ipmi::PropertyMap properties;
+                try
+                {
+                    msg.read(intf, properties);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                auto it = properties.find(bmc_state_property);
+                if (it == properties.end())
+                {
+                    return;
+                }
+                auto state = std::get_if<std::string>(&it->second);
+                bmcReady = state && BMC::convertBMCStateFromString(*state) ==
+                                        BMC::BMCState::Ready;
+                bmcReadyKnown = true;
+            });
+    }
+    if (!bmcReadyKnown)
     {
-        return getCurrentBmcState();
+        try
+        {
+            bmcReady = getCurrentBmcState();
+        }
+        catch (...)
+        {
+            bmcReady.reset();
+        }
+        bmcReadyKnown = true;
     }
-    catch (...)
+    // Nothing provided the BMC interface, therefore return whatever was
+    // configured as the default.
+    return bmcReady.value_or(fallbackAvailability);
+}
+
+/** @brief set when the software objects changed since the firmware
+ *         revision of the Device ID was read from them
+ */
+static bool softwareChanged = true;
+static std::vector<std::unique_ptr<sdbusplus::bus::match_t>> softwareMatches;
+
+/** @brief watches the software objects for the changes that can select
+ *         another active BMC version
+ */
+static void watchSoftwareObjects()
+{
+    if (!softwareMatches.empty())
     {
-        // Nothing provided the BMC interface, therefore return whatever was
-        // configured as the default.
-        return fallbackAvailability;
+        return;
+    }
+    using namespace sdbusplus::bus::match::rules;
+    auto& bus = *getSdBus();
+    auto changed = [](sdbusplus::message::message&) {
+        softwareChanged = true;
+    };
+    const std::string objects = std::string(softwareRoot) + "/";
+    softwareMatches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus, interfacesAdded() + argNpath(0, objects), changed));
+    softwareMatches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus, interfacesRemoved() + argNpath(0, objects), changed));
+    for (const char* intf : {activationIntf, redundancyIntf, versionIntf})
+    {
+        softwareMatches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            type::signal() + member("PropertiesChanged") +
+                interface("org.freedesktop.DBus.Properties") +
+                path_namespace(softwareRoot) + argN(0, intf),
+            changed));
     }
 }
 
@@ -602,31 +700,6 @@ ipmi::RspType<uint8_t,  // Device ID
 
     if (!dev_id_initialized)
     {
-        try
-        {
-            auto version = getActiveSoftwareVersionInfo(ctx);
-            r = convertVersion(version, rev);
-        }
-        catch (const std::exception& e)
-        {
-            log<level::ERR>(e.what());
-        }
-
-        if (r >= 0)
-        {
-            // bit7 identifies if the device is available
-            // 0=normal operation
-            // 1=device firmware, SDR update,
-            // or self-initialization in progress.
-            // The availability may change in run time, so mask here
-            // and initialize later.
-            devId.fw[0] = rev.major & ipmiDevIdFw1Mask;
-
-            rev.minor = (rev.minor > 99 ? 99 : rev.minor);
-            devId.fw[1] = rev.minor % 10 + (rev.minor / 10) * 16;
-            std::memcpy(&devId.aux, rev.d, 4);
-        }
-
         // IPMI Spec version 2.0
         devId.ipmiVer = 2;
 
@@ -662,6 +735,36 @@ ipmi::RspType<uint8_t,  // Device ID
         }
     }
 
+    // The software objects are only searched again after they changed
+    if (softwareChanged)
+    {
+        watchSoftwareObjects();
+        softwareChanged = false;
+        try
+        {
+            auto version = getActiveSoftwareVersionInfo(ctx);
+            r = convertVersion(version, rev);
+        }
+        catch (const std::exception& e)
+        {
+            log<level::ERR>(e.what());
+        }
+
+        if (r >= 0)
+        {
+            // bit7 identifies if the device is available
+            // 0=normal operation
+            // 1=device firmware, SDR update,
+            // or self-initialization in progress.
+            // The availability may change in run time, so mask here
+            // and initialize later.
+            devId.fw[0] = rev.major & ipmiDevIdFw1Mask;
+
+            rev.minor = (rev.minor > 99 ? 99 : rev.minor);
+            devId.fw[1] = rev.minor % 10 + (rev.minor / 10) * 16;
+        }
+    }
+
     // Set availability to the actual current BMC state
     devId.fw[0] &= ipmiDevIdFw1Mask;
     if (!getCurrentBmcStateWithFallback(defaultActivationSetting))
@@ -761,15 +864,20 @@ auto ipmiAppGetDeviceGuid()
     static constexpr sd_id128_t bmcUuidAppId = SD_ID128_MAKE(
         e0, e1, 73, 76, 64, 61, 47, da, a5, 0c, d0, cc, 64, 12, 45, 78);
 
-    sd_id128_t bmcUuid;
-    // create the UUID from /etc/machine-id via the systemd API
-    sd_id128_get_machine_app_specific(bmcUuidAppId, &bmcUuid);
+    // /etc/machine-id does not change while ipmid runs
+    static std::optional<std::array<uint8_t, uuidBinaryLength>> uuid;
+    if (!uuid)
+    {
+        sd_id128_t bmcUuid;
+        // create the UUID from /etc/machine-id via the systemd API
+        sd_id128_get_machine_app_specific(bmcUuidAppId, &bmcUuid);
 
-    char bmcUuidCstr[SD_ID128_STRING_MAX];
-    std::string systemUuid = sd_id128_to_string(bmcUuid, bmcUuidCstr);
+        char bmcUuidCstr[SD_ID128_STRING_MAX];
+        std::string systemUuid = sd_id128_to_string(bmcUuid, bmcUuidCstr);
 
-    std::array<uint8_t, uuidBinaryLength> uuid = rfc4122ToIpmi(systemUuid);
-    return ipmi::responseSuccess(uuid);
+        uuid = rfc4122ToIpmi(systemUuid);
+    }
+    return ipmi::responseSuccess(*uuid);
 }
 
 auto ipmiAppGetBtCapabilities()
@@ -787,19 +895,57 @@ auto ipmiAppGetBtCapabilities()
                                  outputBufferSize, transactionTime, nrRetries);
 }
 
+/** @brief System GUID in IPMI format, read from the BMC inventory object on
+ *         first use. It is dropped when the UUID changes or the service
+ *         providing it goes away.
+ */
+static constexpr auto uuidInterface = "xyz.openbmc_project.Common.UUID";
+static std::optional<std::array<uint8_t, 16>> systemGuid;
+static std::unique_ptr<sdbusplus::bus::match_t> systemGuidMatch;
+static std::unique_ptr<sdbusplus::bus::match_t> systemGuidOwnerMatch;
+
+static void dropSystemGuid()
+{
+    systemGuid.reset();
+    // a match can't be destroyed from its own callback
+    post_work([]() {
+        if (!systemGuid)
+        {
+            systemGuidOwnerMatch.reset();
+        }
+    });
+}
+
 auto ipmiAppGetSystemGuid() -> ipmi::RspType<std::array<uint8_t, 16>>
 {
     static constexpr auto bmcInterface =
         "xyz.openbmc_project.Inventory.Item.Bmc";
-    static constexpr auto uuidInterface = "xyz.openbmc_project.Common.UUID";
     static constexpr auto uuidProperty = "UUID";
 
+    if (systemGuid)
+    {
+        return ipmi::responseSuccess(*systemGuid);
+    }
+
+    auto busPtr = getSdBus();
+    if (!systemGuidMatch)
+    {
+        using namespace sdbusplus::bus::match::rules;
+        systemGuidMatch = std::make_unique<sdbusplus::bus::match_t>(
+            *busPtr,
+            type::signal() + member("PropertiesChanged") +
+                interface("org.freedesktop.DBus.Properties") +
+                argN(0, uuidInterface),
+            [](sdbusplus::message::message&) { dropSystemGuid(); });
+    }
+
     ipmi::Value propValue;
+    std::string service;
     try
     {
         // Get the Inventory object implementing BMC interface
-        auto busPtr = getSdBus();
         auto objectInfo = ipmi::getDbusObject(*busPtr, bmcInterface);
+        service = objectInfo.second;
 
         // Read UUID property value from bmcObject
         // UUID is in RFC4122 format Ex: 61a39523-78f2-11e5-9862-e6402cfc3223
@@ -829,54 +975,314 @@ auto ipmiAppGetSystemGuid() -> ipmi::RspType<std::array<uint8_t, 16>>
                         entry("VALUE=%s", rfc4122Uuid.c_str()));
         return ipmi::responseUnspecifiedError();
     }
+    systemGuid = uuid;
+    systemGuidOwnerMatch = std::make_unique<sdbusplus::bus::match_t>(
+        *busPtr, sdbusplus::bus::match::rules::nameOwnerChanged(service),
+        [](sdbusplus::message::message&) { dropSystemGuid(); });
     return ipmi::responseSuccess(uuid);
 }
 
+namespace
+{
+
+/** @class SessionTable
+ *
+ *  The netipmid session objects, read once from the mapper and the services
+ *  and then kept current by the InterfacesAdded, InterfacesRemoved and
+ *  PropertiesChanged signals of the objects, so Get Session Info and Close
+ *  Session don't walk the sessions over D-Bus. The sessions of a service
+ *  are dropped when it leaves the bus. The signals that come while the
+ *  table is read are newer than what is read, so the sessions they added or
+ *  removed are kept as the signals left them.
+ */
+class SessionTable
+{
+  public:
+    struct Session
+    {
+        std::string service;
+        ipmi::PropertyMap properties;
+    };
+
+    /** @brief sessions by object path, in the order of the object tree */
+    using Sessions = std::map<std::string, Session>;
+
+    /** @brief gets the sessions, the table is loaded on first use
+     *
+     *  @param[in] ctx - ipmi context, used when the table is loaded
+     *
+     *  @return the sessions, nullptr if the table could not be loaded
+     */
+    const Sessions* get(ipmi::Context::ptr ctx)
+    {
+        if (!loaded && !load(ctx))
+        {
+            return nullptr;
+        }
+        return &sessions;
+    }
+
+    /** @brief records a state set by ipmid, ahead of its signal */
+    void setState(const std::string& path, session::State state)
+    {
+        auto it = sessions.find(path);
+        if (it != sessions.end())
+        {
+            it->second.properties["State"] = static_cast<uint8_t>(state);
+        }
+    }
+
+  private:
+    void watch()
+    {
+        using namespace sdbusplus::bus::match::rules;
+        auto& bus = *getSdBus();
+        const std::string objects =
+            std::string(session::sessionManagerRootPath) + "/";
+        addedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, interfacesAdded() + argNpath(0, objects),
+            [this](sdbusplus::message::message& msg) {
+                sdbusplus::message::object_path path;
+                ipmi::DbusInterfaceMap interfaces;
+                try
+                {
+                    msg.read(path, interfaces);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                auto it = interfaces.find(session::sessionIntf);
+                if (it != interfaces.end())
+                {
+                    sessions[path.str] = {msg.get_sender(),
+                                          std::move(it->second)};
+                    if (loads)
+                    {
+                        signaled.insert(path.str);
+                    }
+                }
+            });
+        removedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, interfacesRemoved() + argNpath(0, objects),
+            [this](sdbusplus::message::message& msg) {
+                sdbusplus::message::object_path path;
+                ipmi::InterfaceList interfaces;
+                try
+                {
+                    msg.read(path, interfaces);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                if (std::find(interfaces.begin(), interfaces.end(),
+                              session::sessionIntf) != interfaces.end())
+                {
+                    sessions.erase(path.str);
+                    if (loads)
+                    {
+                        signaled.insert(path.str);
+                    }
+                }
+            });
+        changedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            type::signal() + member("PropertiesChanged") +
+                interface("org.freedesktop.DBus.Properties") +
+                path_namespace(session::sessionManagerRootPath) +
+                argN(0, session::sessionIntf),
+            [this](sdbusplus::message::message& msg) {
+                std::string interface;
+                ipmi::PropertyMap changed;
+                try
+                {
+                    msg.read(interface, changed);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                auto it = sessions.find(msg.get_path());
+                if (it == sessions.end())
+                {
+                    return;
+                }
+                for (auto& [name, value] : changed)
+                {
+                    it->second.properties[name] = std::move(value);
+                }
+            });
+        // a service that leaves the bus takes its sessions along
+        ownerMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, nameOwnerChanged(),
+            [this](sdbusplus::message::message& msg) {
+                std::string name, oldOwner, newOwner;
+                try
+                {
+                    msg.read(name, oldOwner, newOwner);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                if (!newOwner.empty())
+                {
+                    return;
+                }
+                if (loads)
+                {
+                    goneServices.insert(name);
+                    goneServices.insert(oldOwner);
+                }
+                for (auto it = sessions.begin(); it != sessions.end();)
+                {
+                    if (it->second.service == name ||
+                        it->second.service == oldOwner)
+                    {
+                        it = sessions.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            });
+    }
+
+    bool load(ipmi::Context::ptr ctx)
+    {
+        if (!addedMatch)
+        {
+            watch();
+        }
+        loads++;
+        Sessions table;
+        bool read = readSessions(ctx, table);
+        if (read)
+        {
+            // the live table is newer for what the signals touched
+            for (auto& [path, session] : table)
+            {
+                if (signaled.count(path) ||
+                    goneServices.count(session.service))
+                {
+                    continue;
+                }
+                sessions.emplace(path, std::move(session));
+            }
+            loaded = true;
+        }
+        if (--loads == 0)
+        {
+            signaled.clear();
+            goneServices.clear();
+        }
+        return read;
+    }
+
+    bool readSessions(ipmi::Context::ptr ctx, Sessions& table)
+    {
+        ipmi::ObjectTree objectTree;
+        boost::system::error_code ec = ipmi::getAllDbusObjects(
+            ctx, session::sessionManagerRootPath, session::sessionIntf,
+            objectTree);
+        if (ec)
+        {
+            log<level::ERR>("Failed to fetch object from dbus",
+                            entry("INTERFACE=%s", session::sessionIntf),
+                            entry("ERRMSG=%s", ec.message().c_str()));
+            return false;
+        }
+        for (auto& [path, serviceMap] : objectTree)
+        {
+            // Session id and session handle are unique for each session, a
+            // session object can only be provided by one service
+            if (serviceMap.size() != 1)
+            {
+                log<level::ERR>("Session object with multiple services",
+                                entry("OBJECTPATH=%s", path.c_str()));
+                return false;
+            }
+            const std::string& service = serviceMap.begin()->first;
+            ipmi::PropertyMap properties;
+            ec = ipmi::getAllDbusProperties(ctx, service, path,
+                                            session::sessionIntf, properties);
+            if (ec)
+            {
+                log<level::ERR>("Failed to fetch session properties",
+                                entry("SERVICE=%s", service.c_str()),
+                                entry("OBJECTPATH=%s", path.c_str()),
+                                entry("ERRMSG=%s", ec.message().c_str()));
+                return false;
+            }
+            table.emplace(path, Session{service, std::move(properties)});
+        }
+        return true;
+    }
+
+    bool loaded = false;
+    Sessions sessions;
+    /** @brief loads in progress, and the sessions and services the
+     *         signals changed in the meantime
+     */
+    size_t loads = 0;
+    std::set<std::string> signaled;
+    std::set<std::string> goneServices;
+    std::unique_ptr<sdbusplus::bus::match_t> addedMatch;
+    std::unique_ptr<sdbusplus::bus::match_t> removedMatch;
+    std::unique_ptr<sdbusplus::bus::match_t> changedMatch;
+    std::unique_ptr<sdbusplus::bus::match_t> ownerMatch;
+};
+
+SessionTable sessionTable;
+
+} // namespace
+
 /**
  * @brief set the session state as teardown
  *
  * This function is to set the session state to tear down in progress if the
  * state is active.
  *
- * @param[in] busp - Dbus obj
- * @param[in] service - service name
+ * @param[in] ctx - context of the request
  * @param[in] obj - object path
+ * @param[in] session - the session in the session table
  *
  * @return success completion code if it sets the session state to
  * tearDownInProgress else return the corresponding error completion code.
  **/
-uint8_t setSessionState(std::shared_ptr<sdbusplus::asio::connection>& busp,
-                        const std::string& service, const std::string& obj)
+uint8_t setSessionState(ipmi::Context::ptr ctx, const std::string& obj,
+                        const SessionTable::Session& session)
 {
-    try
+    uint8_t sessionState = ipmi::mappedVariant<uint8_t>(
+        session.properties, "State",
+        static_cast<uint8_t>(session::State::inactive));
+    if (sessionState != static_cast<uint8_t>(session::State::active))
     {
-        uint8_t sessionState = std::get<uint8_t>(ipmi::getDbusProperty(
-            *busp, service, obj, session::sessionIntf, "State"));
-
-        if (sessionState == static_cast<uint8_t>(session::State::active))
-        {
-            ipmi::setDbusProperty(
-                *busp, service, obj, session::sessionIntf, "State",
-                static_cast<uint8_t>(session::State::tearDownInProgress));
-            return ipmi::ccSuccess;
-        }
+        return ipmi::ccInvalidFieldRequest;
     }
-    catch (std::exception& e)
+
+    boost::system::error_code ec = ipmi::setDbusProperty(
+        ctx, session.service, obj, session::sessionIntf, "State",
+        static_cast<uint8_t>(session::State::tearDownInProgress));
+    if (ec)
     {
-        log<level::ERR>("Failed in getting session state property",
-                        entry("service=%s", service.c_str()),
+        log<level::ERR>("Failed in setting session state property",
+                        entry("service=%s", session.service.c_str()),
                         entry("object path=%s", obj.c_str()),
-                        entry("interface=%s", session::sessionIntf));
+                        entry("interface=%s", session::sessionIntf),
+                        entry("ERRMSG=%s", ec.message().c_str()));
         return ipmi::ccUnspecifiedError;
     }
-
-    return ipmi::ccInvalidFieldRequest;
+    sessionTable.setState(obj, session::State::tearDownInProgress);
+    return ipmi::ccSuccess;
 }
 
-ipmi::RspType<> ipmiAppCloseSession(uint32_t reqSessionId,
+ipmi::RspType<> ipmiAppCloseSession(ipmi::Context::ptr ctx,
+                                    uint32_t reqSessionId,
                                     std::optional<uint8_t> requestSessionHandle)
 {
-    auto busp = getSdBus();
     uint8_t reqSessionHandle =
         requestSessionHandle.value_or(session::defaultSessionHandle);
 
@@ -898,42 +1304,22 @@ ipmi::RspType<> ipmiAppCloseSession(uint32_t reqSessionId,
         return ipmi::response(ipmi::ccInvalidFieldRequest);
     }
 
-    try
+    const SessionTable::Sessions* sessions = sessionTable.get(ctx);
+    if (!sessions)
     {
-        ipmi::ObjectTree objectTree = ipmi::getAllDbusObjects(
-            *busp, session::sessionManagerRootPath, session::sessionIntf);
+        return ipmi::responseUnspecifiedError();
+    }
 
-        for (auto& objectTreeItr : objectTree)
+    for (const auto& [obj, session] : *sessions)
+    {
+        if (isSessionObjectMatched(obj, reqSessionId, reqSessionHandle))
         {
-            const std::string obj = objectTreeItr.first;
-
-            if (isSessionObjectMatched(obj, reqSessionId, reqSessionHandle))
-            {
-                auto& serviceMap = objectTreeItr.second;
-
-                // Session id and session handle are unique for each session.
-                // Session id and handler are retrived from the object path and
-                // object path will be unique for each session. Checking if
-                // multiple objects exist with same object path under multiple
-                // services.
-                if (serviceMap.size() != 1)
-                {
-                    return ipmi::responseUnspecifiedError();
-                }
-
-                auto itr = serviceMap.begin();
-                const std::string service = itr->first;
-                return ipmi::response(setSessionState(busp, service, obj));
-            }
+            // copied, the table can change while the state is set
+            const std::string path = obj;
+            const SessionTable::Session matched = session;
+            return ipmi::response(setSessionState(ctx, path, matched));
         }
     }
-    catch (sdbusplus::exception::SdBusError& e)
-    {
-        log<level::ERR>("Failed to fetch object from dbus",
-                        entry("INTERFACE=%s", session::sessionIntf),
-                        entry("ERRMSG=%s", e.what()));
-        return ipmi::responseUnspecifiedError();
-    }
 
     return ipmi::responseInvalidFieldRequest();
 }
@@ -1048,23 +1434,6 @@ uint8_t getSessionInfoRequestData(const ipmi::Context::ptr ctx,
     return ipmi::ccSuccess;
 }
 
-uint8_t getSessionState(ipmi::Context::ptr ctx, const std::string& service,
-                        const std::string& objPath, uint8_t& sessionState)
-{
-    boost::system::error_code ec = ipmi::getDbusProperty(
-        ctx, service, objPath, session::sessionIntf, "State", sessionState);
-    if (ec)
-    {
-        log<level::ERR>("Failed to fetch state property ",
-                        entry("SERVICE=%s", service.c_str()),
-                        entry("OBJECTPATH=%s", objPath.c_str()),
-                        entry("INTERFACE=%s", session::sessionIntf),
-                        entry("ERRMSG=%s", ec.message().c_str()));
-        return ipmi::ccUnspecifiedError;
-    }
-    return ipmi::ccSuccess;
-}
-
 static constexpr uint8_t macAddrLen = 6;
 /** Alias SessionDetails - contain the optional information about an
  *        RMCP+ session.
@@ -1085,33 +1454,16 @@ using SessionDetails =
 
 /** @brief get session details for a given session
  *
- *  @param[in] ctx - ipmi::Context pointer for accessing D-Bus
- *  @param[in] service - D-Bus service name to fetch details from
- *  @param[in] objPath - D-Bus object path for session
+ *  @param[in] sessionProps - properties of the session
  *  @param[out] sessionHandle - return session handle for session
  *  @param[out] sessionState - return session state for session
  *  @param[out] details - return a SessionDetails tuple containing other
  *                        session info
- *  @return - ipmi::Cc success or error code
  */
-ipmi::Cc getSessionDetails(ipmi::Context::ptr ctx, const std::string& service,
-                           const std::string& objPath, uint8_t& sessionHandle,
-                           uint8_t& sessionState, SessionDetails& details)
+void getSessionDetails(const ipmi::PropertyMap& sessionProps,
+                       uint8_t& sessionHandle, uint8_t& sessionState,
+                       SessionDetails& details)
 {
-    ipmi::PropertyMap sessionProps;
-    boost::system::error_code ec = ipmi::getAllDbusProperties(
-        ctx, service, objPath, session::sessionIntf, sessionProps);
-
-    if (ec)
-    {
-        log<level::ERR>("Failed to fetch state property ",
-                        entry("SERVICE=%s", service.c_str()),
-                        entry("OBJECTPATH=%s", objPath.c_str()),
-                        entry("INTERFACE=%s", session::sessionIntf),
-                        entry("ERRMSG=%s", ec.message().c_str()));
-        return ipmi::ccUnspecifiedError;
-    }
-
     sessionState = ipmi::mappedVariant<uint8_t>(
         sessionProps, "State", static_cast<uint8_t>(session::State::inactive));
     if (sessionState == static_cast<uint8_t>(session::State::active))
@@ -1134,8 +1486,6 @@ ipmi::Cc getSessionDetails(ipmi::Context::ptr ctx, const std::string& service,
         std::get<8>(details) =
             ipmi::mappedVariant<uint16_t>(sessionProps, "RemotePort", 0);
     }
-
-    return ipmi::ccSuccess;
 }
 
 ipmi::RspType<uint8_t, // session handle,
@@ -1157,14 +1507,9 @@ ipmi::RspType<uint8_t, // session handle,
     {
         return ipmi::response(completionCode);
     }
-    ipmi::ObjectTree objectTree;
-    boost::system::error_code ec = ipmi::getAllDbusObjects(
-        ctx, session::sessionManagerRootPath, session::sessionIntf, objectTree);
-    if (ec)
+    const SessionTable::Sessions* sessions = sessionTable.get(ctx);
+    if (!sessions)
     {
-        log<level::ERR>("Failed to fetch object from dbus",
-                        entry("INTERFACE=%s", session::sessionIntf),
-                        entry("ERRMSG=%s", ec.message().c_str()));
         return ipmi::responseUnspecifiedError();
     }
 
@@ -1173,10 +1518,9 @@ ipmi::RspType<uint8_t, // session handle,
     uint8_t sessionHandle = session::defaultSessionHandle;
     std::optional<SessionDetails> maybeDetails;
     uint8_t index = 0;
-    for (auto& objectTreeItr : objectTree)
+    for (const auto& [objectPath, session] : *sessions)
     {
         uint32_t sessionId = 0;
-        std::string objectPath = objectTreeItr.first;
 
         if (!parseCloseSessionInputPayload(objectPath, sessionId,
                                            sessionHandle))
@@ -1184,23 +1528,10 @@ ipmi::RspType<uint8_t, // session handle,
             continue;
         }
         index++;
-        auto& serviceMap = objectTreeItr.second;
-        auto itr = serviceMap.begin();
-
-        if (serviceMap.size() != 1)
-        {
-            return ipmi::responseUnspecifiedError();
-        }
-
-        std::string service = itr->first;
-        uint8_t sessionState = 0;
-        completionCode =
-            getSessionState(ctx, service, objectPath, sessionState);
-        if (completionCode)
-        {
-            return ipmi::response(completionCode);
-        }
 
+        uint8_t sessionState = ipmi::mappedVariant<uint8_t>(
+            session.properties, "State",
+            static_cast<uint8_t>(session::State::inactive));
         if (sessionState == static_cast<uint8_t>(session::State::active))
         {
             activeSessionCount++;
@@ -1213,13 +1544,7 @@ ipmi::RspType<uint8_t, // session handle,
         }
 
         SessionDetails details{};
-        completionCode = getSessionDetails(ctx, service, objectPath,
-                                           sessionHandle, state, details);
-
-        if (completionCode)
-        {
-            return ipmi::response(completionCode);
-        }
+        getSessionDetails(session.properties, sessionHandle, state, details);
         maybeDetails = std::move(details);
     }
 
@@ -1234,6 +1559,10 @@ ipmi::RspType<uint8_t, // session handle,
 }
 
 static std::unique_ptr<SysInfoParamStore> sysInfoParamStore;
+static std::unique_ptr<sdbusplus::bus::match_t> systemNameMatch;
+
+static constexpr auto networkConfigIntf =
+    "xyz.openbmc_project.Network.SystemConfiguration";
 
 static std::string sysInfoReadSystemName()
 {
@@ -1246,6 +1575,33 @@ static std::string sysInfoReadSystemName()
     return hostname;
 }
 
+/** @brief gets the system info parameter store, creating it on first use
+ *
+ *  The system name is read once and read again after the network
+ *  configuration reports a hostname change.
+ */
+static SysInfoParamStore& getSysInfoParamStore()
+{
+    if (sysInfoParamStore)
+    {
+        return *sysInfoParamStore;
+    }
+
+    sysInfoParamStore = std::make_unique<SysInfoParamStore>();
+    sysInfoParamStore->update(IPMI_SYSINFO_SYSTEM_NAME, sysInfoReadSystemName);
+
+    using namespace sdbusplus::bus::match::rules;
+    systemNameMatch = std::make_unique<sdbusplus::bus::match_t>(
+        *getSdBus(),
+        type::signal() + member("PropertiesChanged") +
+            interface("org.freedesktop.DBus.Properties") +
+            argN(0, networkConfigIntf),
+        [](sdbusplus::message::message&) {
+            sysInfoParamStore->invalidate(IPMI_SYSINFO_SYSTEM_NAME);
+        });
+    return *sysInfoParamStore;
+}
+
 static constexpr uint8_t paramRevision = 0x11;
 static constexpr size_t configParameterLength = 16;
 
@@ -1315,51 +1671,17 @@ ipmi::RspType<uint8_t,                // Parameter revision
         return ipmi::responseParmNotSupported();
     }
 
-    if (sysInfoParamStore == nullptr)
-    {
-        sysInfoParamStore = std::make_unique<SysInfoParamStore>();
-        sysInfoParamStore->update(IPMI_SYSINFO_SYSTEM_NAME,
-                                  sysInfoReadSystemName);
-    }
-
-    // Parameters other than Set In Progress are assumed to be strings.
-    std::tuple<bool, std::string> ret =
-        sysInfoParamStore->lookup(paramSelector);
-    bool found = std::get<0>(ret);
+    // Parameters other than Set In Progress are assumed to be strings, the
+    // store keeps them as prebuilt blocks.
+    auto [found, configData] =
+        getSysInfoParamStore().lookup(paramSelector, setSelector);
     if (!found)
     {
         return ipmi::responseSensorInvalid();
     }
-    std::string& paramString = std::get<1>(ret);
-    std::vector<uint8_t> configData;
-    size_t count = 0;
-    if (setSelector == 0)
-    {                               // First chunk has only 14 bytes.
-        configData.emplace_back(0); // encoding
-        configData.emplace_back(paramString.length()); // string length
-        count = std::min(paramString.length(), smallChunkSize);
-        configData.resize(count + configDataOverhead);
-        std::copy_n(paramString.begin(), count,
-                    configData.begin() + configDataOverhead); // 14 bytes chunk
-
-        // Append zero's to remaining bytes
-        if (configData.size() < configParameterLength)
-        {
-            std::fill_n(std::back_inserter(configData),
-                        configParameterLength - configData.size(), 0x00);
-        }
-    }
-    else
+    if (!configData)
     {
-        size_t offset = (setSelector * fullChunkSize) - configDataOverhead;
-        if (offset >= paramString.length())
-        {
-            return ipmi::responseParmOutOfRange();
-        }
-        count = std::min(paramString.length() - offset, fullChunkSize);
-        configData.resize(count);
-        std::copy_n(paramString.begin() + offset, count,
-                    configData.begin()); // 16 bytes chunk
+        return ipmi::responseParmOutOfRange();
     }
     return ipmi::responseSuccess(paramRevision, setSelector, configData);
 }
@@ -1458,16 +1780,9 @@ ipmi::RspType<> ipmiAppSetSystemInfo(uint8_t paramSelector, uint8_t data1,
                (configParameterLength - configData.size()), 0x00);
     }
 
-    if (!sysInfoParamStore)
-    {
-        sysInfoParamStore = std::make_unique<SysInfoParamStore>();
-        sysInfoParamStore->update(IPMI_SYSINFO_SYSTEM_NAME,
-                                  sysInfoReadSystemName);
-    }
-
     // lookup
     std::tuple<bool, std::string> ret =
-        sysInfoParamStore->lookup(paramSelector);
+        getSysInfoParamStore().lookup(paramSelector);
     bool found = std::get<0>(ret);
     std::string& paramString = std::get<1>(ret);
     if (!found)
@@ -1569,7 +1884,8 @@ static bool populateI2CMasterWRWhitelist()
         //    },]
 
         nlohmann::json filters = data[filtersStr].get<nlohmann::json>();
-        std::vector<i2cMasterWRWhitelist>& whitelist = getWRWhitelist();
+        i2cMasterWRWhitelistIndex& whitelist = getWRWhitelist();
+        size_t filterCount = 0;
         for (const auto& it : filters.items())
         {
             nlohmann::json filter = it.value();
@@ -1590,18 +1906,37 @@ static bool populateI2CMasterWRWhitelist()
                                 "mismatch for command & mask size");
                 return false;
             }
-            whitelist.push_back(
-                {static_cast<uint8_t>(std::stoul(
-                     filter[busIdStr].get<std::string>(), nullptr, base_16)),
-                 static_cast<uint8_t>(
-                     std::stoul(filter[slaveAddrStr].get<std::string>(),
-                                nullptr, base_16)),
-                 static_cast<uint8_t>(
-                     std::stoul(filter[slaveAddrMaskStr].get<std::string>(),
-                                nullptr, base_16)),
-                 writeData, writeDataMask});
+            if (writeData.size() > maxWRWhitelistDataSize)
+            {
+                log<level::ERR>("I2C master write read whitelist filter "
+                                "command too long");
+                return false;
+            }
+            uint8_t busId = static_cast<uint8_t>(std::stoul(
+                filter[busIdStr].get<std::string>(), nullptr, base_16));
+            i2cMasterWRWhitelist entry{};
+            entry.slaveAddrMask = static_cast<uint8_t>(
+                std::stoul(filter[slaveAddrMaskStr].get<std::string>(),
+                           nullptr, base_16));
+            entry.slaveAddr =
+                static_cast<uint8_t>(
+                    std::stoul(filter[slaveAddrStr].get<std::string>(),
+                               nullptr, base_16)) |
+                entry.slaveAddrMask;
+            entry.dataSize = writeData.size();
+            for (size_t i = 0; i < writeData.size(); i++)
+            {
+                entry.dataMask[i] = writeDataMask[i];
+                entry.data[i] = writeData[i] | writeDataMask[i];
+                if (entry.data[i])
+                {
+                    entry.minWriteSize = i + 1;
+                }
+            }
+            whitelist[busId].push_back(entry);
+            filterCount++;
         }
-        if (whitelist.size() != filters.size())
+        if (filterCount != filters.size())
         {
             log<level::ERR>(
                 "I2C master write read whitelist filter size mismatch");
@@ -1617,41 +1952,38 @@ static bool populateI2CMasterWRWhitelist()
     return true;
 }
 
-static inline bool isWriteDataWhitelisted(const std::vector<uint8_t>& data,
-                                          const std::vector<uint8_t>& dataMask,
+static inline bool isWriteDataWhitelisted(const i2cMasterWRWhitelist& wlEntry,
                                           const std::vector<uint8_t>& writeData)
 {
-    std::vector<uint8_t> processedDataBuf(data.size());
-    std::vector<uint8_t> processedReqBuf(dataMask.size());
-    std::transform(writeData.begin(), writeData.end(), dataMask.begin(),
-                   processedReqBuf.begin(), std::bit_or<uint8_t>());
-    std::transform(data.begin(), data.end(), dataMask.begin(),
-                   processedDataBuf.begin(), std::bit_or<uint8_t>());
-
-    return (processedDataBuf == processedReqBuf);
+    for (size_t i = 0; i < writeData.size(); i++)
+    {
+        if ((writeData[i] | wlEntry.dataMask[i]) != wlEntry.data[i])
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 static bool isCmdWhitelisted(uint8_t busId, uint8_t slaveAddr,
-                             std::vector<uint8_t>& writeData)
+                             const std::vector<uint8_t>& writeData)
 {
-    std::vector<i2cMasterWRWhitelist>& whiteList = getWRWhitelist();
-    for (const auto& wlEntry : whiteList)
+    for (const auto& wlEntry : getWRWhitelist()[busId])
     {
-        if ((busId == wlEntry.busId) &&
-            ((slaveAddr | wlEntry.slaveAddrMask) ==
-             (wlEntry.slaveAddr | wlEntry.slaveAddrMask)))
+        if ((slaveAddr | wlEntry.slaveAddrMask) != wlEntry.slaveAddr)
         {
-            const std::vector<uint8_t>& dataMask = wlEntry.dataMask;
-            // Skip as no-match, if requested write data is more than the
-            // write data mask size
-            if (writeData.size() > dataMask.size())
-            {
-                continue;
-            }
-            if (isWriteDataWhitelisted(wlEntry.data, dataMask, writeData))
-            {
-                return true;
-            }
+            continue;
+        }
+        // Skip as no-match, if requested write data is more than the
+        // write data mask size, or too short to match the filter data
+        if (writeData.size() > wlEntry.dataSize ||
+            writeData.size() < wlEntry.minWriteSize)
+        {
+            continue;
+        }
+        if (isWriteDataWhitelisted(wlEntry, writeData))
+        {
+            return true;
         }
     }
     return false;
@@ -1717,17 +2049,34 @@ ipmi::RspType<std::vector<uint8_t>>
     return ipmi::responseSuccess(readBuf);
 }
 
+/** @brief the signals that can change the Get Device ID response: a new
+ *         active BMC version or a BMC state change
+ */
+static ipmi::CachePolicy deviceIdCachePolicy()
+{
+    using namespace sdbusplus::bus::match::rules;
+    const std::string objects = std::string(softwareRoot) + "/";
+    const std::string propertiesChanged =
+        type::signal() + member("PropertiesChanged") +
+        interface("org.freedesktop.DBus.Properties");
+    return {{interfacesAdded() + argNpath(0, objects),
+             interfacesRemoved() + argNpath(0, objects),
+             propertiesChanged + path_namespace(softwareRoot),
+             propertiesChanged + argN(0, bmc_state_interface)}};
+}
+
 void register_netfn_app_functions()
 {
     // <Get Device ID>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
                           ipmi::app::cmdGetDeviceId, ipmi::Privilege::User,
-                          ipmiAppGetDeviceId);
+                          deviceIdCachePolicy(), ipmiAppGetDeviceId);
 
     // <Get BT Interface Capabilities>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
                           ipmi::app::cmdGetBtIfaceCapabilities,
-                          ipmi::Privilege::User, ipmiAppGetBtCapabilities);
+                          ipmi::Privilege::User, ipmi::CachePolicy{},
+                          ipmiAppGetBtCapabilities);
 
     // <Reset Watchdog Timer>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
@@ -1760,7 +2109,7 @@ void register_netfn_app_functions()
     // <Get Device GUID>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
                           ipmi::app::cmdGetDeviceGuid, ipmi::Privilege::User,
-                          ipmiAppGetDeviceGuid);
+                          ipmi::CachePolicy{}, ipmiAppGetDeviceGuid);
 
     // <Set ACPI Power State>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
@@ -1777,21 +2126,34 @@ void register_netfn_app_functions()
     {
         // Note: For security reasons, registering master write read as admin
         // privilege command, even though IPMI 2.0 specification allows it as
-        // operator privilege.
+        // operator privilege. The i2c transfer blocks, so it runs on the
+        // handler worker pool.
         ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
                               ipmi::app::cmdMasterWriteRead,
-                              ipmi::Privilege::Admin, ipmiMasterWriteRead);
+                              ipmi::Privilege::Admin, ipmi::Execution::worker,
+                              ipmiMasterWriteRead);
     }
 
     // <Get System GUID Command>
-    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
-                          ipmi::app::cmdGetSystemGuid, ipmi::Privilege::User,
-                          ipmiAppGetSystemGuid);
+    {
+        using namespace sdbusplus::bus::match::rules;
+        ipmi::registerHandler(
+            ipmi::prioOpenBmcBase, ipmi::netFnApp,
+            ipmi::app::cmdGetSystemGuid, ipmi::Privilege::User,
+            ipmi::CachePolicy{{type::signal() + member("PropertiesChanged") +
+                               interface("org.freedesktop.DBus.Properties") +
+                               argN(0, uuidInterface)}},
+            ipmiAppGetSystemGuid);
+    }
 
     // <Get Channel Cipher Suites Command>
+    // the cipher records are fixed, the expiry only catches a LAN device
+    // going away
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
                           ipmi::app::cmdGetChannelCipherSuites,
-                          ipmi::Privilege::None, getChannelCipherSuites);
+                          ipmi::Privilege::None,
+                          ipmi::CachePolicy{{}, std::chrono::seconds(10)},
+                          getChannelCipherSuites);
 
     // <Get System Info Command>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
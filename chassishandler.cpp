@@ -8,22 +8,29 @@
 #include <mapper.h>
 #include <netinet/in.h>
 
+#include <algorithm>
 #include <array>
+#include <boost/asio/steady_timer.hpp>
 #include <chrono>
+#include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <future>
+#include <limits>
 #include <ipmid/api.hpp>
+#include <ipmid/oemopenbmc.hpp>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
 #include <map>
+#include <memory>
+#include <optional>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/message/types.hpp>
 #include <sdbusplus/server/object.hpp>
-#include <sdbusplus/timer.hpp>
 #include <settings.hpp>
 #include <sstream>
 #include <string>
@@ -35,7 +42,7 @@
 #include <xyz/openbmc_project/State/Host/server.hpp>
 #include <xyz/openbmc_project/State/PowerOnHours/server.hpp>
 
-std::unique_ptr<phosphor::Timer> identifyTimer
+std::unique_ptr<boost::asio::steady_timer> identifyTimer
     __attribute__((init_priority(101)));
 
 static ChassisIDState chassisIDState = ChassisIDState::reserved;
@@ -57,7 +64,6 @@ static constexpr size_t macOffset = 9;
 static constexpr size_t addrTypeOffset = 16;
 static constexpr size_t ipAddrOffset = 17;
 
-static constexpr size_t encIdentifyObjectsSize = 1;
 static constexpr size_t chassisIdentifyReqLength = 2;
 static constexpr size_t identifyIntervalPos = 0;
 static constexpr size_t forceIdentifyPos = 1;
@@ -107,6 +113,10 @@ const static constexpr char chassisSMDevAddrProp[] = "SMDeviceAddress";
 const static constexpr char chassisBridgeDevAddrProp[] = "BridgeDeviceAddress";
 static constexpr uint8_t chassisCapFlagMask = 0x0f;
 static constexpr uint8_t chassisCapAddrMask = 0xfe;
+// The POH counter and the chassis capabilities are read from the D-Bus cache,
+// kept current by the PropertiesChanged signals of their objects; the object
+// lookups are answered by the mapper cache
+static const ipmi::DbusCache trackedProperties{{}, true};
 static constexpr const char* powerButtonIntf =
     "xyz.openbmc_project.Chassis.Buttons.Power";
 static constexpr const char* powerButtonPath =
@@ -153,167 +163,521 @@ settings::Objects& getObjects()
     return *objectsPtr;
 }
 
-} // namespace cache
-} // namespace internal
-} // namespace chassis
-
-namespace poh
+/** @class InterfaceCache
+ *
+ *  Properties of a D-Bus interface, read with one GetAll on first use and
+ *  kept current by its PropertiesChanged signal. The properties are dropped
+ *  when the object is removed or its service goes away. A missing object is
+ *  remembered for absentRetry, so optional objects such as the buttons do not
+ *  cost a mapper lookup on every command.
+ */
+class InterfaceCache
 {
+  public:
+    static constexpr std::chrono::seconds absentRetry{10};
+
+    InterfaceCache(const std::string& path, const std::string& intf) :
+        path(path), intf(intf)
+    {
+        using namespace sdbusplus::bus::match::rules;
+        auto& bus = *getSdBus();
+        changedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, propertiesChanged(path, intf),
+            [this](sdbusplus::message::message& msg) {
+                std::string interface;
+                ipmi::PropertyMap changed;
+                try
+                {
+                    msg.read(interface, changed);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                if (!properties)
+                {
+                    return;
+                }
+                for (auto& [name, value] : changed)
+                {
+                    (*properties)[name] = std::move(value);
+                }
+                changes++;
+            });
+        // the object coming or going invalidates what is known about it
+        auto reset = [this](sdbusplus::message::message&) { invalidate(); };
+        addedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, interfacesAdded() + argNpath(0, path), reset);
+        removedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, interfacesRemoved() + argNpath(0, path), reset);
+    }
+
+    InterfaceCache(const InterfaceCache&) = delete;
+    InterfaceCache& operator=(const InterfaceCache&) = delete;
+
+    /** @brief gets a property of the interface
+     *
+     *  @param[in] ctx - ipmi context, used when the properties are read
+     *  @param[in] property - property name
+     *
+     *  @return the property value, std::nullopt if the object or the
+     *          property is missing
+     */
+    std::optional<ipmi::Value> get(ipmi::Context::ptr ctx,
+                                   const std::string& property)
+    {
+        if (!properties && !load(ctx))
+        {
+            return std::nullopt;
+        }
+        auto it = properties->find(property);
+        if (it == properties->end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
 
-constexpr auto minutesPerCount = 60;
-
-} // namespace poh
-
-int getHostNetworkData(ipmi::message::Payload& payload)
-{
-    ipmi::PropertyMap properties;
-    int rc = 0;
-    uint8_t addrSize = ipmi::network::IPV4_ADDRESS_SIZE_BYTE;
+    /** @brief counts the changes of the properties, a value derived from
+     *         them is current as long as the count is the same
+     */
+    uint64_t generation() const
+    {
+        return changes;
+    }
 
-    try
+    /** @brief the service the properties were read from, empty while they
+     *         are not loaded
+     */
+    const std::string& owner() const
     {
-        // TODO There may be cases where an interface is implemented by multiple
-        // objects,to handle such cases we are interested on that object
-        //  which are on interested busname.
-        //  Currenlty mapper doesn't give the readable busname(gives busid)
-        //  so we can't match with bus name so giving some object specific info
-        //  as SETTINGS_MATCH.
-        //  Later SETTINGS_MATCH will be replaced with busname.
+        return service;
+    }
 
-        sdbusplus::bus::bus bus(ipmid_get_sd_bus_connection());
+    /** @brief records a property the caller has set, ahead of its
+     *         PropertiesChanged signal
+     *
+     *  @param[in] property - property name
+     *  @param[in] value - the value set
+     */
+    void update(const std::string& property, const ipmi::Value& value)
+    {
+        if (properties)
+        {
+            (*properties)[property] = value;
+            changes++;
+        }
+    }
 
-        auto ipObjectInfo = ipmi::getDbusObject(bus, IP_INTERFACE,
-                                                SETTINGS_ROOT, SETTINGS_MATCH);
+  private:
+    bool load(ipmi::Context::ptr ctx)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now < absentUntil)
+        {
+            return false;
+        }
+        std::string owner;
+        ipmi::PropertyMap props;
+        boost::system::error_code ec = ipmi::getService(ctx, intf, path, owner);
+        if (!ec)
+        {
+            ec = ipmi::getAllDbusProperties(ctx, owner, path, intf, props);
+        }
+        if (ec)
+        {
+            log<level::ERR>("Failed to read the properties",
+                            entry("ERROR=%s", ec.message().c_str()),
+                            entry("PATH=%s", path.c_str()),
+                            entry("INTERFACE=%s", intf.c_str()));
+            absentUntil = now + absentRetry;
+            return false;
+        }
+        properties = std::move(props);
+        service = std::move(owner);
+        changes++;
+        ownerMatch = std::make_unique<sdbusplus::bus::match_t>(
+            *getSdBus(),
+            sdbusplus::bus::match::rules::nameOwnerChanged(service),
+            [this](sdbusplus::message::message&) { invalidate(); });
+        return true;
+    }
 
-        auto macObjectInfo = ipmi::getDbusObject(bus, MAC_INTERFACE,
-                                                 SETTINGS_ROOT, SETTINGS_MATCH);
+    void invalidate()
+    {
+        properties.reset();
+        service.clear();
+        changes++;
+        absentUntil = {};
+        // a match can't be destroyed from its own callback
+        post_work([this]() {
+            if (!properties)
+            {
+                ownerMatch.reset();
+            }
+        });
+    }
 
-        properties = ipmi::getAllDbusProperties(
-            bus, ipObjectInfo.second, ipObjectInfo.first, IP_INTERFACE);
-        auto variant = ipmi::getDbusProperty(bus, macObjectInfo.second,
-                                             macObjectInfo.first, MAC_INTERFACE,
-                                             "MACAddress");
+    std::string path;
+    std::string intf;
+    std::string service;
+    std::optional<ipmi::PropertyMap> properties;
+    std::chrono::steady_clock::time_point absentUntil;
+    uint64_t changes = 0;
+    std::unique_ptr<sdbusplus::bus::match_t> changedMatch;
+    std::unique_ptr<sdbusplus::bus::match_t> addedMatch;
+    std::unique_ptr<sdbusplus::bus::match_t> removedMatch;
+    std::unique_ptr<sdbusplus::bus::match_t> ownerMatch;
+};
 
-        auto ipAddress = std::get<std::string>(properties["Address"]);
+/** @brief gets the cache of an interface, the cache lives as long as ipmid
+ *
+ *  @param[in] path - object path
+ *  @param[in] intf - interface name
+ *
+ *  @return the interface cache
+ */
+InterfaceCache& getInterface(const std::string& path, const std::string& intf)
+{
+    static std::map<std::pair<std::string, std::string>,
+                    std::unique_ptr<InterfaceCache>>
+        interfaces;
+    auto& entry = interfaces[std::make_pair(path, intf)];
+    if (!entry)
+    {
+        entry = std::make_unique<InterfaceCache>(path, intf);
+    }
+    return *entry;
+}
 
-        auto gateway = std::get<std::string>(properties["Gateway"]);
+/** @struct BootSettings
+ *  @brief the boot settings in effect, read together from the interface
+ *         caches of the boot setting objects
+ */
+struct BootSettings
+{
+    Source::Sources source;
+    Type::Types type;
+    Mode::Modes mode;
+    /** @brief the one-time boot source setting is in effect */
+    bool oneTimeEnabled;
+};
 
-        auto prefix = std::get<uint8_t>(properties["PrefixLength"]);
+/** @brief gets a property of the boot setting in effect for an interface,
+ *         the one-time setting if it is enabled, else the regular one
+ *
+ *  @param[in] ctx - ipmi context
+ *  @param[in] iface - boot setting interface
+ *  @param[in] property - property name
+ *  @param[out] oneTimeEnabled - whether the one-time setting is in effect
+ *
+ *  @return the property value, std::nullopt if it can't be read
+ */
+std::optional<std::string> getBootSetting(ipmi::Context::ptr ctx,
+                                          const std::string& iface,
+                                          const std::string& property,
+                                          bool& oneTimeEnabled)
+{
+    constexpr auto enabledIntf = "xyz.openbmc_project.Object.Enable";
 
-        uint8_t isStatic =
-            (std::get<std::string>(properties["Origin"]) ==
-             "xyz.openbmc_project.Network.IP.AddressOrigin.Static")
-                ? 1
-                : 0;
+    const auto [oneTimeSetting, regularSetting] =
+        settings::boot::settingPaths(getObjects(), iface);
+    std::optional<ipmi::Value> enabled =
+        getInterface(oneTimeSetting, enabledIntf).get(ctx, "Enabled");
+    if (!enabled || !std::holds_alternative<bool>(*enabled))
+    {
+        return std::nullopt;
+    }
+    oneTimeEnabled = std::get<bool>(*enabled);
+    std::optional<ipmi::Value> value =
+        getInterface(oneTimeEnabled ? oneTimeSetting : regularSetting, iface)
+            .get(ctx, property);
+    if (!value || !std::holds_alternative<std::string>(*value))
+    {
+        return std::nullopt;
+    }
+    return std::get<std::string>(*value);
+}
 
-        auto MACAddress = std::get<std::string>(variant);
+/** @brief gets the boot settings in effect
+ *
+ *  The settings come from the interface caches, which are kept current by
+ *  the PropertiesChanged signals, so repeated boot option requests cost no
+ *  D-Bus calls.
+ *
+ *  @param[in] ctx - ipmi context
+ *
+ *  @return the boot settings, std::nullopt if they can't be read
+ */
+std::optional<BootSettings> getBootSettings(ipmi::Context::ptr ctx)
+{
+    BootSettings boot;
+    std::optional<std::string> source = getBootSetting(
+        ctx, bootSourceIntf, "BootSource", boot.oneTimeEnabled);
+    if (!source)
+    {
+        log<level::ERR>("getBootSettings: Error in BootSource Get");
+        return std::nullopt;
+    }
+    boot.source = Source::convertSourcesFromString(*source);
 
-        // it is expected here that we should get the valid data
-        // but we may also get the default values.
-        // Validation of the data is done by settings.
-        //
-        // if mac address is default mac address then
-        // don't send blank override.
-        if ((MACAddress == ipmi::network::DEFAULT_MAC_ADDRESS))
-        {
-            rc = -1;
-            return rc;
-        }
-        // if addr is static then ipaddress,gateway,prefix
-        // should not be default one,don't send blank override.
-        if (isStatic)
+    // The boot type interface is not relevant for some Host architectures
+    // (for example POWER), EFI is reported when it is not present.
+    boot.type = Type::Types::EFI;
+    if (getObjects().map.count(bootTypeIntf))
+    {
+        bool oneTime;
+        std::optional<std::string> type =
+            getBootSetting(ctx, bootTypeIntf, "BootType", oneTime);
+        if (!type)
         {
-            if ((ipAddress == ipmi::network::DEFAULT_ADDRESS) ||
-                (gateway == ipmi::network::DEFAULT_ADDRESS) || (!prefix))
-            {
-                rc = -1;
-                return rc;
-            }
+            log<level::ERR>("getBootSettings: Error in BootType Get");
+            return std::nullopt;
         }
+        boot.type = Type::convertTypesFromString(*type);
+    }
 
-        std::string token;
-        std::stringstream ss(MACAddress);
+    bool oneTime;
+    std::optional<std::string> mode =
+        getBootSetting(ctx, bootModeIntf, "BootMode", oneTime);
+    if (!mode)
+    {
+        log<level::ERR>("getBootSettings: Error in BootMode Get");
+        return std::nullopt;
+    }
+    boot.mode = Mode::convertModesFromString(*mode);
+    return boot;
+}
 
-        // First pack macOffset no of bytes in payload.
-        // Latter this PetiBoot-Specific data will be populated.
-        std::vector<uint8_t> payloadInitialBytes(macOffset);
-        payload.pack(payloadInitialBytes);
+} // namespace cache
+} // namespace internal
+} // namespace chassis
 
-        while (std::getline(ss, token, ':'))
-        {
-            payload.pack(stoi(token, nullptr, 16));
-        }
+namespace poh
+{
 
-        payload.pack(0x00);
+constexpr auto minutesPerCount = 60;
 
-        payload.pack(isStatic);
+} // namespace poh
 
-        uint8_t addressFamily = (std::get<std::string>(properties["Type"]) ==
-                                 "xyz.openbmc_project.Network.IP.Protocol.IPv4")
-                                    ? AF_INET
-                                    : AF_INET6;
+namespace chassis
+{
+namespace internal
+{
+namespace cache
+{
 
-        addrSize = (addressFamily == AF_INET)
-                       ? ipmi::network::IPV4_ADDRESS_SIZE_BYTE
-                       : ipmi::network::IPV6_ADDRESS_SIZE_BYTE;
+/** @struct HostNetwork
+ *  @brief the host network settings in the binary form of the OPAL network
+ *         settings boot option, encoded once and kept until the settings
+ *         objects change
+ */
+struct HostNetwork
+{
+    /** @brief the settings objects, looked up on first use */
+    std::optional<ipmi::DbusObjectInfo> ipObject;
+    std::optional<ipmi::DbusObjectInfo> macObject;
+    /** @brief generations of the interface caches the data is encoded from */
+    uint64_t ipGeneration = 0;
+    uint64_t macGeneration = 0;
+    bool encoded = false;
+    /** @brief the encoded data, std::nullopt when the settings hold no
+     *         override worth sending
+     */
+    std::optional<std::vector<uint8_t>> data;
+};
 
-        // ipaddress and gateway would be in IPv4 format
-        std::vector<uint8_t> addrInBinary(addrSize);
-        inet_pton(addressFamily, ipAddress.c_str(),
-                  reinterpret_cast<void*>(addrInBinary.data()));
+HostNetwork hostNetwork;
 
-        payload.pack(addrInBinary);
+/** @brief looks up the host network settings objects
+ *
+ *  TODO There may be cases where an interface is implemented by multiple
+ *  objects, to handle such cases we are interested on that object which are
+ *  on interested busname. Currently mapper doesn't give the readable busname
+ *  (gives busid) so we can't match with bus name so giving some object
+ *  specific info as SETTINGS_MATCH. Later SETTINGS_MATCH will be replaced
+ *  with busname.
+ *
+ *  @return true once both objects are known
+ */
+bool findHostNetworkObjects(ipmi::Context::ptr ctx)
+{
+    for (auto [object, intf] :
+         {std::make_pair(&hostNetwork.ipObject, IP_INTERFACE),
+          std::make_pair(&hostNetwork.macObject, MAC_INTERFACE)})
+    {
+        if (*object)
+        {
+            continue;
+        }
+        ipmi::DbusObjectInfo info;
+        boost::system::error_code ec = ipmi::getDbusObject(
+            ctx, intf, SETTINGS_ROOT, SETTINGS_MATCH, info);
+        if (ec)
+        {
+            log<level::ERR>("Failed to find the host network settings",
+                            entry("INTERFACE=%s", intf),
+                            entry("ERROR=%s", ec.message().c_str()));
+            return false;
+        }
+        *object = std::move(info);
+    }
+    return true;
+}
 
-        payload.pack(prefix);
+/** @brief tells if the encoded data still matches the settings */
+bool hostNetworkCurrent()
+{
+    return hostNetwork.encoded && hostNetwork.ipObject &&
+           hostNetwork.macObject &&
+           getInterface(hostNetwork.ipObject->first, IP_INTERFACE)
+                   .generation() == hostNetwork.ipGeneration &&
+           getInterface(hostNetwork.macObject->first, MAC_INTERFACE)
+                   .generation() == hostNetwork.macGeneration;
+}
 
-        std::vector<uint8_t> gatewayDetails(addrSize);
-        inet_pton(addressFamily, gateway.c_str(),
-                  reinterpret_cast<void*>(gatewayDetails.data()));
-        payload.pack(gatewayDetails);
+/** @brief encodes the host network settings
+ *
+ *  @param[in] ctx - ipmi context
+ *
+ *  @return false if the settings can't be read
+ */
+bool encodeHostNetwork(ipmi::Context::ptr ctx)
+{
+    InterfaceCache& ip =
+        getInterface(hostNetwork.ipObject->first, IP_INTERFACE);
+    InterfaceCache& mac =
+        getInterface(hostNetwork.macObject->first, MAC_INTERFACE);
+
+    auto getString = [ctx](InterfaceCache& cache, const char* property,
+                           std::string& value) {
+        std::optional<ipmi::Value> v = cache.get(ctx, property);
+        if (!v || !std::holds_alternative<std::string>(*v))
+        {
+            log<level::ERR>("Failed to read the host network settings",
+                            entry("PROPERTY=%s", property));
+            return false;
+        }
+        value = std::get<std::string>(*v);
+        return true;
+    };
+    std::string ipAddress, gateway, origin, type, macAddress;
+    if (!getString(ip, "Address", ipAddress) ||
+        !getString(ip, "Gateway", gateway) ||
+        !getString(ip, "Origin", origin) || !getString(ip, "Type", type) ||
+        !getString(mac, "MACAddress", macAddress))
+    {
+        return false;
     }
-    catch (InternalFailure& e)
+    std::optional<ipmi::Value> prefixValue = ip.get(ctx, "PrefixLength");
+    if (!prefixValue || !std::holds_alternative<uint8_t>(*prefixValue))
     {
-        commit<InternalFailure>();
-        rc = -1;
-        return rc;
+        log<level::ERR>("Failed to read the host network prefix length");
+        return false;
     }
+    uint8_t prefix = std::get<uint8_t>(*prefixValue);
 
-    // PetiBoot-Specific
-    // If success then copy the first 9 bytes to the payload message
-    // payload first 2 bytes contain the parameter values. Skip that 2 bytes.
-    uint8_t skipFirstTwoBytes = 2;
-    size_t payloadSize = payload.size();
-    uint8_t* configDataStartingAddress = payload.data() + skipFirstTwoBytes;
+    // the generations are taken after the reads, which may load the caches
+    hostNetwork.ipGeneration = ip.generation();
+    hostNetwork.macGeneration = mac.generation();
+    hostNetwork.encoded = true;
+    hostNetwork.data.reset();
 
-    if (payloadSize < skipFirstTwoBytes + sizeof(netConfInitialBytes))
+    uint8_t isStatic =
+        (origin == "xyz.openbmc_project.Network.IP.AddressOrigin.Static") ? 1
+                                                                          : 0;
+
+    // it is expected here that we should get the valid data
+    // but we may also get the default values.
+    // Validation of the data is done by settings.
+    //
+    // if mac address is default mac address then
+    // don't send blank override.
+    if (macAddress == ipmi::network::DEFAULT_MAC_ADDRESS)
     {
-        log<level::ERR>("Invalid net config ");
-        rc = -1;
-        return rc;
+        return true;
     }
-    std::copy(netConfInitialBytes,
-              netConfInitialBytes + sizeof(netConfInitialBytes),
-              configDataStartingAddress);
-
-    if (payloadSize < skipFirstTwoBytes + addrSizeOffset + sizeof(addrSize))
+    // if addr is static then ipaddress,gateway,prefix
+    // should not be default one,don't send blank override.
+    if (isStatic && ((ipAddress == ipmi::network::DEFAULT_ADDRESS) ||
+                     (gateway == ipmi::network::DEFAULT_ADDRESS) || !prefix))
     {
-        log<level::ERR>("Invalid length of address size");
-        rc = -1;
-        return rc;
+        return true;
     }
-    std::copy(&addrSize, &(addrSize) + sizeof(addrSize),
-              configDataStartingAddress + addrSizeOffset);
 
-#ifdef _IPMI_DEBUG_
-    std::printf("\n===Printing the IPMI Formatted Data========\n");
+    int family = (type == "xyz.openbmc_project.Network.IP.Protocol.IPv4")
+                     ? AF_INET
+                     : AF_INET6;
+    uint8_t addrSize = (family == AF_INET)
+                           ? ipmi::network::IPV4_ADDRESS_SIZE_BYTE
+                           : ipmi::network::IPV6_ADDRESS_SIZE_BYTE;
 
-    for (uint8_t pos = 0; pos < index; pos++)
+    // PetiBoot-Specific header, cookie, version and address size
+    std::vector<uint8_t> data(netConfInitialBytes,
+                              netConfInitialBytes +
+                                  sizeof(netConfInitialBytes));
+    data.push_back(addrSize);
+
+    std::string token;
+    std::stringstream ss(macAddress);
+    while (std::getline(ss, token, ':') && data.size() < addrTypeOffset - 1)
     {
-        std::printf("%02x ", payloadStartingAddress[pos]);
+        data.push_back(static_cast<uint8_t>(std::stoul(token, nullptr, 16)));
     }
-#endif
+    data.resize(addrTypeOffset - 1);
+    data.push_back(0x00);
+    data.push_back(isStatic);
+
+    // ipaddress and gateway would be in IPv4 format
+    size_t addr = data.size();
+    data.resize(addr + addrSize);
+    inet_pton(family, ipAddress.c_str(), data.data() + addr);
+    data.push_back(prefix);
+    addr = data.size();
+    data.resize(addr + addrSize);
+    inet_pton(family, gateway.c_str(), data.data() + addr);
 
-    return rc;
+    hostNetwork.data = std::move(data);
+    return true;
+}
+
+} // namespace cache
+} // namespace internal
+} // namespace chassis
+
+/** @brief packs the OPAL network settings boot option, encoded only when the
+ *         settings changed since the last request
+ *
+ *  @param[in] ctx - ipmi context
+ *  @param[out] payload - the response, the data is appended
+ *
+ *  @return 0 on success, -1 if the settings hold no override or can't be
+ *          read
+ */
+int getHostNetworkData(ipmi::Context::ptr ctx, ipmi::message::Payload& payload)
+{
+    namespace cache = chassis::internal::cache;
+    try
+    {
+        if (!cache::hostNetworkCurrent() &&
+            (!cache::findHostNetworkObjects(ctx) ||
+             !cache::encodeHostNetwork(ctx)))
+        {
+            return -1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Invalid host network settings",
+                        entry("ERROR=%s", e.what()));
+        return -1;
+    }
+    if (!cache::hostNetwork.data)
+    {
+        return -1;
+    }
+    payload.pack(*cache::hostNetwork.data);
+    return 0;
 }
 
 /** @brief convert IPv4 and IPv6 addresses from binary to text form.
@@ -362,13 +726,12 @@ std::string getAddrStr(uint8_t family, uint8_t* data, uint8_t offset,
     return ipAddr;
 }
 
-ipmi::Cc setHostNetworkData(ipmi::message::Payload& data)
+ipmi::Cc setHostNetworkData(ipmi::Context::ptr ctx,
+                            ipmi::message::Payload& data)
 {
-    using namespace std::string_literals;
-    std::string hostNetworkConfig;
+    namespace cache = chassis::internal::cache;
     std::string mac("00:00:00:00:00:00");
     std::string ipAddress, gateway;
-    std::string addrOrigin{0};
     uint8_t addrSize{0};
     std::string addressOrigin =
         "xyz.openbmc_project.Network.IP.AddressOrigin.DHCP";
@@ -379,196 +742,177 @@ ipmi::Cc setHostNetworkData(ipmi::message::Payload& data)
     // cookie starts from second byte
     // version starts from sixth byte
 
-    try
+    data.trailingOk = true;
+    auto msgLen = data.size();
+    std::vector<uint8_t> msgPayloadBytes(msgLen);
+    if (data.unpack(msgPayloadBytes) != 0 || !data.fullyUnpacked())
     {
-        do
-        {
-            // cookie ==  0x21 0x70 0x62 0x21
-            data.trailingOk = true;
-            auto msgLen = data.size();
-            std::vector<uint8_t> msgPayloadBytes(msgLen);
-            if (data.unpack(msgPayloadBytes) != 0 || !data.fullyUnpacked())
-            {
-                log<level::ERR>(
-                    "Error in unpacking message of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-
-            uint8_t* msgPayloadStartingPos = msgPayloadBytes.data();
-            constexpr size_t cookieSize = 4;
-            if (msgLen < cookieOffset + cookieSize)
-            {
-                log<level::ERR>(
-                    "Error in cookie getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-            if (std::equal(msgPayloadStartingPos + cookieOffset,
-                           msgPayloadStartingPos + cookieOffset + cookieSize,
-                           (netConfInitialBytes + cookieOffset)) != 0)
-            {
-                // all cookie == 0
-                if (std::all_of(msgPayloadStartingPos + cookieOffset,
-                                msgPayloadStartingPos + cookieOffset +
-                                    cookieSize,
-                                [](int i) { return i == 0; }) == true)
-                {
-                    // need to zero out the network settings.
-                    break;
-                }
-
-                log<level::ERR>("Invalid Cookie");
-                elog<InternalFailure>();
-            }
-
-            // vesion == 0x00 0x01
-            if (msgLen < versionOffset + sizeVersion)
-            {
-                log<level::ERR>(
-                    "Error in version getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-            if (std::equal(msgPayloadStartingPos + versionOffset,
-                           msgPayloadStartingPos + versionOffset + sizeVersion,
-                           (netConfInitialBytes + versionOffset)) != 0)
-            {
-                log<level::ERR>("Invalid Version");
-                elog<InternalFailure>();
-            }
+        log<level::ERR>("Error in unpacking message of setHostNetworkData");
+        return ipmi::ccReqDataLenInvalid;
+    }
 
-            if (msgLen < macOffset + 6)
-            {
-                log<level::ERR>(
-                    "Error in mac address getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-            std::stringstream result;
-            std::copy((msgPayloadStartingPos + macOffset),
-                      (msgPayloadStartingPos + macOffset + 5),
-                      std::ostream_iterator<int>(result, ":"));
-            mac = result.str();
+    // the settings are what the host asks for already, nothing to write
+    if (cache::hostNetworkCurrent() && cache::hostNetwork.data &&
+        *cache::hostNetwork.data == msgPayloadBytes)
+    {
+        return ipmi::ccSuccess;
+    }
 
-            if (msgLen < addrTypeOffset + sizeof(decltype(addrOrigin)))
+    do
+    {
+        // cookie ==  0x21 0x70 0x62 0x21
+        uint8_t* msgPayloadStartingPos = msgPayloadBytes.data();
+        constexpr size_t cookieSize = 4;
+        if (msgLen < cookieOffset + cookieSize)
+        {
+            log<level::ERR>("Error in cookie getting of setHostNetworkData");
+            return ipmi::ccReqDataLenInvalid;
+        }
+        if (!std::equal(msgPayloadStartingPos + cookieOffset,
+                        msgPayloadStartingPos + cookieOffset + cookieSize,
+                        (netConfInitialBytes + cookieOffset)))
+        {
+            // all cookie == 0
+            if (std::all_of(msgPayloadStartingPos + cookieOffset,
+                            msgPayloadStartingPos + cookieOffset + cookieSize,
+                            [](int i) { return i == 0; }))
             {
-                log<level::ERR>(
-                    "Error in original address getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
+                // need to zero out the network settings.
+                break;
             }
-            std::copy(msgPayloadStartingPos + addrTypeOffset,
-                      msgPayloadStartingPos + addrTypeOffset +
-                          sizeof(decltype(addrOrigin)),
-                      std::ostream_iterator<int>(result, ""));
-            addrOrigin = result.str();
 
-            if (!addrOrigin.empty())
-            {
-                addressOrigin =
-                    "xyz.openbmc_project.Network.IP.AddressOrigin.Static";
-            }
+            log<level::ERR>("Invalid Cookie");
+            return ipmi::ccInvalidFieldRequest;
+        }
 
-            if (msgLen < addrSizeOffset + sizeof(decltype(addrSize)))
-            {
-                log<level::ERR>(
-                    "Error in address size getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-            // Get the address size
-            std::copy(msgPayloadStartingPos + addrSizeOffset,
-                      (msgPayloadStartingPos + addrSizeOffset +
-                       sizeof(decltype(addrSize))),
-                      &addrSize);
-
-            uint8_t prefixOffset = ipAddrOffset + addrSize;
-            if (msgLen < prefixOffset + sizeof(decltype(prefix)))
-            {
-                log<level::ERR>(
-                    "Error in prefix getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-            std::copy(msgPayloadStartingPos + prefixOffset,
-                      (msgPayloadStartingPos + prefixOffset +
-                       sizeof(decltype(prefix))),
-                      &prefix);
+        // vesion == 0x00 0x01
+        if (msgLen < versionOffset + sizeVersion)
+        {
+            log<level::ERR>("Error in version getting of setHostNetworkData");
+            return ipmi::ccReqDataLenInvalid;
+        }
+        if (!std::equal(msgPayloadStartingPos + versionOffset,
+                        msgPayloadStartingPos + versionOffset + sizeVersion,
+                        (netConfInitialBytes + versionOffset)))
+        {
+            log<level::ERR>("Invalid Version");
+            return ipmi::ccInvalidFieldRequest;
+        }
 
-            uint8_t gatewayOffset = prefixOffset + sizeof(decltype(prefix));
-            if (addrSize != ipmi::network::IPV4_ADDRESS_SIZE_BYTE)
-            {
-                addressType = "xyz.openbmc_project.Network.IP.Protocol.IPv6";
-                family = AF_INET6;
-            }
+        constexpr size_t macSize = 6;
+        if (msgLen < macOffset + macSize)
+        {
+            log<level::ERR>(
+                "Error in mac address getting of setHostNetworkData");
+            return ipmi::ccReqDataLenInvalid;
+        }
+        const uint8_t* macBytes = msgPayloadStartingPos + macOffset;
+        char macText[sizeof("00:00:00:00:00:00")];
+        std::snprintf(macText, sizeof(macText),
+                      "%02x:%02x:%02x:%02x:%02x:%02x", macBytes[0],
+                      macBytes[1], macBytes[2], macBytes[3], macBytes[4],
+                      macBytes[5]);
+        mac = macText;
+
+        if (msgLen < addrTypeOffset + 1)
+        {
+            log<level::ERR>(
+                "Error in original address getting of setHostNetworkData");
+            return ipmi::ccReqDataLenInvalid;
+        }
+        if (msgPayloadStartingPos[addrTypeOffset] != 0)
+        {
+            addressOrigin =
+                "xyz.openbmc_project.Network.IP.AddressOrigin.Static";
+        }
 
-            if (msgLen < ipAddrOffset + addrSize)
-            {
-                log<level::ERR>(
-                    "Error in IP address getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-            ipAddress = getAddrStr(family, msgPayloadStartingPos, ipAddrOffset,
-                                   addrSize);
+        // Get the address size
+        addrSize = msgPayloadStartingPos[addrSizeOffset];
 
-            if (msgLen < gatewayOffset + addrSize)
-            {
-                log<level::ERR>(
-                    "Error in gateway address getting of setHostNetworkData");
-                return ipmi::ccReqDataLenInvalid;
-            }
-            gateway = getAddrStr(family, msgPayloadStartingPos, gatewayOffset,
-                                 addrSize);
+        size_t prefixOffset = ipAddrOffset + addrSize;
+        if (msgLen < prefixOffset + sizeof(decltype(prefix)))
+        {
+            log<level::ERR>("Error in prefix getting of setHostNetworkData");
+            return ipmi::ccReqDataLenInvalid;
+        }
+        prefix = msgPayloadStartingPos[prefixOffset];
 
-        } while (0);
+        size_t gatewayOffset = prefixOffset + sizeof(decltype(prefix));
+        if (addrSize != ipmi::network::IPV4_ADDRESS_SIZE_BYTE)
+        {
+            addressType = "xyz.openbmc_project.Network.IP.Protocol.IPv6";
+            family = AF_INET6;
+        }
 
-        // Cookie == 0 or it is a valid cookie
-        hostNetworkConfig += "ipaddress="s + ipAddress + ",prefix="s +
-                             std::to_string(prefix) + ",gateway="s + gateway +
-                             ",mac="s + mac + ",addressOrigin="s +
-                             addressOrigin;
+        if (msgLen < gatewayOffset + addrSize)
+        {
+            log<level::ERR>(
+                "Error in gateway address getting of setHostNetworkData");
+            return ipmi::ccReqDataLenInvalid;
+        }
+        ipAddress = getAddrStr(family, msgPayloadStartingPos, ipAddrOffset,
+                               addrSize);
+        gateway = getAddrStr(family, msgPayloadStartingPos, gatewayOffset,
+                             addrSize);
 
-        sdbusplus::bus::bus bus(ipmid_get_sd_bus_connection());
+    } while (0);
 
-        auto ipObjectInfo = ipmi::getDbusObject(bus, IP_INTERFACE,
-                                                SETTINGS_ROOT, SETTINGS_MATCH);
-        auto macObjectInfo = ipmi::getDbusObject(bus, MAC_INTERFACE,
-                                                 SETTINGS_ROOT, SETTINGS_MATCH);
-        // set the dbus property
-        ipmi::setDbusProperty(bus, ipObjectInfo.second, ipObjectInfo.first,
-                              IP_INTERFACE, "Address", std::string(ipAddress));
-        ipmi::setDbusProperty(bus, ipObjectInfo.second, ipObjectInfo.first,
-                              IP_INTERFACE, "PrefixLength", prefix);
-        ipmi::setDbusProperty(bus, ipObjectInfo.second, ipObjectInfo.first,
-                              IP_INTERFACE, "Origin", addressOrigin);
-        ipmi::setDbusProperty(bus, ipObjectInfo.second, ipObjectInfo.first,
-                              IP_INTERFACE, "Gateway", std::string(gateway));
-        ipmi::setDbusProperty(
-            bus, ipObjectInfo.second, ipObjectInfo.first, IP_INTERFACE, "Type",
-            std::string("xyz.openbmc_project.Network.IP.Protocol.IPv4"));
-        ipmi::setDbusProperty(bus, macObjectInfo.second, macObjectInfo.first,
-                              MAC_INTERFACE, "MACAddress", std::string(mac));
-
-        log<level::DEBUG>("Network configuration changed",
-                          entry("NETWORKCONFIG=%s", hostNetworkConfig.c_str()));
+    if (!cache::findHostNetworkObjects(ctx))
+    {
+        return ipmi::ccUnspecifiedError;
     }
-    catch (sdbusplus::exception_t& e)
+    const auto& [ipPath, ipService] = *cache::hostNetwork.ipObject;
+    const auto& [macPath, macService] = *cache::hostNetwork.macObject;
+
+    // Cookie == 0 or it is a valid cookie, set the dbus properties; the
+    // encoded data is rebuilt from their PropertiesChanged signals
+    std::initializer_list<std::pair<const char*, ipmi::Value>> ipProperties = {
+        {"Address", ipAddress},
+        {"PrefixLength", prefix},
+        {"Origin", addressOrigin},
+        {"Gateway", gateway},
+        {"Type", addressType}};
+    for (const auto& [property, value] : ipProperties)
+    {
+        boost::system::error_code ec = ipmi::setDbusProperty(
+            ctx, ipService, ipPath, IP_INTERFACE, property, value);
+        if (ec)
+        {
+            log<level::ERR>("Error in ipmiChassisSetSysBootOptions call",
+                            entry("PROPERTY=%s", property),
+                            entry("ERROR=%s", ec.message().c_str()));
+            return ipmi::ccUnspecifiedError;
+        }
+    }
+    boost::system::error_code ec = ipmi::setDbusProperty(
+        ctx, macService, macPath, MAC_INTERFACE, "MACAddress", mac);
+    if (ec)
     {
-        commit<InternalFailure>();
-        log<level::ERR>("Error in  ipmiChassisSetSysBootOptions call");
+        log<level::ERR>("Error in ipmiChassisSetSysBootOptions call",
+                        entry("PROPERTY=%s", "MACAddress"),
+                        entry("ERROR=%s", ec.message().c_str()));
         return ipmi::ccUnspecifiedError;
     }
 
+    log<level::DEBUG>("Network configuration changed",
+                      entry("IPADDRESS=%s", ipAddress.c_str()),
+                      entry("PREFIX=%u", prefix),
+                      entry("GATEWAY=%s", gateway.c_str()),
+                      entry("MAC=%s", mac.c_str()),
+                      entry("ORIGIN=%s", addressOrigin.c_str()));
     return ipmi::ccSuccess;
 }
 
 uint32_t getPOHCounter()
 {
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+    auto& bus = *getSdBus();
 
     auto chassisStateObj =
         ipmi::getDbusObject(bus, chassisPOHStateIntf, chassisStateRoot, match);
 
-    auto service =
-        ipmi::getService(bus, chassisPOHStateIntf, chassisStateObj.first);
-
-    auto propValue =
-        ipmi::getDbusProperty(bus, service, chassisStateObj.first,
-                              chassisPOHStateIntf, pohCounterProperty);
+    auto propValue = ipmi::getDbusProperty(
+        bus, chassisStateObj.second, chassisStateObj.first,
+        chassisPOHStateIntf, pohCounterProperty, trackedProperties);
 
     return std::get<uint32_t>(propValue);
 }
@@ -599,7 +943,7 @@ ipmi::RspType<bool,    // chassis intrusion sensor
     ipmi::PropertyMap properties;
     try
     {
-        sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+        auto& bus = *getSdBus();
 
         ipmi::DbusObjectInfo chassisCapObject =
             ipmi::getDbusObject(bus, chassisCapIntf);
@@ -616,9 +960,9 @@ ipmi::RspType<bool,    // chassis intrusion sensor
         // [0] -1b = Chassis provides intrusion (physical security) sensor.
         // set to default value 0x0.
 
-        properties =
-            ipmi::getAllDbusProperties(bus, chassisCapObject.second,
-                                       chassisCapObject.first, chassisCapIntf);
+        properties = ipmi::getAllDbusProperties(
+            bus, chassisCapObject.second, chassisCapObject.first,
+            chassisCapIntf, trackedProperties);
     }
     catch (std::exception& e)
     {
@@ -798,77 +1142,176 @@ ipmi::RspType<> ipmiSetChassisCap(bool intrusion, bool fpLockout,
                               chassisCapObject.first, chassisCapIntf,
                               chassisBridgeDevAddrProp, bridgeDeviceAddr);
     }
-    catch (std::exception& e)
+    catch (std::exception& e)
+    {
+        log<level::ERR>(e.what());
+        return ipmi::responseUnspecifiedError();
+    }
+    return ipmi::responseSuccess();
+}
+
+// OpenBMC Host State Manager dbus framework
+static constexpr auto hostStatePath = "/xyz/openbmc_project/state/host0";
+static constexpr auto hostStateIntf = "xyz.openbmc_project.State.Host";
+
+/** @struct TransitionStatus
+ *
+ *  Host transition requested through Chassis Control. It completes when the
+ *  host state manager reports the target host state, for a reboot after the
+ *  host left the Running state first.
+ */
+struct TransitionStatus
+{
+    static constexpr uint8_t noCommand = 0xFF;
+
+    bool inProgress = false;
+    uint8_t command = noCommand; //!< chassis control command
+    std::string target;          //!< host state that completes the transition
+    bool reboot = false;
+    bool leftRunning = false;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration latency{};
+};
+
+static TransitionStatus transitionStatus;
+static std::unique_ptr<sdbusplus::bus::match_t> hostStateMatch;
+
+/** @brief Updates the transition in progress with a new host state
+ *
+ *  @param[in] hostState - CurrentHostState property value
+ */
+static void updateTransition(const std::string& hostState)
+{
+    if (!transitionStatus.inProgress)
+    {
+        return;
+    }
+    if (transitionStatus.reboot && !transitionStatus.leftRunning)
     {
-        log<level::ERR>(e.what());
-        return ipmi::responseUnspecifiedError();
+        transitionStatus.leftRunning =
+            hostState !=
+            State::convertForMessage(State::Host::HostState::Running);
+        return;
     }
-    return ipmi::responseSuccess();
+    if (hostState != transitionStatus.target)
+    {
+        return;
+    }
+    transitionStatus.inProgress = false;
+    transitionStatus.latency =
+        std::chrono::steady_clock::now() - transitionStatus.start;
+    log<level::INFO>(
+        "Chassis transition complete",
+        entry("COMMAND=0x%X", transitionStatus.command),
+        entry("LATENCY_MS=%lld",
+              static_cast<long long>(
+                  std::chrono::duration_cast<std::chrono::milliseconds>(
+                      transitionStatus.latency)
+                      .count())));
+}
+
+/** @brief Starts tracking a host transition
+ *
+ *  @param[in] command - chassis control command
+ *  @param[in] transition - requested host transition
+ */
+static void trackTransition(uint8_t command,
+                            State::Host::Transition transition)
+{
+    if (!hostStateMatch)
+    {
+        hostStateMatch = std::make_unique<sdbusplus::bus::match_t>(
+            *getSdBus(),
+            sdbusplus::bus::match::rules::propertiesChanged(hostStatePath,
+                                                            hostStateIntf),
+            [](sdbusplus::message::message& msg) {
+                std::string interface;
+                ipmi::PropertyMap properties;
+                try
+                {
+                    msg.read(interface, properties);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                auto state = properties.find("CurrentHostState");
+                if (state == properties.end())
+                {
+                    return;
+                }
+                if (auto value = std::get_if<std::string>(&state->second))
+                {
+                    updateTransition(*value);
+                }
+            });
+    }
+
+    transitionStatus.inProgress = true;
+    transitionStatus.command = command;
+    transitionStatus.reboot = transition == State::Host::Transition::Reboot;
+    transitionStatus.leftRunning = false;
+    transitionStatus.target = State::convertForMessage(
+        transition == State::Host::Transition::Off
+            ? State::Host::HostState::Off
+            : State::Host::HostState::Running);
+    transitionStatus.start = std::chrono::steady_clock::now();
 }
 
 //------------------------------------------
 // Calls into Host State Manager Dbus object
 //------------------------------------------
-int initiate_state_transition(State::Host::Transition transition)
+int initiate_state_transition(ipmi::Context::ptr ctx, uint8_t command,
+                              State::Host::Transition transition)
 {
-    // OpenBMC Host State Manager dbus framework
-    constexpr auto HOST_STATE_MANAGER_ROOT = "/xyz/openbmc_project/state/host0";
-    constexpr auto HOST_STATE_MANAGER_IFACE = "xyz.openbmc_project.State.Host";
-    constexpr auto DBUS_PROPERTY_IFACE = "org.freedesktop.DBus.Properties";
     constexpr auto PROPERTY = "RequestedHostTransition";
 
-    // sd_bus error
-    int rc = 0;
-    char* busname = NULL;
-
-    // SD Bus error report mechanism.
-    sd_bus_error bus_error = SD_BUS_ERROR_NULL;
-
-    // Gets a hook onto either a SYSTEM or SESSION bus
-    sd_bus* bus_type = ipmid_get_sd_bus_connection();
-    rc = mapper_get_service(bus_type, HOST_STATE_MANAGER_ROOT, &busname);
-    if (rc < 0)
+    std::string service;
+    boost::system::error_code ec =
+        ipmi::getService(ctx, hostStateIntf, hostStatePath, service);
+    if (ec)
     {
-        log<level::ERR>(
-            "Failed to get bus name",
-            entry("ERRNO=0x%X, OBJPATH=%s", -rc, HOST_STATE_MANAGER_ROOT));
-        return rc;
+        log<level::ERR>("Failed to get bus name",
+                        entry("ERROR=%s", ec.message().c_str()),
+                        entry("OBJPATH=%s", hostStatePath));
+        return -1;
     }
 
     // Convert to string equivalent of the passed in transition enum.
     auto request = State::convertForMessage(transition);
 
-    rc = sd_bus_call_method(bus_type,                // On the system bus
-                            busname,                 // Service to contact
-                            HOST_STATE_MANAGER_ROOT, // Object path
-                            DBUS_PROPERTY_IFACE,     // Interface name
-                            "Set",                   // Method to be called
-                            &bus_error,              // object to return error
-                            nullptr,                 // Response buffer if any
-                            "ssv",                   // Takes 3 arguments
-                            HOST_STATE_MANAGER_IFACE, PROPERTY, "s",
-                            request.c_str());
-    if (rc < 0)
+    // watch before the request, so that no state change can be missed
+    trackTransition(command, transition);
+    ec = ipmi::setDbusProperty(ctx, service, hostStatePath, hostStateIntf,
+                               PROPERTY, request);
+    if (ec)
     {
+        transitionStatus.inProgress = false;
         log<level::ERR>("Failed to initiate transition",
-                        entry("ERRNO=0x%X, REQUEST=%s", -rc, request.c_str()));
+                        entry("ERROR=%s", ec.message().c_str()),
+                        entry("REQUEST=%s", request.c_str()));
+        return -1;
     }
-    else
+    log<level::INFO>("Transition request initiated successfully");
+
+    // the host may already be in the requested state
+    if (!transitionStatus.reboot)
     {
-        log<level::INFO>("Transition request initiated successfully");
+        std::string hostState;
+        if (!ipmi::getDbusProperty(ctx, service, hostStatePath, hostStateIntf,
+                                   "CurrentHostState", hostState))
+        {
+            updateTransition(hostState);
+        }
     }
-
-    sd_bus_error_free(&bus_error);
-    free(busname);
-
-    return rc;
+    return 0;
 }
 
 //------------------------------------------
 // Set Enabled property to inform NMI source
 // handling to trigger a NMI_OUT BSOD.
 //------------------------------------------
-int setNmiProperty(const bool value)
+int setNmiProperty(ipmi::Context::ptr ctx, const bool value)
 {
     constexpr const char* nmiSourceObjPath =
         "/xyz/openbmc_project/Chassis/Control/NMISource";
@@ -876,20 +1319,25 @@ int setNmiProperty(const bool value)
         "xyz.openbmc_project.Chassis.Control.NMISource";
     std::string bmcSourceSignal = "xyz.openbmc_project.Chassis.Control."
                                   "NMISource.BMCSourceSignal.ChassisCmd";
-    std::shared_ptr<sdbusplus::asio::connection> busp = getSdBus();
 
-    try
+    std::string service;
+    boost::system::error_code ec =
+        ipmi::getService(ctx, nmiSourceIntf, nmiSourceObjPath, service);
+    if (!ec)
     {
-        auto service = ipmi::getService(*busp, nmiSourceIntf, nmiSourceObjPath);
-        ipmi::setDbusProperty(*busp, service, nmiSourceObjPath, nmiSourceIntf,
-                              "BMCSource", bmcSourceSignal);
-        ipmi::setDbusProperty(*busp, service, nmiSourceObjPath, nmiSourceIntf,
-                              "Enabled", value);
+        ec = ipmi::setDbusProperty(ctx, service, nmiSourceObjPath,
+                                   nmiSourceIntf, "BMCSource",
+                                   bmcSourceSignal);
     }
-    catch (std::exception& e)
+    if (!ec)
+    {
+        ec = ipmi::setDbusProperty(ctx, service, nmiSourceObjPath,
+                                   nmiSourceIntf, "Enabled", value);
+    }
+    if (ec)
     {
         log<level::ERR>("Failed to trigger NMI_OUT",
-                        entry("EXCEPTION=%s", e.what()));
+                        entry("ERROR=%s", ec.message().c_str()));
         return -1;
     }
 
@@ -913,7 +1361,7 @@ static constexpr uint8_t allSupport = 0x01 | 0x02 | 0x04;
 
 /* helper function for Get Chassis Status Command
  */
-std::optional<uint2_t> getPowerRestorePolicy()
+std::optional<uint2_t> getPowerRestorePolicy(ipmi::Context::ptr ctx)
 {
     uint2_t restorePolicy = 0;
     using namespace chassis::internal;
@@ -924,13 +1372,15 @@ std::optional<uint2_t> getPowerRestorePolicy()
     {
         const auto& powerRestoreSetting =
             objects.map.at(powerRestoreIntf).front();
-        ipmi::Value result = ipmi::getDbusProperty(
-            *getSdBus(),
-            objects.service(powerRestoreSetting, powerRestoreIntf).c_str(),
-            powerRestoreSetting.c_str(), powerRestoreIntf,
-            "PowerRestorePolicy");
+        std::optional<ipmi::Value> result =
+            cache::getInterface(powerRestoreSetting, powerRestoreIntf)
+                .get(ctx, "PowerRestorePolicy");
+        if (!result)
+        {
+            return std::nullopt;
+        }
         auto powerRestore = RestorePolicy::convertPolicyFromString(
-            std::get<std::string>(result));
+            std::get<std::string>(*result));
         restorePolicy = dbusToIpmi.at(powerRestore);
     }
     catch (const std::exception& e)
@@ -950,49 +1400,40 @@ std::optional<uint2_t> getPowerRestorePolicy()
  * helper function for Get Chassis Status Command
  * return - optional value for pgood (no value on error)
  */
-std::optional<bool> getPowerStatus()
+std::optional<bool> getPowerStatus(ipmi::Context::ptr ctx)
 {
-    bool powerGood = false;
-    std::shared_ptr<sdbusplus::asio::connection> busp = getSdBus();
-    try
-    {
-        constexpr const char* chassisStatePath =
-            "/xyz/openbmc_project/state/chassis0";
-        constexpr const char* chassisStateIntf =
-            "xyz.openbmc_project.State.Chassis";
-        auto service =
-            ipmi::getService(*busp, chassisStateIntf, chassisStatePath);
-
-        ipmi::Value powerState =
-            ipmi::getDbusProperty(*busp, service, chassisStatePath,
-                                  chassisStateIntf, "CurrentPowerState");
-        powerGood = std::get<std::string>(powerState) ==
-                    "xyz.openbmc_project.State.Chassis.PowerState.On";
-    }
-    catch (const std::exception& e)
-    {
-        try
+    using namespace chassis::internal;
+    constexpr const char* chassisStatePath =
+        "/xyz/openbmc_project/state/chassis0";
+    constexpr const char* chassisStateIntf =
+        "xyz.openbmc_project.State.Chassis";
+    std::optional<ipmi::Value> powerState =
+        cache::getInterface(chassisStatePath, chassisStateIntf)
+            .get(ctx, "CurrentPowerState");
+    if (powerState)
+    {
+        if (auto state = std::get_if<std::string>(&*powerState))
         {
-            // FIXME: some legacy modules use the older path; try that next
-            constexpr const char* legacyPwrCtrlObj =
-                "/org/openbmc/control/power0";
-            constexpr const char* legacyPwrCtrlIntf =
-                "org.openbmc.control.Power";
-            auto service =
-                ipmi::getService(*busp, legacyPwrCtrlIntf, legacyPwrCtrlObj);
-
-            ipmi::Value variant = ipmi::getDbusProperty(
-                *busp, service, legacyPwrCtrlObj, legacyPwrCtrlIntf, "pgood");
-            powerGood = static_cast<bool>(std::get<int>(variant));
+            return *state == "xyz.openbmc_project.State.Chassis.PowerState.On";
         }
-        catch (const std::exception& e)
+    }
+
+    // FIXME: some legacy modules use the older path; try that next
+    constexpr const char* legacyPwrCtrlObj = "/org/openbmc/control/power0";
+    constexpr const char* legacyPwrCtrlIntf = "org.openbmc.control.Power";
+    std::optional<ipmi::Value> pgood =
+        cache::getInterface(legacyPwrCtrlObj, legacyPwrCtrlIntf)
+            .get(ctx, "pgood");
+    if (pgood)
+    {
+        if (auto value = std::get_if<int>(&*pgood))
         {
-            log<level::ERR>("Failed to fetch pgood property",
-                            entry("ERROR=%s", e.what()));
-            return std::nullopt;
+            return static_cast<bool>(*value);
         }
     }
-    return std::make_optional(powerGood);
+
+    log<level::ERR>("Failed to fetch pgood property");
+    return std::nullopt;
 }
 
 /*
@@ -1000,54 +1441,45 @@ std::optional<bool> getPowerStatus()
  * helper function for Get Chassis Status Command
  * return - bool value for ACFail (false on error)
  */
-bool getACFailStatus()
+bool getACFailStatus(ipmi::Context::ptr ctx)
 {
+    using namespace chassis::internal;
     constexpr const char* powerControlObj =
         "/xyz/openbmc_project/Chassis/Control/Power0";
     constexpr const char* powerControlIntf =
         "xyz.openbmc_project.Chassis.Control.Power";
-    bool acFail = false;
-    std::shared_ptr<sdbusplus::asio::connection> bus = getSdBus();
-    try
-    {
-        auto service =
-            ipmi::getService(*bus, powerControlIntf, powerControlObj);
-
-        ipmi::Value variant = ipmi::getDbusProperty(
-            *bus, service, powerControlObj, powerControlIntf, "PFail");
-        acFail = std::get<bool>(variant);
-    }
-    catch (const std::exception& e)
+    std::optional<ipmi::Value> acFail =
+        cache::getInterface(powerControlObj, powerControlIntf)
+            .get(ctx, "PFail");
+    if (acFail)
     {
-        log<level::ERR>("Failed to fetch PFail property",
-                        entry("ERROR=%s", e.what()),
-                        entry("PATH=%s", powerControlObj),
-                        entry("INTERFACE=%s", powerControlIntf));
+        if (auto value = std::get_if<bool>(&*acFail))
+        {
+            return *value;
+        }
     }
-    return acFail;
+    return false;
 }
 } // namespace power_policy
 
-static std::optional<bool> getButtonEnabled(const std::string& buttonPath,
+static std::optional<bool> getButtonEnabled(ipmi::Context::ptr ctx,
+                                            const std::string& buttonPath,
                                             const std::string& buttonIntf)
 {
-    std::shared_ptr<sdbusplus::asio::connection> busp = getSdBus();
-    bool buttonDisabled = false;
-    try
+    using namespace chassis::internal;
+    std::optional<ipmi::Value> enabled =
+        cache::getInterface(buttonPath, buttonIntf).get(ctx, "Enabled");
+    if (!enabled)
     {
-        auto service = ipmi::getService(*busp, buttonIntf, buttonPath);
-        ipmi::Value enabled = ipmi::getDbusProperty(*busp, service, buttonPath,
-                                                    buttonIntf, "Enabled");
-        buttonDisabled = !std::get<bool>(enabled);
+        return std::nullopt;
     }
-    catch (sdbusplus::exception::SdBusError& e)
+    auto value = std::get_if<bool>(&*enabled);
+    if (!value)
     {
-        log<level::ERR>("Fail to get button Enabled property",
-                        entry("PATH=%s", buttonPath.c_str()),
-                        entry("ERROR=%s", e.what()));
         return std::nullopt;
     }
-    return std::make_optional(buttonDisabled);
+    // return whether the button is disabled
+    return std::make_optional(!*value);
 }
 
 static bool setButtonEnabled(ipmi::Context::ptr& ctx,
@@ -1108,12 +1540,12 @@ ipmi::RspType<bool,    // Power is on
               bool, // Diagnostic Interrupt button disable allowed
               bool  // Standby (sleep) button disable allowed
               >
-    ipmiGetChassisStatus()
+    ipmiGetChassisStatus(ipmi::Context::ptr ctx)
 {
     using namespace chassis::internal;
     std::optional<uint2_t> restorePolicy =
-        power_policy::getPowerRestorePolicy();
-    std::optional<bool> powerGood = power_policy::getPowerStatus();
+        power_policy::getPowerRestorePolicy(ctx);
+    std::optional<bool> powerGood = power_policy::getPowerStatus(ctx);
     if (!restorePolicy || !powerGood)
     {
         return ipmi::responseUnspecifiedError();
@@ -1121,7 +1553,7 @@ ipmi::RspType<bool,    // Power is on
 
     //  Front Panel Button Capabilities and disable/enable status(Optional)
     std::optional<bool> powerButtonReading =
-        getButtonEnabled(powerButtonPath, powerButtonIntf);
+        getButtonEnabled(ctx, powerButtonPath, powerButtonIntf);
     // allow disable if the interface is present
     bool powerButtonDisableAllow = static_cast<bool>(powerButtonReading);
     // default return the button is enabled (not disabled)
@@ -1133,7 +1565,7 @@ ipmi::RspType<bool,    // Power is on
     }
 
     std::optional<bool> resetButtonReading =
-        getButtonEnabled(resetButtonPath, resetButtonIntf);
+        getButtonEnabled(ctx, resetButtonPath, resetButtonIntf);
     // allow disable if the interface is present
     bool resetButtonDisableAllow = static_cast<bool>(resetButtonReading);
     // default return the button is enabled (not disabled)
@@ -1144,7 +1576,7 @@ ipmi::RspType<bool,    // Power is on
         resetButtonDisabled = *resetButtonReading;
     }
 
-    bool powerDownAcFailed = power_policy::getACFailStatus();
+    bool powerDownAcFailed = power_policy::getACFailStatus(ctx);
 
     // This response has a lot of hard-coded, unsupported fields
     // They are set to false or 0
@@ -1254,26 +1686,22 @@ static std::optional<uint4_t> getRestartCause(ipmi::Context::ptr ctx)
     constexpr const char* restartCauseIntf =
         "xyz.openbmc_project.Control.Host.RestartCause";
 
-    std::string service;
-    boost::system::error_code ec =
-        ipmi::getService(ctx, restartCauseIntf, restartCausePath, service);
-    if (!ec)
+    using namespace chassis::internal;
+    std::optional<ipmi::Value> restartCause =
+        cache::getInterface(restartCausePath, restartCauseIntf)
+            .get(ctx, "RestartCause");
+    if (restartCause)
     {
-        std::string restartCauseStr;
-        ec = ipmi::getDbusProperty<std::string>(
-            ctx, service, restartCausePath, restartCauseIntf, "RestartCause",
-            restartCauseStr);
-        if (!ec)
+        if (auto restartCauseStr = std::get_if<std::string>(&*restartCause))
         {
             auto cause =
-                State::Host::convertRestartCauseFromString(restartCauseStr);
+                State::Host::convertRestartCauseFromString(*restartCauseStr);
             return types::enum_cast<uint4_t>(
                 restartCauseToIpmiRestartCause(cause));
         }
     }
 
     log<level::ERR>("Failed to fetch RestartCause property",
-                    entry("ERROR=%s", ec.message().c_str()),
                     entry("PATH=%s", restartCausePath),
                     entry("INTERFACE=%s", restartCauseIntf));
     return std::nullopt;
@@ -1299,7 +1727,7 @@ ipmi::RspType<uint4_t, // Restart Cause
 //-------------------------------------------------------------
 // Send a command to SoftPowerOff application to stop any timer
 //-------------------------------------------------------------
-int stop_soft_off_timer()
+int stop_soft_off_timer(ipmi::Context::ptr ctx)
 {
     constexpr auto iface = "org.freedesktop.DBus.Properties";
     constexpr auto soft_off_iface = "xyz.openbmc_project.Ipmi.Internal."
@@ -1309,9 +1737,6 @@ int stop_soft_off_timer()
     constexpr auto value = "xyz.openbmc_project.Ipmi.Internal."
                            "SoftPowerOff.HostResponse.HostShutdown";
 
-    // Get the system bus where most system services are provided.
-    auto bus = ipmid_get_sd_bus_connection();
-
     // Get the service name
     // TODO openbmc/openbmc#1661 - Mapper refactor
     //
@@ -1328,19 +1753,29 @@ int stop_soft_off_timer()
     //    return r;
     //}
 
-    // No error object or reply expected.
-    int rc = sd_bus_call_method(bus, SOFTOFF_BUSNAME, SOFTOFF_OBJPATH, iface,
-                                "Set", nullptr, nullptr, "ssv", soft_off_iface,
-                                property, "s", value);
-    if (rc < 0)
+    // the SoftPowerOff object of the host asking, host 0 keeps the root
+    // path and the others sit below it, see softoff/mainapp.cpp
+    std::string objPath{SOFTOFF_OBJPATH};
+    if (ctx->hostIdx > 0)
+    {
+        objPath += std::string("/") + HOST_NAME + std::to_string(ctx->hostIdx);
+    }
+
+    // No reply expected.
+    boost::system::error_code ec;
+    ctx->bus->yield_method_call(ctx->yield, ec, SOFTOFF_BUSNAME, objPath,
+                                iface, "Set", soft_off_iface, property,
+                                std::variant<std::string>(value));
+    if (ec)
     {
         log<level::ERR>("Failed to set property in SoftPowerOff object",
-                        entry("ERRNO=0x%X", -rc));
+                        entry("ERROR=%s", ec.message().c_str()));
+        return -1;
     }
 
     // TODO openbmc/openbmc#1661 - Mapper refactor
     // free(busname);
-    return rc;
+    return 0;
 }
 
 //----------------------------------------------------------------------
@@ -1372,13 +1807,15 @@ void indicate_no_softoff_needed()
  *
  *  @return  Success or InvalidFieldRequest.
  */
-ipmi::RspType<> ipmiChassisControl(uint8_t chassisControl)
+ipmi::RspType<> ipmiChassisControl(ipmi::Context::ptr ctx,
+                                   uint8_t chassisControl)
 {
     int rc = 0;
     switch (chassisControl)
     {
         case CMD_POWER_ON:
-            rc = initiate_state_transition(State::Host::Transition::On);
+            rc = initiate_state_transition(ctx, chassisControl,
+                                           State::Host::Transition::On);
             break;
         case CMD_POWER_OFF:
             // This path would be hit in 2 conditions.
@@ -1393,7 +1830,7 @@ ipmi::RspType<> ipmiChassisControl(uint8_t chassisControl)
 
             // For now, we are going ahead with trying to nudge the soft off and
             // interpret the failure to do so as a non softoff case
-            rc = stop_soft_off_timer();
+            rc = stop_soft_off_timer(ctx);
 
             // Only request the Off transition if the soft power off
             // application is not running
@@ -1406,12 +1843,14 @@ ipmi::RspType<> ipmiChassisControl(uint8_t chassisControl)
                 indicate_no_softoff_needed();
 
                 // Now request the shutdown
-                rc = initiate_state_transition(State::Host::Transition::Off);
+                rc = initiate_state_transition(
+                    ctx, chassisControl, State::Host::Transition::Off);
             }
             else
             {
                 log<level::INFO>("Soft off is running, so let shutdown target "
                                  "stop the host");
+                trackTransition(chassisControl, State::Host::Transition::Off);
             }
             break;
 
@@ -1427,16 +1866,18 @@ ipmi::RspType<> ipmiChassisControl(uint8_t chassisControl)
             // originating via a soft power off SMS request)
             indicate_no_softoff_needed();
 
-            rc = initiate_state_transition(State::Host::Transition::Reboot);
+            rc = initiate_state_transition(ctx, chassisControl,
+                                           State::Host::Transition::Reboot);
             break;
 
         case CMD_SOFT_OFF_VIA_OVER_TEMP:
             // Request Host State Manager to do a soft power off
-            rc = initiate_state_transition(State::Host::Transition::Off);
+            rc = initiate_state_transition(ctx, chassisControl,
+                                           State::Host::Transition::Off);
             break;
 
         case CMD_PULSE_DIAGNOSTIC_INTR:
-            rc = setNmiProperty(true);
+            rc = setNmiProperty(ctx, true);
             break;
 
         default:
@@ -1451,81 +1892,104 @@ ipmi::RspType<> ipmiChassisControl(uint8_t chassisControl)
                      : ipmi::responseSuccess());
 }
 
-/** @brief Return D-Bus connection string to enclosure identify LED object
+/** @brief Implementation of the Get Chassis Transition Status OEM command
  *
- *  @param[in, out] connection - connection to D-Bus object
- *  @return a IPMI return code
+ *  @return the state of the last host transition requested through Chassis
+ *          Control, with the time since the request while it is in
+ *          progress, or the time it took once complete
  */
-std::string getEnclosureIdentifyConnection()
+ipmi::RspType<bool,     // transition in progress
+              uint7_t,  // reserved
+              uint8_t,  // chassis control command, FFh if none
+              uint32_t  // elapsed or completion time in milliseconds
+              >
+    ipmiGetChassisTransitionStatus()
 {
-    // lookup enclosure_identify group owner(s) in mapper
-    auto mapperCall = chassis::internal::dbus.new_method_call(
-        ipmi::MAPPER_BUS_NAME, ipmi::MAPPER_OBJ, ipmi::MAPPER_INTF,
-        "GetObject");
+    auto elapsed = transitionStatus.inProgress
+                       ? std::chrono::steady_clock::now() -
+                             transitionStatus.start
+                       : transitionStatus.latency;
+    auto elapsedMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    return ipmi::responseSuccess(
+        transitionStatus.inProgress, uint7_t(0), transitionStatus.command,
+        static_cast<uint32_t>(std::min<int64_t>(
+            elapsedMs, std::numeric_limits<uint32_t>::max())));
+}
 
-    mapperCall.append(identify_led_object_name);
-    static const std::vector<std::string> interfaces = {
-        "xyz.openbmc_project.Led.Group"};
-    mapperCall.append(interfaces);
-    auto mapperReply = chassis::internal::dbus.call(mapperCall);
-    if (mapperReply.is_method_error())
-    {
-        log<level::ERR>("Chassis Identify: Error communicating to mapper.");
-        elog<InternalFailure>();
-    }
-    std::vector<std::pair<std::string, std::vector<std::string>>> mapperResp;
-    mapperReply.read(mapperResp);
+constexpr auto ledGroupIntf = "xyz.openbmc_project.Led.Group";
 
-    if (mapperResp.size() != encIdentifyObjectsSize)
-    {
-        log<level::ERR>(
-            "Invalid number of enclosure identify objects.",
-            entry("ENC_IDENTITY_OBJECTS_SIZE=%d", mapperResp.size()));
-        elog<InternalFailure>();
-    }
-    auto pair = mapperResp[encIdentifyObjectsSize - 1];
-    return pair.first;
+/** @brief the cache of the enclosure identify LED group; it also knows the
+ *         service of the group once the properties are read
+ */
+chassis::internal::cache::InterfaceCache& identifyLed()
+{
+    return chassis::internal::cache::getInterface(identify_led_object_name,
+                                                  ledGroupIntf);
 }
 
-/** @brief Turn On/Off enclosure identify LED
+/** @brief Turn On/Off enclosure identify LED, a request for the state the
+ *         LED is in already sets nothing
  *
+ *  @param[in] ctx - ipmi context
  *  @param[in] flag - true to turn on LED, false to turn off
- *  @return a IPMI return code
+ *  @return false if the LED can't be set
  */
-void enclosureIdentifyLed(bool flag)
+bool enclosureIdentifyLed(ipmi::Context::ptr ctx, bool flag)
 {
-    using namespace chassis::internal;
-    std::string connection = std::move(getEnclosureIdentifyConnection());
-    auto msg = std::string("enclosureIdentifyLed(") +
-               boost::lexical_cast<std::string>(flag) + ")";
-    log<level::DEBUG>(msg.c_str());
-    auto led =
-        dbus.new_method_call(connection.c_str(), identify_led_object_name,
-                             "org.freedesktop.DBus.Properties", "Set");
-    led.append("xyz.openbmc_project.Led.Group", "Asserted",
-               std::variant<bool>(flag));
-    auto ledReply = dbus.call(led);
-    if (ledReply.is_method_error())
-    {
-        log<level::ERR>("Chassis Identify: Error Setting State On/Off\n",
-                        entry("LED_STATE=%d", flag));
-        elog<InternalFailure>();
+    log<level::DEBUG>("enclosureIdentifyLed", entry("LED_STATE=%d", flag));
+    auto& led = identifyLed();
+    std::optional<ipmi::Value> asserted = led.get(ctx, "Asserted");
+    if (!asserted)
+    {
+        log<level::ERR>("Chassis Identify: No enclosure identify LED group");
+        return false;
+    }
+    if (std::holds_alternative<bool>(*asserted) &&
+        std::get<bool>(*asserted) == flag)
+    {
+        return true;
+    }
+    boost::system::error_code ec =
+        ipmi::setDbusProperty(ctx, led.owner(), identify_led_object_name,
+                              ledGroupIntf, "Asserted", flag);
+    if (ec)
+    {
+        log<level::ERR>("Chassis Identify: Error Setting State On/Off",
+                        entry("LED_STATE=%d", flag),
+                        entry("ERROR=%s", ec.message().c_str()));
+        return false;
     }
+    led.update("Asserted", flag);
+    return true;
 }
 
-/** @brief Callback method to turn off LED
+/** @brief Callback method to turn off LED, the timer has no context to yield
+ *         on so the property is set with an async call
  */
 void enclosureIdentifyLedOff()
 {
-    try
+    chassisIDState = ChassisIDState::off;
+    auto& led = identifyLed();
+    if (led.owner().empty())
     {
-        chassisIDState = ChassisIDState::off;
-        enclosureIdentifyLed(false);
-    }
-    catch (const InternalFailure& e)
-    {
-        report<InternalFailure>();
+        // the group went away with its service, the LED state went with it
+        return;
     }
+    getSdBus()->async_method_call(
+        [](boost::system::error_code ec) {
+            if (ec)
+            {
+                log<level::ERR>("Chassis Identify: Error Setting State Off",
+                                entry("ERROR=%s", ec.message().c_str()));
+                report<InternalFailure>();
+                return;
+            }
+            identifyLed().update("Asserted", false);
+        },
+        led.owner(), identify_led_object_name,
+        "org.freedesktop.DBus.Properties", "Set", ledGroupIntf, "Asserted",
+        std::variant<bool>(false));
 }
 
 /** @brief Create timer to turn on and off the enclosure LED
@@ -1535,27 +1999,26 @@ void createIdentifyTimer()
     if (!identifyTimer)
     {
         identifyTimer =
-            std::make_unique<phosphor::Timer>(enclosureIdentifyLedOff);
+            std::make_unique<boost::asio::steady_timer>(*getIoContext());
     }
 }
 
-ipmi::RspType<> ipmiChassisIdentify(std::optional<uint8_t> interval,
+ipmi::RspType<> ipmiChassisIdentify(ipmi::Context::ptr ctx,
+                                    std::optional<uint8_t> interval,
                                     std::optional<uint8_t> force)
 {
     uint8_t identifyInterval = interval.value_or(DEFAULT_IDENTIFY_TIME_OUT);
     bool forceIdentify = force.value_or(0) & 0x01;
 
+    createIdentifyTimer();
+    // stop the timer if already started;
+    // for force identify we should not turn off LED
+    identifyTimer->cancel();
     if (identifyInterval || forceIdentify)
     {
-        // stop the timer if already started;
-        // for force identify we should not turn off LED
-        identifyTimer->stop();
-        try
-        {
-            chassisIDState = ChassisIDState::temporaryOn;
-            enclosureIdentifyLed(true);
-        }
-        catch (const InternalFailure& e)
+        // a repeated identify finds the LED on and only moves the expiry
+        chassisIDState = ChassisIDState::temporaryOn;
+        if (!enclosureIdentifyLed(ctx, true))
         {
             report<InternalFailure>();
             return ipmi::responseResponseError();
@@ -1567,14 +2030,24 @@ ipmi::RspType<> ipmiChassisIdentify(std::optional<uint8_t> interval,
             return ipmi::responseSuccess();
         }
         // start the timer
-        auto time = std::chrono::duration_cast<std::chrono::microseconds>(
-            std::chrono::seconds(identifyInterval));
-        identifyTimer->start(time);
+        identifyTimer->expires_after(std::chrono::seconds(identifyInterval));
+        identifyTimer->async_wait([](const boost::system::error_code& ec) {
+            // an expiry already queued when a later identify moved it out
+            // is stale
+            if (!ec && identifyTimer->expiry() <=
+                           boost::asio::steady_timer::clock_type::now())
+            {
+                enclosureIdentifyLedOff();
+            }
+        });
     }
-    else if (!identifyInterval)
+    else
     {
-        identifyTimer->stop();
-        enclosureIdentifyLedOff();
+        chassisIDState = ChassisIDState::off;
+        if (!enclosureIdentifyLed(ctx, false))
+        {
+            report<InternalFailure>();
+        }
     }
     return ipmi::responseSuccess();
 }
@@ -1712,6 +2185,87 @@ static constexpr uint8_t setComplete = 0x0;
 static constexpr uint8_t setInProgress = 0x1;
 static uint8_t transferStatus = setComplete;
 
+/** @struct BootFlags
+ *  @brief the boot settings requested by a Set System Boot Options boot
+ *         flags parameter, including the source and mode resets it implies
+ */
+struct BootFlags
+{
+    bool permanent;
+    std::optional<Source::Sources> source;
+    std::optional<Type::Types> type;
+    std::optional<Mode::Modes> mode;
+};
+
+/** @brief boot flags written while a set is in progress; they are applied
+ *         together when the set completes
+ */
+static std::optional<BootFlags> pendingBootFlags;
+
+/** @brief apply boot flags to the boot setting objects
+ *  @param[in] ctx - context pointer
+ *  @param[in] flags - the boot flags
+ *  @return On failure return IPMI error.
+ */
+static ipmi::Cc applyBootFlags(ipmi::Context::ptr& ctx, const BootFlags& flags)
+{
+    using namespace chassis::internal;
+    using namespace chassis::internal::cache;
+    constexpr auto enabledIntf = "xyz.openbmc_project.Object.Enable";
+    constexpr auto oneTimePath =
+        "/xyz/openbmc_project/control/host0/boot/one_time";
+
+    try
+    {
+        settings::Objects& objects = getObjects();
+
+        auto bootSetting = settings::boot::setting(objects, bootSourceIntf);
+
+        bool oneTimeEnabled =
+            std::get<settings::boot::OneTimeEnabled>(bootSetting);
+
+        /*
+         * Check if the current boot setting is onetime or permanent, if the
+         * request in the command is otherwise, then set the "Enabled"
+         * property in one_time object path to 'True' to indicate onetime
+         * and 'False' to indicate permanent.
+         *
+         * Once the onetime/permanent setting is applied, then the bootMode
+         * and bootSource is updated for the corresponding object.
+         */
+        if (flags.permanent == oneTimeEnabled)
+        {
+            auto service = ipmi::getService(dbus, enabledIntf, oneTimePath);
+
+            ipmi::setDbusProperty(dbus, service, oneTimePath, enabledIntf,
+                                  "Enabled", !flags.permanent);
+        }
+
+        ipmi::Cc rc = ipmi::ccSuccess;
+        if (flags.source)
+        {
+            rc = setBootSource(ctx, *flags.source);
+        }
+        if (rc == ipmi::ccSuccess && flags.type)
+        {
+            rc = setBootType(ctx, *flags.type);
+        }
+        if (rc == ipmi::ccSuccess && flags.mode)
+        {
+            rc = setBootMode(ctx, *flags.mode);
+        }
+        return rc;
+    }
+    catch (sdbusplus::exception_t& e)
+    {
+        objectsPtr.reset();
+        report<InternalFailure>();
+        log<level::ERR>("ipmiChassisSetSysBootOptions: Error in setting Boot "
+                        "flag parameters");
+        return ipmi::ccUnspecifiedError;
+    }
+}
+
 /** @brief implements the Get Chassis system boot option
  *  @param ctx - context pointer
  *  @param bootOptionParameter   - boot option parameter selector
@@ -1776,72 +2330,15 @@ ipmi::RspType<ipmi::message::Payload>
 
         try
         {
-            std::string result;
-            boost::system::error_code ec;
-            settings::Objects& objects = getObjects();
-
-            auto bootSetting = settings::boot::setting(objects, bootSourceIntf);
-            const auto& bootSourceSetting =
-                std::get<settings::Path>(bootSetting);
-            ec = ipmi::getDbusProperty(
-                ctx, objects.service(bootSourceSetting, bootSourceIntf),
-                bootSourceSetting, bootSourceIntf, "BootSource", result);
-            if (ec)
-            {
-                log<level::ERR>(
-                    "ipmiChassisGetSysBootOptions: Error in BootSource Get");
-                report<InternalFailure>();
-                return ipmi::responseUnspecifiedError();
-            }
-            auto bootSource = Source::convertSourcesFromString(result);
-
-            Type::Types bootType;
-            bool bootTypeIntfPresent = true;
-            try
-            {
-                bootSetting = settings::boot::setting(objects, bootTypeIntf);
-            }
-            catch (const std::exception& e)
-            {
-                bootTypeIntfPresent = false;
-            }
-            if (bootTypeIntfPresent)
+            std::optional<BootSettings> boot = getBootSettings(ctx);
+            if (!boot)
             {
-                const auto& bootTypeSetting =
-                    std::get<settings::Path>(bootSetting);
-                ec = ipmi::getDbusProperty(
-                    ctx, objects.service(bootTypeSetting, bootTypeIntf),
-                    bootTypeSetting, bootTypeIntf, "BootType", result);
-                if (ec)
-                {
-                    log<level::ERR>(
-                        "ipmiChassisGetSysBootOptions: Error in BootType Get");
-                    report<InternalFailure>();
-                    return ipmi::responseUnspecifiedError();
-                }
-                else
-                {
-                    bootType = Type::convertTypesFromString(result);
-                }
-            }
-            else
-            {
-                bootType = Type::Types::EFI;
-            }
-
-            bootSetting = settings::boot::setting(objects, bootModeIntf);
-            const auto& bootModeSetting = std::get<settings::Path>(bootSetting);
-            ec = ipmi::getDbusProperty(
-                ctx, objects.service(bootModeSetting, bootModeIntf),
-                bootModeSetting, bootModeIntf, "BootMode", result);
-            if (ec)
-            {
-                log<level::ERR>(
-                    "ipmiChassisGetSysBootOptions: Error in BootMode Get");
                 report<InternalFailure>();
                 return ipmi::responseUnspecifiedError();
             }
-            auto bootMode = Mode::convertModesFromString(result);
+            auto bootSource = boot->source;
+            auto bootType = boot->type;
+            auto bootMode = boot->mode;
 
             bootOption = sourceDbusToIpmi.at(bootSource);
             if ((Mode::Modes::Regular == bootMode) &&
@@ -1855,9 +2352,7 @@ ipmi::RspType<ipmi::message::Payload>
             }
 
             IpmiValue biosBootType = typeDbusToIpmi.at(bootType);
-            auto oneTimeEnabled =
-                std::get<settings::boot::OneTimeEnabled>(bootSetting);
-            uint1_t permanent = oneTimeEnabled ? 0 : 1;
+            uint1_t permanent = boot->oneTimeEnabled ? 0 : 1;
             uint1_t validFlag = 1;
 
             response.pack(bootOptionParameter, reserved1, uint5_t{},
@@ -1882,7 +2377,7 @@ ipmi::RspType<ipmi::message::Payload>
                 BootOptionParameter::opalNetworkSettings)
             {
                 response.pack(bootOptionParameter, reserved1);
-                int ret = getHostNetworkData(response);
+                int ret = getHostNetworkData(ctx, response);
                 if (ret < 0)
                 {
                     response.trailingOk = true;
@@ -1934,6 +2429,17 @@ ipmi::RspType<> ipmiChassisSetSysBootOptions(ipmi::Context::ptr ctx,
             return ipmi::response(IPMI_CC_FAIL_SET_IN_PROGRESS);
         }
         transferStatus = static_cast<uint8_t>(setInProgressFlag);
+        if (transferStatus != setInProgress && pendingBootFlags)
+        {
+            // the set is complete, apply what was written during it
+            BootFlags flags = *pendingBootFlags;
+            pendingBootFlags.reset();
+            rc = applyBootFlags(ctx, flags);
+            if (rc != ipmi::ccSuccess)
+            {
+                return ipmi::response(rc);
+            }
+        }
         return ipmi::responseSuccess();
     }
 
@@ -1973,106 +2479,62 @@ ipmi::RspType<> ipmiChassisSetSysBootOptions(ipmi::Context::ptr ctx,
             return ipmi::responseInvalidFieldRequest();
         }
 
-        using namespace chassis::internal;
-        using namespace chassis::internal::cache;
-        auto oneTimeEnabled = false;
-        constexpr auto enabledIntf = "xyz.openbmc_project.Object.Enable";
-        constexpr auto oneTimePath =
-            "/xyz/openbmc_project/control/host0/boot/one_time";
-
-        try
+        auto modeItr =
+            modeIpmiToDbus.find(static_cast<uint8_t>(bootDeviceSelector));
+        auto typeItr = typeIpmiToDbus.find(static_cast<uint8_t>(biosBootType));
+        auto sourceItr =
+            sourceIpmiToDbus.find(static_cast<uint8_t>(bootDeviceSelector));
+        if ((modeIpmiToDbus.end() == modeItr) &&
+            (typeIpmiToDbus.end() == typeItr) &&
+            (sourceIpmiToDbus.end() == sourceItr))
         {
-            settings::Objects& objects = getObjects();
-
-            auto bootSetting = settings::boot::setting(objects, bootSourceIntf);
-
-            oneTimeEnabled =
-                std::get<settings::boot::OneTimeEnabled>(bootSetting);
-
-            /*
-             * Check if the current boot setting is onetime or permanent, if the
-             * request in the command is otherwise, then set the "Enabled"
-             * property in one_time object path to 'True' to indicate onetime
-             * and 'False' to indicate permanent.
-             *
-             * Once the onetime/permanent setting is applied, then the bootMode
-             * and bootSource is updated for the corresponding object.
-             */
-            if ((permanent && oneTimeEnabled) ||
-                (!permanent && !oneTimeEnabled))
-            {
-                auto service = ipmi::getService(dbus, enabledIntf, oneTimePath);
-
-                ipmi::setDbusProperty(dbus, service, oneTimePath, enabledIntf,
-                                      "Enabled", !permanent);
-            }
+            // return error if boot option is not supported
+            log<level::ERR>(
+                "ipmiChassisSetSysBootOptions: Boot option not supported");
+            return ipmi::responseInvalidFieldRequest();
+        }
 
-            auto modeItr =
-                modeIpmiToDbus.find(static_cast<uint8_t>(bootDeviceSelector));
-            auto typeItr =
-                typeIpmiToDbus.find(static_cast<uint8_t>(biosBootType));
-            auto sourceItr =
-                sourceIpmiToDbus.find(static_cast<uint8_t>(bootDeviceSelector));
-            if (sourceIpmiToDbus.end() != sourceItr)
+        BootFlags flags{permanent, std::nullopt, std::nullopt, std::nullopt};
+        if (sourceIpmiToDbus.end() != sourceItr)
+        {
+            flags.source = sourceItr->second;
+            // If a set boot device is mapping to a boot source, then reset
+            // the boot mode D-Bus property to default.
+            // This way the ipmid code can determine which property is not
+            // at the default value
+            if (sourceItr->second != Source::Sources::Default)
             {
-                rc = setBootSource(ctx, sourceItr->second);
-                if (rc != ipmi::ccSuccess)
-                {
-                    return ipmi::responseUnspecifiedError();
-                }
-                // If a set boot device is mapping to a boot source, then reset
-                // the boot mode D-Bus property to default.
-                // This way the ipmid code can determine which property is not
-                // at the default value
-                if (sourceItr->second != Source::Sources::Default)
-                {
-                    setBootMode(ctx, Mode::Modes::Regular);
-                }
+                flags.mode = Mode::Modes::Regular;
             }
-
-            if (typeIpmiToDbus.end() != typeItr)
+        }
+        if (typeIpmiToDbus.end() != typeItr)
+        {
+            flags.type = typeItr->second;
+        }
+        if (modeIpmiToDbus.end() != modeItr)
+        {
+            flags.mode = modeItr->second;
+            // If a set boot device is mapping to a boot mode, then reset
+            // the boot source D-Bus property to default.
+            // This way the ipmid code can determine which property is not
+            // at the default value
+            if (modeItr->second != Mode::Modes::Regular)
             {
-                rc = setBootType(ctx, typeItr->second);
-                if (rc != ipmi::ccSuccess)
-                {
-                    return ipmi::responseUnspecifiedError();
-                }
+                flags.source = Source::Sources::Default;
             }
+        }
 
-            if (modeIpmiToDbus.end() != modeItr)
-            {
-                rc = setBootMode(ctx, modeItr->second);
-                if (rc != ipmi::ccSuccess)
-                {
-                    return ipmi::responseUnspecifiedError();
-                }
-                // If a set boot device is mapping to a boot mode, then reset
-                // the boot source D-Bus property to default.
-                // This way the ipmid code can determine which property is not
-                // at the default value
-                if (modeItr->second != Mode::Modes::Regular)
-                {
-                    setBootSource(ctx, Source::Sources::Default);
-                }
-            }
-            if ((modeIpmiToDbus.end() == modeItr) &&
-                (typeIpmiToDbus.end() == typeItr) &&
-                (sourceIpmiToDbus.end() == sourceItr))
-            {
-                // return error if boot option is not supported
-                log<level::ERR>(
-                    "ipmiChassisSetSysBootOptions: Boot option not supported");
-                return ipmi::responseInvalidFieldRequest();
-            }
+        // While a set is in progress the flags are only kept, so the host
+        // never sees a partly applied boot configuration.
+        if (transferStatus == setInProgress)
+        {
+            pendingBootFlags = flags;
+            return ipmi::responseSuccess();
         }
-        catch (sdbusplus::exception_t& e)
+        rc = applyBootFlags(ctx, flags);
+        if (rc != ipmi::ccSuccess)
         {
-            objectsPtr.reset();
-            report<InternalFailure>();
-            log<level::ERR>(
-                "ipmiChassisSetSysBootOptions: Error in setting Boot "
-                "flag parameters");
-            return ipmi::responseUnspecifiedError();
+            return ipmi::response(rc);
         }
     }
     else if (types::enum_cast<BootOptionParameter>(parameterSelector) ==
@@ -2108,7 +2570,7 @@ ipmi::RspType<> ipmiChassisSetSysBootOptions(ipmi::Context::ptr ctx,
             if (types::enum_cast<BootOptionParameter>(parameterSelector) ==
                 BootOptionParameter::opalNetworkSettings)
             {
-                ipmi::Cc ret = setHostNetworkData(data);
+                ipmi::Cc ret = setHostNetworkData(ctx, data);
                 if (ret != ipmi::ccSuccess)
                 {
                     log<level::ERR>("ipmiChassisSetSysBootOptions: Error in "
@@ -2250,7 +2712,7 @@ ipmi::RspType<> ipmiSetFrontPanelButtonEnables(
 
 void register_netfn_chassis_functions()
 {
-    createIdentifyTimer();
+    defer_init(createIdentifyTimer);
 
     // Get Chassis Capabilities
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnChassis,
@@ -2289,6 +2751,12 @@ void register_netfn_chassis_functions()
                           ipmi::chassis::cmdChassisControl,
                           ipmi::Privilege::Operator, ipmiChassisControl);
 
+    // <Get Chassis Transition Status>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getChassisTransitionStatusCmd,
+                             ipmi::Privilege::User,
+                             ipmiGetChassisTransitionStatus);
+
     // <Chassis Identify>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnChassis,
                           ipmi::chassis::cmdChassisIdentify,
@@ -0,0 +1,358 @@
+#include "config.h"
+
+#include "command-stats.hpp"
+
+#include "ipmb-bridge.hpp"
+#include "pressure.hpp"
+
+#include <algorithm>
+#include <ipmid/api.hpp>
+#include <ipmid/dbus-stats.hpp>
+#include <ipmid/handler.hpp>
+#include <ipmid/mapper.hpp>
+#include <ipmid/oemopenbmc.hpp>
+#include <ipmid/oemrouter.hpp>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace ipmi
+{
+namespace stats
+{
+
+namespace
+{
+
+constexpr auto statsPath = "/xyz/openbmc_project/Ipmi/Statistics";
+constexpr auto statsIntf = "xyz.openbmc_project.Ipmi.Statistics";
+
+/** @brief most completion codes reported per entry by the OEM command */
+constexpr size_t maxOemCompletionCodes = 8;
+
+/** @brief counters keyed by (netFn << 16) | (cmd << 8) | channel, ordered so
+ *         the OEM command can walk them by index
+ */
+std::map<uint32_t, Counters> commands;
+
+/** @brief requests past their deadline, dropped before they ran and
+ *         answered too late
+ */
+uint64_t shedRequests = 0;
+uint64_t lateRequests = 0;
+
+/** @brief request coroutines, now and at their peak since the last reset */
+struct
+{
+    uint64_t live = 0;
+    uint64_t peakLive = 0;
+    uint64_t waiting = 0;
+    uint64_t peakWaiting = 0;
+    uint64_t spawned = 0;
+} coroutines;
+
+inline uint32_t makeKey(NetFn netFn, Cmd cmd, uint8_t channel)
+{
+    return (static_cast<uint32_t>(netFn) << 16) |
+           (static_cast<uint32_t>(cmd) << 8) | channel;
+}
+
+inline size_t latencyBucket(uint64_t us)
+{
+    // floor(log2(us)) - 3, so everything below 16us lands in bucket 0
+    size_t bucket = 0;
+    for (us >>= 4; us && bucket < latencyBuckets - 1; us >>= 1)
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+inline uint32_t saturate(uint64_t value)
+{
+    return static_cast<uint32_t>(
+        std::min<uint64_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+using CompletionCodes = std::vector<std::tuple<uint8_t, uint64_t>>;
+using CommandEntry =
+    std::tuple<uint8_t, uint8_t, uint8_t, uint64_t, uint64_t, uint64_t,
+               CompletionCodes, std::vector<uint64_t>>;
+
+/** @brief D-Bus method returning the statistics of every command
+ *
+ *  @return one (netFn, cmd, channel, count, totalUs, maxUs,
+ *          [(cc, count)], [latency bucket counts]) entry per command
+ */
+std::vector<CommandEntry> getCommandStatistics()
+{
+    std::vector<CommandEntry> entries;
+    entries.reserve(commands.size());
+    for (const auto& [key, counters] : commands)
+    {
+        CompletionCodes ccs(counters.completionCodes.begin(),
+                            counters.completionCodes.end());
+        entries.emplace_back(
+            static_cast<uint8_t>(key >> 16), static_cast<uint8_t>(key >> 8),
+            static_cast<uint8_t>(key), counters.count, counters.totalUs,
+            counters.maxUs, std::move(ccs),
+            std::vector<uint64_t>(counters.latency.begin(),
+                                  counters.latency.end()));
+    }
+    return entries;
+}
+
+/** @brief implements the Get Command Statistics OpenBMC OEM command
+ *
+ *  @param[in] index - index of the entry, in netFn, cmd, channel order
+ *
+ *  @return IPMI completion code plus response data
+ *   - entries - number of entries
+ *   - netFn, cmd, channel - the command of the entry
+ *   - count - number of executions
+ *   - totalUs - total execution time
+ *   - maxUs - longest execution time
+ *   - latency - count per latency bucket
+ *   - completionCodes - (cc, count) of the first completion codes
+ */
+ipmi::RspType<uint16_t,                              // entries
+              uint8_t,                               // netFn
+              uint8_t,                               // cmd
+              uint8_t,                               // channel
+              uint32_t,                              // count
+              uint64_t,                              // totalUs
+              uint32_t,                              // maxUs
+              std::array<uint32_t, latencyBuckets>,  // latency
+              std::vector<std::tuple<uint8_t, uint32_t>> // completionCodes
+              >
+    ipmiGetCommandStatistics(uint16_t index)
+{
+    if (index >= commands.size())
+    {
+        return ipmi::responseParmOutOfRange();
+    }
+    const auto& [key, counters] = *std::next(commands.begin(), index);
+
+    std::array<uint32_t, latencyBuckets> latency;
+    std::transform(counters.latency.begin(), counters.latency.end(),
+                   latency.begin(), saturate);
+    std::vector<std::tuple<uint8_t, uint32_t>> ccs;
+    for (const auto& [cc, count] : counters.completionCodes)
+    {
+        if (ccs.size() == maxOemCompletionCodes)
+        {
+            break;
+        }
+        ccs.emplace_back(cc, saturate(count));
+    }
+
+    return ipmi::responseSuccess(
+        static_cast<uint16_t>(std::min<size_t>(
+            commands.size(), std::numeric_limits<uint16_t>::max())),
+        static_cast<uint8_t>(key >> 16), static_cast<uint8_t>(key >> 8),
+        static_cast<uint8_t>(key), saturate(counters.count), counters.totalUs,
+        saturate(counters.maxUs), latency, ccs);
+}
+
+/** @brief D-Bus method returning the D-Bus calls of the libipmid helpers
+ *         by the command that made them
+ *
+ *  @return one (netFn, cmd, calls, failures, totalUs, maxUs, requests over
+ *          budget) entry per command, netFn and cmd FFh for the calls made
+ *          outside of a handler
+ */
+std::vector<std::tuple<uint8_t, uint8_t, uint64_t, uint64_t, uint64_t,
+                       uint64_t, uint64_t>>
+    getDbusCallStatistics()
+{
+    std::vector<std::tuple<uint8_t, uint8_t, uint64_t, uint64_t, uint64_t,
+                           uint64_t, uint64_t>>
+        entries;
+    for (const auto& [key, counters] : dbus_stats::getStats())
+    {
+        entries.emplace_back(static_cast<uint8_t>(key >> 8),
+                             static_cast<uint8_t>(key), counters.calls,
+                             counters.failures, counters.totalUs,
+                             counters.maxUs, counters.overBudget);
+    }
+    return entries;
+}
+
+/** @brief D-Bus method returning the counters of the IPMB bridging engine
+ *
+ *  @return one (channel, slave address, requests, responses, retries,
+ *          timeouts, failures, busy, in flight, peak in flight, totalUs,
+ *          maxUs) entry per target
+ */
+std::vector<std::tuple<uint8_t, uint8_t, uint64_t, uint64_t, uint64_t,
+                       uint64_t, uint64_t, uint64_t, uint64_t, uint64_t,
+                       uint64_t, uint64_t>>
+    getIpmbBridgeStatistics()
+{
+    std::vector<std::tuple<uint8_t, uint8_t, uint64_t, uint64_t, uint64_t,
+                           uint64_t, uint64_t, uint64_t, uint64_t, uint64_t,
+                           uint64_t, uint64_t>>
+        entries;
+    for (const auto& [key, target] : ipmb::getStats())
+    {
+        entries.emplace_back(
+            static_cast<uint8_t>(key >> 8), static_cast<uint8_t>(key),
+            target.requests, target.responses, target.retries,
+            target.timeouts, target.failures, target.busy, target.inFlight,
+            target.peakInFlight, target.totalUs, target.maxUs);
+    }
+    return entries;
+}
+
+/** @brief D-Bus method returning the pressure and the load it shed
+ *
+ *  @return under pressure, CPU and memory avg10 percentages, episodes,
+ *          critical commands run in their own lane, expensive commands
+ *          deferred, resumed and rejected
+ */
+std::tuple<bool, double, double, uint64_t, uint64_t, uint64_t, uint64_t,
+           uint64_t>
+    getPressureStatistics()
+{
+    pressure::Stats shedding = pressure::getStats();
+    return std::make_tuple(shedding.active, shedding.cpu, shedding.memory,
+                           shedding.episodes, shedding.fastLane,
+                           shedding.deferred, shedding.resumed,
+                           shedding.rejected);
+}
+
+/** @brief D-Bus method returning the counters of the mapper client
+ *
+ *  @return hits, misses, coalesced queries, invalidated and cached answers
+ */
+std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, uint64_t>
+    getMapperCacheStatistics()
+{
+    mapper::Stats mapperStats = mapper::getStats();
+    return std::make_tuple(mapperStats.hits, mapperStats.misses,
+                           mapperStats.coalesced, mapperStats.invalidations,
+                           mapperStats.cached);
+}
+
+/** @brief implements the Get Mapper Cache Statistics OpenBMC OEM command
+ *
+ *  @return IPMI completion code plus response data
+ *   - hits - queries answered from the cache
+ *   - misses - queries that called the mapper
+ *   - coalesced - queries that waited for an identical query in flight
+ *   - invalidations - cached answers dropped by a change
+ *   - cached - answers in the cache
+ */
+ipmi::RspType<uint32_t, // hits
+              uint32_t, // misses
+              uint32_t, // coalesced
+              uint32_t, // invalidations
+              uint32_t  // cached
+              >
+    ipmiGetMapperCacheStatistics()
+{
+    mapper::Stats mapperStats = mapper::getStats();
+    return ipmi::responseSuccess(
+        saturate(mapperStats.hits), saturate(mapperStats.misses),
+        saturate(mapperStats.coalesced), saturate(mapperStats.invalidations),
+        saturate(mapperStats.cached));
+}
+
+} // namespace
+
+void recordShed()
+{
+    shedRequests++;
+}
+
+void recordLate()
+{
+    lateRequests++;
+}
+
+void record(NetFn netFn, Cmd cmd, int channel, Cc cc,
+            std::chrono::steady_clock::duration latency)
+{
+    Counters& counters =
+        commands[makeKey(netFn, cmd, static_cast<uint8_t>(channel))];
+    uint64_t us =
+        std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    counters.count++;
+    counters.totalUs += us;
+    counters.maxUs = std::max(counters.maxUs, us);
+    counters.completionCodes[cc]++;
+    counters.latency[latencyBucket(us)]++;
+}
+
+void recordCoroutines(size_t live, size_t waiting, bool spawned)
+{
+    coroutines.live = live;
+    coroutines.peakLive = std::max<uint64_t>(coroutines.peakLive, live);
+    coroutines.waiting = waiting;
+    coroutines.peakWaiting =
+        std::max<uint64_t>(coroutines.peakWaiting, waiting);
+    coroutines.spawned += spawned;
+}
+
+std::shared_ptr<sdbusplus::asio::dbus_interface>
+    registerStatistics(sdbusplus::asio::object_server& server)
+{
+    auto statsIface = server.add_interface(statsPath, statsIntf);
+    statsIface->register_method("GetCommandStatistics", getCommandStatistics);
+    statsIface->register_method("GetMapperCacheStatistics",
+                                getMapperCacheStatistics);
+    statsIface->register_method("GetDbusCallStatistics",
+                                getDbusCallStatistics);
+    statsIface->register_method("GetIpmbBridgeStatistics",
+                                getIpmbBridgeStatistics);
+    statsIface->register_method("GetPressureStatistics",
+                                getPressureStatistics);
+    // (netFn, cmd, calls, time in us) per request, zeros drop the budget
+    statsIface->register_method(
+        "SetDbusCallBudget",
+        [](uint8_t netFn, uint8_t cmd, uint32_t calls, uint64_t timeUs) {
+            dbus_stats::setBudget(netFn, cmd,
+                                  {calls, std::chrono::microseconds(timeUs)});
+        });
+    statsIface->register_method("GetExpiredRequests", []() {
+        return std::make_tuple(shedRequests, lateRequests);
+    });
+    // (stack size, limit, live, peak live, waiting, peak waiting, spawned)
+    statsIface->register_method("GetCoroutineStatistics", []() {
+        return std::make_tuple(
+            static_cast<uint64_t>(REQUEST_STACK_SIZE),
+            static_cast<uint64_t>(MAX_REQUEST_COROUTINES), coroutines.live,
+            coroutines.peakLive, coroutines.waiting, coroutines.peakWaiting,
+            coroutines.spawned);
+    });
+    statsIface->register_method("Reset", []() {
+        commands.clear();
+        dbus_stats::reset();
+        ipmb::reset();
+        pressure::reset();
+        shedRequests = 0;
+        lateRequests = 0;
+        coroutines.peakLive = coroutines.live;
+        coroutines.peakWaiting = coroutines.waiting;
+        coroutines.spawned = 0;
+    });
+    statsIface->initialize();
+
+    // <Get Command Statistics>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getCommandStatsCmd, ipmi::Privilege::User,
+                             ipmiGetCommandStatistics);
+
+    // <Get Mapper Cache Statistics>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getMapperCacheStatsCmd,
+                             ipmi::Privilege::User,
+                             ipmiGetMapperCacheStatistics);
+
+    return statsIface;
+}
+
+} // namespace stats
+} // namespace ipmi
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ipmid/api-types.hpp>
+#include <map>
+#include <memory>
+#include <sdbusplus/asio/object_server.hpp>
+
+namespace ipmi
+{
+namespace stats
+{
+
+/** @brief number of latency buckets: bucket 0 counts the commands that took
+ *         less than 16us, bucket i the ones that took [2^(i+3), 2^(i+4))us
+ *         and the last one all that took 2^18us (262ms) or more
+ */
+constexpr size_t latencyBuckets = 16;
+
+/** @struct Counters
+ *  @brief statistics of one command on one channel
+ */
+struct Counters
+{
+    uint64_t count = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+    /** @brief number of responses by completion code */
+    std::map<uint8_t, uint64_t> completionCodes;
+    std::array<uint64_t, latencyBuckets> latency{};
+};
+
+/** @brief record the execution of a command
+ *
+ *  Group and OEM commands are recorded under netFn 2Ch and 2Eh without the
+ *  group or IANA.
+ *
+ *  @param[in] netFn - network function of the request
+ *  @param[in] cmd - command of the request
+ *  @param[in] channel - channel the request came in on
+ *  @param[in] cc - completion code of the response
+ *  @param[in] latency - time the command took, from dispatch to response
+ */
+void record(NetFn netFn, Cmd cmd, int channel, Cc cc,
+            std::chrono::steady_clock::duration latency);
+
+/** @brief count a request that was dropped without running because its
+ *         requester had given up on it
+ */
+void recordShed();
+
+/** @brief count a request that was answered after its requester had given
+ *         up on it
+ */
+void recordLate();
+
+/** @brief record the request coroutines live and waiting for a slot,
+ *         every time either changes
+ *
+ *  @param[in] live - request coroutines running
+ *  @param[in] waiting - requests waiting for a coroutine
+ *  @param[in] spawned - whether the change is a coroutine starting
+ */
+void recordCoroutines(size_t live, size_t waiting, bool spawned);
+
+/** @brief publish the statistics on D-Bus and register the OEM command
+ *         that reads them
+ *
+ *  @param[in] server - the ipmid object server
+ *
+ *  @return the statistics interface, published for as long as it is held
+ */
+std::shared_ptr<sdbusplus::asio::dbus_interface>
+    registerStatistics(sdbusplus::asio::object_server& server);
+
+} // namespace stats
+} // namespace ipmi
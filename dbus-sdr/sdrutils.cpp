@@ -16,24 +16,269 @@
 
 #include "dbus-sdr/sdrutils.hpp"
 
+#include "dbus-sdr/storagecommands.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <ipmid/dbus-signals.hpp>
+#include <ipmid/mapper.hpp>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+
+// a deque, so that the names handed out stay where they are
+std::deque<std::string> sensorNames;
+std::unordered_map<std::string_view, SensorNameId> sensorNameIds;
+
+} // namespace
+
+SensorNameId internSensorName(std::string_view name)
+{
+    auto found = sensorNameIds.find(name);
+    if (found != sensorNameIds.end())
+    {
+        return found->second;
+    }
+    SensorNameId id = static_cast<SensorNameId>(sensorNames.size());
+    const std::string& interned = sensorNames.emplace_back(name);
+    sensorNameIds.emplace(interned, id);
+    return id;
+}
+
+const std::string& sensorName(SensorNameId id)
+{
+    return sensorNames.at(id);
+}
+
 namespace details
 {
-uint16_t getSensorSubtree(std::shared_ptr<SensorSubTree>& subtree)
+namespace
+{
+
+/** @brief how long the sensors have to stay quiet before the subtree is
+ *         rebuilt, so a hotplug or an entity-manager reconfiguration that
+ *         adds or removes many sensors causes a single rebuild
+ */
+constexpr auto sensorTreeSettleTime = std::chrono::milliseconds(500);
+
+std::shared_ptr<const SensorSubTree> sensorTreePtr;
+uint16_t sensorUpdatedIndex = 0;
+uint64_t sensorTreeGeneration = 0;
+std::function<void()> sensorTreeSwapped;
+
+constexpr const char* mapperBusName = "xyz.openbmc_project.ObjectMapper";
+constexpr const char* mapperPath = "/xyz/openbmc_project/object_mapper";
+constexpr const char* mapperInterface = "xyz.openbmc_project.ObjectMapper";
+constexpr const char* sensorRoot = "/xyz/openbmc_project/sensors";
+constexpr const int32_t sensorTreeDepth = 2;
+constexpr std::array<const char*, 3> sensorInterfaces = {
+    "xyz.openbmc_project.Sensor.Value",
+    "xyz.openbmc_project.Sensor.Threshold.Warning",
+    "xyz.openbmc_project.Sensor.Threshold.Critical"};
+
+/** @brief the subtree of a mapper answer, with its names interned */
+std::shared_ptr<const SensorSubTree>
+    makeSensorSubTree(const ipmi::ObjectTree& objects)
+{
+    auto tree = std::make_shared<SensorSubTree>();
+    tree->reserve(objects.size());
+    for (const auto& [path, services] : objects)
+    {
+        auto& sensor = (*tree)[path];
+        for (const auto& [service, interfaces] : services)
+        {
+            auto& ids = sensor[internSensorName(service)];
+            ids.reserve(interfaces.size());
+            for (const std::string& interface : interfaces)
+            {
+                ids.push_back(internSensorName(interface));
+            }
+        }
+    }
+    return tree;
+}
+
+/** @brief the last subtree the mapper answered, so that a restarted ipmid
+ *         answers from it while it fetches the subtree again
+ */
+constexpr const char* sensorSnapshotFile = "/var/lib/ipmi/sensor_subtree.json";
+constexpr uint64_t sensorSnapshotVersion = 2;
+
+/** @brief the ID of the current boot, empty when it can't be read */
+std::string bootId()
+{
+    std::string id;
+    std::ifstream file("/proc/sys/kernel/random/boot_id");
+    std::getline(file, id);
+    return id;
+}
+
+/** @brief loads the snapshot, unless it is from another version or another
+ *         boot of the BMC, the sensors may differ then
+ *
+ *  The boot is told by the ID the kernel gives it, which unlike the time
+ *  of the file doesn't depend on the clock being set right.
+ */
+std::shared_ptr<const SensorSubTree> loadSensorSnapshot()
+{
+    std::string boot = bootId();
+    if (boot.empty())
+    {
+        return nullptr;
+    }
+    std::ifstream file(sensorSnapshotFile);
+    auto data = nlohmann::json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.is_object() ||
+        data.value("version", uint64_t{0}) != sensorSnapshotVersion ||
+        data.value("bootId", std::string{}) != boot)
+    {
+        return nullptr;
+    }
+    try
+    {
+        return makeSensorSubTree(data.at("sensors").get<ipmi::ObjectTree>());
+    }
+    catch (const nlohmann::json::exception&)
+    {
+        return nullptr;
+    }
+}
+
+void saveSensorSnapshot(const SensorSubTree& tree)
+{
+    namespace fs = std::filesystem;
+
+    nlohmann::json sensors = nlohmann::json::object();
+    for (const auto& [path, services] : tree)
+    {
+        auto& sensor = sensors[path];
+        for (const auto& [service, interfaces] : services)
+        {
+            auto& names = sensor[sensorName(service)];
+            names = nlohmann::json::array();
+            for (SensorNameId interface : interfaces)
+            {
+                names.push_back(sensorName(interface));
+            }
+        }
+    }
+    nlohmann::json data = {{"version", sensorSnapshotVersion},
+                           {"bootId", bootId()},
+                           {"sensors", std::move(sensors)}};
+
+    std::error_code ec;
+    fs::path filePath(sensorSnapshotFile);
+    fs::create_directories(filePath.parent_path(), ec);
+    fs::path tmpPath = filePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        out << data.dump();
+        if (!out.good())
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                "Failed to write the sensor subtree snapshot");
+            fs::remove(tmpPath, ec);
+            return;
+        }
+    }
+    fs::rename(tmpPath, filePath, ec);
+    if (ec)
+    {
+        fs::remove(tmpPath, ec);
+    }
+}
+
+void swapSensorTree(std::shared_ptr<const SensorSubTree>&& tree)
+{
+    sensorTreePtr = std::move(tree);
+    sensorUpdatedIndex++;
+    sensorTreeGeneration++;
+    // The SDR is being regenerated, wipe the old stats
+    sdrStatsTable.wipeTable();
+    if (sensorTreeSwapped)
+    {
+        boost::asio::post(*getIoContext(), sensorTreeSwapped);
+    }
+}
+
+void rebuildSensorTree()
+{
+    static bool rebuilding = false;
+    static bool changedWhileRebuilding = false;
+    if (rebuilding)
+    {
+        changedWhileRebuilding = true;
+        return;
+    }
+    rebuilding = true;
+    getSdBus()->async_method_call(
+        [](const boost::system::error_code ec, ipmi::ObjectTree tree) {
+            rebuilding = false;
+            if (ec)
+            {
+                phosphor::logging::log<phosphor::logging::level::ERR>(
+                    "Failed to rebuild the sensor subtree",
+                    phosphor::logging::entry("ERROR=%s", ec.message().c_str()));
+            }
+            else
+            {
+                swapSensorTree(makeSensorSubTree(tree));
+                saveSensorSnapshot(*sensorTreePtr);
+            }
+            if (changedWhileRebuilding)
+            {
+                // the reply may predate the last change, fetch it again
+                changedWhileRebuilding = false;
+                rebuildSensorTree();
+            }
+        },
+        mapperBusName, mapperPath, mapperInterface, "GetSubTree", sensorRoot,
+        sensorTreeDepth, sensorInterfaces);
+}
+
+/** @brief schedules a rebuild once the sensors settle, requests keep using
+ *         the current subtree until the new one is swapped in
+ */
+void sensorsChanged()
+{
+    static boost::asio::steady_timer settleTimer(*getIoContext());
+    settleTimer.expires_after(sensorTreeSettleTime);
+    settleTimer.async_wait([](const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        rebuildSensorTree();
+    });
+}
+
+} // namespace
+
+uint16_t getSensorSubtree(std::shared_ptr<const SensorSubTree>& subtree)
 {
-    static std::shared_ptr<SensorSubTree> sensorTreePtr;
-    static uint16_t sensorUpdatedIndex = 0;
     std::shared_ptr<sdbusplus::asio::connection> dbus = getSdBus();
-    static sdbusplus::bus::match::match sensorAdded(
-        *dbus,
-        "type='signal',member='InterfacesAdded',arg0path='/xyz/openbmc_project/"
-        "sensors/'",
-        [](sdbusplus::message::message& m) { sensorTreePtr.reset(); });
-
-    static sdbusplus::bus::match::match sensorRemoved(
-        *dbus,
-        "type='signal',member='InterfacesRemoved',arg0path='/xyz/"
-        "openbmc_project/sensors/'",
-        [](sdbusplus::message::message& m) { sensorTreePtr.reset(); });
+    static ipmi::dbus_signals::Subscription sensorAdded =
+        ipmi::dbus_signals::onInterfacesAdded(
+            sensorRoot,
+            [](const ipmi::dbus_signals::InterfacesAdded&) {
+                sensorsChanged();
+            });
+
+    static ipmi::dbus_signals::Subscription sensorRemoved =
+        ipmi::dbus_signals::onInterfacesRemoved(
+            sensorRoot,
+            [](const ipmi::dbus_signals::InterfacesRemoved&) {
+                sensorsChanged();
+            });
 
     if (sensorTreePtr)
     {
@@ -41,42 +286,267 @@ uint16_t getSensorSubtree(std::shared_ptr<SensorSubTree>& subtree)
         return sensorUpdatedIndex;
     }
 
-    sensorTreePtr = std::make_shared<SensorSubTree>();
-
-    auto mapperCall =
-        dbus->new_method_call("xyz.openbmc_project.ObjectMapper",
-                              "/xyz/openbmc_project/object_mapper",
-                              "xyz.openbmc_project.ObjectMapper", "GetSubTree");
-    static constexpr const int32_t depth = 2;
-    static constexpr std::array<const char*, 3> interfaces = {
-        "xyz.openbmc_project.Sensor.Value",
-        "xyz.openbmc_project.Sensor.Threshold.Warning",
-        "xyz.openbmc_project.Sensor.Threshold.Critical"};
-    mapperCall.append("/xyz/openbmc_project/sensors", depth, interfaces);
+    // a snapshot from before a restart is answered from while the subtree
+    // is fetched again in the background
+    static bool snapshotTried = false;
+    if (!snapshotTried)
+    {
+        snapshotTried = true;
+        if (std::shared_ptr<const SensorSubTree> snapshot =
+                loadSensorSnapshot())
+        {
+            swapSensorTree(std::move(snapshot));
+            rebuildSensorTree();
+            subtree = sensorTreePtr;
+            return sensorUpdatedIndex;
+        }
+    }
 
+    // nothing to answer from yet, the first subtree is fetched inline
+    std::shared_ptr<const SensorSubTree> tree;
     try
     {
-        auto mapperReply = dbus->call(mapperCall);
-        mapperReply.read(*sensorTreePtr);
+        ipmi::ObjectTree objects = ipmi::mapper::getSubTree(
+            *dbus, sensorRoot, sensorTreeDepth,
+            ipmi::InterfaceList(sensorInterfaces.begin(),
+                                sensorInterfaces.end()));
+        tree = makeSensorSubTree(objects);
     }
     catch (sdbusplus::exception_t& e)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(e.what());
         return sensorUpdatedIndex;
     }
+    swapSensorTree(std::move(tree));
+    saveSensorSnapshot(*sensorTreePtr);
     subtree = sensorTreePtr;
-    sensorUpdatedIndex++;
-    // The SDR is being regenerated, wipe the old stats
-    sdrStatsTable.wipeTable();
     return sensorUpdatedIndex;
 }
 
+uint64_t getSensorTreeGeneration()
+{
+    return sensorTreeGeneration;
+}
+
+void onSensorTreeSwap(std::function<void()>&& callback)
+{
+    sensorTreeSwapped = std::move(callback);
+}
+
+uint16_t slotSensorNumber(size_t slot)
+{
+    static constexpr std::array<uint16_t, 3> lunBase = {0, lun1Sensor0,
+                                                        lun3Sensor0};
+    return lunBase[slot / maxSensorsPerLUN] | (slot % maxSensorsPerLUN);
+}
+
+std::optional<size_t> sensorNumberSlot(uint16_t number)
+{
+    size_t lunSlot = number & 0xFF;
+    if (lunSlot >= maxSensorsPerLUN)
+    {
+        return std::nullopt;
+    }
+    switch (number >> 8)
+    {
+        case 0:
+            return lunSlot;
+        case lun1Sensor0 >> 8:
+            return maxSensorsPerLUN + lunSlot;
+        case lun3Sensor0 >> 8:
+            return 2 * maxSensorsPerLUN + lunSlot;
+        default:
+            return std::nullopt;
+    }
+}
+
+namespace
+{
+
+/** @brief persistent path to sensor number allocation, so a sensor keeps
+ *         its number, and the host its cached SDR, when other sensors come
+ *         and go, and across restarts
+ */
+constexpr const char* sensorNumbersFile = "/var/lib/ipmi/sensor_numbers.json";
+
+/** @brief the path each slot was last allocated to, empty if never */
+using SensorNumberTable = std::vector<std::string>;
+
+SensorNumberTable loadSensorNumbers()
+{
+    SensorNumberTable table(maxIPMISensors);
+    std::ifstream file(sensorNumbersFile);
+    if (!file.is_open())
+    {
+        return table;
+    }
+    auto data = nlohmann::json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.is_object())
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "Invalid sensor number allocation file, renumbering sensors");
+        return table;
+    }
+    for (const auto& [path, number] : data.items())
+    {
+        std::optional<size_t> slot;
+        if (number.is_number_unsigned() && number.get<uint64_t>() <= 0xFFFF)
+        {
+            slot = sensorNumberSlot(number.get<uint16_t>());
+        }
+        if (slot && table[*slot].empty())
+        {
+            table[*slot] = path;
+        }
+    }
+    return table;
+}
+
+void saveSensorNumbers(const SensorNumberTable& table)
+{
+    namespace fs = std::filesystem;
+
+    nlohmann::json data = nlohmann::json::object();
+    for (size_t slot = 0; slot < table.size(); slot++)
+    {
+        if (!table[slot].empty())
+        {
+            data[table[slot]] = slotSensorNumber(slot);
+        }
+    }
+
+    std::error_code ec;
+    fs::path filePath(sensorNumbersFile);
+    fs::create_directories(filePath.parent_path(), ec);
+    fs::path tmpPath = filePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        out << data.dump();
+        if (!out.good())
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                "Failed to write the sensor number allocation file");
+            fs::remove(tmpPath, ec);
+            return;
+        }
+    }
+    fs::rename(tmpPath, filePath, ec);
+    if (ec)
+    {
+        fs::remove(tmpPath, ec);
+    }
+}
+
+/** @brief gives every sensor of the subtree a number, keeping the numbers
+ *         already allocated
+ *
+ *  A new sensor gets a slot that was never allocated. Once all are, it
+ *  takes over the slot of the lowest numbered sensor that is gone.
+ *
+ *  @return true if the allocation changed
+ */
+bool allocateSensorNumbers(SensorNumberTable& table,
+                           const SensorSubTree& sensorTree,
+                           std::vector<std::optional<size_t>>& slots)
+{
+    std::unordered_map<std::string_view, size_t> allocated;
+    for (size_t slot = 0; slot < table.size(); slot++)
+    {
+        if (!table[slot].empty())
+        {
+            allocated.emplace(table[slot], slot);
+        }
+    }
+
+    std::vector<bool> present(table.size());
+    slots.assign(sensorTree.size(), std::nullopt);
+    size_t index = 0;
+    for (const auto& sensor : sensorTree)
+    {
+        auto found = allocated.find(sensor.first);
+        if (found != allocated.end())
+        {
+            slots[index] = found->second;
+            present[found->second] = true;
+        }
+        index++;
+    }
+
+    bool changed = false;
+    size_t unused = 0;
+    size_t reusable = 0;
+    index = 0;
+    for (const auto& sensor : sensorTree)
+    {
+        if (slots[index])
+        {
+            index++;
+            continue;
+        }
+        while (unused < table.size() && !table[unused].empty())
+        {
+            unused++;
+        }
+        size_t slot = unused;
+        if (slot == table.size())
+        {
+            while (reusable < table.size() && present[reusable])
+            {
+                reusable++;
+            }
+            if (reusable == table.size())
+            {
+                throw std::out_of_range(
+                    "Maximum number of IPMI sensors exceeded.");
+            }
+            slot = reusable;
+        }
+        table[slot] = sensor.first;
+        present[slot] = true;
+        slots[index++] = slot;
+        changed = true;
+    }
+    return changed;
+}
+
+/** @brief the sensors by LUN and number, for the lookups of the reading
+ *         commands; the paths belong to the subtree it holds
+ */
+struct SensorNumberIndex
+{
+    std::shared_ptr<const SensorSubTree> tree;
+    std::array<SensorIndexEntry, 3 * sensorsPerIndexLUN> entries{};
+};
+
+SensorNumberIndex sensorIndex;
+
+std::array<SensorReadStats, 3 * sensorsPerIndexLUN> sensorReadStats;
+
+std::optional<size_t> sensorIndexPosition(uint16_t sensorNum)
+{
+    size_t number = sensorNum & 0xFF;
+    switch (sensorNum >> 8)
+    {
+        case 0:
+            return number;
+        case lun1Sensor0 >> 8:
+            return sensorsPerIndexLUN + number;
+        case lun3Sensor0 >> 8:
+            return 2 * sensorsPerIndexLUN + number;
+        default:
+            return std::nullopt;
+    }
+}
+
+} // namespace
+
 bool getSensorNumMap(std::shared_ptr<SensorNumMap>& sensorNumMap)
 {
     static std::shared_ptr<SensorNumMap> sensorNumMapPtr;
     bool sensorNumMapUpated = false;
     static uint16_t prevSensorUpdatedIndex = 0;
-    std::shared_ptr<SensorSubTree> sensorTree;
+    std::shared_ptr<const SensorSubTree> sensorTree;
     uint16_t curSensorUpdatedIndex = details::getSensorSubtree(sensorTree);
     if (!sensorTree)
     {
@@ -90,47 +560,141 @@ bool getSensorNumMap(std::shared_ptr<SensorNumMap>& sensorNumMap)
     }
     prevSensorUpdatedIndex = curSensorUpdatedIndex;
 
-    sensorNumMapPtr = std::make_shared<SensorNumMap>();
+    static SensorNumberTable sensorNumbers = loadSensorNumbers();
+    std::vector<std::optional<size_t>> slots;
+    if (allocateSensorNumbers(sensorNumbers, *sensorTree, slots))
+    {
+        saveSensorNumbers(sensorNumbers);
+    }
 
-    uint16_t sensorNum = 0;
-    uint16_t sensorIndex = 0;
+    sensorNumMapPtr = std::make_shared<SensorNumMap>();
+    // holds on to the previous subtree until the statistics are compared
+    SensorNumberIndex previousIndex = std::move(sensorIndex);
+    sensorIndex = SensorNumberIndex();
+    sensorIndex.tree = sensorTree;
+    size_t index = 0;
     for (const auto& sensor : *sensorTree)
     {
-        sensorNumMapPtr->insert(
-            SensorNumMap::value_type(sensorNum, sensor.first));
-        sensorIndex++;
-        if (sensorIndex == maxSensorsPerLUN)
+        uint16_t number = slotSensorNumber(*slots[index++]);
+        sensorNumMapPtr->insert(SensorNumMap::value_type(number, sensor.first));
+        SensorIndexEntry& entry =
+            sensorIndex.entries[*sensorIndexPosition(number)];
+        entry.path = &sensor.first;
+        entry.codes = getSensorCodesFromPath(sensor.first);
+        if (!sensor.second.empty())
         {
-            sensorIndex = lun1Sensor0;
+            entry.connection = &sensorName(sensor.second.begin()->first);
         }
-        else if (sensorIndex == (lun1Sensor0 | maxSensorsPerLUN))
-        {
-            // Skip assigning LUN 0x2 any sensors
-            sensorIndex = lun3Sensor0;
-        }
-        else if (sensorIndex == (lun3Sensor0 | maxSensorsPerLUN))
+    }
+    for (size_t position = 0; position < sensorReadStats.size(); position++)
+    {
+        const std::string* previous = previousIndex.entries[position].path;
+        const std::string* current = sensorIndex.entries[position].path;
+        if (!previous || !current || *previous != *current)
         {
-            // this is an error, too many IPMI sensors
-            throw std::out_of_range("Maximum number of IPMI sensors exceeded.");
+            sensorReadStats[position].reset();
         }
-        sensorNum = sensorIndex;
     }
     sensorNumMap = sensorNumMapPtr;
     sensorNumMapUpated = true;
     return sensorNumMapUpated;
 }
+
+const SensorIndexEntry& getSensorIndexEntry(uint16_t sensorNum)
+{
+    static const SensorIndexEntry noSensor;
+    // the index is rebuilt along with the numbering, whenever a new
+    // subtree was swapped in
+    if (!sensorTreePtr || sensorIndex.tree != sensorTreePtr)
+    {
+        std::shared_ptr<SensorNumMap> sensorNumMap;
+        getSensorNumMap(sensorNumMap);
+    }
+    std::optional<size_t> position = sensorIndexPosition(sensorNum);
+    if (!position)
+    {
+        return noSensor;
+    }
+    return sensorIndex.entries[*position];
+}
+
+void SensorReadStats::record(bool failed, bool noReading, bool fetched,
+                             double reading,
+                             std::chrono::steady_clock::duration latency)
+{
+    constexpr auto relaxed = std::memory_order_relaxed;
+    uint64_t us =
+        std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    reads.fetch_add(1, relaxed);
+    if (failed)
+    {
+        failures.fetch_add(1, relaxed);
+    }
+    if (noReading)
+    {
+        unavailable.fetch_add(1, relaxed);
+    }
+    if (fetched)
+    {
+        dbusFetches.fetch_add(1, relaxed);
+    }
+    totalLatencyUs.fetch_add(us, relaxed);
+    uint64_t longest = maxLatencyUs.load(relaxed);
+    while (us > longest &&
+           !maxLatencyUs.compare_exchange_weak(longest, us, relaxed))
+    {
+    }
+    if (failed || noReading || !std::isfinite(reading))
+    {
+        return;
+    }
+    double lowest = minReading.load(relaxed);
+    while ((std::isnan(lowest) || reading < lowest) &&
+           !minReading.compare_exchange_weak(lowest, reading, relaxed))
+    {
+    }
+    double highest = maxReading.load(relaxed);
+    while ((std::isnan(highest) || reading > highest) &&
+           !maxReading.compare_exchange_weak(highest, reading, relaxed))
+    {
+    }
+}
+
+void SensorReadStats::reset()
+{
+    constexpr auto relaxed = std::memory_order_relaxed;
+    reads.store(0, relaxed);
+    failures.store(0, relaxed);
+    unavailable.store(0, relaxed);
+    dbusFetches.store(0, relaxed);
+    totalLatencyUs.store(0, relaxed);
+    maxLatencyUs.store(0, relaxed);
+    minReading.store(std::numeric_limits<double>::quiet_NaN(), relaxed);
+    maxReading.store(std::numeric_limits<double>::quiet_NaN(), relaxed);
+}
+
+SensorReadStats* getSensorReadStats(uint16_t sensorNum)
+{
+    std::optional<size_t> position = sensorIndexPosition(sensorNum);
+    if (!position)
+    {
+        return nullptr;
+    }
+    return &sensorReadStats[*position];
+}
+
 } // namespace details
 
-bool getSensorSubtree(SensorSubTree& subtree)
+bool getSensorSubtree(std::shared_ptr<const SensorSubTree>& subtree)
 {
-    std::shared_ptr<SensorSubTree> sensorTree;
+    std::shared_ptr<const SensorSubTree> sensorTree;
     details::getSensorSubtree(sensorTree);
     if (!sensorTree)
     {
         return false;
     }
 
-    subtree = *sensorTree;
+    subtree = std::move(sensorTree);
     return true;
 }
 
@@ -175,15 +739,12 @@ uint16_t getSensorNumberFromPath(const std::string& path)
         return invalidSensorNumber;
     }
 
-    try
-    {
-        return sensorNumMapPtr->right.at(path);
-    }
-    catch (std::out_of_range& e)
+    auto sensor = sensorNumMapPtr->right.find(path);
+    if (sensor == sensorNumMapPtr->right.end())
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(e.what());
         return invalidSensorNumber;
     }
+    return sensor->second;
 }
 
 uint8_t getSensorEventTypeFromPath(const std::string& path)
@@ -192,24 +753,36 @@ uint8_t getSensorEventTypeFromPath(const std::string& path)
     return 0x1; // reading type = threshold
 }
 
-std::string getPathFromSensorNumber(uint16_t sensorNum)
+SensorPathCodes getSensorCodesFromPath(const std::string& path)
 {
-    std::shared_ptr<SensorNumMap> sensorNumMapPtr;
-    details::getSensorNumMap(sensorNumMapPtr);
-    if (!sensorNumMapPtr)
-    {
-        return std::string();
-    }
-
-    try
+    static const boost::container::flat_map<std::string_view, SensorUnits>
+        sensorUnits{{{"temperature", SensorUnits::degreesC},
+                     {"voltage", SensorUnits::volts},
+                     {"current", SensorUnits::amps},
+                     {"fan_tach", SensorUnits::rpm},
+                     {"power", SensorUnits::watts}}};
+
+    SensorPathCodes codes;
+    std::string type = getSensorTypeStringFromPath(path);
+    auto findSensor = sensorTypes.find(type.c_str());
+    if (findSensor != sensorTypes.end())
     {
-        return sensorNumMapPtr->left.at(sensorNum);
-    }
-    catch (std::out_of_range& e)
+        codes.sensorType = static_cast<uint8_t>(findSensor->second);
+    } // else default 0x0 RESERVED
+    auto findUnits = sensorUnits.find(type);
+    if (findUnits != sensorUnits.end())
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(e.what());
-        return std::string();
-    }
+        codes.unitsBase = static_cast<uint8_t>(findUnits->second);
+    } // else default 0x0 unspecified
+    codes.eventReadingType = getSensorEventTypeFromPath(path);
+    return codes;
+}
+
+std::string getPathFromSensorNumber(uint16_t sensorNum)
+{
+    const details::SensorIndexEntry& sensor =
+        details::getSensorIndexEntry(sensorNum);
+    return sensor.path ? *sensor.path : std::string();
 }
 
 namespace ipmi
@@ -219,19 +792,11 @@ std::map<std::string, std::vector<std::string>>
     getObjectInterfaces(const char* path)
 {
     std::map<std::string, std::vector<std::string>> interfacesResponse;
-    std::vector<std::string> interfaces;
     std::shared_ptr<sdbusplus::asio::connection> dbus = getSdBus();
 
-    sdbusplus::message::message getObjectMessage =
-        dbus->new_method_call("xyz.openbmc_project.ObjectMapper",
-                              "/xyz/openbmc_project/object_mapper",
-                              "xyz.openbmc_project.ObjectMapper", "GetObject");
-    getObjectMessage.append(path, interfaces);
-
     try
     {
-        sdbusplus::message::message response = dbus->call(getObjectMessage);
-        response.read(interfacesResponse);
+        interfacesResponse = ipmi::mapper::getObject(*dbus, path, {});
     }
     catch (const std::exception& e)
     {
@@ -311,8 +876,6 @@ void updateIpmiFromAssociation(const std::string& path,
                                const DbusInterfaceMap& sensorMap,
                                uint8_t& entityId, uint8_t& entityInstance)
 {
-    namespace fs = std::filesystem;
-
     auto sensorAssociationObject =
         sensorMap.find("xyz.openbmc_project.Association.Definitions");
     if (sensorAssociationObject == sensorMap.end())
@@ -339,11 +902,20 @@ void updateIpmiFromAssociation(const std::string& path,
         return;
     }
 
-    std::vector<Association> associationValues =
-        std::get<std::vector<Association>>(associationObject->second);
+    updateIpmiFromAssociation(
+        path, std::get<std::vector<Association>>(associationObject->second),
+        entityId, entityInstance);
+}
+
+// Same as the above, with the Associations property already read.
+void updateIpmiFromAssociation(const std::string& path,
+                               const std::vector<Association>& associations,
+                               uint8_t& entityId, uint8_t& entityInstance)
+{
+    namespace fs = std::filesystem;
 
     // loop through the Associations looking for the right one:
-    for (const auto& entry : associationValues)
+    for (const auto& entry : associations)
     {
         // forward, reverse, endpoint
         const std::string& forward = std::get<0>(entry);
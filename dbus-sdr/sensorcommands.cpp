@@ -20,31 +20,58 @@
 #include "dbus-sdr/sensorutils.hpp"
 #include "dbus-sdr/storagecommands.hpp"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <systemd/sd-bus.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <array>
+#include <bitset>
 #include <boost/algorithm/string.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <cerrno>
 #include <chrono>
 #include <cmath>
 #include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <ipmid-host/cmd.hpp>
 #include <ipmid/api.hpp>
+#include <ipmid/dbus-signals.hpp>
+#include <ipmid/iana.hpp>
+#include <ipmid/oemopenbmc.hpp>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
+#include <limits>
 #include <map>
 #include <memory>
 #include <optional>
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <stdexcept>
+#include <tuple>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace ipmi
 {
 static constexpr int sensorMapUpdatePeriod = 10;
 static constexpr int sensorMapSdrUpdatePeriod = 60;
+// full GetManagedObjects resync of a signal-maintained SensorCache entry
+static constexpr int sensorMapResyncPeriod = 300;
 
 constexpr size_t maxSDRTotalSize =
     76; // Largest SDR Record Size (type 01) + SDR Overheader Size
@@ -56,179 +83,821 @@ static uint32_t sdrLastRemove = noTimestamp;
 static constexpr size_t lastRecordIndex = 0xFFFF;
 static constexpr int GENERAL_ERROR = -1;
 
-static boost::container::flat_map<std::string, ObjectValueTree> SensorCache;
+static constexpr const char* sensorValueInterface =
+    "xyz.openbmc_project.Sensor.Value";
+static constexpr const char* warningInterface =
+    "xyz.openbmc_project.Sensor.Threshold.Warning";
+static constexpr const char* criticalInterface =
+    "xyz.openbmc_project.Sensor.Threshold.Critical";
+static constexpr const char* availabilityInterface =
+    "xyz.openbmc_project.State.Decorator.Availability";
+static constexpr const char* associationInterface =
+    "xyz.openbmc_project.Association.Definitions";
+
+// the properties IPMI reads of one sensor object, decoded out of its D-Bus
+// interfaces; the has* flags tell which interfaces the object implements
+struct SensorRecord
+{
+    bool hasValue = false;
+    bool hasWarning = false;
+    bool hasCritical = false;
+    bool hasAvailability = false;
+    bool hasAssociations = false;
+    std::optional<double> value;
+    std::optional<double> maxValue;
+    std::optional<double> minValue;
+    std::optional<double> warningHigh;
+    std::optional<double> warningLow;
+    std::optional<double> criticalHigh;
+    std::optional<double> criticalLow;
+    bool warningAlarmHigh = false;
+    bool warningAlarmLow = false;
+    bool criticalAlarmHigh = false;
+    bool criticalAlarmLow = false;
+    std::optional<bool> available;
+    std::vector<Association> associations;
+};
 
-// Specify the comparison required to sort and find char* map objects
-struct CmpStr
+// sensor records by connection, then by object path
+static boost::container::flat_map<
+    std::string, boost::container::flat_map<std::string, SensorRecord>>
+    SensorCache;
+
+// materialized SDR repository: every record back to back in one image and
+// the byte offset of each record ID into it, plus one trailing end offset.
+// The record ID of a sensor record is the allocation slot of its sensor
+// number, so it stays with the sensor when others come and go; the FRU and
+// type 12 records follow the maxIPMISensors slots, and the record IDs of
+// the free slots have no record
+struct SdrRepository
 {
-    bool operator()(const char* a, const char* b) const
+    // the image built in memory; one loaded from sdrCacheFile stays in the
+    // mapping of the file instead, which is only ever replaced by a rename
+    std::vector<uint8_t> image;
+    std::shared_ptr<const void> mapping;
+    const uint8_t* mappedImage = nullptr;
+    size_t mappedSize = 0;
+    std::vector<size_t> offsets;
+    uint32_t lastAdd = noTimestamp;
+    uint32_t lastRemove = noTimestamp;
+    // records the repository holds, less than the record IDs being sparse
+    size_t recordCount = 0;
+    bool incomplete = false;
+    // loaded from sdrCacheFile and not yet checked against D-Bus
+    bool persisted = false;
+    std::chrono::time_point<std::chrono::steady_clock> built;
+
+    const uint8_t* imageData() const
     {
-        return std::strcmp(a, b) < 0;
+        return mapping ? mappedImage : image.data();
     }
+
+    size_t imageSize() const
+    {
+        return mapping ? mappedSize : image.size();
+    }
+};
+static SdrRepository sdrRepository;
+// the records the current reservation read in part, so that every part
+// of a record comes from one copy even if the image is rebuilt in between
+static constexpr size_t maxPinnedSdrRecords = 16;
+static boost::container::flat_map<uint16_t, std::vector<uint8_t>>
+    pinnedSdrRecords;
+// the record ID each requester, by channel, session and slave address, was
+// told follows the one it last started to read, to tell the hosts walking
+// the repository; the sensors
+// of the next few records of a walk are fetched ahead of their reads
+static constexpr size_t sdrPrefetchRecords = 8;
+static constexpr size_t maxSdrWalkers = 16;
+static boost::container::flat_map<std::tuple<int, uint32_t, int>, uint16_t>
+    sdrWalkers;
+// set when a threshold changed, so the next SDR access rebuilds the image
+static bool sdrRepositoryDirty = true;
+// set while a persisted image is being checked in the background
+static bool sdrRepositoryRefreshing = false;
+
+// on-disk copy of the SDR image and its sensor numbering, for cold starts
+static constexpr const char* sdrCacheFile = "/var/lib/ipmi/sdr_cache";
+static constexpr uint32_t sdrCacheMagic = 0x52445349; // "ISDR"
+static constexpr uint16_t sdrCacheVersion = 2;
+
+struct SdrCacheHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sensorCount;
+    uint32_t recordCount;
+    uint32_t recordIDs;
+    uint32_t imageSize;
 };
-const static boost::container::flat_map<const char*, SensorUnits, CmpStr>
-    sensorUnits{{{"temperature", SensorUnits::degreesC},
-                 {"voltage", SensorUnits::volts},
-                 {"current", SensorUnits::amps},
-                 {"fan_tach", SensorUnits::rpm},
-                 {"power", SensorUnits::watts}}};
 
-void registerSensorFunctions() __attribute__((constructor));
+// sensor number to path map the persisted image was generated with
+static std::vector<std::pair<uint16_t, std::string>> persistedSensorNumbers;
 
-static sdbusplus::bus::match::match sensorAdded(
-    *getSdBus(),
-    "type='signal',member='InterfacesAdded',arg0path='/xyz/openbmc_project/"
-    "sensors/'",
-    [](sdbusplus::message::message& m) {
-        getSensorTree().clear();
-        sdrLastAdd = std::chrono::duration_cast<std::chrono::seconds>(
-                         std::chrono::system_clock::now().time_since_epoch())
-                         .count();
-    });
+// per record ID change tracking for the Get SDR Changes OEM command: every
+// image that changes records bumps sdrGeneration, and each record ID keeps
+// the generation it was added in and the one it last changed or was
+// removed in
+struct SdrRecordChange
+{
+    size_t hash = 0;
+    uint64_t added = 0;
+    uint64_t changed = 0;
+    bool present = false;
+};
+static std::vector<SdrRecordChange> sdrRecordChanges;
+// the generations start at the time of the first image in microseconds, so
+// they keep growing across restarts and a host finds out when the one it
+// synced to predates them
+static uint64_t sdrFirstGeneration = 0;
+static uint64_t sdrGeneration = 0;
 
-static sdbusplus::bus::match::match sensorRemoved(
-    *getSdBus(),
-    "type='signal',member='InterfacesRemoved',arg0path='/xyz/openbmc_project/"
-    "sensors/'",
-    [](sdbusplus::message::message& m) {
-        getSensorTree().clear();
-        sdrLastRemove = std::chrono::duration_cast<std::chrono::seconds>(
-                            std::chrono::system_clock::now().time_since_epoch())
-                            .count();
-    });
+void registerSensorFunctions() __attribute__((constructor));
+
+static dbus_signals::Subscription sensorAdded =
+    dbus_signals::onInterfacesAdded(
+        "/xyz/openbmc_project/sensors",
+        [](const dbus_signals::InterfacesAdded&) {
+            getSensorTree().reset();
+            sdrLastAdd =
+                std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+        });
+
+static dbus_signals::Subscription sensorRemoved =
+    dbus_signals::onInterfacesRemoved(
+        "/xyz/openbmc_project/sensors",
+        [](const dbus_signals::InterfacesRemoved&) {
+            getSensorTree().reset();
+            sdrLastRemove =
+                std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+        });
+
+/** @brief the alarms of a threshold sensor, the bits of its events */
+enum class ThresholdAlarm : size_t
+{
+    warningHigh,
+    warningLow,
+    criticalHigh,
+    criticalLow,
+};
+static constexpr size_t thresholdAlarms = 4;
 
 // this keeps track of deassertions for sensor event status command. A
-// deasertion can only happen if an assertion was seen first.
-static boost::container::flat_map<
-    std::string, boost::container::flat_map<std::string, std::optional<bool>>>
-    thresholdDeassertMap;
+// deasertion can only happen if an assertion was seen first. By sensor
+// number, bit n is set once alarm n was asserted and bit
+// thresholdAlarms + n while it is.
+using ThresholdEvents = std::bitset<2 * thresholdAlarms>;
+static std::array<ThresholdEvents, 4 * details::sensorsPerIndexLUN>
+    thresholdEvents;
+
+/** @brief an alarm property of the Sensor.Threshold interfaces, by its
+ *         exact name; the other properties are threshold values
+ */
+struct ThresholdProperty
+{
+    std::string_view name;
+    // nullopt for the alarms Get Sensor Event Status doesn't report
+    std::optional<ThresholdAlarm> alarm;
+};
 
-static sdbusplus::bus::match::match thresholdChanged(
-    *getSdBus(),
-    "type='signal',member='PropertiesChanged',interface='org.freedesktop.DBus."
-    "Properties',arg0namespace='xyz.openbmc_project.Sensor.Threshold'",
-    [](sdbusplus::message::message& m) {
-        boost::container::flat_map<std::string, std::variant<bool, double>>
-            values;
-        m.read(std::string(), values);
-
-        auto findAssert =
-            std::find_if(values.begin(), values.end(), [](const auto& pair) {
-                return pair.first.find("Alarm") != std::string::npos;
-            });
-        if (findAssert != values.end())
+static constexpr std::array<ThresholdProperty, 10> thresholdProperties{{
+    {"WarningAlarmHigh", ThresholdAlarm::warningHigh},
+    {"WarningAlarmLow", ThresholdAlarm::warningLow},
+    {"CriticalAlarmHigh", ThresholdAlarm::criticalHigh},
+    {"CriticalAlarmLow", ThresholdAlarm::criticalLow},
+    {"HardShutdownAlarmHigh", std::nullopt},
+    {"HardShutdownAlarmLow", std::nullopt},
+    {"SoftShutdownAlarmHigh", std::nullopt},
+    {"SoftShutdownAlarmLow", std::nullopt},
+    {"PerformanceLossAlarmHigh", std::nullopt},
+    {"PerformanceLossAlarmLow", std::nullopt},
+}};
+
+static const ThresholdProperty* findThresholdProperty(std::string_view name)
+{
+    for (const ThresholdProperty& property : thresholdProperties)
+    {
+        if (property.name == name)
+        {
+            return &property;
+        }
+    }
+    return nullptr;
+}
+
+/** @brief record an alarm change of a signal */
+static void thresholdAlarmChanged(const char* path, uint16_t sensorNum,
+                                  ThresholdAlarm alarm, bool asserted)
+{
+    if (sensorNum >= thresholdEvents.size())
+    {
+        return;
+    }
+    ThresholdEvents& events = thresholdEvents[sensorNum];
+    size_t seen = static_cast<size_t>(alarm);
+    size_t current = thresholdAlarms + seen;
+    if (asserted)
+    {
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            "thresholdChanged: Assert",
+            phosphor::logging::entry("SENSOR=%s", path));
+        events.set(seen);
+        events.set(current);
+    }
+    else if (events.test(seen))
+    {
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            "thresholdChanged: deassert",
+            phosphor::logging::entry("SENSOR=%s", path));
+        events.reset(current);
+    }
+}
+
+/** @brief decode a Sensor.Threshold PropertiesChanged signal in place,
+ *         without building a map of its properties
+ */
+static void decodeThresholdSignal(sdbusplus::message::message& m)
+{
+    sd_bus_message* msg = m.get();
+    if (sd_bus_message_skip(msg, "s") < 0 ||
+        sd_bus_message_enter_container(msg, SD_BUS_TYPE_ARRAY, "{sv}") < 0)
+    {
+        return;
+    }
+    std::optional<uint16_t> sensorNum;
+    while (sd_bus_message_enter_container(msg, SD_BUS_TYPE_DICT_ENTRY, "sv") >
+           0)
+    {
+        const char* name = nullptr;
+        if (sd_bus_message_read_basic(msg, SD_BUS_TYPE_STRING, &name) < 0)
+        {
+            return;
+        }
+        const ThresholdProperty* property = findThresholdProperty(name);
+        if (property == nullptr)
         {
-            auto ptr = std::get_if<bool>(&(findAssert->second));
-            if (ptr == nullptr)
+            // threshold values are part of the full sensor records
+            sdrRepositoryDirty = true;
+        }
+        if (property != nullptr && property->alarm)
+        {
+            int asserted = 0;
+            if (sd_bus_message_enter_container(msg, SD_BUS_TYPE_VARIANT,
+                                               "b") <= 0 ||
+                sd_bus_message_read_basic(msg, SD_BUS_TYPE_BOOLEAN,
+                                          &asserted) < 0 ||
+                sd_bus_message_exit_container(msg) < 0)
             {
                 phosphor::logging::log<phosphor::logging::level::ERR>(
                     "thresholdChanged: Assert non bool");
                 return;
             }
-            if (*ptr)
+            if (!sensorNum)
             {
-                phosphor::logging::log<phosphor::logging::level::INFO>(
-                    "thresholdChanged: Assert",
-                    phosphor::logging::entry("SENSOR=%s", m.get_path()));
-                thresholdDeassertMap[m.get_path()][findAssert->first] = *ptr;
-            }
-            else
-            {
-                auto& value =
-                    thresholdDeassertMap[m.get_path()][findAssert->first];
-                if (value)
-                {
-                    phosphor::logging::log<phosphor::logging::level::INFO>(
-                        "thresholdChanged: deassert",
-                        phosphor::logging::entry("SENSOR=%s", m.get_path()));
-                    value = *ptr;
-                }
+                sensorNum = getSensorNumberFromPath(m.get_path());
             }
+            thresholdAlarmChanged(m.get_path(), *sensorNum, *property->alarm,
+                                  asserted != 0);
         }
-    });
+        else if (sd_bus_message_skip(msg, "v") < 0)
+        {
+            return;
+        }
+        if (sd_bus_message_exit_container(msg) < 0)
+        {
+            return;
+        }
+    }
+}
 
-static void getSensorMaxMin(const DbusInterfaceMap& sensorMap, double& max,
+static sdbusplus::bus::match::match thresholdChanged(
+    *getSdBus(),
+    "type='signal',member='PropertiesChanged',interface='org.freedesktop.DBus."
+    "Properties',arg0namespace='xyz.openbmc_project.Sensor.Threshold'",
+    decodeThresholdSignal);
+
+static void getSensorMaxMin(const SensorRecord& sensor, double& max,
                             double& min)
 {
-    max = 127;
-    min = -128;
+    max = sensor.maxValue.value_or(127);
+    min = sensor.minValue.value_or(-128);
 
-    auto sensorObject = sensorMap.find("xyz.openbmc_project.Sensor.Value");
-    auto critical =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Critical");
-    auto warning =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Warning");
-
-    if (sensorObject != sensorMap.end())
+    if (sensor.criticalLow)
+    {
+        min = std::min(*sensor.criticalLow, min);
+    }
+    if (sensor.criticalHigh)
     {
-        auto maxMap = sensorObject->second.find("MaxValue");
-        auto minMap = sensorObject->second.find("MinValue");
+        max = std::max(*sensor.criticalHigh, max);
+    }
+    if (sensor.warningLow)
+    {
+        min = std::min(*sensor.warningLow, min);
+    }
+    if (sensor.warningHigh)
+    {
+        max = std::max(*sensor.warningHigh, max);
+    }
+}
+
+static boost::container::flat_map<
+    std::string, std::chrono::time_point<std::chrono::steady_clock>>
+    sensorCacheUpdateTime;
+
+// number of GetManagedObjects fetches, to tell the reads that waited on one
+static uint64_t sensorMapFetches = 0;
+
+// GetManagedObjects fetches a warm-up of SensorCache keeps in flight at once
+static constexpr size_t sensorWarmUpParallelism = 4;
+
+// what the warm-ups did: the connections of the last one and how long it
+// took, and when, after the provider was loaded, a sensor was first read
+// from a warm cache
+struct SensorWarmUpStats
+{
+    std::chrono::steady_clock::time_point loaded =
+        std::chrono::steady_clock::now();
+    uint64_t connections = 0;
+    uint64_t durationUs = 0;
+    std::optional<uint64_t> firstFastReadUs;
+};
+static SensorWarmUpStats sensorWarmUpStats;
+
+// the fetches in flight by connection, a read of a connection being fetched
+// waits on its timer, which is cancelled once the fetch is done
+static boost::container::flat_map<std::string,
+                                  std::shared_ptr<boost::asio::steady_timer>>
+    sensorMapFetching;
+
+// signal matches that apply deltas to SensorCache, one set per connection
+static boost::container::flat_map<
+    std::string, std::vector<std::unique_ptr<sdbusplus::bus::match::match>>>
+    sensorCacheMatches;
+
+// sensor change subscriptions of the hosts, by host and then by LUN and
+// sensor number; the changes are told to the host through the host command
+// path as (cmdSensorChanged + LUN, sensor number), a change queued already
+// is not queued again
+static constexpr size_t maxSensorSubscriptions = 64;
+static constexpr uint8_t cmdSensorChanged = 0x10;
+enum class SensorChange : uint8_t
+{
+    remove = 0,
+    delta = 1,
+    threshold = 2,
+};
+struct SensorSubscription
+{
+    SensorChange kind;
+    uint8_t value;
+    // the raw reading last told, signed for a signed sensor, nullopt while
+    // there is no reading; until a first one is taken any change is told
+    bool reported = false;
+    std::optional<int> steps;
+};
+static boost::container::flat_map<
+    phosphor::host::command::HostId,
+    boost::container::flat_map<uint16_t, SensorSubscription>>
+    sensorSubscriptions;
+
+// force the next getSensorMap on this connection to do a full refresh
+static void invalidateSensorCache(const std::string& sensorConnection)
+{
+    sensorCacheUpdateTime.erase(sensorConnection);
+}
+
+static std::optional<double> toDouble(const Value& value)
+{
+    return std::visit(
+        [](const auto& v) -> std::optional<double> {
+            if constexpr (std::is_arithmetic_v<std::decay_t<decltype(v)>>)
+            {
+                return static_cast<double>(v);
+            }
+            return std::nullopt;
+        },
+        value);
+}
+
+static bool toBool(const Value& value)
+{
+    const bool* flag = std::get_if<bool>(&value);
+    return flag && *flag;
+}
 
-        if (maxMap != sensorObject->second.end())
+/** @brief decode the properties of one interface into a sensor record
+ *  @param sensor - record of the sensor object
+ *  @param interface - interface the properties belong to
+ *  @param properties - the properties, all or the changed ones
+ *
+ *  @returns false when IPMI does not read the interface
+ */
+static bool updateSensorRecord(SensorRecord& sensor,
+                               const std::string& interface,
+                               const PropertyMap& properties)
+{
+    if (interface == sensorValueInterface)
+    {
+        sensor.hasValue = true;
+        for (const auto& [name, value] : properties)
         {
-            max = std::visit(VariantToDoubleVisitor(), maxMap->second);
+            if (name == "Value")
+            {
+                sensor.value = toDouble(value);
+            }
+            else if (name == "MaxValue")
+            {
+                sensor.maxValue = toDouble(value);
+            }
+            else if (name == "MinValue")
+            {
+                sensor.minValue = toDouble(value);
+            }
         }
-        if (minMap != sensorObject->second.end())
+    }
+    else if (interface == warningInterface)
+    {
+        sensor.hasWarning = true;
+        for (const auto& [name, value] : properties)
         {
-            min = std::visit(VariantToDoubleVisitor(), minMap->second);
+            if (name == "WarningHigh")
+            {
+                sensor.warningHigh = toDouble(value);
+            }
+            else if (name == "WarningLow")
+            {
+                sensor.warningLow = toDouble(value);
+            }
+            else if (name == "WarningAlarmHigh")
+            {
+                sensor.warningAlarmHigh = toBool(value);
+            }
+            else if (name == "WarningAlarmLow")
+            {
+                sensor.warningAlarmLow = toBool(value);
+            }
         }
     }
-    if (critical != sensorMap.end())
+    else if (interface == criticalInterface)
     {
-        auto lower = critical->second.find("CriticalLow");
-        auto upper = critical->second.find("CriticalHigh");
-        if (lower != critical->second.end())
+        sensor.hasCritical = true;
+        for (const auto& [name, value] : properties)
         {
-            double value = std::visit(VariantToDoubleVisitor(), lower->second);
-            min = std::min(value, min);
+            if (name == "CriticalHigh")
+            {
+                sensor.criticalHigh = toDouble(value);
+            }
+            else if (name == "CriticalLow")
+            {
+                sensor.criticalLow = toDouble(value);
+            }
+            else if (name == "CriticalAlarmHigh")
+            {
+                sensor.criticalAlarmHigh = toBool(value);
+            }
+            else if (name == "CriticalAlarmLow")
+            {
+                sensor.criticalAlarmLow = toBool(value);
+            }
         }
-        if (upper != critical->second.end())
+    }
+    else if (interface == availabilityInterface)
+    {
+        sensor.hasAvailability = true;
+        auto available = properties.find("Available");
+        if (available != properties.end())
         {
-            double value = std::visit(VariantToDoubleVisitor(), upper->second);
-            max = std::max(value, max);
+            const bool* flag = std::get_if<bool>(&available->second);
+            sensor.available =
+                flag ? std::optional<bool>(*flag) : std::nullopt;
         }
     }
-    if (warning != sensorMap.end())
+    else if (interface == associationInterface)
+    {
+        sensor.hasAssociations = true;
+        auto associations = properties.find("Associations");
+        if (associations != properties.end())
+        {
+            const auto* list = std::get_if<std::vector<Association>>(
+                &associations->second);
+            sensor.associations =
+                list ? *list : std::vector<Association>();
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+/** @brief drop an interface the sensor object no longer implements
+ *
+ *  @returns whether the record still holds an interface IPMI reads
+ */
+static bool removeSensorInterface(SensorRecord& sensor,
+                                  const std::string& interface)
+{
+    if (interface == sensorValueInterface)
+    {
+        sensor.hasValue = false;
+        sensor.value = sensor.maxValue = sensor.minValue = std::nullopt;
+    }
+    else if (interface == warningInterface)
+    {
+        sensor.hasWarning = false;
+        sensor.warningHigh = sensor.warningLow = std::nullopt;
+        sensor.warningAlarmHigh = sensor.warningAlarmLow = false;
+    }
+    else if (interface == criticalInterface)
     {
+        sensor.hasCritical = false;
+        sensor.criticalHigh = sensor.criticalLow = std::nullopt;
+        sensor.criticalAlarmHigh = sensor.criticalAlarmLow = false;
+    }
+    else if (interface == availabilityInterface)
+    {
+        sensor.hasAvailability = false;
+        sensor.available = std::nullopt;
+    }
+    else if (interface == associationInterface)
+    {
+        sensor.hasAssociations = false;
+        sensor.associations.clear();
+    }
+    return sensor.hasValue || sensor.hasWarning || sensor.hasCritical ||
+           sensor.hasAvailability || sensor.hasAssociations;
+}
+
+/** @brief compare the reading of a sensor with the one a subscription last
+ *         told, taking it as the one told when the change is to be told
+ *
+ *  @returns whether the change is to be told
+ */
+static bool sensorSubscriptionTriggered(SensorSubscription& subscription,
+                                        const SensorRecord& sensor)
+{
+    std::optional<int> steps;
+    int threshold = subscription.value;
+    double max = 0;
+    double min = 0;
+    getSensorMaxMin(sensor, max, min);
+    auto attributes = getSensorAttributes(max, min);
+    if (attributes && sensor.value && !std::isnan(*sensor.value) &&
+        sensor.available.value_or(true))
+    {
+        uint8_t raw = scaleIPMIValueFromDouble(*sensor.value, *attributes);
+        steps = attributes->bSigned ? static_cast<int8_t>(raw) : raw;
+        if (attributes->bSigned)
+        {
+            threshold = static_cast<int8_t>(subscription.value);
+        }
+    }
 
-        auto lower = warning->second.find("WarningLow");
-        auto upper = warning->second.find("WarningHigh");
-        if (lower != warning->second.end())
+    bool triggered = !subscription.reported ||
+                     steps.has_value() != subscription.steps.has_value();
+    if (!triggered && steps)
+    {
+        if (subscription.kind == SensorChange::delta)
         {
-            double value = std::visit(VariantToDoubleVisitor(), lower->second);
-            min = std::min(value, min);
+            triggered = std::abs(*steps - *subscription.steps) >=
+                        std::max<int>(subscription.value, 1);
         }
-        if (upper != warning->second.end())
+        else
         {
-            double value = std::visit(VariantToDoubleVisitor(), upper->second);
-            max = std::max(value, max);
+            triggered =
+                (*steps > threshold) != (*subscription.steps > threshold);
         }
     }
+    if (triggered)
+    {
+        subscription.reported = true;
+        subscription.steps = steps;
+    }
+    return triggered;
 }
 
-static bool getSensorMap(ipmi::Context::ptr ctx, std::string sensorConnection,
-                         std::string sensorPath, DbusInterfaceMap& sensorMap,
-                         int updatePeriod = sensorMapUpdatePeriod)
+/** @brief tell the hosts subscribed to a sensor that it changed */
+static void notifySensorSubscribers(const std::string& path,
+                                    const SensorRecord& sensor)
+{
+    uint16_t sensorKey = getSensorNumberFromPath(path);
+    if (sensorKey == invalidSensorNumber)
+    {
+        return;
+    }
+    for (auto& [hostId, subscriptions] : sensorSubscriptions)
+    {
+        auto subscription = subscriptions.find(sensorKey);
+        if (subscription == subscriptions.end() ||
+            !sensorSubscriptionTriggered(subscription->second, sensor))
+        {
+            continue;
+        }
+        ipmid_send_cmd_to_host(
+            std::make_tuple(
+                std::make_pair(
+                    static_cast<uint8_t>(cmdSensorChanged + (sensorKey >> 8)),
+                    static_cast<uint8_t>(sensorKey)),
+                [](phosphor::host::command::IpmiCmdData, bool) {}),
+            hostId);
+    }
+}
+
+static void sensorCachePropertiesChanged(const std::string& sensorConnection,
+                                         sdbusplus::message::message& m)
+{
+    auto connection = SensorCache.find(sensorConnection);
+    if (connection == SensorCache.end())
+    {
+        return;
+    }
+    std::string interface;
+    PropertyMap changed;
+    try
+    {
+        m.read(interface, changed);
+    }
+    catch (const sdbusplus::exception::SdBusError& e)
+    {
+        invalidateSensorCache(sensorConnection);
+        return;
+    }
+    auto path = connection->second.find(m.get_path());
+    if (path == connection->second.end())
+    {
+        return;
+    }
+    if (updateSensorRecord(path->second, interface, changed) &&
+        !sensorSubscriptions.empty())
+    {
+        notifySensorSubscribers(path->first, path->second);
+    }
+}
+
+static void sensorCacheInterfacesAdded(const std::string& sensorConnection,
+                                       sdbusplus::message::message& m)
 {
-    static boost::container::flat_map<
-        std::string, std::chrono::time_point<std::chrono::steady_clock>>
-        updateTimeMap;
+    auto connection = SensorCache.find(sensorConnection);
+    if (connection == SensorCache.end())
+    {
+        return;
+    }
+    sdbusplus::message::object_path path;
+    DbusInterfaceMap interfaces;
+    try
+    {
+        m.read(path, interfaces);
+    }
+    catch (const sdbusplus::exception::SdBusError& e)
+    {
+        invalidateSensorCache(sensorConnection);
+        return;
+    }
+    auto object = connection->second.find(path.str);
+    SensorRecord added =
+        object != connection->second.end() ? object->second : SensorRecord();
+    bool tracked = false;
+    for (const auto& [interface, properties] : interfaces)
+    {
+        tracked = updateSensorRecord(added, interface, properties) || tracked;
+    }
+    if (tracked)
+    {
+        connection->second.insert_or_assign(path.str, std::move(added));
+    }
+}
 
-    auto updateFind = updateTimeMap.find(sensorConnection);
+static void sensorCacheInterfacesRemoved(const std::string& sensorConnection,
+                                         sdbusplus::message::message& m)
+{
+    auto connection = SensorCache.find(sensorConnection);
+    if (connection == SensorCache.end())
+    {
+        return;
+    }
+    sdbusplus::message::object_path path;
+    std::vector<std::string> interfaces;
+    try
+    {
+        m.read(path, interfaces);
+    }
+    catch (const sdbusplus::exception::SdBusError& e)
+    {
+        invalidateSensorCache(sensorConnection);
+        return;
+    }
+    auto object = connection->second.find(path.str);
+    if (object == connection->second.end())
+    {
+        return;
+    }
+    bool tracked = true;
+    for (const auto& interface : interfaces)
+    {
+        tracked = removeSensorInterface(object->second, interface);
+    }
+    if (!tracked)
+    {
+        connection->second.erase(object);
+    }
+}
+
+// subscribe to the signals of a connection so its cache entry stays current
+static void watchSensorCache(const std::string& sensorConnection)
+{
+    auto& matches = sensorCacheMatches[sensorConnection];
+    if (!matches.empty())
+    {
+        return;
+    }
+    const std::string sender = "sender='" + sensorConnection + "',";
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match::match>(
+        *getSdBus(),
+        "type='signal'," + sender +
+            "interface='org.freedesktop.DBus.Properties',"
+            "member='PropertiesChanged',"
+            "path_namespace='/xyz/openbmc_project/sensors'",
+        [sensorConnection](sdbusplus::message::message& m) {
+            sensorCachePropertiesChanged(sensorConnection, m);
+        }));
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match::match>(
+        *getSdBus(),
+        "type='signal'," + sender +
+            "member='InterfacesAdded',"
+            "arg0path='/xyz/openbmc_project/sensors/'",
+        [sensorConnection](sdbusplus::message::message& m) {
+            sensorCacheInterfacesAdded(sensorConnection, m);
+        }));
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match::match>(
+        *getSdBus(),
+        "type='signal'," + sender +
+            "member='InterfacesRemoved',"
+            "arg0path='/xyz/openbmc_project/sensors/'",
+        [sensorConnection](sdbusplus::message::message& m) {
+            sensorCacheInterfacesRemoved(sensorConnection, m);
+        }));
+}
+
+/** @brief check whether the SensorCache entry of a connection is due for a
+ *         GetManagedObjects fetch
+ *  @param sensorConnection - the connection
+ *  @param updatePeriod - age in seconds after which the entry is refreshed
+ */
+static bool sensorMapStale(const std::string& sensorConnection,
+                           int updatePeriod)
+{
+    auto updateFind = sensorCacheUpdateTime.find(sensorConnection);
     auto lastUpdate = std::chrono::time_point<std::chrono::steady_clock>();
-    if (updateFind != updateTimeMap.end())
+    if (updateFind != sensorCacheUpdateTime.end())
     {
         lastUpdate = updateFind->second;
     }
 
-    auto now = std::chrono::steady_clock::now();
+    // Once the signals of a connection are watched the cache is kept
+    // current in place, so only resync now and then as a safety net
+    if (sensorCacheMatches.find(sensorConnection) != sensorCacheMatches.end())
+    {
+        updatePeriod = std::max(updatePeriod, sensorMapResyncPeriod);
+    }
+
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::steady_clock::now() - lastUpdate)
+               .count() > updatePeriod;
+}
 
-    if (std::chrono::duration_cast<std::chrono::seconds>(now - lastUpdate)
-            .count() > updatePeriod)
+static bool getSensorMap(ipmi::Context::ptr ctx, std::string sensorConnection,
+                         std::string sensorPath, SensorRecord& sensor,
+                         int updatePeriod = sensorMapUpdatePeriod)
+{
+    auto fetching = sensorMapFetching.find(sensorConnection);
+    if (fetching != sensorMapFetching.end())
     {
+        // a prefetch or another read is fetching this connection already
+        std::shared_ptr<boost::asio::steady_timer> done = fetching->second;
+        boost::system::error_code ec;
+        done->async_wait(ctx->yield[ec]);
+    }
+    else if (sensorMapStale(sensorConnection, updatePeriod))
+    {
+        // subscribe ahead of the fetch so no change in between is missed
+        watchSensorCache(sensorConnection);
+
+        sensorMapFetches++;
+        auto done = std::make_shared<boost::asio::steady_timer>(
+            *getIoContext(), boost::asio::steady_timer::time_point::max());
+        sensorMapFetching.emplace(sensorConnection, done);
         ObjectValueTree managedObjects;
         boost::system::error_code ec = getManagedObjects(
             ctx, sensorConnection.c_str(), "/", managedObjects);
+        // the waiters resume once this read yields again, after the
+        // cache is updated
+        sensorMapFetching.erase(sensorConnection);
+        done->cancel();
         if (ec)
         {
             phosphor::logging::log<phosphor::logging::level::ERR>(
@@ -238,10 +907,30 @@ static bool getSensorMap(ipmi::Context::ptr ctx, std::string sensorConnection,
             return false;
         }
 
-        SensorCache[sensorConnection] = managedObjects;
+        // only the objects implementing an interface IPMI reads are kept,
+        // GetManagedObjects answers them in path order
+        boost::container::flat_map<std::string, SensorRecord> records;
+        for (const auto& [path, interfaces] : managedObjects)
+        {
+            SensorRecord record;
+            bool tracked = false;
+            for (const auto& [interface, properties] : interfaces)
+            {
+                tracked =
+                    updateSensorRecord(record, interface, properties) ||
+                    tracked;
+            }
+            if (tracked)
+            {
+                records.emplace_hint(records.end(), path.str,
+                                     std::move(record));
+            }
+        }
+        SensorCache[sensorConnection] = std::move(records);
         // Update time after finish building the map which allow the
         // data to be cached for updatePeriod plus the build time.
-        updateTimeMap[sensorConnection] = std::chrono::steady_clock::now();
+        sensorCacheUpdateTime[sensorConnection] =
+            std::chrono::steady_clock::now();
     }
     auto connection = SensorCache.find(sensorConnection);
     if (connection == SensorCache.end())
@@ -253,11 +942,87 @@ static bool getSensorMap(ipmi::Context::ptr ctx, std::string sensorConnection,
     {
         return false;
     }
-    sensorMap = path->second;
+    sensor = path->second;
 
     return true;
 }
 
+/** @brief fetch the stale SensorCache entries of every connection of the
+ *  sensor subtree, a few at a time, ahead of the first reads of the host
+ */
+static void warmUpSensorCache()
+{
+    std::shared_ptr<const SensorSubTree> tree;
+    details::getSensorSubtree(tree);
+    if (!tree)
+    {
+        return;
+    }
+
+    auto pending = std::make_shared<std::deque<std::string>>();
+    boost::container::flat_set<std::string> seen;
+    for (const auto& [path, services] : *tree)
+    {
+        for (const auto& [service, interfaces] : services)
+        {
+            const std::string& connection = sensorName(service);
+            if (seen.insert(connection).second &&
+                sensorMapFetching.find(connection) ==
+                    sensorMapFetching.end() &&
+                sensorMapStale(connection, sensorMapUpdatePeriod))
+            {
+                pending->push_back(connection);
+            }
+        }
+    }
+    if (pending->empty())
+    {
+        return;
+    }
+
+    uint64_t connections = pending->size();
+    auto start = std::chrono::steady_clock::now();
+    size_t workers = std::min(sensorWarmUpParallelism, pending->size());
+    auto running = std::make_shared<size_t>(workers);
+    auto warmUp = [pending, running, connections,
+                   start](boost::asio::yield_context yield) {
+        auto ctx = std::make_shared<ipmi::Context>(
+            getSdBus(), ipmi::netFnSensor, 0,
+            ipmi::sensor_event::cmdGetSensorReading, 0, 0, 0,
+            ipmi::Privilege::Admin, 0, 0, yield);
+        while (!pending->empty())
+        {
+            std::string connection = std::move(pending->front());
+            pending->pop_front();
+            // no path, only the cache entry is wanted
+            SensorRecord sensor;
+            getSensorMap(ctx, connection, std::string(), sensor);
+        }
+        if (--*running != 0)
+        {
+            return;
+        }
+        sensorWarmUpStats.connections = connections;
+        sensorWarmUpStats.durationUs =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            "Sensor cache warmed up",
+            phosphor::logging::entry(
+                "CONNECTIONS=%llu",
+                static_cast<unsigned long long>(connections)),
+            phosphor::logging::entry(
+                "DURATION_MS=%llu",
+                static_cast<unsigned long long>(
+                    sensorWarmUpStats.durationUs / 1000)));
+    };
+    for (size_t i = 0; i < workers; i++)
+    {
+        boost::asio::spawn(*getIoContext(), warmUp);
+    }
+}
+
 ipmi::RspType<> ipmiSenPlatformEvent(uint8_t generatorID, uint8_t evmRev,
                                      uint8_t sensorType, uint8_t sensorNum,
                                      uint8_t eventType, uint8_t eventData1,
@@ -282,39 +1047,31 @@ ipmi::RspType<> ipmiSetSensorReading(ipmi::Context::ptr ctx,
         return ipmi::response(status);
     }
 
-    DbusInterfaceMap sensorMap;
-    if (!getSensorMap(ctx, connection, path, sensorMap))
+    SensorRecord sensor;
+    if (!getSensorMap(ctx, connection, path, sensor))
     {
         return ipmi::responseResponseError();
     }
-    auto sensorObject = sensorMap.find("xyz.openbmc_project.Sensor.Value");
-
-    if (sensorObject == sensorMap.end() ||
-        sensorObject->second.find("Value") == sensorObject->second.end())
+    if (!sensor.value)
     {
         return ipmi::responseResponseError();
     }
 
     double max = 0;
     double min = 0;
-    getSensorMaxMin(sensorMap, max, min);
-
-    int16_t mValue = 0;
-    int16_t bValue = 0;
-    int8_t rExp = 0;
-    int8_t bExp = 0;
-    bool bSigned = false;
+    getSensorMaxMin(sensor, max, min);
 
-    if (!getSensorAttributes(max, min, mValue, rExp, bValue, bExp, bSigned))
+    auto attributes = getSensorAttributes(max, min);
+    if (!attributes)
     {
         return ipmi::responseResponseError();
     }
 
-    double value = bSigned ? ((int8_t)reading) : reading;
+    double value = attributes->bSigned ? ((int8_t)reading) : reading;
 
-    value *= ((double)mValue);
-    value += ((double)bValue) * std::pow(10.0, bExp);
-    value *= std::pow(10.0, rExp);
+    value *= ((double)attributes->mValue);
+    value += ((double)attributes->bValue) * std::pow(10.0, attributes->bExp);
+    value *= std::pow(10.0, attributes->rExp);
 
     if constexpr (debug)
     {
@@ -327,8 +1084,7 @@ ipmi::RspType<> ipmiSetSensorReading(ipmi::Context::ptr ctx,
 
     try
     {
-        setDbusProperty(ctx, connection, path,
-                        "xyz.openbmc_project.Sensor.Value", "Value",
+        setDbusProperty(ctx, connection, path, sensorValueInterface, "Value",
                         ipmi::Value(value));
     }
     // setDbusProperty intended to resolve dbus exception/rc within the
@@ -340,15 +1096,176 @@ ipmi::RspType<> ipmiSetSensorReading(ipmi::Context::ptr ctx,
         log<level::ERR>(
             "Failed to set property", entry("PROPERTY=%s", "Value"),
             entry("PATH=%s", path.c_str()),
-            entry("INTERFACE=%s", "xyz.openbmc_project.Sensor.Value"),
+            entry("INTERFACE=%s", sensorValueInterface),
             entry("WHAT=%s", e.what()));
         return ipmi::responseResponseError();
     }
     return ipmi::responseSuccess();
 }
 
-ipmi::RspType<uint8_t, uint8_t, uint8_t, std::optional<uint8_t>>
-    ipmiSenGetSensorReading(ipmi::Context::ptr ctx, uint8_t sensnum)
+/** @brief encode the Get Sensor Reading bytes of a sensor
+ *  @param sensnum - sensor number, for the instrumentation
+ *  @param sensor - record of the sensor object
+ *  @param value - scaled reading byte
+ *  @param operation - reading/state byte
+ *  @param thresholds - threshold comparison status byte
+ *  @param reading - the unscaled reading, left alone when there is none
+ *
+ *  @returns IPMI completion code
+ */
+static ipmi::Cc getSensorReading(uint8_t sensnum, const SensorRecord& sensor,
+                                 uint8_t& value, uint8_t& operation,
+                                 uint8_t& thresholds, double& reading)
+{
+    if (!sensor.value)
+    {
+        return ipmi::ccResponseError;
+    }
+    reading = *sensor.value;
+
+    double max = 0;
+    double min = 0;
+    getSensorMaxMin(sensor, max, min);
+
+    auto attributes = getSensorAttributes(max, min);
+    if (!attributes)
+    {
+        return ipmi::ccResponseError;
+    }
+
+    value = scaleIPMIValueFromDouble(reading, *attributes);
+    operation =
+        static_cast<uint8_t>(IPMISensorReadingByte2::sensorScanningEnable);
+    operation |=
+        static_cast<uint8_t>(IPMISensorReadingByte2::eventMessagesEnable);
+    bool notReading = std::isnan(reading);
+
+    if (!notReading && sensor.available && !*sensor.available)
+    {
+        notReading = true;
+    }
+
+    if (notReading)
+    {
+        operation |= static_cast<uint8_t>(
+            IPMISensorReadingByte2::readingStateUnavailable);
+    }
+
+    if constexpr (details::enableInstrumentation)
+    {
+        int byteValue;
+        if (attributes->bSigned)
+        {
+            byteValue = static_cast<int>(static_cast<int8_t>(value));
+        }
+        else
+        {
+            byteValue = static_cast<int>(static_cast<uint8_t>(value));
+        }
+
+        // Keep stats on the reading just obtained, even if it is "NaN"
+        if (details::sdrStatsTable.updateReading(sensnum, reading, byteValue))
+        {
+            // This is the first reading, show the coefficients
+            double step = (max - min) / 255.0;
+            std::cerr << "IPMI sensor "
+                      << details::sdrStatsTable.getName(sensnum)
+                      << ": Range min=" << min << " max=" << max
+                      << ", step=" << step
+                      << ", Coefficients mValue="
+                      << static_cast<int>(attributes->mValue)
+                      << " rExp=" << static_cast<int>(attributes->rExp)
+                      << " bValue=" << static_cast<int>(attributes->bValue)
+                      << " bExp=" << static_cast<int>(attributes->bExp)
+                      << " bSigned=" << static_cast<int>(attributes->bSigned)
+                      << "\n";
+        }
+    }
+
+    thresholds = 0;
+
+    if (sensor.warningAlarmHigh)
+    {
+        thresholds |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::upperNonCritical);
+    }
+    if (sensor.warningAlarmLow)
+    {
+        thresholds |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::lowerNonCritical);
+    }
+    if (sensor.criticalAlarmHigh)
+    {
+        thresholds |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::upperCritical);
+    }
+    if (sensor.criticalAlarmLow)
+    {
+        thresholds |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::lowerCritical);
+    }
+
+    return ipmi::ccSuccess;
+}
+
+/** @brief record a sensor read in the read statistics of the sensor
+ *  @param ctx - context of the current request
+ *  @param sensnum - sensor number (the LUN is taken from ctx)
+ *  @param cc - completion code of the read
+ *  @param operation - reading/state byte
+ *  @param reading - the unscaled reading
+ *  @param start - when the read started
+ *  @param fetched - whether the read waited for the sensor map to be
+ *                   fetched from D-Bus
+ */
+static void recordSensorRead(ipmi::Context::ptr ctx, uint8_t sensnum,
+                             ipmi::Cc cc, uint8_t operation, double reading,
+                             std::chrono::steady_clock::time_point start,
+                             bool fetched)
+{
+    if (cc == ipmi::ccSuccess && !fetched &&
+        !sensorWarmUpStats.firstFastReadUs)
+    {
+        sensorWarmUpStats.firstFastReadUs =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - sensorWarmUpStats.loaded)
+                .count();
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            "First sensor reading served from a warm cache",
+            phosphor::logging::entry(
+                "AFTER_MS=%llu",
+                static_cast<unsigned long long>(
+                    *sensorWarmUpStats.firstFastReadUs / 1000)));
+    }
+
+    details::SensorReadStats* stats =
+        details::getSensorReadStats((ctx->lun << 8) | sensnum);
+    if (!stats)
+    {
+        return;
+    }
+    bool noReading =
+        cc == ipmi::ccSuccess &&
+        (operation & static_cast<uint8_t>(
+                         IPMISensorReadingByte2::readingStateUnavailable));
+    stats->record(cc != ipmi::ccSuccess, noReading, fetched, reading,
+                  std::chrono::steady_clock::now() - start);
+}
+
+/** @brief read one sensor and encode it as the Get Sensor Reading bytes
+ *  @param ctx - context of the current request
+ *  @param sensnum - sensor number (the LUN is taken from ctx)
+ *  @param value - scaled reading byte
+ *  @param operation - reading/state byte
+ *  @param thresholds - threshold comparison status byte
+ *  @param updatePeriod - age in seconds after which SensorCache is refreshed
+ *
+ *  @returns IPMI completion code
+ */
+static ipmi::Cc getSensorReading(ipmi::Context::ptr ctx, uint8_t sensnum,
+                                 uint8_t& value, uint8_t& operation,
+                                 uint8_t& thresholds,
+                                 int updatePeriod = sensorMapUpdatePeriod)
 {
     std::string connection;
     std::string path;
@@ -356,152 +1273,279 @@ ipmi::RspType<uint8_t, uint8_t, uint8_t, std::optional<uint8_t>>
     auto status = getSensorConnection(ctx, sensnum, connection, path);
     if (status)
     {
-        return ipmi::response(status);
+        return status;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t fetches = sensorMapFetches;
+    double reading = std::numeric_limits<double>::quiet_NaN();
+    ipmi::Cc cc = ipmi::ccResponseError;
+    SensorRecord sensor;
+    if (getSensorMap(ctx, connection, path, sensor, updatePeriod))
+    {
+        cc = getSensorReading(sensnum, sensor, value, operation, thresholds,
+                              reading);
+    }
+    recordSensorRead(ctx, sensnum, cc, operation, reading, start,
+                     fetches != sensorMapFetches);
+    return cc;
+}
+
+ipmi::RspType<uint8_t, uint8_t, uint8_t, std::optional<uint8_t>>
+    ipmiSenGetSensorReading(ipmi::Context::ptr ctx, uint8_t sensnum)
+{
+    uint8_t value = 0;
+    uint8_t operation = 0;
+    uint8_t thresholds = 0;
+
+    ipmi::Cc cc = getSensorReading(ctx, sensnum, value, operation, thresholds);
+    if (cc != ipmi::ccSuccess)
+    {
+        return ipmi::response(cc);
+    }
+
+    // no discrete as of today so optional byte is never returned
+    return ipmi::responseSuccess(value, operation, thresholds, std::nullopt);
+}
+
+/** @brief implements the OpenBMC OEM Get Multiple Sensor Readings command
+ *  @param ctx - context of the current request
+ *  @param selector - 00h: list of sensor numbers follows
+ *                    01h: first and last sensor number of a range follow
+ *  @param sensors - list of sensor numbers, or range bounds
+ *
+ *  @returns IPMI completion code plus response data
+ *   - count - number of sensor entries that follow
+ *   - readings - per sensor: number, completion code, reading, reading
+ *                state byte, threshold status byte
+ */
+ipmi::RspType<uint8_t,               // count
+              ipmi::message::Payload // readings
+              >
+    ipmiSenGetMultipleSensorReadings(ipmi::Context::ptr ctx, uint8_t selector,
+                                     std::vector<uint8_t> sensors)
+{
+    constexpr uint8_t selectorList = 0x00;
+    constexpr uint8_t selectorRange = 0x01;
+    // NetFn/LUN, Cmd, CC, IANA and count bytes ahead of the readings
+    constexpr size_t responseOverhead = 7;
+    constexpr size_t readingEntrySize = 5;
+
+    if (selector == selectorRange)
+    {
+        if (sensors.size() != 2 || sensors[0] > sensors[1])
+        {
+            return ipmi::responseReqDataLenInvalid();
+        }
+        std::vector<uint8_t> range;
+        for (unsigned int sensnum = sensors[0]; sensnum <= sensors[1];
+             sensnum++)
+        {
+            range.emplace_back(static_cast<uint8_t>(sensnum));
+        }
+        sensors = std::move(range);
+    }
+    else if (selector != selectorList)
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
+    if (sensors.empty())
+    {
+        return ipmi::responseReqDataLenInvalid();
+    }
+
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxEntries = 0;
+    if (maxTransfer > responseOverhead)
+    {
+        maxEntries = (maxTransfer - responseOverhead) / readingEntrySize;
+    }
+    if (maxEntries == 0)
+    {
+        return ipmi::responseResponseError();
+    }
+    if (sensors.size() > maxEntries)
+    {
+        sensors.resize(maxEntries);
     }
 
-    DbusInterfaceMap sensorMap;
-    if (!getSensorMap(ctx, connection, path, sensorMap))
+    // Refresh every stale connection once up front so all the readings in
+    // this response come from the same SensorCache snapshot
+    boost::container::flat_set<std::string> refreshed;
+    for (uint8_t sensnum : sensors)
     {
-        return ipmi::responseResponseError();
+        std::string connection;
+        std::string path;
+        if (getSensorConnection(ctx, sensnum, connection, path))
+        {
+            continue;
+        }
+        if (refreshed.insert(connection).second)
+        {
+            SensorRecord sensor;
+            getSensorMap(ctx, connection, path, sensor);
+        }
     }
-    auto sensorObject = sensorMap.find("xyz.openbmc_project.Sensor.Value");
 
-    if (sensorObject == sensorMap.end() ||
-        sensorObject->second.find("Value") == sensorObject->second.end())
+    ipmi::message::Payload readings;
+    for (uint8_t sensnum : sensors)
     {
-        return ipmi::responseResponseError();
+        uint8_t value = 0;
+        uint8_t operation = 0;
+        uint8_t thresholds = 0;
+        ipmi::Cc cc =
+            getSensorReading(ctx, sensnum, value, operation, thresholds,
+                             std::numeric_limits<int>::max());
+        if (cc != ipmi::ccSuccess)
+        {
+            value = 0;
+            operation = static_cast<uint8_t>(
+                IPMISensorReadingByte2::readingStateUnavailable);
+            thresholds = 0;
+        }
+        readings.pack(sensnum, cc, value, operation, thresholds);
     }
-    auto& valueVariant = sensorObject->second["Value"];
-    double reading = std::visit(VariantToDoubleVisitor(), valueVariant);
 
-    double max = 0;
-    double min = 0;
-    getSensorMaxMin(sensorMap, max, min);
+    return ipmi::responseSuccess(static_cast<uint8_t>(sensors.size()),
+                                 readings);
+}
 
-    int16_t mValue = 0;
-    int16_t bValue = 0;
-    int8_t rExp = 0;
-    int8_t bExp = 0;
-    bool bSigned = false;
+/** @brief implements the OpenBMC OEM Subscribe Sensor Changes command
+ *
+ *  Subscribes the host to the changes of sensors, each told to it by the
+ *  SMS attention flag and read back by Read Event Message Buffer as the
+ *  sensor number to read.
+ *
+ *  @param ctx - context of the current request
+ *  @param entries - 3 bytes per sensor: sensor number, change (00h remove
+ *                   the subscription, 01h change of at least value raw
+ *                   steps, 02h crossing of the raw reading value), value;
+ *                   sensor FFh with change 00h removes every subscription
+ *
+ *  @returns IPMI completion code plus response data
+ *   - count - sensors the host is subscribed to
+ */
+ipmi::RspType<uint8_t> // count
+    ipmiSenSubscribeSensorChanges(ipmi::Context::ptr ctx,
+                                  std::vector<uint8_t> entries)
+{
+    constexpr size_t entrySize = 3;
+    constexpr uint8_t allSensors = 0xFF;
 
-    if (!getSensorAttributes(max, min, mValue, rExp, bValue, bExp, bSigned))
+    // only a host can be told, through its system interface
+    ipmi::ChannelInfo chInfo;
+    if (ipmi::getChannelInfo(ctx->channel, chInfo) != ipmi::ccSuccess ||
+        static_cast<ipmi::EChannelMediumType>(chInfo.mediumType) !=
+            ipmi::EChannelMediumType::systemInterface)
     {
-        return ipmi::responseResponseError();
+        return ipmi::responseCommandNotAvailable();
+    }
+    if (entries.empty() || entries.size() % entrySize != 0)
+    {
+        return ipmi::responseReqDataLenInvalid();
     }
 
-    uint8_t value =
-        scaleIPMIValueFromDouble(reading, mValue, rExp, bValue, bExp, bSigned);
-    uint8_t operation =
-        static_cast<uint8_t>(IPMISensorReadingByte2::sensorScanningEnable);
-    operation |=
-        static_cast<uint8_t>(IPMISensorReadingByte2::eventMessagesEnable);
-    bool notReading = std::isnan(reading);
+    // the dispatcher gives a system interface request the host the channel
+    // serves, the one its SMS attention is raised for
+    auto hostId = static_cast<phosphor::host::command::HostId>(ctx->hostIdx);
 
-    if (!notReading)
+    // check every entry against the subscriptions they would leave before
+    // applying any
+    boost::container::flat_set<uint16_t> subscribed;
+    auto host = sensorSubscriptions.find(hostId);
+    if (host != sensorSubscriptions.end())
     {
-        auto availableObject =
-            sensorMap.find("xyz.openbmc_project.State.Decorator.Availability");
-        if (availableObject != sensorMap.end())
+        for (const auto& subscription : host->second)
         {
-            auto findAvailable = availableObject->second.find("Available");
-            if (findAvailable != availableObject->second.end())
-            {
-                bool* available = std::get_if<bool>(&(findAvailable->second));
-                if (available && !(*available))
-                {
-                    notReading = true;
-                }
-            }
+            subscribed.insert(subscribed.end(), subscription.first);
         }
     }
-
-    if (notReading)
-    {
-        operation |= static_cast<uint8_t>(
-            IPMISensorReadingByte2::readingStateUnavailable);
-    }
-
-    if constexpr (details::enableInstrumentation)
+    for (size_t i = 0; i < entries.size(); i += entrySize)
     {
-        int byteValue;
-        if (bSigned)
+        uint8_t sensnum = entries[i];
+        uint8_t kind = entries[i + 1];
+        if (kind > static_cast<uint8_t>(SensorChange::threshold))
         {
-            byteValue = static_cast<int>(static_cast<int8_t>(value));
+            return ipmi::responseInvalidFieldRequest();
         }
-        else
+        if (sensnum == allSensors && kind == 0)
         {
-            byteValue = static_cast<int>(static_cast<uint8_t>(value));
+            subscribed.clear();
+            continue;
         }
-
-        // Keep stats on the reading just obtained, even if it is "NaN"
-        if (details::sdrStatsTable.updateReading(sensnum, reading, byteValue))
+        std::string connection;
+        std::string path;
+        if (getSensorConnection(ctx, sensnum, connection, path))
         {
-            // This is the first reading, show the coefficients
-            double step = (max - min) / 255.0;
-            std::cerr << "IPMI sensor "
-                      << details::sdrStatsTable.getName(sensnum)
-                      << ": Range min=" << min << " max=" << max
-                      << ", step=" << step
-                      << ", Coefficients mValue=" << static_cast<int>(mValue)
-                      << " rExp=" << static_cast<int>(rExp)
-                      << " bValue=" << static_cast<int>(bValue)
-                      << " bExp=" << static_cast<int>(bExp)
-                      << " bSigned=" << static_cast<int>(bSigned) << "\n";
+            return ipmi::responseSensorInvalid();
+        }
+        uint16_t sensorKey = (ctx->lun << 8) | sensnum;
+        if (kind == 0)
+        {
+            subscribed.erase(sensorKey);
+        }
+        else if (subscribed.insert(sensorKey).second &&
+                 subscribed.size() > maxSensorSubscriptions)
+        {
+            return ipmi::responseOutOfSpace();
         }
     }
 
-    uint8_t thresholds = 0;
-
-    auto warningObject =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Warning");
-    if (warningObject != sensorMap.end())
+    std::vector<uint16_t> added;
+    auto& subscriptions = sensorSubscriptions[hostId];
+    for (size_t i = 0; i < entries.size(); i += entrySize)
     {
-        auto alarmHigh = warningObject->second.find("WarningAlarmHigh");
-        auto alarmLow = warningObject->second.find("WarningAlarmLow");
-        if (alarmHigh != warningObject->second.end())
+        uint8_t sensnum = entries[i];
+        auto kind = static_cast<SensorChange>(entries[i + 1]);
+        if (sensnum == allSensors && kind == SensorChange::remove)
         {
-            if (std::get<bool>(alarmHigh->second))
-            {
-                thresholds |= static_cast<uint8_t>(
-                    IPMISensorReadingByte3::upperNonCritical);
-            }
+            subscriptions.clear();
+            added.clear();
+            continue;
         }
-        if (alarmLow != warningObject->second.end())
+        uint16_t sensorKey = (ctx->lun << 8) | sensnum;
+        if (kind == SensorChange::remove)
         {
-            if (std::get<bool>(alarmLow->second))
-            {
-                thresholds |= static_cast<uint8_t>(
-                    IPMISensorReadingByte3::lowerNonCritical);
-            }
+            subscriptions.erase(sensorKey);
+            continue;
         }
+        subscriptions.insert_or_assign(
+            sensorKey, SensorSubscription{kind, entries[i + 2]});
+        added.push_back(sensorKey);
+    }
+    size_t count = subscriptions.size();
+    if (subscriptions.empty())
+    {
+        sensorSubscriptions.erase(hostId);
     }
 
-    auto criticalObject =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Critical");
-    if (criticalObject != sensorMap.end())
+    // take the readings the changes are told from, this also watches the
+    // connections of the sensors
+    for (uint16_t sensorKey : added)
     {
-        auto alarmHigh = criticalObject->second.find("CriticalAlarmHigh");
-        auto alarmLow = criticalObject->second.find("CriticalAlarmLow");
-        if (alarmHigh != criticalObject->second.end())
+        std::string connection;
+        std::string path;
+        SensorRecord sensor;
+        if (getSensorConnection(ctx, sensorKey & 0xFF, connection, path) ||
+            !getSensorMap(ctx, connection, path, sensor))
         {
-            if (std::get<bool>(alarmHigh->second))
-            {
-                thresholds |=
-                    static_cast<uint8_t>(IPMISensorReadingByte3::upperCritical);
-            }
+            continue;
         }
-        if (alarmLow != criticalObject->second.end())
+        // the subscriptions may have changed while the reading was fetched
+        host = sensorSubscriptions.find(hostId);
+        if (host == sensorSubscriptions.end())
         {
-            if (std::get<bool>(alarmLow->second))
-            {
-                thresholds |=
-                    static_cast<uint8_t>(IPMISensorReadingByte3::lowerCritical);
-            }
+            break;
+        }
+        auto subscription = host->second.find(sensorKey);
+        if (subscription != host->second.end() &&
+            !subscription->second.reported)
+        {
+            sensorSubscriptionTriggered(subscription->second, sensor);
         }
     }
 
-    // no discrete as of today so optional byte is never returned
-    return ipmi::responseSuccess(value, operation, thresholds, std::nullopt);
+    return ipmi::responseSuccess(static_cast<uint8_t>(count));
 }
 
 /** @brief implements the Set Sensor threshold command
@@ -558,23 +1602,18 @@ ipmi::RspType<> ipmiSenSetSensorThresholds(
     {
         return ipmi::response(status);
     }
-    DbusInterfaceMap sensorMap;
-    if (!getSensorMap(ctx, connection, path, sensorMap))
+    SensorRecord sensor;
+    if (!getSensorMap(ctx, connection, path, sensor))
     {
         return ipmi::responseResponseError();
     }
 
     double max = 0;
     double min = 0;
-    getSensorMaxMin(sensorMap, max, min);
-
-    int16_t mValue = 0;
-    int16_t bValue = 0;
-    int8_t rExp = 0;
-    int8_t bExp = 0;
-    bool bSigned = false;
+    getSensorMaxMin(sensor, max, min);
 
-    if (!getSensorAttributes(max, min, mValue, rExp, bValue, bExp, bSigned))
+    auto attributes = getSensorAttributes(max, min);
+    if (!attributes)
     {
         return ipmi::responseResponseError();
     }
@@ -589,89 +1628,75 @@ ipmi::RspType<> ipmiSenSetSensorThresholds(
     // verifiy all needed fields are present
     if (lowerCriticalThreshMask || upperCriticalThreshMask)
     {
-        auto findThreshold =
-            sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Critical");
-        if (findThreshold == sensorMap.end())
+        if (!sensor.hasCritical)
         {
             return ipmi::responseInvalidFieldRequest();
         }
         if (lowerCriticalThreshMask)
         {
-            auto findLower = findThreshold->second.find("CriticalLow");
-            if (findLower == findThreshold->second.end())
+            if (!sensor.criticalLow)
             {
                 return ipmi::responseInvalidFieldRequest();
             }
             thresholdsToSet.emplace_back("CriticalLow", lowerCritical,
-                                         findThreshold->first);
+                                         criticalInterface);
         }
         if (upperCriticalThreshMask)
         {
-            auto findUpper = findThreshold->second.find("CriticalHigh");
-            if (findUpper == findThreshold->second.end())
+            if (!sensor.criticalHigh)
             {
                 return ipmi::responseInvalidFieldRequest();
             }
             thresholdsToSet.emplace_back("CriticalHigh", upperCritical,
-                                         findThreshold->first);
+                                         criticalInterface);
         }
     }
     if (lowerNonCriticalThreshMask || upperNonCriticalThreshMask)
     {
-        auto findThreshold =
-            sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Warning");
-        if (findThreshold == sensorMap.end())
+        if (!sensor.hasWarning)
         {
             return ipmi::responseInvalidFieldRequest();
         }
         if (lowerNonCriticalThreshMask)
         {
-            auto findLower = findThreshold->second.find("WarningLow");
-            if (findLower == findThreshold->second.end())
+            if (!sensor.warningLow)
             {
                 return ipmi::responseInvalidFieldRequest();
             }
             thresholdsToSet.emplace_back("WarningLow", lowerNonCritical,
-                                         findThreshold->first);
+                                         warningInterface);
         }
         if (upperNonCriticalThreshMask)
         {
-            auto findUpper = findThreshold->second.find("WarningHigh");
-            if (findUpper == findThreshold->second.end())
+            if (!sensor.warningHigh)
             {
                 return ipmi::responseInvalidFieldRequest();
             }
             thresholdsToSet.emplace_back("WarningHigh", upperNonCritical,
-                                         findThreshold->first);
+                                         warningInterface);
         }
     }
     for (const auto& property : thresholdsToSet)
     {
         // from section 36.3 in the IPMI Spec, assume all linear
-        double valueToSet = ((mValue * std::get<thresholdValue>(property)) +
-                             (bValue * std::pow(10.0, bExp))) *
-                            std::pow(10.0, rExp);
+        double valueToSet =
+            ((attributes->mValue * std::get<thresholdValue>(property)) +
+             (attributes->bValue * std::pow(10.0, attributes->bExp))) *
+            std::pow(10.0, attributes->rExp);
         setDbusProperty(
             *getSdBus(), connection, path, std::get<interface>(property),
             std::get<propertyName>(property), ipmi::Value(valueToSet));
     }
+    sdrRepositoryDirty = true;
     return ipmi::responseSuccess();
 }
 
-IPMIThresholds getIPMIThresholds(const DbusInterfaceMap& sensorMap)
+IPMIThresholds getIPMIThresholds(const SensorRecord& sensor)
 {
     IPMIThresholds resp;
-    auto warningInterface =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Warning");
-    auto criticalInterface =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Critical");
-
-    if ((warningInterface != sensorMap.end()) ||
-        (criticalInterface != sensorMap.end()))
+    if (sensor.hasWarning || sensor.hasCritical)
     {
-        auto sensorPair = sensorMap.find("xyz.openbmc_project.Sensor.Value");
-
-        if (sensorPair == sensorMap.end())
+        if (!sensor.hasValue)
         {
             // should not have been able to find a sensor not implementing
             // the sensor object
@@ -680,67 +1705,89 @@ IPMIThresholds getIPMIThresholds(const DbusInterfaceMap& sensorMap)
 
         double max = 0;
         double min = 0;
-        getSensorMaxMin(sensorMap, max, min);
+        getSensorMaxMin(sensor, max, min);
 
-        int16_t mValue = 0;
-        int16_t bValue = 0;
-        int8_t rExp = 0;
-        int8_t bExp = 0;
-        bool bSigned = false;
-
-        if (!getSensorAttributes(max, min, mValue, rExp, bValue, bExp, bSigned))
+        auto attributes = getSensorAttributes(max, min);
+        if (!attributes)
         {
             throw std::runtime_error("Invalid sensor atrributes");
         }
-        if (warningInterface != sensorMap.end())
+        if (sensor.warningHigh)
         {
-            auto& warningMap = warningInterface->second;
-
-            auto warningHigh = warningMap.find("WarningHigh");
-            auto warningLow = warningMap.find("WarningLow");
-
-            if (warningHigh != warningMap.end())
-            {
-
-                double value =
-                    std::visit(VariantToDoubleVisitor(), warningHigh->second);
-                resp.warningHigh = scaleIPMIValueFromDouble(
-                    value, mValue, rExp, bValue, bExp, bSigned);
-            }
-            if (warningLow != warningMap.end())
-            {
-                double value =
-                    std::visit(VariantToDoubleVisitor(), warningLow->second);
-                resp.warningLow = scaleIPMIValueFromDouble(
-                    value, mValue, rExp, bValue, bExp, bSigned);
-            }
+            resp.warningHigh =
+                scaleIPMIValueFromDouble(*sensor.warningHigh, *attributes);
         }
-        if (criticalInterface != sensorMap.end())
+        if (sensor.warningLow)
         {
-            auto& criticalMap = criticalInterface->second;
-
-            auto criticalHigh = criticalMap.find("CriticalHigh");
-            auto criticalLow = criticalMap.find("CriticalLow");
-
-            if (criticalHigh != criticalMap.end())
-            {
-                double value =
-                    std::visit(VariantToDoubleVisitor(), criticalHigh->second);
-                resp.criticalHigh = scaleIPMIValueFromDouble(
-                    value, mValue, rExp, bValue, bExp, bSigned);
-            }
-            if (criticalLow != criticalMap.end())
-            {
-                double value =
-                    std::visit(VariantToDoubleVisitor(), criticalLow->second);
-                resp.criticalLow = scaleIPMIValueFromDouble(
-                    value, mValue, rExp, bValue, bExp, bSigned);
-            }
+            resp.warningLow =
+                scaleIPMIValueFromDouble(*sensor.warningLow, *attributes);
+        }
+        if (sensor.criticalHigh)
+        {
+            resp.criticalHigh =
+                scaleIPMIValueFromDouble(*sensor.criticalHigh, *attributes);
+        }
+        if (sensor.criticalLow)
+        {
+            resp.criticalLow =
+                scaleIPMIValueFromDouble(*sensor.criticalLow, *attributes);
         }
     }
     return resp;
 }
 
+/** @brief the Get Sensor Threshold response bytes of a sensor */
+struct SensorThresholdBytes
+{
+    uint8_t readable = 0;
+    uint8_t lowerNC = 0;
+    uint8_t lowerCritical = 0;
+    uint8_t lowerNonRecoverable = 0;
+    uint8_t upperNC = 0;
+    uint8_t upperCritical = 0;
+    uint8_t upperNonRecoverable = 0;
+};
+
+/** @brief encode the Get Sensor Threshold bytes of a sensor
+ *  @param sensor - record of the sensor object
+ *
+ *  @returns the readable mask and the scaled thresholds; throws if the
+ *           sensor can't be scaled
+ */
+static SensorThresholdBytes
+    getSensorThresholdBytes(const SensorRecord& sensor)
+{
+    IPMIThresholds thresholdData = getIPMIThresholds(sensor);
+    SensorThresholdBytes bytes;
+
+    if (thresholdData.warningHigh)
+    {
+        bytes.readable |=
+            1 << static_cast<uint8_t>(IPMIThresholdRespBits::upperNonCritical);
+        bytes.upperNC = *thresholdData.warningHigh;
+    }
+    if (thresholdData.warningLow)
+    {
+        bytes.readable |=
+            1 << static_cast<uint8_t>(IPMIThresholdRespBits::lowerNonCritical);
+        bytes.lowerNC = *thresholdData.warningLow;
+    }
+
+    if (thresholdData.criticalHigh)
+    {
+        bytes.readable |=
+            1 << static_cast<uint8_t>(IPMIThresholdRespBits::upperCritical);
+        bytes.upperCritical = *thresholdData.criticalHigh;
+    }
+    if (thresholdData.criticalLow)
+    {
+        bytes.readable |=
+            1 << static_cast<uint8_t>(IPMIThresholdRespBits::lowerCritical);
+        bytes.lowerCritical = *thresholdData.criticalLow;
+    }
+    return bytes;
+}
+
 ipmi::RspType<uint8_t, // readable
               uint8_t, // lowerNCrit
               uint8_t, // lowerCrit
@@ -759,59 +1806,26 @@ ipmi::RspType<uint8_t, // readable
         return ipmi::response(status);
     }
 
-    DbusInterfaceMap sensorMap;
-    if (!getSensorMap(ctx, connection, path, sensorMap))
+    SensorRecord sensor;
+    if (!getSensorMap(ctx, connection, path, sensor))
     {
         return ipmi::responseResponseError();
     }
 
-    IPMIThresholds thresholdData;
+    SensorThresholdBytes bytes;
     try
     {
-        thresholdData = getIPMIThresholds(sensorMap);
+        bytes = getSensorThresholdBytes(sensor);
     }
     catch (std::exception&)
     {
         return ipmi::responseResponseError();
     }
 
-    uint8_t readable = 0;
-    uint8_t lowerNC = 0;
-    uint8_t lowerCritical = 0;
-    uint8_t lowerNonRecoverable = 0;
-    uint8_t upperNC = 0;
-    uint8_t upperCritical = 0;
-    uint8_t upperNonRecoverable = 0;
-
-    if (thresholdData.warningHigh)
-    {
-        readable |=
-            1 << static_cast<uint8_t>(IPMIThresholdRespBits::upperNonCritical);
-        upperNC = *thresholdData.warningHigh;
-    }
-    if (thresholdData.warningLow)
-    {
-        readable |=
-            1 << static_cast<uint8_t>(IPMIThresholdRespBits::lowerNonCritical);
-        lowerNC = *thresholdData.warningLow;
-    }
-
-    if (thresholdData.criticalHigh)
-    {
-        readable |=
-            1 << static_cast<uint8_t>(IPMIThresholdRespBits::upperCritical);
-        upperCritical = *thresholdData.criticalHigh;
-    }
-    if (thresholdData.criticalLow)
-    {
-        readable |=
-            1 << static_cast<uint8_t>(IPMIThresholdRespBits::lowerCritical);
-        lowerCritical = *thresholdData.criticalLow;
-    }
-
-    return ipmi::responseSuccess(readable, lowerNC, lowerCritical,
-                                 lowerNonRecoverable, upperNC, upperCritical,
-                                 upperNonRecoverable);
+    return ipmi::responseSuccess(bytes.readable, bytes.lowerNC,
+                                 bytes.lowerCritical, bytes.lowerNonRecoverable,
+                                 bytes.upperNC, bytes.upperCritical,
+                                 bytes.upperNonRecoverable);
 }
 
 /** @brief implements the get Sensor event enable command
@@ -847,63 +1861,43 @@ ipmi::RspType<uint8_t, // enabled
         return ipmi::response(status);
     }
 
-    DbusInterfaceMap sensorMap;
-    if (!getSensorMap(ctx, connection, path, sensorMap))
+    SensorRecord sensor;
+    if (!getSensorMap(ctx, connection, path, sensor))
     {
         return ipmi::responseResponseError();
     }
 
-    auto warningInterface =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Warning");
-    auto criticalInterface =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Critical");
-    if ((warningInterface != sensorMap.end()) ||
-        (criticalInterface != sensorMap.end()))
+    if (sensor.hasWarning || sensor.hasCritical)
     {
         enabled = static_cast<uint8_t>(
             IPMISensorEventEnableByte2::sensorScanningEnable);
-        if (warningInterface != sensorMap.end())
+        if (sensor.warningHigh)
         {
-            auto& warningMap = warningInterface->second;
-
-            auto warningHigh = warningMap.find("WarningHigh");
-            auto warningLow = warningMap.find("WarningLow");
-            if (warningHigh != warningMap.end())
-            {
-                assertionEnabledLsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::upperNonCriticalGoingHigh);
-                deassertionEnabledLsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::upperNonCriticalGoingLow);
-            }
-            if (warningLow != warningMap.end())
-            {
-                assertionEnabledLsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::lowerNonCriticalGoingLow);
-                deassertionEnabledLsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::lowerNonCriticalGoingHigh);
-            }
+            assertionEnabledLsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::upperNonCriticalGoingHigh);
+            deassertionEnabledLsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::upperNonCriticalGoingLow);
         }
-        if (criticalInterface != sensorMap.end())
+        if (sensor.warningLow)
         {
-            auto& criticalMap = criticalInterface->second;
-
-            auto criticalHigh = criticalMap.find("CriticalHigh");
-            auto criticalLow = criticalMap.find("CriticalLow");
-
-            if (criticalHigh != criticalMap.end())
-            {
-                assertionEnabledMsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::upperCriticalGoingHigh);
-                deassertionEnabledMsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::upperCriticalGoingLow);
-            }
-            if (criticalLow != criticalMap.end())
-            {
-                assertionEnabledLsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::lowerCriticalGoingLow);
-                deassertionEnabledLsb |= static_cast<uint8_t>(
-                    IPMISensorEventEnableThresholds::lowerCriticalGoingHigh);
-            }
+            assertionEnabledLsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::lowerNonCriticalGoingLow);
+            deassertionEnabledLsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::lowerNonCriticalGoingHigh);
+        }
+        if (sensor.criticalHigh)
+        {
+            assertionEnabledMsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::upperCriticalGoingHigh);
+            deassertionEnabledMsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::upperCriticalGoingLow);
+        }
+        if (sensor.criticalLow)
+        {
+            assertionEnabledLsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::lowerCriticalGoingLow);
+            deassertionEnabledLsb |= static_cast<uint8_t>(
+                IPMISensorEventEnableThresholds::lowerCriticalGoingHigh);
         }
     }
 
@@ -912,6 +1906,85 @@ ipmi::RspType<uint8_t, // enabled
                                  deassertionEnabledMsb);
 }
 
+/** @brief the Get Sensor Event Status response bytes of a sensor */
+struct SensorEventStatus
+{
+    uint8_t sensorEventStatus = 0;
+    std::bitset<16> assertions = 0;
+    std::bitset<16> deassertions = 0;
+};
+
+/** @brief encode the Get Sensor Event Status bytes of a sensor
+ *  @param sensor - record of the sensor object
+ *  @param sensorNum - number of the sensor, for the deassertions seen
+ *
+ *  @returns the event messages state, assertions and deassertions
+ */
+static SensorEventStatus getSensorEventStatus(const SensorRecord& sensor,
+                                              uint16_t sensorNum)
+{
+    SensorEventStatus eventStatus;
+    eventStatus.sensorEventStatus =
+        static_cast<uint8_t>(IPMISensorEventEnableByte2::sensorScanningEnable);
+
+    ThresholdEvents events = sensorNum < thresholdEvents.size()
+                                 ? thresholdEvents[sensorNum]
+                                 : ThresholdEvents();
+    // seen asserted and no longer is
+    auto deasserted = [&events](ThresholdAlarm alarm) {
+        size_t seen = static_cast<size_t>(alarm);
+        return events.test(seen) && !events.test(thresholdAlarms + seen);
+    };
+
+    if (deasserted(ThresholdAlarm::criticalHigh))
+    {
+        eventStatus.deassertions.set(static_cast<size_t>(
+            IPMIGetSensorEventEnableThresholds::upperCriticalGoingHigh));
+    }
+    if (deasserted(ThresholdAlarm::criticalLow))
+    {
+        eventStatus.deassertions.set(static_cast<size_t>(
+            IPMIGetSensorEventEnableThresholds::upperCriticalGoingLow));
+    }
+    if (deasserted(ThresholdAlarm::warningHigh))
+    {
+        eventStatus.deassertions.set(static_cast<size_t>(
+            IPMIGetSensorEventEnableThresholds::upperNonCriticalGoingHigh));
+    }
+    if (deasserted(ThresholdAlarm::warningLow))
+    {
+        eventStatus.deassertions.set(static_cast<size_t>(
+            IPMIGetSensorEventEnableThresholds::lowerNonCriticalGoingHigh));
+    }
+    if (sensor.hasWarning || sensor.hasCritical)
+    {
+        eventStatus.sensorEventStatus = static_cast<size_t>(
+            IPMISensorEventEnableByte2::eventMessagesEnable);
+        if (sensor.warningAlarmHigh)
+        {
+            eventStatus.assertions.set(static_cast<size_t>(
+                IPMIGetSensorEventEnableThresholds::upperNonCriticalGoingHigh));
+        }
+        if (sensor.warningAlarmLow)
+        {
+            eventStatus.assertions.set(static_cast<size_t>(
+                IPMIGetSensorEventEnableThresholds::lowerNonCriticalGoingLow));
+        }
+        if (sensor.criticalAlarmHigh)
+        {
+            eventStatus.assertions.set(static_cast<size_t>(
+                IPMIGetSensorEventEnableThresholds::upperCriticalGoingHigh));
+        }
+        if (sensor.criticalAlarmLow)
+        {
+            eventStatus.assertions.set(static_cast<size_t>(
+                IPMIGetSensorEventEnableThresholds::lowerCriticalGoingLow));
+        }
+    }
+
+    return eventStatus;
+}
+
 /** @brief implements the get Sensor event status command
  *  @param sensorNumber - sensor number, FFh = reserved
  *
@@ -942,128 +2015,280 @@ ipmi::RspType<uint8_t,         // sensorEventStatus
         return ipmi::response(status);
     }
 
-    DbusInterfaceMap sensorMap;
-    if (!getSensorMap(ctx, connection, path, sensorMap))
+    SensorRecord sensor;
+    if (!getSensorMap(ctx, connection, path, sensor))
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "ipmiSenGetSensorEventStatus: Sensor Mapping Error",
             phosphor::logging::entry("SENSOR=%s", path.c_str()));
         return ipmi::responseResponseError();
     }
-    auto warningInterface =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Warning");
-    auto criticalInterface =
-        sensorMap.find("xyz.openbmc_project.Sensor.Threshold.Critical");
+    SensorEventStatus eventStatus =
+        getSensorEventStatus(sensor, (ctx->lun << 8) | sensorNum);
+    return ipmi::responseSuccess(eventStatus.sensorEventStatus,
+                                 eventStatus.assertions,
+                                 eventStatus.deassertions);
+}
 
-    uint8_t sensorEventStatus =
-        static_cast<uint8_t>(IPMISensorEventEnableByte2::sensorScanningEnable);
+/** @brief implements the OpenBMC OEM Get Sensor Snapshot command
+ *  @param ctx - context of the current request
+ *  @param first - first sensor number of the range
+ *  @param last - last sensor number of the range
+ *
+ *  @returns IPMI completion code plus response data
+ *   - count - number of sensor entries that follow, the range is cut short
+ *             to what fits in one response
+ *   - sensors - per sensor: number, completion code, the Get Sensor Reading
+ *               bytes, the Get Sensor Threshold bytes and the Get Sensor
+ *               Event Status bytes
+ */
+ipmi::RspType<uint8_t,               // count
+              ipmi::message::Payload // sensors
+              >
+    ipmiSenGetSensorSnapshot(ipmi::Context::ptr ctx, uint8_t first,
+                             uint8_t last)
+{
+    // NetFn/LUN, Cmd, CC, IANA and count bytes ahead of the entries
+    constexpr size_t responseOverhead = 7;
+    constexpr size_t snapshotEntrySize = 17;
 
-    std::optional<bool> criticalDeassertHigh =
-        thresholdDeassertMap[path]["CriticalAlarmHigh"];
-    std::optional<bool> criticalDeassertLow =
-        thresholdDeassertMap[path]["CriticalAlarmLow"];
-    std::optional<bool> warningDeassertHigh =
-        thresholdDeassertMap[path]["WarningAlarmHigh"];
-    std::optional<bool> warningDeassertLow =
-        thresholdDeassertMap[path]["WarningAlarmLow"];
+    if (first > last)
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
 
-    std::bitset<16> assertions = 0;
-    std::bitset<16> deassertions = 0;
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxEntries = 0;
+    if (maxTransfer > responseOverhead)
+    {
+        maxEntries = (maxTransfer - responseOverhead) / snapshotEntrySize;
+    }
+    if (maxEntries == 0)
+    {
+        return ipmi::responseResponseError();
+    }
+    size_t count = std::min<size_t>(last - first + 1, maxEntries);
 
-    if (criticalDeassertHigh && !*criticalDeassertHigh)
+    // Refresh every stale connection once up front, then take the reading,
+    // thresholds and event status of each sensor from the same sensor map
+    boost::container::flat_set<std::string> refreshed;
+    ipmi::message::Payload sensors;
+    for (size_t index = 0; index < count; index++)
     {
-        deassertions.set(static_cast<size_t>(
-            IPMIGetSensorEventEnableThresholds::upperCriticalGoingHigh));
+        uint8_t sensnum = static_cast<uint8_t>(first + index);
+        uint8_t value = 0;
+        uint8_t operation = static_cast<uint8_t>(
+            IPMISensorReadingByte2::readingStateUnavailable);
+        uint8_t thresholds = 0;
+        SensorThresholdBytes limits;
+        SensorEventStatus eventStatus;
+
+        std::string connection;
+        std::string path;
+        ipmi::Cc cc = getSensorConnection(ctx, sensnum, connection, path);
+        if (cc == ipmi::ccSuccess)
+        {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t fetches = sensorMapFetches;
+            double reading = std::numeric_limits<double>::quiet_NaN();
+            int updatePeriod = refreshed.insert(connection).second
+                                   ? sensorMapUpdatePeriod
+                                   : std::numeric_limits<int>::max();
+            SensorRecord sensor;
+            if (!getSensorMap(ctx, connection, path, sensor, updatePeriod))
+            {
+                cc = ipmi::ccResponseError;
+            }
+            else
+            {
+                try
+                {
+                    cc = getSensorReading(sensnum, sensor, value, operation,
+                                          thresholds, reading);
+                    limits = getSensorThresholdBytes(sensor);
+                    eventStatus = getSensorEventStatus(
+                        sensor, (ctx->lun << 8) | sensnum);
+                }
+                catch (const std::exception&)
+                {
+                    cc = ipmi::ccResponseError;
+                }
+            }
+            recordSensorRead(ctx, sensnum, cc, operation, reading, start,
+                             fetches != sensorMapFetches);
+        }
+        if (cc != ipmi::ccSuccess)
+        {
+            value = 0;
+            operation = static_cast<uint8_t>(
+                IPMISensorReadingByte2::readingStateUnavailable);
+            thresholds = 0;
+            limits = SensorThresholdBytes();
+            eventStatus = SensorEventStatus();
+        }
+        sensors.pack(sensnum, cc, value, operation, thresholds,
+                     limits.readable, limits.lowerNC, limits.lowerCritical,
+                     limits.lowerNonRecoverable, limits.upperNC,
+                     limits.upperCritical, limits.upperNonRecoverable,
+                     eventStatus.sensorEventStatus, eventStatus.assertions,
+                     eventStatus.deassertions);
+    }
+
+    return ipmi::responseSuccess(static_cast<uint8_t>(count), sensors);
+}
+
+static uint32_t saturate32(uint64_t value)
+{
+    return static_cast<uint32_t>(
+        std::min<uint64_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+/** @brief a reading in thousandths of its unit, INT32_MIN for none */
+static int32_t milliReading(double reading)
+{
+    constexpr double limit = std::numeric_limits<int32_t>::max();
+    if (std::isnan(reading))
+    {
+        return std::numeric_limits<int32_t>::min();
     }
-    if (criticalDeassertLow && !*criticalDeassertLow)
+    return static_cast<int32_t>(
+        std::round(std::clamp(reading * 1000.0, -limit, limit)));
+}
+
+/** @brief implements the OpenBMC OEM Get Sensor Read Statistics command
+ *  @param ctx - context of the current request
+ *  @param sensnum - sensor number (the LUN is taken from ctx)
+ *
+ *  @returns IPMI completion code plus response data
+ *   - reads - number of reads of the sensor
+ *   - failures - reads that returned an error completion code
+ *   - unavailable - reads that found no valid reading
+ *   - dbusFetches - reads that waited for the sensor to be fetched from
+ *                   D-Bus
+ *   - totalLatencyUs - total time the reads took
+ *   - maxLatencyUs - longest read
+ *   - minReading, maxReading - lowest and highest reading, in thousandths
+ *                              of the sensor unit
+ */
+ipmi::RspType<uint32_t, // reads
+              uint32_t, // failures
+              uint32_t, // unavailable
+              uint32_t, // dbusFetches
+              uint64_t, // totalLatencyUs
+              uint32_t, // maxLatencyUs
+              int32_t,  // minReading
+              int32_t   // maxReading
+              >
+    ipmiSenGetSensorReadStats(ipmi::Context::ptr ctx, uint8_t sensnum)
+{
+    std::string connection;
+    std::string path;
+    ipmi::Cc cc = getSensorConnection(ctx, sensnum, connection, path);
+    if (cc != ipmi::ccSuccess)
     {
-        deassertions.set(static_cast<size_t>(
-            IPMIGetSensorEventEnableThresholds::upperCriticalGoingLow));
+        return ipmi::response(cc);
     }
-    if (warningDeassertHigh && !*warningDeassertHigh)
+    const details::SensorReadStats* stats =
+        details::getSensorReadStats((ctx->lun << 8) | sensnum);
+    if (!stats)
     {
-        deassertions.set(static_cast<size_t>(
-            IPMIGetSensorEventEnableThresholds::upperNonCriticalGoingHigh));
+        return ipmi::responseInvalidFieldRequest();
     }
-    if (warningDeassertLow && !*warningDeassertLow)
+
+    constexpr auto relaxed = std::memory_order_relaxed;
+    return ipmi::responseSuccess(
+        saturate32(stats->reads.load(relaxed)),
+        saturate32(stats->failures.load(relaxed)),
+        saturate32(stats->unavailable.load(relaxed)),
+        saturate32(stats->dbusFetches.load(relaxed)),
+        stats->totalLatencyUs.load(relaxed),
+        saturate32(stats->maxLatencyUs.load(relaxed)),
+        milliReading(stats->minReading.load(relaxed)),
+        milliReading(stats->maxReading.load(relaxed)));
+}
+
+using SensorReadStatsEntry =
+    std::tuple<uint16_t, std::string, uint64_t, uint64_t, uint64_t, uint64_t,
+               uint64_t, uint64_t, double, double>;
+
+/** @brief D-Bus method returning the read statistics of every sensor
+ *
+ *  @return one (LUN and sensor number, path, reads, failures, unavailable,
+ *          dbusFetches, totalLatencyUs, maxLatencyUs, minReading,
+ *          maxReading) entry per sensor
+ */
+static std::vector<SensorReadStatsEntry> getSensorReadStatistics()
+{
+    std::vector<SensorReadStatsEntry> entries;
+    std::shared_ptr<SensorNumMap> sensorNumMap;
+    details::getSensorNumMap(sensorNumMap);
+    if (!sensorNumMap)
     {
-        deassertions.set(static_cast<size_t>(
-            IPMIGetSensorEventEnableThresholds::lowerNonCriticalGoingHigh));
+        return entries;
     }
-    if ((warningInterface != sensorMap.end()) ||
-        (criticalInterface != sensorMap.end()))
+
+    constexpr auto relaxed = std::memory_order_relaxed;
+    entries.reserve(sensorNumMap->size());
+    for (const auto& [number, path] : sensorNumMap->left)
     {
-        sensorEventStatus = static_cast<size_t>(
-            IPMISensorEventEnableByte2::eventMessagesEnable);
-        if (warningInterface != sensorMap.end())
+        const details::SensorReadStats* stats =
+            details::getSensorReadStats(static_cast<uint16_t>(number));
+        if (!stats)
         {
-            auto& warningMap = warningInterface->second;
-
-            auto warningHigh = warningMap.find("WarningAlarmHigh");
-            auto warningLow = warningMap.find("WarningAlarmLow");
-            auto warningHighAlarm = false;
-            auto warningLowAlarm = false;
-
-            if (warningHigh != warningMap.end())
-            {
-                warningHighAlarm = std::get<bool>(warningHigh->second);
-            }
-            if (warningLow != warningMap.end())
-            {
-                warningLowAlarm = std::get<bool>(warningLow->second);
-            }
-            if (warningHighAlarm)
-            {
-                assertions.set(
-                    static_cast<size_t>(IPMIGetSensorEventEnableThresholds::
-                                            upperNonCriticalGoingHigh));
-            }
-            if (warningLowAlarm)
-            {
-                assertions.set(
-                    static_cast<size_t>(IPMIGetSensorEventEnableThresholds::
-                                            lowerNonCriticalGoingLow));
-            }
+            continue;
         }
-        if (criticalInterface != sensorMap.end())
-        {
-            auto& criticalMap = criticalInterface->second;
-
-            auto criticalHigh = criticalMap.find("CriticalAlarmHigh");
-            auto criticalLow = criticalMap.find("CriticalAlarmLow");
-            auto criticalHighAlarm = false;
-            auto criticalLowAlarm = false;
+        entries.emplace_back(
+            static_cast<uint16_t>(number), path, stats->reads.load(relaxed),
+            stats->failures.load(relaxed), stats->unavailable.load(relaxed),
+            stats->dbusFetches.load(relaxed),
+            stats->totalLatencyUs.load(relaxed),
+            stats->maxLatencyUs.load(relaxed),
+            stats->minReading.load(relaxed), stats->maxReading.load(relaxed));
+    }
+    return entries;
+}
 
-            if (criticalHigh != criticalMap.end())
-            {
-                criticalHighAlarm = std::get<bool>(criticalHigh->second);
-            }
-            if (criticalLow != criticalMap.end())
-            {
-                criticalLowAlarm = std::get<bool>(criticalLow->second);
-            }
-            if (criticalHighAlarm)
-            {
-                assertions.set(
-                    static_cast<size_t>(IPMIGetSensorEventEnableThresholds::
-                                            upperCriticalGoingHigh));
-            }
-            if (criticalLowAlarm)
+/** @brief publish the sensor read statistics on D-Bus
+ *
+ *  @return the statistics interface, published for as long as it is held
+ */
+static std::shared_ptr<sdbusplus::asio::dbus_interface>
+    registerSensorReadStatistics()
+{
+    constexpr auto statsPath = "/xyz/openbmc_project/Ipmi/SensorStatistics";
+    constexpr auto statsIntf = "xyz.openbmc_project.Ipmi.SensorStatistics";
+
+    std::shared_ptr<sdbusplus::asio::connection> bus = getSdBus();
+    // ipmid already serves the object manager
+    sdbusplus::asio::object_server server(bus, true);
+    auto statsIface = server.add_interface(statsPath, statsIntf);
+    statsIface->register_method("GetSensorStatistics",
+                                getSensorReadStatistics);
+    // (connections, duration in us) of the last warm-up of the sensor
+    // cache, and the time in us to the first reading it served, 0 if none
+    statsIface->register_method("GetWarmUpStatistics", []() {
+        return std::make_tuple(sensorWarmUpStats.connections,
+                               sensorWarmUpStats.durationUs,
+                               sensorWarmUpStats.firstFastReadUs.value_or(0));
+    });
+    statsIface->register_method("Reset", []() {
+        for (uint16_t lunBase : {uint16_t(0), lun1Sensor0, lun3Sensor0})
+        {
+            for (uint16_t number = 0; number < details::sensorsPerIndexLUN;
+                 number++)
             {
-                assertions.set(static_cast<size_t>(
-                    IPMIGetSensorEventEnableThresholds::lowerCriticalGoingLow));
+                details::getSensorReadStats(lunBase | number)->reset();
             }
         }
-    }
-
-    return ipmi::responseSuccess(sensorEventStatus, assertions, deassertions);
+    });
+    statsIface->initialize();
+    return statsIface;
 }
 
 static int getSensorDataRecord(ipmi::Context::ptr ctx,
                                std::vector<uint8_t>& recordData,
                                uint16_t recordID)
 {
-    auto& sensorTree = getSensorTree();
     size_t fruCount = 0;
     ipmi::Cc ret = ipmi::storage::getFruSdrCount(ctx, fruCount);
     if (ret != ipmi::ccSuccess)
@@ -1074,11 +2299,7 @@ static int getSensorDataRecord(ipmi::Context::ptr ctx,
     }
 
     size_t lastRecord =
-        sensorTree.size() + fruCount + ipmi::storage::type12Count - 1;
-    if (recordID == lastRecordIndex)
-    {
-        recordID = lastRecord;
-    }
+        maxIPMISensors + fruCount + ipmi::storage::type12Count - 1;
     if (recordID > lastRecord)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
@@ -1086,9 +2307,9 @@ static int getSensorDataRecord(ipmi::Context::ptr ctx,
         return GENERAL_ERROR;
     }
 
-    if (recordID >= sensorTree.size())
+    if (recordID >= maxIPMISensors)
     {
-        size_t fruIndex = recordID - sensorTree.size();
+        size_t fruIndex = recordID - maxIPMISensors;
         if (fruIndex >= fruCount)
         {
             // handle type 12 hardcoded records
@@ -1099,7 +2320,9 @@ static int getSensorDataRecord(ipmi::Context::ptr ctx,
                     "getSensorDataRecord: type12Index error");
                 return GENERAL_ERROR;
             }
-            recordData = ipmi::storage::getType12SDRs(type12Index, recordID);
+            std::vector<uint8_t> type12 =
+                ipmi::storage::getType12SDRs(type12Index, recordID);
+            recordData.insert(recordData.end(), type12.begin(), type12.end());
         }
         else
         {
@@ -1120,27 +2343,28 @@ static int getSensorDataRecord(ipmi::Context::ptr ctx,
         return 0;
     }
 
-    std::string connection;
-    std::string path;
-    auto status = getSensorConnection(ctx, recordID, connection, path);
-    if (status)
+    // the sensor record ID is the slot of the sensor number, a free slot
+    // has no record
+    uint16_t sensorNum = details::slotSensorNumber(recordID);
+    const details::SensorIndexEntry& indexed =
+        details::getSensorIndexEntry(sensorNum);
+    if (!indexed.path)
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "getSensorDataRecord: getSensorConnection error");
-        return GENERAL_ERROR;
+        return 0;
     }
-    DbusInterfaceMap sensorMap;
-    if (!getSensorMap(ctx, connection, path, sensorMap, sensorMapUpdatePeriod))
+    if (!indexed.connection)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "getSensorDataRecord: getSensorMap error");
+            "getSensorDataRecord: getSensorConnection error");
         return GENERAL_ERROR;
     }
-    uint16_t sensorNum = getSensorNumberFromPath(path);
-    if (sensorNum == invalidSensorNumber)
+    std::string path = *indexed.path;
+    std::string connection = *indexed.connection;
+    SensorRecord sensor;
+    if (!getSensorMap(ctx, connection, path, sensor, sensorMapUpdatePeriod))
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "getSensorDataRecord: invalidSensorNumber");
+            "getSensorDataRecord: getSensorMap error");
         return GENERAL_ERROR;
     }
     uint8_t sensornumber = static_cast<uint8_t>(sensorNum);
@@ -1160,20 +2384,11 @@ static int getSensorDataRecord(ipmi::Context::ptr ctx,
     record.key.sensor_number = sensornumber;
 
     record.body.sensor_capabilities = 0x68; // auto rearm - todo hysteresis
-    record.body.sensor_type = getSensorTypeFromPath(path);
-    std::string type = getSensorTypeStringFromPath(path);
-    auto typeCstr = type.c_str();
-    auto findUnits = sensorUnits.find(typeCstr);
-    if (findUnits != sensorUnits.end())
-    {
-        record.body.sensor_units_2_base =
-            static_cast<uint8_t>(findUnits->second);
-    } // else default 0x0 unspecified
-
-    record.body.event_reading_type = getSensorEventTypeFromPath(path);
+    record.body.sensor_type = indexed.codes.sensorType;
+    record.body.sensor_units_2_base = indexed.codes.unitsBase;
+    record.body.event_reading_type = indexed.codes.eventReadingType;
 
-    auto sensorObject = sensorMap.find("xyz.openbmc_project.Sensor.Value");
-    if (sensorObject == sensorMap.end())
+    if (!sensor.hasValue)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "getSensorDataRecord: sensorObject error");
@@ -1185,40 +2400,30 @@ static int getSensorDataRecord(ipmi::Context::ptr ctx,
 
     // follow the association chain to get the parent board's entityid and
     // entityInstance
-    updateIpmiFromAssociation(path, sensorMap, entityId, entityInstance);
+    updateIpmiFromAssociation(path, sensor.associations, entityId,
+                              entityInstance);
 
     record.body.entity_id = entityId;
     record.body.entity_instance = entityInstance;
 
-    auto maxObject = sensorObject->second.find("MaxValue");
-    auto minObject = sensorObject->second.find("MinValue");
-
     // If min and/or max are left unpopulated,
     // then default to what a signed byte would be, namely (-128,127) range.
-    auto max = static_cast<double>(std::numeric_limits<int8_t>::max());
-    auto min = static_cast<double>(std::numeric_limits<int8_t>::lowest());
-    if (maxObject != sensorObject->second.end())
-    {
-        max = std::visit(VariantToDoubleVisitor(), maxObject->second);
-    }
-
-    if (minObject != sensorObject->second.end())
-    {
-        min = std::visit(VariantToDoubleVisitor(), minObject->second);
-    }
+    double max = sensor.maxValue.value_or(std::numeric_limits<int8_t>::max());
+    double min =
+        sensor.minValue.value_or(std::numeric_limits<int8_t>::lowest());
 
-    int16_t mValue = 0;
-    int8_t rExp = 0;
-    int16_t bValue = 0;
-    int8_t bExp = 0;
-    bool bSigned = false;
-
-    if (!getSensorAttributes(max, min, mValue, rExp, bValue, bExp, bSigned))
+    auto attributes = getSensorAttributes(max, min);
+    if (!attributes)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "getSensorDataRecord: getSensorAttributes error");
         return GENERAL_ERROR;
     }
+    int16_t mValue = attributes->mValue;
+    int8_t rExp = attributes->rExp;
+    int16_t bValue = attributes->bValue;
+    int8_t bExp = attributes->bExp;
+    bool bSigned = attributes->bSigned;
 
     // The record.body is a struct SensorDataFullRecordBody
     // from sensorhandler.hpp in phosphor-ipmi-host.
@@ -1266,106 +2471,574 @@ static int getSensorDataRecord(ipmi::Context::ptr ctx,
     // Set the analog reading byte interpretation accordingly
     record.body.sensor_units_1 = (bSigned ? 1 : 0) << 7;
 
-    // TODO(): Perhaps care about Tolerance, Accuracy, and so on
-    // These seem redundant, but derivable from the above 5 attributes
-    // Original comment said "todo fill out rest of units"
+    // TODO(): Perhaps care about Tolerance, Accuracy, and so on
+    // These seem redundant, but derivable from the above 5 attributes
+    // Original comment said "todo fill out rest of units"
+
+    // populate sensor name from path
+    std::string name;
+    size_t nameStart = path.rfind("/");
+    if (nameStart != std::string::npos)
+    {
+        name = path.substr(nameStart + 1, std::string::npos - nameStart);
+    }
+
+    std::replace(name.begin(), name.end(), '_', ' ');
+    if (name.size() > FULL_RECORD_ID_STR_MAX_LENGTH)
+    {
+        // try to not truncate by replacing common words
+        constexpr std::array<std::pair<const char*, const char*>, 2>
+            replaceWords = {std::make_pair("Output", "Out"),
+                            std::make_pair("Input", "In")};
+        for (const auto& [find, replace] : replaceWords)
+        {
+            boost::replace_all(name, find, replace);
+        }
+
+        name.resize(FULL_RECORD_ID_STR_MAX_LENGTH);
+    }
+    record.body.id_string_info = name.size();
+    std::strncpy(record.body.id_string, name.c_str(),
+                 sizeof(record.body.id_string));
+
+    // Remember the sensor name, as determined for this sensor number
+    details::sdrStatsTable.updateName(sensornumber, name);
+
+    IPMIThresholds thresholdData;
+    try
+    {
+        thresholdData = getIPMIThresholds(sensor);
+    }
+    catch (std::exception&)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "getSensorDataRecord: getIPMIThresholds error");
+        return GENERAL_ERROR;
+    }
+
+    if (thresholdData.criticalHigh)
+    {
+        record.body.upper_critical_threshold = *thresholdData.criticalHigh;
+        record.body.supported_deassertions[1] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::criticalThreshold);
+        record.body.supported_deassertions[1] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::upperCriticalGoingHigh);
+        record.body.supported_assertions[1] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::upperCriticalGoingHigh);
+        record.body.discrete_reading_setting_mask[0] |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::upperCritical);
+    }
+    if (thresholdData.warningHigh)
+    {
+        record.body.upper_noncritical_threshold = *thresholdData.warningHigh;
+        record.body.supported_deassertions[1] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::nonCriticalThreshold);
+        record.body.supported_deassertions[0] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::upperNonCriticalGoingHigh);
+        record.body.supported_assertions[0] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::upperNonCriticalGoingHigh);
+        record.body.discrete_reading_setting_mask[0] |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::upperNonCritical);
+    }
+    if (thresholdData.criticalLow)
+    {
+        record.body.lower_critical_threshold = *thresholdData.criticalLow;
+        record.body.supported_assertions[1] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::criticalThreshold);
+        record.body.supported_deassertions[0] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::lowerCriticalGoingLow);
+        record.body.supported_assertions[0] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::lowerCriticalGoingLow);
+        record.body.discrete_reading_setting_mask[0] |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::lowerCritical);
+    }
+    if (thresholdData.warningLow)
+    {
+        record.body.lower_noncritical_threshold = *thresholdData.warningLow;
+        record.body.supported_assertions[1] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::nonCriticalThreshold);
+        record.body.supported_deassertions[0] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::lowerNonCriticalGoingLow);
+        record.body.supported_assertions[0] |= static_cast<uint8_t>(
+            IPMISensorEventEnableThresholds::lowerNonCriticalGoingLow);
+        record.body.discrete_reading_setting_mask[0] |=
+            static_cast<uint8_t>(IPMISensorReadingByte3::lowerNonCritical);
+    }
+
+    // everything that is readable is setable
+    record.body.discrete_reading_setting_mask[1] =
+        record.body.discrete_reading_setting_mask[0];
+    recordData.insert(recordData.end(), reinterpret_cast<uint8_t*>(&record),
+                      reinterpret_cast<uint8_t*>(&record) + sizeof(record));
+    return 0;
+}
+
+/** @brief build every record of the SDR repository into a new image
+ *  @param ctx - context of the current request
+ *  @param recordCount - number of records in the repository
+ *  @param fruCount - number of FRU records in the repository
+ *
+ *  @returns the new repository
+ */
+static SdrRepository buildSdrRepository(ipmi::Context::ptr ctx,
+                                        size_t recordCount, size_t fruCount)
+{
+    size_t recordIDs = maxIPMISensors + fruCount + ipmi::storage::type12Count;
+    SdrRepository repo;
+    repo.lastAdd = sdrLastAdd;
+    repo.lastRemove = sdrLastRemove;
+    repo.recordCount = recordCount;
+    repo.offsets.reserve(recordIDs + 1);
+    repo.image.reserve(recordCount * maxSDRTotalSize);
+    for (size_t recordID = 0; recordID < recordIDs; recordID++)
+    {
+        repo.offsets.emplace_back(repo.image.size());
+        if (getSensorDataRecord(ctx, repo.image, recordID))
+        {
+            // leave an empty slot for this record ID
+            repo.image.resize(repo.offsets.back());
+            repo.incomplete = true;
+        }
+    }
+    repo.offsets.emplace_back(repo.image.size());
+    repo.built = std::chrono::steady_clock::now();
+    return repo;
+}
+
+/** @brief the number of record IDs of the SDR repository, the free sensor
+ *  slots included
+ */
+static size_t sdrRecordIDs(const SdrRepository& repo)
+{
+    return repo.offsets.empty() ? 0 : repo.offsets.size() - 1;
+}
+
+/** @brief update the change generations of the records with a new image
+ *  @param repo - the SDR repository about to be served
+ *
+ *  @returns true if a record changed, and the generation with it
+ */
+static bool trackSdrChanges(const SdrRepository& repo)
+{
+    if (sdrFirstGeneration == 0)
+    {
+        sdrFirstGeneration =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        sdrGeneration = sdrFirstGeneration - 1;
+    }
+
+    uint64_t next = sdrGeneration + 1;
+    bool changed = false;
+    size_t recordIDs = sdrRecordIDs(repo);
+    sdrRecordChanges.resize(std::max(sdrRecordChanges.size(), recordIDs));
+    for (size_t recordID = 0; recordID < sdrRecordChanges.size(); recordID++)
+    {
+        SdrRecordChange& change = sdrRecordChanges[recordID];
+        if (recordID >= recordIDs ||
+            repo.offsets[recordID + 1] == repo.offsets[recordID])
+        {
+            if (change.present)
+            {
+                change.present = false;
+                change.changed = next;
+                changed = true;
+            }
+            continue;
+        }
+        size_t begin = repo.offsets[recordID];
+        size_t hash = std::hash<std::string_view>{}(std::string_view(
+            reinterpret_cast<const char*>(repo.imageData()) + begin,
+            repo.offsets[recordID + 1] - begin));
+        if (!change.present)
+        {
+            change.present = true;
+            change.added = next;
+        }
+        else if (change.hash == hash)
+        {
+            continue;
+        }
+        change.hash = hash;
+        change.changed = next;
+        changed = true;
+    }
+    if (changed)
+    {
+        sdrGeneration = next;
+    }
+    return changed;
+}
+
+/** @brief write a complete SDR repository and the current sensor numbering
+ *  to sdrCacheFile
+ *  @param repo - the SDR repository to save
+ */
+static void saveSdrRepository(const SdrRepository& repo)
+{
+    namespace fs = std::filesystem;
+
+    std::shared_ptr<SensorNumMap> sensorNumMap;
+    details::getSensorNumMap(sensorNumMap);
+    if (repo.incomplete || !sensorNumMap ||
+        sdrRecordIDs(repo) > std::numeric_limits<uint32_t>::max())
+    {
+        return;
+    }
+
+    SdrCacheHeader header{};
+    header.magic = sdrCacheMagic;
+    header.version = sdrCacheVersion;
+    header.sensorCount = static_cast<uint16_t>(sensorNumMap->size());
+    header.recordCount = static_cast<uint32_t>(repo.recordCount);
+    header.recordIDs = static_cast<uint32_t>(sdrRecordIDs(repo));
+    header.imageSize = static_cast<uint32_t>(repo.imageSize());
+
+    std::error_code ec;
+    fs::path cachePath(sdrCacheFile);
+    fs::create_directories(cachePath.parent_path(), ec);
+    fs::path tmpPath = cachePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& [number, path] : sensorNumMap->left)
+        {
+            uint16_t sensorNum = static_cast<uint16_t>(number);
+            uint16_t pathLength = static_cast<uint16_t>(path.size());
+            out.write(reinterpret_cast<const char*>(&sensorNum),
+                      sizeof(sensorNum));
+            out.write(reinterpret_cast<const char*>(&pathLength),
+                      sizeof(pathLength));
+            out.write(path.data(), pathLength);
+        }
+        for (size_t offset : repo.offsets)
+        {
+            uint32_t offset32 = static_cast<uint32_t>(offset);
+            out.write(reinterpret_cast<const char*>(&offset32),
+                      sizeof(offset32));
+        }
+        out.write(reinterpret_cast<const char*>(repo.imageData()),
+                  repo.imageSize());
+        out.close();
+        if (!out.good())
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                "saveSdrRepository: failed to write SDR cache");
+            fs::remove(tmpPath, ec);
+            return;
+        }
+    }
+    // on flash before the rename, so that a power cut leaves the old cache
+    // or the new one and not an empty or truncated file
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0 || fsync(fd) < 0)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "saveSdrRepository: failed to sync SDR cache",
+            phosphor::logging::entry("ERRNO=%d", errno));
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        fs::remove(tmpPath, ec);
+        return;
+    }
+    close(fd);
+    fs::rename(tmpPath, cachePath, ec);
+    if (ec)
+    {
+        fs::remove(tmpPath, ec);
+    }
+}
+
+/** @brief map sdrCacheFile and load it as the current SDR repository
+ *
+ *  The loaded image is served from the mapping, without a copy, and marked
+ *  persisted; it is served as is until the first access checks it against
+ *  D-Bus in the background.
+ */
+static void loadSdrRepository()
+{
+    int fd = open(sdrCacheFile, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(SdrCacheHeader))
+    {
+        close(fd);
+        return;
+    }
+    size_t fileSize = st.st_size;
+    void* map = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return;
+    }
+    // unmapped once no repository serves the image any more
+    std::shared_ptr<const void> mapping(map, [fileSize](const void* addr) {
+        munmap(const_cast<void*>(addr), fileSize);
+    });
+
+    const uint8_t* data = static_cast<const uint8_t*>(map);
+    const uint8_t* const dataEnd = data + fileSize;
+    auto readBytes = [&data, dataEnd](void* out, size_t size) {
+        if (static_cast<size_t>(dataEnd - data) < size)
+        {
+            return false;
+        }
+        std::memcpy(out, data, size);
+        data += size;
+        return true;
+    };
+
+    SdrCacheHeader header;
+    SdrRepository repo;
+    std::vector<std::pair<uint16_t, std::string>> sensorNumbers;
+    bool valid = readBytes(&header, sizeof(header)) &&
+                 header.magic == sdrCacheMagic &&
+                 header.version == sdrCacheVersion;
+    for (uint16_t i = 0; valid && i < header.sensorCount; i++)
+    {
+        uint16_t sensorNum = 0;
+        uint16_t pathLength = 0;
+        valid = readBytes(&sensorNum, sizeof(sensorNum)) &&
+                readBytes(&pathLength, sizeof(pathLength)) &&
+                static_cast<size_t>(dataEnd - data) >= pathLength;
+        if (valid)
+        {
+            sensorNumbers.emplace_back(
+                sensorNum,
+                std::string(reinterpret_cast<const char*>(data), pathLength));
+            data += pathLength;
+        }
+    }
+    for (uint32_t i = 0; valid && i <= header.recordIDs; i++)
+    {
+        uint32_t offset = 0;
+        valid = readBytes(&offset, sizeof(offset)) &&
+                offset <= header.imageSize &&
+                (repo.offsets.empty() || offset >= repo.offsets.back());
+        repo.offsets.emplace_back(offset);
+    }
+    if (valid && static_cast<size_t>(dataEnd - data) == header.imageSize)
+    {
+        repo.mapping = std::move(mapping);
+        repo.mappedImage = data;
+        repo.mappedSize = header.imageSize;
+        repo.recordCount = header.recordCount;
+        repo.persisted = true;
+        repo.built = std::chrono::steady_clock::now();
+        trackSdrChanges(repo);
+        sdrRepository = std::move(repo);
+        persistedSensorNumbers = std::move(sensorNumbers);
+    }
+    else
+    {
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            "loadSdrRepository: ignoring stale or corrupt SDR cache");
+    }
+}
+
+/** @brief check a persisted SDR image against D-Bus in the background
+ *
+ *  If the sensor numbering changed the persisted image is dropped right
+ *  away, otherwise it keeps being served until the rebuilt one replaces it.
+ */
+static void refreshPersistedSdrRepository()
+{
+    if (sdrRepositoryRefreshing)
+    {
+        return;
+    }
+    sdrRepositoryRefreshing = true;
+    boost::asio::spawn(*getIoContext(), [](boost::asio::yield_context yield) {
+        auto ctx = std::make_shared<ipmi::Context>(
+            getSdBus(), ipmi::netFnSensor, 0,
+            ipmi::sensor_event::cmdGetDeviceSdr, 0, 0, 0,
+            ipmi::Privilege::Admin, 0, 0, yield);
+
+        std::shared_ptr<SensorNumMap> sensorNumMap;
+        details::getSensorNumMap(sensorNumMap);
+        bool numberingMatches =
+            sensorNumMap &&
+            sensorNumMap->size() == persistedSensorNumbers.size();
+        if (numberingMatches)
+        {
+            size_t index = 0;
+            for (const auto& [number, path] : sensorNumMap->left)
+            {
+                const auto& persisted = persistedSensorNumbers[index++];
+                if (persisted.first != number || persisted.second != path)
+                {
+                    numberingMatches = false;
+                    break;
+                }
+            }
+        }
+        persistedSensorNumbers.clear();
+        if (!numberingMatches)
+        {
+            // let the next request rebuild it the regular way
+            sdrRepository = SdrRepository();
+            sdrRepositoryRefreshing = false;
+            return;
+        }
+
+        auto& sensorTree = getSensorTree();
+        size_t fruCount = 0;
+        if ((!getSensorSubtree(sensorTree) &&
+             (!sensorTree || sensorTree->empty())) ||
+            ipmi::storage::getFruSdrCount(ctx, fruCount) != ipmi::ccSuccess)
+        {
+            sdrRepository = SdrRepository();
+            sdrRepositoryRefreshing = false;
+            return;
+        }
+        size_t recordCount =
+            sensorTree->size() + fruCount + ipmi::storage::type12Count;
+
+        sdrRepositoryDirty = false;
+        SdrRepository repo = buildSdrRepository(ctx, recordCount, fruCount);
+        bool changed = trackSdrChanges(repo);
+        sdrRepository = std::move(repo);
+        if (changed)
+        {
+            saveSdrRepository(sdrRepository);
+        }
+        sdrRepositoryRefreshing = false;
+    });
+}
 
-    // populate sensor name from path
-    std::string name;
-    size_t nameStart = path.rfind("/");
-    if (nameStart != std::string::npos)
+/** @brief get the SDR repository image, rebuilding it when it is stale
+ *
+ *  The image is rebuilt when a sensor was added or removed, a threshold
+ *  changed or the number of records changed. Records that failed to build
+ *  are retried after sensorMapSdrUpdatePeriod.
+ *
+ *  @param ctx - context of the current request
+ *
+ *  @returns pointer to the repository, nullptr if it is not available
+ */
+static const SdrRepository* getSdrRepository(ipmi::Context::ptr ctx)
+{
+    // answer from the image restored at startup while it is checked
+    if (sdrRepository.persisted)
     {
-        name = path.substr(nameStart + 1, std::string::npos - nameStart);
+        refreshPersistedSdrRepository();
+        return &sdrRepository;
     }
 
-    std::replace(name.begin(), name.end(), '_', ' ');
-    if (name.size() > FULL_RECORD_ID_STR_MAX_LENGTH)
+    auto& sensorTree = getSensorTree();
+    if (!getSensorSubtree(sensorTree) && (!sensorTree || sensorTree->empty()))
     {
-        // try to not truncate by replacing common words
-        constexpr std::array<std::pair<const char*, const char*>, 2>
-            replaceWords = {std::make_pair("Output", "Out"),
-                            std::make_pair("Input", "In")};
-        for (const auto& [find, replace] : replaceWords)
-        {
-            boost::replace_all(name, find, replace);
-        }
-
-        name.resize(FULL_RECORD_ID_STR_MAX_LENGTH);
+        return nullptr;
     }
-    record.body.id_string_info = name.size();
-    std::strncpy(record.body.id_string, name.c_str(),
-                 sizeof(record.body.id_string));
-
-    // Remember the sensor name, as determined for this sensor number
-    details::sdrStatsTable.updateName(sensornumber, name);
+    size_t fruCount = 0;
+    if (ipmi::storage::getFruSdrCount(ctx, fruCount) != ipmi::ccSuccess)
+    {
+        return nullptr;
+    }
+    size_t recordCount =
+        sensorTree->size() + fruCount + ipmi::storage::type12Count;
 
-    IPMIThresholds thresholdData;
-    try
+    auto now = std::chrono::steady_clock::now();
+    bool stale = sdrRepositoryDirty || sdrRepository.lastAdd != sdrLastAdd ||
+                 sdrRepository.lastRemove != sdrLastRemove ||
+                 sdrRepository.recordCount != recordCount;
+    if (!stale && sdrRepository.incomplete)
     {
-        thresholdData = getIPMIThresholds(sensorMap);
+        stale = std::chrono::duration_cast<std::chrono::seconds>(
+                    now - sdrRepository.built)
+                    .count() > sensorMapSdrUpdatePeriod;
     }
-    catch (std::exception&)
+    if (!stale)
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "getSensorDataRecord: getIPMIThresholds error");
-        return GENERAL_ERROR;
+        return &sdrRepository;
     }
 
-    if (thresholdData.criticalHigh)
+    // clear the flag first; a change seen while building marks it again
+    sdrRepositoryDirty = false;
+
+    sdrRepository = buildSdrRepository(ctx, recordCount, fruCount);
+    // the flash copy is only rewritten when a record changed
+    if (trackSdrChanges(sdrRepository))
     {
-        record.body.upper_critical_threshold = *thresholdData.criticalHigh;
-        record.body.supported_deassertions[1] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::criticalThreshold);
-        record.body.supported_deassertions[1] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::upperCriticalGoingHigh);
-        record.body.supported_assertions[1] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::upperCriticalGoingHigh);
-        record.body.discrete_reading_setting_mask[0] |=
-            static_cast<uint8_t>(IPMISensorReadingByte3::upperCritical);
+        saveSdrRepository(sdrRepository);
     }
-    if (thresholdData.warningHigh)
+    return &sdrRepository;
+}
+
+/** @brief look up one record of the SDR repository image
+ *  @param repo - the SDR repository
+ *  @param recordID - record ID
+ *  @param record - set to the first byte of the record
+ *  @param size - set to the size of the record
+ *
+ *  @returns true if the record exists
+ */
+static bool getSdrRecord(const SdrRepository& repo, uint16_t recordID,
+                         const uint8_t*& record, size_t& size)
+{
+    if (recordID >= sdrRecordIDs(repo))
     {
-        record.body.upper_noncritical_threshold = *thresholdData.warningHigh;
-        record.body.supported_deassertions[1] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::nonCriticalThreshold);
-        record.body.supported_deassertions[0] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::upperNonCriticalGoingHigh);
-        record.body.supported_assertions[0] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::upperNonCriticalGoingHigh);
-        record.body.discrete_reading_setting_mask[0] |=
-            static_cast<uint8_t>(IPMISensorReadingByte3::upperNonCritical);
+        return false;
     }
-    if (thresholdData.criticalLow)
+    size = repo.offsets[recordID + 1] - repo.offsets[recordID];
+    record = repo.imageData() + repo.offsets[recordID];
+    return size >= sizeof(get_sdr::SensorDataRecordHeader);
+}
+
+/** @brief the record ID of the first record after one of the SDR repository
+ *  @param repo - the SDR repository
+ *  @param recordID - record ID, skipped over by the free sensor slots
+ *
+ *  @returns the record ID, lastRecordIndex if there is no other record
+ */
+static uint16_t nextSdrRecordID(const SdrRepository& repo, size_t recordID)
+{
+    size_t recordIDs = sdrRecordIDs(repo);
+    for (recordID++; recordID < recordIDs; recordID++)
     {
-        record.body.lower_critical_threshold = *thresholdData.criticalLow;
-        record.body.supported_assertions[1] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::criticalThreshold);
-        record.body.supported_deassertions[0] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::lowerCriticalGoingLow);
-        record.body.supported_assertions[0] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::lowerCriticalGoingLow);
-        record.body.discrete_reading_setting_mask[0] |=
-            static_cast<uint8_t>(IPMISensorReadingByte3::lowerCritical);
+        if (repo.offsets[recordID + 1] != repo.offsets[recordID])
+        {
+            return static_cast<uint16_t>(recordID);
+        }
     }
-    if (thresholdData.warningLow)
+    return lastRecordIndex;
+}
+
+/** @brief the record ID a Get SDR of one reads
+ *  @param repo - the SDR repository
+ *  @param recordID - record ID, 0 for the first record and 0xFFFF for the
+ *                    last
+ *
+ *  @returns the record ID of the record
+ */
+static uint16_t resolveSdrRecordID(const SdrRepository& repo,
+                                   uint16_t recordID)
+{
+    if (recordID == 0 && sdrRecordIDs(repo) > 0 &&
+        repo.offsets[1] == repo.offsets[0])
     {
-        record.body.lower_noncritical_threshold = *thresholdData.warningLow;
-        record.body.supported_assertions[1] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::nonCriticalThreshold);
-        record.body.supported_deassertions[0] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::lowerNonCriticalGoingLow);
-        record.body.supported_assertions[0] |= static_cast<uint8_t>(
-            IPMISensorEventEnableThresholds::lowerNonCriticalGoingLow);
-        record.body.discrete_reading_setting_mask[0] |=
-            static_cast<uint8_t>(IPMISensorReadingByte3::lowerNonCritical);
+        return nextSdrRecordID(repo, 0);
     }
-
-    // everything that is readable is setable
-    record.body.discrete_reading_setting_mask[1] =
-        record.body.discrete_reading_setting_mask[0];
-    recordData.insert(recordData.end(), reinterpret_cast<uint8_t*>(&record),
-                      reinterpret_cast<uint8_t*>(&record) + sizeof(record));
-    return 0;
+    if (recordID == lastRecordIndex)
+    {
+        for (size_t last = sdrRecordIDs(repo); last > 0; last--)
+        {
+            if (repo.offsets[last] != repo.offsets[last - 1])
+            {
+                return static_cast<uint16_t>(last - 1);
+            }
+        }
+    }
+    return recordID;
 }
 
 /** @brief implements the get SDR Info command
@@ -1384,31 +3057,40 @@ static ipmi::RspType<uint8_t, // respcount
 {
     auto& sensorTree = getSensorTree();
     uint8_t sdrCount = 0;
-    uint16_t recordID = 0;
-    std::vector<uint8_t> record;
     // Sensors are dynamically allocated, and there is at least one LUN
     uint8_t lunsAndDynamicPopulation = 0x80;
     constexpr uint8_t getSdrCount = 0x01;
     constexpr uint8_t getSensorCount = 0x00;
 
-    if (!getSensorSubtree(sensorTree) || sensorTree.empty())
+    if (!getSensorSubtree(sensorTree) || sensorTree->empty())
     {
         return ipmi::responseResponseError();
     }
-    uint16_t numSensors = sensorTree.size();
     if (count.value_or(0) == getSdrCount)
     {
+        const SdrRepository* repo = getSdrRepository(ctx);
+        if (!repo)
+        {
+            return ipmi::responseResponseError();
+        }
         // Count the number of Type 1 SDR entries assigned to the LUN
-        while (!getSensorDataRecord(ctx, record, recordID++))
+        for (size_t recordID = 0; recordID < sdrRecordIDs(*repo); recordID++)
         {
-            get_sdr::SensorDataRecordHeader* hdr =
-                reinterpret_cast<get_sdr::SensorDataRecordHeader*>(
-                    record.data());
-            if (hdr && hdr->record_type == get_sdr::SENSOR_DATA_FULL_RECORD)
+            const uint8_t* record = nullptr;
+            size_t size = 0;
+            if (!getSdrRecord(*repo, recordID, record, size))
+            {
+                continue;
+            }
+            auto hdr =
+                reinterpret_cast<const get_sdr::SensorDataRecordHeader*>(
+                    record);
+            if (hdr->record_type == get_sdr::SENSOR_DATA_FULL_RECORD &&
+                size >= sizeof(get_sdr::SensorDataFullRecord))
             {
-                get_sdr::SensorDataFullRecord* recordData =
-                    reinterpret_cast<get_sdr::SensorDataFullRecord*>(
-                        record.data());
+                auto recordData =
+                    reinterpret_cast<const get_sdr::SensorDataFullRecord*>(
+                        record);
                 if (ctx->lun == recordData->key.owner_lun)
                 {
                     sdrCount++;
@@ -1416,57 +3098,28 @@ static ipmi::RspType<uint8_t, // respcount
             }
         }
     }
-    else if (count.value_or(0) == getSensorCount)
-    {
-        // Return the number of sensors attached to the LUN
-        if ((ctx->lun == 0) && (numSensors > 0))
-        {
-            sdrCount =
-                (numSensors > maxSensorsPerLUN) ? maxSensorsPerLUN : numSensors;
-        }
-        else if ((ctx->lun == 1) && (numSensors > maxSensorsPerLUN))
-        {
-            sdrCount = (numSensors > (2 * maxSensorsPerLUN))
-                           ? maxSensorsPerLUN
-                           : (numSensors - maxSensorsPerLUN) & maxSensorsPerLUN;
-        }
-        else if (ctx->lun == 3)
-        {
-            if (numSensors <= maxIPMISensors)
-            {
-                sdrCount =
-                    (numSensors - (2 * maxSensorsPerLUN)) & maxSensorsPerLUN;
-            }
-            else
-            {
-                // error
-                throw std::out_of_range(
-                    "Maximum number of IPMI sensors exceeded.");
-            }
-        }
-    }
-    else
+    else if (count.value_or(0) != getSensorCount)
     {
         return ipmi::responseInvalidFieldRequest();
     }
 
-    // Get Sensor count. This returns the number of sensors
-    if (numSensors > 0)
-    {
-        lunsAndDynamicPopulation |= 1;
-    }
-    if (numSensors > maxSensorsPerLUN)
+    // the sensor numbers are allocated to stay stable, so the LUNs may have
+    // gaps and are counted from the numbering
+    std::shared_ptr<SensorNumMap> sensorNumMap;
+    details::getSensorNumMap(sensorNumMap);
+    if (!sensorNumMap)
     {
-        lunsAndDynamicPopulation |= 2;
-    }
-    if (numSensors >= (maxSensorsPerLUN * 2))
-    {
-        lunsAndDynamicPopulation |= 8;
+        return ipmi::responseResponseError();
     }
-    if (numSensors > maxIPMISensors)
+    for (const auto& [number, path] : sensorNumMap->left)
     {
-        // error
-        throw std::out_of_range("Maximum number of IPMI sensors exceeded.");
+        uint8_t lun = static_cast<uint8_t>(number >> 8);
+        // Return the number of sensors attached to the LUN
+        if (count.value_or(0) == getSensorCount && lun == ctx->lun)
+        {
+            sdrCount++;
+        }
+        lunsAndDynamicPopulation |= 1 << lun;
     }
 
     return ipmi::responseSuccess(sdrCount, lunsAndDynamicPopulation,
@@ -1488,7 +3141,7 @@ ipmi::RspType<uint8_t,  // sdr version
 {
     auto& sensorTree = getSensorTree();
     constexpr const uint16_t unspecifiedFreeSpace = 0xFFFF;
-    if (!getSensorSubtree(sensorTree) && sensorTree.empty())
+    if (!getSensorSubtree(sensorTree) && (!sensorTree || sensorTree->empty()))
     {
         return ipmi::responseResponseError();
     }
@@ -1501,7 +3154,7 @@ ipmi::RspType<uint8_t,  // sdr version
     }
 
     uint16_t recordCount =
-        sensorTree.size() + fruCount + ipmi::storage::type12Count;
+        sensorTree->size() + fruCount + ipmi::storage::type12Count;
 
     uint8_t operationSupport = static_cast<uint8_t>(
         SdrRepositoryInfoOps::overflow); // write not supported
@@ -1544,6 +3197,94 @@ ipmi::RspType<uint16_t, // allocUnits
                                  allocUnitLargestFree, maxRecordSize);
 }
 
+/** @brief fetch in the background the stale SensorCache entries of the
+ *  sensors of the records after one, across all their connections
+ *
+ *  A host walking the repository reads the sensor of every record it gets,
+ *  so the fetches overlap the round trips of the walk instead of holding up
+ *  its reads.
+ *  @param recordID - the record the walk is at
+ */
+static void prefetchSdrWalk(uint16_t recordID)
+{
+    std::shared_ptr<SensorNumMap> sensorNumMap;
+    std::shared_ptr<const SensorSubTree> numberedTree;
+    details::getSensorNumMap(sensorNumMap);
+    details::getSensorSubtree(numberedTree);
+    if (!sensorNumMap || !numberedTree || recordID >= maxIPMISensors)
+    {
+        return;
+    }
+
+    // the sensor numbers are in the order of their slots, so of the sensor
+    // record IDs
+    boost::container::flat_set<std::string> connections;
+    auto numbered =
+        sensorNumMap->left.upper_bound(details::slotSensorNumber(recordID));
+    for (size_t i = 0;
+         i < sdrPrefetchRecords && numbered != sensorNumMap->left.end();
+         i++, ++numbered)
+    {
+        auto sensor = numberedTree->find(numbered->second);
+        if (sensor == numberedTree->end() || sensor->second.empty())
+        {
+            continue;
+        }
+        std::string connection = sensorName(sensor->second.begin()->first);
+        if (sensorMapFetching.find(connection) == sensorMapFetching.end() &&
+            sensorMapStale(connection, sensorMapUpdatePeriod))
+        {
+            connections.insert(std::move(connection));
+        }
+    }
+    for (const std::string& connection : connections)
+    {
+        boost::asio::spawn(
+            *getIoContext(), [connection](boost::asio::yield_context yield) {
+                auto ctx = std::make_shared<ipmi::Context>(
+                    getSdBus(), ipmi::netFnSensor, 0,
+                    ipmi::sensor_event::cmdGetSensorReading, 0, 0, 0,
+                    ipmi::Privilege::Admin, 0, 0, yield);
+                // no path, only the cache entry is wanted
+                SensorRecord sensor;
+                getSensorMap(ctx, connection, std::string(), sensor);
+            });
+    }
+}
+
+/** @brief note the record a requester started to read, and prefetch ahead
+ *  of it when the requester walks the repository
+ *  @param ctx - context of the current request
+ *  @param first - the requester asked for the first record
+ *  @param recordID - the record
+ *  @param nextRecordID - the record after it, the requester was told
+ */
+static void trackSdrWalk(ipmi::Context::ptr ctx, bool first, uint16_t recordID,
+                         uint16_t nextRecordID)
+{
+    auto requester = std::make_tuple(ctx->channel, ctx->sessionId, ctx->rqSA);
+    auto walker = sdrWalkers.find(requester);
+    // a walk starts at the first record and follows the next record IDs
+    bool walking = first || (walker != sdrWalkers.end() &&
+                             recordID == walker->second);
+    if (walker == sdrWalkers.end())
+    {
+        if (sdrWalkers.size() >= maxSdrWalkers)
+        {
+            sdrWalkers.clear();
+        }
+        sdrWalkers.emplace(requester, nextRecordID);
+    }
+    else
+    {
+        walker->second = nextRecordID;
+    }
+    if (walking)
+    {
+        prefetchSdrWalk(recordID);
+    }
+}
+
 /** @brief implements the reserve SDR command
  *  @returns IPMI completion code plus response data
  *   - sdrReservationID
@@ -1555,6 +3296,7 @@ ipmi::RspType<uint16_t> ipmiStorageReserveSDR()
     {
         sdrReservationID++;
     }
+    pinnedSdrRecords.clear();
 
     return ipmi::responseSuccess(sdrReservationID);
 }
@@ -1565,7 +3307,6 @@ ipmi::RspType<uint16_t,            // next record ID
     ipmiStorageGetSDR(ipmi::Context::ptr ctx, uint16_t reservationID,
                       uint16_t recordID, uint8_t offset, uint8_t bytesToRead)
 {
-    size_t fruCount = 0;
     // reservation required for partial reads with non zero offset into
     // record
     if ((sdrReservationID == 0 || reservationID != sdrReservationID) && offset)
@@ -1574,65 +3315,238 @@ ipmi::RspType<uint16_t,            // next record ID
             "ipmiStorageGetSDR: responseInvalidReservationId");
         return ipmi::responseInvalidReservationId();
     }
-    ipmi::Cc ret = ipmi::storage::getFruSdrCount(ctx, fruCount);
-    if (ret != ipmi::ccSuccess)
+
+    const SdrRepository* repo = getSdrRepository(ctx);
+    if (!repo)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "ipmiStorageGetSDR: getFruSdrCount error");
-        return ipmi::response(ret);
+            "ipmiStorageGetSDR: SDR repository unavailable");
+        return ipmi::responseResponseError();
     }
+    bool first = recordID == 0;
+    bool last = recordID == lastRecordIndex;
+    recordID = resolveSdrRecordID(*repo, recordID);
+    uint16_t nextRecordId = nextSdrRecordID(*repo, recordID);
 
-    auto& sensorTree = getSensorTree();
-    size_t lastRecord =
-        sensorTree.size() + fruCount + ipmi::storage::type12Count - 1;
-    uint16_t nextRecordId = lastRecord > recordID ? recordID + 1 : 0XFFFF;
+    const uint8_t* record = nullptr;
+    size_t sdrLength = 0;
+    auto pinned = pinnedSdrRecords.end();
+    if (offset)
+    {
+        pinned = pinnedSdrRecords.find(recordID);
+    }
+    if (pinned != pinnedSdrRecords.end())
+    {
+        record = pinned->second.data();
+        sdrLength = pinned->second.size();
+    }
+    else
+    {
+        if (!getSdrRecord(*repo, recordID, record, sdrLength))
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                "ipmiStorageGetSDR: fail to get SDR");
+            return ipmi::responseInvalidFieldRequest();
+        }
+        auto hdr =
+            reinterpret_cast<const get_sdr::SensorDataRecordHeader*>(record);
+        sdrLength =
+            std::min(sdrLength, sizeof(get_sdr::SensorDataRecordHeader) +
+                                    hdr->record_length);
+        if (reservationID == sdrReservationID && sdrReservationID != 0 &&
+            static_cast<size_t>(offset) + bytesToRead < sdrLength)
+        {
+            if (pinnedSdrRecords.size() >= maxPinnedSdrRecords)
+            {
+                pinnedSdrRecords.clear();
+            }
+            auto& copy = pinnedSdrRecords[recordID];
+            copy.assign(record, record + sdrLength);
+            record = copy.data();
+        }
+    }
+    if (offset > sdrLength)
+    {
+        return ipmi::responseParmOutOfRange();
+    }
+    if (sdrLength < (offset + bytesToRead))
+    {
+        bytesToRead = sdrLength - offset;
+    }
+
+    const uint8_t* respStart = record + offset;
+    std::vector<uint8_t> recordData(respStart, respStart + bytesToRead);
 
-    if (!getSensorSubtree(sensorTree) && sensorTree.empty())
+    if (offset == 0 && !last)
+    {
+        trackSdrWalk(ctx, first, recordID, nextRecordId);
+    }
+
+    return ipmi::responseSuccess(nextRecordId, recordData);
+}
+
+/** @brief implements the OpenBMC OEM Get SDR Changes command
+ *  @param ctx - context of the current request
+ *  @param generation - SDR generation the host last synced to
+ *  @param startRecord - first record ID to report, to resume a truncated
+ *                       response
+ *
+ *  @returns IPMI completion code plus response data
+ *   - current - current SDR generation
+ *   - flags - bit 0 set when the changes since generation are not known,
+ *             and the whole repository has to be read again
+ *   - nextRecord - record ID to resume from, 0xFFFF when complete
+ *   - changes - per changed record: record ID and the kind of change
+ */
+ipmi::RspType<uint64_t,              // current
+              uint8_t,               // flags
+              uint16_t,              // nextRecord
+              ipmi::message::Payload // changes
+              >
+    ipmiStorageGetSdrChanges(ipmi::Context::ptr ctx, uint64_t generation,
+                             uint16_t startRecord)
+{
+    // NetFn/LUN, Cmd and CC bytes, 3 IANA bytes, 8 current bytes, the flags
+    // and 2 nextRecord bytes ahead of the changes
+    constexpr size_t responseOverhead = 17;
+    constexpr size_t changeEntrySize = 3;
+    constexpr uint8_t resyncRequired = 0x01;
+    constexpr uint16_t lastRecord = 0xFFFF;
+    enum class SdrChange : uint8_t
+    {
+        added = 0,
+        modified = 1,
+        removed = 2,
+    };
+
+    if (!getSdrRepository(ctx))
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "ipmiStorageGetSDR: getSensorSubtree error");
         return ipmi::responseResponseError();
     }
 
-    std::vector<uint8_t> record;
-    if (getSensorDataRecord(ctx, record, recordID))
+    ipmi::message::Payload changes;
+    if (generation < sdrFirstGeneration || generation > sdrGeneration)
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "ipmiStorageGetSDR: fail to get SDR");
-        return ipmi::responseInvalidFieldRequest();
+        return ipmi::responseSuccess(sdrGeneration, resyncRequired,
+                                     lastRecord, changes);
     }
-    get_sdr::SensorDataRecordHeader* hdr =
-        reinterpret_cast<get_sdr::SensorDataRecordHeader*>(record.data());
-    if (!hdr)
+
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxEntries = 0;
+    if (maxTransfer > responseOverhead)
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "ipmiStorageGetSDR: record header is null");
-        return ipmi::responseSuccess(nextRecordId, record);
+        maxEntries = (maxTransfer - responseOverhead) / changeEntrySize;
+    }
+    if (maxEntries == 0)
+    {
+        return ipmi::responseResponseError();
     }
 
-    size_t sdrLength =
-        sizeof(get_sdr::SensorDataRecordHeader) + hdr->record_length;
-    if (sdrLength < (offset + bytesToRead))
+    uint16_t nextRecord = lastRecord;
+    size_t count = 0;
+    for (size_t recordID = startRecord;
+         recordID < std::min<size_t>(sdrRecordChanges.size(), lastRecord);
+         recordID++)
     {
-        bytesToRead = sdrLength - offset;
+        const SdrRecordChange& change = sdrRecordChanges[recordID];
+        if (change.changed <= generation)
+        {
+            continue;
+        }
+        if (count == maxEntries)
+        {
+            nextRecord = static_cast<uint16_t>(recordID);
+            break;
+        }
+        SdrChange kind = !change.present          ? SdrChange::removed
+                         : change.added > generation ? SdrChange::added
+                                                     : SdrChange::modified;
+        changes.pack(static_cast<uint16_t>(recordID),
+                     static_cast<uint8_t>(kind));
+        count++;
     }
 
-    uint8_t* respStart = reinterpret_cast<uint8_t*>(hdr) + offset;
-    if (!respStart)
+    return ipmi::responseSuccess(sdrGeneration, static_cast<uint8_t>(0),
+                                 nextRecord, changes);
+}
+
+/** @brief implements the OpenBMC OEM Read SDR Image command
+ *
+ *  Reads the whole SDR repository, as the records of Get SDR one after the
+ *  other, in as few transfers as the channel allows.
+ *
+ *  @param ctx - context of the current request
+ *  @param generation - SDR generation of the image being read, 0 to start
+ *  @param offset - byte of the image to read from
+ *
+ *  @returns IPMI completion code plus response data
+ *   - current - SDR generation of the image, the one to read on with
+ *   - flags - bit 0 set when generation is not the current one any more,
+ *             the image has to be read again from offset 0 and no data
+ *             follows
+ *   - imageSize - bytes in the image
+ *   - recordCount - records in the image
+ *   - data - the image from offset on, as much as the channel transfers
+ */
+ipmi::RspType<uint64_t,            // current
+              uint8_t,             // flags
+              uint32_t,            // imageSize
+              uint16_t,            // recordCount
+              std::vector<uint8_t> // data
+              >
+    ipmiStorageReadSdrImage(ipmi::Context::ptr ctx, uint64_t generation,
+                            uint32_t offset)
+{
+    // NetFn/LUN, Cmd, CC, IANA, current, flags, imageSize and recordCount
+    // bytes ahead of the data
+    constexpr size_t responseOverhead = 21;
+    constexpr uint8_t restartRequired = 0x01;
+
+    const SdrRepository* repo = getSdrRepository(ctx);
+    if (!repo || repo->imageSize() > std::numeric_limits<uint32_t>::max() ||
+        repo->recordCount > std::numeric_limits<uint16_t>::max())
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "ipmiStorageGetSDR: record is null");
-        return ipmi::responseSuccess(nextRecordId, record);
+        return ipmi::responseResponseError();
     }
+    uint32_t imageSize = static_cast<uint32_t>(repo->imageSize());
+    uint16_t recordCount = static_cast<uint16_t>(repo->recordCount);
 
-    std::vector<uint8_t> recordData(respStart, respStart + bytesToRead);
+    // the image changed under a copy in progress
+    if (generation != 0 && generation != sdrGeneration)
+    {
+        return ipmi::responseSuccess(sdrGeneration, restartRequired,
+                                     imageSize, recordCount,
+                                     std::vector<uint8_t>());
+    }
+    if (offset > imageSize)
+    {
+        return ipmi::responseParmOutOfRange();
+    }
 
-    return ipmi::responseSuccess(nextRecordId, recordData);
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    if (maxTransfer <= responseOverhead)
+    {
+        return ipmi::responseRetBytesUnavailable();
+    }
+    size_t size = std::min<size_t>(maxTransfer - responseOverhead,
+                                   imageSize - offset);
+    const uint8_t* begin = repo->imageData() + offset;
+    return ipmi::responseSuccess(sdrGeneration, static_cast<uint8_t>(0),
+                                 imageSize, recordCount,
+                                 std::vector<uint8_t>(begin, begin + size));
 }
 /* end storage commands */
 
 void registerSensorFunctions()
 {
+    // restore the SDR image of the previous run for a fast cold start
+    loadSdrRepository();
+
+    // fill the sensor cache once ipmid runs, and again for every new
+    // sensor subtree
+    details::onSensorTreeSwap(warmUpSensorCache);
+    boost::asio::post(*getIoContext(), warmUpSensorCache);
+
     // <Platform Event>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnSensor,
                           ipmi::sensor_event::cmdPlatformEvent,
@@ -1648,7 +3562,41 @@ void registerSensorFunctions()
     // <Get Sensor Reading>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnSensor,
                           ipmi::sensor_event::cmdGetSensorReading,
-                          ipmi::Privilege::User, ipmiSenGetSensorReading);
+                          ipmi::Privilege::User, ipmi::Idempotent{},
+                          ipmiSenGetSensorReading);
+
+    // <Get Multiple Sensor Readings>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getMultipleSensorReadingsCmd,
+                             ipmi::Privilege::User,
+                             ipmiSenGetMultipleSensorReadings);
+
+    // <Subscribe Sensor Changes>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::subscribeSensorChangesCmd,
+                             ipmi::Privilege::User,
+                             ipmiSenSubscribeSensorChanges);
+
+    // <Get Sensor Snapshot>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getSensorSnapshotCmd, ipmi::Privilege::User,
+                             ipmiSenGetSensorSnapshot);
+
+    // <Get SDR Changes>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getSdrChangesCmd, ipmi::Privilege::User,
+                             ipmiStorageGetSdrChanges);
+
+    // <Read SDR Image>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::readSdrImageCmd, ipmi::Privilege::User,
+                             ipmiStorageReadSdrImage);
+
+    // <Get Sensor Read Statistics>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getSensorReadStatsCmd, ipmi::Privilege::User,
+                             ipmiSenGetSensorReadStats);
+    static auto sensorReadStatsIface = registerSensorReadStatistics();
 
     // <Get Sensor Threshold>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnSensor,
@@ -1675,10 +3623,22 @@ void registerSensorFunctions()
     // versions
 
     // <Get SDR Repository Info>
-    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnStorage,
-                          ipmi::storage::cmdGetSdrRepositoryInfo,
-                          ipmi::Privilege::User,
-                          ipmiStorageGetSDRRepositoryInfo);
+    // the record count and timestamps only change along with the sensor and
+    // FRU objects, and with the sensor subtree that follows them
+    ipmi::registerHandler(
+        ipmi::prioOpenBmcBase, ipmi::netFnStorage,
+        ipmi::storage::cmdGetSdrRepositoryInfo, ipmi::Privilege::User,
+        ipmi::CachePolicy{{"type='signal',member='InterfacesAdded',"
+                           "arg0path='/xyz/openbmc_project/sensors/'",
+                           "type='signal',member='InterfacesRemoved',"
+                           "arg0path='/xyz/openbmc_project/sensors/'",
+                           "type='signal',member='InterfacesAdded',"
+                           "arg0path='/xyz/openbmc_project/FruDevice/'",
+                           "type='signal',member='InterfacesRemoved',"
+                           "arg0path='/xyz/openbmc_project/FruDevice/'"},
+                          {},
+                          details::getSensorTreeGeneration},
+        ipmiStorageGetSDRRepositoryInfo);
 
     // <Get Device SDR Info>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnSensor,
@@ -19,6 +19,10 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace ipmi
 {
@@ -255,37 +259,60 @@ bool getSensorAttributes(const double max, const double min, int16_t& mValue,
     return true;
 }
 
+// Precompute the powers of ten of scaleIPMIValueFromDouble()
+static SensorAttributes makeSensorAttributes(const int16_t mValue,
+                                             const int8_t rExp,
+                                             const int16_t bValue,
+                                             const int8_t bExp,
+                                             const bool bSigned)
+{
+    SensorAttributes attributes;
+    attributes.mValue = mValue;
+    attributes.rExp = rExp;
+    attributes.bValue = bValue;
+    attributes.bExp = bExp;
+    attributes.bSigned = bSigned;
+    attributes.rScale = std::pow(10.0, -rExp);
+    attributes.bOffset =
+        static_cast<double>(bValue) * std::pow(10.0, rExp + bExp);
+    return attributes;
+}
+
 uint8_t scaleIPMIValueFromDouble(const double value, const int16_t mValue,
                                  const int8_t rExp, const int16_t bValue,
                                  const int8_t bExp, const bool bSigned)
+{
+    return scaleIPMIValueFromDouble(
+        value, makeSensorAttributes(mValue, rExp, bValue, bExp, bSigned));
+}
+
+uint8_t scaleIPMIValueFromDouble(const double value,
+                                 const SensorAttributes& attributes)
 {
     // Avoid division by zero below
-    if (mValue == 0)
+    if (attributes.mValue == 0)
     {
         throw std::out_of_range("Scaling multiplier is uninitialized");
     }
 
-    auto dM = static_cast<double>(mValue);
-    auto dB = static_cast<double>(bValue);
+    auto dM = static_cast<double>(attributes.mValue);
 
     // Solve the IPMI equation for x, instead of y
     // https://www.wolframalpha.com/input/?i=solve+y%3D%28%28M*x%29%2B%28B*%2810%5EE%29%29%29*%2810%5ER%29+for+x
     // x = (10^(-rExp) (y - B 10^(rExp + bExp)))/M and M 10^rExp!=0
     // TODO(): Compare with this alternative solution from SageMathCell
     // https://sagecell.sagemath.org/?z=eJyrtC1LLNJQr1TX5KqAMCuATF8I0xfIdIIwnYDMIteKAggPxAIKJMEFkiACxfk5Zaka0ZUKtrYKGhq-CloKFZoK2goaTkCWhqGBgpaWAkilpqYmQgBklmasDlAlAMB8JP0=&lang=sage&interacts=eJyLjgUAARUAuQ==
-    double dX =
-        (std::pow(10.0, -rExp) * (value - (dB * std::pow(10.0, rExp + bExp)))) /
-        dM;
+    // The operations are kept in this order, folding them into a single
+    // multiply-add moves some readings that fall on .5 to the next step
+    double dX = (attributes.rScale * (value - attributes.bOffset)) / dM;
 
-    auto scaledValue = static_cast<int32_t>(std::round(dX));
-
-    int32_t minClamp;
-    int32_t maxClamp;
+    double minClamp;
+    double maxClamp;
 
     // Because of rounding and integer truncation of scaling factors,
     // sometimes the resulting byte is slightly out of range.
     // Still allow this, but clamp the values to range.
-    if (bSigned)
+    if (attributes.bSigned)
     {
         minClamp = std::numeric_limits<int8_t>::lowest();
         maxClamp = std::numeric_limits<int8_t>::max();
@@ -296,13 +323,119 @@ uint8_t scaleIPMIValueFromDouble(const double value, const int16_t mValue,
         maxClamp = std::numeric_limits<uint8_t>::max();
     }
 
-    auto clampedValue = std::clamp(scaledValue, minClamp, maxClamp);
+    // Clamp before the conversion to an integer, which is undefined for
+    // NaN and values out of its range; a NaN reading lands on the bottom
+    auto clampedValue = static_cast<int32_t>(
+        std::fmin(std::fmax(std::round(dX), minClamp), maxClamp));
 
     // This works for both signed and unsigned,
     // because it is the same underlying byte storage.
     return static_cast<uint8_t>(clampedValue);
 }
 
+void SensorScalingBatch::reserve(size_t count)
+{
+    for (auto* column : {&values, &rScale, &bOffset, &mValue, &minClamp,
+                         &maxClamp})
+    {
+        column->reserve(count);
+    }
+}
+
+void SensorScalingBatch::add(const double value,
+                             const SensorAttributes& attributes)
+{
+    if (attributes.mValue == 0)
+    {
+        throw std::out_of_range("Scaling multiplier is uninitialized");
+    }
+    values.push_back(value);
+    rScale.push_back(attributes.rScale);
+    bOffset.push_back(attributes.bOffset);
+    mValue.push_back(static_cast<double>(attributes.mValue));
+    if (attributes.bSigned)
+    {
+        minClamp.push_back(std::numeric_limits<int8_t>::lowest());
+        maxClamp.push_back(std::numeric_limits<int8_t>::max());
+    }
+    else
+    {
+        minClamp.push_back(std::numeric_limits<uint8_t>::lowest());
+        maxClamp.push_back(std::numeric_limits<uint8_t>::max());
+    }
+}
+
+void SensorScalingBatch::clear()
+{
+    for (auto* column : {&values, &rScale, &bOffset, &mValue, &minClamp,
+                         &maxClamp})
+    {
+        column->clear();
+    }
+}
+
+void SensorScalingBatch::scale(uint8_t* bytes) const
+{
+    const size_t count = values.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        double dX = (rScale[i] * (values[i] - bOffset[i])) / mValue[i];
+        // the bounds are integers, so clamping before rounding gives the
+        // same result as scaleIPMIValueFromDouble(); written with compares
+        // rather than fmin/fmax/round to keep the loop free of calls, NaN
+        // still ends up on the lower bound
+        dX = dX > minClamp[i] ? dX : minClamp[i];
+        dX = dX < maxClamp[i] ? dX : maxClamp[i];
+        // round half away from zero, dX - truncated is exact
+        int32_t truncated = static_cast<int32_t>(dX);
+        double fraction = dX - truncated;
+        truncated += (fraction >= 0.5) - (fraction <= -0.5);
+        bytes[i] = static_cast<uint8_t>(truncated);
+    }
+}
+
+std::optional<SensorAttributes> getSensorAttributes(const double max,
+                                                    const double min)
+{
+    // most sensors share a handful of ranges, and a range only changes
+    // with the limits of its sensor, so the bound is rarely reached
+    static constexpr size_t maxRanges = 256;
+    static std::map<std::pair<double, double>, std::optional<SensorAttributes>>
+        ranges;
+
+    int16_t mValue = 0;
+    int8_t rExp = 0;
+    int16_t bValue = 0;
+    int8_t bExp = 0;
+    bool bSigned = false;
+
+    // NaN can't be ordered in the map, and is rejected anyway
+    if (!std::isfinite(max) || !std::isfinite(min))
+    {
+        getSensorAttributes(max, min, mValue, rExp, bValue, bExp, bSigned);
+        return std::nullopt;
+    }
+
+    auto range = ranges.find({max, min});
+    if (range != ranges.end())
+    {
+        return range->second;
+    }
+    if (ranges.size() >= maxRanges)
+    {
+        ranges.clear();
+    }
+
+    std::optional<SensorAttributes> attributes;
+    if (getSensorAttributes(max, min, mValue, rExp, bValue, bExp, bSigned))
+    {
+        attributes = makeSensorAttributes(mValue, rExp, bValue, bExp, bSigned);
+    }
+    // unusable ranges are kept too, so they are only reported once
+    ranges.emplace(std::make_pair(max, min), attributes);
+    return attributes;
+}
+
 uint8_t getScaledIPMIValue(const double value, const double max,
                            const double min)
 {
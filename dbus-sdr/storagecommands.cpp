@@ -17,20 +17,30 @@
 #include "dbus-sdr/storagecommands.hpp"
 
 #include "dbus-sdr/sdrutils.hpp"
+#include "selindex.hpp"
 #include "selutility.hpp"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/process.hpp>
+#include <charconv>
+#include <ctime>
 #include <filesystem>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <ipmid/api.hpp>
+#include <ipmid/dbus-signals.hpp>
+#include <ipmid/iana.hpp>
 #include <ipmid/message.hpp>
+#include <ipmid/oemopenbmc.hpp>
 #include <ipmid/types.hpp>
+#include <optional>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/message/types.hpp>
-#include <sdbusplus/timer.hpp>
+#include <sstream>
 #include <stdexcept>
 #include <string_view>
 
@@ -56,6 +66,9 @@ namespace erase_time
 {
 static constexpr const char* selEraseTimestamp = "/var/lib/ipmi/sel_erase_time";
 
+// last erase time, read from the file once and then kept up to date by save()
+static std::optional<int> eraseTimestamp;
+
 void save()
 {
     // open the file, creating it if necessary
@@ -63,6 +76,7 @@ void save()
     if (fd < 0)
     {
         std::cerr << "Failed to open file\n";
+        eraseTimestamp.reset();
         return;
     }
 
@@ -73,11 +87,16 @@ void save()
                   << std::string(strerror(errno));
     }
     close(fd);
+    eraseTimestamp = getFileTimestamp(selEraseTimestamp);
 }
 
 int get()
 {
-    return getFileTimestamp(selEraseTimestamp);
+    if (!eraseTimestamp)
+    {
+        eraseTimestamp = getFileTimestamp(selEraseTimestamp);
+    }
+    return *eraseTimestamp;
 }
 } // namespace erase_time
 } // namespace dynamic_sensors::ipmi::sel
@@ -107,16 +126,23 @@ constexpr static const char* chassisTypeRackMount = "23";
 // event direction is bit[7] of eventType where 1b = Deassertion event
 constexpr static const uint8_t deassertionEvent = 0x80;
 
-static std::vector<uint8_t> fruCache;
-static uint8_t cacheBus = 0xFF;
-static uint8_t cacheAddr = 0XFF;
-static uint8_t lastDevId = 0xFF;
-
-static uint8_t writeBus = 0xFF;
-static uint8_t writeAddr = 0XFF;
-
-std::unique_ptr<phosphor::Timer> writeTimer = nullptr;
-static std::vector<sdbusplus::bus::match::match> fruMatches;
+struct FruCacheEntry
+{
+    uint8_t bus;
+    uint8_t addr;
+    std::vector<uint8_t> data;
+    // the contents were changed since they were last written back
+    bool dirty = false;
+    // a write of the contents is in flight
+    bool writing = false;
+    // writes the contents back once no further data is sent
+    std::unique_ptr<boost::asio::steady_timer> writeTimer;
+};
+
+// raw FRU contents by device ID, read from FruDevice on first access
+static boost::container::flat_map<uint8_t, FruCacheEntry> fruCache;
+
+static std::vector<dbus_signals::Subscription> fruMatches;
 
 ManagedObjectType frus;
 
@@ -124,44 +150,259 @@ ManagedObjectType frus;
 // collision to verify our dev-id
 boost::container::flat_map<uint8_t, std::pair<uint8_t, uint8_t>> deviceHashes;
 
+// the FRU SDR records in the order of deviceHashes, built along with it
+std::vector<get_sdr::SensorDataFruRecord> fruSdrs;
+
+#ifdef USING_ENTITY_MANAGER_DECORATORS
+constexpr static const char* fruDeviceDecorator =
+    "xyz.openbmc_project.Inventory.Decorator.FruDevice";
+constexpr static const char* ipmiDecorator =
+    "xyz.openbmc_project.Inventory.Decorator.Ipmi";
+
+// whether fruSdrs holds the entities of the entity-manager decorators
+bool fruSdrEntitiesValid = false;
+// bumped whenever the records or the decorators change, so a fill that
+// yielded over a change doesn't mark its stale entities valid
+uint64_t fruSdrEntitiesGeneration = 0;
+
+static std::vector<dbus_signals::Subscription> entityMatches;
+
+void invalidateFruSdrEntities()
+{
+    fruSdrEntitiesValid = false;
+    fruSdrEntitiesGeneration++;
+}
+#endif
+
 void registerStorageFunctions() __attribute__((constructor));
 
-bool writeFru()
+/** @brief find the cached contents of a FRU device
+ *  @param bus - bus of the device
+ *  @param addr - address of the device
+ *
+ *  @returns the cache entry, nullptr when the device is not cached
+ */
+FruCacheEntry* findCachedFru(uint8_t bus, uint8_t addr)
 {
-    if (writeBus == 0xFF && writeAddr == 0xFF)
+    for (auto& [devId, fru] : fruCache)
     {
-        return true;
+        if (fru.bus == bus && fru.addr == addr)
+        {
+            return &fru;
+        }
     }
-    std::shared_ptr<sdbusplus::asio::connection> dbus = getSdBus();
-    sdbusplus::message::message writeFru = dbus->new_method_call(
-        fruDeviceServiceName, "/xyz/openbmc_project/FruDevice",
-        "xyz.openbmc_project.FruDeviceManager", "WriteFru");
-    writeFru.append(writeBus, writeAddr, fruCache);
-    try
+    return nullptr;
+}
+
+/** @brief start writing the cached contents of a FRU device back
+ *  @param fru - cache entry of the device
+ *
+ *  @returns the contents to write, nothing when they are unchanged or a
+ *           write is already in flight, which writes them once it is done
+ */
+std::optional<std::vector<uint8_t>> beginFruWrite(FruCacheEntry& fru)
+{
+    if (fru.writeTimer)
     {
-        sdbusplus::message::message writeFruResp = dbus->call(writeFru);
+        fru.writeTimer->cancel();
     }
-    catch (sdbusplus::exception_t&)
+    if (!fru.dirty || fru.writing)
+    {
+        return std::nullopt;
+    }
+    fru.dirty = false;
+    fru.writing = true;
+    return fru.data;
+}
+
+void writeFru(FruCacheEntry& fru);
+void invalidateFruCache(uint8_t bus, uint8_t addr);
+
+/** @brief finish a write of the cached contents of a FRU device
+ *  @param bus - bus of the device
+ *  @param addr - address of the device
+ *  @param ec - result of the write
+ *
+ *  @returns whether the write succeeded
+ */
+bool endFruWrite(uint8_t bus, uint8_t addr, const boost::system::error_code& ec)
+{
+    // the entry can have been dropped while the write was in flight
+    FruCacheEntry* fru = findCachedFru(bus, addr);
+    if (ec)
     {
         // todo: log sel?
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "error writing fru");
+            "error writing fru",
+            phosphor::logging::entry("ERROR=%s", ec.message().c_str()));
+    }
+    if (fru == nullptr)
+    {
+        return !ec;
+    }
+    fru->writing = false;
+    if (ec)
+    {
+        // the cached contents no longer match the device
+        invalidateFruCache(bus, addr);
         return false;
     }
-    writeBus = 0xFF;
-    writeAddr = 0xFF;
+    // write the data that came in while this write was in flight
+    writeFru(*fru);
     return true;
 }
 
-void createTimers()
+/** @brief write the changed contents of a FRU device back, without waiting
+ *         for the write
+ *  @param fru - cache entry of the device
+ */
+void writeFru(FruCacheEntry& fru)
 {
-    writeTimer = std::make_unique<phosphor::Timer>(writeFru);
+    std::optional<std::vector<uint8_t>> data = beginFruWrite(fru);
+    if (!data)
+    {
+        return;
+    }
+    uint8_t bus = fru.bus;
+    uint8_t addr = fru.addr;
+    getSdBus()->async_method_call(
+        [bus, addr](const boost::system::error_code& ec) {
+            endFruWrite(bus, addr, ec);
+        },
+        fruDeviceServiceName, "/xyz/openbmc_project/FruDevice",
+        "xyz.openbmc_project.FruDeviceManager", "WriteFru", bus, addr, *data);
+}
+
+/** @brief write the changed contents of a FRU device back; the entry can be
+ *         dropped once the coroutine yields, so it must not be used after
+ *  @param ctx - context of the current request
+ *  @param fru - cache entry of the device
+ *
+ *  @returns whether the write succeeded
+ */
+bool writeFru(ipmi::Context::ptr ctx, FruCacheEntry& fru)
+{
+    std::optional<std::vector<uint8_t>> data = beginFruWrite(fru);
+    if (!data)
+    {
+        return true;
+    }
+    uint8_t bus = fru.bus;
+    uint8_t addr = fru.addr;
+    boost::system::error_code ec;
+    ctx->bus->yield_method_call(ctx->yield, ec, fruDeviceServiceName,
+                                "/xyz/openbmc_project/FruDevice",
+                                "xyz.openbmc_project.FruDeviceManager",
+                                "WriteFru", bus, addr, *data);
+    return endFruWrite(bus, addr, ec);
+}
+
+/** @brief write the changed contents of every cached FRU device back */
+void writeAllFru()
+{
+    for (auto& [devId, fru] : fruCache)
+    {
+        writeFru(fru);
+    }
+}
+
+/** @brief drop the cached contents of a FRU device
+ *  @param bus - bus of the device
+ *  @param addr - address of the device
+ */
+void invalidateFruCache(uint8_t bus, uint8_t addr)
+{
+    for (auto fru = fruCache.begin(); fru != fruCache.end();)
+    {
+        if (fru->second.bus == bus && fru->second.addr == addr)
+        {
+            fru = fruCache.erase(fru);
+        }
+        else
+        {
+            fru++;
+        }
+    }
+}
+
+/** @brief drop the cached contents of the FRU device of an object
+ *  @param object - interfaces of a FruDevice object
+ */
+void invalidateFruCache(const ObjectType& object)
+{
+    auto fruIface = object.find("xyz.openbmc_project.FruDevice");
+    if (fruIface == object.end())
+    {
+        return;
+    }
+    auto busFind = fruIface->second.find("BUS");
+    auto addrFind = fruIface->second.find("ADDRESS");
+    if (busFind == fruIface->second.end() ||
+        addrFind == fruIface->second.end())
+    {
+        return;
+    }
+    invalidateFruCache(std::get<uint32_t>(busFind->second),
+                       std::get<uint32_t>(addrFind->second));
+}
+
+/** @brief build the FRU SDR record of a FRU device, without its entity
+ *  @param fruId - FRU device ID
+ *  @param fruData - properties of the FruDevice interface of the device
+ *  @param resp - the record
+ */
+void buildFruSdr(uint8_t fruId,
+                 const boost::container::flat_map<std::string, Value>& fruData,
+                 get_sdr::SensorDataFruRecord& resp)
+{
+    std::string name;
+    auto findProductName = fruData.find("BOARD_PRODUCT_NAME");
+    auto findBoardName = fruData.find("PRODUCT_PRODUCT_NAME");
+    if (findProductName != fruData.end())
+    {
+        name = std::get<std::string>(findProductName->second);
+    }
+    else if (findBoardName != fruData.end())
+    {
+        name = std::get<std::string>(findBoardName->second);
+    }
+    else
+    {
+        name = "UNKNOWN";
+    }
+    if (name.size() > maxFruSdrNameSize)
+    {
+        name = name.substr(0, maxFruSdrNameSize);
+    }
+    size_t sizeDiff = maxFruSdrNameSize - name.size();
+
+    resp = {};
+    resp.header.record_id_lsb = 0x0; // calling code is to implement these
+    resp.header.record_id_msb = 0x0;
+    resp.header.sdr_version = ipmiSdrVersion;
+    resp.header.record_type = get_sdr::SENSOR_DATA_FRU_RECORD;
+    resp.header.record_length = sizeof(resp.body) + sizeof(resp.key) - sizeDiff;
+    resp.key.deviceAddress = 0x20;
+    resp.key.fruID = fruId;
+    resp.key.accessLun = 0x80; // logical / physical fru device
+    resp.key.channelNumber = 0x0;
+    resp.body.reserved = 0x0;
+    resp.body.deviceType = 0x10;
+    resp.body.deviceTypeModifier = 0x0;
+    resp.body.entityID = 0;
+    resp.body.entityInstance = 0x1;
+    resp.body.oem = 0x0;
+    resp.body.deviceIDLen = name.size();
+    name.copy(resp.body.deviceID, name.size());
 }
 
 void recalculateHashes()
 {
 
     deviceHashes.clear();
+    boost::container::flat_map<
+        uint8_t, const boost::container::flat_map<std::string, Value>*>
+        deviceData;
     // hash the object paths to create unique device id's. increment on
     // collision
     std::hash<std::string> hasher;
@@ -210,6 +451,10 @@ void recalculateHashes()
         {
             auto resp = deviceHashes.emplace(fruHash, newDev);
             emplacePassed = resp.second;
+            if (emplacePassed)
+            {
+                deviceData.emplace(fruHash, &fruIface->second);
+            }
             if (!emplacePassed)
             {
                 fruHash++;
@@ -222,6 +467,16 @@ void recalculateHashes()
             }
         }
     }
+
+    fruSdrs.resize(deviceHashes.size());
+    size_t index = 0;
+    for (const auto& [fruId, data] : deviceData)
+    {
+        buildFruSdr(fruId, *data, fruSdrs[index++]);
+    }
+#ifdef USING_ENTITY_MANAGER_DECORATORS
+    invalidateFruSdrEntities();
+#endif
 }
 
 void replaceCacheFru(const std::shared_ptr<sdbusplus::asio::connection>& bus,
@@ -244,13 +499,18 @@ void replaceCacheFru(const std::shared_ptr<sdbusplus::asio::connection>& bus,
     recalculateHashes();
 }
 
-ipmi::Cc getFru(ipmi::Context::ptr ctx, uint8_t devId)
+/** @brief get the raw contents of a FRU device, reading them on first use
+ *  @param ctx - context of the current request
+ *  @param devId - FRU device ID
+ *  @param fru - set to the cache entry of the device
+ *
+ *  The entry can be dropped once the coroutine yields, so it must only be
+ *  used until then.
+ *
+ *  @returns IPMI completion code
+ */
+ipmi::Cc getFru(ipmi::Context::ptr ctx, uint8_t devId, FruCacheEntry*& fru)
 {
-    if (lastDevId == devId && devId != 0xFF)
-    {
-        return ipmi::ccSuccess;
-    }
-
     // Set devId to 1 if devId is 0.
     // 0 is reserved for baseboard and set to 1 in recalculateHashes().
     if (!devId)
@@ -261,41 +521,49 @@ ipmi::Cc getFru(ipmi::Context::ptr ctx, uint8_t devId)
     {
         return IPMI_CC_SENSOR_INVALID;
     }
+    uint8_t bus = deviceFind->second.first;
+    uint8_t addr = deviceFind->second.second;
 
-    fruCache.clear();
-
-    cacheBus = deviceFind->second.first;
-    cacheAddr = deviceFind->second.second;
+    auto cached = fruCache.find(devId);
+    if (cached != fruCache.end() && cached->second.bus == bus &&
+        cached->second.addr == addr)
+    {
+        fru = &cached->second;
+        return ipmi::ccSuccess;
+    }
 
     boost::system::error_code ec;
 
-    fruCache = ctx->bus->yield_method_call<std::vector<uint8_t>>(
-        ctx->yield, ec, fruDeviceServiceName, "/xyz/openbmc_project/FruDevice",
-        "xyz.openbmc_project.FruDeviceManager", "GetRawFru", cacheBus,
-        cacheAddr);
+    std::vector<uint8_t> data =
+        ctx->bus->yield_method_call<std::vector<uint8_t>>(
+            ctx->yield, ec, fruDeviceServiceName,
+            "/xyz/openbmc_project/FruDevice",
+            "xyz.openbmc_project.FruDeviceManager", "GetRawFru", bus, addr);
     if (ec)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "Couldn't get raw fru",
             phosphor::logging::entry("ERROR=%s", ec.message().c_str()));
 
-        cacheBus = 0xFF;
-        cacheAddr = 0xFF;
         return ipmi::ccResponseError;
     }
 
-    lastDevId = devId;
-    return ipmi::ccSuccess;
-}
-
-void writeFruIfRunning()
-{
-    if (!writeTimer->isRunning())
+    // a pending write of this device was cached while we were reading
+    cached = fruCache.find(devId);
+    if (cached != fruCache.end() && cached->second.bus == bus &&
+        cached->second.addr == addr)
     {
-        return;
+        fru = &cached->second;
+        return ipmi::ccSuccess;
+    }
+    if (cached != fruCache.end())
+    {
+        // the ID now names another device, write the old one back first
+        writeFru(cached->second);
     }
-    writeTimer->stop();
-    writeFru();
+
+    fru = &(fruCache[devId] = FruCacheEntry{bus, addr, std::move(data)});
+    return ipmi::ccSuccess;
 }
 
 void startMatch(void)
@@ -307,58 +575,77 @@ void startMatch(void)
 
     fruMatches.reserve(2);
 
-    auto bus = getSdBus();
-    fruMatches.emplace_back(*bus,
-                            "type='signal',arg0path='/xyz/openbmc_project/"
-                            "FruDevice/',member='InterfacesAdded'",
-                            [](sdbusplus::message::message& message) {
-                                sdbusplus::message::object_path path;
-                                ObjectType object;
-                                try
-                                {
-                                    message.read(path, object);
-                                }
-                                catch (sdbusplus::exception_t&)
-                                {
-                                    return;
-                                }
-                                auto findType = object.find(
-                                    "xyz.openbmc_project.FruDevice");
-                                if (findType == object.end())
-                                {
-                                    return;
-                                }
-                                writeFruIfRunning();
-                                frus[path] = object;
-                                recalculateHashes();
-                                lastDevId = 0xFF;
-                            });
-
-    fruMatches.emplace_back(*bus,
-                            "type='signal',arg0path='/xyz/openbmc_project/"
-                            "FruDevice/',member='InterfacesRemoved'",
-                            [](sdbusplus::message::message& message) {
-                                sdbusplus::message::object_path path;
-                                std::set<std::string> interfaces;
-                                try
-                                {
-                                    message.read(path, interfaces);
-                                }
-                                catch (sdbusplus::exception_t&)
-                                {
-                                    return;
-                                }
-                                auto findType = interfaces.find(
-                                    "xyz.openbmc_project.FruDevice");
-                                if (findType == interfaces.end())
-                                {
-                                    return;
-                                }
-                                writeFruIfRunning();
-                                frus.erase(path);
-                                recalculateHashes();
-                                lastDevId = 0xFF;
-                            });
+    fruMatches.emplace_back(dbus_signals::onInterfacesAdded(
+        "/xyz/openbmc_project/FruDevice",
+        [](const dbus_signals::InterfacesAdded& signal) {
+            if (!signal.complete)
+            {
+                return;
+            }
+            auto findType =
+                signal.interfaces.find("xyz.openbmc_project.FruDevice");
+            if (findType == signal.interfaces.end())
+            {
+                return;
+            }
+            ObjectType object;
+            for (const auto& [interface, properties] : signal.interfaces)
+            {
+                object[interface].insert(properties.begin(), properties.end());
+            }
+            writeAllFru();
+            invalidateFruCache(object);
+            frus[sdbusplus::message::object_path(signal.path)] = object;
+            recalculateHashes();
+        }));
+
+    fruMatches.emplace_back(dbus_signals::onInterfacesRemoved(
+        "/xyz/openbmc_project/FruDevice",
+        [](const dbus_signals::InterfacesRemoved& signal) {
+            if (!signal.complete ||
+                std::find(signal.interfaces.begin(), signal.interfaces.end(),
+                          "xyz.openbmc_project.FruDevice") ==
+                    signal.interfaces.end())
+            {
+                return;
+            }
+            writeAllFru();
+            auto fru = frus.find(sdbusplus::message::object_path(signal.path));
+            if (fru != frus.end())
+            {
+                invalidateFruCache(fru->second);
+                frus.erase(fru);
+            }
+            recalculateHashes();
+        }));
+
+#ifdef USING_ENTITY_MANAGER_DECORATORS
+    // the entities of the records come from the decorators of entity-manager
+    entityMatches.reserve(2);
+    entityMatches.emplace_back(dbus_signals::onInterfacesAdded(
+        "/xyz/openbmc_project/inventory",
+        [](const dbus_signals::InterfacesAdded& signal) {
+            if (!signal.complete ||
+                signal.interfaces.count(fruDeviceDecorator) ||
+                signal.interfaces.count(ipmiDecorator))
+            {
+                invalidateFruSdrEntities();
+            }
+        }));
+    entityMatches.emplace_back(dbus_signals::onInterfacesRemoved(
+        "/xyz/openbmc_project/inventory",
+        [](const dbus_signals::InterfacesRemoved& signal) {
+            const auto& interfaces = signal.interfaces;
+            if (!signal.complete ||
+                std::find(interfaces.begin(), interfaces.end(),
+                          fruDeviceDecorator) != interfaces.end() ||
+                std::find(interfaces.begin(), interfaces.end(),
+                          ipmiDecorator) != interfaces.end())
+            {
+                invalidateFruSdrEntities();
+            }
+        }));
+#endif
 
     // call once to populate
     boost::asio::spawn(*getIoContext(), [](boost::asio::yield_context yield) {
@@ -385,21 +672,23 @@ ipmi::RspType<uint8_t,             // Count
         return ipmi::responseInvalidFieldRequest();
     }
 
-    ipmi::Cc status = getFru(ctx, fruDeviceId);
+    FruCacheEntry* fru = nullptr;
+    ipmi::Cc status = getFru(ctx, fruDeviceId, fru);
 
     if (status != ipmi::ccSuccess)
     {
         return ipmi::response(status);
     }
+    const std::vector<uint8_t>& fruData = fru->data;
 
     size_t fromFruByteLen = 0;
-    if (countToRead + fruInventoryOffset < fruCache.size())
+    if (countToRead + fruInventoryOffset < fruData.size())
     {
         fromFruByteLen = countToRead;
     }
-    else if (fruCache.size() > fruInventoryOffset)
+    else if (fruData.size() > fruInventoryOffset)
     {
-        fromFruByteLen = fruCache.size() - fruInventoryOffset;
+        fromFruByteLen = fruData.size() - fruInventoryOffset;
     }
     else
     {
@@ -409,8 +698,8 @@ ipmi::RspType<uint8_t,             // Count
     std::vector<uint8_t> requestedData;
 
     requestedData.insert(
-        requestedData.begin(), fruCache.begin() + fruInventoryOffset,
-        fruCache.begin() + fruInventoryOffset + fromFruByteLen);
+        requestedData.begin(), fruData.begin() + fruInventoryOffset,
+        fruData.begin() + fruInventoryOffset + fromFruByteLen);
 
     return ipmi::responseSuccess(static_cast<uint8_t>(requestedData.size()),
                                  requestedData);
@@ -427,7 +716,7 @@ ipmi::RspType<uint8_t,             // Count
 ipmi::RspType<uint8_t>
     ipmiStorageWriteFruData(ipmi::Context::ptr ctx, uint8_t fruDeviceId,
                             uint16_t fruInventoryOffset,
-                            std::vector<uint8_t>& dataToWrite)
+                            ipmi::message::ByteSpan dataToWrite)
 {
     if (fruDeviceId == 0xFF)
     {
@@ -436,25 +725,34 @@ ipmi::RspType<uint8_t>
 
     size_t writeLen = dataToWrite.size();
 
-    ipmi::Cc status = getFru(ctx, fruDeviceId);
+    FruCacheEntry* fru = nullptr;
+    ipmi::Cc status = getFru(ctx, fruDeviceId, fru);
     if (status != ipmi::ccSuccess)
     {
         return ipmi::response(status);
     }
+    std::vector<uint8_t>& fruData = fru->data;
     size_t lastWriteAddr = fruInventoryOffset + writeLen;
-    if (fruCache.size() < lastWriteAddr)
+    if (fruData.size() < lastWriteAddr)
     {
-        fruCache.resize(fruInventoryOffset + writeLen);
+        fruData.resize(fruInventoryOffset + writeLen);
+        fru->dirty = true;
     }
 
-    std::copy(dataToWrite.begin(), dataToWrite.begin() + writeLen,
-              fruCache.begin() + fruInventoryOffset);
+    // only data that changes the contents needs writing back
+    if (!std::equal(dataToWrite.begin(), dataToWrite.begin() + writeLen,
+                    fruData.begin() + fruInventoryOffset))
+    {
+        std::copy(dataToWrite.begin(), dataToWrite.begin() + writeLen,
+                  fruData.begin() + fruInventoryOffset);
+        fru->dirty = true;
+    }
 
     bool atEnd = false;
 
-    if (fruCache.size() >= sizeof(FRUHeader))
+    if (fruData.size() >= sizeof(FRUHeader))
     {
-        FRUHeader* header = reinterpret_cast<FRUHeader*>(fruCache.data());
+        FRUHeader* header = reinterpret_cast<FRUHeader*>(fruData.data());
 
         size_t areaLength = 0;
         size_t lastRecordStart = std::max(
@@ -471,9 +769,9 @@ ipmi::RspType<uint8_t>
             {
                 // The MSB in the second byte of the MultiRecord header signals
                 // "End of list"
-                endOfList = fruCache[lastRecordStart + 1] & 0x80;
+                endOfList = fruData[lastRecordStart + 1] & 0x80;
                 // Third byte in the MultiRecord header is the length
-                areaLength = fruCache[lastRecordStart + 2];
+                areaLength = fruData[lastRecordStart + 2];
                 // This length is in bytes (not 8 bytes like other headers)
                 areaLength += 5; // The length omits the 5 byte header
                 if (!endOfList)
@@ -490,7 +788,7 @@ ipmi::RspType<uint8_t>
             if (lastWriteAddr > (lastRecordStart + 1))
             {
                 // second byte in record area is the length
-                areaLength = fruCache[lastRecordStart + 1];
+                areaLength = fruData[lastRecordStart + 1];
                 areaLength *= 8; // it is in multiples of 8 bytes
             }
         }
@@ -501,24 +799,42 @@ ipmi::RspType<uint8_t>
     }
     uint8_t countWritten = 0;
 
-    writeBus = cacheBus;
-    writeAddr = cacheAddr;
     if (atEnd)
     {
-        // cancel timer, we're at the end so might as well send it
-        writeTimer->stop();
-        if (!writeFru())
+        // we're at the end so might as well send it, writes of other devices
+        // go on while this one yields
+        countWritten = std::min(fruData.size(), static_cast<size_t>(0xFF));
+        if (!writeFru(ctx, *fru))
         {
             return ipmi::responseInvalidFieldRequest();
         }
-        countWritten = std::min(fruCache.size(), static_cast<size_t>(0xFF));
     }
     else
     {
         // start a timer, if no further data is sent  to check to see if it is
         // valid
-        writeTimer->start(std::chrono::duration_cast<std::chrono::microseconds>(
-            std::chrono::seconds(writeTimeoutSeconds)));
+        if (!fru->writeTimer)
+        {
+            fru->writeTimer =
+                std::make_unique<boost::asio::steady_timer>(*getIoContext());
+        }
+        uint8_t bus = fru->bus;
+        uint8_t addr = fru->addr;
+        fru->writeTimer->expires_after(
+            std::chrono::seconds(writeTimeoutSeconds));
+        fru->writeTimer->async_wait(
+            [bus, addr](const boost::system::error_code& ec) {
+                // cancelled by further data or a write of the device
+                if (ec)
+                {
+                    return;
+                }
+                FruCacheEntry* fru = findCachedFru(bus, addr);
+                if (fru != nullptr)
+                {
+                    writeFru(*fru);
+                }
+            });
         countWritten = 0;
     }
 
@@ -541,7 +857,8 @@ ipmi::RspType<uint16_t, // inventorySize
         return ipmi::responseInvalidFieldRequest();
     }
 
-    ipmi::Cc ret = getFru(ctx, fruDeviceId);
+    FruCacheEntry* fru = nullptr;
+    ipmi::Cc ret = getFru(ctx, fruDeviceId, fru);
     if (ret != ipmi::ccSuccess)
     {
         return ipmi::response(ret);
@@ -550,65 +867,22 @@ ipmi::RspType<uint16_t, // inventorySize
     constexpr uint8_t accessType =
         static_cast<uint8_t>(GetFRUAreaAccessType::byte);
 
-    return ipmi::responseSuccess(fruCache.size(), accessType);
+    return ipmi::responseSuccess(fru->data.size(), accessType);
 }
 
 ipmi_ret_t getFruSdrCount(ipmi::Context::ptr ctx, size_t& count)
 {
-    count = deviceHashes.size();
+    count = fruSdrs.size();
     return IPMI_CC_OK;
 }
 
-ipmi_ret_t getFruSdrs(ipmi::Context::ptr ctx, size_t index,
-                      get_sdr::SensorDataFruRecord& resp)
-{
-    if (deviceHashes.size() < index)
-    {
-        return IPMI_CC_INVALID_FIELD_REQUEST;
-    }
-    auto device = deviceHashes.begin() + index;
-    uint8_t& bus = device->second.first;
-    uint8_t& address = device->second.second;
-
-    boost::container::flat_map<std::string, Value>* fruData = nullptr;
-    auto fru =
-        std::find_if(frus.begin(), frus.end(),
-                     [bus, address, &fruData](ManagedEntry& entry) {
-                         auto findFruDevice =
-                             entry.second.find("xyz.openbmc_project.FruDevice");
-                         if (findFruDevice == entry.second.end())
-                         {
-                             return false;
-                         }
-                         fruData = &(findFruDevice->second);
-                         auto findBus = findFruDevice->second.find("BUS");
-                         auto findAddress =
-                             findFruDevice->second.find("ADDRESS");
-                         if (findBus == findFruDevice->second.end() ||
-                             findAddress == findFruDevice->second.end())
-                         {
-                             return false;
-                         }
-                         if (std::get<uint32_t>(findBus->second) != bus)
-                         {
-                             return false;
-                         }
-                         if (std::get<uint32_t>(findAddress->second) != address)
-                         {
-                             return false;
-                         }
-                         return true;
-                     });
-    if (fru == frus.end())
-    {
-        return IPMI_CC_RESPONSE_ERROR;
-    }
-
 #ifdef USING_ENTITY_MANAGER_DECORATORS
-
-    boost::container::flat_map<std::string, Value>* entityData = nullptr;
-
-    // todo: this should really use caching, this is a very inefficient lookup
+/** @brief fill the entities of the entity-manager decorators in fruSdrs
+ *  @param ctx - context of the current request
+ */
+ipmi::Cc updateFruSdrEntities(ipmi::Context::ptr ctx)
+{
+    uint64_t generation = fruSdrEntitiesGeneration;
     boost::system::error_code ec;
     ManagedObjectType entities = ctx->bus->yield_method_call<ManagedObjectType>(
         ctx->yield, ec, entityManagerServiceName, "/",
@@ -617,124 +891,109 @@ ipmi_ret_t getFruSdrs(ipmi::Context::ptr ctx, size_t index,
     if (ec)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "GetMangagedObjects for ipmiStorageGetFruInvAreaInfo failed",
+            "GetMangagedObjects for getFruSdrs failed",
             phosphor::logging::entry("ERROR=%s", ec.message().c_str()));
 
         return ipmi::ccResponseError;
     }
 
-    auto entity = std::find_if(
-        entities.begin(), entities.end(),
-        [bus, address, &entityData](ManagedEntry& entry) {
-            auto findFruDevice = entry.second.find(
-                "xyz.openbmc_project.Inventory.Decorator.FruDevice");
-            if (findFruDevice == entry.second.end())
-            {
-                return false;
-            }
+    // the records may have been rebuilt while yielding, fill the current ones
+    size_t index = 0;
+    for (const auto& [fruId, device] : deviceHashes)
+    {
+        uint8_t bus = device.first;
+        uint8_t address = device.second;
+        boost::container::flat_map<std::string, Value>* entityData = nullptr;
+
+        auto entity = std::find_if(
+            entities.begin(), entities.end(),
+            [bus, address, &entityData](ManagedEntry& entry) {
+                auto findFruDevice = entry.second.find(fruDeviceDecorator);
+                if (findFruDevice == entry.second.end())
+                {
+                    return false;
+                }
+
+                // Integer fields added via Entity-Manager json are uint64_ts by
+                // default.
+                auto findBus = findFruDevice->second.find("Bus");
+                auto findAddress = findFruDevice->second.find("Address");
 
-            // Integer fields added via Entity-Manager json are uint64_ts by
-            // default.
-            auto findBus = findFruDevice->second.find("Bus");
-            auto findAddress = findFruDevice->second.find("Address");
+                if (findBus == findFruDevice->second.end() ||
+                    findAddress == findFruDevice->second.end())
+                {
+                    return false;
+                }
+                if ((std::get<uint64_t>(findBus->second) != bus) ||
+                    (std::get<uint64_t>(findAddress->second) != address))
+                {
+                    return false;
+                }
 
-            if (findBus == findFruDevice->second.end() ||
-                findAddress == findFruDevice->second.end())
+                // At this point we found the device entry and should return
+                // true.
+                auto findIpmiDevice = entry.second.find(ipmiDecorator);
+                if (findIpmiDevice != entry.second.end())
+                {
+                    entityData = &(findIpmiDevice->second);
+                }
+
+                return true;
+            });
+
+        if (entity == entities.end())
+        {
+            if constexpr (DEBUG)
             {
-                return false;
+                std::fprintf(stderr, "Ipmi or FruDevice Decorator interface "
+                                     "not found for Fru\n");
             }
-            if ((std::get<uint64_t>(findBus->second) != bus) ||
-                (std::get<uint64_t>(findAddress->second) != address))
+        }
+
+        get_sdr::SensorDataFruRecord& resp = fruSdrs[index++];
+        resp.body.entityID = 0;
+        resp.body.entityInstance = 0x1;
+        if (entityData)
+        {
+            auto entityIdProperty = entityData->find("EntityId");
+            auto entityInstanceProperty = entityData->find("EntityInstance");
+
+            if (entityIdProperty != entityData->end())
             {
-                return false;
+                resp.body.entityID = static_cast<uint8_t>(
+                    std::get<uint64_t>(entityIdProperty->second));
             }
-
-            // At this point we found the device entry and should return
-            // true.
-            auto findIpmiDevice = entry.second.find(
-                "xyz.openbmc_project.Inventory.Decorator.Ipmi");
-            if (findIpmiDevice != entry.second.end())
+            if (entityInstanceProperty != entityData->end())
             {
-                entityData = &(findIpmiDevice->second);
+                resp.body.entityInstance = static_cast<uint8_t>(
+                    std::get<uint64_t>(entityInstanceProperty->second));
             }
-
-            return true;
-        });
-
-    if (entity == entities.end())
-    {
-        if constexpr (DEBUG)
-        {
-            std::fprintf(stderr, "Ipmi or FruDevice Decorator interface "
-                                 "not found for Fru\n");
         }
     }
-
+    // a change while yielding leaves the entities to be read again
+    fruSdrEntitiesValid = generation == fruSdrEntitiesGeneration;
+    return ipmi::ccSuccess;
+}
 #endif
 
-    std::string name;
-    auto findProductName = fruData->find("BOARD_PRODUCT_NAME");
-    auto findBoardName = fruData->find("PRODUCT_PRODUCT_NAME");
-    if (findProductName != fruData->end())
-    {
-        name = std::get<std::string>(findProductName->second);
-    }
-    else if (findBoardName != fruData->end())
-    {
-        name = std::get<std::string>(findBoardName->second);
-    }
-    else
-    {
-        name = "UNKNOWN";
-    }
-    if (name.size() > maxFruSdrNameSize)
-    {
-        name = name.substr(0, maxFruSdrNameSize);
-    }
-    size_t sizeDiff = maxFruSdrNameSize - name.size();
-
-    resp.header.record_id_lsb = 0x0; // calling code is to implement these
-    resp.header.record_id_msb = 0x0;
-    resp.header.sdr_version = ipmiSdrVersion;
-    resp.header.record_type = get_sdr::SENSOR_DATA_FRU_RECORD;
-    resp.header.record_length = sizeof(resp.body) + sizeof(resp.key) - sizeDiff;
-    resp.key.deviceAddress = 0x20;
-    resp.key.fruID = device->first;
-    resp.key.accessLun = 0x80; // logical / physical fru device
-    resp.key.channelNumber = 0x0;
-    resp.body.reserved = 0x0;
-    resp.body.deviceType = 0x10;
-    resp.body.deviceTypeModifier = 0x0;
-
-    uint8_t entityID = 0;
-    uint8_t entityInstance = 0x1;
-
+ipmi_ret_t getFruSdrs(ipmi::Context::ptr ctx, size_t index,
+                      get_sdr::SensorDataFruRecord& resp)
+{
 #ifdef USING_ENTITY_MANAGER_DECORATORS
-    if (entityData)
+    if (!fruSdrEntitiesValid)
     {
-        auto entityIdProperty = entityData->find("EntityId");
-        auto entityInstanceProperty = entityData->find("EntityInstance");
-
-        if (entityIdProperty != entityData->end())
+        ipmi::Cc cc = updateFruSdrEntities(ctx);
+        if (cc != ipmi::ccSuccess)
         {
-            entityID = static_cast<uint8_t>(
-                std::get<uint64_t>(entityIdProperty->second));
-        }
-        if (entityInstanceProperty != entityData->end())
-        {
-            entityInstance = static_cast<uint8_t>(
-                std::get<uint64_t>(entityInstanceProperty->second));
+            return cc;
         }
     }
 #endif
-
-    resp.body.entityID = entityID;
-    resp.body.entityInstance = entityInstance;
-
-    resp.body.oem = 0x0;
-    resp.body.deviceIDLen = name.size();
-    name.copy(resp.body.deviceID, name.size());
-
+    if (index >= fruSdrs.size())
+    {
+        return IPMI_CC_INVALID_FIELD_REQUEST;
+    }
+    resp = fruSdrs[index];
     return IPMI_CC_OK;
 }
 
@@ -762,99 +1021,150 @@ static bool getSELLogFiles(std::vector<std::filesystem::path>& selLogFiles)
     return !selLogFiles.empty();
 }
 
-static int countSELEntries()
+/** @brief decode an ipmi_sel line into a SEL record
+ *
+ *  The format of the ipmi_sel message is "<Timestamp>
+ *  <ID>,<Type>,<EventData>,[<Generator ID>,<Path>,<Direction>]". Only
+ *  system event records are decoded.
+ *
+ *  @param[in] line - the log line
+ *  @param[out] record - the SEL record
+ *
+ *  @return true if the line holds a system event record
+ */
+static bool decodeSELLine(std::string_view line,
+                          ipmi::sel::LogIndex::Record& record)
 {
-    // Get the list of ipmi_sel log files
-    std::vector<std::filesystem::path> selLogFiles;
-    if (!getSELLogFiles(selLogFiles))
+    size_t space = line.find_first_of(' ');
+    if (space == std::string_view::npos)
     {
-        return 0;
+        return false;
     }
-    int numSELEntries = 0;
-    // Loop through each log file and count the number of logs
-    for (const std::filesystem::path& file : selLogFiles)
+    std::string_view entryTimestamp = line.substr(0, space);
+    size_t entryStart = line.find_first_not_of(' ', space);
+    if (entryStart == std::string_view::npos)
     {
-        std::ifstream logStream(file);
-        if (!logStream.is_open())
-        {
-            continue;
-        }
+        return false;
+    }
+    line.remove_prefix(entryStart);
 
-        std::string line;
-        while (std::getline(logStream, line))
+    // split the fields, merging adjacent separators
+    std::array<std::string_view, 6> fields;
+    size_t fieldCount = 0;
+    while (!line.empty() && fieldCount < fields.size())
+    {
+        size_t comma = line.find_first_of(',');
+        std::string_view field = line.substr(0, comma);
+        if (!field.empty())
         {
-            numSELEntries++;
+            fields[fieldCount++] = field;
         }
+        line.remove_prefix(comma == std::string_view::npos ? line.size()
+                                                           : comma + 1);
+    }
+    if (fieldCount < 3)
+    {
+        return false;
     }
-    return numSELEntries;
-}
 
-static bool findSELEntry(const int recordID,
-                         const std::vector<std::filesystem::path>& selLogFiles,
-                         std::string& entry)
-{
-    // Record ID is the first entry field following the timestamp. It is
-    // preceded by a space and followed by a comma
-    std::string search = " " + std::to_string(recordID) + ",";
+    auto parse = [](std::string_view field, auto& value, int base) {
+        auto [ptr, ec] = std::from_chars(field.data(),
+                                         field.data() + field.size(), value,
+                                         base);
+        return ec == std::errc() && ptr == field.data() + field.size();
+    };
 
-    // Loop through the ipmi_sel log entries
-    for (const std::filesystem::path& file : selLogFiles)
+    uint16_t recordID;
+    uint8_t recordType;
+    if (!parse(fields[0], recordID, 10) || !parse(fields[1], recordType, 16) ||
+        recordType != dynamic_sensors::ipmi::sel::systemEvent)
     {
-        std::ifstream logStream(file);
-        if (!logStream.is_open())
-        {
-            continue;
-        }
+        return false;
+    }
 
-        while (std::getline(logStream, entry))
+    // Only keep the eventData bytes that fit in the record
+    std::array<uint8_t, dynamic_sensors::ipmi::sel::systemEventSize>
+        eventData{};
+    std::string_view eventDataStr = fields[2];
+    for (size_t i = 0; i < eventData.size() && eventDataStr.size() >= 2; i++)
+    {
+        if (!parse(eventDataStr.substr(0, 2), eventData[i], 16))
         {
-            // Check if the record ID matches
-            if (entry.find(search) != std::string::npos)
-            {
-                return true;
-            }
+            return false;
         }
+        eventDataStr.remove_prefix(2);
     }
-    return false;
-}
 
-static uint16_t
-    getNextRecordID(const uint16_t recordID,
-                    const std::vector<std::filesystem::path>& selLogFiles)
-{
-    uint16_t nextRecordID = recordID + 1;
-    std::string entry;
-    if (findSELEntry(nextRecordID, selLogFiles, entry))
-    {
-        return nextRecordID;
-    }
-    else
+    std::tm timeStruct = {};
+    std::istringstream entryStream{std::string(entryTimestamp)};
+    uint32_t timestamp = ipmi::sel::invalidTimeStamp;
+    if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
     {
-        return ipmi::sel::lastEntry;
+        timestamp = std::mktime(&timeStruct);
     }
-}
 
-static int fromHexStr(const std::string& hexStr, std::vector<uint8_t>& data)
-{
-    for (unsigned int i = 0; i < hexStr.size(); i += 2)
+    uint16_t generatorID = 0;
+    uint8_t sensorType = 0;
+    uint8_t sensorNum = 0xFF;
+    uint8_t eventType = 0;
+    // System type events should have six fields
+    if (fieldCount >= 6)
     {
-        try
+        if (!parse(fields[3], generatorID, 16))
         {
-            data.push_back(static_cast<uint8_t>(
-                std::stoul(hexStr.substr(i, 2), nullptr, 16)));
+            std::cerr << "Invalid Generator ID\n";
         }
-        catch (std::invalid_argument& e)
+
+        // Get the sensor type, sensor number, and event type for the sensor
+        std::string sensorPath(fields[4]);
+        uint16_t sensorAndLun = getSensorNumberFromPath(sensorPath);
+        const details::SensorIndexEntry& indexed =
+            details::getSensorIndexEntry(sensorAndLun);
+        SensorPathCodes codes = indexed.path
+                                    ? indexed.codes
+                                    : getSensorCodesFromPath(sensorPath);
+        sensorType = codes.sensorType;
+        sensorNum = static_cast<uint8_t>(sensorAndLun);
+        generatorID |= sensorAndLun >> 8;
+        eventType = codes.eventReadingType & 0x7F;
+
+        // Get the event direction, deassertions have bit 7 set
+        unsigned int asserted;
+        if (parse(fields[5], asserted, 10))
         {
-            phosphor::logging::log<phosphor::logging::level::ERR>(e.what());
-            return -1;
+            eventType |= asserted ? 0x00 : 0x80;
         }
-        catch (std::out_of_range& e)
+        else
         {
-            phosphor::logging::log<phosphor::logging::level::ERR>(e.what());
-            return -1;
+            std::cerr << "Invalid Event Direction\n";
         }
     }
-    return 0;
+
+    record = {static_cast<uint8_t>(recordID),
+              static_cast<uint8_t>(recordID >> 8),
+              recordType,
+              static_cast<uint8_t>(timestamp),
+              static_cast<uint8_t>(timestamp >> 8),
+              static_cast<uint8_t>(timestamp >> 16),
+              static_cast<uint8_t>(timestamp >> 24),
+              static_cast<uint8_t>(generatorID),
+              static_cast<uint8_t>(generatorID >> 8),
+              dynamic_sensors::ipmi::sel::eventMsgRev,
+              sensorType,
+              sensorNum,
+              eventType,
+              eventData[0],
+              eventData[1],
+              eventData[2]};
+    return true;
+}
+
+static ipmi::sel::LogIndex& getSELLogIndex()
+{
+    static ipmi::sel::LogIndex selLogIndex(
+        dynamic_sensors::ipmi::sel::selLogDir,
+        dynamic_sensors::ipmi::sel::selLogFilename, decodeSELLine);
+    return selLogIndex;
 }
 
 ipmi::RspType<uint8_t,  // SEL version
@@ -866,10 +1176,8 @@ ipmi::RspType<uint8_t,  // SEL version
     ipmiStorageGetSELInfo()
 {
     constexpr uint8_t selVersion = ipmi::sel::selVersion;
-    uint16_t entries = countSELEntries();
-    uint32_t addTimeStamp = dynamic_sensors::ipmi::sel::getFileTimestamp(
-        dynamic_sensors::ipmi::sel::selLogDir /
-        dynamic_sensors::ipmi::sel::selLogFilename);
+    uint16_t entries = getSELLogIndex().count();
+    uint32_t addTimeStamp = getSELLogIndex().lastAddTime();
     uint32_t eraseTimeStamp = dynamic_sensors::ipmi::sel::erase_time::get();
     constexpr uint8_t operationSupport =
         dynamic_sensors::ipmi::sel::selOperationSupport;
@@ -880,28 +1188,28 @@ ipmi::RspType<uint8_t,  // SEL version
                                  eraseTimeStamp, operationSupport);
 }
 
-using systemEventType = std::tuple<
-    uint32_t, // Timestamp
-    uint16_t, // Generator ID
-    uint8_t,  // EvM Rev
-    uint8_t,  // Sensor Type
-    uint8_t,  // Sensor Number
-    uint7_t,  // Event Type
-    bool,     // Event Direction
-    std::array<uint8_t, dynamic_sensors::ipmi::sel::systemEventSize>>; // Event
-                                                                       // Data
-using oemTsEventType = std::tuple<
-    uint32_t, // Timestamp
-    std::array<uint8_t, dynamic_sensors::ipmi::sel::oemTsEventSize>>; // Event
-                                                                      // Data
-using oemEventType =
-    std::array<uint8_t, dynamic_sensors::ipmi::sel::oemEventSize>; // Event Data
-
-ipmi::RspType<uint16_t, // Next Record ID
-              uint16_t, // Record ID
-              uint8_t,  // Record Type
-              std::variant<systemEventType, oemTsEventType,
-                           oemEventType>> // Record Content
+/** @brief get the SEL log index, with records decoded against the current
+ *         sensors
+ *
+ *  The decoded records hold sensor numbers, they are decoded again when the
+ *  sensors changed.
+ */
+static ipmi::sel::LogIndex& getDecodedSELLogIndex()
+{
+    ipmi::sel::LogIndex& selLogIndex = getSELLogIndex();
+    static uint16_t decodedSensorTree = 0;
+    std::shared_ptr<const SensorSubTree> subtree;
+    uint16_t sensorTree = details::getSensorSubtree(subtree);
+    if (sensorTree != decodedSensorTree)
+    {
+        selLogIndex.reset();
+        decodedSensorTree = sensorTree;
+    }
+    return selLogIndex;
+}
+
+ipmi::RspType<uint16_t,                         // Next Record ID
+              ipmi::sel::LogIndex::Record> // Record
     ipmiStorageGetSELEntry(uint16_t reservationID, uint16_t targetID,
                            uint8_t offset, uint8_t size)
 {
@@ -922,169 +1230,100 @@ ipmi::RspType<uint16_t, // Next Record ID
         }
     }
 
-    // Get the ipmi_sel log files
-    std::vector<std::filesystem::path> selLogFiles;
-    if (!getSELLogFiles(selLogFiles))
+    // The index decoded the line when it indexed it, the first entry is at
+    // the top of the oldest log file and the last entry at the bottom of
+    // the newest one
+    ipmi::sel::LogIndex& selLogIndex = getDecodedSELLogIndex();
+
+    std::optional<ipmi::sel::LogIndex::Record> record;
+    if (!selLogIndex.readRecord(targetID, record))
     {
         return ipmi::responseSensorInvalid();
     }
-
-    std::string targetEntry;
-
-    if (targetID == ipmi::sel::firstEntry)
+    if (!record)
     {
-        // The first entry will be at the top of the oldest log file
-        std::ifstream logStream(selLogFiles.back());
-        if (!logStream.is_open())
-        {
-            return ipmi::responseUnspecifiedError();
-        }
-
-        if (!std::getline(logStream, targetEntry))
-        {
-            return ipmi::responseUnspecifiedError();
-        }
+        return ipmi::responseUnspecifiedError();
     }
-    else if (targetID == ipmi::sel::lastEntry)
-    {
-        // The last entry will be at the bottom of the newest log file
-        std::ifstream logStream(selLogFiles.front());
-        if (!logStream.is_open())
-        {
-            return ipmi::responseUnspecifiedError();
-        }
+    uint16_t recordID = (*record)[0] | ((*record)[1] << 8);
 
-        std::string line;
-        while (std::getline(logStream, line))
-        {
-            targetEntry = line;
-        }
-    }
-    else
-    {
-        if (!findSELEntry(targetID, selLogFiles, targetEntry))
-        {
-            return ipmi::responseSensorInvalid();
-        }
-    }
+    return ipmi::responseSuccess(selLogIndex.nextRecordID(recordID), *record);
+}
 
-    // The format of the ipmi_sel message is "<Timestamp>
-    // <ID>,<Type>,<EventData>,[<Generator ID>,<Path>,<Direction>]".
-    // First get the Timestamp
-    size_t space = targetEntry.find_first_of(" ");
-    if (space == std::string::npos)
+/** @brief implements the OpenBMC OEM Read SEL Chunk command
+ *  @param ctx - context of the request
+ *  @param reservationID - SEL reservation ID, 0 if none is held
+ *  @param startID - record ID to start from, 0000h for the oldest record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - nextRecordID - record ID to continue from, FFFFh when done
+ *   - count - number of records that follow
+ *   - records - packed 16-byte SEL records
+ */
+ipmi::RspType<uint16_t,               // Next Record ID
+              uint8_t,                // Record count
+              ipmi::message::Payload> // Records
+    ipmiStorageReadSELChunk(ipmi::Context::ptr ctx, uint16_t reservationID,
+                            uint16_t startID)
+{
+    // NetFn/LUN, Cmd, CC, IANA, next record ID and count bytes
+    constexpr size_t responseOverhead = 9;
+
+    if (reservationID != 0 && !checkSELReservation(reservationID))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::responseInvalidReservationId();
     }
-    std::string entryTimestamp = targetEntry.substr(0, space);
-    // Then get the log contents
-    size_t entryStart = targetEntry.find_first_not_of(" ", space);
-    if (entryStart == std::string::npos)
+
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxRecords = 0;
+    if (maxTransfer > responseOverhead)
     {
-        return ipmi::responseUnspecifiedError();
+        maxRecords = (maxTransfer - responseOverhead) /
+                     std::tuple_size_v<ipmi::sel::LogIndex::Record>;
     }
-    std::string_view entry(targetEntry);
-    entry.remove_prefix(entryStart);
-    // Use split to separate the entry into its fields
-    std::vector<std::string> targetEntryFields;
-    boost::split(targetEntryFields, entry, boost::is_any_of(","),
-                 boost::token_compress_on);
-    if (targetEntryFields.size() < 3)
+    maxRecords = std::min<size_t>(maxRecords, 0xFF);
+    if (maxRecords == 0)
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::responseRetBytesUnavailable();
     }
-    std::string& recordIDStr = targetEntryFields[0];
-    std::string& recordTypeStr = targetEntryFields[1];
-    std::string& eventDataStr = targetEntryFields[2];
 
-    uint16_t recordID;
-    uint8_t recordType;
-    try
-    {
-        recordID = std::stoul(recordIDStr);
-        recordType = std::stoul(recordTypeStr, nullptr, 16);
-    }
-    catch (const std::invalid_argument&)
+    ipmi::sel::LogIndex& selLogIndex = getDecodedSELLogIndex();
+    std::optional<ipmi::sel::LogIndex::Record> record;
+    if (!selLogIndex.readRecord(startID, record))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::responseSensorInvalid();
     }
-    uint16_t nextRecordID = getNextRecordID(recordID, selLogFiles);
-    std::vector<uint8_t> eventDataBytes;
-    if (fromHexStr(eventDataStr, eventDataBytes) < 0)
+    if (!record)
     {
         return ipmi::responseUnspecifiedError();
     }
 
-    if (recordType == dynamic_sensors::ipmi::sel::systemEvent)
+    ipmi::message::Payload records;
+    uint8_t count = 0;
+    uint16_t nextRecordID;
+    while (true)
     {
-        // Get the timestamp
-        std::tm timeStruct = {};
-        std::istringstream entryStream(entryTimestamp);
+        records.pack(*record);
+        count++;
 
-        uint32_t timestamp = ipmi::sel::invalidTimeStamp;
-        if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
+        nextRecordID = selLogIndex.nextRecordID((*record)[0] |
+                                                ((*record)[1] << 8));
+        if (nextRecordID == ipmi::sel::lastEntry || count == maxRecords)
         {
-            timestamp = std::mktime(&timeStruct);
+            break;
         }
-
-        // Set the event message revision
-        uint8_t evmRev = dynamic_sensors::ipmi::sel::eventMsgRev;
-
-        uint16_t generatorID = 0;
-        uint8_t sensorType = 0;
-        uint16_t sensorAndLun = 0;
-        uint8_t sensorNum = 0xFF;
-        uint7_t eventType = 0;
-        bool eventDir = 0;
-        // System type events should have six fields
-        if (targetEntryFields.size() >= 6)
+        if (!selLogIndex.readRecord(nextRecordID, record))
         {
-            std::string& generatorIDStr = targetEntryFields[3];
-            std::string& sensorPath = targetEntryFields[4];
-            std::string& eventDirStr = targetEntryFields[5];
-
-            // Get the generator ID
-            try
-            {
-                generatorID = std::stoul(generatorIDStr, nullptr, 16);
-            }
-            catch (const std::invalid_argument&)
-            {
-                std::cerr << "Invalid Generator ID\n";
-            }
-
-            // Get the sensor type, sensor number, and event type for the sensor
-            sensorType = getSensorTypeFromPath(sensorPath);
-            sensorAndLun = getSensorNumberFromPath(sensorPath);
-            sensorNum = static_cast<uint8_t>(sensorAndLun);
-            generatorID |= sensorAndLun >> 8;
-            eventType = getSensorEventTypeFromPath(sensorPath);
-
-            // Get the event direction
-            try
-            {
-                eventDir = std::stoul(eventDirStr) ? 0 : 1;
-            }
-            catch (const std::invalid_argument&)
-            {
-                std::cerr << "Invalid Event Direction\n";
-            }
+            nextRecordID = ipmi::sel::lastEntry;
+            break;
+        }
+        if (!record)
+        {
+            // resume at the bad record, Get SEL Entry reports its error
+            break;
         }
-
-        // Only keep the eventData bytes that fit in the record
-        std::array<uint8_t, dynamic_sensors::ipmi::sel::systemEventSize>
-            eventData{};
-        std::copy_n(eventDataBytes.begin(),
-                    std::min(eventDataBytes.size(), eventData.size()),
-                    eventData.begin());
-
-        return ipmi::responseSuccess(
-            nextRecordID, recordID, recordType,
-            systemEventType{timestamp, generatorID, evmRev, sensorType,
-                            sensorNum, eventType, eventDir, eventData});
     }
 
-    return ipmi::responseUnspecifiedError();
+    return ipmi::responseSuccess(nextRecordID, count, records);
 }
 
 ipmi::RspType<uint16_t> ipmiStorageAddSELEntry(
@@ -1147,6 +1386,7 @@ ipmi::RspType<uint8_t> ipmiStorageClearSEL(ipmi::Context::ptr ctx,
             std::filesystem::remove(file, ec);
         }
     }
+    getSELLogIndex().reset();
 
     // Reload rsyslog so it knows to start new log files
     std::shared_ptr<sdbusplus::asio::connection> dbus = getSdBus();
@@ -1242,7 +1482,6 @@ std::vector<uint8_t> getType12SDRs(uint16_t index, uint16_t recordId)
 
 void registerStorageFunctions()
 {
-    createTimers();
     startMatch();
 
     // <Get FRU Inventory Area Info>
@@ -1269,6 +1508,11 @@ void registerStorageFunctions()
                           ipmi::storage::cmdGetSelEntry, ipmi::Privilege::User,
                           ipmiStorageGetSELEntry);
 
+    // <Read SEL Chunk>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::readSelChunkCmd, ipmi::Privilege::User,
+                             ipmiStorageReadSELChunk);
+
     // <Add SEL Entry>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnStorage,
                           ipmi::storage::cmdAddSelEntry,
@@ -4,11 +4,22 @@
 
 #include "user_channel/channel_layer.hpp"
 
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <boost/asio/steady_timer.hpp>
 #include <cmath>
+#include <ctime>
+#include <filesystem>
 #include <fstream>
 #include <ipmid/api.hpp>
+#include <ipmid/mapper.hpp>
+#include <ipmid/oemopenbmc.hpp>
 #include <ipmid/utils.hpp>
+#include <limits>
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
@@ -53,6 +64,15 @@ constexpr auto SENSOR_VALUE_INTF = "xyz.openbmc_project.Sensor.Value";
 constexpr auto SENSOR_VALUE_PROP = "Value";
 constexpr auto SENSOR_SCALE_PROP = "Scale";
 
+// Power Reading State bit 6, the power measurement is active
+constexpr auto POWER_MEASUREMENT_ACTIVE = 0x40;
+// Rolling average time period of the enhanced system power statistics,
+// bits 7:6 are the duration units and bits 5:0 the duration
+constexpr auto POWER_PERIOD_UNITS_SHIFT = 6;
+constexpr auto POWER_PERIOD_DURATION_MASK = 0x3F;
+
+static std::unique_ptr<dcmi::PowerStatistics> powerStatistics;
+
 using namespace phosphor::logging;
 
 namespace dcmi
@@ -65,136 +85,298 @@ static const std::map<uint8_t, std::string> entityIdToName{
 
 bool isDCMIPowerMgmtSupported()
 {
-    auto data = parseJSONConfig(gDCMICapabilitiesConfig);
+    const Json& data = getConfig().capabilities();
 
     return (gDCMIPowerMgmtSupported == data.value(gDCMIPowerMgmtCapability, 0));
 }
 
-uint32_t getPcap(sdbusplus::bus::bus& bus)
+void PowerCap::Latency::add(std::chrono::steady_clock::duration latency)
 {
-    auto settingService = ipmi::getService(bus, PCAP_INTERFACE, PCAP_PATH);
-
-    auto method = bus.new_method_call(settingService.c_str(), PCAP_PATH,
-                                      "org.freedesktop.DBus.Properties", "Get");
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency)
+                  .count();
+    count++;
+    totalUs += us;
+    maxUs = std::max<uint32_t>(maxUs, us);
+}
 
-    method.append(PCAP_INTERFACE, POWER_CAP_PROP);
-    auto reply = bus.call(method);
+PowerCap::PowerCap(sdbusplus::bus::bus& bus) : bus(bus)
+{
+    propertiesMatch = std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusplus::bus::match::rules::propertiesChanged(PCAP_PATH,
+                                                        PCAP_INTERFACE),
+        [this](sdbusplus::message::message& msg) {
+            std::string interface;
+            ipmi::PropertyMap properties;
+            try
+            {
+                msg.read(interface, properties);
+            }
+            catch (const std::exception& e)
+            {
+                return;
+            }
+            update(properties);
+        });
+}
 
-    if (reply.is_method_error())
+void PowerCap::update(const ipmi::PropertyMap& properties)
+{
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& [property, value] : properties)
     {
-        log<level::ERR>("Error in getPcap prop");
-        elog<InternalFailure>();
+        if (property == POWER_CAP_PROP)
+        {
+            if (auto v = std::get_if<uint32_t>(&value))
+            {
+                powerCap = *v;
+            }
+        }
+        else if (property == POWER_CAP_ENABLE_PROP)
+        {
+            if (auto v = std::get_if<bool>(&value))
+            {
+                powerCapEnable = *v;
+            }
+        }
+        auto pending = pendingApply.find(property);
+        if (pending != pendingApply.end() && pending->second.first == value)
+        {
+            applyStats.add(now - pending->second.second);
+            pendingApply.erase(pending);
+        }
     }
-    std::variant<uint32_t> pcap;
-    reply.read(pcap);
-
-    return std::get<uint32_t>(pcap);
 }
 
-bool getPcapEnabled(sdbusplus::bus::bus& bus)
+void PowerCap::load()
 {
-    auto settingService = ipmi::getService(bus, PCAP_INTERFACE, PCAP_PATH);
-
-    auto method = bus.new_method_call(settingService.c_str(), PCAP_PATH,
-                                      "org.freedesktop.DBus.Properties", "Get");
-
-    method.append(PCAP_INTERFACE, POWER_CAP_ENABLE_PROP);
-    auto reply = bus.call(method);
-
-    if (reply.is_method_error())
+    if (powerCap && powerCapEnable)
+    {
+        return;
+    }
+    try
+    {
+        if (service.empty())
+        {
+            service = ipmi::getService(bus, PCAP_INTERFACE, PCAP_PATH);
+        }
+        update(ipmi::getAllDbusProperties(bus, service, PCAP_PATH,
+                                          PCAP_INTERFACE));
+    }
+    catch (const std::exception& e)
     {
-        log<level::ERR>("Error in getPcapEnabled prop");
+        service.clear();
+        log<level::ERR>("Error in reading the power cap properties",
+                        entry("ERROR=%s", e.what()));
+        elog<InternalFailure>();
+    }
+    if (!powerCap || !powerCapEnable)
+    {
+        log<level::ERR>("Power cap properties missing");
         elog<InternalFailure>();
     }
-    std::variant<bool> pcapEnabled;
-    reply.read(pcapEnabled);
-
-    return std::get<bool>(pcapEnabled);
 }
 
-void setPcap(sdbusplus::bus::bus& bus, const uint32_t powerCap)
+uint32_t PowerCap::getPcap()
 {
-    auto service = ipmi::getService(bus, PCAP_INTERFACE, PCAP_PATH);
-
-    auto method = bus.new_method_call(service.c_str(), PCAP_PATH,
-                                      "org.freedesktop.DBus.Properties", "Set");
+    load();
+    return *powerCap;
+}
 
-    method.append(PCAP_INTERFACE, POWER_CAP_PROP);
-    method.append(std::variant<uint32_t>(powerCap));
+bool PowerCap::getPcapEnabled()
+{
+    load();
+    return *powerCapEnable;
+}
 
-    auto reply = bus.call(method);
+boost::system::error_code PowerCap::set(ipmi::Context::ptr ctx,
+                                        const std::string& property,
+                                        const ipmi::Value& value)
+{
+    boost::system::error_code ec;
+    if (service.empty())
+    {
+        std::string found;
+        ec = ipmi::getService(ctx, PCAP_INTERFACE, PCAP_PATH, found);
+        if (ec)
+        {
+            failures++;
+            return ec;
+        }
+        service = std::move(found);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pendingApply[property] = std::make_pair(value, start);
+    ctx->bus->yield_method_call(ctx->yield, ec, service.c_str(), PCAP_PATH,
+                                "org.freedesktop.DBus.Properties", "Set",
+                                PCAP_INTERFACE, property, value);
+    if (ec)
+    {
+        // the settings daemon may have restarted, look it up again
+        failures++;
+        pendingApply.erase(property);
+        service.clear();
+        powerCap.reset();
+        powerCapEnable.reset();
+        return ec;
+    }
+    setStats.add(std::chrono::steady_clock::now() - start);
+    return ec;
+}
 
-    if (reply.is_method_error())
+boost::system::error_code PowerCap::setPcap(ipmi::Context::ptr ctx,
+                                            uint32_t value)
+{
+    if (powerCap == value)
     {
-        log<level::ERR>("Error in setPcap property");
-        elog<InternalFailure>();
+        return {};
     }
+    auto ec = set(ctx, POWER_CAP_PROP, value);
+    if (!ec)
+    {
+        powerCap = value;
+    }
+    return ec;
 }
 
-void setPcapEnable(sdbusplus::bus::bus& bus, bool enabled)
+boost::system::error_code PowerCap::setPcapEnable(ipmi::Context::ptr ctx,
+                                                  bool enabled)
 {
-    auto service = ipmi::getService(bus, PCAP_INTERFACE, PCAP_PATH);
-
-    auto method = bus.new_method_call(service.c_str(), PCAP_PATH,
-                                      "org.freedesktop.DBus.Properties", "Set");
-
-    method.append(PCAP_INTERFACE, POWER_CAP_ENABLE_PROP);
-    method.append(std::variant<bool>(enabled));
-
-    auto reply = bus.call(method);
-
-    if (reply.is_method_error())
+    if (powerCapEnable == enabled)
     {
-        log<level::ERR>("Error in setPcapEnabled property");
-        elog<InternalFailure>();
+        return {};
     }
+    auto ec = set(ctx, POWER_CAP_ENABLE_PROP, enabled);
+    if (!ec)
+    {
+        powerCapEnable = enabled;
+    }
+    return ec;
 }
 
-void readAssetTagObjectTree(dcmi::assettag::ObjectTree& objectTree)
+PowerCap& getPowerCap()
 {
-    static constexpr auto mapperBusName = "xyz.openbmc_project.ObjectMapper";
-    static constexpr auto mapperObjPath = "/xyz/openbmc_project/object_mapper";
-    static constexpr auto mapperIface = "xyz.openbmc_project.ObjectMapper";
-    static constexpr auto inventoryRoot = "/xyz/openbmc_project/inventory/";
+    static PowerCap powerCap(*getSdBus());
+    return powerCap;
+}
 
+void readAssetTagObjectTree(dcmi::assettag::ObjectTree& objectTree)
+{
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    auto depth = 0;
-
-    auto mapperCall = bus.new_method_call(mapperBusName, mapperObjPath,
-                                          mapperIface, "GetSubTree");
 
-    mapperCall.append(inventoryRoot);
-    mapperCall.append(depth);
-    mapperCall.append(std::vector<std::string>({dcmi::assetTagIntf}));
+    objectTree =
+        ipmi::mapper::getSubTree(bus, inventoryRoot, 0, {dcmi::assetTagIntf});
 
-    auto mapperReply = bus.call(mapperCall);
-    if (mapperReply.is_method_error())
+    if (objectTree.empty())
     {
-        log<level::ERR>("Error in mapper call");
+        log<level::ERR>("AssetTag property is not populated");
         elog<InternalFailure>();
     }
+}
 
-    mapperReply.read(objectTree);
-
-    if (objectTree.empty())
+/** @brief Reads a string property from a PropertiesChanged signal
+ *
+ *  @param[in] msg - the signal
+ *  @param[in] property - property name
+ *
+ *  @return the new value, std::nullopt if the property did not change
+ */
+static std::optional<std::string>
+    readChangedString(sdbusplus::message::message& msg, const char* property)
+{
+    std::string interface;
+    ipmi::PropertyMap properties;
+    try
     {
-        log<level::ERR>("AssetTag property is not populated");
-        elog<InternalFailure>();
+        msg.read(interface, properties);
+    }
+    catch (const std::exception& e)
+    {
+        return std::nullopt;
+    }
+    auto it = properties.find(property);
+    if (it == properties.end())
+    {
+        return std::nullopt;
+    }
+    if (auto value = std::get_if<std::string>(&it->second))
+    {
+        return *value;
     }
+    return std::nullopt;
 }
 
-std::string readAssetTag()
+// The asset tag object found by the mapper lookup and its value are kept
+// until the signals report a change, so that the chunks of a multi-chunk
+// read come from one lookup.
+static std::string assetTagService;
+static std::string assetTagPath;
+static std::optional<std::string> assetTagValue;
+static std::unique_ptr<sdbusplus::bus::match_t> assetTagMatch;
+static std::unique_ptr<sdbusplus::bus::match_t> assetTagAddedMatch;
+static std::unique_ptr<sdbusplus::bus::match_t> assetTagRemovedMatch;
+
+/** @brief Finds the object that implements the Asset tag interface, the
+ *         result of the lookup is cached
+ */
+static void findAssetTagObject()
 {
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    dcmi::assettag::ObjectTree objectTree;
+    if (!assetTagPath.empty())
+    {
+        return;
+    }
+
+    auto& bus = *getSdBus();
+    if (!assetTagAddedMatch)
+    {
+        // another object may provide the asset tag as inventory objects
+        // come and go
+        using namespace sdbusplus::bus::match::rules;
+        auto invalidate = [](sdbusplus::message::message&) {
+            assetTagMatch.reset();
+            assetTagPath.clear();
+            assetTagService.clear();
+            assetTagValue.reset();
+        };
+        assetTagAddedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, interfacesAdded() + argNpath(0, inventoryRoot), invalidate);
+        assetTagRemovedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, interfacesRemoved() + argNpath(0, inventoryRoot), invalidate);
+    }
 
     // Read the object tree with the inventory root to figure out the object
     // that has implemented the Asset tag interface.
+    dcmi::assettag::ObjectTree objectTree;
     readAssetTagObjectTree(objectTree);
+    assetTagPath = objectTree.begin()->first;
+    assetTagService = objectTree.begin()->second.begin()->first;
+
+    assetTagMatch = std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusplus::bus::match::rules::propertiesChanged(assetTagPath,
+                                                        dcmi::assetTagIntf),
+        [](sdbusplus::message::message& msg) {
+            auto value = readChangedString(msg, dcmi::assetTagProp);
+            if (value)
+            {
+                assetTagValue = std::move(*value);
+            }
+        });
+}
 
-    auto method = bus.new_method_call(
-        (objectTree.begin()->second.begin()->first).c_str(),
-        (objectTree.begin()->first).c_str(), dcmi::propIntf, "Get");
+std::string readAssetTag()
+{
+    findAssetTagObject();
+    if (assetTagValue)
+    {
+        return *assetTagValue;
+    }
+
+    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+    auto method = bus.new_method_call(assetTagService.c_str(),
+                                      assetTagPath.c_str(), dcmi::propIntf,
+                                      "Get");
     method.append(dcmi::assetTagIntf);
     method.append(dcmi::assetTagProp);
 
@@ -208,21 +390,18 @@ std::string readAssetTag()
     std::variant<std::string> assetTag;
     reply.read(assetTag);
 
-    return std::get<std::string>(assetTag);
+    assetTagValue = std::get<std::string>(assetTag);
+    return *assetTagValue;
 }
 
 void writeAssetTag(const std::string& assetTag)
 {
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    dcmi::assettag::ObjectTree objectTree;
-
-    // Read the object tree with the inventory root to figure out the object
-    // that has implemented the Asset tag interface.
-    readAssetTagObjectTree(objectTree);
+    findAssetTagObject();
 
-    auto method = bus.new_method_call(
-        (objectTree.begin()->second.begin()->first).c_str(),
-        (objectTree.begin()->first).c_str(), dcmi::propIntf, "Set");
+    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+    auto method = bus.new_method_call(assetTagService.c_str(),
+                                      assetTagPath.c_str(), dcmi::propIntf,
+                                      "Set");
     method.append(dcmi::assetTagIntf);
     method.append(dcmi::assetTagProp);
     method.append(std::variant<std::string>(assetTag));
@@ -233,17 +412,50 @@ void writeAssetTag(const std::string& assetTag)
         log<level::ERR>("Error in writing asset tag");
         elog<InternalFailure>();
     }
+    assetTagValue = assetTag;
 }
 
+// The host name, kept until the network daemon reports a change
+static std::optional<std::string> hostNameValue;
+static std::unique_ptr<sdbusplus::bus::match_t> hostNameMatch;
+
 std::string getHostName(void)
 {
+    if (!hostNameMatch)
+    {
+        hostNameMatch = std::make_unique<sdbusplus::bus::match_t>(
+            *getSdBus(),
+            sdbusplus::bus::match::rules::propertiesChanged(networkConfigObj,
+                                                            networkConfigIntf),
+            [](sdbusplus::message::message& msg) {
+                auto value = readChangedString(msg, hostNameProp);
+                if (value)
+                {
+                    hostNameValue = std::move(*value);
+                }
+            });
+    }
+    if (hostNameValue)
+    {
+        return *hostNameValue;
+    }
+
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
 
     auto service = ipmi::getService(bus, networkConfigIntf, networkConfigObj);
     auto value = ipmi::getDbusProperty(bus, service, networkConfigObj,
                                        networkConfigIntf, hostNameProp);
 
-    return std::get<std::string>(value);
+    hostNameValue = std::get<std::string>(value);
+    return *hostNameValue;
+}
+
+void setHostName(const std::string& hostName)
+{
+    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+    ipmi::setDbusProperty(bus, networkServiceName, networkConfigObj,
+                          networkConfigIntf, hostNameProp, hostName);
+    hostNameValue = hostName;
 }
 
 bool getDHCPEnabled()
@@ -297,36 +509,148 @@ Json parseJSONConfig(const std::string& configFile)
     return data;
 }
 
+Config::Config()
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        log<level::ERR>("Failed to create DCMI config inotify instance",
+                        entry("ERRNO=%d", errno));
+        return;
+    }
+    // the files are expected to be replaced rather than edited in place
+    auto dir = std::filesystem::path(gDCMISensorsConfig).parent_path();
+    if (inotify_add_watch(inotifyFd, dir.c_str(),
+                          IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                              IN_MOVED_FROM | IN_MOVED_TO) < 0)
+    {
+        log<level::ERR>("Failed to watch DCMI config directory",
+                        entry("DIR=%s", dir.c_str()),
+                        entry("ERRNO=%d", errno));
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+}
+
+Config::~Config()
+{
+    if (inotifyFd >= 0)
+    {
+        close(inotifyFd);
+    }
+}
+
+void Config::update()
+{
+    if (inotifyFd < 0)
+    {
+        // without the watch a change can't be detected, so always parse
+        caps.reset();
+        capsResponses.reset();
+        sensorMap.reset();
+        return;
+    }
+
+    static const std::string capsName =
+        std::filesystem::path(gDCMICapabilitiesConfig).filename();
+    static const std::string sensorsName =
+        std::filesystem::path(gDCMISensorsConfig).filename();
+    alignas(inotify_event) std::array<char, 4096> events;
+    ssize_t size;
+    while ((size = ::read(inotifyFd, events.data(), events.size())) > 0)
+    {
+        for (ssize_t pos = 0; pos < size;)
+        {
+            auto event =
+                reinterpret_cast<const inotify_event*>(events.data() + pos);
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len && capsName == event->name))
+            {
+                caps.reset();
+                capsResponses.reset();
+            }
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len && sensorsName == event->name))
+            {
+                sensorMap.reset();
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+
+const Json& Config::capabilities()
+{
+    update();
+    if (!caps)
+    {
+        caps = parseJSONConfig(gDCMICapabilitiesConfig);
+    }
+    return *caps;
+}
+
+std::shared_ptr<SensorBindings> Config::sensors(const std::string& type)
+{
+    update();
+    if (!sensorMap)
+    {
+        auto data = parseJSONConfig(gDCMISensorsConfig);
+        std::map<std::string, SensorBindings> bindings;
+        for (const auto& [name, readings] : data.items())
+        {
+            if (!readings.is_array())
+            {
+                continue;
+            }
+            auto& sensors = bindings[name];
+            for (const auto& reading : readings)
+            {
+                sensors.push_back({reading.value("instance", uint8_t(0)),
+                                   reading.value("dbus", ""), "",
+                                   reading.value("record_id", uint16_t(0))});
+            }
+        }
+        sensorMap = std::make_shared<std::map<std::string, SensorBindings>>(
+            std::move(bindings));
+    }
+    // shares the ownership of the whole map
+    return std::shared_ptr<SensorBindings>(sensorMap, &(*sensorMap)[type]);
+}
+
+Config& getConfig()
+{
+    static Config config;
+    return config;
+}
+
 } // namespace dcmi
 
-ipmi_ret_t getPowerLimit(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                         ipmi_request_t request, ipmi_response_t response,
-                         ipmi_data_len_t data_len, ipmi_context_t context)
+ipmi::RspType<uint16_t, // reserved
+              uint8_t,  // exception action
+              uint16_t, // power limit in watts
+              uint32_t, // correction time in milliseconds
+              uint16_t, // reserved
+              uint16_t  // statistics sampling period in seconds
+              >
+    getPowerLimit(uint16_t reserved)
 {
     if (!dcmi::isDCMIPowerMgmtSupported())
     {
-        *data_len = 0;
         log<level::ERR>("DCMI Power management is unsupported!");
-        return IPMI_CC_INVALID;
+        return ipmi::responseInvalidCommand();
     }
 
-    std::vector<uint8_t> outPayload(sizeof(dcmi::GetPowerLimitResponse));
-    auto responseData =
-        reinterpret_cast<dcmi::GetPowerLimitResponse*>(outPayload.data());
-
-    sdbusplus::bus::bus sdbus{ipmid_get_sd_bus_connection()};
     uint32_t pcapValue = 0;
     bool pcapEnable = false;
 
     try
     {
-        pcapValue = dcmi::getPcap(sdbus);
-        pcapEnable = dcmi::getPcapEnabled(sdbus);
+        pcapValue = dcmi::getPowerCap().getPcap();
+        pcapEnable = dcmi::getPowerCap().getPcapEnabled();
     }
     catch (InternalFailure& e)
     {
-        *data_len = 0;
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        return ipmi::responseUnspecifiedError();
     }
 
     /*
@@ -334,95 +658,95 @@ ipmi_ret_t getPowerLimit(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
      * with the correction time limit is hardcoded to Hard Power Off system
      * and log event to SEL.
      */
-    constexpr auto exception = 0x01;
-    responseData->exceptionAction = exception;
-
-    responseData->powerLimit = static_cast<uint16_t>(pcapValue);
+    constexpr uint8_t exception = 0x01;
 
     /*
      * Correction time limit and Statistics sampling period is currently not
      * populated.
      */
-
-    *data_len = outPayload.size();
-    memcpy(response, outPayload.data(), *data_len);
-
-    if (pcapEnable)
-    {
-        return IPMI_CC_OK;
-    }
-    else
-    {
-        return IPMI_DCMI_CC_NO_ACTIVE_POWER_LIMIT;
-    }
+    constexpr uint32_t correctionTime = 0;
+    constexpr uint16_t samplingPeriod = 0;
+
+    // the limit is answered even when it is not active
+    ipmi::Cc cc = pcapEnable ? ipmi::ccSuccess
+                             : static_cast<ipmi::Cc>(
+                                   IPMI_DCMI_CC_NO_ACTIVE_POWER_LIMIT);
+    return ipmi::response(cc, uint16_t{0}, exception,
+                          static_cast<uint16_t>(pcapValue), correctionTime,
+                          uint16_t{0}, samplingPeriod);
 }
 
-ipmi_ret_t setPowerLimit(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                         ipmi_request_t request, ipmi_response_t response,
-                         ipmi_data_len_t data_len, ipmi_context_t context)
+ipmi::RspType<> setPowerLimit(ipmi::Context::ptr ctx, uint16_t reserved,
+                              uint8_t reserved1, uint8_t exceptionAction,
+                              uint16_t powerLimit, uint32_t correctionTime,
+                              uint16_t reserved2, uint16_t samplingPeriod)
 {
     if (!dcmi::isDCMIPowerMgmtSupported())
     {
-        *data_len = 0;
         log<level::ERR>("DCMI Power management is unsupported!");
-        return IPMI_CC_INVALID;
+        return ipmi::responseInvalidCommand();
     }
 
-    auto requestData =
-        reinterpret_cast<const dcmi::SetPowerLimitRequest*>(request);
-
-    sdbusplus::bus::bus sdbus{ipmid_get_sd_bus_connection()};
-
     // Only process the power limit requested in watts.
-    try
+    if (dcmi::getPowerCap().setPcap(ctx, powerLimit))
     {
-        dcmi::setPcap(sdbus, requestData->powerLimit);
-    }
-    catch (InternalFailure& e)
-    {
-        *data_len = 0;
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        log<level::ERR>("Error in setPcap property");
+        return ipmi::responseUnspecifiedError();
     }
 
-    log<level::INFO>("Set Power Cap",
-                     entry("POWERCAP=%u", requestData->powerLimit));
+    log<level::INFO>("Set Power Cap", entry("POWERCAP=%u", powerLimit));
 
-    *data_len = 0;
-    return IPMI_CC_OK;
+    return ipmi::responseSuccess();
 }
 
-ipmi_ret_t applyPowerLimit(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                           ipmi_request_t request, ipmi_response_t response,
-                           ipmi_data_len_t data_len, ipmi_context_t context)
+ipmi::RspType<> applyPowerLimit(ipmi::Context::ptr ctx,
+                                uint8_t powerLimitAction, uint16_t reserved)
 {
     if (!dcmi::isDCMIPowerMgmtSupported())
     {
-        *data_len = 0;
         log<level::ERR>("DCMI Power management is unsupported!");
-        return IPMI_CC_INVALID;
+        return ipmi::responseInvalidCommand();
     }
 
-    auto requestData =
-        reinterpret_cast<const dcmi::ApplyPowerLimitRequest*>(request);
-
-    sdbusplus::bus::bus sdbus{ipmid_get_sd_bus_connection()};
-
-    try
-    {
-        dcmi::setPcapEnable(sdbus,
-                            static_cast<bool>(requestData->powerLimitAction));
-    }
-    catch (InternalFailure& e)
+    if (dcmi::getPowerCap().setPcapEnable(ctx,
+                                          static_cast<bool>(powerLimitAction)))
     {
-        *data_len = 0;
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        log<level::ERR>("Error in setPcapEnabled property");
+        return ipmi::responseUnspecifiedError();
     }
 
     log<level::INFO>("Set Power Cap Enable",
-                     entry("POWERCAPENABLE=%u", requestData->powerLimitAction));
+                     entry("POWERCAPENABLE=%u", powerLimitAction));
 
-    *data_len = 0;
-    return IPMI_CC_OK;
+    return ipmi::responseSuccess();
+}
+
+/** @brief Get Power Cap Statistics OEM command, reports how long the power
+ *         limit updates take
+ *
+ *  @return the number of Set calls with their average and maximum latency in
+ *          microseconds, the same for the applies and the Set failures
+ */
+ipmi::RspType<uint32_t, // setCount
+              uint32_t, // setAverageUs
+              uint32_t, // setMaxUs
+              uint32_t, // applyCount
+              uint32_t, // applyAverageUs
+              uint32_t, // applyMaxUs
+              uint32_t  // setFailures
+              >
+    getPowerCapStats()
+{
+    const dcmi::PowerCap& powerCap = dcmi::getPowerCap();
+    auto average = [](const dcmi::PowerCap::Latency& latency) {
+        return static_cast<uint32_t>(
+            latency.count ? latency.totalUs / latency.count : 0);
+    };
+    return ipmi::responseSuccess(
+        powerCap.setLatency().count, average(powerCap.setLatency()),
+        powerCap.setLatency().maxUs, powerCap.applyLatency().count,
+        average(powerCap.applyLatency()), powerCap.applyLatency().maxUs,
+        powerCap.setFailures());
 }
 
 ipmi_ret_t getAssetTag(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
@@ -635,11 +959,7 @@ ipmi_ret_t setMgmntCtrlIdStr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                             requestData->data + requestData->bytes, '\0');
         if (it != requestData->data + requestData->bytes)
         {
-            sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-            ipmi::setDbusProperty(bus, dcmi::networkServiceName,
-                                  dcmi::networkConfigObj,
-                                  dcmi::networkConfigIntf, dcmi::hostNameProp,
-                                  std::string(newCtrlIdStr.data()));
+            dcmi::setHostName(newCtrlIdStr.data());
         }
     }
     catch (InternalFailure& e)
@@ -683,47 +1003,30 @@ dcmi::DCMICaps dcmiCaps = {
        {"OptionalSecondaryLanOOBSupport", 2, 0, 8},
        {"OptionalSerialOOBMTMODECapability", 3, 0, 8}}}}};
 
-ipmi_ret_t getDCMICapabilities(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                               ipmi_request_t request, ipmi_response_t response,
-                               ipmi_data_len_t data_len, ipmi_context_t context)
+namespace dcmi
 {
 
-    std::ifstream dcmiCapFile(dcmi::gDCMICapabilitiesConfig);
-    if (!dcmiCapFile.is_open())
-    {
-        log<level::ERR>("DCMI Capabilities file not found");
-        return IPMI_CC_UNSPECIFIED_ERROR;
-    }
-
-    auto data = nlohmann::json::parse(dcmiCapFile, nullptr, false);
-    if (data.is_discarded())
-    {
-        log<level::ERR>("DCMI Capabilities JSON parser failure");
-        return IPMI_CC_UNSPECIFIED_ERROR;
-    }
-
-    auto requestData =
-        reinterpret_cast<const dcmi::GetDCMICapRequest*>(request);
-
-    // get list of capabilities in a parameter
-    auto caps =
-        dcmiCaps.find(static_cast<dcmi::DCMICapParameters>(requestData->param));
-    if (caps == dcmiCaps.end())
-    {
-        log<level::ERR>("Invalid input parameter");
-        return IPMI_CC_INVALID_FIELD_REQUEST;
-    }
-
-    auto responseData = reinterpret_cast<dcmi::GetDCMICapResponse*>(response);
+/** @brief encodes the Get DCMI Capabilities Info response of a parameter
+ *
+ *  @param[in] data - the capabilities config
+ *  @param[in] entry - the capabilities of the parameter
+ *
+ *  @return the response data
+ */
+static std::vector<uint8_t> encodeCapabilities(const Json& data,
+                                               const DCMICapEntry& entry)
+{
+    std::vector<uint8_t> response(sizeof(GetDCMICapResponse) + entry.size);
+    auto responseData = reinterpret_cast<GetDCMICapResponse*>(response.data());
 
     // For each capabilities in a parameter fill the data from
     // the json file based on the capability name.
-    for (auto cap : caps->second.capList)
+    for (const auto& cap : entry.capList)
     {
         // If the data is beyond first byte boundary, insert in a
         // 16bit pattern for example number of SEL entries are represented
         // in 12bits.
-        if ((cap.length + cap.position) > dcmi::gByteBitSize)
+        if ((cap.length + cap.position) > gByteBitSize)
         {
             uint16_t val = data.value(cap.name.c_str(), 0);
             // According to DCMI spec v1.5, max number of SEL entries is
@@ -732,14 +1035,14 @@ ipmi_ret_t getDCMICapabilities(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
             // the provided 12 bits with maximum value of 4095.
             // We're playing safe here by applying the mask
             // to ensure that provided value will fit into 12 bits.
-            if (cap.length > dcmi::gByteBitSize)
+            if (cap.length > gByteBitSize)
             {
-                val &= dcmi::gMaxSELEntriesMask;
+                val &= gMaxSELEntriesMask;
             }
             val <<= cap.position;
             responseData->data[cap.bytePosition - 1] |=
                 static_cast<uint8_t>(val);
-            responseData->data[cap.bytePosition] |= val >> dcmi::gByteBitSize;
+            responseData->data[cap.bytePosition] |= val >> gByteBitSize;
         }
         else
         {
@@ -751,7 +1054,54 @@ ipmi_ret_t getDCMICapabilities(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     responseData->major = DCMI_SPEC_MAJOR_VERSION;
     responseData->minor = DCMI_SPEC_MINOR_VERSION;
     responseData->paramRevision = DCMI_PARAMETER_REVISION;
-    *data_len = sizeof(*responseData) + caps->second.size;
+    return response;
+}
+
+const std::vector<uint8_t>* Config::capabilityResponse(DCMICapParameters param)
+{
+    const Json& data = capabilities();
+    if (!capsResponses)
+    {
+        std::map<DCMICapParameters, std::vector<uint8_t>> responses;
+        for (const auto& [selector, entry] : dcmiCaps)
+        {
+            responses.emplace(selector, encodeCapabilities(data, entry));
+        }
+        capsResponses = std::move(responses);
+    }
+    auto response = capsResponses->find(param);
+    return response == capsResponses->end() ? nullptr : &response->second;
+}
+
+} // namespace dcmi
+
+ipmi_ret_t getDCMICapabilities(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                               ipmi_request_t request, ipmi_response_t response,
+                               ipmi_data_len_t data_len, ipmi_context_t context)
+{
+    auto requestData =
+        reinterpret_cast<const dcmi::GetDCMICapRequest*>(request);
+
+    const std::vector<uint8_t>* capsResponse;
+    try
+    {
+        capsResponse = dcmi::getConfig().capabilityResponse(
+            static_cast<dcmi::DCMICapParameters>(requestData->param));
+    }
+    catch (InternalFailure& e)
+    {
+        log<level::ERR>("DCMI Capabilities config failure");
+        return IPMI_CC_UNSPECIFIED_ERROR;
+    }
+    if (!capsResponse)
+    {
+        log<level::ERR>("Invalid input parameter");
+        return IPMI_CC_INVALID_FIELD_REQUEST;
+    }
+
+    std::copy(capsResponse->begin(), capsResponse->end(),
+              static_cast<uint8_t*>(response));
+    *data_len = capsResponse->size();
 
     return IPMI_CC_OK;
 }
@@ -761,25 +1111,19 @@ namespace dcmi
 namespace temp_readings
 {
 
-Temperature readTemp(const std::string& dbusService,
-                     const std::string& dbusPath)
+Temperature toTemperature(const ipmi::PropertyMap& properties)
 {
-    // Read the temperature value from d-bus object. Need some conversion.
     // As per the interface xyz.openbmc_project.Sensor.Value, the temperature
     // is an double and in degrees C. It needs to be scaled by using the
     // formula Value * 10^Scale. The ipmi spec has the temperature as a uint8_t,
     // with a separate single bit for the sign.
-
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    auto result = ipmi::getAllDbusProperties(
-        bus, dbusService, dbusPath, "xyz.openbmc_project.Sensor.Value");
     auto temperature =
-        std::visit(ipmi::VariantToDoubleVisitor(), result.at("Value"));
+        std::visit(ipmi::VariantToDoubleVisitor(), properties.at("Value"));
     double absTemp = std::abs(temperature);
 
-    auto findFactor = result.find("Scale");
+    auto findFactor = properties.find("Scale");
     double factor = 0.0;
-    if (findFactor != result.end())
+    if (findFactor != properties.end())
     {
         factor = std::visit(ipmi::VariantToDoubleVisitor(), findFactor->second);
     }
@@ -796,11 +1140,76 @@ Temperature readTemp(const std::string& dbusService,
                            (temperature < 0));
 }
 
-std::tuple<Response, NumInstances> read(const std::string& type,
+std::vector<std::optional<Temperature>>
+    readTemps(ipmi::Context::ptr ctx,
+              const std::vector<SensorBinding*>& sensors)
+{
+    std::vector<std::optional<Temperature>> temps(sensors.size());
+
+    // the services are looked up once and cached in the sensors
+    for (SensorBinding* sensor : sensors)
+    {
+        if (sensor->service.empty())
+        {
+            ipmi::getService(ctx, "xyz.openbmc_project.Sensor.Value",
+                             sensor->path, sensor->service);
+        }
+    }
+
+    // issue all the reads at once, the coroutine resumes when the last
+    // reply cancels the timer
+    boost::asio::steady_timer done(
+        *getIoContext(), boost::asio::steady_timer::time_point::max());
+    size_t pending = 0;
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        SensorBinding* sensor = sensors[i];
+        if (sensor->service.empty())
+        {
+            continue;
+        }
+        pending++;
+        ctx->bus->async_method_call(
+            [&temps, &pending, &done, sensor,
+             i](const boost::system::error_code& ec,
+                const ipmi::PropertyMap& properties) {
+                if (ec)
+                {
+                    // the sensor may have moved to another service
+                    sensor->service.clear();
+                }
+                else
+                {
+                    try
+                    {
+                        temps[i] = toTemperature(properties);
+                    }
+                    catch (std::exception& e)
+                    {
+                        log<level::DEBUG>(e.what());
+                    }
+                }
+                if (--pending == 0)
+                {
+                    done.cancel();
+                }
+            },
+            sensor->service, sensor->path, "org.freedesktop.DBus.Properties",
+            "GetAll", "xyz.openbmc_project.Sensor.Value");
+    }
+    if (pending)
+    {
+        boost::system::error_code ec;
+        done.async_wait(ctx->yield[ec]);
+    }
+    return temps;
+}
+
+std::tuple<Response, NumInstances> read(ipmi::Context::ptr ctx,
+                                        const std::string& type,
                                         uint8_t instance)
 {
     Response response{};
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
 
     if (!instance)
     {
@@ -808,36 +1217,27 @@ std::tuple<Response, NumInstances> read(const std::string& type,
         elog<InternalFailure>();
     }
 
-    auto data = parseJSONConfig(gDCMISensorsConfig);
-    static const std::vector<Json> empty{};
-    std::vector<Json> readings = data.value(type, empty);
-    size_t numInstances = readings.size();
-    for (const auto& j : readings)
+    // held over the yields of the reads
+    std::shared_ptr<SensorBindings> sensors = getConfig().sensors(type);
+    size_t numInstances = sensors->size();
+    for (auto& sensor : *sensors)
     {
-        uint8_t instanceNum = j.value("instance", 0);
         // Not the instance we're interested in
-        if (instanceNum != instance)
+        if (sensor.instance != instance)
         {
             continue;
         }
 
-        std::string path = j.value("dbus", "");
-        std::string service;
-        try
-        {
-            service =
-                ipmi::getService(bus, "xyz.openbmc_project.Sensor.Value", path);
-        }
-        catch (std::exception& e)
+        auto temps = readTemps(ctx, {&sensor});
+        if (!temps[0])
         {
-            log<level::DEBUG>(e.what());
             return std::make_tuple(response, numInstances);
         }
 
         response.instance = instance;
         uint8_t temp{};
         bool sign{};
-        std::tie(temp, sign) = readTemp(service, path);
+        std::tie(temp, sign) = *temps[0];
         response.temperature = temp;
         response.sign = sign;
 
@@ -852,52 +1252,48 @@ std::tuple<Response, NumInstances> read(const std::string& type,
     return std::make_tuple(response, numInstances);
 }
 
-std::tuple<ResponseList, NumInstances> readAll(const std::string& type,
+std::tuple<ResponseList, NumInstances> readAll(ipmi::Context::ptr ctx,
+                                               const std::string& type,
                                                uint8_t instanceStart)
 {
     ResponseList response{};
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
 
-    size_t numInstances = 0;
-    auto data = parseJSONConfig(gDCMISensorsConfig);
-    static const std::vector<Json> empty{};
-    std::vector<Json> readings = data.value(type, empty);
-    numInstances = readings.size();
-    for (const auto& j : readings)
+    // held over the yields of the reads
+    std::shared_ptr<SensorBindings> sensors = getConfig().sensors(type);
+    size_t numInstances = sensors->size();
+
+    // Max of 8 response data sets, the sensors that can't be read are
+    // skipped so read all the ones in the instance range
+    std::vector<SensorBinding*> selected;
+    for (auto& sensor : *sensors)
     {
-        try
+        // Only the instances in the range we're interested in
+        if (sensor.instance >= instanceStart)
         {
-            // Max of 8 response data sets
-            if (response.size() == maxDataSets)
-            {
-                break;
-            }
-
-            uint8_t instanceNum = j.value("instance", 0);
-            // Not in the instance range we're interested in
-            if (instanceNum < instanceStart)
-            {
-                continue;
-            }
+            selected.push_back(&sensor);
+        }
+    }
 
-            std::string path = j.value("dbus", "");
-            auto service =
-                ipmi::getService(bus, "xyz.openbmc_project.Sensor.Value", path);
-
-            Response r{};
-            r.instance = instanceNum;
-            uint8_t temp{};
-            bool sign{};
-            std::tie(temp, sign) = readTemp(service, path);
-            r.temperature = temp;
-            r.sign = sign;
-            response.push_back(r);
+    auto temps = readTemps(ctx, selected);
+    for (size_t i = 0; i < selected.size(); i++)
+    {
+        if (response.size() == maxDataSets)
+        {
+            break;
         }
-        catch (std::exception& e)
+        if (!temps[i])
         {
-            log<level::DEBUG>(e.what());
             continue;
         }
+
+        Response r{};
+        r.instance = selected[i]->instance;
+        uint8_t temp{};
+        bool sign{};
+        std::tie(temp, sign) = *temps[i];
+        r.temperature = temp;
+        r.sign = sign;
+        response.push_back(r);
     }
 
     if (numInstances > maxInstances)
@@ -910,78 +1306,75 @@ std::tuple<ResponseList, NumInstances> readAll(const std::string& type,
 } // namespace temp_readings
 } // namespace dcmi
 
-ipmi_ret_t getTempReadings(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                           ipmi_request_t request, ipmi_response_t response,
-                           ipmi_data_len_t data_len, ipmi_context_t context)
+ipmi::RspType<uint8_t,             // No. of instances for requested id
+              uint8_t,             // No. of sets of temperature data
+              std::vector<uint8_t> // Temperature data sets
+              >
+    getTempReadings(ipmi::Context::ptr ctx, uint8_t sensorType,
+                    uint8_t entityId, uint8_t entityInstance,
+                    uint8_t instanceStart)
 {
-    auto requestData =
-        reinterpret_cast<const dcmi::GetTempReadingsRequest*>(request);
-    auto responseData =
-        reinterpret_cast<dcmi::GetTempReadingsResponseHdr*>(response);
-
-    if (*data_len != sizeof(dcmi::GetTempReadingsRequest))
-    {
-        log<level::ERR>("Malformed request data",
-                        entry("DATA_SIZE=%d", *data_len));
-        return IPMI_CC_REQ_DATA_LEN_INVALID;
-    }
-    *data_len = 0;
-
-    auto it = dcmi::entityIdToName.find(requestData->entityId);
+    auto it = dcmi::entityIdToName.find(entityId);
     if (it == dcmi::entityIdToName.end())
     {
-        log<level::ERR>("Unknown Entity ID",
-                        entry("ENTITY_ID=%d", requestData->entityId));
-        return IPMI_CC_INVALID_FIELD_REQUEST;
+        log<level::ERR>("Unknown Entity ID", entry("ENTITY_ID=%d", entityId));
+        return ipmi::responseInvalidFieldRequest();
     }
 
-    if (requestData->sensorType != dcmi::temperatureSensorType)
+    if (sensorType != dcmi::temperatureSensorType)
     {
         log<level::ERR>("Invalid sensor type",
-                        entry("SENSOR_TYPE=%d", requestData->sensorType));
-        return IPMI_CC_INVALID_FIELD_REQUEST;
+                        entry("SENSOR_TYPE=%d", sensorType));
+        return ipmi::responseInvalidFieldRequest();
     }
 
     dcmi::temp_readings::ResponseList temps{};
+    dcmi::NumInstances numInstances = 0;
     try
     {
-        if (!requestData->entityInstance)
+        if (!entityInstance)
         {
             // Read all instances
-            std::tie(temps, responseData->numInstances) =
-                dcmi::temp_readings::readAll(it->second,
-                                             requestData->instanceStart);
+            std::tie(temps, numInstances) =
+                dcmi::temp_readings::readAll(ctx, it->second, instanceStart);
         }
         else
         {
             // Read one instance
             temps.resize(1);
-            std::tie(temps[0], responseData->numInstances) =
-                dcmi::temp_readings::read(it->second,
-                                          requestData->entityInstance);
+            std::tie(temps[0], numInstances) =
+                dcmi::temp_readings::read(ctx, it->second, entityInstance);
         }
-        responseData->numDataSets = temps.size();
     }
     catch (InternalFailure& e)
     {
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        return ipmi::responseUnspecifiedError();
     }
 
-    size_t payloadSize = temps.size() * sizeof(dcmi::temp_readings::Response);
+    std::vector<uint8_t> payload(temps.size() *
+                                 sizeof(dcmi::temp_readings::Response));
     if (!temps.empty())
     {
-        memcpy(responseData + 1, // copy payload right after the response header
-               temps.data(), payloadSize);
+        memcpy(payload.data(), temps.data(), payload.size());
     }
-    *data_len = sizeof(dcmi::GetTempReadingsResponseHdr) + payloadSize;
-
-    return IPMI_CC_OK;
+    return ipmi::responseSuccess(static_cast<uint8_t>(numInstances),
+                                 static_cast<uint8_t>(temps.size()), payload);
 }
 
-int64_t getPowerReading(sdbusplus::bus::bus& bus)
+/** @brief Gets the power reading sensor object path, the configuration
+ *         file is parsed only once
+ *
+ *  @return the object path
+ */
+static const std::string& getPowerSensorPath()
 {
+    static std::string objectPath;
+    if (!objectPath.empty())
+    {
+        return objectPath;
+    }
+
     std::ifstream sensorFile(POWER_READING_SENSOR);
-    std::string objectPath;
     if (!sensorFile.is_open())
     {
         log<level::ERR>("Power reading configuration file not found",
@@ -1004,6 +1397,31 @@ int64_t getPowerReading(sdbusplus::bus::bus& bus)
                         entry("POWER_SENSOR_FILE=%s", POWER_READING_SENSOR));
         elog<InternalFailure>();
     }
+    return objectPath;
+}
+
+/** @brief Converts a sensor property to a number
+ *
+ *  @param[in] value - property value
+ *
+ *  @return the number, std::nullopt if the property is not numeric
+ */
+static std::optional<double> sensorNumber(const ipmi::Value& value)
+{
+    if (auto v = std::get_if<int64_t>(&value))
+    {
+        return *v;
+    }
+    if (auto v = std::get_if<double>(&value))
+    {
+        return *v;
+    }
+    return std::nullopt;
+}
+
+int64_t getPowerReading(sdbusplus::bus::bus& bus)
+{
+    const std::string& objectPath = getPowerSensorPath();
 
     // Return default value if failed to read from D-Bus object
     int64_t power = 0;
@@ -1030,6 +1448,135 @@ int64_t getPowerReading(sdbusplus::bus::bus& bus)
     return power;
 }
 
+namespace dcmi
+{
+
+PowerStatistics::PowerStatistics(sdbusplus::bus::bus& bus,
+                                 const std::string& objectPath) :
+    bus(bus),
+    objectPath(objectPath), timer(*getIoContext())
+{
+    // watch before the first read, so that no change can be missed
+    valueMatch = std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusplus::bus::match::rules::propertiesChanged(objectPath,
+                                                        SENSOR_VALUE_INTF),
+        [this](sdbusplus::message::message& msg) {
+            std::string interface;
+            ipmi::PropertyMap properties;
+            try
+            {
+                msg.read(interface, properties);
+            }
+            catch (const std::exception& e)
+            {
+                return;
+            }
+            auto scaleProp = properties.find(SENSOR_SCALE_PROP);
+            if (scaleProp != properties.end())
+            {
+                if (auto number = sensorNumber(scaleProp->second))
+                {
+                    scale = static_cast<int64_t>(*number);
+                }
+            }
+            auto valueProp = properties.find(SENSOR_VALUE_PROP);
+            if (valueProp != properties.end())
+            {
+                value = sensorNumber(valueProp->second);
+            }
+        });
+    readSensor();
+    schedule();
+}
+
+void PowerStatistics::readSensor()
+{
+    try
+    {
+        auto service = ipmi::getService(bus, SENSOR_VALUE_INTF, objectPath);
+        auto properties = ipmi::getAllDbusProperties(bus, service, objectPath,
+                                                     SENSOR_VALUE_INTF);
+        // newer sensors have no Scale property, their value is not scaled
+        auto scaleProp = properties.find(SENSOR_SCALE_PROP);
+        if (scaleProp != properties.end())
+        {
+            scale = static_cast<int64_t>(
+                sensorNumber(scaleProp->second).value_or(0));
+        }
+        value = sensorNumber(properties[SENSOR_VALUE_PROP]);
+        scaleKnown = true;
+    }
+    catch (std::exception& e)
+    {
+        // the sensor may not be up yet, the read is retried on every sample
+    }
+}
+
+void PowerStatistics::sample()
+{
+    if (!scaleKnown)
+    {
+        readSensor();
+    }
+    if (!scaleKnown || !value)
+    {
+        return;
+    }
+
+    // Power reading needs to be scaled with the Scale value using the
+    // formula Value * 10^Scale.
+    double power = *value * std::pow(10, scale);
+    samples[next] = static_cast<uint16_t>(
+        std::clamp(power, 0.0, double(std::numeric_limits<uint16_t>::max())));
+    next = (next + 1) % maxSamples;
+    sampleCount = std::min(sampleCount + 1, maxSamples);
+    lastSampleTime = static_cast<uint32_t>(std::time(nullptr));
+}
+
+void PowerStatistics::schedule()
+{
+    timer.expires_after(sampleInterval);
+    timer.async_wait([this](const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        sample();
+        schedule();
+    });
+}
+
+std::optional<PowerStatistics::Stats>
+    PowerStatistics::get(std::chrono::seconds period) const
+{
+    if (sampleCount == 0)
+    {
+        return std::nullopt;
+    }
+
+    size_t count = std::clamp<size_t>(period / sampleInterval, 1, sampleCount);
+    Stats stats{};
+    stats.current = samples[(next + maxSamples - 1) % maxSamples];
+    stats.minimum = std::numeric_limits<uint16_t>::max();
+    uint32_t sum = 0;
+    for (size_t i = 1; i <= count; i++)
+    {
+        uint16_t power = samples[(next + maxSamples - i) % maxSamples];
+        stats.minimum = std::min(stats.minimum, power);
+        stats.maximum = std::max(stats.maximum, power);
+        sum += power;
+    }
+    stats.average = sum / count;
+    stats.timeStamp = lastSampleTime;
+    stats.timeFrame = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          count * sampleInterval)
+                          .count();
+    return stats;
+}
+
+} // namespace dcmi
+
 ipmi_ret_t setDCMIConfParams(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                              ipmi_request_t request, ipmi_response_t response,
                              ipmi_data_len_t data_len, ipmi_context_t context)
@@ -1181,33 +1728,83 @@ ipmi_ret_t getPowerReading(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
         return IPMI_CC_INVALID;
     }
 
+    if (*data_len != sizeof(dcmi::GetPowerReadingRequest))
+    {
+        *data_len = 0;
+        return IPMI_CC_REQ_DATA_LEN_INVALID;
+    }
+
+    auto requestData =
+        reinterpret_cast<const dcmi::GetPowerReadingRequest*>(request);
+    std::chrono::seconds period;
+    switch (static_cast<dcmi::PowerReadingMode>(requestData->mode))
+    {
+        case dcmi::PowerReadingMode::SYSTEM_POWER_STATISTICS:
+            period = dcmi::PowerStatistics::maxSamples *
+                     dcmi::PowerStatistics::sampleInterval;
+            break;
+        case dcmi::PowerReadingMode::ENHANCED_SYSTEM_POWER_STATISTICS:
+        {
+            static constexpr std::array<std::chrono::seconds, 4> units = {
+                std::chrono::seconds(1), std::chrono::minutes(1),
+                std::chrono::hours(1), std::chrono::hours(24)};
+            period = (requestData->modeAttribute &
+                      POWER_PERIOD_DURATION_MASK) *
+                     units[requestData->modeAttribute >>
+                           POWER_PERIOD_UNITS_SHIFT];
+            if (period.count() == 0 ||
+                period > dcmi::PowerStatistics::maxSamples *
+                             dcmi::PowerStatistics::sampleInterval)
+            {
+                *data_len = 0;
+                return IPMI_CC_INVALID_FIELD_REQUEST;
+            }
+            break;
+        }
+        default:
+            *data_len = 0;
+            return IPMI_CC_INVALID_FIELD_REQUEST;
+    }
+
     ipmi_ret_t rc = IPMI_CC_OK;
     auto responseData =
         reinterpret_cast<dcmi::GetPowerReadingResponse*>(response);
 
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    int64_t power = 0;
-    try
+    std::optional<dcmi::PowerStatistics::Stats> stats;
+    if (powerStatistics)
     {
-        power = getPowerReading(bus);
+        stats = powerStatistics->get(period);
     }
-    catch (InternalFailure& e)
+    if (!stats)
     {
-        log<level::ERR>("Error in reading power sensor value",
-                        entry("INTERFACE=%s", SENSOR_VALUE_INTF),
-                        entry("PROPERTY=%s", SENSOR_VALUE_PROP));
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        // no sample yet, report the instantaneous reading
+        sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+        int64_t power = 0;
+        try
+        {
+            power = getPowerReading(bus);
+        }
+        catch (InternalFailure& e)
+        {
+            log<level::ERR>("Error in reading power sensor value",
+                            entry("INTERFACE=%s", SENSOR_VALUE_INTF),
+                            entry("PROPERTY=%s", SENSOR_VALUE_PROP));
+            *data_len = 0;
+            return IPMI_CC_UNSPECIFIED_ERROR;
+        }
+        uint16_t totalPower = static_cast<uint16_t>(power);
+        stats = dcmi::PowerStatistics::Stats{
+            totalPower, totalPower, totalPower, totalPower,
+            static_cast<uint32_t>(std::time(nullptr)), 0};
     }
 
-    // TODO: openbmc/openbmc#2819
-    // Minimum, Maximum, Average power, TimeFrame, TimeStamp,
-    // PowerReadingState readings need to be populated
-    // after Telemetry changes.
-    uint16_t totalPower = static_cast<uint16_t>(power);
-    responseData->currentPower = totalPower;
-    responseData->minimumPower = totalPower;
-    responseData->maximumPower = totalPower;
-    responseData->averagePower = totalPower;
+    responseData->currentPower = stats->current;
+    responseData->minimumPower = stats->minimum;
+    responseData->maximumPower = stats->maximum;
+    responseData->averagePower = stats->average;
+    responseData->timeStamp = stats->timeStamp;
+    responseData->timeFrame = stats->timeFrame;
+    responseData->powerReadingState = POWER_MEASUREMENT_ACTIVE;
 
     *data_len = sizeof(*responseData);
     return rc;
@@ -1218,17 +1815,16 @@ namespace dcmi
 namespace sensor_info
 {
 
-Response createFromJson(const Json& config)
+Response createFromBinding(const SensorBinding& sensor)
 {
     Response response{};
-    uint16_t recordId = config.value("record_id", 0);
-    response.recordIdLsb = recordId & 0xFF;
-    response.recordIdMsb = (recordId >> 8) & 0xFF;
+    response.recordIdLsb = sensor.recordId & 0xFF;
+    response.recordIdMsb = (sensor.recordId >> 8) & 0xFF;
     return response;
 }
 
 std::tuple<Response, NumInstances> read(const std::string& type,
-                                        uint8_t instance, const Json& config)
+                                        uint8_t instance)
 {
     Response response{};
 
@@ -1238,19 +1834,17 @@ std::tuple<Response, NumInstances> read(const std::string& type,
         elog<InternalFailure>();
     }
 
-    static const std::vector<Json> empty{};
-    std::vector<Json> readings = config.value(type, empty);
-    size_t numInstances = readings.size();
-    for (const auto& reading : readings)
+    std::shared_ptr<SensorBindings> sensors = getConfig().sensors(type);
+    size_t numInstances = sensors->size();
+    for (const auto& sensor : *sensors)
     {
-        uint8_t instanceNum = reading.value("instance", 0);
         // Not the instance we're interested in
-        if (instanceNum != instance)
+        if (sensor.instance != instance)
         {
             continue;
         }
 
-        response = createFromJson(reading);
+        response = createFromBinding(sensor);
 
         // Found the instance we're interested in
         break;
@@ -1265,40 +1859,28 @@ std::tuple<Response, NumInstances> read(const std::string& type,
     return std::make_tuple(response, numInstances);
 }
 
-std::tuple<ResponseList, NumInstances>
-    readAll(const std::string& type, uint8_t instanceStart, const Json& config)
+std::tuple<ResponseList, NumInstances> readAll(const std::string& type,
+                                               uint8_t instanceStart)
 {
     ResponseList responses{};
 
-    size_t numInstances = 0;
-    static const std::vector<Json> empty{};
-    std::vector<Json> readings = config.value(type, empty);
-    numInstances = readings.size();
-    for (const auto& reading : readings)
+    std::shared_ptr<SensorBindings> sensors = getConfig().sensors(type);
+    size_t numInstances = sensors->size();
+    for (const auto& sensor : *sensors)
     {
-        try
+        // Max of 8 records
+        if (responses.size() == maxRecords)
         {
-            // Max of 8 records
-            if (responses.size() == maxRecords)
-            {
-                break;
-            }
-
-            uint8_t instanceNum = reading.value("instance", 0);
-            // Not in the instance range we're interested in
-            if (instanceNum < instanceStart)
-            {
-                continue;
-            }
-
-            Response response = createFromJson(reading);
-            responses.push_back(response);
+            break;
         }
-        catch (std::exception& e)
+
+        // Not in the instance range we're interested in
+        if (sensor.instance < instanceStart)
         {
-            log<level::DEBUG>(e.what());
             continue;
         }
+
+        responses.push_back(createFromBinding(sensor));
     }
 
     if (numInstances > maxInstances)
@@ -1346,31 +1928,23 @@ ipmi_ret_t getSensorInfo(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     }
 
     dcmi::sensor_info::ResponseList sensors{};
-    static dcmi::Json config{};
-    static bool parsed = false;
 
     try
     {
-        if (!parsed)
-        {
-            config = dcmi::parseJSONConfig(dcmi::gDCMISensorsConfig);
-            parsed = true;
-        }
-
         if (!requestData->entityInstance)
         {
             // Read all instances
             std::tie(sensors, responseData->numInstances) =
                 dcmi::sensor_info::readAll(it->second,
-                                           requestData->instanceStart, config);
+                                           requestData->instanceStart);
         }
         else
         {
             // Read one instance
             sensors.resize(1);
             std::tie(sensors[0], responseData->numInstances) =
-                dcmi::sensor_info::read(it->second, requestData->entityInstance,
-                                        config);
+                dcmi::sensor_info::read(it->second,
+                                        requestData->entityInstance);
         }
         responseData->numRecords = sensors.size();
     }
@@ -1394,18 +1968,26 @@ void register_netfn_dcmi_functions()
 {
     // <Get Power Limit>
 
-    ipmi_register_callback(NETFUN_GRPEXT, dcmi::Commands::GET_POWER_LIMIT, NULL,
-                           getPowerLimit, PRIVILEGE_USER);
+    ipmi::registerGroupHandler(ipmi::prioOpenBmcBase, ipmi::groupDCMI,
+                               ipmi::dcmi::cmdGetPowerLimit,
+                               ipmi::Privilege::User, getPowerLimit);
 
     // <Set Power Limit>
 
-    ipmi_register_callback(NETFUN_GRPEXT, dcmi::Commands::SET_POWER_LIMIT, NULL,
-                           setPowerLimit, PRIVILEGE_OPERATOR);
+    ipmi::registerGroupHandler(ipmi::prioOpenBmcBase, ipmi::groupDCMI,
+                               ipmi::dcmi::cmdSetPowerLimit,
+                               ipmi::Privilege::Operator, setPowerLimit);
 
     // <Activate/Deactivate Power Limit>
 
-    ipmi_register_callback(NETFUN_GRPEXT, dcmi::Commands::APPLY_POWER_LIMIT,
-                           NULL, applyPowerLimit, PRIVILEGE_OPERATOR);
+    ipmi::registerGroupHandler(ipmi::prioOpenBmcBase, ipmi::groupDCMI,
+                               ipmi::dcmi::cmdActDeactivatePwrLimit,
+                               ipmi::Privilege::Operator, applyPowerLimit);
+
+    // <Get Power Cap Statistics>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getPowerCapStatsCmd, ipmi::Privilege::User,
+                             getPowerCapStats);
 
     // <Get Asset Tag>
 
@@ -1431,12 +2013,29 @@ void register_netfn_dcmi_functions()
                            NULL, getDCMICapabilities, PRIVILEGE_USER);
 
     // <Get Temperature Readings>
-    ipmi_register_callback(NETFUN_GRPEXT, dcmi::Commands::GET_TEMP_READINGS,
-                           NULL, getTempReadings, PRIVILEGE_USER);
+    ipmi::registerGroupHandler(ipmi::prioOpenBmcBase, ipmi::groupDCMI,
+                               ipmi::dcmi::cmdGetTemperatureReadings,
+                               ipmi::Privilege::User, getTempReadings);
 
     // <Get Power Reading>
     ipmi_register_callback(NETFUN_GRPEXT, dcmi::Commands::GET_POWER_READING,
                            NULL, getPowerReading, PRIVILEGE_USER);
+    // sample the power reading sensor in the background once the daemon runs
+    post_work([]() {
+        try
+        {
+            if (dcmi::isDCMIPowerMgmtSupported())
+            {
+                powerStatistics = std::make_unique<dcmi::PowerStatistics>(
+                    *getSdBus(), getPowerSensorPath());
+            }
+        }
+        catch (std::exception& e)
+        {
+            log<level::ERR>("Failed to start the power statistics",
+                            entry("ERROR=%s", e.what()));
+        }
+    });
 
     // <Get Sensor Info>
     ipmi_register_callback(NETFUN_GRPEXT, dcmi::Commands::GET_SENSOR_INFO, NULL,
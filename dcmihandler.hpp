@@ -2,8 +2,16 @@
 
 #include "nlohmann/json.hpp"
 
+#include <array>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <ipmid/api.hpp>
+#include <ipmid/types.hpp>
 #include <map>
+#include <memory>
+#include <optional>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <string>
 #include <vector>
 
@@ -35,6 +43,7 @@ static constexpr auto propIntf = "org.freedesktop.DBus.Properties";
 static constexpr auto assetTagIntf =
     "xyz.openbmc_project.Inventory.Decorator.AssetTag";
 static constexpr auto assetTagProp = "AssetTag";
+static constexpr auto inventoryRoot = "/xyz/openbmc_project/inventory/";
 static constexpr auto networkServiceName = "xyz.openbmc_project.Network";
 static constexpr auto networkConfigObj = "/xyz/openbmc_project/network/config";
 static constexpr auto networkConfigIntf =
@@ -190,75 +199,123 @@ std::string readAssetTag();
  */
 void writeAssetTag(const std::string& assetTag);
 
-/** @brief Read the current power cap value
- *
- *  @param[in] bus - dbus connection
- *
- *  @return On success return the power cap value.
- */
-uint32_t getPcap(sdbusplus::bus::bus& bus);
-
-/** @brief Check if the power capping is enabled
- *
- *  @param[in] bus - dbus connection
- *
- *  @return true if the powerCap is enabled and false if the powercap
- *          is disabled.
- */
-bool getPcapEnabled(sdbusplus::bus::bus& bus);
-
-/** @struct GetPowerLimitResponse
- *
- *  DCMI payload for Get Power Limit command response.
- */
-struct GetPowerLimitResponse
-{
-    uint16_t reserved;       //!< Reserved.
-    uint8_t exceptionAction; //!< Exception action.
-    uint16_t powerLimit;     //!< Power limit requested in watts.
-    uint32_t correctionTime; //!< Correction time limit in milliseconds.
-    uint16_t reserved1;      //!< Reserved.
-    uint16_t samplingPeriod; //!< Statistics sampling period in seconds.
-} __attribute__((packed));
-
-/** @brief Set the power cap value
- *
- *  @param[in] bus - dbus connection
- *  @param[in] powerCap - power cap value
- */
-void setPcap(sdbusplus::bus::bus& bus, const uint32_t powerCap);
-
-/** @struct SetPowerLimitRequest
- *
- *  DCMI payload for Set Power Limit command request.
- */
-struct SetPowerLimitRequest
-{
-    uint16_t reserved;       //!< Reserved
-    uint8_t reserved1;       //!< Reserved
-    uint8_t exceptionAction; //!< Exception action.
-    uint16_t powerLimit;     //!< Power limit requested in watts.
-    uint32_t correctionTime; //!< Correction time limit in milliseconds.
-    uint16_t reserved2;      //!< Reserved.
-    uint16_t samplingPeriod; //!< Statistics sampling period in seconds.
-} __attribute__((packed));
-
-/** @brief Enable or disable the power capping
- *
- *  @param[in] bus - dbus connection
- *  @param[in] enabled - enable/disable
- */
-void setPcapEnable(sdbusplus::bus::bus& bus, bool enabled);
+/** @class PowerCap
+ *
+ *  Cache of the power cap settings object, kept in sync through its
+ *  PropertiesChanged signal so the power limit is read without a D-Bus call.
+ *  Updates are sent from the request coroutine and skipped when the value is
+ *  already set. The time the Set call takes and the time until the signal
+ *  reports the new value are recorded, to show how long a cap takes to
+ *  become active.
+ */
+class PowerCap
+{
+  public:
+    /** @struct Latency
+     *
+     *  Latency counters of an operation.
+     */
+    struct Latency
+    {
+        uint32_t count = 0;   //!< number of operations
+        uint64_t totalUs = 0; //!< sum of the latencies in microseconds
+        uint32_t maxUs = 0;   //!< largest latency in microseconds
+
+        /** @brief adds an operation to the counters */
+        void add(std::chrono::steady_clock::duration latency);
+    };
+
+    /** @brief starts tracking the power cap settings object
+     *
+     *  @param[in] bus - dbus connection
+     */
+    explicit PowerCap(sdbusplus::bus::bus& bus);
+
+    PowerCap(const PowerCap&) = delete;
+    PowerCap& operator=(const PowerCap&) = delete;
+
+    /** @brief Read the current power cap value
+     *
+     *  @return the power cap value, throws InternalFailure on failure
+     */
+    uint32_t getPcap();
+
+    /** @brief Check if the power capping is enabled
+     *
+     *  @return true if the powerCap is enabled and false if the powercap
+     *          is disabled, throws InternalFailure on failure
+     */
+    bool getPcapEnabled();
+
+    /** @brief Set the power cap value
+     *
+     *  @param[in] ctx - ipmi context of the request
+     *  @param[in] powerCap - power cap value
+     *
+     *  @return the D-Bus error code
+     */
+    boost::system::error_code setPcap(ipmi::Context::ptr ctx,
+                                      uint32_t powerCap);
+
+    /** @brief Enable or disable the power capping
+     *
+     *  @param[in] ctx - ipmi context of the request
+     *  @param[in] enabled - enable/disable
+     *
+     *  @return the D-Bus error code
+     */
+    boost::system::error_code setPcapEnable(ipmi::Context::ptr ctx,
+                                            bool enabled);
+
+    /** @brief gets the latency of the Set calls */
+    const Latency& setLatency() const
+    {
+        return setStats;
+    }
+
+    /** @brief gets the time from a Set call to the signal of the new value */
+    const Latency& applyLatency() const
+    {
+        return applyStats;
+    }
+
+    /** @brief gets the number of failed Set calls */
+    uint32_t setFailures() const
+    {
+        return failures;
+    }
+
+  private:
+    /** @brief reads the properties, if they are not cached */
+    void load();
+
+    /** @brief updates the cache from the properties of the object */
+    void update(const ipmi::PropertyMap& properties);
+
+    /** @brief sets a property of the power cap object */
+    boost::system::error_code set(ipmi::Context::ptr ctx,
+                                  const std::string& property,
+                                  const ipmi::Value& value);
+
+    sdbusplus::bus::bus& bus;
+    std::unique_ptr<sdbusplus::bus::match_t> propertiesMatch;
+    std::string service;
+    std::optional<uint32_t> powerCap;
+    std::optional<bool> powerCapEnable;
+    // Set calls whose new value was not reported by the signal yet
+    std::map<std::string, std::pair<ipmi::Value,
+                                    std::chrono::steady_clock::time_point>>
+        pendingApply;
+    Latency setStats;
+    Latency applyStats;
+    uint32_t failures = 0;
+};
 
-/** @struct ApplyPowerLimitRequest
+/** @brief Gets the power cap settings cache
  *
- *  DCMI payload for Activate/Deactivate Power Limit command request.
+ *  @return the process wide cache
  */
-struct ApplyPowerLimitRequest
-{
-    uint8_t powerLimitAction; //!< Power limit activation
-    uint16_t reserved;        //!< Reserved
-} __attribute__((packed));
+PowerCap& getPowerCap();
 
 /** @struct GetMgmntCtrlIdStrRequest
  *
@@ -359,85 +416,152 @@ struct DCMICapEntry
 
 using DCMICaps = std::map<DCMICapParameters, DCMICapEntry>;
 
-/** @struct GetTempReadingsRequest
+/** @brief Parse out JSON config file.
+ *
+ *  @param[in] configFile - JSON config file name
  *
- *  DCMI payload for Get Temperature Readings request
+ *  @return A json object
  */
-struct GetTempReadingsRequest
-{
-    uint8_t sensorType;     //!< Type of the sensor
-    uint8_t entityId;       //!< Entity ID
-    uint8_t entityInstance; //!< Entity Instance (0 means all instances)
-    uint8_t instanceStart;  //!< Instance start (used if instance is 0)
-} __attribute__((packed));
+Json parseJSONConfig(const std::string& configFile);
 
-/** @struct GetTempReadingsResponse
+/** @struct SensorBinding
  *
- *  DCMI header for Get Temperature Readings response
+ *  DCMI sensor of an entity instance, from the DCMI sensors config.
  */
-struct GetTempReadingsResponseHdr
+struct SensorBinding
 {
-    uint8_t numInstances; //!< No. of instances for requested id
-    uint8_t numDataSets;  //!< No. of sets of temperature data
-} __attribute__((packed));
+    uint8_t instance;    //!< Entity instance number
+    std::string path;    //!< D-Bus object path of the sensor
+    std::string service; //!< D-Bus service, resolved on first read
+    uint16_t recordId;   //!< SDR record id
+};
 
-/** @brief Parse out JSON config file.
- *
- *  @param[in] configFile - JSON config file name
+using SensorBindings = std::vector<SensorBinding>;
+
+/** @class Config
+ *
+ *  DCMI capabilities and sensors configuration, parsed once into typed
+ *  structures. An inotify watch on the configuration directory reports the
+ *  changes to the files, which are parsed again on the next access.
+ */
+class Config
+{
+  public:
+    Config();
+    ~Config();
+
+    Config(const Config&) = delete;
+    Config& operator=(const Config&) = delete;
+
+    /** @brief gets the DCMI capabilities config
+     *
+     *  @return the parsed capabilities config, throws InternalFailure if the
+     *          file can't be parsed
+     */
+    const Json& capabilities();
+
+    /** @brief gets the Get DCMI Capabilities Info response of a parameter,
+     *         encoded from the capabilities config once per parse
+     *
+     *  @param[in] param - the parameter selector
+     *
+     *  @return the response data, nullptr for an unknown parameter; throws
+     *          InternalFailure if the file can't be parsed
+     */
+    const std::vector<uint8_t>* capabilityResponse(DCMICapParameters param);
+
+    /** @brief gets the sensors of an entity type
+     *
+     *  @param[in] type - one of "inlet", "cpu", "baseboard"
+     *
+     *  @return the sensors ordered as in the config, throws InternalFailure
+     *          if the file can't be parsed; they stay valid while held,
+     *          even when the file is parsed again during a yield
+     */
+    std::shared_ptr<SensorBindings> sensors(const std::string& type);
+
+  private:
+    /** @brief drops the parsed files that changed since the last access */
+    void update();
+
+    int inotifyFd = -1;
+    std::optional<Json> caps;
+    std::optional<std::map<DCMICapParameters, std::vector<uint8_t>>>
+        capsResponses;
+    std::shared_ptr<std::map<std::string, SensorBindings>> sensorMap;
+};
+
+/** @brief Gets the DCMI configuration
  *
- *  @return A json object
+ *  @return the process wide configuration
  */
-Json parseJSONConfig(const std::string& configFile);
+Config& getConfig();
 
 namespace temp_readings
 {
-/** @brief Read temperature from a d-bus object, scale it as per dcmi
- *         get temperature reading requirements.
+/** @brief Scale a temperature sensor reading as per dcmi get temperature
+ *         reading requirements.
  *
- *  @param[in] dbusService - the D-Bus service
- *  @param[in] dbusPath - the D-Bus path
+ *  @param[in] properties - the xyz.openbmc_project.Sensor.Value properties
  *
  *  @return A temperature reading
  */
-Temperature readTemp(const std::string& dbusService,
-                     const std::string& dbusPath);
+Temperature toTemperature(const ipmi::PropertyMap& properties);
+
+/** @brief Read the temperatures of DCMI sensors, the D-Bus calls for all the
+ *         sensors are issued at once so the reads take a single round trip.
+ *
+ *  @param[in] ctx - ipmi context of the request
+ *  @param[in] sensors - DCMI sensors to read, of a Config::sensors snapshot
+ *                       the caller holds
+ *
+ *  @return The readings in the order of the sensors, std::nullopt for a
+ *          sensor that couldn't be read.
+ */
+std::vector<std::optional<Temperature>>
+    readTemps(ipmi::Context::ptr ctx,
+              const std::vector<SensorBinding*>& sensors);
 
 /** @brief Read temperatures and fill up DCMI response for the Get
  *         Temperature Readings command. This looks at a specific
  *         instance.
  *
+ *  @param[in] ctx - ipmi context of the request
  *  @param[in] type - one of "inlet", "cpu", "baseboard"
  *  @param[in] instance - A non-zero Entity instance number
  *
  *  @return A tuple, containing a temperature reading and the
  *          number of instances.
  */
-std::tuple<Response, NumInstances> read(const std::string& type,
+std::tuple<Response, NumInstances> read(ipmi::Context::ptr ctx,
+                                        const std::string& type,
                                         uint8_t instance);
 
 /** @brief Read temperatures and fill up DCMI response for the Get
  *         Temperature Readings command. This looks at a range of
  *         instances.
  *
+ *  @param[in] ctx - ipmi context of the request
  *  @param[in] type - one of "inlet", "cpu", "baseboard"
  *  @param[in] instanceStart - Entity instance start index
  *
  *  @return A tuple, containing a list of temperature readings and the
  *          number of instances.
  */
-std::tuple<ResponseList, NumInstances> readAll(const std::string& type,
+std::tuple<ResponseList, NumInstances> readAll(ipmi::Context::ptr ctx,
+                                               const std::string& type,
                                                uint8_t instanceStart);
 } // namespace temp_readings
 
 namespace sensor_info
 {
-/** @brief Create response from JSON config.
+/** @brief Create response from a DCMI sensor.
  *
- *  @param[in] config - JSON config info about DCMI sensors
+ *  @param[in] sensor - DCMI sensor from the config
  *
  *  @return Sensor info response
  */
-Response createFromJson(const Json& config);
+Response createFromBinding(const SensorBinding& sensor);
 
 /** @brief Read sensor info and fill up DCMI response for the Get
  *         Sensor Info command. This looks at a specific
@@ -445,13 +569,12 @@ Response createFromJson(const Json& config);
  *
  *  @param[in] type - one of "inlet", "cpu", "baseboard"
  *  @param[in] instance - A non-zero Entity instance number
- *  @param[in] config - JSON config info about DCMI sensors
  *
  *  @return A tuple, containing a sensor info response and
  *          number of instances.
  */
 std::tuple<Response, NumInstances> read(const std::string& type,
-                                        uint8_t instance, const Json& config);
+                                        uint8_t instance);
 
 /** @brief Read sensor info and fill up DCMI response for the Get
  *         Sensor Info command. This looks at a range of
@@ -459,13 +582,12 @@ std::tuple<Response, NumInstances> read(const std::string& type,
  *
  *  @param[in] type - one of "inlet", "cpu", "baseboard"
  *  @param[in] instanceStart - Entity instance start index
- *  @param[in] config - JSON config info about DCMI sensors
  *
  *  @return A tuple, containing a list of sensor info responses and the
  *          number of instances.
  */
-std::tuple<ResponseList, NumInstances>
-    readAll(const std::string& type, uint8_t instanceStart, const Json& config);
+std::tuple<ResponseList, NumInstances> readAll(const std::string& type,
+                                               uint8_t instanceStart);
 } // namespace sensor_info
 
 /** @brief Read power reading from power reading sensor object
@@ -476,6 +598,86 @@ std::tuple<ResponseList, NumInstances>
  */
 int64_t getPowerReading(sdbusplus::bus::bus& bus);
 
+/** @class PowerStatistics
+ *
+ *  Rolling statistics of the power reading sensor. The sensor value is
+ *  tracked through its PropertiesChanged signal and sampled once every
+ *  sampleInterval into a fixed size ring buffer, so the minimum, maximum and
+ *  average power over any period up to the buffer length are computed
+ *  without a D-Bus call.
+ */
+class PowerStatistics
+{
+  public:
+    /** @struct Stats
+     *
+     *  Power statistics over a period, in watts.
+     */
+    struct Stats
+    {
+        uint16_t current;
+        uint16_t minimum;
+        uint16_t maximum;
+        uint16_t average;
+        uint32_t timeStamp; //!< time of the newest sample, seconds since epoch
+        uint32_t timeFrame; //!< period covered by the samples in milliseconds
+    };
+
+    static constexpr std::chrono::seconds sampleInterval{1};
+    static constexpr size_t maxSamples = 3600;
+
+    /** @brief starts sampling the power reading sensor
+     *
+     *  @param[in] bus - dbus connection
+     *  @param[in] objectPath - power reading sensor object path
+     */
+    PowerStatistics(sdbusplus::bus::bus& bus, const std::string& objectPath);
+
+    PowerStatistics(const PowerStatistics&) = delete;
+    PowerStatistics& operator=(const PowerStatistics&) = delete;
+
+    /** @brief gets the statistics over a period
+     *
+     *  @param[in] period - statistics period, limited to the collected
+     *                      samples
+     *
+     *  @return the statistics, std::nullopt if no sample was collected yet
+     */
+    std::optional<Stats> get(std::chrono::seconds period) const;
+
+  private:
+    /** @brief reads the sensor value and scale, done until it succeeds */
+    void readSensor();
+
+    /** @brief adds the current sensor value to the samples */
+    void sample();
+
+    /** @brief arms the timer for the next sample */
+    void schedule();
+
+    sdbusplus::bus::bus& bus;
+    std::string objectPath;
+    std::unique_ptr<sdbusplus::bus::match_t> valueMatch;
+    boost::asio::steady_timer timer;
+    std::optional<double> value;
+    int64_t scale = 0;
+    bool scaleKnown = false;
+    std::array<uint16_t, maxSamples> samples{};
+    size_t next = 0;        //!< index of the next sample to write
+    size_t sampleCount = 0; //!< number of valid samples
+    uint32_t lastSampleTime = 0;
+};
+
+/** @enum PowerReadingMode
+ *
+ *  DCMI Get Power Reading modes
+ */
+enum class PowerReadingMode : uint8_t
+{
+    SYSTEM_POWER_STATISTICS = 0x01,          //!< Since sampling started
+    ENHANCED_SYSTEM_POWER_STATISTICS = 0x02, //!< Over a rolling period
+};
+
 /** @struct GetPowerReadingRequest
  *
  *  DCMI Get Power Reading command request.
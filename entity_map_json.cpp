@@ -1,11 +1,14 @@
 #include "entity_map_json.hpp"
 
+#include <algorithm>
 #include <exception>
 #include <fstream>
 #include <ipmid/types.hpp>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <tuple>
 #include <utility>
 
 namespace ipmi
@@ -15,17 +18,13 @@ namespace sensor
 
 EntityInfoMapContainer* EntityInfoMapContainer::getContainer()
 {
+    static std::once_flag loaded;
     static std::unique_ptr<EntityInfoMapContainer> instance;
 
-    if (!instance)
-    {
-        /* TODO: With multi-threading this would all need to be locked so
-         * the first thread to hit it would set it up.
-         */
-        EntityInfoMap builtEntityMap = buildEntityMapFromFile();
+    std::call_once(loaded, []() {
         instance = std::unique_ptr<EntityInfoMapContainer>(
-            new EntityInfoMapContainer(builtEntityMap));
-    }
+            new EntityInfoMapContainer(buildEntityMapFromFile()));
+    });
 
     return instance.get();
 }
@@ -35,6 +34,67 @@ const EntityInfoMap& EntityInfoMapContainer::getIpmiEntityRecords()
     return entityRecords;
 }
 
+std::pair<EntityIndex::const_iterator, EntityIndex::const_iterator>
+    EntityInfoMapContainer::findEntity(uint8_t entityId,
+                                       uint8_t entityInstance) const
+{
+    return sensor::findEntity(entityIndex, entityId, entityInstance);
+}
+
+std::pair<EntityIndex::const_iterator, EntityIndex::const_iterator>
+    findEntity(const EntityIndex& index, uint8_t entityId,
+               uint8_t entityInstance)
+{
+    auto byEntity = [](const EntityRecordRef& a, const EntityRecordRef& b) {
+        return std::tie(a.entityId, a.entityInstance) <
+               std::tie(b.entityId, b.entityInstance);
+    };
+    return std::equal_range(index.begin(), index.end(),
+                            EntityRecordRef{entityId, entityInstance, 0},
+                            byEntity);
+}
+
+EntityIndex buildEntityIndex(const EntityInfoMap& entityRecords)
+{
+    EntityIndex index;
+    for (const auto& [recordId, info] : entityRecords)
+    {
+        index.push_back({info.containerEntityId, info.containerEntityInstance,
+                         recordId});
+        const auto& entities = info.containedEntities;
+        for (size_t i = 0; i < entities.size(); i++)
+        {
+            auto [entityId, entityInstance] = entities[i];
+            if (entityId == 0)
+            {
+                continue;
+            }
+            // a range starts at an even slot and ends at the next one
+            uint8_t last = entityInstance;
+            if (!info.isList && i % 2 == 0 && i + 1 < entities.size() &&
+                entities[i + 1].first == entityId &&
+                entities[i + 1].second > entityInstance)
+            {
+                last = entities[++i].second;
+            }
+            for (unsigned instance = entityInstance; instance <= last;
+                 instance++)
+            {
+                index.push_back(
+                    {entityId, static_cast<uint8_t>(instance), recordId});
+            }
+        }
+    }
+    std::sort(index.begin(), index.end());
+    index.erase(std::unique(index.begin(), index.end(),
+                            [](const EntityRecordRef& a,
+                               const EntityRecordRef& b) {
+                                return !(a < b) && !(b < a);
+                            }),
+                index.end());
+    return index;
+}
+
 EntityInfoMap buildEntityMapFromFile()
 {
     const char* entityMapJsonFilename =
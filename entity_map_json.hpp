@@ -3,6 +3,9 @@
 #include <ipmid/types.hpp>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace ipmi
 {
@@ -34,23 +37,87 @@ EntityInfoMap buildEntityMapFromFile();
  */
 EntityInfoMap buildJsonEntityMap(const nlohmann::json& data);
 
+/**
+ * @brief An entity of an entity association record.
+ */
+struct EntityRecordRef
+{
+    uint8_t entityId;
+    uint8_t entityInstance;
+    Id recordId;
+
+    bool operator<(const EntityRecordRef& other) const
+    {
+        return std::tie(entityId, entityInstance, recordId) <
+               std::tie(other.entityId, other.entityInstance, other.recordId);
+    }
+};
+
+using EntityIndex = std::vector<EntityRecordRef>;
+
+/**
+ * @brief Index the container and contained entities of the entity map.
+ *
+ * Unused contained entity slots (entity ID 0) are skipped. The contained
+ * entities of a record that is not a list are two ranges, the first and
+ * second entity and the third and fourth, and every instance of a range is
+ * indexed.
+ *
+ * @param[in] entityRecords - the entity map
+ * @return the entities sorted by entity ID, instance and record ID
+ */
+EntityIndex buildEntityIndex(const EntityInfoMap& entityRecords);
+
+/**
+ * @brief Find the entity association records an entity is part of.
+ *
+ * @param[in] index - the entity index
+ * @param[in] entityId - entity ID
+ * @param[in] entityInstance - entity instance
+ * @return the range of the entity index for the entity, in record order
+ */
+std::pair<EntityIndex::const_iterator, EntityIndex::const_iterator>
+    findEntity(const EntityIndex& index, uint8_t entityId,
+               uint8_t entityInstance);
+
 /**
  * @brief Owner of the EntityInfoMap.
+ *
+ * The map is loaded once, at startup from the event loop or by the first
+ * request that needs it, whichever comes first.
  */
 class EntityInfoMapContainer
 {
   public:
-    /** Get ahold of the owner. */
+    /** Get ahold of the owner, loading the entity map on first use. */
     static EntityInfoMapContainer* getContainer();
     /** Get ahold of the records. */
     const EntityInfoMap& getIpmiEntityRecords();
 
+    /** Get the entities of the records, sorted by entity ID and instance. */
+    const EntityIndex& getEntityIndex() const
+    {
+        return entityIndex;
+    }
+
+    /**
+     * @brief Find the entity association records an entity is part of.
+     *
+     * @param[in] entityId - entity ID
+     * @param[in] entityInstance - entity instance
+     * @return the range of the entity index for the entity, in record order
+     */
+    std::pair<EntityIndex::const_iterator, EntityIndex::const_iterator>
+        findEntity(uint8_t entityId, uint8_t entityInstance) const;
+
   private:
-    EntityInfoMapContainer(const EntityInfoMap& entityRecords) :
-        entityRecords(entityRecords)
+    EntityInfoMapContainer(EntityInfoMap&& entityRecords) :
+        entityRecords(std::move(entityRecords)),
+        entityIndex(buildEntityIndex(this->entityRecords))
     {
     }
     EntityInfoMap entityRecords;
+    EntityIndex entityIndex;
 };
 
 } // namespace sensor
@@ -7,20 +7,36 @@
 #include <string>
 #include <vector>
 
+#ifdef STATIC_FRU_TABLE
+#include "statictable.hpp"
+
+#include <string_view>
+
+// the generated FRU table is a tree of constexpr arrays, its strings point
+// into one string pool
+using FruString = std::string_view;
+template <typename T>
+using FruList = ipmi::TableView<T>;
+#else
+using FruString = std::string;
+template <typename T>
+using FruList = std::vector<T>;
+#endif
+
 struct IPMIFruData
 {
-    std::string section;
-    std::string property;
-    std::string delimiter;
+    FruString section;
+    FruString property;
+    FruString delimiter;
 };
 
-using DbusProperty = std::string;
-using DbusPropertyVec = std::vector<std::pair<DbusProperty, IPMIFruData>>;
+using DbusProperty = FruString;
+using DbusPropertyVec = FruList<std::pair<DbusProperty, IPMIFruData>>;
 
-using DbusInterface = std::string;
-using DbusInterfaceVec = std::vector<std::pair<DbusInterface, DbusPropertyVec>>;
+using DbusInterface = FruString;
+using DbusInterfaceVec = FruList<std::pair<DbusInterface, DbusPropertyVec>>;
 
-using FruInstancePath = std::string;
+using FruInstancePath = FruString;
 
 struct FruInstance
 {
@@ -30,7 +46,11 @@ struct FruInstance
     DbusInterfaceVec interfaces;
 };
 
-using FruInstanceVec = std::vector<FruInstance>;
+using FruInstanceVec = FruList<FruInstance>;
 
 using FruId = uint32_t;
+#ifdef STATIC_FRU_TABLE
+using FruMap = ipmi::SortedTable<FruId, FruInstanceVec>;
+#else
 using FruMap = std::map<FruId, FruInstanceVec>;
+#endif
@@ -9,7 +9,10 @@ fi
 cat << EOF
 #include <ipmiwhitelist.hpp>
 
-const std::vector<netfncmd_pair> whitelist = {
+namespace
+{
+
+constexpr netfncmd_pair whitelistEntries[] = {
 
 EOF
 
@@ -24,4 +27,10 @@ cat $* | sed "s/#.*//" | sed '/^$/d' | sort -n | uniq | sed "s/^/    { /" | \
 
 cat << EOF
 };
+
+} // namespace
+
+// constant initialized, built at compile time
+constexpr WhitelistBits whitelistBits = makeWhitelist(whitelistEntries);
+const WhitelistBits whitelist = whitelistBits;
 EOF
@@ -4,7 +4,11 @@
 
 #include "systemintfcmds.hpp"
 
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <charconv>
 #include <chrono>
+#include <ipmid/api.hpp>
 #include <ipmid/utils.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
@@ -23,7 +27,7 @@ namespace command
 constexpr auto MAPPER_BUSNAME = "xyz.openbmc_project.ObjectMapper";
 constexpr auto MAPPER_PATH = "/xyz/openbmc_project/object_mapper";
 constexpr auto MAPPER_INTERFACE = "xyz.openbmc_project.ObjectMapper";
-constexpr auto HOST_STATE_PATH = "/xyz/openbmc_project/state/host0";
+constexpr auto HOST_STATE_ROOT = "/xyz/openbmc_project/state/";
 constexpr auto HOST_STATE_INTERFACE = "xyz.openbmc_project.State.Host";
 constexpr auto HOST_TRANS_PROP = "RequestedHostTransition";
 constexpr auto SMS_SET_ATTENTION = "setAttention";
@@ -36,115 +40,287 @@ using InternalFailure =
 
 namespace sdbusRule = sdbusplus::bus::match::rules;
 
-Manager::Manager(sdbusplus::bus::bus& bus) :
-    bus(bus), timer(std::bind(&Manager::hostTimeout, this)),
+HostId hostOfChannel(std::string_view channelName)
+{
+    constexpr std::string_view kcs = "kcs";
+    size_t pos = channelName.rfind(kcs);
+    if (pos == std::string_view::npos)
+    {
+        return 0;
+    }
+    const char* end = channelName.data() + channelName.size();
+    HostId number = 0;
+    auto [parsed, ec] =
+        std::from_chars(channelName.data() + pos + kcs.size(), end, number);
+    if (ec != std::errc() || parsed != end || number == 0 ||
+        number > CONTROL_HOST_INSTANCES)
+    {
+        return 0;
+    }
+    return number - 1;
+}
+
+Manager::HostQueue::HostQueue(Manager& manager, HostId hostId) :
+    hostId(hostId), timer([&manager, this]() { manager.hostTimeout(*this); }),
     hostTransitionMatch(
-        bus,
-        sdbusRule::propertiesChanged(HOST_STATE_PATH, HOST_STATE_INTERFACE),
-        std::bind(&Manager::clearQueueOnPowerOn, this, std::placeholders::_1))
+        manager.bus,
+        sdbusRule::propertiesChanged(HOST_STATE_ROOT + std::string{HOST_NAME} +
+                                         std::to_string(hostId),
+                                     HOST_STATE_INTERFACE),
+        [&manager, this](sdbusplus::message::message& msg) {
+            manager.clearQueueOnPowerOn(*this, msg);
+        })
 {
-    // Nothing to do here.
 }
 
-// Called as part of READ_MSG_DATA command
-IpmiCmdData Manager::getNextCommand()
+Manager::Manager(sdbusplus::bus::bus& bus) : bus(bus)
 {
-    // Stop the timer. Don't have to Err failure doing so.
-    auto r = timer.stop();
-    if (r < 0)
+    // the single host systems only ever use host 0
+    queueOf(0);
+}
+
+Manager::HostQueue& Manager::queueOf(HostId hostId)
+{
+    auto& host = hosts[hostId];
+    if (!host)
     {
-        log<level::ERR>("Failure to STOP the timer",
-                        entry("ERROR=%s", strerror(-r)));
+        host = std::make_unique<HostQueue>(*this, hostId);
     }
+    return *host;
+}
+
+// Attention cycles a command may time out at the head of the queue
+constexpr unsigned int maxAttempts = 3;
+
+/** @brief gives the priority class of a command */
+static Priority priorityOf(const IpmiCmdData& command)
+{
+    return command.first == CMD_POWER ? Priority::Power : Priority::Normal;
+}
+
+/** @brief encodes the Read Event Message Buffer response passing a command
+ *         to the host, the OEM SEL skiboot reads
+ */
+static EventRecord encode(const IpmiCmdData& command)
+{
+    // per IPMI spec NetFuntion for OEM
+    constexpr uint8_t netFn = 0x3A;
+
+    // either id[0] -or- id[1] can be filled in, both bytes hold
+    // SEL_OEM_ID_0. The 3 bytes after the record type are the IANA
+    // Manufacture_Id 00A741h, the timestamp is unused and so are the last
+    // 3 bytes, all '0xFF'.
+    return {SEL_OEM_ID_0,  SEL_OEM_ID_0,   SEL_RECORD_TYPE_OEM,
+            0x41,          0xA7,           0x00,
+            0x00,          0x00,           0x00,
+            0x00,          netFn,          command.first,
+            command.second, 0xFF,          0xFF,
+            0xFF};
+}
 
-    if (this->workQueue.empty())
+// Called as part of READ_MSG_DATA command
+EventRecord Manager::readEvent(HostId hostId)
+{
+    auto& host = queueOf(hostId);
+    std::optional<EventRecord> record = host.ring.pop();
+    if (!record)
     {
         // Just return a heartbeat in this case.  A spurious SMS_ATN was
         // asserted for the host (probably from a previous boot).
-        log<level::DEBUG>("Control Host work queue is empty!");
+        host.spuriousRead = true;
+    }
 
-        return std::make_pair(CMD_HEARTBEAT, 0x00);
+    // the callbacks, the next command and SMS_ATN are taken care of once
+    // the response is on its way
+    if (!host.reapPosted.exchange(true))
+    {
+        boost::asio::post(*getIoContext(), [this, &host]() { reap(host); });
     }
 
+    return record ? *record : encode(std::make_pair(CMD_HEARTBEAT, 0x00));
+}
+
+void Manager::complete(HostQueue& host, bool status)
+{
     // Pop the processed entry off the queue
-    auto command = this->workQueue.front();
-    this->workQueue.pop();
+    auto head = std::move(host.staged.front());
+    host.staged.pop_front();
+    host.completed++;
+
+    for (const auto& callBack : head.callbacks)
+    {
+        callBack(head.command, status);
+    }
+}
 
-    // IPMI command is the first element in pair
-    auto ipmiCmdData = std::get<0>(command);
+void Manager::stage(HostQueue& host)
+{
+    while (!host.workQueue.empty() &&
+           host.ring.push(encode(host.workQueue.front().command)))
+    {
+        host.staged.emplace_back(std::move(host.workQueue.front()));
+        host.workQueue.pop_front();
+    }
+}
+
+void Manager::reap(HostQueue& host)
+{
+    host.reapPosted = false;
 
     // Now, call the user registered functions so that
     // implementation specific CommandComplete signals
     // can be sent. `true` indicating Success.
-    std::get<CallBack>(command)(ipmiCmdData, true);
+    size_t taken = host.ring.taken();
+    while (host.completed < taken && !host.staged.empty())
+    {
+        complete(host, true);
+    }
+    stage(host);
 
-    // Check for another entry in the queue and kick it off
-    this->checkQueueAndAlertHost();
+    if (host.spuriousRead.exchange(false) && host.ring.empty())
+    {
+        log<level::DEBUG>("Control Host work queue is empty!",
+                          entry("HOST=%u", host.hostId));
+        this->sendAttention(host, Attention::Clear, true);
+    }
 
-    // Tuple of command and data
-    return ipmiCmdData;
+    // Check for another entry in the queue and kick it off, the attention
+    // stays asserted so the host can read it right away
+    this->checkQueueAndAlertHost(host);
 }
 
 // Called when initial timer goes off post sending SMS_ATN
-void Manager::hostTimeout()
+void Manager::hostTimeout(HostQueue& host)
 {
-    log<level::ERR>("Host control timeout hit!");
+    if (host.ring.taken() != host.armedAt)
+    {
+        // the host read commands since the timer was armed, the one now at
+        // the head gets a full timeout of its own
+        reap(host);
+        return;
+    }
+    if (host.staged.empty())
+    {
+        return;
+    }
 
-    clearQueue();
-}
+    auto& head = host.staged.front();
+    head.timeouts++;
+    log<level::ERR>("Host control timeout hit!",
+                    entry("HOST=%u", host.hostId),
+                    entry("COMMAND=%d", head.command.first),
+                    entry("ATTEMPT=%u", head.timeouts));
 
-void Manager::clearQueue()
-{
-    // Dequeue all entries and send fail signal
-    while (!this->workQueue.empty())
+    if (head.timeouts >= maxAttempts)
     {
-        auto command = this->workQueue.front();
-        this->workQueue.pop();
+        // Call the implementation specific Command Failure.
+        // `false` indicating Failure, unless the host read it meanwhile
+        complete(host, !host.ring.drop(host.completed));
+        reap(host);
+        return;
+    }
 
-        // IPMI command is the first element in pair
-        auto ipmiCmdData = std::get<0>(command);
+    // The host may have missed the attention, assert it again
+    this->checkQueueAndAlertHost(host, true);
+}
 
-        // Call the implementation specific Command Failure.
-        // `false` indicating Failure
-        std::get<CallBack>(command)(ipmiCmdData, false);
+void Manager::clearQueue(HostQueue& host)
+{
+    // Dequeue all entries and send fail signal, but to the ones the host
+    // read already
+    while (!host.staged.empty())
+    {
+        complete(host, !host.ring.drop(host.completed));
     }
-    this->sendAttention(Attention::Clear);
+    for (auto& entry : host.workQueue)
+    {
+        for (const auto& callBack : entry.callbacks)
+        {
+            callBack(entry.command, false);
+        }
+    }
+    host.workQueue.clear();
+    this->sendAttention(host, Attention::Clear, true);
 }
 
 // Called for alerting the host
-void Manager::checkQueueAndAlertHost()
+void Manager::checkQueueAndAlertHost(HostQueue& host, bool force)
 {
-    if (this->workQueue.size() >= 1)
+    if (!host.ring.empty())
     {
-        // Start the timer for this transaction
-        auto time = std::chrono::duration_cast<std::chrono::microseconds>(
-            std::chrono::seconds(IPMI_SMS_ATN_ACK_TIMEOUT_SECS));
-
-        auto r = timer.start(time);
-        if (r < 0)
+        if (force || !host.timer.isRunning())
         {
-            log<level::ERR>("Error starting timer for control host");
-            return;
+            // Start the timer for this transaction
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::seconds(IPMI_SMS_ATN_ACK_TIMEOUT_SECS));
+
+            host.armedAt = host.ring.taken();
+            auto r = host.timer.start(time);
+            if (r < 0)
+            {
+                log<level::ERR>("Error starting timer for control host",
+                                entry("HOST=%u", host.hostId));
+                return;
+            }
         }
-        this->sendAttention(Attention::Set);
+        this->sendAttention(host, Attention::Set, force);
     }
     else
-        this->sendAttention(Attention::Clear);
+    {
+        if (host.timer.isRunning())
+        {
+            // Stop the timer. Don't have to Err failure doing so.
+            auto r = host.timer.stop();
+            if (r < 0)
+            {
+                log<level::ERR>("Failure to STOP the timer",
+                                entry("ERROR=%s", strerror(-r)));
+            }
+        }
+        this->sendAttention(host, Attention::Clear);
+    }
 }
 
 // Called by specific implementations that provide commands
-void Manager::execute(CommandHandler command)
+void Manager::execute(CommandHandler command, HostId hostId)
 {
-    log<level::DEBUG>("Pushing cmd on to queue",
-                      entry("COMMAND=%d", std::get<0>(command).first));
+    auto& ipmiCmdData = std::get<IpmiCmdData>(command);
+    auto& callBack = std::get<CallBack>(command);
+    auto& host = queueOf(hostId);
+
+    // A command that is already queued is passed to the host once
+    for (auto* queue : {&host.staged, &host.workQueue})
+    {
+        for (auto& queued : *queue)
+        {
+            if (queued.command == ipmiCmdData)
+            {
+                log<level::DEBUG>("Command already queued",
+                                  entry("COMMAND=%d", ipmiCmdData.first));
+                queued.callbacks.emplace_back(std::move(callBack));
+                return;
+            }
+        }
+    }
+
+    log<level::DEBUG>("Pushing cmd on to queue", entry("HOST=%u", hostId),
+                      entry("COMMAND=%d", ipmiCmdData.first));
 
-    this->workQueue.emplace(command);
+    // Queue behind the commands of the same or a higher priority
+    auto priority = priorityOf(ipmiCmdData);
+    auto pos = std::find_if(
+        host.workQueue.begin(), host.workQueue.end(),
+        [priority](const Entry& e) { return e.priority > priority; });
+    bool wasEmpty = host.ring.empty();
+    host.workQueue.insert(
+        pos, Entry{ipmiCmdData, priority, {std::move(callBack)}, 0});
+    stage(host);
 
     // Alert host if this is only command in queue otherwise host will
     // be notified of next message after processing the current one
-    if (this->workQueue.size() == 1)
+    if (wasEmpty)
     {
-        this->checkQueueAndAlertHost();
+        this->checkQueueAndAlertHost(host);
     }
     else
     {
@@ -154,7 +330,8 @@ void Manager::execute(CommandHandler command)
     return;
 }
 
-void Manager::clearQueueOnPowerOn(sdbusplus::message::message& msg)
+void Manager::clearQueueOnPowerOn(HostQueue& host,
+                                  sdbusplus::message::message& msg)
 {
     namespace server = sdbusplus::xyz::openbmc_project::State::server;
 
@@ -174,17 +351,25 @@ void Manager::clearQueueOnPowerOn(sdbusplus::message::message& msg)
     if (server::Host::convertTransitionFromString(requestedState) ==
         server::Host::Transition::On)
     {
-        if (!this->workQueue.empty())
-            clearQueue();
+        if (!host.staged.empty() || !host.workQueue.empty())
+            clearQueue(host);
     }
 }
 
-void Manager::sendAttention(Attention attention)
+void Manager::sendAttention(HostQueue& host, Attention attention, bool force)
 {
+    bool set = attention == Attention::Set;
+    if (set == host.attentionSet && !force)
+    {
+        return;
+    }
+
     std::string service;
     log<level::DEBUG>("Asserting SMS Attention:", entry("ATN=%u", attention));
 
-    std::string IPMI_PATH("/xyz/openbmc_project/Ipmi/Channel/kcs1");
+    // host N reads its commands on the system interface kcs<N + 1>
+    std::string IPMI_PATH("/xyz/openbmc_project/Ipmi/Channel/kcs" +
+                          std::to_string(host.hostId + 1));
     std::string IPMI_INTERFACE("xyz.openbmc_project.Ipmi.Channel.SMS");
     auto atn = attention==Attention::Set ?
         SMS_SET_ATTENTION : SMS_CLEAR_ATTENTION;
@@ -202,6 +387,7 @@ void Manager::sendAttention(Attention attention)
             log<level::ERR>("Error in setting SMS attention, ", entry("ATN=%s", atn));
             elog<InternalFailure>();
         }
+        host.attentionSet = set;
     }
     catch (sdbusplus::exception::SdBusError& e)
     {
@@ -1,11 +1,18 @@
 #pragma once
 
+#include "host-event-ring.hpp"
+
+#include <atomic>
+#include <deque>
 #include <ipmid-host/cmd-utils.hpp>
-#include <queue>
+#include <map>
+#include <memory>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/timer.hpp>
+#include <string_view>
 #include <tuple>
+#include <vector>
 
 namespace phosphor
 {
@@ -15,8 +22,47 @@ namespace command
 {
 
 enum class Attention:unsigned int {Set, Clear};
+
+/** @brief the host reading its commands on a system interface channel
+ *
+ *  Host N reads them on kcs<N + 1>, the channel named after it; a channel
+ *  named otherwise, or after a host out of CONTROL_HOST_INSTANCES, serves
+ *  host 0.
+ *
+ *  @param[in] channelName - name of the system interface channel
+ */
+HostId hostOfChannel(std::string_view channelName);
+
+/** @brief Order in which queued commands are passed to the host, power
+ *         control goes ahead of everything else
+ */
+enum class Priority
+{
+    Power,
+    Normal,
+};
+
 /** @class
  *  @brief Manages commands that are to be sent to Host
+ *
+ *  @detail Commands are queued by priority and in order of arrival within
+ *          a priority. A command that is already queued is not queued
+ *          again, the callbacks of both requests are invoked when it is
+ *          passed to the host. SMS_ATN stays asserted as long as commands
+ *          are queued, so the host can read several of them for a single
+ *          attention. A timeout accounts against the command at the head
+ *          of the queue only, which is failed once it ran out of attempts.
+ *
+ *          Every host has a queue, SMS_ATN and timer of its own, so a slow
+ *          host does not hold up the commands to the others.
+ *
+ *          The head of a queue is staged, encoded, in a ring the Read Event
+ *          Message Buffer handler takes its records from without calling
+ *          back into the manager. The callbacks of the commands the host
+ *          read run afterwards from the io context, where the ring is
+ *          refilled. The timer is armed when the ring fills and stopped
+ *          when it empties; on expiry the reads since it was armed tell
+ *          whether the host made progress.
  */
 class Manager
 {
@@ -35,47 +81,161 @@ class Manager
      */
     explicit Manager(sdbusplus::bus::bus& bus);
 
-    /** @brief  Extracts the next entry in the queue and returns
-     *          Command and data part of it.
+    /** @brief  Takes the next record staged for a host, a heartbeat if
+     *          there is none
+     *
+     *  @detail The registered handlers are called from the io context
+     *          afterwards, so that they can send the CommandComplete signal
+     *          since the interface contract is that we emit this signal
+     *          once the message has been passed to the host. The next
+     *          command is staged then too.
      *
-     *  @detail Also calls into the registered handlers so that they can now
-     *          send the CommandComplete signal since the interface contract
-     *          is that we emit this signal once the message has been
-     *          passed to the host (which is required when calling this)
+     *  @param[in] hostId - the host reading the command
+     *
+     *  @return the Read Event Message Buffer response
+     */
+    EventRecord readEvent(HostId hostId = 0);
+
+    /** @brief Checks if the Event Message Buffer of a host is full, which
+     *         it is while a record is staged or SMS_ATN is asserted
      *
-     *          Also, if the queue has more commands, then it will alert the
-     *          host
+     *  @param[in] hostId - the host asking
      */
-    IpmiCmdData getNextCommand();
+    bool eventBufferFull(HostId hostId = 0) const
+    {
+        auto host = hosts.find(hostId);
+        return host != hosts.end() &&
+               (!host->second->ring.empty() || host->second->attentionSet);
+    }
 
-    /** @brief  Pushes the command onto the queue.
+    /** @brief  Pushes the command onto the queue of a host.
      *
      *  @detail If the queue is empty, then it alerts the Host. If not,
      *          then it returns and the API documented above will handle
      *          the commands in Queue.
      *
      *  @param[in] command - tuple of <IPMI command, data, callback>
+     *  @param[in] hostId - the host to send the command to
      */
-    void execute(CommandHandler command);
+    void execute(CommandHandler command, HostId hostId = 0);
+
+    /** @brief Checks if commands are waiting to be read by a host */
+    bool hasCommands(HostId hostId = 0) const
+    {
+        auto host = hosts.find(hostId);
+        return host != hosts.end() && (!host->second->staged.empty() ||
+                                       !host->second->workQueue.empty());
+    }
 
   private:
-    /** @brief Check if anything in queue and alert host if so */
-    void checkQueueAndAlertHost();
+    /** @brief A queued command and the requests waiting for it */
+    struct Entry
+    {
+        IpmiCmdData command;
+        Priority priority;
+        std::vector<CallBack> callbacks;
+        /** @brief Attention cycles that timed out with this command at the
+         *         head of the queue
+         */
+        unsigned int timeouts;
+    };
+
+    /** @brief Commands staged for a host to read, the ones beyond wait
+     *         in priority order
+     */
+    static constexpr size_t maxStaged = 4;
+
+    /** @brief The commands of one host and its attention state */
+    struct HostQueue
+    {
+        HostQueue(Manager& manager, HostId hostId);
+
+        const HostId hostId;
+
+        /** @brief The records of the staged commands */
+        EventRing<maxStaged> ring;
+
+        /** @brief The staged commands, in ring order */
+        std::deque<Entry> staged{};
+
+        /** @brief Staged commands completed, the ring index of the first
+         *         one still staged
+         */
+        size_t completed = 0;
+
+        /** @brief Ring records taken when the timer was armed */
+        size_t armedAt = 0;
+
+        /** @brief A completion is posted to the io context */
+        std::atomic<bool> reapPosted{false};
+
+        /** @brief The host read an empty buffer since the last completion */
+        std::atomic<bool> spuriousRead{false};
+
+        /** @brief Queue to store the requested commands not staged yet,
+         *         ordered by priority
+         */
+        std::deque<Entry> workQueue{};
+
+        /** @brief Last state set for SMS_ATN */
+        std::atomic<bool> attentionSet{false};
+
+        /** @brief Timer for commands to host */
+        phosphor::Timer timer;
+
+        /** @brief Match handler for the requested host state */
+        sdbusplus::bus::match_t hostTransitionMatch;
+    };
+
+    /** @brief The queue of a host, created on its first command */
+    HostQueue& queueOf(HostId hostId);
+
+    /** @brief Removes the first staged entry and calls its callbacks
+     *
+     *  @param[in] host - the queue of the host
+     *  @param[in] status - true if the command was passed to the host
+     */
+    void complete(HostQueue& host, bool status);
+
+    /** @brief Stages the commands at the head of the work queue while the
+     *         ring has room
+     *
+     *  @param[in] host - the queue of the host
+     */
+    void stage(HostQueue& host);
+
+    /** @brief Completes the commands the host read, stages the next ones
+     *         and updates the attention
+     *
+     *  @param[in] host - the queue of the host
+     */
+    void reap(HostQueue& host);
+
+    /** @brief Check if anything in queue and alert host if so
+     *
+     *  @param[in] host - the queue of the host
+     *  @param[in] force - assert SMS_ATN again even if it is already set
+     */
+    void checkQueueAndAlertHost(HostQueue& host, bool force = false);
 
     /** @brief  Call back interface on message timeouts to host.
      *
-     *  @detail When this happens, a failure message would be sent
-     *          to all the commands that are in the Queue and queue
-     *          will be purged
+     *  @detail The attention is asserted again for the command at the
+     *          head of the queue, which is failed once it has timed out
+     *          maxAttempts times. The other commands keep their place.
+     *
+     *  @param[in] host - the queue of the host that timed out
      */
-    void hostTimeout();
+    void hostTimeout(HostQueue& host);
 
     /** @brief Clears the command queue
      *
      *  @detail Clears the command queue and calls all callbacks
      *          specifying the command wasn't successful.
+     *
+     *  @param[in] host - the queue of the host
      */
-    void clearQueue();
+    void clearQueue(HostQueue& host);
 
     /** @brief Clears the command queue on a power on
      *
@@ -91,22 +251,27 @@ class Manager
      *          powered off system to power off again and then immediately
      *          requesting a power on.
      *
+     *  @param[in] host - the queue of the host whose state changed
      *  @param[in] msg - the sdbusplus message containing the property
      */
-    void clearQueueOnPowerOn(sdbusplus::message::message& msg);
-    void sendAttention(Attention);
+    void clearQueueOnPowerOn(HostQueue& host,
+                             sdbusplus::message::message& msg);
+
+    /** @brief Sets or clears SMS_ATN of a host
+     *
+     *  @param[in] host - the queue of the host
+     *  @param[in] attention - Set or Clear
+     *  @param[in] force - send the request even if SMS_ATN is known to be
+     *                     in the requested state already
+     */
+    void sendAttention(HostQueue& host, Attention attention,
+                       bool force = false);
 
     /** @brief Reference to the dbus handler */
     sdbusplus::bus::bus& bus;
 
-    /** @brief Queue to store the requested commands */
-    std::queue<CommandHandler> workQueue{};
-
-    /** @brief Timer for commands to host */
-    phosphor::Timer timer;
-
-    /** @brief Match handler for the requested host state */
-    sdbusplus::bus::match_t hostTransitionMatch;
+    /** @brief The queues of the hosts, by host id */
+    std::map<HostId, std::unique_ptr<HostQueue>> hosts;
 };
 
 } // namespace command
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace phosphor
+{
+namespace host
+{
+namespace command
+{
+
+/** @brief A Read Event Message Buffer response, encoded */
+using EventRecord = std::array<uint8_t, 16>;
+
+/** @class EventRing
+ *  @brief Fixed capacity ring of the records a host reads from the Event
+ *         Message Buffer
+ *
+ *  @detail The queue owner stages records at the tail and the Read Event
+ *          Message Buffer handler takes them from the head, each side
+ *          owning one index, so neither of them takes a lock. The owner
+ *          may also drop the head record, it then claims the head index
+ *          against the reader with a compare and swap.
+ */
+template <size_t Capacity>
+class EventRing
+{
+  public:
+    /** @brief Stages a record at the tail
+     *
+     *  @param[in] record - the record
+     *
+     *  @return false if the ring is full
+     */
+    bool push(const EventRecord& record)
+    {
+        size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) >= Capacity)
+        {
+            return false;
+        }
+        records[tail % Capacity] = record;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Takes the record at the head, nullopt if there is none */
+    std::optional<EventRecord> pop()
+    {
+        size_t head = headIndex.load(std::memory_order_relaxed);
+        while (head != tailIndex.load(std::memory_order_acquire))
+        {
+            // the slot is only written again once the head moved past it,
+            // a copy that lost the race is thrown away
+            EventRecord record = records[head % Capacity];
+            if (headIndex.compare_exchange_weak(head, head + 1,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed))
+            {
+                return record;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /** @brief Drops the head record unless it was taken already
+     *
+     *  @param[in] index - the index of the record, as counted by taken()
+     *
+     *  @return true if the record was dropped, false if it was taken
+     */
+    bool drop(size_t index)
+    {
+        return headIndex.compare_exchange_strong(index, index + 1,
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed);
+    }
+
+    /** @brief Records taken or dropped since the ring was made */
+    size_t taken() const
+    {
+        return headIndex.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return taken() == tailIndex.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::array<EventRecord, Capacity> records{};
+    std::atomic<size_t> headIndex{0};
+    std::atomic<size_t> tailIndex{0};
+};
+
+} // namespace command
+} // namespace host
+} // namespace phosphor
@@ -50,7 +50,7 @@ static const std::map<Host::Command, IpmiCmdData> ipmiCommand = {
 void Host::execute(Base::Host::Command command)
 {
     log<level::DEBUG>(
-        "Pushing cmd on to queue",
+        "Pushing cmd on to queue", entry("HOST=%u", hostId),
         entry("CONTROL_HOST_CMD=%s", convertForMessage(command).c_str()));
 
     auto cmd = std::make_tuple(ipmiCommand.at(command),
@@ -58,7 +58,7 @@ void Host::execute(Base::Host::Command command)
                                          std::placeholders::_1,
                                          std::placeholders::_2));
 
-    ipmid_send_cmd_to_host(std::move(cmd));
+    ipmid_send_cmd_to_host(std::move(cmd), hostId);
 }
 
 // Called into by Command Manager
@@ -93,7 +93,7 @@ Host::FirmwareCondition Host::currentFirmwareCondition() const
         ipmiCommand.at(Base::Host::Command::Heartbeat),
         std::move(hostAckCallback));
 
-    ipmid_send_cmd_to_host(std::move(cmd));
+    ipmid_send_cmd_to_host(std::move(cmd), hostId);
 
     // Timer to ensure this function returns something within a reasonable time
     phosphor::Timer hostAckTimer([hostCondition]() {
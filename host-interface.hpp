@@ -26,13 +26,14 @@ class Host
      *
      *  @param[in] bus     - The Dbus bus object
      *  @param[in] objPath - The Dbus object path
+     *  @param[in] hostId  - The host the commands are sent to
      */
-    Host(sdbusplus::bus::bus& bus, const char* objPath) :
+    Host(sdbusplus::bus::bus& bus, const char* objPath, HostId hostId = 0) :
         sdbusplus::server::object::object<
             sdbusplus::xyz::openbmc_project::Control::server::Host,
             sdbusplus::xyz::openbmc_project::Condition::server::HostFirmware>(
             bus, objPath),
-        bus(bus)
+        bus(bus), hostId(hostId)
     {
         // Nothing to do
     }
@@ -52,6 +53,9 @@ class Host
     /** @brief sdbusplus DBus bus connection. */
     sdbusplus::bus::bus& bus;
 
+    /** @brief The host the commands are sent to */
+    const HostId hostId;
+
     /** @brief  Callback function to be invoked by command manager
      *
      *  @detail Conveys the status of the last Host bound command.
@@ -14,19 +14,25 @@
 // limitations under the License.
 */
 
+#include <atomic>
 #include <boost/algorithm/string.hpp>
 #include <boost/bimap.hpp>
 #include <boost/container/flat_map.hpp>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <exception>
 #include <filesystem>
+#include <functional>
 #include <ipmid/api.hpp>
 #include <ipmid/types.hpp>
+#include <limits>
 #include <map>
+#include <optional>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus/match.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #pragma once
@@ -41,9 +47,33 @@ struct CmpStrVersion
     }
 };
 
+/** @brief an interned service or interface name of the sensor subtree, the
+ *         sensors share one copy of each name
+ */
+using SensorNameId = uint32_t;
+
+/** @brief interns a name, the same name always gets the same ID */
+SensorNameId internSensorName(std::string_view name);
+
+/** @brief the name of an ID, valid for the life of the process */
+const std::string& sensorName(SensorNameId id);
+
+struct CmpSensorName
+{
+    bool operator()(SensorNameId a, SensorNameId b) const
+    {
+        return sensorName(a) < sensorName(b);
+    }
+};
+
+/** @brief the sensor objects with their services and interfaces; the
+ *         subtree is shared as an immutable snapshot, a new one is swapped
+ *         in when the sensors change
+ */
 using SensorSubTree = boost::container::flat_map<
     std::string,
-    boost::container::flat_map<std::string, std::vector<std::string>>,
+    boost::container::flat_map<SensorNameId, std::vector<SensorNameId>,
+                               CmpSensorName>,
     CmpStrVersion>;
 
 using SensorNumMap = boost::bimap<int, std::string>;
@@ -55,6 +85,17 @@ static constexpr uint16_t lun3Sensor0 = 0x300;
 static constexpr uint16_t invalidSensorNumber = 0xFFFF;
 static constexpr uint8_t reservedSensorNumber = 0xFF;
 
+/** @brief the SDR codes the path of a sensor gives, see
+ *         getSensorCodesFromPath
+ */
+struct SensorPathCodes
+{
+    uint8_t sensorType = 0;
+    /** @brief SensorUnits of the base unit, 0 for unspecified */
+    uint8_t unitsBase = 0;
+    uint8_t eventReadingType = 0;
+};
+
 namespace details
 {
 // Enable/disable the logging of stats instrumentation
@@ -212,12 +253,98 @@ class IPMIStatsTable
 // This object is global singleton, used from a variety of places
 inline IPMIStatsTable sdrStatsTable;
 
-uint16_t getSensorSubtree(std::shared_ptr<SensorSubTree>& subtree);
+uint16_t getSensorSubtree(std::shared_ptr<const SensorSubTree>& subtree);
+
+/** @brief counts the sensor subtrees fetched so far; the subtree is rebuilt
+ *         in the background once the sensors settle after a change, so this
+ *         tells when the data behind a cached response was replaced
+ */
+uint64_t getSensorTreeGeneration();
+
+/** @brief sets a callback posted to the io context every time a new sensor
+ *         subtree is swapped in, to warm up what depends on it
+ */
+void onSensorTreeSwap(std::function<void()>&& callback);
 
 bool getSensorNumMap(std::shared_ptr<SensorNumMap>& sensorNumMap);
+
+/** @brief sensor number of an allocation slot, LUN 0, 1 and 3 in turn and
+ *         maxSensorsPerLUN slots each, as reservedSensorNumber is not used
+ */
+uint16_t slotSensorNumber(size_t slot);
+
+/** @brief allocation slot of a sensor number, nullopt if no slot has it */
+std::optional<size_t> sensorNumberSlot(uint16_t number);
+
+/** @brief numbers of a LUN in the sensor index, reservedSensorNumber
+ *         included so a position is just the LUN slot and the number
+ */
+static constexpr size_t sensorsPerIndexLUN = 256;
+
+struct SensorIndexEntry
+{
+    const std::string* path = nullptr;
+    const std::string* connection = nullptr;
+    /** @brief worked out from the path once, when the index is built */
+    SensorPathCodes codes;
+};
+
+/** @brief looks a sensor up by LUN and number in a dense index, for the
+ *         commands that read sensors
+ *
+ *  @param[in] sensorNum - LUN in the high byte, sensor number in the low
+ *
+ *  @return the path and connection of the sensor, null if there is no
+ *          such sensor; valid until the sensor subtree is next rebuilt
+ */
+const SensorIndexEntry& getSensorIndexEntry(uint16_t sensorNum);
+
+/** @struct SensorReadStats
+ *  @brief read telemetry of one sensor
+ *
+ *  The counters are relaxed atomics, so recording a read never locks and
+ *  the statistics can be read at any time, each counter consistent on its
+ *  own. They are kept across subtree rebuilds while the sensor keeps its
+ *  number, and reset when the number goes to another sensor or none.
+ */
+struct SensorReadStats
+{
+    std::atomic<uint64_t> reads{0};
+    /** @brief reads that returned an error completion code */
+    std::atomic<uint64_t> failures{0};
+    /** @brief reads that found no valid reading on D-Bus */
+    std::atomic<uint64_t> unavailable{0};
+    /** @brief reads that found the cached sensor map stale and waited for
+     *         it to be fetched from D-Bus
+     */
+    std::atomic<uint64_t> dbusFetches{0};
+    std::atomic<uint64_t> totalLatencyUs{0};
+    std::atomic<uint64_t> maxLatencyUs{0};
+    /** @brief lowest and highest valid reading, NaN before the first */
+    std::atomic<double> minReading{std::numeric_limits<double>::quiet_NaN()};
+    std::atomic<double> maxReading{std::numeric_limits<double>::quiet_NaN()};
+
+    void record(bool failed, bool noReading, bool fetched, double reading,
+                std::chrono::steady_clock::duration latency);
+    void reset();
+};
+
+/** @brief gets the read statistics of a sensor
+ *
+ *  @param[in] sensorNum - LUN in the high byte, sensor number in the low
+ *
+ *  @return the statistics, nullptr if the LUN has no sensors
+ */
+SensorReadStats* getSensorReadStats(uint16_t sensorNum);
 } // namespace details
 
-bool getSensorSubtree(SensorSubTree& subtree);
+/** @brief gets the current snapshot of the sensor subtree
+ *
+ *  @param[out] subtree - the snapshot, left alone when there is none
+ *
+ *  @return false if no subtree could be fetched yet
+ */
+bool getSensorSubtree(std::shared_ptr<const SensorSubTree>& subtree);
 
 struct CmpStr
 {
@@ -253,6 +380,11 @@ uint16_t getSensorNumberFromPath(const std::string& path);
 
 uint8_t getSensorEventTypeFromPath(const std::string& path);
 
+/** @brief gets the sensor type, units and event/reading type of a sensor
+ *         path at once; the sensor index holds them for every sensor
+ */
+SensorPathCodes getSensorCodesFromPath(const std::string& path);
+
 std::string getPathFromSensorNumber(uint16_t sensorNum);
 
 namespace ipmi
@@ -270,4 +402,8 @@ const std::string* getSensorConfigurationInterface(
 void updateIpmiFromAssociation(const std::string& path,
                                const DbusInterfaceMap& sensorMap,
                                uint8_t& entityId, uint8_t& entityInstance);
+
+void updateIpmiFromAssociation(const std::string& path,
+                               const std::vector<Association>& associations,
+                               uint8_t& entityId, uint8_t& entityInstance);
 } // namespace ipmi
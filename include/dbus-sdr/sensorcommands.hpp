@@ -118,9 +118,10 @@ enum class IPMINetfnSensorCmds : ipmi_cmd_t
 namespace ipmi
 {
 
-SensorSubTree& getSensorTree()
+/** @brief the subtree snapshot the SDR commands count the sensors of */
+std::shared_ptr<const SensorSubTree>& getSensorTree()
 {
-    static SensorSubTree sensorTree;
+    static std::shared_ptr<const SensorSubTree> sensorTree;
     return sensorTree;
 }
 
@@ -128,30 +129,24 @@ static ipmi_ret_t getSensorConnection(ipmi::Context::ptr ctx, uint16_t sensnum,
                                       std::string& connection,
                                       std::string& path)
 {
-    auto& sensorTree = getSensorTree();
-    if (!getSensorSubtree(sensorTree) && sensorTree.empty())
-    {
-        return IPMI_CC_RESPONSE_ERROR;
-    }
-
     if (ctx == nullptr)
     {
         return IPMI_CC_RESPONSE_ERROR;
     }
 
-    path = getPathFromSensorNumber((ctx->lun << 8) | sensnum);
-    if (path.empty())
+    const details::SensorIndexEntry& sensor =
+        details::getSensorIndexEntry((ctx->lun << 8) | sensnum);
+    if (!sensor.path)
     {
-        return IPMI_CC_INVALID_FIELD_REQUEST;
+        // no subtree could be fetched yet, or no such sensor
+        return details::getSensorTreeGeneration() == 0
+                   ? IPMI_CC_RESPONSE_ERROR
+                   : IPMI_CC_INVALID_FIELD_REQUEST;
     }
-
-    for (const auto& sensor : sensorTree)
+    path = *sensor.path;
+    if (sensor.connection)
     {
-        if (path == sensor.first)
-        {
-            connection = sensor.second.begin()->first;
-            break;
-        }
+        connection = *sensor.connection;
     }
 
     return 0;
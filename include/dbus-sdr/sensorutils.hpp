@@ -17,7 +17,10 @@
 #pragma once
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <optional>
+#include <vector>
 
 namespace ipmi
 {
@@ -36,4 +39,84 @@ uint8_t scaleIPMIValueFromDouble(const double value, const int16_t mValue,
 
 uint8_t getScaledIPMIValue(const double value, const double max,
                            const double min);
+
+/** @brief the linear conversion of a sensor range, see getSensorAttributes
+ *
+ *  The powers of ten of the conversion are kept with the coefficients, so
+ *  scaling a reading costs a subtraction, a multiplication and a division.
+ */
+struct SensorAttributes
+{
+    int16_t mValue = 0;
+    int8_t rExp = 0;
+    int16_t bValue = 0;
+    int8_t bExp = 0;
+    bool bSigned = false;
+    /** @brief 10^-rExp */
+    double rScale = 0;
+    /** @brief B * 10^(rExp + bExp) */
+    double bOffset = 0;
+};
+
+/** @brief get the conversion of a sensor range, solved once per range
+ *
+ *  The range is derived from MaxValue, MinValue and the thresholds of the
+ *  sensor, so the conversion is solved again whenever one of them changes.
+ *
+ *  @param[in] max - top of the sensor range
+ *  @param[in] min - bottom of the sensor range
+ *
+ *  @return the conversion, or nullopt if the range can't be represented
+ */
+std::optional<SensorAttributes> getSensorAttributes(const double max,
+                                                    const double min);
+
+uint8_t scaleIPMIValueFromDouble(const double value,
+                                 const SensorAttributes& attributes);
+
+/** @class SensorScalingBatch
+ *  @brief scales the readings of many sensors in one pass
+ *
+ *  The readings and their conversions are kept as structure of arrays, so
+ *  the loop of scale() has no branches and no libm calls and stays open to
+ *  vectorization.
+ *  Every reading scales to the same byte as with scaleIPMIValueFromDouble.
+ */
+class SensorScalingBatch
+{
+  public:
+    /** @brief reserve room for a number of readings */
+    void reserve(size_t count);
+
+    /** @brief queue a reading; throws if the conversion is unusable
+     *
+     *  @param[in] value - the sensor reading
+     *  @param[in] attributes - the conversion of the sensor range
+     */
+    void add(const double value, const SensorAttributes& attributes);
+
+    /** @brief the number of queued readings */
+    size_t size() const
+    {
+        return values.size();
+    }
+
+    /** @brief drop the queued readings */
+    void clear();
+
+    /** @brief scale all the queued readings
+     *
+     *  @param[out] bytes - one byte per reading, in the order they were
+     *                      queued; must have room for size() bytes
+     */
+    void scale(uint8_t* bytes) const;
+
+  private:
+    std::vector<double> values;
+    std::vector<double> rScale;
+    std::vector<double> bOffset;
+    std::vector<double> mValue;
+    std::vector<double> minClamp;
+    std::vector<double> maxClamp;
+};
 } // namespace ipmi
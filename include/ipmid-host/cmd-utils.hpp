@@ -22,6 +22,9 @@ namespace command
  *          in IPMI V2.0 spec.
  */
 
+/** @brief Host a command is sent to, 0 on single host systems */
+using HostId = unsigned int;
+
 /** @brief IPMI command */
 using IPMIcmd = uint8_t;
 
@@ -4,5 +4,8 @@
 
 // Global Host Bound Command manager
 extern void ipmid_send_cmd_to_host(phosphor::host::command::CommandHandler&&);
+// Host Bound Command manager of a host on a multi-host system
+extern void ipmid_send_cmd_to_host(phosphor::host::command::CommandHandler&&,
+                                   phosphor::host::command::HostId);
 extern std::unique_ptr<sdbusplus::asio::connection>&
     ipmid_get_sdbus_plus_handler();
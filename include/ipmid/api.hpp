@@ -51,6 +51,28 @@ static inline void post_work(WorkFn work)
     boost::asio::post(*getIoContext(), std::forward<WorkFn>(work));
 }
 
+/**
+ * @brief run provider initialization that is expensive at load time
+ *
+ * Built with DEFERRED_PROVIDER_INIT, the work is posted to the async
+ * execution queue, so it runs once all the providers are loaded and the
+ * daemon serves requests; otherwise it runs right away. The first request
+ * may come before the work ran, so what it sets up must also be set up on
+ * first use.
+ *
+ * @tparam WorkFn - a function of type void(void)
+ * @param work - the initialization to run
+ */
+template <typename WorkFn>
+static inline void defer_init(WorkFn work)
+{
+#ifdef DEFERRED_PROVIDER_INIT
+    post_work(std::forward<WorkFn>(work));
+#else
+    work();
+#endif
+}
+
 enum class SignalResponse : int
 {
     breakExecution,
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ipmi
+{
+namespace bridge
+{
+
+/* Native transport between the channel bridges and ipmid, an alternative to
+ * the execute method of xyz.openbmc_project.Ipmi.Server.
+ *
+ * A bridge connects a SOCK_SEQPACKET socket to socketPath. Every request is
+ * one packet: a RequestHeader followed by the request data. ipmid answers
+ * every request with one packet: a ResponseHeader followed by the response
+ * data, echoing the tag of the request. Responses can come back out of
+ * order, since the requests of a connection run concurrently. Both ends run
+ * on the BMC, so the fields are in host byte order.
+ *
+ * Only root may connect; the bridge vouches for the channel and, on session
+ * based channels, the user, session and privilege it sends. */
+
+constexpr const char* socketPath = "/run/ipmid/bridge.sock";
+
+/** @brief version of the headers, a request of another version is dropped
+ *
+ *  Version 2 added deadlineUs to the request header. ipmid still serves the
+ *  shorter version 1 requests, without a deadline, and answers every request
+ *  with the version it came with.
+ */
+constexpr uint8_t version = 2;
+constexpr uint8_t version1 = 1;
+
+/** @brief most request data bytes a request may carry */
+constexpr uint16_t maxRequestData = 4096;
+
+/** @struct RequestHeader
+ *  @brief header of a request packet
+ */
+struct RequestHeader
+{
+    uint8_t version;
+    uint8_t netFn;
+    uint8_t lun;
+    uint8_t cmd;
+    /** @brief channel the request came in on */
+    uint8_t channel;
+    /** @brief session privilege, ignored on session-less channels */
+    uint8_t privilege;
+    /** @brief session user, ignored on session-less channels */
+    uint8_t userId;
+    /** @brief requester slave address, used on IPMB channels */
+    uint8_t rqSA;
+    /** @brief session ID, ignored on session-less channels */
+    uint32_t sessionId;
+    /** @brief host index, used on IPMB channels */
+    uint32_t hostIdx;
+    /** @brief echoed in the response */
+    uint32_t tag;
+    /** @brief CLOCK_MONOTONIC microseconds at which the requester gives up
+     *         on the response, 0 for none; since version 2
+     */
+    uint64_t deadlineUs;
+} __attribute__((packed));
+
+/** @brief size of the request header of a version, 0 if it is not known */
+constexpr size_t requestHeaderSize(uint8_t headerVersion)
+{
+    switch (headerVersion)
+    {
+        case version1:
+            return offsetof(RequestHeader, deadlineUs);
+        case version:
+            return sizeof(RequestHeader);
+        default:
+            return 0;
+    }
+}
+
+/** @struct ResponseHeader
+ *  @brief header of a response packet
+ */
+struct ResponseHeader
+{
+    uint8_t version;
+    /** @brief netFn of the request with the response bit set */
+    uint8_t netFn;
+    uint8_t lun;
+    uint8_t cmd;
+    /** @brief completion code */
+    uint8_t cc;
+    uint8_t reserved[3];
+    /** @brief tag of the request */
+    uint32_t tag;
+} __attribute__((packed));
+
+} // namespace bridge
+} // namespace ipmi
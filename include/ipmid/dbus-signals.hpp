@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ipmid/types.hpp>
+#include <string>
+#include <vector>
+
+namespace ipmi
+{
+namespace dbus_signals
+{
+
+/* One match per signal class for all of ipmid, in place of a match per
+ * module for the same signals.
+ *
+ * A subscriber names the path prefix of the objects it is interested in,
+ * itself and everything below it, "/" for all of them. The signals are
+ * matched on the bus by the widest prefixes subscribed: a prefix within one
+ * that is already matched adds no match, a wider one replaces the matches
+ * within it, and the match of a prefix goes with its last subscriber, the
+ * narrower prefixes subscribed within it matched again in its place. Each
+ * signal is decoded once, and the decoded signal handed to every subscriber
+ * whose prefix covers its object path.
+ *
+ * Subscribing and unsubscribing may be done from any thread, the handlers
+ * run on the main loop, without any lock of the hub held, so they may
+ * subscribe or unsubscribe themselves. */
+
+/** @struct InterfacesAdded
+ *  @brief an InterfacesAdded signal, decoded
+ */
+struct InterfacesAdded
+{
+    std::string path;
+    DbusInterfaceMap interfaces;
+    /** @brief false when the interfaces could not all be decoded, those that
+     *         were are in interfaces
+     */
+    bool complete = true;
+};
+
+/** @struct InterfacesRemoved
+ *  @brief an InterfacesRemoved signal, decoded
+ */
+struct InterfacesRemoved
+{
+    std::string path;
+    std::vector<std::string> interfaces;
+    /** @brief false when the interfaces could not be decoded */
+    bool complete = true;
+};
+
+/** @struct PropertiesChanged
+ *  @brief a PropertiesChanged signal, decoded
+ */
+struct PropertiesChanged
+{
+    std::string path;
+    std::string interface;
+    PropertyMap changed;
+    std::vector<std::string> invalidated;
+    /** @brief false when the signal could not all be decoded, what was is in
+     *         the other members
+     */
+    bool complete = true;
+};
+
+/** @struct NameOwnerChanged
+ *  @brief a NameOwnerChanged signal, decoded
+ */
+struct NameOwnerChanged
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+};
+
+/** @class Subscription
+ *  @brief a subscription to the hub, unsubscribed when destroyed
+ */
+class Subscription
+{
+  public:
+    Subscription() = default;
+    explicit Subscription(uint64_t id) : id(id)
+    {
+    }
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+    Subscription(Subscription&& other) noexcept : id(other.id)
+    {
+        other.id = 0;
+    }
+    Subscription& operator=(Subscription&& other) noexcept;
+    ~Subscription();
+
+    explicit operator bool() const
+    {
+        return id != 0;
+    }
+
+  private:
+    uint64_t id = 0;
+};
+
+/** @brief subscribe to the InterfacesAdded signals of the objects under a
+ *         path prefix
+ *
+ *  @param[in] prefix - the path prefix
+ *  @param[in] handler - called with each signal
+ */
+Subscription onInterfacesAdded(
+    const std::string& prefix,
+    std::function<void(const InterfacesAdded&)>&& handler);
+
+/** @brief subscribe to the InterfacesRemoved signals of the objects under a
+ *         path prefix
+ *
+ *  @param[in] prefix - the path prefix
+ *  @param[in] handler - called with each signal
+ */
+Subscription onInterfacesRemoved(
+    const std::string& prefix,
+    std::function<void(const InterfacesRemoved&)>&& handler);
+
+/** @brief subscribe to the PropertiesChanged signals of the objects under a
+ *         path prefix
+ *
+ *  @param[in] prefix - the path prefix
+ *  @param[in] handler - called with each signal
+ */
+Subscription onPropertiesChanged(
+    const std::string& prefix,
+    std::function<void(const PropertiesChanged&)>&& handler);
+
+/** @brief subscribe to the NameOwnerChanged signals of every name
+ *
+ *  @param[in] handler - called with each signal
+ */
+Subscription
+    onNameOwnerChanged(std::function<void(const NameOwnerChanged&)>&& handler);
+
+} // namespace dbus_signals
+} // namespace ipmi
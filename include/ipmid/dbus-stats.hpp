@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <ipmid/api-types.hpp>
+#include <ipmid/message.hpp>
+#include <map>
+
+namespace ipmi
+{
+namespace dbus_stats
+{
+
+/* Accounting of the D-Bus calls the libipmid helpers make, charged to the
+ * command whose handler made them.
+ *
+ * The dispatcher names the request it runs a handler for on the thread,
+ * and the yielding helpers name theirs again once they resume, since
+ * another request may have run on the main loop meanwhile. A call made
+ * outside of a handler is charged to netFn FFh, cmd FFh. Handlers calling
+ * yield_method_call on the connection of their Context directly are not
+ * seen.
+ *
+ * A command may have a soft budget of D-Bus calls and D-Bus time per
+ * request; the requests going over are counted and logged, nothing fails. */
+
+/** @brief key of the calls made outside of a handler */
+constexpr uint16_t unattributed = 0xFFFF;
+
+/** @brief key of a command, (netFn << 8) | cmd */
+inline uint16_t makeKey(NetFn netFn, Cmd cmd)
+{
+    return static_cast<uint16_t>((netFn << 8) | cmd);
+}
+
+/** @struct Counters
+ *  @brief the D-Bus calls of one command since the start
+ */
+struct Counters
+{
+    uint64_t calls = 0;
+    /** @brief calls answered with an error */
+    uint64_t failures = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+    /** @brief requests that went over the budget of the command */
+    uint64_t overBudget = 0;
+};
+
+/** @struct Budget
+ *  @brief what one request of a command is expected to stay within, zero
+ *         for no limit
+ */
+struct Budget
+{
+    uint32_t calls = 0;
+    std::chrono::microseconds time{};
+};
+
+/** @brief get the counters of every command that made calls, by key */
+std::map<uint16_t, Counters> getStats();
+
+/** @brief drop the counters; the budgets are kept */
+void reset();
+
+/** @brief set the budget of a command, a zero budget removes it */
+void setBudget(NetFn netFn, Cmd cmd, const Budget& budget);
+
+/** @brief charge the calls this thread makes to a request, until the
+ *         request is released or another one is named
+ */
+void attribute(Context& ctx);
+
+/** @brief stop charging the calls of this thread to a request */
+void release(Context& ctx);
+
+/** @brief check a request that is done against the budget of its command,
+ *         logging it if it went over
+ */
+void checkBudget(const Context& ctx);
+
+/** @class Call
+ *  @brief times one D-Bus call of a helper and charges it on destruction;
+ *         a call that throws counts as failed
+ */
+class Call
+{
+  public:
+    /** @brief a call charged to the request named on the thread */
+    Call();
+
+    /** @brief a yielding call of a request, charged to it; a request the
+     *         dispatcher named is named again on the thread once the call
+     *         is charged, since another one may have run meanwhile
+     */
+    explicit Call(Context& ctx);
+
+    ~Call();
+
+    Call(const Call&) = delete;
+    Call& operator=(const Call&) = delete;
+
+    /** @brief mark the call failed when it answered an error */
+    void check(bool error)
+    {
+        failed = failed || error;
+    }
+
+  private:
+    Context* ctx = nullptr;
+    int exceptions;
+    bool failed = false;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+};
+
+} // namespace dbus_stats
+} // namespace ipmi
@@ -20,8 +20,10 @@
 #include <ipmid/api-types.hpp>
 #include <ipmid/message.hpp>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace ipmi
 {
@@ -73,6 +75,20 @@ class IpmiFilter : public FilterBase
     Filter filter_;
 };
 
+/** @brief requests a filter is called on
+ *
+ * A filter registered with scopes is only called on the requests matching
+ * one of them, a field left empty matches every value. The dispatcher
+ * resolves the filters of each command once the providers are loaded, so
+ * the commands no filter is scoped to skip the filters altogether.
+ */
+struct FilterScope
+{
+    std::optional<NetFn> netFn;
+    std::optional<Cmd> cmd;
+    std::optional<uint8_t> channel;
+};
+
 /**
  * @brief helper function to construct a filter object
  *
@@ -96,6 +112,8 @@ namespace impl
 
 // IPMI command filter registration implementation
 void registerFilter(int prio, ::ipmi::FilterBase::ptr filter);
+void registerFilter(int prio, ::ipmi::FilterBase::ptr filter,
+                    std::vector<FilterScope>&& scopes);
 
 } // namespace impl
 
@@ -132,4 +150,22 @@ void registerFilter(int prio, const Filter& filter)
     impl::registerFilter(prio, f);
 }
 
+/**
+ * @brief IPMI command filter registration function for scoped filters
+ *
+ * Same as the above, for filters that are only called on the requests
+ * matching one of their scopes, see FilterScope.
+ *
+ * @param prio - priority at which to register; see api.hpp
+ * @param scopes - requests the filter is called on
+ * @param filter - the callback function that will handle this request
+ */
+template <typename Filter>
+void registerFilter(int prio, std::vector<FilterScope>&& scopes,
+                    Filter&& filter)
+{
+    auto f = ipmi::makeFilter(std::forward<Filter>(filter));
+    impl::registerFilter(prio, f, std::move(scopes));
+}
+
 } // namespace ipmi
@@ -17,17 +17,21 @@
 #include <algorithm>
 #include <boost/asio/spawn.hpp>
 #include <boost/callable_traits.hpp>
+#include <chrono>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <ipmid/api-types.hpp>
 #include <ipmid/message.hpp>
 #include <memory>
 #include <optional>
 #include <phosphor-logging/log.hpp>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <user_channel/channel_layer.hpp>
 #include <utility>
+#include <vector>
 
 #ifdef ALLOW_DEPRECATED_API
 #include <ipmid/api.h>
@@ -35,6 +39,12 @@
 #include <ipmid/oemrouter.hpp>
 #endif /* ALLOW_DEPRECATED_API */
 
+#ifdef IPMID_CXX20_COROUTINES
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#endif /* IPMID_CXX20_COROUTINES */
+
 namespace ipmi
 {
 
@@ -87,6 +97,154 @@ class HandlerException : public HandlerCompletion, public std::runtime_error
     }
 };
 
+#ifdef IPMID_CXX20_COROUTINES
+/** @brief the result of a handler that is a C++20 coroutine
+ *
+ * A handler returning a Task<RspType<...>> runs as a stackless coroutine on
+ * the ipmid main loop and co_awaits its D-Bus calls with
+ * boost::asio::use_awaitable, instead of suspending the stackful coroutine
+ * of its request with the yield context. It takes the same arguments as
+ * any other handler and is registered the same way, but not as a worker
+ * handler. Only built with --enable-cxx20-coroutines.
+ */
+template <typename T>
+using Task = boost::asio::awaitable<T>;
+#endif /* IPMID_CXX20_COROUTINES */
+
+/** @brief where a handler runs
+ *
+ * Handlers run on the ipmid main loop unless they register as worker
+ * handlers. A worker handler is either thread safe or blocks, and runs on
+ * the handler worker pool when ipmid is built with HANDLER_WORKER_THREADS
+ * above 0, so a slow synchronous D-Bus call doesn't stall every channel.
+ * A worker handler must not use the yield context or the asio connection
+ * of its Context; ipmid_get_sd_bus_connection() returns a connection of
+ * the worker thread for its synchronous D-Bus calls.
+ */
+enum class Execution
+{
+    mainLoop,
+    worker,
+};
+
+/** @brief when the cached responses of a handler go stale
+ *
+ * The dispatcher caches the successful responses of a handler registered
+ * with a cache policy, keyed by the command, request data, channel and
+ * privilege of the request, and answers the requests that match without
+ * calling the handler. The cache of the handler is dropped when a D-Bus
+ * signal matches one of the match rules, and a response expires maxAge
+ * after it was cached unless maxAge is zero. Without either the responses
+ * are kept for the life of ipmid, so only handlers whose response changes
+ * never, or only along with a signal, should be registered with one.
+ *
+ * A handler that answers from data of its own that is refreshed some time
+ * after the signals gives a generation function; the responses cached
+ * under another generation of that data are stale.
+ */
+struct CachePolicy
+{
+    std::vector<std::string> matches;
+    std::chrono::steady_clock::duration maxAge{};
+    std::function<uint64_t()> generation;
+};
+
+/** @brief concurrent identical requests of a handler share one execution
+ *
+ * The requests of a handler registered as idempotent that have the same
+ * command, lun, privilege and request data as one in flight wait for it,
+ * and are answered with a copy of its response instead of calling the
+ * handler again. Only handlers whose response does not depend on the
+ * channel, session or user of the request, and that change nothing, should
+ * be registered as idempotent.
+ */
+struct Idempotent
+{
+};
+
+namespace impl
+{
+
+// the response type of a handler, the one its Task completes with for the
+// coroutine handlers
+template <typename T>
+struct HandlerResult
+{
+    using type = T;
+    static constexpr bool isTask = false;
+};
+
+#ifdef IPMID_CXX20_COROUTINES
+template <typename T>
+struct HandlerResult<Task<T>>
+{
+    using type = T;
+    static constexpr bool isTask = true;
+};
+
+// run the task of a coroutine handler on the main loop and suspend the
+// request until it completes, rethrowing what the task threw
+template <typename T>
+T awaitTask(Context::ptr ctx, Task<T>&& task)
+{
+    boost::asio::steady_timer done(
+        ctx->bus->get_io_context(),
+        boost::asio::steady_timer::time_point::max());
+    std::optional<T> result;
+    std::exception_ptr error;
+    bool finished = false;
+    boost::asio::co_spawn(done.get_executor(), std::move(task),
+                          [&](std::exception_ptr e, T r) {
+                              error = e;
+                              if (!error)
+                              {
+                                  result.emplace(std::move(r));
+                              }
+                              finished = true;
+                              done.cancel();
+                          });
+    while (!finished)
+    {
+        boost::system::error_code ec;
+        done.async_wait(ctx->yield[ec]);
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    return std::move(*result);
+}
+#endif /* IPMID_CXX20_COROUTINES */
+
+// run a worker handler on the worker pool and return to the main loop
+message::Response::ptr
+    callOnWorker(message::Request::ptr request,
+                 std::function<message::Response::ptr()>&& callback);
+
+// the cached responses of one handler, see CachePolicy
+class ResponseCache;
+
+std::shared_ptr<ResponseCache> makeResponseCache(CachePolicy&& policy);
+
+// answer the request from the cache, or call the handler and cache the
+// response if it is successful
+message::Response::ptr
+    callCached(ResponseCache& cache, message::Request::ptr request,
+               const std::function<message::Response::ptr()>& callback);
+
+// the requests of one idempotent handler in flight, see Idempotent
+class RequestFlights;
+
+std::shared_ptr<RequestFlights> makeRequestFlights();
+
+// answer the request with the response of an identical request in flight,
+// or call the handler and answer the identical requests that came meanwhile
+message::Response::ptr
+    callCoalesced(RequestFlights& flights, message::Request::ptr request,
+                  const std::function<message::Response::ptr()>& callback);
+
+} // namespace impl
+
 /**
  * @brief Handler base class for dealing with IPMI request/response
  *
@@ -116,10 +274,62 @@ class HandlerBase
      */
     message::Response::ptr call(message::Request::ptr request)
     {
-        return executeCallback(request);
+        if (requestFlights)
+        {
+            return impl::callCoalesced(*requestFlights, request,
+                                       [this, request]() {
+                                           return callCaching(request);
+                                       });
+        }
+        return callCaching(request);
+    }
+
+    /** @brief set where the handler runs, see Execution */
+    void setExecution(Execution where)
+    {
+        execution = where;
+    }
+
+    /** @brief cache the responses of the handler, see CachePolicy */
+    void setCachePolicy(CachePolicy&& policy)
+    {
+        responseCache = impl::makeResponseCache(std::move(policy));
+    }
+
+    /** @brief share executions among identical requests, see Idempotent */
+    void setIdempotent()
+    {
+        requestFlights = impl::makeRequestFlights();
     }
 
   private:
+    Execution execution = Execution::mainLoop;
+    std::shared_ptr<impl::ResponseCache> responseCache;
+    std::shared_ptr<impl::RequestFlights> requestFlights;
+
+    message::Response::ptr callCaching(message::Request::ptr request)
+    {
+        if (responseCache)
+        {
+            return impl::callCached(*responseCache, request,
+                                    [this, request]() {
+                                        return dispatch(request);
+                                    });
+        }
+        return dispatch(request);
+    }
+
+    message::Response::ptr dispatch(message::Request::ptr request)
+    {
+        if (execution == Execution::worker)
+        {
+            return impl::callOnWorker(request, [this, request]() {
+                return executeCallback(request);
+            });
+        }
+        return executeCallback(request);
+    }
+
     /** @brief call the registered handler with the request
      *
      * This is called from the running queue context after it has already
@@ -183,7 +393,9 @@ class IpmiHandler final : public HandlerBase
         using UnpackArgsType = typename utility::StripFirstArgs<
             utility::NonIpmiArgsCount<InputArgsType>::size(),
             InputArgsType>::type;
-        using ResultType = boost::callable_traits::return_type_t<Handler>;
+        using HandlerResult = impl::HandlerResult<
+            boost::callable_traits::return_type_t<Handler>>;
+        using ResultType = typename HandlerResult::type;
 
         UnpackArgsType unpackArgs;
         request->payload.trailingOk = false;
@@ -255,7 +467,15 @@ class IpmiHandler final : public HandlerBase
 
             // execute the registered callback function and get the
             // ipmi::RspType<>
-            result = std::apply(handler_, *inputArgs);
+            if constexpr (HandlerResult::isTask)
+            {
+                result = impl::awaitTask(request->ctx,
+                                         std::apply(handler_, *inputArgs));
+            }
+            else
+            {
+                result = std::apply(handler_, *inputArgs);
+            }
         }
         catch (const HandlerException& e)
         {
@@ -303,10 +523,20 @@ class IpmiHandler final : public HandlerBase
         }
 
         response->cc = std::get<0>(result);
-        auto payload = std::get<1>(result);
+        auto& payload = std::get<1>(result);
         // check for optional payload
         if (payload)
         {
+            // reserve the whole response at once when its size is fixed
+            using PayloadType =
+                typename std::decay_t<decltype(payload)>::value_type;
+            constexpr size_t packedSize =
+                message::details::packedSize<PayloadType>;
+            if constexpr (packedSize > 0)
+            {
+                response->payload.raw.reserve(response->payload.size() +
+                                              packedSize);
+            }
             response->pack(*payload);
         }
         return response;
@@ -358,8 +588,9 @@ class IpmiHandler<ipmid_callback_t> final : public HandlerBase
         executeCallback(message::Request::ptr request) override
     {
         message::Response::ptr response = request->makeResponse();
-        // allocate a big response buffer here
-        response->payload.resize(maxLegacyBufferSize);
+        // allocate a big response buffer here, after the response prefix
+        size_t prefixSize = response->payload.size();
+        response->payload.resize(prefixSize + maxLegacyBufferSize);
 
         size_t len = request->payload.size() - request->payload.rawIndex;
         Cc ccRet{ccSuccess};
@@ -368,7 +599,8 @@ class IpmiHandler<ipmid_callback_t> final : public HandlerBase
             ccRet =
                 handler_(request->ctx->netFn, request->ctx->cmd,
                          request->payload.data() + request->payload.rawIndex,
-                         response->payload.data(), &len, handlerCtx);
+                         response->payload.data() + prefixSize, &len,
+                         handlerCtx);
         }
         catch (const HandlerException& e)
         {
@@ -415,7 +647,7 @@ class IpmiHandler<ipmid_callback_t> final : public HandlerBase
             }
         }
         response->cc = ccRet;
-        response->payload.resize(len);
+        response->payload.resize(prefixSize + len);
         return response;
     }
 };
@@ -461,8 +693,9 @@ class IpmiHandler<oem::Handler> final : public HandlerBase
         executeCallback(message::Request::ptr request) override
     {
         message::Response::ptr response = request->makeResponse();
-        // allocate a big response buffer here
-        response->payload.resize(maxLegacyBufferSize);
+        // allocate a big response buffer here, after the response prefix
+        size_t prefixSize = response->payload.size();
+        response->payload.resize(prefixSize + maxLegacyBufferSize);
 
         size_t len = request->payload.size() - request->payload.rawIndex;
         Cc ccRet{ccSuccess};
@@ -471,7 +704,7 @@ class IpmiHandler<oem::Handler> final : public HandlerBase
             ccRet =
                 handler_(request->ctx->cmd,
                          request->payload.data() + request->payload.rawIndex,
-                         response->payload.data(), &len);
+                         response->payload.data() + prefixSize, &len);
         }
         catch (const HandlerException& e)
         {
@@ -518,7 +751,7 @@ class IpmiHandler<oem::Handler> final : public HandlerBase
             }
         }
         response->cc = ccRet;
-        response->payload.resize(len);
+        response->payload.resize(prefixSize + len);
         return response;
     }
 };
@@ -560,6 +793,72 @@ inline auto makeLegacyHandler(oem::Handler&& handler)
         new IpmiHandler<oem::Handler>(std::forward<oem::Handler>(handler)));
     return ptr;
 }
+
+/**
+ * @brief IPMI OEM handler class for the commands of one OEN of a
+ *        StaticRouter
+ *
+ * The router handlers get the request straight out of the request payload
+ * and write the reply straight into the response payload, after the
+ * response prefix.
+ *
+ * @tparam Router - the StaticRouter type
+ */
+template <typename Router>
+class StaticOemRouterHandler final : public HandlerBase
+{
+  public:
+    StaticOemRouterHandler(const Router& router, size_t index) :
+        router_(router), index_(index)
+    {
+    }
+
+  private:
+    const Router& router_;
+    size_t index_;
+
+    message::Response::ptr
+        executeCallback(message::Request::ptr request) override
+    {
+        oem::SpanHandler handler = router_.at(index_, request->ctx->cmd);
+        if (!handler)
+        {
+            return errorResponse(request, ccInvalidCommand);
+        }
+
+        message::Response::ptr response = request->makeResponse();
+        size_t prefixSize = response->payload.size();
+        response->payload.resize(prefixSize + oem::maxSpanReplySize);
+
+        message::Payload& payload = request->payload;
+        size_t len = oem::maxSpanReplySize;
+        Cc ccRet{ccSuccess};
+        try
+        {
+            ccRet = handler(request->ctx->cmd,
+                            payload.data() + payload.rawIndex,
+                            payload.size() - payload.rawIndex,
+                            response->payload.data() + prefixSize, &len);
+        }
+        catch (const HandlerException& e)
+        {
+            return errorResponse(request, e.code());
+        }
+        catch (const std::exception& e)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                "OEM Router Handler failed to catch exception",
+                phosphor::logging::entry("EXCEPTION=%s", e.what()),
+                phosphor::logging::entry("NETFN=%x", request->ctx->netFn),
+                phosphor::logging::entry("CMD=%x", request->ctx->cmd));
+            return errorResponse(request, ccUnspecifiedError);
+        }
+        response->cc = ccRet;
+        response->payload.resize(prefixSize +
+                                 std::min(len, oem::maxSpanReplySize));
+        return response;
+    }
+};
 #endif // ALLOW_DEPRECATED_API
 
 /**
@@ -619,6 +918,76 @@ bool registerHandler(int prio, NetFn netFn, Cmd cmd, Privilege priv,
     return impl::registerHandler(prio, netFn, cmd, priv, h);
 }
 
+/**
+ * @brief register a IPMI handler that runs as specified
+ *
+ * Same as the above, for handlers that can run on the worker pool.
+ *
+ * @param prio - priority at which to register; see api.hpp
+ * @param netFn - the IPMI net function number to register
+ * @param cmd - the IPMI command number to register
+ * @param priv - the IPMI user privilige required for this command
+ * @param where - where the handler runs, see Execution
+ * @param handler - the callback function that will handle this request
+ *
+ * @return bool - success of registering the handler
+ */
+template <typename Handler>
+bool registerHandler(int prio, NetFn netFn, Cmd cmd, Privilege priv,
+                     Execution where, Handler&& handler)
+{
+    auto h = ipmi::makeHandler(std::forward<Handler>(handler));
+    h->setExecution(where);
+    return impl::registerHandler(prio, netFn, cmd, priv, h);
+}
+
+/**
+ * @brief register a IPMI handler with cached responses
+ *
+ * Same as the above, for handlers whose responses the dispatcher may cache.
+ *
+ * @param prio - priority at which to register; see api.hpp
+ * @param netFn - the IPMI net function number to register
+ * @param cmd - the IPMI command number to register
+ * @param priv - the IPMI user privilige required for this command
+ * @param policy - when the cached responses go stale, see CachePolicy
+ * @param handler - the callback function that will handle this request
+ *
+ * @return bool - success of registering the handler
+ */
+template <typename Handler>
+bool registerHandler(int prio, NetFn netFn, Cmd cmd, Privilege priv,
+                     CachePolicy&& policy, Handler&& handler)
+{
+    auto h = ipmi::makeHandler(std::forward<Handler>(handler));
+    h->setCachePolicy(std::move(policy));
+    return impl::registerHandler(prio, netFn, cmd, priv, h);
+}
+
+/**
+ * @brief register an idempotent IPMI handler
+ *
+ * Same as the above, for handlers whose concurrent identical requests may
+ * share one execution.
+ *
+ * @param prio - priority at which to register; see api.hpp
+ * @param netFn - the IPMI net function number to register
+ * @param cmd - the IPMI command number to register
+ * @param priv - the IPMI user privilige required for this command
+ * @param idempotent - see Idempotent
+ * @param handler - the callback function that will handle this request
+ *
+ * @return bool - success of registering the handler
+ */
+template <typename Handler>
+bool registerHandler(int prio, NetFn netFn, Cmd cmd, Privilege priv,
+                     Idempotent, Handler&& handler)
+{
+    auto h = ipmi::makeHandler(std::forward<Handler>(handler));
+    h->setIdempotent();
+    return impl::registerHandler(prio, netFn, cmd, priv, h);
+}
+
 /**
  * @brief register a IPMI OEM group handler
  *
@@ -658,6 +1027,22 @@ void registerGroupHandler(int prio, Group group, Cmd cmd, Privilege priv,
     impl::registerGroupHandler(prio, group, cmd, priv, h);
 }
 
+/**
+ * @brief register a IPMI OEM group handler that runs as specified
+ *
+ * Same as the above, for handlers that can run on the worker pool.
+ *
+ * @param where - where the handler runs, see Execution
+ */
+template <typename Handler>
+void registerGroupHandler(int prio, Group group, Cmd cmd, Privilege priv,
+                          Execution where, Handler&& handler)
+{
+    auto h = ipmi::makeHandler(handler);
+    h->setExecution(where);
+    impl::registerGroupHandler(prio, group, cmd, priv, h);
+}
+
 /**
  * @brief register a IPMI OEM IANA handler
  *
@@ -693,6 +1078,65 @@ void registerOemHandler(int prio, Iana iana, Cmd cmd, Privilege priv,
     impl::registerOemHandler(prio, iana, cmd, priv, h);
 }
 
+/**
+ * @brief register a IPMI OEM IANA handler that runs as specified
+ *
+ * Same as the above, for handlers that can run on the worker pool.
+ *
+ * @param where - where the handler runs, see Execution
+ */
+template <typename Handler>
+void registerOemHandler(int prio, Iana iana, Cmd cmd, Privilege priv,
+                        Execution where, Handler&& handler)
+{
+    auto h = ipmi::makeHandler(handler);
+    h->setExecution(where);
+    impl::registerOemHandler(prio, iana, cmd, priv, h);
+}
+
+/**
+ * @brief register an idempotent IPMI OEM IANA handler
+ *
+ * Same as the above, for handlers whose concurrent identical requests may
+ * share one execution.
+ *
+ * @param idempotent - see Idempotent
+ */
+template <typename Handler>
+void registerOemHandler(int prio, Iana iana, Cmd cmd, Privilege priv,
+                        Idempotent, Handler&& handler)
+{
+    auto h = ipmi::makeHandler(handler);
+    h->setIdempotent();
+    impl::registerOemHandler(prio, iana, cmd, priv, h);
+}
+
+#ifdef ALLOW_DEPRECATED_API
+/**
+ * @brief register the OEM Numbers of a StaticRouter
+ *
+ * Each OEN is registered as a wildcard OEM handler that routes the commands
+ * through the router arrays. Handlers registered with the router afterwards
+ * are routed too.
+ *
+ * @param prio - priority at which to register; see api.hpp
+ * @param priv - the IPMI user privilige required for the commands
+ * @param router - the router, it must outlive the registration
+ */
+template <oem::Number... oens>
+void registerOemRouter(int prio, Privilege priv,
+                       const oem::StaticRouter<oens...>& router)
+{
+    using Router = oem::StaticRouter<oens...>;
+    for (size_t index = 0; index < Router::oenCount; index++)
+    {
+        HandlerBase::ptr h(new StaticOemRouterHandler<Router>(router, index));
+        impl::registerOemHandler(prio, Router::numbers[index], cmdWildcard,
+                                 priv, h);
+    }
+}
+#endif // ALLOW_DEPRECATED_API
+
 } // namespace ipmi
 
 #ifdef ALLOW_DEPRECATED_API
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <boost/system/error_code.hpp>
+#include <cstdint>
+#include <ipmid/message.hpp>
+#include <ipmid/types.hpp>
+#include <map>
+#include <sdbusplus/bus.hpp>
+#include <string>
+#include <vector>
+
+namespace ipmi
+{
+namespace mapper
+{
+
+/* Shared client of the object mapper GetSubTree and GetObject queries.
+ *
+ * Answers are cached until the InterfacesAdded or InterfacesRemoved signal
+ * of an object they cover, the mapper completing the introspection of a
+ * service, or a service leaving the bus drops them. An identical query
+ * issued while one is in flight waits for its answer instead of calling the
+ * mapper again: yielding queries wait for the one of another coroutine and
+ * blocking queries for the one of another thread. An answer that races a
+ * change is handed to the callers waiting for it but not cached. */
+
+/** @brief services and their interfaces, as GetObject answers them */
+using ServiceMap = std::map<DbusService, std::vector<DbusInterface>>;
+
+/** @struct Stats
+ *  @brief counters of the mapper client since the start
+ */
+struct Stats
+{
+    /** @brief queries answered from the cache */
+    uint64_t hits = 0;
+    /** @brief queries that called the mapper */
+    uint64_t misses = 0;
+    /** @brief queries that waited for an identical query in flight */
+    uint64_t coalesced = 0;
+    /** @brief cached answers dropped by a change */
+    uint64_t invalidations = 0;
+    /** @brief answers in the cache */
+    uint64_t cached = 0;
+};
+
+/** @brief get the counters of the mapper client */
+Stats getStats();
+
+/** @brief drop every cached answer */
+void clear();
+
+/** @brief GetSubTree, from the cache when it holds the answer
+ *
+ *  @param[in] bus - D-Bus bus object
+ *  @param[in] root - subtree to search
+ *  @param[in] depth - levels to search, 0 for all
+ *  @param[in] interfaces - interfaces the objects implement, all when empty
+ *
+ *  @return the objects with their services and interfaces; throws the
+ *          errors of the mapper call
+ */
+ObjectTree getSubTree(sdbusplus::bus::bus& bus, const std::string& root,
+                      int32_t depth, const InterfaceList& interfaces);
+
+/** @brief GetObject, from the cache when it holds the answer
+ *
+ *  @param[in] bus - D-Bus bus object
+ *  @param[in] path - object path
+ *  @param[in] interfaces - interfaces the services implement, all when empty
+ *
+ *  @return the services of the object with their interfaces; throws the
+ *          errors of the mapper call
+ */
+ServiceMap getObject(sdbusplus::bus::bus& bus, const std::string& path,
+                     const InterfaceList& interfaces);
+
+/** @brief GetSubTree yielding until the answer, from the cache when it
+ *         holds the answer
+ *
+ *  @param[in] ctx - ipmi::Context::ptr
+ *  @param[in] root - subtree to search
+ *  @param[in] depth - levels to search, 0 for all
+ *  @param[in] interfaces - interfaces the objects implement, all when empty
+ *  @param[out] objectTree - the objects with their services and interfaces
+ *  @return - boost error code object
+ */
+boost::system::error_code getSubTree(Context::ptr ctx, const std::string& root,
+                                     int32_t depth,
+                                     const InterfaceList& interfaces,
+                                     ObjectTree& objectTree);
+
+/** @brief GetObject yielding until the answer, from the cache when it holds
+ *         the answer
+ *
+ *  @param[in] ctx - ipmi::Context::ptr
+ *  @param[in] path - object path
+ *  @param[in] interfaces - interfaces the services implement, all when empty
+ *  @param[out] services - the services of the object with their interfaces
+ *  @return - boost error code object
+ */
+boost::system::error_code getObject(Context::ptr ctx, const std::string& path,
+                                    const InterfaceList& interfaces,
+                                    ServiceMap& services);
+
+} // namespace mapper
+} // namespace ipmi
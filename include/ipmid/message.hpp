@@ -16,12 +16,15 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <boost/asio/spawn.hpp>
+#include <chrono>
 #include <cstdint>
 #include <exception>
 #include <ipmid/api-types.hpp>
 #include <ipmid/message/types.hpp>
 #include <memory>
+#include <optional>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/asio/connection.hpp>
 #include <tuple>
@@ -66,6 +69,25 @@ struct Context
     int rqSA;
     int hostIdx;
     boost::asio::yield_context yield;
+    // when the requester gives up on the response, if its bridge said so
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    // the D-Bus calls of the handler so far, see ipmid/dbus-stats.hpp
+    uint32_t dbusCalls = 0;
+    std::chrono::steady_clock::duration dbusTime{};
+    // threads the request is named on, only a named request is alive for
+    // as long as the calls are charged to it
+    uint8_t dbusNamed = 0;
+
+    /** @brief whether the requester has given up on the response
+     *
+     *  The yielding D-Bus helpers of ipmid/utils.hpp fail at once with
+     *  timed_out for an expired request, so that a handler walking many
+     *  objects stops at its next call; handlers may check it too.
+     */
+    bool expired() const
+    {
+        return deadline && std::chrono::steady_clock::now() >= *deadline;
+    }
 };
 
 namespace message
@@ -80,6 +102,9 @@ struct UnpackSingle;
 template <typename T>
 using UnpackSingle_t = UnpackSingle<utility::TypeIdDowncast_t<T>>;
 
+template <typename T, typename>
+struct UnpackFixed;
+
 template <typename A>
 struct PackSingle;
 
@@ -91,6 +116,62 @@ static constexpr size_t bitStreamSize = ((sizeof(uint64_t) + 1) * CHAR_BIT);
 
 } // namespace details
 
+/**
+ * @brief a non-owning view of request bytes
+ *
+ * A handler that takes a ByteSpan instead of a std::vector<uint8_t> gets the
+ * remainder of the request without a copy. The view points into the request
+ * payload, which lives until the handler returns, so the handler must copy
+ * out anything it keeps beyond that.
+ */
+struct ByteSpan
+{
+    ByteSpan() = default;
+    ByteSpan(const uint8_t* data, size_t size) : ptr(data), len(size)
+    {
+    }
+
+    const uint8_t* data() const
+    {
+        return ptr;
+    }
+    size_t size() const
+    {
+        return len;
+    }
+    bool empty() const
+    {
+        return len == 0;
+    }
+    const uint8_t* begin() const
+    {
+        return ptr;
+    }
+    const uint8_t* end() const
+    {
+        return ptr + len;
+    }
+    const uint8_t& operator[](size_t index) const
+    {
+        return ptr[index];
+    }
+    /**
+     * @brief return a view of part of this one
+     *
+     * @param offset - first byte of the part, clamped to the size
+     * @param count - number of bytes, clamped to the bytes left
+     */
+    ByteSpan subspan(size_t offset, size_t count = SIZE_MAX) const
+    {
+        offset = std::min(offset, len);
+        return ByteSpan(ptr + offset, std::min(count, len - offset));
+    }
+
+  private:
+    const uint8_t* ptr = nullptr;
+    size_t len = 0;
+};
+
 /**
  * @brief a payload class that provides a mechanism to pack and unpack data
  *
@@ -460,6 +541,22 @@ struct Payload
     template <typename... Types>
     int unpack(std::tuple<Types...>& t)
     {
+        using Fixed = details::UnpackFixed<std::tuple<Types...>, void>;
+        if constexpr (Fixed::size > 0)
+        {
+            // whole bytes only: one length check, then plain byte loads
+            if (bitCount == 0)
+            {
+                if (raw.size() - rawIndex < Fixed::size)
+                {
+                    unpackError = true;
+                    return 1;
+                }
+                Fixed::op(raw.data() + rawIndex, t);
+                rawIndex += Fixed::size;
+                return 0;
+            }
+        }
         // roll back checkpoint so that unpacking a tuple is atomic
         size_t priorBitCount = bitCount;
         size_t priorIndex = rawIndex;
@@ -487,6 +584,141 @@ struct Payload
     bool unpackError = false;
 };
 
+namespace details
+{
+
+/**
+ * @brief recycles the response buffers
+ *
+ * A response is built in a buffer returned by an earlier response, which
+ * already has the capacity for it, instead of in a new vector that grows
+ * while the response is packed. Commands run on the ipmid main loop, the
+ * pool is per thread to stay safe for other users of the library.
+ */
+struct ResponseBufferPool
+{
+    static constexpr size_t maxBuffers = 8;
+    static constexpr size_t initialCapacity = 64;
+    // larger buffers, like the legacy scratch buffers, are not kept
+    static constexpr size_t maxCapacity = 1024;
+
+    static std::vector<uint8_t> take()
+    {
+        auto& pool = buffers();
+        if (pool.empty())
+        {
+            std::vector<uint8_t> buffer;
+            buffer.reserve(initialCapacity);
+            return buffer;
+        }
+        std::vector<uint8_t> buffer = std::move(pool.back());
+        pool.pop_back();
+        return buffer;
+    }
+
+    static void give(std::vector<uint8_t>&& buffer)
+    {
+        auto& pool = buffers();
+        if (buffer.capacity() == 0 || buffer.capacity() > maxCapacity ||
+            pool.size() >= maxBuffers)
+        {
+            return;
+        }
+        buffer.clear();
+        pool.emplace_back(std::move(buffer));
+    }
+
+  private:
+    static std::vector<std::vector<uint8_t>>& buffers()
+    {
+        thread_local std::vector<std::vector<uint8_t>> pool;
+        return pool;
+    }
+};
+
+/**
+ * @brief allocator recycling the blocks of the per request objects
+ *
+ * The Context, Request and Response of every request are allocated with
+ * std::allocate_shared and this allocator, so in steady state they reuse the
+ * blocks of the earlier requests instead of going to the heap. Each thread
+ * keeps a few free blocks of each size.
+ *
+ * @tparam T - type of the allocated objects
+ */
+template <typename T>
+struct PoolAllocator
+{
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        auto& pool = freeBlocks();
+        if (n != 1 || pool.blocks.empty())
+        {
+            return std::allocator<T>().allocate(n);
+        }
+        T* block = static_cast<T*>(pool.blocks.back());
+        pool.blocks.pop_back();
+        return block;
+    }
+
+    void deallocate(T* block, size_t n) noexcept
+    {
+        auto& pool = freeBlocks();
+        if (n != 1 || pool.blocks.size() >= maxFreeBlocks)
+        {
+            std::allocator<T>().deallocate(block, n);
+            return;
+        }
+        pool.blocks.push_back(block);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept
+    {
+        return false;
+    }
+
+  private:
+    static constexpr size_t maxFreeBlocks = 16;
+
+    struct FreeBlocks
+    {
+        FreeBlocks()
+        {
+            blocks.reserve(maxFreeBlocks);
+        }
+        ~FreeBlocks()
+        {
+            for (void* block : blocks)
+            {
+                std::allocator<T>().deallocate(static_cast<T*>(block), 1);
+            }
+        }
+        std::vector<void*> blocks;
+    };
+
+    static FreeBlocks& freeBlocks()
+    {
+        thread_local FreeBlocks pool;
+        return pool;
+    }
+};
+
+} // namespace details
+
 /**
  * @brief high-level interface to an IPMI response
  *
@@ -508,12 +740,16 @@ struct Response
     Response& operator=(const Response&) = default;
     Response(Response&&) = default;
     Response& operator=(Response&&) = default;
-    ~Response() = default;
+    ~Response()
+    {
+        details::ResponseBufferPool::give(std::move(payload.raw));
+    }
 
     using ptr = std::shared_ptr<Response>;
 
     explicit Response(Context::ptr& context) :
-        payload(), ctx(context), cc(ccSuccess)
+        payload(details::ResponseBufferPool::take()), ctx(context),
+        cc(ccSuccess)
     {
     }
 
@@ -554,7 +790,8 @@ struct Response
      * @brief Prepends another payload to this one
      *
      * Avoid using this unless absolutely required since it inserts into the
-     * front of the response payload.
+     * front of the response payload. A prefix known before the handler runs
+     * is better set with Request::setResponsePrefix.
      *
      * @param p - The payload to prepend
      *
@@ -643,8 +880,52 @@ struct Request
     template <typename... Types>
     int unpack(std::tuple<Types...>& t)
     {
-        return std::apply([this](Types&... args) { return unpack(args...); },
-                          t);
+        int unpackRet = payload.unpack(t);
+        if (unpackRet != ipmi::ccSuccess)
+        {
+            return ipmi::ccReqDataLenInvalid;
+        }
+        if (!payload.trailingOk)
+        {
+            if (!payload.fullyUnpacked())
+            {
+                // not all bits were consumed by requested parameters
+                return ipmi::ccReqDataLenInvalid;
+            }
+        }
+        return ipmi::ccSuccess;
+    }
+
+    /** @brief Set the bytes every response to this request starts with
+     *
+     * The group and OEM dispatchers echo the group or IANA of the request.
+     * Packing the prefix into the response before the handler packs its
+     * data saves shifting the whole response afterwards.
+     *
+     * @param p - the packed prefix, at most maxResponsePrefix bytes
+     *
+     * @return int - non-zero if the prefix is too long
+     */
+    int setResponsePrefix(const Payload& p)
+    {
+        return setResponsePrefix(ByteSpan(p.raw.data(), p.raw.size()));
+    }
+
+    /** @brief Set the bytes every response to this request starts with
+     *
+     * @param p - the prefix bytes, at most maxResponsePrefix
+     *
+     * @return int - non-zero if the prefix is too long
+     */
+    int setResponsePrefix(ByteSpan p)
+    {
+        if (p.size() > responsePrefix.size())
+        {
+            return 1;
+        }
+        std::copy(p.begin(), p.end(), responsePrefix.begin());
+        responsePrefixSize = p.size();
+        return 0;
     }
 
     /** @brief Create a response message that corresponds to this request
@@ -653,11 +934,23 @@ struct Request
      */
     Response::ptr makeResponse()
     {
-        return std::make_shared<Response>(ctx);
+        auto response = std::allocate_shared<Response>(
+            details::PoolAllocator<Response>(), ctx);
+        response->payload.raw.insert(
+            response->payload.raw.end(), responsePrefix.begin(),
+            responsePrefix.begin() + responsePrefixSize);
+        return response;
     }
 
+    /** @brief longest response prefix, an IANA */
+    static constexpr size_t maxResponsePrefix = 3;
+
     Payload payload;
     Context::ptr ctx;
+
+  private:
+    std::array<uint8_t, maxResponsePrefix> responsePrefix{};
+    size_t responsePrefixSize = 0;
 };
 
 } // namespace message
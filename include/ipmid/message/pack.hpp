@@ -16,6 +16,8 @@
 #pragma once
 
 #include <array>
+#include <bitset>
+#include <climits>
 #include <ipmid/message/types.hpp>
 #include <memory>
 #include <optional>
@@ -59,6 +61,57 @@ void PackBytesUnaligned(Payload& p, const NumericType& i)
     }
 }
 
+/** @struct PackedBits
+ *  @brief Number of bits a type packs into, known at compile time for the
+ *         fixed size types and 0 for the types whose size depends on the
+ *         value, such as vectors, strings and optionals
+ *
+ *  @tparam T - Type of element to pack.
+ */
+template <typename T, typename = void>
+struct PackedBits : std::integral_constant<size_t, 0>
+{
+};
+
+template <typename T>
+struct PackedBits<T, std::enable_if_t<std::is_integral_v<T>>>
+    : std::integral_constant<size_t, sizeof(T) * CHAR_BIT>
+{
+};
+
+template <>
+struct PackedBits<bool> : std::integral_constant<size_t, 1>
+{
+};
+
+template <unsigned N>
+struct PackedBits<fixed_uint_t<N>> : std::integral_constant<size_t, N>
+{
+};
+
+template <size_t N>
+struct PackedBits<std::bitset<N>> : std::integral_constant<size_t, N>
+{
+};
+
+template <typename T, size_t N>
+struct PackedBits<std::array<T, N>>
+    : std::integral_constant<size_t, N * PackedBits<T>::value>
+{
+};
+
+template <typename... T>
+struct PackedBits<std::tuple<T...>>
+    : std::integral_constant<size_t, ((PackedBits<T>::value != 0) && ...)
+                                         ? (PackedBits<T>::value + ... + 0)
+                                         : 0>
+{
+};
+
+/** @brief Number of bytes a type packs into, 0 if it depends on the value */
+template <typename T>
+constexpr size_t packedSize = (PackedBits<T>::value + CHAR_BIT - 1) / CHAR_BIT;
+
 /** @struct PackSingle
  *  @brief Utility to pack a single C++ element into a Payload
  *
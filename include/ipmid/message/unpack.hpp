@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <ipmid/message/types.hpp>
 #include <optional>
@@ -36,7 +37,7 @@ namespace details
  **************************************/
 
 template <typename NumericType, size_t byteIndex = 0>
-void UnpackBytes(uint8_t* pointer, NumericType& i)
+void UnpackBytes(const uint8_t* pointer, NumericType& i)
 {
     if constexpr (byteIndex < sizeof(NumericType))
     {
@@ -56,6 +57,83 @@ void UnpackBytesUnaligned(Payload& p, NumericType& i)
     }
 }
 
+/** @struct UnpackFixed
+ *  @brief Utility to unpack a whole-byte, fixed size element straight from
+ *         the raw bytes of a Payload
+ *
+ *  Payload::unpack uses it for argument tuples made only of integers and
+ *  arrays of integers, which covers most commands, so the arguments are
+ *  decoded after a single length check instead of one check per element.
+ *  size is 0 for any other type, which is left to UnpackSingle.
+ *
+ *  @tparam T - Type of element to unpack.
+ */
+template <typename T, typename = void>
+struct UnpackFixed
+{
+    static constexpr size_t size = 0;
+};
+
+template <typename T>
+struct UnpackFixed<
+    T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+{
+    static constexpr size_t size = sizeof(T);
+
+    /** @brief Do the operation to unpack element.
+     *
+     *  @param[in] pointer - size bytes to unpack from.
+     *  @param[out] t - The reference to unpack item into.
+     */
+    static void op(const uint8_t* pointer, T& t)
+    {
+        t = 0;
+        UnpackBytes<T>(pointer, t);
+    }
+};
+
+template <typename T, size_t N>
+struct UnpackFixed<std::array<T, N>, void>
+{
+    static constexpr size_t size = N * UnpackFixed<T>::size;
+
+    static void op(const uint8_t* pointer, std::array<T, N>& t)
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+        {
+            std::copy_n(pointer, N, t.begin());
+        }
+        else
+        {
+            for (auto& v : t)
+            {
+                UnpackFixed<T>::op(pointer, v);
+                pointer += UnpackFixed<T>::size;
+            }
+        }
+    }
+};
+
+template <typename... T>
+struct UnpackFixed<std::tuple<T...>, void>
+{
+    static constexpr size_t size =
+        ((UnpackFixed<utility::TypeIdDowncast_t<T>>::size != 0) && ...)
+            ? (UnpackFixed<utility::TypeIdDowncast_t<T>>::size + ... + 0)
+            : 0;
+
+    static void op(const uint8_t* pointer, std::tuple<T...>& t)
+    {
+        std::apply(
+            [&pointer](T&... args) {
+                ((UnpackFixed<utility::TypeIdDowncast_t<T>>::op(pointer, args),
+                  pointer += UnpackFixed<utility::TypeIdDowncast_t<T>>::size),
+                 ...);
+            },
+            t);
+    }
+};
+
 /** @struct UnpackSingle
  *  @brief Utility to unpack a single C++ element from a Payload
  *
@@ -324,6 +402,22 @@ struct UnpackSingle<std::vector<uint8_t>>
     }
 };
 
+/** @brief Specialization of UnpackSingle for ByteSpan
+ *
+ *  Like std::vector<uint8_t>, the span takes the remainder of the message,
+ *  but it points into the payload instead of copying the bytes out.
+ */
+template <>
+struct UnpackSingle<ByteSpan>
+{
+    static int op(Payload& p, ByteSpan& t)
+    {
+        t = ByteSpan(p.raw.data() + p.rawIndex, p.raw.size() - p.rawIndex);
+        p.rawIndex = p.raw.size();
+        return 0;
+    }
+};
+
 /** @brief Specialization of UnpackSingle for Payload */
 template <>
 struct UnpackSingle<Payload>
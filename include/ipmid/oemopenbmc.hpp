@@ -15,6 +15,21 @@ enum Cmd
     i2cCmd = 2,
     flashCmd = 3,
     fanManualCmd = 4,
+    getMultipleSensorReadingsCmd = 5,
+    readSelChunkCmd = 6,
+    beginUserConfigCmd = 7,
+    commitUserConfigCmd = 8,
+    getLanSnapshotCmd = 9,
+    getPowerCapStatsCmd = 10,
+    getChassisTransitionStatusCmd = 11,
+    getCommandStatsCmd = 12,
+    getSensorSnapshotCmd = 13,
+    getSdrChangesCmd = 14,
+    getSensorReadStatsCmd = 15,
+    getMapperCacheStatsCmd = 16,
+    getChannelUserAccessCmd = 17,
+    readSdrImageCmd = 18,
+    subscribeSensorChangesCmd = 19,
     ethStatsCmd = 48,
     blobTransferCmd = 128,
 };
@@ -24,6 +24,125 @@ using Handler = std::function<ipmi_ret_t(ipmi_cmd_t,          // cmd byte
                                          std::uint8_t*,       // replyBuf
                                          std::size_t*)>;      // dataLen
 
+/// Handler signature of the commands routed by a StaticRouter.
+/// Unlike Handler it is a plain function that reads the request and writes
+/// the reply in place, without the OemGroup bytes.
+///
+/// @param[in] cmd - the Command.
+/// @param[in] reqBuf - request data.
+/// @param[in] reqLen - length of reqBuf.
+/// @param[out] replyBuf - reply data.
+/// @param[in,out] replyLen - size of replyBuf upon call, should be set to
+///                           the length of the reply upon return.
+using SpanHandler = ipmi_ret_t (*)(ipmi_cmd_t, const std::uint8_t*,
+                                   std::size_t, std::uint8_t*, std::size_t*);
+
+/// Size of the reply buffer passed to a SpanHandler.
+constexpr std::size_t maxSpanReplySize = 1024;
+
+/// Router for a set of OEM Numbers known at compile time.
+/// @brief Each OEN gets an array of handlers indexed by command, so routing
+///        is a search over the handful of OENs plus an array index, with no
+///        map, std::function or copied buffer involved.
+///
+/// @tparam oens - the OEM Numbers routed.
+template <Number... oens>
+class StaticRouter
+{
+  public:
+    static constexpr std::size_t oenCount = sizeof...(oens);
+    static constexpr std::array<Number, oenCount> numbers{oens...};
+
+    /// Index of an OEN in numbers.
+    ///
+    /// @param[in] oen - the OEM Number.
+    /// @return the index, oenCount if the OEN is not routed.
+    static constexpr std::size_t indexOf(Number oen)
+    {
+        for (std::size_t index = 0; index < oenCount; index++)
+        {
+            if (numbers[index] == oen)
+            {
+                return index;
+            }
+        }
+        return oenCount;
+    }
+
+    /// Register a handler for given OEMNumber & cmd.
+    /// Use IPMI_CMD_WILDCARD to catch any unregistered cmd
+    /// for the given OEMNumber.
+    ///
+    /// @param[in] oen - the OEM Number.
+    /// @param[in] cmd - the Command.
+    /// @param[in] handler - the handler to call given that OEN and
+    ///                      command.
+    /// @return false if the OEN is not routed.
+    constexpr bool registerHandler(Number oen, ipmi_cmd_t cmd,
+                                   SpanHandler handler)
+    {
+        std::size_t index = indexOf(oen);
+        if (index == oenCount)
+        {
+            return false;
+        }
+        if (cmd == IPMI_CMD_WILDCARD)
+        {
+            wildcards[index] = handler;
+        }
+        else
+        {
+            commands[index][cmd] = handler;
+        }
+        return true;
+    }
+
+    /// Find the handler of a command of the OEN at an index.
+    ///
+    /// @param[in] index - index of the OEN, less than oenCount.
+    /// @param[in] cmd - the Command.
+    /// @return the handler, nullptr if none is registered.
+    constexpr SpanHandler at(std::size_t index, ipmi_cmd_t cmd) const
+    {
+        SpanHandler handler = commands[index][cmd];
+        return handler ? handler : wildcards[index];
+    }
+
+    /// Find the handler of a command.
+    ///
+    /// @param[in] oen - the OEM Number.
+    /// @param[in] cmd - the Command.
+    /// @return the handler, nullptr if none is registered.
+    constexpr SpanHandler find(Number oen, ipmi_cmd_t cmd) const
+    {
+        std::size_t index = indexOf(oen);
+        return index == oenCount ? nullptr : at(index, cmd);
+    }
+
+    /// Route a command to its handler.
+    ///
+    /// @return the completion code of the handler, IPMI_CC_INVALID if
+    ///         there is none.
+    ipmi_ret_t route(Number oen, ipmi_cmd_t cmd, const std::uint8_t* reqBuf,
+                     std::size_t reqLen, std::uint8_t* replyBuf,
+                     std::size_t* replyLen) const
+    {
+        SpanHandler handler = find(oen, cmd);
+        if (!handler)
+        {
+            *replyLen = 0;
+            return IPMI_CC_INVALID;
+        }
+        return handler(cmd, reqBuf, reqLen, replyBuf, replyLen);
+    }
+
+  private:
+    static constexpr std::size_t commandCount = IPMI_CMD_WILDCARD + 1;
+
+    std::array<std::array<SpanHandler, commandCount>, oenCount> commands{};
+    std::array<SpanHandler, oenCount> wildcards{};
+};
+
 /// Router Interface class.
 /// @brief Abstract Router Interface
 class Router
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/* Static probes for profiling ipmid on a live BMC with bpftrace or perf,
+ * placed where a request enters, is filtered, runs its handler and makes
+ * its D-Bus calls through the libipmid helpers.
+ *
+ * Built with --enable-usdt-probes, each probe is a sys/sdt.h USDT probe of
+ * the ipmid provider: a nop instruction until a tracer attaches to it, and
+ * listed by `bpftrace -l 'usdt:/usr/bin/ipmid:*'`. Built without it, the
+ * probes and their arguments compile away. Every probe carries the netFn
+ * and cmd of its request, with ffh, ffh for the D-Bus calls made outside of
+ * a handler:
+ *
+ *  request__start   netFn, lun, cmd, channel, request bytes
+ *  filter           netFn, cmd, channel, completion code of one filter
+ *  handler__start   netFn, cmd, channel
+ *  handler__done    netFn, cmd, channel, completion code, microseconds
+ *  command__done    netFn, cmd, channel, completion code, microseconds
+ *                   from the dispatch to the response, filters included
+ *  dbus__call       netFn, cmd
+ *  dbus__return     netFn, cmd, failed, microseconds
+ *
+ * The probes have semaphores, a tracer that does not count them up sees
+ * none of them fire.
+ */
+
+#ifdef IPMID_USDT_PROBES
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/* Every probe has a sys/sdt.h semaphore, which a tracer counts up while it
+ * is attached to the probe. The arguments of a probe, and the timing they
+ * need, are only computed while its semaphore is up. The semaphore of a
+ * probe is defined once, with IPMID_PROBE_SEMAPHORE, in the binary or the
+ * library that places the probe. */
+#define IPMID_PROBE_SEMAPHORE(name)                                           \
+    __extension__ volatile unsigned short ipmid_##name##_semaphore            \
+        __attribute__((unused)) __attribute__((section(".probes")))
+
+extern volatile unsigned short ipmid_request__start_semaphore;
+extern volatile unsigned short ipmid_filter_semaphore;
+extern volatile unsigned short ipmid_handler__start_semaphore;
+extern volatile unsigned short ipmid_handler__done_semaphore;
+extern volatile unsigned short ipmid_command__done_semaphore;
+extern volatile unsigned short ipmid_dbus__call_semaphore;
+extern volatile unsigned short ipmid_dbus__return_semaphore;
+
+#define IPMID_PROBE_ENABLED(name)                                             \
+    __builtin_expect(ipmid_##name##_semaphore != 0, 0)
+#define IPMID_PROBE(name, ...)                                                \
+    do                                                                        \
+    {                                                                         \
+        if (IPMID_PROBE_ENABLED(name))                                        \
+        {                                                                     \
+            STAP_PROBEV(ipmid, name, __VA_ARGS__);                            \
+        }                                                                     \
+    } while (0)
+#else
+#define IPMID_PROBE_SEMAPHORE(name) static_assert(true)
+#define IPMID_PROBE_ENABLED(name) false
+#define IPMID_PROBE(...) static_cast<void>(0)
+#endif
+
+namespace ipmi
+{
+namespace probes
+{
+
+/** @class Timer
+ *  @brief the time since its construction, for the latency a probe
+ *         carries; nothing is timed unless a tracer is attached to the
+ *         probe when the timer is constructed
+ */
+class Timer
+{
+  public:
+#ifdef IPMID_USDT_PROBES
+    /** @param[in] enabled - IPMID_PROBE_ENABLED of the probe */
+    explicit Timer(bool enabled)
+    {
+        if (enabled)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    /** @brief microseconds since the construction, 0 if not timed */
+    uint64_t us() const
+    {
+        if (start == std::chrono::steady_clock::time_point())
+        {
+            return 0;
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point start;
+#else
+    explicit Timer(bool)
+    {
+    }
+#endif
+};
+
+} // namespace probes
+} // namespace ipmi
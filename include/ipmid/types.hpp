@@ -140,13 +140,13 @@ enum class Mutability
     Write = 1 << 1,
 };
 
-inline Mutability operator|(Mutability lhs, Mutability rhs)
+constexpr Mutability operator|(Mutability lhs, Mutability rhs)
 {
     return static_cast<Mutability>(static_cast<uint8_t>(lhs) |
                                    static_cast<uint8_t>(rhs));
 }
 
-inline Mutability operator&(Mutability lhs, Mutability rhs)
+constexpr Mutability operator&(Mutability lhs, Mutability rhs)
 {
     return static_cast<Mutability>(static_cast<uint8_t>(lhs) &
                                    static_cast<uint8_t>(rhs));
@@ -3,6 +3,7 @@
 #include <boost/system/error_code.hpp>
 #include <chrono>
 #include <ipmid/api-types.hpp>
+#include <ipmid/dbus-stats.hpp>
 #include <ipmid/message.hpp>
 #include <ipmid/types.hpp>
 #include <optional>
@@ -80,6 +81,23 @@ class ServiceCache
      */
     bool isValid(sdbusplus::bus::bus& bus) const;
 
+    /** @brief Gets the service name from the cache or does a yielding
+     *         lookup when invalid.
+     *
+     *  @param[in] ctx - ipmi::Context::ptr, used for looking up the service
+     *  @param[out] service - The service name
+     *  @return - boost error code object
+     */
+    boost::system::error_code getService(Context::ptr ctx,
+                                         std::string& service);
+
+    /** @brief Check to see if the current cache is valid
+     *
+     * @param[in] ctx - ipmi::Context::ptr of the bus used for the lookup
+     * @return True if the cache is valid false otherwise.
+     */
+    bool isValid(Context::ptr ctx) const;
+
   private:
     /** @brief DBUS interface provided by the service */
     const std::string intf;
@@ -91,6 +109,28 @@ class ServiceCache
     std::optional<std::string> cachedBusName;
 };
 
+/** @struct DbusCache
+ *  @brief Opts a D-Bus lookup into the process wide cache of services and
+ *         properties.
+ *
+ * Answers are kept per (interface, path) for services and per (service,
+ * path, interface) for properties, and reused for maxAge, or for the life of
+ * the process when maxAge is zero. With track set the cached properties are
+ * kept current from the PropertiesChanged signals of the object. Services
+ * are forgotten when they leave the bus, and the properties written through
+ * setDbusProperty are dropped from the cache. A lookup with bypass set reads
+ * from D-Bus and the answer replaces the cached one.
+ */
+struct DbusCache
+{
+    std::chrono::steady_clock::duration maxAge{};
+    bool track = false;
+    bool bypass = false;
+};
+
+/** @brief Drops everything held in the D-Bus cache */
+void clearDbusCache();
+
 /**
  * @brief Get the DBUS Service name for the input dbus path
  *
@@ -102,6 +142,17 @@ class ServiceCache
 std::string getService(sdbusplus::bus::bus& bus, const std::string& intf,
                        const std::string& path);
 
+/** @brief Get the DBUS Service name for the input dbus path, from the D-Bus
+ *         cache when it holds a fresh answer
+ *
+ * @param[in] bus - DBUS Bus Object
+ * @param[in] intf - DBUS Interface
+ * @param[in] path - DBUS Object Path
+ * @param[in] cache - how the cached answer is used
+ */
+std::string getService(sdbusplus::bus::bus& bus, const std::string& intf,
+                       const std::string& path, const DbusCache& cache);
+
 /** @brief Gets the dbus object info implementing the given interface
  *         from the given subtree.
  *  @param[in] bus - DBUS Bus Object.
@@ -129,6 +180,21 @@ Value getDbusProperty(sdbusplus::bus::bus& bus, const std::string& service,
                       const std::string& property,
                       std::chrono::microseconds timeout = IPMI_DBUS_TIMEOUT);
 
+/** @brief Gets the value associated with the given object and the
+ *         interface, from the D-Bus cache when it holds a fresh answer.
+ *         A miss reads all the properties of the interface at once.
+ *  @param[in] bus - DBUS Bus Object.
+ *  @param[in] service - Dbus service name.
+ *  @param[in] objPath - Dbus object path.
+ *  @param[in] interface - Dbus interface.
+ *  @param[in] property - name of the property.
+ *  @param[in] cache - how the cached answer is used
+ *  @return On success returns the value of the property.
+ */
+Value getDbusProperty(sdbusplus::bus::bus& bus, const std::string& service,
+                      const std::string& objPath, const std::string& interface,
+                      const std::string& property, const DbusCache& cache);
+
 /** @brief Gets all the properties associated with the given object
  *         and the interface.
  *  @param[in] bus - DBUS Bus Object.
@@ -143,6 +209,21 @@ PropertyMap
                          const std::string& interface,
                          std::chrono::microseconds timeout = IPMI_DBUS_TIMEOUT);
 
+/** @brief Gets all the properties associated with the given object and the
+ *         interface, from the D-Bus cache when it holds a fresh answer.
+ *  @param[in] bus - DBUS Bus Object.
+ *  @param[in] service - Dbus service name.
+ *  @param[in] objPath - Dbus object path.
+ *  @param[in] interface - Dbus interface.
+ *  @param[in] cache - how the cached answer is used
+ *  @return On success returns the map of name value pair.
+ */
+PropertyMap getAllDbusProperties(sdbusplus::bus::bus& bus,
+                                 const std::string& service,
+                                 const std::string& objPath,
+                                 const std::string& interface,
+                                 const DbusCache& cache);
+
 /** @brief Gets all managed objects associated with the given object
  *         path and service.
  *  @param[in] bus - D-Bus Bus Object.
@@ -248,6 +329,15 @@ static inline boost::system::error_code
     return getDbusObject(ctx, interface, subtreePath, {}, dbusObject);
 }
 
+/** @brief the error of the yielding calls of an expired request, which are
+ *         not made
+ */
+inline boost::system::error_code requestExpired()
+{
+    return boost::system::errc::make_error_code(
+        boost::system::errc::timed_out);
+}
+
 /** @brief Gets the value associated with the given object
  *         and the interface.
  *  @param[in] ctx - ipmi::Context::ptr
@@ -264,10 +354,16 @@ boost::system::error_code
                     const std::string& objPath, const std::string& interface,
                     const std::string& property, Type& propertyValue)
 {
+    if (ctx->expired())
+    {
+        return requestExpired();
+    }
     boost::system::error_code ec;
+    dbus_stats::Call call(*ctx);
     auto variant = ctx->bus->yield_method_call<std::variant<Type>>(
         ctx->yield, ec, service.c_str(), objPath.c_str(), PROP_INTF, METHOD_GET,
         interface, property);
+    call.check(bool(ec));
     if (!ec)
     {
         Type* tmp = std::get_if<Type>(&variant);
@@ -367,7 +463,8 @@ boost::system::error_code getManagedObjects(Context::ptr ctx,
  *  @param[in] path - Child D-Bus object path.
  *  @param[in] interfaces - D-Bus interface list.
  *  @param[out] ObjectTree - map of object path and service info.
- *  @return - boost error code object
+ *  @return - boost error code object, an error if no ancestor implements
+ *            the interfaces
  */
 boost::system::error_code getAllAncestors(Context::ptr ctx,
                                           const std::string& path,
@@ -438,15 +535,34 @@ void callDbusMethod(sdbusplus::bus::bus& bus, const std::string& service,
                     const std::string& objPath, const std::string& interface,
                     const std::string& method);
 
+/** @brief Calls the Dbus method, yielding until the response.
+ *  @param[in] ctx - ipmi::Context::ptr
+ *  @param[in] service - Dbus service name.
+ *  @param[in] objPath - Dbus object path.
+ *  @param[in] interface - Dbus interface.
+ *  @param[in] method - Dbus method.
+ *  @return - boost error code object
+ */
+boost::system::error_code callDbusMethod(Context::ptr ctx,
+                                         const std::string& service,
+                                         const std::string& objPath,
+                                         const std::string& interface,
+                                         const std::string& method);
+
 } // namespace method_no_args
 
 /** @brief Perform the low-level i2c bus write-read.
+ *
+ *  The bus device is opened on the first transfer and kept open. Transfers
+ *  on the same bus are serialized, so this can be called from the handler
+ *  worker threads.
+ *
  *  @param[in] i2cBus - i2c bus device node name, such as /dev/i2c-2.
  *  @param[in] slaveAddr - i2c device slave address.
  *  @param[in] writeData - The data written to i2c device.
  *  @param[out] readBuf - Data read from the i2c device.
  */
-ipmi::Cc i2cWriteRead(std::string i2cBus, const uint8_t slaveAddr,
-                      std::vector<uint8_t> writeData,
+ipmi::Cc i2cWriteRead(const std::string& i2cBus, const uint8_t slaveAddr,
+                      const std::vector<uint8_t>& writeData,
                       std::vector<uint8_t>& readBuf);
 } // namespace ipmi
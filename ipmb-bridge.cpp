@@ -0,0 +1,313 @@
+#include "config.h"
+
+#include "ipmb-bridge.hpp"
+
+#include "ipmb-message.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <deque>
+#include <ipmid/api.hpp>
+#include <optional>
+#include <phosphor-logging/log.hpp>
+#include <utility>
+#include <vector>
+
+namespace ipmi
+{
+namespace ipmb
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+constexpr auto bridgeService = "xyz.openbmc_project.Ipmi.Channel.Ipmb";
+constexpr auto bridgePath = "/xyz/openbmc_project/Ipmi/Channel/Ipmb";
+constexpr auto bridgeIntf = "org.openbmc.Ipmb";
+
+/** @brief channels of ipmbbridged: the management engine is reached at its
+ *         own address, every other target on the IPMB channel
+ */
+constexpr uint8_t bridgeChannelMe = 0;
+constexpr uint8_t bridgeChannelIpmb = 1;
+constexpr uint8_t meSlaveAddr = 0x2C;
+
+/** @brief sendRequest status of a request the target answered, and of one
+ *         ipmbbridged had no sequence number free for and did not send
+ */
+constexpr int bridgeSuccess = 0;
+constexpr int bridgeBusy = 3;
+/** @brief sendRequest status of a request the target did not answer within
+ *         the retries and timeout of ipmbbridged
+ */
+constexpr int bridgeTimeout = 4;
+
+/** @brief Send Message completion code of a request that was not answered */
+constexpr Cc ccNakOnWrite = 0x83;
+/** @brief Get Message completion code of an empty queue */
+constexpr Cc ccDataNotAvailable = 0x80;
+/** @brief completion code of the response queued for a failed request */
+constexpr Cc ccTimeoutResponse = 0xC3;
+
+/** @brief IPMB sequence numbers, 6 bits */
+constexpr size_t sequenceNumbers = 64;
+
+/** @struct Target
+ *  @brief the sequence numbers in flight to one target and its counters
+ */
+struct Target
+{
+    std::bitset<sequenceNumbers> inFlight;
+    TargetStats stats;
+};
+
+/** @brief targets keyed by (channel << 8) | slave address, never erased so
+ *         the requests in flight can hold on to theirs
+ */
+std::map<uint16_t, Target> targets;
+
+/** @brief Get Message data of the responses waiting for each system
+ *         interface channel
+ */
+std::map<uint8_t, std::deque<std::vector<uint8_t>>> received;
+
+uint16_t makeKey(const Request& request)
+{
+    return static_cast<uint16_t>(request.channel << 8 | request.rsSA);
+}
+
+bool isMedium(int channel, EChannelMediumType medium)
+{
+    ChannelInfo chInfo{};
+    return getChannelInfo(static_cast<uint8_t>(channel), chInfo) ==
+               ccSuccess &&
+           static_cast<EChannelMediumType>(chInfo.mediumType) == medium;
+}
+
+/** @brief take the sequence number of a request at its target, false when
+ *         it is in flight already
+ */
+bool reserve(const Request& request)
+{
+    Target& target = targets[makeKey(request)];
+    if (target.inFlight.test(request.rqSeq))
+    {
+        target.stats.busy++;
+        return false;
+    }
+    target.inFlight.set(request.rqSeq);
+    target.stats.requests++;
+    target.stats.inFlight++;
+    target.stats.peakInFlight =
+        std::max(target.stats.peakInFlight, target.stats.inFlight);
+    return true;
+}
+
+/** @brief send a request through ipmbbridged until the target answers it
+ *
+ *  ipmbbridged retries and times out the request on the bus itself, it is
+ *  only sent again when ipmbbridged reports it did not send it.
+ */
+std::optional<Reply> transact(Target& target, const Request& request,
+                              boost::asio::yield_context yield)
+{
+    uint8_t bridgeChannel =
+        request.rsSA == meSlaveAddr ? bridgeChannelMe : bridgeChannelIpmb;
+    for (unsigned int attempt = 0; attempt <= maxRetries; attempt++)
+    {
+        if (attempt)
+        {
+            target.stats.retries++;
+            boost::asio::steady_timer delay(*getIoContext(), busyRetryDelay);
+            boost::system::error_code ec;
+            delay.async_wait(yield[ec]);
+        }
+        boost::system::error_code ec;
+        auto [status, netFn, lun, cmd, cc, data] =
+            getSdBus()
+                ->yield_method_call<int, uint8_t, uint8_t, uint8_t, uint8_t,
+                                    std::vector<uint8_t>>(
+                    yield, ec, bridgeService, bridgePath, bridgeIntf,
+                    "sendRequest", bridgeChannel, request.netFn,
+                    request.rsLun, request.cmd, request.data);
+        if (ec)
+        {
+            return std::nullopt;
+        }
+        if (status == bridgeSuccess)
+        {
+            return Reply{cc, std::move(data)};
+        }
+        if (status == bridgeTimeout)
+        {
+            target.stats.timeouts++;
+        }
+        if (status != bridgeBusy)
+        {
+            return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+/** @brief bridge a reserved request and release its sequence number */
+std::optional<Reply> bridge(const Request& request,
+                            boost::asio::yield_context yield)
+{
+    Target& target = targets[makeKey(request)];
+    auto start = std::chrono::steady_clock::now();
+    std::optional<Reply> reply = transact(target, request, yield);
+    target.inFlight.reset(request.rqSeq);
+    target.stats.inFlight--;
+    if (!reply)
+    {
+        target.stats.failures++;
+        log<level::ERR>("Bridged IPMB request failed",
+                        entry("CHANNEL=%u", request.channel),
+                        entry("SLAVE_ADDR=0x%X", request.rsSA),
+                        entry("NETFN=0x%X", request.netFn),
+                        entry("CMD=0x%X", request.cmd));
+        return std::nullopt;
+    }
+    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    target.stats.responses++;
+    target.stats.totalUs += us;
+    target.stats.maxUs = std::max(target.stats.maxUs, us);
+    return reply;
+}
+
+/** @brief queue the response of a request for Get Message; a failed request
+ *         gets a timeout response, so its requester can let go of it
+ */
+void queueResponse(uint8_t channel, const Request& request,
+                   const std::optional<Reply>& reply)
+{
+    std::deque<std::vector<uint8_t>>& queue = received[channel];
+    if (queue.size() >= maxQueuedResponses)
+    {
+        queue.pop_front();
+    }
+    queue.push_back(encodeGetMessage(
+        request, reply ? *reply : Reply{ccTimeoutResponse, {}}));
+}
+
+/** @brief implements the Send Message command for IPMB channels
+ *
+ *  @param[in] ctx - context of the request
+ *  @param[in] channel - channel to send the message on
+ *  @param[in] authentication - ignored, IPMB has no sessions
+ *  @param[in] encryption - ignored, IPMB has no sessions
+ *  @param[in] tracking - ignored, requests are always tracked
+ *  @param[in] message - the IPMB request, checksums included
+ *
+ *  @return IPMI completion code plus response data
+ *   - the IPMB response, when not sent from a system interface
+ */
+ipmi::RspType<std::vector<uint8_t>>
+    ipmiAppSendMessage(ipmi::Context::ptr ctx, uint4_t channel,
+                       bool authentication, bool encryption, uint2_t tracking,
+                       std::vector<uint8_t> message)
+{
+    uint8_t chNum = static_cast<uint8_t>(channel);
+    if (!isMedium(chNum, EChannelMediumType::ipmb))
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
+    std::optional<Request> request = decode(chNum, message);
+    if (!request)
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
+    if (!reserve(*request))
+    {
+        return ipmi::responseBusy();
+    }
+
+    if (isMedium(ctx->channel, EChannelMediumType::systemInterface))
+    {
+        uint8_t source = static_cast<uint8_t>(ctx->channel);
+        boost::asio::spawn(
+            *getIoContext(), [source, request = std::move(*request)](
+                                 boost::asio::yield_context yield) {
+                queueResponse(source, request, bridge(request, yield));
+            });
+        return ipmi::responseSuccess(std::vector<uint8_t>{});
+    }
+
+    std::optional<Reply> reply = bridge(*request, ctx->yield);
+    if (!reply)
+    {
+        return ipmi::response(ccNakOnWrite);
+    }
+    return ipmi::responseSuccess(encode(*request, *reply));
+}
+
+/** @brief implements the Get Message command
+ *
+ *  @param[in] ctx - context of the request
+ *
+ *  @return IPMI completion code plus response data
+ *   - the channel and the IPMB response of the oldest bridged request
+ */
+ipmi::RspType<std::vector<uint8_t>> ipmiAppGetMessage(ipmi::Context::ptr ctx)
+{
+    auto queue = received.find(static_cast<uint8_t>(ctx->channel));
+    if (queue == received.end() || queue->second.empty())
+    {
+        return ipmi::response(ccDataNotAvailable);
+    }
+    std::vector<uint8_t> message = std::move(queue->second.front());
+    queue->second.pop_front();
+    return ipmi::responseSuccess(std::move(message));
+}
+
+} // namespace
+
+std::map<uint16_t, TargetStats> getStats()
+{
+    std::map<uint16_t, TargetStats> stats;
+    for (const auto& [key, target] : targets)
+    {
+        stats.emplace(key, target.stats);
+    }
+    return stats;
+}
+
+void reset()
+{
+    for (auto& [key, target] : targets)
+    {
+        uint64_t inFlight = target.stats.inFlight;
+        target.stats = TargetStats{};
+        target.stats.inFlight = inFlight;
+        target.stats.peakInFlight = inFlight;
+    }
+}
+
+bool messageAvailable(uint8_t channel)
+{
+    auto queue = received.find(channel);
+    return queue != received.end() && !queue->second.empty();
+}
+
+void registerBridging()
+{
+    // <Send Message>
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
+                          ipmi::app::cmdSendMessage, ipmi::Privilege::User,
+                          ipmiAppSendMessage);
+
+    // <Get Message>
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
+                          ipmi::app::cmdGetMessage, ipmi::Privilege::User,
+                          ipmiAppGetMessage);
+}
+
+} // namespace ipmb
+} // namespace ipmi
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+namespace ipmi
+{
+namespace ipmb
+{
+
+/* Send Message and Get Message bridging to the controllers on the IPMB
+ * channels, through the sendRequest method of ipmbbridged.
+ *
+ * A bridged request is tracked by the sequence number its requester gave it
+ * in the encapsulated IPMB message, per target: up to 64 requests can be in
+ * flight to one target, and as many targets as there are answered at once,
+ * since every request waits for ipmbbridged in a coroutine of its own. A
+ * request reusing a sequence number still in flight to its target is
+ * refused as busy, because its response could not be told apart.
+ *
+ * Requests sent from a system interface are answered at once, their
+ * response is queued for Get Message of the same channel and flagged by
+ * Get Message Flags. Requests sent from any other channel wait for the
+ * response, which comes back in the Send Message response data.
+ *
+ * ipmbbridged retries a request on the bus and times it out itself. A
+ * request is only sent again when ipmbbridged had no sequence number free
+ * for it and did not send it. */
+
+/** @brief wait before a request ipmbbridged did not send is sent again */
+constexpr std::chrono::milliseconds busyRetryDelay(50);
+
+/** @brief attempts of a request ipmbbridged did not send, after the first */
+constexpr unsigned int maxRetries = 2;
+
+/** @brief most responses queued for Get Message per channel, the oldest is
+ *         dropped to make room
+ */
+constexpr size_t maxQueuedResponses = 32;
+
+/** @struct TargetStats
+ *  @brief counters of the requests bridged to one target since the start
+ */
+struct TargetStats
+{
+    /** @brief requests accepted */
+    uint64_t requests = 0;
+    /** @brief requests answered by the target */
+    uint64_t responses = 0;
+    /** @brief requests sent again, as ipmbbridged did not send them */
+    uint64_t retries = 0;
+    /** @brief requests ipmbbridged got no answer in time to */
+    uint64_t timeouts = 0;
+    /** @brief requests failed after their last attempt */
+    uint64_t failures = 0;
+    /** @brief requests refused for a sequence number in flight */
+    uint64_t busy = 0;
+    /** @brief requests in flight, and the most there ever were */
+    uint64_t inFlight = 0;
+    uint64_t peakInFlight = 0;
+    /** @brief time from acceptance to response of the answered requests */
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+};
+
+/** @brief get the counters of every target, keyed by
+ *         (channel << 8) | slave address
+ */
+std::map<uint16_t, TargetStats> getStats();
+
+/** @brief clear the counters, except the requests in flight */
+void reset();
+
+/** @brief check whether responses are queued for Get Message
+ *
+ *  @param[in] channel - the system interface channel asking
+ */
+bool messageAvailable(uint8_t channel);
+
+/** @brief register the Send Message and Get Message commands, below the
+ *         priority of any provider implementing them
+ */
+void registerBridging();
+
+} // namespace ipmb
+} // namespace ipmi
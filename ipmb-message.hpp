@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ipmid/api-types.hpp>
+#include <optional>
+#include <vector>
+
+namespace ipmi
+{
+namespace ipmb
+{
+
+/* The IPMB messages of Send Message and Get Message: the request a
+ * requester encapsulates in Send Message, and the response it gets back in
+ * the Send Message response data or from Get Message. */
+
+/** @brief bytes of an IPMB message up to the header checksum, and of a
+ *         request without data
+ */
+constexpr size_t ipmbHeaderSize = 3;
+constexpr size_t ipmbMinRequestSize = 7;
+
+/** @struct Request
+ *  @brief an IPMB request encapsulated in Send Message
+ */
+struct Request
+{
+    uint8_t channel;
+    uint8_t rsSA;
+    uint8_t netFn;
+    uint8_t rsLun;
+    uint8_t rqSA;
+    uint8_t rqSeq;
+    uint8_t rqLun;
+    uint8_t cmd;
+    std::vector<uint8_t> data;
+};
+
+/** @struct Reply
+ *  @brief the answer of a target
+ */
+struct Reply
+{
+    Cc cc;
+    std::vector<uint8_t> data;
+};
+
+template <typename Iterator>
+uint8_t checksum(Iterator first, Iterator last)
+{
+    uint8_t sum = 0;
+    for (; first != last; ++first)
+    {
+        sum += *first;
+    }
+    return static_cast<uint8_t>(-sum);
+}
+
+/** @brief decode the IPMB request of a Send Message
+ *
+ *  @param[in] channel - the channel the request is sent on
+ *  @param[in] message - the request, checksums included
+ *
+ *  @return the request, nullopt when it is malformed
+ */
+inline std::optional<Request> decode(uint8_t channel,
+                                     const std::vector<uint8_t>& message)
+{
+    if (message.size() < ipmbMinRequestSize ||
+        checksum(message.begin(), message.begin() + ipmbHeaderSize) != 0 ||
+        checksum(message.begin() + ipmbHeaderSize, message.end()) != 0)
+    {
+        return std::nullopt;
+    }
+    Request request{};
+    request.channel = channel;
+    request.rsSA = message[0];
+    request.netFn = message[1] >> 2;
+    request.rsLun = message[1] & 0x03;
+    request.rqSA = message[3];
+    request.rqSeq = message[4] >> 2;
+    request.rqLun = message[4] & 0x03;
+    request.cmd = message[5];
+    request.data.assign(message.begin() + 6, message.end() - 1);
+    return request;
+}
+
+/** @brief the IPMB response to a request, as the requester gets it from the
+ *         target: rqSA, netFn/rqLUN, checksum, rsSA, rqSeq/rsLUN, cmd, cc,
+ *         data, checksum
+ */
+inline std::vector<uint8_t> encode(const Request& request, const Reply& reply)
+{
+    std::vector<uint8_t> frame{
+        request.rqSA,
+        static_cast<uint8_t>(((request.netFn | 0x01) << 2) | request.rqLun)};
+    frame.push_back(checksum(frame.begin(), frame.end()));
+    frame.push_back(request.rsSA);
+    frame.push_back(static_cast<uint8_t>(request.rqSeq << 2 | request.rsLun));
+    frame.push_back(request.cmd);
+    frame.push_back(reply.cc);
+    frame.insert(frame.end(), reply.data.begin(), reply.data.end());
+    frame.push_back(checksum(frame.begin() + ipmbHeaderSize, frame.end()));
+    return frame;
+}
+
+/** @brief the Get Message data of the response to a request
+ *
+ *  Get Message leaves out the rqSA, which is the own address of the
+ *  requester, and starts with the channel the response came in on.
+ */
+inline std::vector<uint8_t> encodeGetMessage(const Request& request,
+                                             const Reply& reply)
+{
+    std::vector<uint8_t> frame = encode(request, reply);
+    frame[0] = request.channel;
+    return frame;
+}
+
+} // namespace ipmb
+} // namespace ipmi
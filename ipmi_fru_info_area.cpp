@@ -1,12 +1,14 @@
 #include "ipmi_fru_info_area.hpp"
 
 #include <algorithm>
+#include <array>
 #include <ctime>
 #include <iomanip>
 #include <map>
 #include <numeric>
 #include <phosphor-logging/elog.hpp>
 #include <sstream>
+#include <string_view>
 
 namespace ipmi
 {
@@ -58,69 +60,136 @@ static constexpr auto fruMinSize = 0x27E0;
 // Using 0xff to match the default (blank) value in a physical EEPROM.
 static constexpr auto fruPadValue = 0xff;
 
+/** @class FruWriter
+ *
+ *  Writes FRU data into a caller provided buffer. A writer without a buffer
+ *  only counts the bytes, so the same code computes the size of an area
+ *  before it is encoded.
+ */
+class FruWriter
+{
+  public:
+    explicit FruWriter(uint8_t* data = nullptr) : data(data)
+    {
+    }
+
+    bool counting() const
+    {
+        return data == nullptr;
+    }
+
+    size_t size() const
+    {
+        return pos;
+    }
+
+    void put(uint8_t byte)
+    {
+        if (data)
+        {
+            data[pos] = byte;
+        }
+        pos++;
+    }
+
+    template <typename T>
+    void put(const T* bytes, size_t len)
+    {
+        static_assert(sizeof(T) == 1, "FRU data is written byte by byte");
+        if (data)
+        {
+            std::copy(bytes, bytes + len, data + pos);
+        }
+        pos += len;
+    }
+
+    void set(size_t offset, uint8_t byte)
+    {
+        if (data)
+        {
+            data[offset] = byte;
+        }
+    }
+
+    uint8_t checksum(size_t offset) const
+    {
+        if (!data)
+        {
+            return 0;
+        }
+        uint8_t sum = std::accumulate(data + offset, data + pos, 0);
+        return -sum;
+    }
+
+  private:
+    uint8_t* data;
+    size_t pos = 0;
+};
+
 /**
  * @brief Format Beginning of Individual IPMI FRU Data Section
  *
  * @param[in] langCode Language code
- * @param[in/out] data FRU area data
+ * @param[in/out] w FRU area writer
  */
-void preFormatProcessing(bool langCode, FruAreaData& data)
+void preFormatProcessing(bool langCode, FruWriter& w)
 {
     // Add id for version of FRU Info Storage Spec used
-    data.emplace_back(specVersion);
+    w.put(specVersion);
 
     // Add Data Size - 0 as a placeholder, can edit after the data is finalized
-    data.emplace_back(typeLengthByteNull);
+    w.put(typeLengthByteNull);
 
     if (langCode)
     {
-        data.emplace_back(englishLanguageCode);
+        w.put(englishLanguageCode);
     }
 }
 
 /**
  * @brief Append checksum of the FRU area data
  *
- * @param[in/out] data FRU area data
+ * @param[in] start offset of the FRU area
+ * @param[in/out] w FRU area writer
  */
-void appendDataChecksum(FruAreaData& data)
+void appendDataChecksum(size_t start, FruWriter& w)
 {
-    uint8_t checksumVal = std::accumulate(data.begin(), data.end(), 0);
     // Push the Zero checksum as the last byte of this data
     // This appears to be a simple summation of all the bytes
-    data.emplace_back(-checksumVal);
+    w.put(w.checksum(start));
 }
 
 /**
  * @brief Append padding bytes for the FRU area data
  *
- * @param[in/out] data FRU area data
+ * @param[in] start offset of the FRU area
+ * @param[in/out] w FRU area writer
  */
-void padData(FruAreaData& data)
+void padData(size_t start, FruWriter& w)
 {
-    uint8_t pad = (data.size() + checksumSize) % recordUnitOfMeasurement;
-    if (pad)
+    while ((w.size() - start + checksumSize) % recordUnitOfMeasurement)
     {
-        data.resize((data.size() + recordUnitOfMeasurement - pad));
+        w.put(0);
     }
 }
 
 /**
  * @brief Format End of Individual IPMI FRU Data Section
  *
- * @param[in/out] fruAreaData FRU area info data
+ * @param[in] start offset of the FRU area
+ * @param[in/out] w FRU area writer
  */
-void postFormatProcessing(FruAreaData& data)
+void postFormatProcessing(size_t start, FruWriter& w)
 {
     // This area needs to be padded to a multiple of 8 bytes (after checksum)
-    padData(data);
+    padData(start, w);
 
     // Set size of data info area
-    data.at(areaSizeOffset) =
-        (data.size() + checksumSize) / (recordUnitOfMeasurement);
+    w.set(start + areaSizeOffset, (w.size() - start + checksumSize) /
+                                      (recordUnitOfMeasurement));
 
     // Finally add area checksum
-    appendDataChecksum(data);
+    appendDataChecksum(start, w);
 }
 
 /**
@@ -128,15 +197,15 @@ void postFormatProcessing(FruAreaData& data)
  * area data.
  *
  * @param[in] propMap map of property values
- * @param[in,out] data FRU area data to be appended
+ * @param[in,out] w FRU area writer
  */
-void appendChassisType(const PropertyMap& propMap, FruAreaData& data)
+void appendChassisType(const PropertyMap& propMap, FruWriter& w)
 {
     uint8_t chassisType = 0; // Not specified
     auto iter = propMap.find(type);
-    if (iter != propMap.end())
+    if (iter != propMap.end() && !w.counting())
     {
-        auto value = iter->second;
+        const auto& value = iter->second;
         try
         {
             chassisType = std::stoi(value);
@@ -149,7 +218,7 @@ void appendChassisType(const PropertyMap& propMap, FruAreaData& data)
             chassisType = 0;
         }
     }
-    data.emplace_back(chassisType);
+    w.put(chassisType);
 }
 
 /**
@@ -157,21 +226,20 @@ void appendChassisType(const PropertyMap& propMap, FruAreaData& data)
  *
  * @param[in] key key to search for in the property inventory data
  * @param[in] propMap map of property values
- * @param[in,out] data FRU area data to be appended
+ * @param[in,out] w FRU area writer
  */
-void appendData(const Property& key, const PropertyMap& propMap,
-                FruAreaData& data)
+void appendData(const Property& key, const PropertyMap& propMap, FruWriter& w)
 {
     auto iter = propMap.find(key);
     if (iter != propMap.end())
     {
-        auto value = iter->second;
+        std::string_view value = iter->second;
         // If starts with 0x or 0X remove them
         // ex: 0x123a just take 123a
         if ((value.compare(0, 2, "0x")) == 0 ||
             (value.compare(0, 2, "0X") == 0))
         {
-            value.erase(0, 2);
+            value.remove_prefix(2);
         }
 
         // 6 bits for length as per FRU spec v1.0
@@ -184,14 +252,13 @@ void appendData(const Property& key, const PropertyMap& propMap,
         // Set the type to ascii
         uint8_t typeLength = valueLength | ipmi::fru::typeASCII;
 
-        data.emplace_back(typeLength);
-        std::copy(value.begin(), value.begin() + valueLength,
-                  std::back_inserter(data));
+        w.put(typeLength);
+        w.put(value.data(), valueLength);
     }
     else
     {
         // set 0 size
-        data.emplace_back(typeLengthByteNull);
+        w.put(typeLengthByteNull);
     }
 }
 
@@ -222,13 +289,13 @@ std::time_t timeStringToRaw(const std::string& input)
  * @brief Appends Build Date
  *
  * @param[in] propMap map of property values
- * @param[in/out] data FRU area to add the manfufacture date
+ * @param[in/out] w FRU area writer to add the manfufacture date
  */
-void appendMfgDate(const PropertyMap& propMap, FruAreaData& data)
+void appendMfgDate(const PropertyMap& propMap, FruWriter& w)
 {
     // MFG Date/Time
     auto iter = propMap.find(buildDate);
-    if ((iter != propMap.end()) && (iter->second.size() > 0))
+    if ((iter != propMap.end()) && (iter->second.size() > 0) && !w.counting())
     {
         std::time_t raw = timeStringToRaw(iter->second);
 
@@ -241,20 +308,18 @@ void appendMfgDate(const PropertyMap& propMap, FruAreaData& data)
         {
             raw -= secs_from_1970_1996;
             raw /= secs_per_min;
-            uint8_t fru_raw[3];
-            fru_raw[0] = raw & 0xFF;
-            fru_raw[1] = (raw >> 8) & 0xFF;
-            fru_raw[2] = (raw >> 16) & 0xFF;
-            std::copy(fru_raw, fru_raw + 3, std::back_inserter(data));
+            w.put(raw & 0xFF);
+            w.put((raw >> 8) & 0xFF);
+            w.put((raw >> 16) & 0xFF);
             return;
         }
         std::fprintf(stderr, "MgfDate invalid date: %u secs since UNIX epoch\n",
                      static_cast<unsigned int>(raw));
     }
     // Blank date
-    data.emplace_back(0);
-    data.emplace_back(0);
-    data.emplace_back(0);
+    w.put(0);
+    w.put(0);
+    w.put(0);
 }
 
 /**
@@ -262,16 +327,16 @@ void appendMfgDate(const PropertyMap& propMap, FruAreaData& data)
  *
  * @param[in] infoAreaSize size of the FRU area to write
  * @param[in] offset Current offset for data in overall record
- * @param[in/out] data Common Header section data container
+ * @param[in/out] w Common Header section writer
  */
 void buildCommonHeaderSection(const uint32_t& infoAreaSize, uint16_t& offset,
-                              FruAreaData& data)
+                              FruWriter& w)
 {
     // Check if data for internal use section populated
     if (infoAreaSize == 0)
     {
         // Indicate record not present
-        data.emplace_back(recordNotPresent);
+        w.put(recordNotPresent);
     }
     else
     {
@@ -281,7 +346,7 @@ void buildCommonHeaderSection(const uint32_t& infoAreaSize, uint16_t& offset,
         // will be multiple of 8 byte.
         offset += (remainder > 0) ? recordUnitOfMeasurement - remainder : 0;
         // Place data to define offset to area data section
-        data.emplace_back(offset / recordUnitOfMeasurement);
+        w.put(offset / recordUnitOfMeasurement);
 
         offset += infoAreaSize;
     }
@@ -291,192 +356,302 @@ void buildCommonHeaderSection(const uint32_t& infoAreaSize, uint16_t& offset,
  * @brief Builds the Chassis info area data section
  *
  * @param[in] propMap map of properties for chassis info area
- * @return FruAreaData container with chassis info area
+ * @param[in/out] w writer of the chassis info area
  */
-FruAreaData buildChassisInfoArea(const PropertyMap& propMap)
+void buildChassisInfoArea(const PropertyMap& propMap, FruWriter& w)
 {
-    FruAreaData fruAreaData;
     if (!propMap.empty())
     {
+        size_t start = w.size();
         // Set formatting data that goes at the beginning of the record
-        preFormatProcessing(false, fruAreaData);
+        preFormatProcessing(false, w);
 
         // chassis type
-        appendChassisType(propMap, fruAreaData);
+        appendChassisType(propMap, w);
 
         // Chasiss part number, in config.yaml it is configured as model
-        appendData(modelNumber, propMap, fruAreaData);
+        appendData(modelNumber, propMap, w);
 
         // Board serial number
-        appendData(serialNumber, propMap, fruAreaData);
+        appendData(serialNumber, propMap, w);
 
         // Indicate End of Custom Fields
-        fruAreaData.emplace_back(endOfCustomFields);
+        w.put(endOfCustomFields);
 
         // Complete record data formatting
-        postFormatProcessing(fruAreaData);
+        postFormatProcessing(start, w);
     }
-    return fruAreaData;
 }
 
 /**
  * @brief Builds the Board info area data section
  *
  * @param[in] propMap map of properties for board info area
- * @return FruAreaData container with board info area
+ * @param[in/out] w writer of the board info area
  */
-FruAreaData buildBoardInfoArea(const PropertyMap& propMap)
+void buildBoardInfoArea(const PropertyMap& propMap, FruWriter& w)
 {
-    FruAreaData fruAreaData;
     if (!propMap.empty())
     {
-        preFormatProcessing(true, fruAreaData);
+        size_t start = w.size();
+        preFormatProcessing(true, w);
 
         // Manufacturing date
-        appendMfgDate(propMap, fruAreaData);
+        appendMfgDate(propMap, w);
 
         // manufacturer
-        appendData(manufacturer, propMap, fruAreaData);
+        appendData(manufacturer, propMap, w);
 
         // Product name/Pretty name
-        appendData(prettyName, propMap, fruAreaData);
+        appendData(prettyName, propMap, w);
 
         // Board serial number
-        appendData(serialNumber, propMap, fruAreaData);
+        appendData(serialNumber, propMap, w);
 
         // Board part number
-        appendData(partNumber, propMap, fruAreaData);
+        appendData(partNumber, propMap, w);
 
         // FRU File ID - Empty
-        fruAreaData.emplace_back(typeLengthByteNull);
+        w.put(typeLengthByteNull);
 
         // Empty FRU File ID bytes
-        fruAreaData.emplace_back(recordNotPresent);
+        w.put(recordNotPresent);
 
         // End of custom fields
-        fruAreaData.emplace_back(endOfCustomFields);
+        w.put(endOfCustomFields);
 
-        postFormatProcessing(fruAreaData);
+        postFormatProcessing(start, w);
     }
-    return fruAreaData;
 }
 
 /**
  * @brief Builds the Product info area data section
  *
  * @param[in] propMap map of FRU properties for Board info area
- * @return FruAreaData container with product info area data
+ * @param[in/out] w writer of the product info area
  */
-FruAreaData buildProductInfoArea(const PropertyMap& propMap)
+void buildProductInfoArea(const PropertyMap& propMap, FruWriter& w)
 {
-    FruAreaData fruAreaData;
     if (!propMap.empty())
     {
+        size_t start = w.size();
         // Set formatting data that goes at the beginning of the record
-        preFormatProcessing(true, fruAreaData);
+        preFormatProcessing(true, w);
 
         // manufacturer
-        appendData(manufacturer, propMap, fruAreaData);
+        appendData(manufacturer, propMap, w);
 
         // Product name/Pretty name
-        appendData(prettyName, propMap, fruAreaData);
+        appendData(prettyName, propMap, w);
 
         // Product part/model number
-        appendData(modelNumber, propMap, fruAreaData);
+        appendData(modelNumber, propMap, w);
 
         // Product version
-        appendData(version, propMap, fruAreaData);
+        appendData(version, propMap, w);
 
         // Serial Number
-        appendData(serialNumber, propMap, fruAreaData);
+        appendData(serialNumber, propMap, w);
 
         // Add Asset Tag
-        fruAreaData.emplace_back(recordNotPresent);
+        w.put(recordNotPresent);
 
         // FRU File ID - Empty
-        fruAreaData.emplace_back(typeLengthByteNull);
+        w.put(typeLengthByteNull);
 
         // Empty FRU File ID bytes
-        fruAreaData.emplace_back(recordNotPresent);
+        w.put(recordNotPresent);
 
         // End of custom fields
-        fruAreaData.emplace_back(endOfCustomFields);
+        w.put(endOfCustomFields);
 
-        postFormatProcessing(fruAreaData);
+        postFormatProcessing(start, w);
     }
-    return fruAreaData;
 }
 
-FruAreaData buildFruAreaData(const FruInventoryData& inventory)
+/**
+ * @brief Writes an info area
+ *
+ * @param[in] section Chassis, Board or Product
+ * @param[in] propMap FRU properties values of the section
+ * @param[in/out] w FRU area writer
+ */
+void buildInfoArea(const Section& section, const PropertyMap& propMap,
+                   FruWriter& w)
+{
+    if (section == chassis)
+    {
+        buildChassisInfoArea(propMap, w);
+    }
+    else if (section == board)
+    {
+        buildBoardInfoArea(propMap, w);
+    }
+    else if (section == product)
+    {
+        buildProductInfoArea(propMap, w);
+    }
+}
+
+/** @brief Sizes of the chassis, board and product areas, in that order */
+using AreaSizes = std::array<size_t, 3>;
+
+/**
+ * @brief Writes the common header of the FRU area data
+ *
+ * @param[in] sizes sizes of the info areas
+ * @param[in/out] w FRU area writer
+ */
+void buildCommonHeader(const AreaSizes& sizes, FruWriter& w)
 {
-    FruAreaData combFruArea{};
     // Now build common header with data for this FRU Inv Record
     // Use this variable to increment size of header as we go along to determine
     // offset for the subsequent area offsets
     uint16_t curDataOffset = commonHeaderFormatSize;
     // First byte is id for version of FRU Info Storage Spec used
-    combFruArea.emplace_back(specVersion);
+    w.put(specVersion);
 
     // 2nd byte is offset to internal use data
-    combFruArea.emplace_back(recordNotPresent);
+    w.put(recordNotPresent);
 
     // 3rd byte is offset to chassis data
-    FruAreaData chassisArea;
-    auto chassisIt = inventory.find(chassis);
-    if (chassisIt != inventory.end())
+    // 4th byte is offset to board data
+    // 5th byte is offset to product data
+    for (size_t areaSize : sizes)
     {
-        chassisArea = buildChassisInfoArea(chassisIt->second);
+        buildCommonHeaderSection(areaSize, curDataOffset, w);
     }
-    // update the offset to chassis data.
-    buildCommonHeaderSection(chassisArea.size(), curDataOffset, combFruArea);
 
-    // 4th byte is offset to board data
-    FruAreaData boardArea;
-    auto boardIt = inventory.find(board);
-    if (boardIt != inventory.end())
+    // 6th byte is offset to multirecord data
+    w.put(recordNotPresent);
+
+    // 7th byte is PAD
+    w.put(recordNotPresent);
+
+    // 8th (Final byte of Header Format) is the checksum
+    appendDataChecksum(0, w);
+}
+
+/**
+ * @brief Size of the FRU area data with info areas of the given sizes
+ *
+ * @param[in] sizes sizes of the info areas
+ * @return size in bytes
+ */
+size_t fruAreaDataSize(const AreaSizes& sizes)
+{
+    size_t size = commonHeaderFormatSize;
+    for (size_t areaSize : sizes)
     {
-        boardArea = buildBoardInfoArea(boardIt->second);
+        size += areaSize;
     }
-    // update the offset to the board data.
-    buildCommonHeaderSection(boardArea.size(), curDataOffset, combFruArea);
+    // If area is smaller than the minimum size, pad it. This enables ipmitool
+    // to update the FRU blob with values longer than the original payload.
+    return std::max<size_t>(size, fruMinSize);
+}
 
-    // 5th byte is offset to product data
-    FruAreaData prodArea;
-    auto prodIt = inventory.find(product);
-    if (prodIt != inventory.end())
+/**
+ * @brief Get the inventory data of a section
+ *
+ * @param[in] inventory FRU properties values read from inventory
+ * @param[in] section Chassis, Board or Product
+ * @return the properties, empty if the section is missing
+ */
+const PropertyMap& sectionData(const FruInventoryData& inventory,
+                               const Section& section)
+{
+    static const PropertyMap noData;
+    auto iter = inventory.find(section);
+    return iter != inventory.end() ? iter->second : noData;
+}
+
+/**
+ * @brief Compute the sizes of the info areas of the inventory data
+ *
+ * @param[in] inventory FRU properties values read from inventory
+ * @return sizes of the chassis, board and product areas
+ */
+AreaSizes infoAreaSizes(const FruInventoryData& inventory)
+{
+    AreaSizes sizes{};
+    const Section sections[] = {chassis, board, product};
+    for (size_t i = 0; i < sizes.size(); i++)
     {
-        prodArea = buildProductInfoArea(prodIt->second);
+        FruWriter counter;
+        buildInfoArea(sections[i], sectionData(inventory, sections[i]),
+                      counter);
+        sizes[i] = counter.size();
     }
-    // update the offset to the product data.
-    buildCommonHeaderSection(prodArea.size(), curDataOffset, combFruArea);
+    return sizes;
+}
 
-    // 6th byte is offset to multirecord data
-    combFruArea.emplace_back(recordNotPresent);
+size_t fruAreaDataSize(const FruInventoryData& inventory)
+{
+    return fruAreaDataSize(infoAreaSizes(inventory));
+}
 
-    // 7th byte is PAD
-    combFruArea.emplace_back(recordNotPresent);
+size_t encodeFruAreaData(const FruInventoryData& inventory, uint8_t* buffer,
+                         size_t size)
+{
+    AreaSizes sizes = infoAreaSizes(inventory);
+    size_t total = fruAreaDataSize(sizes);
+    if (size < total)
+    {
+        return 0;
+    }
 
-    // 8th (Final byte of Header Format) is the checksum
-    appendDataChecksum(combFruArea);
+    FruWriter w(buffer);
+    buildCommonHeader(sizes, w);
 
     // Combine everything into one full IPMI FRU specification Record
-    // add chassis use area data
-    combFruArea.insert(combFruArea.end(), chassisArea.begin(),
-                       chassisArea.end());
+    buildChassisInfoArea(sectionData(inventory, chassis), w);
+    buildBoardInfoArea(sectionData(inventory, board), w);
+    buildProductInfoArea(sectionData(inventory, product), w);
+
+    std::fill(buffer + w.size(), buffer + total, fruPadValue);
+    return total;
+}
 
-    // add board area data
-    combFruArea.insert(combFruArea.end(), boardArea.begin(), boardArea.end());
+FruAreaData buildInfoArea(const Section& section, const PropertyMap& propMap)
+{
+    FruWriter counter;
+    buildInfoArea(section, propMap, counter);
 
-    // add product use area data
-    combFruArea.insert(combFruArea.end(), prodArea.begin(), prodArea.end());
+    FruAreaData fruAreaData(counter.size());
+    FruWriter w(fruAreaData.data());
+    buildInfoArea(section, propMap, w);
+    return fruAreaData;
+}
 
-    // If area is smaller than the minimum size, pad it. This enables ipmitool
-    // to update the FRU blob with values longer than the original payload.
-    if (combFruArea.size() < fruMinSize)
+FruAreaData assembleFruAreaData(const FruAreas& areas)
+{
+    static const FruAreaData noArea;
+    auto getArea = [&areas](const Section& section) -> const FruAreaData& {
+        auto it = areas.find(section);
+        return it != areas.end() ? it->second : noArea;
+    };
+    const FruAreaData* infoAreas[] = {&getArea(chassis), &getArea(board),
+                                      &getArea(product)};
+    AreaSizes sizes{};
+    for (size_t i = 0; i < sizes.size(); i++)
     {
-        combFruArea.resize(fruMinSize, fruPadValue);
+        sizes[i] = infoAreas[i]->size();
     }
 
+    FruAreaData combFruArea(fruAreaDataSize(sizes), fruPadValue);
+    FruWriter w(combFruArea.data());
+    buildCommonHeader(sizes, w);
+    for (const FruAreaData* area : infoAreas)
+    {
+        w.put(area->data(), area->size());
+    }
+    return combFruArea;
+}
+
+FruAreaData buildFruAreaData(const FruInventoryData& inventory)
+{
+    FruAreaData combFruArea(fruAreaDataSize(inventory));
+    encodeFruAreaData(inventory, combFruArea.data(), combFruArea.size());
     return combFruArea;
 }
 
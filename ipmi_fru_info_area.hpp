@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -14,6 +16,7 @@ using Value = std::string;
 using Property = std::string;
 using PropertyMap = std::map<Property, Value>;
 using FruInventoryData = std::map<Section, PropertyMap>;
+using FruAreas = std::map<Section, FruAreaData>;
 
 /**
  * @brief Builds Fru area data from inventory data
@@ -24,5 +27,51 @@ using FruInventoryData = std::map<Section, PropertyMap>;
  */
 FruAreaData buildFruAreaData(const FruInventoryData& inventory);
 
+/**
+ * @brief Computes the size of the FRU area data of the inventory data
+ *
+ * @param[in] inventory FRU properties values read from inventory
+ *
+ * @return size in bytes of the FRU area data, including the padding to the
+ *         minimum FRU size
+ */
+size_t fruAreaDataSize(const FruInventoryData& inventory);
+
+/**
+ * @brief Encodes the FRU area data into a caller provided buffer
+ *
+ * The header, info areas, padding and checksums are written in place,
+ * without any temporary allocation.
+ *
+ * @param[in] inventory FRU properties values read from inventory
+ * @param[out] buffer buffer to write the FRU area data to
+ * @param[in] size size of the buffer
+ *
+ * @return number of bytes written, 0 if the buffer is smaller than
+ *         fruAreaDataSize()
+ */
+size_t encodeFruAreaData(const FruInventoryData& inventory, uint8_t* buffer,
+                         size_t size);
+
+/**
+ * @brief Builds one info area from its inventory data
+ *
+ * @param[in] section Chassis, Board or Product
+ * @param[in] propMap FRU properties values of the section
+ *
+ * @return FruAreaData info area data with its padding and checksum, empty if
+ *         the section has no properties or is not an info area
+ */
+FruAreaData buildInfoArea(const Section& section, const PropertyMap& propMap);
+
+/**
+ * @brief Builds Fru area data from already built info areas
+ *
+ * @param[in] areas info areas data by section
+ *
+ * @return FruAreaData FRU area data as per IPMI specification
+ */
+FruAreaData assembleFruAreaData(const FruAreas& areas);
+
 } // namespace fru
 } // namespace ipmi
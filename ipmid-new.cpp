@@ -15,25 +15,47 @@
  */
 #include "config.h"
 
+#include "command-stats.hpp"
+#include "pressure.hpp"
 #include "settings.hpp"
 
 #include <dlfcn.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <any>
+#include <array>
 #include <boost/algorithm/string.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <dcmihandler.hpp>
+#include <deque>
 #include <exception>
 #include <filesystem>
 #include <forward_list>
+#include <functional>
 #include <host-cmd-manager.hpp>
+#include <ipmb-bridge.hpp>
 #include <ipmid-host/cmd.hpp>
 #include <ipmid/api.hpp>
+#include <ipmid/bridge.hpp>
+#include <ipmid/dbus-stats.hpp>
 #include <ipmid/handler.hpp>
 #include <ipmid/message.hpp>
 #include <ipmid/oemrouter.hpp>
+#include <ipmid/probes.hpp>
 #include <ipmid/types.hpp>
+#include <limits>
 #include <map>
 #include <memory>
 #include <optional>
@@ -44,6 +66,7 @@
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/timer.hpp>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -53,6 +76,13 @@ namespace fs = std::filesystem;
 
 using namespace phosphor::logging;
 
+// the dispatcher probes, see ipmid/probes.hpp
+IPMID_PROBE_SEMAPHORE(request__start);
+IPMID_PROBE_SEMAPHORE(filter);
+IPMID_PROBE_SEMAPHORE(handler__start);
+IPMID_PROBE_SEMAPHORE(handler__done);
+IPMID_PROBE_SEMAPHORE(command__done);
+
 // IPMI Spec, shared Reservation ID.
 static unsigned short selReservationID = 0xFFFF;
 static bool selReservationValid = false;
@@ -86,13 +116,17 @@ EInterfaceIndex getInterfaceIndex(void)
 
 sd_bus* bus;
 sd_event* events = nullptr;
+/* private connection of a handler worker thread; sd_bus objects must not be
+ * shared between threads, so the worker handlers get their own */
+static thread_local sd_bus* workerBus = nullptr;
+static bool sessionBus = false;
 sd_event* ipmid_get_sd_event_connection(void)
 {
     return events;
 }
 sd_bus* ipmid_get_sd_bus_connection(void)
 {
-    return bus;
+    return workerBus ? workerBus : bus;
 }
 
 namespace ipmi
@@ -122,15 +156,518 @@ static std::unordered_map<unsigned int, /* key is Iana/Cmd (NetFn is 2Eh) */
                           HandlerTuple>
     oemHandlerMap;
 
-using FilterTuple = std::tuple<int,            /* prio */
-                               FilterBase::ptr /* filter */
+using FilterTuple = std::tuple<int,                      /* prio */
+                               FilterBase::ptr,          /* filter */
+                               std::vector<FilterScope> /* scopes */
                                >;
 
 /* list to hold all registered ipmi command filters */
 static std::forward_list<FilterTuple> filterList;
 
+/* a filter of a command with the channels it is called on, channels past
+ * the mask only match the filters of every channel */
+struct ChainedFilter
+{
+    FilterBase* filter;
+    bool allChannels;
+    uint16_t channels;
+
+    bool operator==(const ChainedFilter& other) const
+    {
+        return filter == other.filter && allChannels == other.allChannels &&
+               channels == other.channels;
+    }
+};
+
+/* the filters of one command in priority order; the commands share the
+ * chains, there are only a few distinct ones */
+using FilterChain = std::vector<ChainedFilter>;
+static std::vector<std::unique_ptr<FilterChain>> filterChains;
+
+static bool inScope(const FilterScope& scope, NetFn netFn, Cmd cmd)
+{
+    return (!scope.netFn || *scope.netFn == netFn) &&
+           (!scope.cmd || *scope.cmd == cmd);
+}
+
+/* the filter chain of a command, nullptr when no filter is called on it */
+static const FilterChain* buildFilterChain(NetFn netFn, Cmd cmd)
+{
+    FilterChain chain;
+    for (const auto& [prio, filter, scopes] : filterList)
+    {
+        ChainedFilter chained{filter.get(), scopes.empty(), 0};
+        for (const FilterScope& scope : scopes)
+        {
+            if (!inScope(scope, netFn, cmd))
+            {
+                continue;
+            }
+            if (!scope.channel)
+            {
+                chained.allChannels = true;
+            }
+            else if (*scope.channel < 16)
+            {
+                chained.channels |= 1 << *scope.channel;
+            }
+        }
+        if (chained.allChannels || chained.channels)
+        {
+            chain.push_back(chained);
+        }
+    }
+    if (chain.empty())
+    {
+        return nullptr;
+    }
+    for (const auto& known : filterChains)
+    {
+        if (*known == chain)
+        {
+            return known.get();
+        }
+    }
+    filterChains.emplace_back(std::make_unique<FilterChain>(std::move(chain)));
+    return filterChains.back().get();
+}
+
+/* one slot of the dense NetFn/Cmd dispatch table; the handler is owned by
+ * handlerMap and the filters by filterList, so the table only keeps
+ * borrowed pointers to them */
+struct DispatchEntry
+{
+    Privilege priv = Privilege::None;
+    HandlerBase* handler = nullptr;
+    const FilterChain* filters = nullptr;
+};
+
+/* even NetFns 00h-3Eh map to rows 0-31, each row is indexed by Cmd */
+static constexpr size_t dispatchRowSize =
+    static_cast<size_t>(std::numeric_limits<Cmd>::max()) + 1;
+static constexpr size_t dispatchRowCount = (netFnOemEight >> 1) + 1;
+
+/* dense table to handle standard registered commands after startup */
+static std::array<DispatchEntry, dispatchRowCount * dispatchRowSize>
+    dispatchTable;
+static bool dispatchTableFrozen = false;
+
+/* one row per Group or IANA with registered commands, sorted by the Group
+ * or IANA; there are only a handful of them, so a binary search over a
+ * flat vector beats hashing the Group or IANA with the Cmd */
+using DispatchRow = std::array<DispatchEntry, dispatchRowSize>;
+using ExtensionRows =
+    std::vector<std::pair<unsigned int, std::unique_ptr<DispatchRow>>>;
+static ExtensionRows groupDispatchRows;
+static ExtensionRows oemDispatchRows;
+
+static inline size_t dispatchIndex(NetFn netFn, Cmd cmd)
+{
+    return (static_cast<size_t>(netFn >> 1) * dispatchRowSize) + cmd;
+}
+
+/* resolve each command of a NetFn to its handler, falling back to the
+ * wildcard handler so no second lookup is needed at dispatch time */
+static void buildDispatchRow(NetFn netFn)
+{
+    auto wildcard = handlerMap.find(makeCmdKey(netFn, cmdWildcard));
+    for (size_t cmd = 0; cmd < dispatchRowSize; cmd++)
+    {
+        DispatchEntry& entry = dispatchTable[dispatchIndex(netFn, cmd)];
+        auto cmdIter = handlerMap.find(makeCmdKey(netFn, cmd));
+        if (cmdIter == handlerMap.end())
+        {
+            cmdIter = wildcard;
+        }
+        if (cmdIter == handlerMap.end())
+        {
+            entry = DispatchEntry();
+            continue;
+        }
+        entry.priv = std::get<Privilege>(cmdIter->second);
+        entry.handler = std::get<HandlerBase::ptr>(cmdIter->second).get();
+        entry.filters = buildFilterChain(netFn, cmd);
+    }
+}
+
+static const DispatchRow* findExtensionRow(const ExtensionRows& rows,
+                                           unsigned int key)
+{
+    auto row = std::lower_bound(
+        rows.begin(), rows.end(), key,
+        [](const auto& entry, unsigned int k) { return entry.first < k; });
+    if (row == rows.end() || row->first != key)
+    {
+        return nullptr;
+    }
+    return row->second.get();
+}
+
+/* same as buildDispatchRow, for the commands of one Group or IANA */
+static void buildExtensionRow(
+    const std::unordered_map<unsigned int, HandlerTuple>& handlers,
+    NetFn netFn, ExtensionRows& rows, unsigned int key)
+{
+    auto row = std::lower_bound(
+        rows.begin(), rows.end(), key,
+        [](const auto& entry, unsigned int k) { return entry.first < k; });
+    if (row == rows.end() || row->first != key)
+    {
+        row = rows.emplace(row, key, std::make_unique<DispatchRow>());
+    }
+
+    auto wildcard = handlers.find(makeCmdKey(key, cmdWildcard));
+    for (size_t cmd = 0; cmd < dispatchRowSize; cmd++)
+    {
+        DispatchEntry& entry = (*row->second)[cmd];
+        auto cmdIter = handlers.find(makeCmdKey(key, cmd));
+        if (cmdIter == handlers.end())
+        {
+            cmdIter = wildcard;
+        }
+        if (cmdIter == handlers.end())
+        {
+            entry = DispatchEntry();
+            continue;
+        }
+        entry.priv = std::get<Privilege>(cmdIter->second);
+        entry.handler = std::get<HandlerBase::ptr>(cmdIter->second).get();
+        entry.filters = buildFilterChain(netFn, static_cast<Cmd>(cmd));
+    }
+}
+
+static void buildExtensionRows(
+    const std::unordered_map<unsigned int, HandlerTuple>& handlers,
+    NetFn netFn, ExtensionRows& rows)
+{
+    for (const auto& [key, item] : handlers)
+    {
+        unsigned int extension = key >> 8;
+        if (!findExtensionRow(rows, extension))
+        {
+            buildExtensionRow(handlers, netFn, rows, extension);
+        }
+    }
+}
+
+/* build the dense dispatch table once all the providers have registered,
+ * or again once a filter registers late */
+static void freezeDispatchTable()
+{
+    // the rows are rebuilt from scratch, so no entry keeps an old chain
+    groupDispatchRows.clear();
+    oemDispatchRows.clear();
+    filterChains.clear();
+    for (unsigned int netFn = 0; netFn <= netFnOemEight; netFn += 2)
+    {
+        buildDispatchRow(static_cast<NetFn>(netFn));
+    }
+    buildExtensionRows(groupHandlerMap, netFnGroup, groupDispatchRows);
+    buildExtensionRows(oemHandlerMap, netFnOem, oemDispatchRows);
+    dispatchTableFrozen = true;
+}
+
+/* drop all the borrowed handler pointers ahead of clearing handlerMap */
+static void releaseDispatchTable()
+{
+    dispatchTableFrozen = false;
+    dispatchTable.fill(DispatchEntry());
+    groupDispatchRows.clear();
+    oemDispatchRows.clear();
+    filterChains.clear();
+}
+
+/* pool running the worker handlers, see ipmi::Execution; null when ipmid
+ * is built without handler worker threads */
+static std::unique_ptr<boost::asio::thread_pool> workerPool;
+
+/* open the private connection of the calling worker thread */
+static bool openWorkerBus()
+{
+    struct Connection
+    {
+        sd_bus* bus = nullptr;
+        ~Connection()
+        {
+            sd_bus_flush_close_unref(bus);
+        }
+    };
+    thread_local Connection connection;
+    if (!connection.bus)
+    {
+        int r = sessionBus ? sd_bus_open_user(&connection.bus)
+                           : sd_bus_open_system(&connection.bus);
+        if (r < 0)
+        {
+            log<level::ERR>("Failed to open a handler worker connection",
+                            entry("ERROR=%s", strerror(-r)));
+            connection.bus = nullptr;
+            return false;
+        }
+    }
+    workerBus = connection.bus;
+    return true;
+}
+
 namespace impl
 {
+
+message::Response::ptr
+    callOnWorker(message::Request::ptr request,
+                 std::function<message::Response::ptr()>&& callback)
+{
+    if (!workerPool)
+    {
+        return callback();
+    }
+
+    // the request coroutine waits on the main loop until the worker posts
+    // the completion back, so the response is sent from the main loop
+    boost::asio::steady_timer done(
+        *getIoContext(), boost::asio::steady_timer::time_point::max());
+    message::Response::ptr response;
+    std::exception_ptr error;
+    bool ran = false;
+    boost::asio::post(*workerPool, [&]() {
+        if (openWorkerBus())
+        {
+            dbus_stats::attribute(*request->ctx);
+            try
+            {
+                response = callback();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            dbus_stats::release(*request->ctx);
+            ran = true;
+        }
+        boost::asio::post(*getIoContext(), [&done]() { done.cancel(); });
+    });
+    boost::system::error_code ec;
+    done.async_wait(request->ctx->yield[ec]);
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    if (!ran)
+    {
+        // without a connection of its own the handler runs on the main loop
+        return callback();
+    }
+    return response;
+}
+
+/* the responses of one handler, keyed by the command, channel, privilege
+ * and data of the request. A handler answers few distinct requests, the
+ * bound only keeps odd request data from growing the cache. */
+class ResponseCache
+{
+  public:
+    static constexpr size_t maxEntries = 32;
+
+    explicit ResponseCache(CachePolicy&& policy) : policy(std::move(policy))
+    {
+    }
+
+    message::Response::ptr
+        call(message::Request::ptr request,
+             const std::function<message::Response::ptr()>& callback)
+    {
+        watch();
+        std::vector<uint8_t> key = makeKey(*request);
+        auto now = std::chrono::steady_clock::now();
+        uint64_t dataGeneration = policy.generation ? policy.generation() : 0;
+        auto entry = entries.find(key);
+        if (entry != entries.end())
+        {
+            if (!expired(entry->second, now) &&
+                entry->second.dataGeneration == dataGeneration)
+            {
+                auto response = request->makeResponse();
+                response->payload.raw.assign(entry->second.data.begin(),
+                                             entry->second.data.end());
+                return response;
+            }
+            entries.erase(entry);
+        }
+
+        // the handler may yield, and a response that was computed across
+        // an invalidation must not be cached
+        uint64_t started = generation;
+        message::Response::ptr response = callback();
+        if (response->cc == ccSuccess && started == generation &&
+            (!policy.generation || policy.generation() == dataGeneration) &&
+            entries.size() < maxEntries)
+        {
+            entries.emplace(std::move(key),
+                            Entry{response->payload.raw, now, dataGeneration});
+        }
+        return response;
+    }
+
+  private:
+    struct Entry
+    {
+        std::vector<uint8_t> data;
+        std::chrono::steady_clock::time_point cached;
+        uint64_t dataGeneration;
+    };
+
+    static std::vector<uint8_t> makeKey(const message::Request& request)
+    {
+        std::vector<uint8_t> key;
+        key.reserve(request.payload.raw.size() + 4);
+        key.push_back(static_cast<uint8_t>(request.ctx->netFn));
+        key.push_back(static_cast<uint8_t>(request.ctx->cmd));
+        key.push_back(static_cast<uint8_t>(request.ctx->channel));
+        key.push_back(static_cast<uint8_t>(request.ctx->priv));
+        key.insert(key.end(), request.payload.raw.begin(),
+                   request.payload.raw.end());
+        return key;
+    }
+
+    bool expired(const Entry& entry,
+                 std::chrono::steady_clock::time_point now) const
+    {
+        return policy.maxAge != std::chrono::steady_clock::duration::zero() &&
+               now - entry.cached >= policy.maxAge;
+    }
+
+    /* the matches are added on first use, so a command that is never
+     * requested costs no match rules on the bus */
+    void watch()
+    {
+        if (matches.size() == policy.matches.size())
+        {
+            return;
+        }
+        for (const auto& rule : policy.matches)
+        {
+            matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+                *getSdBus(), rule, [this](sdbusplus::message::message&) {
+                    entries.clear();
+                    generation++;
+                }));
+        }
+    }
+
+    CachePolicy policy;
+    std::map<std::vector<uint8_t>, Entry> entries;
+    uint64_t generation = 0;
+    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches;
+};
+
+std::shared_ptr<ResponseCache> makeResponseCache(CachePolicy&& policy)
+{
+    return std::make_shared<ResponseCache>(std::move(policy));
+}
+
+message::Response::ptr
+    callCached(ResponseCache& cache, message::Request::ptr request,
+               const std::function<message::Response::ptr()>& callback)
+{
+    return cache.call(request, callback);
+}
+
+/* the requests of one idempotent handler in flight, keyed by the command,
+ * lun, privilege and data of the request. The identical requests that come
+ * while one is in flight wait on its timer, which is cancelled once its
+ * response is in. Handlers and their flights are only touched on the main
+ * loop, worker handlers included. */
+class RequestFlights
+{
+  public:
+    message::Response::ptr
+        call(message::Request::ptr request,
+             const std::function<message::Response::ptr()>& callback)
+    {
+        std::vector<uint8_t> key = makeKey(*request);
+        auto found = flights.find(key);
+        if (found != flights.end())
+        {
+            std::shared_ptr<Flight> flight = found->second;
+            boost::system::error_code ec;
+            flight->done.async_wait(request->ctx->yield[ec]);
+            if (flight->error)
+            {
+                std::rethrow_exception(flight->error);
+            }
+            auto response = request->makeResponse();
+            response->cc = flight->cc;
+            response->payload.raw.assign(flight->data.begin(),
+                                         flight->data.end());
+            return response;
+        }
+
+        auto flight = std::make_shared<Flight>(*getIoContext());
+        flights.emplace(key, flight);
+        message::Response::ptr response;
+        try
+        {
+            response = callback();
+        }
+        catch (...)
+        {
+            flight->error = std::current_exception();
+        }
+        flights.erase(key);
+        if (response)
+        {
+            flight->cc = response->cc;
+            flight->data = response->payload.raw;
+        }
+        flight->done.cancel();
+        if (flight->error)
+        {
+            std::rethrow_exception(flight->error);
+        }
+        return response;
+    }
+
+  private:
+    struct Flight
+    {
+        explicit Flight(boost::asio::io_context& io) :
+            done(io, boost::asio::steady_timer::time_point::max())
+        {
+        }
+
+        boost::asio::steady_timer done;
+        Cc cc = ccSuccess;
+        std::vector<uint8_t> data;
+        std::exception_ptr error;
+    };
+
+    static std::vector<uint8_t> makeKey(const message::Request& request)
+    {
+        std::vector<uint8_t> key;
+        key.reserve(request.payload.raw.size() + 4);
+        key.push_back(static_cast<uint8_t>(request.ctx->netFn));
+        key.push_back(static_cast<uint8_t>(request.ctx->cmd));
+        key.push_back(static_cast<uint8_t>(request.ctx->lun));
+        key.push_back(static_cast<uint8_t>(request.ctx->priv));
+        key.insert(key.end(), request.payload.raw.begin(),
+                   request.payload.raw.end());
+        return key;
+    }
+
+    std::map<std::vector<uint8_t>, std::shared_ptr<Flight>> flights;
+};
+
+std::shared_ptr<RequestFlights> makeRequestFlights()
+{
+    return std::make_shared<RequestFlights>();
+}
+
+message::Response::ptr
+    callCoalesced(RequestFlights& flights, message::Request::ptr request,
+                  const std::function<message::Response::ptr()>& callback)
+{
+    return flights.call(request, callback);
+}
+
 /* common function to register all standard IPMI handlers */
 bool registerHandler(int prio, NetFn netFn, Cmd cmd, Privilege priv,
                      HandlerBase::ptr handler)
@@ -151,6 +688,11 @@ bool registerHandler(int prio, NetFn netFn, Cmd cmd, Privilege priv,
     if (!std::get<HandlerBase::ptr>(mapCmd) || std::get<int>(mapCmd) <= prio)
     {
         mapCmd = item;
+        // late registrations after startup must be visible in the table too
+        if (dispatchTableFrozen)
+        {
+            buildDispatchRow(netFn);
+        }
         return true;
     }
     return false;
@@ -169,6 +711,11 @@ bool registerGroupHandler(int prio, Group group, Cmd cmd, Privilege priv,
     if (!std::get<HandlerBase::ptr>(mapCmd) || std::get<int>(mapCmd) <= prio)
     {
         mapCmd = item;
+        if (dispatchTableFrozen)
+        {
+            buildExtensionRow(groupHandlerMap, netFnGroup, groupDispatchRows,
+                              group);
+        }
         return true;
     }
     return false;
@@ -187,6 +734,10 @@ bool registerOemHandler(int prio, Iana iana, Cmd cmd, Privilege priv,
     if (!std::get<HandlerBase::ptr>(mapCmd) || std::get<int>(mapCmd) <= prio)
     {
         mapCmd = item;
+        if (dispatchTableFrozen)
+        {
+            buildExtensionRow(oemHandlerMap, netFnOem, oemDispatchRows, iana);
+        }
         return true;
     }
     return false;
@@ -194,20 +745,35 @@ bool registerOemHandler(int prio, Iana iana, Cmd cmd, Privilege priv,
 
 /* common function to register all IPMI filter handlers */
 void registerFilter(int prio, FilterBase::ptr filter)
+{
+    registerFilter(prio, filter, {});
+}
+
+void registerFilter(int prio, FilterBase::ptr filter,
+                    std::vector<FilterScope>&& scopes)
 {
     // check for initial placement
     if (filterList.empty() || std::get<int>(filterList.front()) < prio)
     {
-        filterList.emplace_front(std::make_tuple(prio, filter));
-        return;
+        filterList.emplace_front(
+            std::make_tuple(prio, filter, std::move(scopes)));
     }
-    // walk the list and put it in the right place
-    auto j = filterList.begin();
-    for (auto i = j; i != filterList.end() && std::get<int>(*i) > prio; i++)
+    else
     {
-        j = i;
+        // walk the list and put it in the right place
+        auto j = filterList.begin();
+        for (auto i = j; i != filterList.end() && std::get<int>(*i) > prio;
+             i++)
+        {
+            j = i;
+        }
+        filterList.emplace_after(
+            j, std::make_tuple(prio, filter, std::move(scopes)));
+    }
+    if (dispatchTableFrozen)
+    {
+        freezeDispatchTable();
     }
-    filterList.emplace_after(j, std::make_tuple(prio, filter));
 }
 
 } // namespace impl
@@ -217,10 +783,19 @@ message::Response::ptr filterIpmiCommand(message::Request::ptr request)
     // pass the command through the filter mechanism
     // This can be the firmware firewall or any OEM mechanism like
     // whitelist filtering based on operational mode
-    for (auto& item : filterList)
+    const Context& ctx = *request->ctx;
+    for (auto& [prio, filter, scopes] : filterList)
     {
-        FilterBase::ptr filter = std::get<FilterBase::ptr>(item);
+        if (!scopes.empty() &&
+            std::none_of(scopes.begin(), scopes.end(), [&ctx](auto& scope) {
+                return inScope(scope, ctx.netFn, ctx.cmd) &&
+                       (!scope.channel || *scope.channel == ctx.channel);
+            }))
+        {
+            continue;
+        }
         ipmi::Cc cc = filter->call(request);
+        IPMID_PROBE(filter, ctx.netFn, ctx.cmd, ctx.channel, cc);
         if (ipmi::ccSuccess != cc)
         {
             return errorResponse(request, cc);
@@ -229,21 +804,55 @@ message::Response::ptr filterIpmiCommand(message::Request::ptr request)
     return message::Response::ptr();
 }
 
+/* same as filterIpmiCommand, with the chain resolved for the command */
+static message::Response::ptr
+    filterIpmiCommand(const FilterChain& chain, message::Request::ptr request)
+{
+    int channel = request->ctx->channel;
+    for (const ChainedFilter& chained : chain)
+    {
+        if (!chained.allChannels &&
+            (channel < 0 || channel >= 16 ||
+             !(chained.channels & (1 << channel))))
+        {
+            continue;
+        }
+        ipmi::Cc cc = chained.filter->call(request);
+        IPMID_PROBE(filter, request->ctx->netFn, request->ctx->cmd, channel,
+                    cc);
+        if (ipmi::ccSuccess != cc)
+        {
+            return errorResponse(request, cc);
+        }
+    }
+    return message::Response::ptr();
+}
+
+/* run the handler chosen for a request, between its probes */
+static message::Response::ptr callHandler(HandlerBase& handler,
+                                          message::Request::ptr request)
+{
+    const Context& ctx = *request->ctx;
+    IPMID_PROBE(handler__start, ctx.netFn, ctx.cmd, ctx.channel);
+    probes::Timer timer(IPMID_PROBE_ENABLED(handler__done));
+    message::Response::ptr response = handler.call(request);
+    IPMID_PROBE(handler__done, ctx.netFn, ctx.cmd, ctx.channel, response->cc,
+                timer.us());
+    return response;
+}
+
 message::Response::ptr executeIpmiCommandCommon(
     std::unordered_map<unsigned int, HandlerTuple>& handlers,
     unsigned int keyCommon, message::Request::ptr request)
 {
-    // filter the command first; a non-null message::Response::ptr
-    // means that the message has been rejected for some reason
-    message::Response::ptr filterResponse = filterIpmiCommand(request);
-
     Cmd cmd = request->ctx->cmd;
     unsigned int key = makeCmdKey(keyCommon, cmd);
     auto cmdIter = handlers.find(key);
     if (cmdIter != handlers.end())
     {
-        // only return the filter response if the command is found
-        if (filterResponse)
+        // filter the command, unknown commands are not filtered; a non-null
+        // message::Response::ptr means that it has been rejected
+        if (message::Response::ptr filterResponse = filterIpmiCommand(request))
         {
             return filterResponse;
         }
@@ -252,7 +861,7 @@ message::Response::ptr executeIpmiCommandCommon(
         {
             return errorResponse(request, ccInsufficientPrivilege);
         }
-        return std::get<HandlerBase::ptr>(chosen)->call(request);
+        return callHandler(*std::get<HandlerBase::ptr>(chosen), request);
     }
     else
     {
@@ -260,8 +869,8 @@ message::Response::ptr executeIpmiCommandCommon(
         cmdIter = handlers.find(wildcard);
         if (cmdIter != handlers.end())
         {
-            // only return the filter response if the command is found
-            if (filterResponse)
+            if (message::Response::ptr filterResponse =
+                    filterIpmiCommand(request))
             {
                 return filterResponse;
             }
@@ -270,12 +879,69 @@ message::Response::ptr executeIpmiCommandCommon(
             {
                 return errorResponse(request, ccInsufficientPrivilege);
             }
-            return std::get<HandlerBase::ptr>(chosen)->call(request);
+            return callHandler(*std::get<HandlerBase::ptr>(chosen), request);
         }
     }
     return errorResponse(request, ccInvalidCommand);
 }
 
+static message::Response::ptr
+    executeDispatchEntry(const DispatchEntry& chosen,
+                         message::Request::ptr request)
+{
+    if (!chosen.handler)
+    {
+        return errorResponse(request, ccInvalidCommand);
+    }
+    // filter the command, with the filters resolved for it; a non-null
+    // message::Response::ptr means that it has been rejected
+    if (chosen.filters)
+    {
+        if (message::Response::ptr filterResponse =
+                filterIpmiCommand(*chosen.filters, request))
+        {
+            return filterResponse;
+        }
+    }
+    if (request->ctx->priv < chosen.priv)
+    {
+        return errorResponse(request, ccInsufficientPrivilege);
+    }
+    return callHandler(*chosen.handler, request);
+}
+
+message::Response::ptr executeIpmiCommandDense(message::Request::ptr request)
+{
+    NetFn netFn = request->ctx->netFn;
+    if (netFn & 1 || netFn > netFnOemEight)
+    {
+        return errorResponse(request, ccInvalidCommand);
+    }
+    return executeDispatchEntry(
+        dispatchTable[dispatchIndex(netFn, request->ctx->cmd)], request);
+}
+
+/* run a group or OEM command from its row, or report it as unknown */
+static message::Response::ptr
+    executeExtensionRow(const DispatchRow* row, message::Request::ptr request)
+{
+    if (!row)
+    {
+        static const DispatchEntry none{};
+        return executeDispatchEntry(none, request);
+    }
+    return executeDispatchEntry((*row)[request->ctx->cmd], request);
+}
+
+/* every group and OEM response echoes the group or IANA; the request bytes
+ * just unpacked are copied straight into the response prefix */
+static void echoRequestPrefix(message::Request::ptr& request, size_t size)
+{
+    const message::Payload& payload = request->payload;
+    request->setResponsePrefix(message::ByteSpan(
+        payload.data() + payload.rawIndex - size, size));
+}
+
 message::Response::ptr executeIpmiGroupCommand(message::Request::ptr request)
 {
     // look up the group for this request
@@ -285,12 +951,13 @@ message::Response::ptr executeIpmiGroupCommand(message::Request::ptr request)
         return errorResponse(request, ccReqDataLenInvalid);
     }
     auto group = static_cast<Group>(bytes);
-    message::Response::ptr response =
-        executeIpmiCommandCommon(groupHandlerMap, group, request);
-    ipmi::message::Payload prefix;
-    prefix.pack(bytes);
-    response->prepend(prefix);
-    return response;
+    echoRequestPrefix(request, sizeof(bytes));
+    if (dispatchTableFrozen)
+    {
+        return executeExtensionRow(findExtensionRow(groupDispatchRows, group),
+                                   request);
+    }
+    return executeIpmiCommandCommon(groupHandlerMap, group, request);
 }
 
 message::Response::ptr executeIpmiOemCommand(message::Request::ptr request)
@@ -302,15 +969,17 @@ message::Response::ptr executeIpmiOemCommand(message::Request::ptr request)
         return errorResponse(request, ccReqDataLenInvalid);
     }
     auto iana = static_cast<Iana>(bytes);
-    message::Response::ptr response =
-        executeIpmiCommandCommon(oemHandlerMap, iana, request);
-    ipmi::message::Payload prefix;
-    prefix.pack(bytes);
-    response->prepend(prefix);
-    return response;
+    echoRequestPrefix(request, 3);
+    if (dispatchTableFrozen)
+    {
+        return executeExtensionRow(findExtensionRow(oemDispatchRows, iana),
+                                   request);
+    }
+    return executeIpmiCommandCommon(oemHandlerMap, iana, request);
 }
 
-message::Response::ptr executeIpmiCommand(message::Request::ptr request)
+static message::Response::ptr
+    dispatchIpmiCommand(message::Request::ptr request)
 {
     NetFn netFn = request->ctx->netFn;
     if (netFnGroup == netFn)
@@ -321,9 +990,31 @@ message::Response::ptr executeIpmiCommand(message::Request::ptr request)
     {
         return executeIpmiOemCommand(request);
     }
+    if (dispatchTableFrozen)
+    {
+        return executeIpmiCommandDense(request);
+    }
     return executeIpmiCommandCommon(handlerMap, netFn, request);
 }
 
+message::Response::ptr executeIpmiCommand(message::Request::ptr request)
+{
+    auto start = std::chrono::steady_clock::now();
+    dbus_stats::attribute(*request->ctx);
+    message::Response::ptr response = dispatchIpmiCommand(request);
+    dbus_stats::release(*request->ctx);
+    dbus_stats::checkBudget(*request->ctx);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    stats::record(request->ctx->netFn, request->ctx->cmd,
+                  request->ctx->channel, response->cc, elapsed);
+    IPMID_PROBE(
+        command__done, request->ctx->netFn, request->ctx->cmd,
+        request->ctx->channel, response->cc,
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+            .count());
+    return response;
+}
+
 namespace utils
 {
 template <typename AssocContainer, typename UnaryPredicate>
@@ -340,7 +1031,36 @@ void assoc_erase_if(AssocContainer& c, UnaryPredicate p)
 
 namespace
 {
-std::unordered_map<std::string, uint8_t> uniqueNameToChannelNumber;
+/* channels of the connections owning a channel bus name, keyed by the
+ * packed unique name of the connection, see uniqueNameKey */
+std::unordered_map<uint64_t, uint8_t> uniqueNameToChannelNumber;
+
+/* channel of every other sender, resolved once at startup */
+uint8_t intraBmcChannel = invalidChannel;
+
+/* pack a unique connection name ":<a>.<b>" into an integer, so resolving
+ * the channel of a request costs an integer hash lookup */
+std::optional<uint64_t> uniqueNameKey(std::string_view name)
+{
+    if (name.size() < 4 || name[0] != ':')
+    {
+        return std::nullopt;
+    }
+    const char* end = name.data() + name.size();
+    uint32_t major = 0;
+    uint32_t minor = 0;
+    auto [dot, ec] = std::from_chars(name.data() + 1, end, major);
+    if (ec != std::errc() || dot == end || *dot != '.')
+    {
+        return std::nullopt;
+    }
+    auto [last, ec2] = std::from_chars(dot + 1, end, minor);
+    if (ec2 != std::errc() || last != end)
+    {
+        return std::nullopt;
+    }
+    return (static_cast<uint64_t>(major) << 32) | minor;
+}
 
 // sdbusplus::bus::match::rules::arg0namespace() wants the prefix
 // to match without any trailing '.'
@@ -363,7 +1083,10 @@ void updateOwners(sdbusplus::asio::connection& conn, const std::string& name)
             try
             {
                 uint8_t channel = getChannelByName(chName);
-                uniqueNameToChannelNumber[nameOwner] = channel;
+                if (auto key = uniqueNameKey(nameOwner))
+                {
+                    uniqueNameToChannelNumber[*key] = channel;
+                }
                 log<level::INFO>("New interface mapping",
                                  entry("INTERFACE=%s", name.c_str()),
                                  entry("CHANNEL=%u", channel));
@@ -396,78 +1119,606 @@ void doListNames(boost::asio::io_context& io, sdbusplus::asio::connection& conn)
                 std::string(ipmiDbusChannelMatch) + ".";
             for (const std::string& busName : busNames)
             {
-                if (busName.find(channelPrefix) == 0)
-                {
-                    updateOwners(conn, busName);
-                }
+                if (busName.find(channelPrefix) == 0)
+                {
+                    updateOwners(conn, busName);
+                }
+            }
+        },
+        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+        "ListNames");
+}
+
+void nameChangeHandler(sdbusplus::message::message& message)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+
+    message.read(name, oldOwner, newOwner);
+
+    if (!oldOwner.empty())
+    {
+        if (boost::starts_with(oldOwner, ":"))
+        {
+            // Connection removed
+            if (auto key = uniqueNameKey(oldOwner))
+            {
+                uniqueNameToChannelNumber.erase(*key);
+            }
+        }
+    }
+    if (!newOwner.empty())
+    {
+        // start after ipmiDbusChannelMatch (and after the '.')
+        std::string chName = name.substr(std::strlen(ipmiDbusChannelMatch) + 1);
+        try
+        {
+            uint8_t channel = getChannelByName(chName);
+            if (auto key = uniqueNameKey(newOwner))
+            {
+                uniqueNameToChannelNumber[*key] = channel;
+            }
+            log<level::INFO>("New interface mapping",
+                             entry("INTERFACE=%s", name.c_str()),
+                             entry("CHANNEL=%u", channel));
+        }
+        catch (const std::exception& e)
+        {
+            log<level::INFO>("Failed interface mapping, no such name",
+                             entry("INTERFACE=%s", name.c_str()));
+        }
+    }
+};
+
+} // anonymous namespace
+
+static constexpr const char intraBmcName[] = "INTRABMC";
+
+/* resolve the channel of the intra-BMC senders, off the request path */
+void resolveIntraBmcChannel()
+{
+    // FIXME: currently internal connections are ephemeral and hard to pin down
+    try
+    {
+        intraBmcChannel = getChannelByName(intraBmcName);
+    }
+    catch (const std::exception&)
+    {
+        log<level::ERR>("No INTRABMC channel, intra-BMC requests are refused");
+        intraBmcChannel = invalidChannel;
+    }
+}
+
+uint8_t channelFromMessage(sdbusplus::message::message& msg)
+{
+    // channel name for ipmitool to resolve to
+    if (auto key = uniqueNameKey(msg.get_sender()))
+    {
+        auto chIter = uniqueNameToChannelNumber.find(*key);
+        if (chIter != uniqueNameToChannelNumber.end())
+        {
+            return chIter->second;
+        }
+    }
+    return intraBmcChannel;
+}
+
+} // namespace ipmi
+
+/* Admission of the request coroutines. Every request runs in its own
+ * coroutine on the one io_context, so a burst of slow requests on one
+ * channel would delay the others without bound. Each channel may only run a
+ * few requests at once and all the channels together a few more; requests
+ * over those limits wait in a bounded queue per channel class, which is
+ * served by smooth weighted round robin so the system interface keeps
+ * getting through while a LAN burst is queued. A request that finds its
+ * queue full, or that waits too long, is answered with Node Busy.
+ */
+class RequestScheduler
+{
+  public:
+    enum class Class : size_t
+    {
+        systemInterface,
+        ipmb,
+        lan,
+        other,
+    };
+
+    /* hold a slot of a channel for as long as it is in scope */
+    class Slot
+    {
+      public:
+        Slot(RequestScheduler& scheduler, uint8_t channel) :
+            scheduler(scheduler), channel(channel)
+        {
+        }
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+        ~Slot()
+        {
+            scheduler.release(channel);
+        }
+
+      private:
+        RequestScheduler& scheduler;
+        uint8_t channel;
+    };
+
+    /* get the class of a channel from its medium type */
+    Class classify(uint8_t channel)
+    {
+        if (channel >= channelClass.size())
+        {
+            return Class::other;
+        }
+        std::optional<Class>& cls = channelClass[channel];
+        if (!cls)
+        {
+            ChannelInfo chInfo{};
+            cls = Class::other;
+            if (getChannelInfo(channel, chInfo) == ccSuccess)
+            {
+                switch (static_cast<EChannelMediumType>(chInfo.mediumType))
+                {
+                    case EChannelMediumType::systemInterface:
+                        cls = Class::systemInterface;
+                        break;
+                    case EChannelMediumType::ipmb:
+                        cls = Class::ipmb;
+                        break;
+                    case EChannelMediumType::lan8032:
+                    case EChannelMediumType::otherLan:
+                        cls = Class::lan;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        return *cls;
+    }
+
+    /* wait for a slot of the channel; false if the request has to be
+     * refused because the queue of its class is full or it waited too long,
+     * which is until its deadline when it has an earlier one
+     */
+    bool acquire(uint8_t channel, Class cls, boost::asio::yield_context yield,
+                 std::optional<std::chrono::steady_clock::time_point>
+                     deadline = std::nullopt)
+    {
+        Queue& queue = queues[static_cast<size_t>(cls)];
+        if (queue.empty() && canRun(channel, cls))
+        {
+            start(channel);
+            return true;
+        }
+        if (queue.size() >= limits[static_cast<size_t>(cls)].queued)
+        {
+            return false;
+        }
+
+        auto expiry = std::chrono::steady_clock::now() + maxQueueTime;
+        if (deadline)
+        {
+            expiry = std::min(expiry, *deadline);
+        }
+        boost::asio::steady_timer timer(*getIoContext(), expiry);
+        Waiter waiter{channel, &timer, false};
+        queue.push_back(&waiter);
+        boost::system::error_code ec;
+        timer.async_wait(yield[ec]);
+        if (waiter.admitted)
+        {
+            return true;
+        }
+        queue.erase(std::find(queue.begin(), queue.end(), &waiter));
+        return false;
+    }
+
+  private:
+    struct Waiter
+    {
+        uint8_t channel;
+        boost::asio::steady_timer* timer;
+        bool admitted;
+    };
+    using Queue = std::deque<Waiter*>;
+
+    struct Limits
+    {
+        size_t weight;   /* share of the slots while classes are queued */
+        size_t inFlight; /* requests of one channel run at once */
+        size_t queued;   /* requests of the class waiting for a slot */
+    };
+
+    static constexpr size_t classCount = 4;
+    static constexpr size_t maxInFlight = 16;
+    static constexpr auto maxQueueTime = std::chrono::seconds(5);
+    static constexpr std::array<Limits, classCount> limits = {{
+        {4, 4, 32}, /* systemInterface */
+        {2, 4, 16}, /* ipmb */
+        {1, 8, 32}, /* lan */
+        {1, 2, 8},  /* other */
+    }};
+
+    /* a channel past the channel count has no counter of its own, its
+     * requests are only held to the total of maxInFlight */
+    bool canRun(uint8_t channel, Class cls) const
+    {
+        if (inFlight >= maxInFlight)
+        {
+            return false;
+        }
+        return channel >= channelInFlight.size() ||
+               channelInFlight[channel] <
+                   limits[static_cast<size_t>(cls)].inFlight;
+    }
+
+    void start(uint8_t channel)
+    {
+        inFlight++;
+        if (channel < channelInFlight.size())
+        {
+            channelInFlight[channel]++;
+        }
+    }
+
+    void release(uint8_t channel)
+    {
+        inFlight--;
+        if (channel < channelInFlight.size())
+        {
+            channelInFlight[channel]--;
+        }
+        admit();
+    }
+
+    /* hand the free slots to the waiters, by weight between the classes */
+    void admit()
+    {
+        while (inFlight < maxInFlight)
+        {
+            std::array<Queue::iterator, classCount> next;
+            size_t totalWeight = 0;
+            std::optional<size_t> chosen;
+            for (size_t c = 0; c < classCount; c++)
+            {
+                Queue& queue = queues[c];
+                next[c] = std::find_if(
+                    queue.begin(), queue.end(), [this, c](const Waiter* w) {
+                        return canRun(w->channel, static_cast<Class>(c));
+                    });
+                if (next[c] == queue.end())
+                {
+                    continue;
+                }
+                current[c] += limits[c].weight;
+                totalWeight += limits[c].weight;
+                if (!chosen || current[c] > current[*chosen])
+                {
+                    chosen = c;
+                }
+            }
+            if (!chosen)
+            {
+                return;
+            }
+            current[*chosen] -= totalWeight;
+
+            Waiter* waiter = *next[*chosen];
+            queues[*chosen].erase(next[*chosen]);
+            start(waiter->channel);
+            waiter->admitted = true;
+            waiter->timer->cancel();
+        }
+    }
+
+    size_t inFlight = 0;
+    std::array<size_t, maxIpmiChannels> channelInFlight{};
+    std::array<std::optional<Class>, maxIpmiChannels> channelClass;
+    std::array<Queue, classCount> queues;
+    /* smooth weighted round robin credit of each class */
+    std::array<ssize_t, classCount> current{};
+};
+
+static RequestScheduler requestScheduler;
+
+/* spawns the coroutines of the requests ipmid takes in itself, at most
+ * MAX_REQUEST_COROUTINES live at once so that a burst of requests does not
+ * allocate a stack for each; the requests past the cap wait in a queue,
+ * which holds no stack, and start as the live coroutines end. The
+ * coroutines sdbusplus spawns for the execute method calls are counted in
+ * the statistics too, but not capped. */
+class RequestCoroutines
+{
+  public:
+    using Function = std::function<void(boost::asio::yield_context)>;
+
+    void spawn(Function&& function)
+    {
+        if (live >= MAX_REQUEST_COROUTINES)
+        {
+            waiting.push_back(std::move(function));
+            record(false);
+            return;
+        }
+        start(std::move(function));
+    }
+
+    /* count a coroutine this class did not spawn for as long as it is in
+     * scope */
+    class Uncapped
+    {
+      public:
+        explicit Uncapped(RequestCoroutines& coroutines) :
+            coroutines(coroutines)
+        {
+            coroutines.uncapped++;
+            coroutines.record(true);
+        }
+        Uncapped(const Uncapped&) = delete;
+        Uncapped& operator=(const Uncapped&) = delete;
+        ~Uncapped()
+        {
+            coroutines.uncapped--;
+            coroutines.record(false);
+        }
+
+      private:
+        RequestCoroutines& coroutines;
+    };
+
+  private:
+    /* ends the coroutine slot, also when the request throws */
+    struct Finish
+    {
+        ~Finish()
+        {
+            // posted, so that the next stack is only allocated once this
+            // coroutine returned
+            boost::asio::post(*getIoContext(),
+                              [coroutines = coroutines]() {
+                                  coroutines->finish();
+                              });
+        }
+
+        RequestCoroutines* coroutines;
+    };
+
+    void start(Function&& function)
+    {
+        live++;
+        record(true);
+        auto body = [this, function = std::move(function)](
+                        boost::asio::yield_context yield) {
+            Finish finish{this};
+            function(yield);
+        };
+        if constexpr (REQUEST_STACK_SIZE > 0)
+        {
+            boost::asio::spawn(
+                *getIoContext(), std::move(body),
+                boost::coroutines::attributes(REQUEST_STACK_SIZE));
+        }
+        else
+        {
+            boost::asio::spawn(*getIoContext(), std::move(body));
+        }
+    }
+
+    void finish()
+    {
+        live--;
+        if (waiting.empty())
+        {
+            record(false);
+            return;
+        }
+        Function next = std::move(waiting.front());
+        waiting.pop_front();
+        start(std::move(next));
+    }
+
+    void record(bool spawned)
+    {
+        stats::recordCoroutines(live + uncapped, waiting.size(), spawned);
+    }
+
+    size_t live = 0;
+    size_t uncapped = 0;
+    std::deque<Function> waiting;
+};
+
+static RequestCoroutines requestCoroutines;
+
+/* the options of an execute call */
+struct ExecuteOptions
+{
+    std::optional<int> privilege;
+    std::optional<int> userId;
+    std::optional<uint32_t> sessionId;
+    std::optional<int> rqSA;
+    std::optional<int> hostId;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+};
+
+/* decode the options in one pass; options of an unexpected type are
+ * treated as missing */
+static ExecuteOptions
+    decodeOptions(const std::map<std::string, ipmi::Value>& options)
+{
+    ExecuteOptions decoded;
+    for (const auto& [key, value] : options)
+    {
+        if (const int* i = std::get_if<int>(&value))
+        {
+            if (key == "privilege")
+            {
+                decoded.privilege = *i;
+            }
+            else if (key == "userId")
+            {
+                decoded.userId = *i;
+            }
+            else if (key == "rqSA")
+            {
+                decoded.rqSA = *i;
+            }
+            else if (key == "hostId")
+            {
+                decoded.hostId = *i;
+            }
+        }
+        else if (const uint32_t* u = std::get_if<uint32_t>(&value))
+        {
+            if (key == "currentSessionId")
+            {
+                decoded.sessionId = *u;
             }
-        },
-        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
-        "ListNames");
+        }
+        else if (const uint64_t* u64 = std::get_if<uint64_t>(&value))
+        {
+            // CLOCK_MONOTONIC microseconds, which steady_clock counts too
+            if (key == "deadline")
+            {
+                decoded.deadline = std::chrono::steady_clock::time_point(
+                    std::chrono::microseconds(*u64));
+            }
+        }
+    }
+    return decoded;
 }
 
-void nameChangeHandler(sdbusplus::message::message& message)
+/* the host a system interface channel serves, resolved once per channel */
+static int hostOfSystemInterface(uint8_t channel)
 {
-    std::string name;
-    std::string oldOwner;
-    std::string newOwner;
+    static std::array<std::optional<int>, maxIpmiChannels> hosts;
+    if (channel >= hosts.size())
+    {
+        return 0;
+    }
+    std::optional<int>& host = hosts[channel];
+    if (!host)
+    {
+        host = phosphor::host::command::hostOfChannel(getChannelName(channel));
+    }
+    return *host;
+}
 
-    message.read(name, oldOwner, newOwner);
+/* dispatch a request from the channel it came in on, the way every
+ * transport does; the response is left empty when the request is refused */
+static Cc executeRequest(boost::asio::yield_context yield,
+                         const char* sender, NetFn netFn, uint8_t lun,
+                         Cmd cmd, uint8_t channel,
+                         const ExecuteOptions& decoded,
+                         std::vector<uint8_t>&& data,
+                         message::Response::ptr& response)
+{
+    IPMID_PROBE(request__start, netFn, lun, cmd, channel, data.size());
+    Privilege privilege = Privilege::None;
+    int rqSA = 0;
+    int hostIdx = 0;
+    uint8_t userId = 0; // undefined user
+    uint32_t sessionId = 0;
 
-    if (!oldOwner.empty())
+    // session-based channels are required to provide userId, privilege and
+    // sessionId
+    if (getChannelSessionSupport(channel) != EChannelSessSupported::none)
     {
-        if (boost::starts_with(oldOwner, ":"))
+        if (!decoded.privilege || !decoded.userId || !decoded.sessionId)
         {
-            // Connection removed
-            auto it = uniqueNameToChannelNumber.find(oldOwner);
-            if (it != uniqueNameToChannelNumber.end())
-            {
-                uniqueNameToChannelNumber.erase(it);
-            }
+            log<level::ERR>("ERROR determining IPMI session credentials",
+                            entry("CHANNEL=%u", channel),
+                            entry("NETFN=0x%X", netFn), entry("CMD=0x%X", cmd));
+            return ipmi::ccUnspecifiedError;
         }
+        privilege = static_cast<Privilege>(*decoded.privilege);
+        userId = static_cast<uint8_t>(*decoded.userId);
+        sessionId = *decoded.sessionId;
     }
-    if (!newOwner.empty())
+    else
     {
-        // start after ipmiDbusChannelMatch (and after the '.')
-        std::string chName = name.substr(std::strlen(ipmiDbusChannelMatch) + 1);
-        try
+        // get max privilege for session-less channels
+        // For now, there is not a way to configure this, default to Admin
+        privilege = Privilege::Admin;
+
+        // ipmb should supply rqSA
+        RequestScheduler::Class channelClass =
+            requestScheduler.classify(channel);
+        if (channelClass == RequestScheduler::Class::ipmb)
         {
-            uint8_t channel = getChannelByName(chName);
-            uniqueNameToChannelNumber[newOwner] = channel;
-            log<level::INFO>("New interface mapping",
-                             entry("INTERFACE=%s", name.c_str()),
-                             entry("CHANNEL=%u", channel));
+            rqSA = decoded.rqSA.value_or(0);
+            hostIdx = decoded.hostId.value_or(0);
         }
-        catch (const std::exception& e)
+        else if (channelClass == RequestScheduler::Class::systemInterface)
         {
-            log<level::INFO>("Failed interface mapping, no such name",
-                             entry("INTERFACE=%s", name.c_str()));
+            hostIdx = hostOfSystemInterface(channel);
         }
     }
-};
-
-} // anonymous namespace
+    // check to see if the requested priv/username is valid
+    log<level::DEBUG>("Set up ipmi context", entry("SENDER=%s", sender),
+                      entry("NETFN=0x%X", netFn), entry("LUN=0x%X", lun),
+                      entry("CMD=0x%X", cmd), entry("CHANNEL=%u", channel),
+                      entry("USERID=%u", userId),
+                      entry("SESSIONID=0x%X", sessionId),
+                      entry("PRIVILEGE=%u", static_cast<uint8_t>(privilege)),
+                      entry("RQSA=%x", rqSA));
 
-static constexpr const char intraBmcName[] = "INTRABMC";
-uint8_t channelFromMessage(sdbusplus::message::message& msg)
-{
-    // channel name for ipmitool to resolve to
-    std::string sender = msg.get_sender();
-    auto chIter = uniqueNameToChannelNumber.find(sender);
-    if (chIter != uniqueNameToChannelNumber.end())
+    const auto expired = [&decoded]() {
+        return decoded.deadline &&
+               std::chrono::steady_clock::now() >= *decoded.deadline;
+    };
+    // the requester gave up on it, running it would only extend an overload
+    if (expired())
     {
-        return chIter->second;
+        stats::recordShed();
+        return ipmi::ccBusy;
     }
-    // FIXME: currently internal connections are ephemeral and hard to pin down
-    try
+    // under pressure, the critical commands go past the scheduler and the
+    // expensive ones wait for the pressure to go first
+    pressure::Lane lane = pressure::laneOf(netFn, cmd);
+    std::optional<pressure::FastLane> fastLane;
+    if (lane == pressure::Lane::critical && pressure::active())
     {
-        return getChannelByName(intraBmcName);
+        fastLane.emplace();
     }
-    catch (const std::exception& e)
+    std::optional<RequestScheduler::Slot> slot;
+    if (!fastLane || !*fastLane)
     {
-        return invalidChannel;
+        if (lane == pressure::Lane::expensive &&
+            !pressure::defer(yield, decoded.deadline))
+        {
+            return ipmi::ccBusy;
+        }
+        if (!requestScheduler.acquire(channel,
+                                      requestScheduler.classify(channel),
+                                      yield, decoded.deadline))
+        {
+            if (expired())
+            {
+                stats::recordShed();
+            }
+            return ipmi::ccBusy;
+        }
+        slot.emplace(requestScheduler, channel);
     }
-} // namespace ipmi
+
+    auto ctx = std::allocate_shared<ipmi::Context>(
+        message::details::PoolAllocator<ipmi::Context>(), getSdBus(), netFn,
+        lun, cmd, channel, userId, sessionId, privilege, rqSA, hostIdx, yield);
+    ctx->deadline = decoded.deadline;
+    auto request = std::allocate_shared<ipmi::message::Request>(
+        message::details::PoolAllocator<ipmi::message::Request>(), ctx,
+        std::move(data));
+    response = executeIpmiCommand(request);
+    if (ctx->expired())
+    {
+        stats::recordLate();
+    }
+    return ipmi::ccSuccess;
+}
 
 /* called from sdbus async server context */
 auto executionEntry(boost::asio::yield_context yield,
@@ -481,12 +1732,8 @@ auto executionEntry(boost::asio::yield_context yield,
             uint8_t retNetFn = netFn | netFnResponse;
             return std::make_tuple(retNetFn, lun, cmd, cc, data);
         };
+    RequestCoroutines::Uncapped coroutine(requestCoroutines);
     std::string sender = m.get_sender();
-    Privilege privilege = Privilege::None;
-    int rqSA = 0;
-    int hostIdx = 0;
-    uint8_t userId = 0; // undefined user
-    uint32_t sessionId = 0;
 
     // figure out what channel the request came in on
     uint8_t channel = channelFromMessage(m);
@@ -499,77 +1746,340 @@ auto executionEntry(boost::asio::yield_context yield,
         return dbusResponse(ipmi::ccDestinationUnavailable);
     }
 
-    // session-based channels are required to provide userId, privilege and
-    // sessionId
-    if (getChannelSessionSupport(channel) != EChannelSessSupported::none)
+    message::Response::ptr response;
+    Cc cc = executeRequest(yield, sender.c_str(), netFn, lun, cmd, channel,
+                           decodeOptions(options), std::move(data), response);
+    if (!response)
     {
-        try
-        {
-            Value requestPriv = options.at("privilege");
-            Value requestUserId = options.at("userId");
-            Value requestSessionId = options.at("currentSessionId");
-            privilege = static_cast<Privilege>(std::get<int>(requestPriv));
-            userId = static_cast<uint8_t>(std::get<int>(requestUserId));
-            sessionId =
-                static_cast<uint32_t>(std::get<uint32_t>(requestSessionId));
-        }
-        catch (const std::exception& e)
+        return dbusResponse(cc);
+    }
+    return dbusResponse(response->cc, response->payload.raw);
+}
+
+/* one request of an executeBatch call and its response */
+using BatchRequest = std::tuple<NetFn, uint8_t, Cmd, std::vector<uint8_t>,
+                                std::map<std::string, ipmi::Value>>;
+using BatchResponse =
+    std::tuple<uint8_t, uint8_t, uint8_t, Cc, std::vector<uint8_t>>;
+
+/* requests of an executeBatch call past this many are answered Node Busy */
+constexpr size_t maxBatchRequests = 64;
+
+/* called from sdbus async server context; the requests of the batch run
+ * concurrently, each admitted by the request scheduler on its own, and the
+ * responses come back in the order of the requests */
+auto executionBatchEntry(boost::asio::yield_context yield,
+                         sdbusplus::message::message& m,
+                         std::vector<BatchRequest>& requests)
+{
+    struct Batch
+    {
+        Batch(boost::asio::io_context& io, size_t size) :
+            done(io, boost::asio::steady_timer::time_point::max()),
+            responses(size)
         {
-            log<level::ERR>("ERROR determining IPMI session credentials",
-                            entry("CHANNEL=%u", channel),
-                            entry("NETFN=0x%X", netFn), entry("CMD=0x%X", cmd));
-            return dbusResponse(ipmi::ccUnspecifiedError);
         }
-    }
-    else
+
+        // cancelled once the last request of the batch is answered
+        boost::asio::steady_timer done;
+        size_t pending = 0;
+        std::vector<BatchResponse> responses;
+    };
+
+    constexpr uint8_t netFnResponse = 0x01;
+    std::string sender = m.get_sender();
+    uint8_t channel = channelFromMessage(m);
+    if (channel == invalidChannel)
     {
-        // get max privilege for session-less channels
-        // For now, there is not a way to configure this, default to Admin
-        privilege = Privilege::Admin;
+        // unknown sender channel; refuse to service the requests
+        log<level::ERR>("ERROR determining source IPMI channel",
+                        entry("SENDER=%s", sender.c_str()),
+                        entry("COUNT=%zu", requests.size()));
+    }
 
-        // ipmb should supply rqSA
-        ChannelInfo chInfo;
-        getChannelInfo(channel, chInfo);
-        if (static_cast<EChannelMediumType>(chInfo.mediumType) ==
-            EChannelMediumType::ipmb)
+    auto batch = std::make_shared<Batch>(*getIoContext(), requests.size());
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        auto& [netFn, lun, cmd, data, options] = requests[i];
+        batch->responses[i] = std::make_tuple(
+            static_cast<uint8_t>(netFn | netFnResponse), lun, cmd,
+            channel == invalidChannel ? ipmi::ccDestinationUnavailable
+                                      : ipmi::ccBusy,
+            std::vector<uint8_t>{});
+        if (channel == invalidChannel || i >= maxBatchRequests)
         {
-            const auto iter = options.find("rqSA");
-            if (iter != options.end())
-            {
-                if (std::holds_alternative<int>(iter->second))
+            continue;
+        }
+
+        // counted before the spawn, which can run the request to its end
+        batch->pending++;
+        requestCoroutines.spawn(
+            [batch, i, sender, channel, netFn = netFn, lun = lun, cmd = cmd,
+             data = std::move(data), decoded = decodeOptions(options)](
+                boost::asio::yield_context yield) mutable {
+                message::Response::ptr response;
+                Cc cc = executeRequest(yield, sender.c_str(), netFn, lun, cmd,
+                                       channel, decoded, std::move(data),
+                                       response);
+                BatchResponse& answer = batch->responses[i];
+                if (response)
                 {
-                    rqSA = std::get<int>(iter->second);
+                    std::get<3>(answer) = response->cc;
+                    std::get<4>(answer) = std::move(response->payload.raw);
                 }
-            }
-            const auto iteration = options.find("hostId");
-            if (iteration != options.end())
-            {
-                if (std::holds_alternative<int>(iteration->second))
+                else
                 {
-                    hostIdx = std::get<int>(iteration->second);
+                    std::get<3>(answer) = cc;
                 }
-            }
+                if (--batch->pending == 0)
+                {
+                    batch->done.cancel();
+                }
+            });
+    }
+
+    if (batch->pending)
+    {
+        boost::system::error_code ec;
+        batch->done.async_wait(yield[ec]);
+    }
+    return std::move(batch->responses);
+}
+
+#ifdef IPMI_NATIVE_TRANSPORT
+namespace bridge
+{
+
+using Descriptor = boost::asio::posix::stream_descriptor;
+
+/* send one response packet, waiting while the socket is full; the data is
+ * sent from the response, without a copy */
+static void sendResponse(Descriptor& conn, const ResponseHeader& header,
+                         const std::vector<uint8_t>& data,
+                         boost::asio::yield_context yield)
+{
+    std::array<iovec, 2> iov{
+        iovec{const_cast<ResponseHeader*>(&header), sizeof(header)},
+        iovec{const_cast<uint8_t*>(data.data()), data.size()}};
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = iov.size();
+    while (conn.is_open())
+    {
+        if (sendmsg(conn.native_handle(), &msg, MSG_NOSIGNAL) >= 0)
+        {
+            return;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+            // the bridge went away, its requests are answered to nobody
+            return;
+        }
+        boost::system::error_code ec;
+        conn.async_wait(Descriptor::wait_write, yield[ec]);
+        if (ec)
+        {
+            return;
         }
     }
-    // check to see if the requested priv/username is valid
-    log<level::DEBUG>("Set up ipmi context", entry("SENDER=%s", sender.c_str()),
-                      entry("NETFN=0x%X", netFn), entry("LUN=0x%X", lun),
-                      entry("CMD=0x%X", cmd), entry("CHANNEL=%u", channel),
-                      entry("USERID=%u", userId),
-                      entry("SESSIONID=0x%X", sessionId),
-                      entry("PRIVILEGE=%u", static_cast<uint8_t>(privilege)),
-                      entry("RQSA=%x", rqSA));
+}
+
+static void serveRequest(const std::shared_ptr<Descriptor>& conn,
+                         const RequestHeader& header,
+                         std::vector<uint8_t>&& data,
+                         boost::asio::yield_context yield)
+{
+    ResponseHeader rsp{};
+    rsp.version = header.version;
+    rsp.netFn = header.netFn | 0x01;
+    rsp.lun = header.lun;
+    rsp.cmd = header.cmd;
+    rsp.tag = header.tag;
+
+    if (!isValidChannel(header.channel))
+    {
+        log<level::ERR>("ERROR determining source IPMI channel",
+                        entry("CHANNEL=%u", header.channel),
+                        entry("NETFN=0x%X", header.netFn),
+                        entry("CMD=0x%X", header.cmd));
+        rsp.cc = ipmi::ccDestinationUnavailable;
+        sendResponse(*conn, rsp, {}, yield);
+        return;
+    }
 
-    auto ctx = std::make_shared<ipmi::Context>(getSdBus(), netFn, lun, cmd,
-                                               channel, userId, sessionId,
-                                               privilege, rqSA, hostIdx, yield);
-    auto request = std::make_shared<ipmi::message::Request>(
-        ctx, std::forward<std::vector<uint8_t>>(data));
-    message::Response::ptr response = executeIpmiCommand(request);
+    ExecuteOptions decoded;
+    decoded.privilege = header.privilege;
+    decoded.userId = header.userId;
+    decoded.sessionId = header.sessionId;
+    decoded.rqSA = header.rqSA;
+    decoded.hostId = header.hostIdx;
+    if (header.deadlineUs)
+    {
+        decoded.deadline = std::chrono::steady_clock::time_point(
+            std::chrono::microseconds(header.deadlineUs));
+    }
 
-    return dbusResponse(response->cc, response->payload.raw);
+    message::Response::ptr response;
+    rsp.cc = executeRequest(yield, socketPath, header.netFn, header.lun,
+                            header.cmd, header.channel, decoded,
+                            std::move(data), response);
+    if (!response)
+    {
+        sendResponse(*conn, rsp, {}, yield);
+        return;
+    }
+    rsp.cc = response->cc;
+    sendResponse(*conn, rsp, response->payload.raw, yield);
+}
+
+/* read the request packets of a bridge, every request runs in its own
+ * coroutine so that a slow command does not hold up the ones behind it */
+static void serveConnection(const std::shared_ptr<Descriptor>& conn,
+                            boost::asio::yield_context yield)
+{
+    while (conn->is_open())
+    {
+        boost::system::error_code ec;
+        conn->async_wait(Descriptor::wait_read, yield[ec]);
+        if (ec)
+        {
+            return;
+        }
+        // the size of the next packet, without reading it
+        ssize_t size = recv(conn->native_handle(), nullptr, 0,
+                            MSG_PEEK | MSG_TRUNC);
+        if (size < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            continue;
+        }
+        if (size <= 0)
+        {
+            // the bridge closed the connection
+            return;
+        }
+
+        // the version of the packet tells the size of its header
+        RequestHeader header{};
+        if (recv(conn->native_handle(), &header.version,
+                 sizeof(header.version), MSG_PEEK) < 0)
+        {
+            return;
+        }
+        size_t headerSize = requestHeaderSize(header.version);
+        std::vector<uint8_t> data;
+        bool valid = headerSize != 0 &&
+                     static_cast<size_t>(size) >= headerSize &&
+                     static_cast<size_t>(size) - headerSize <= maxRequestData;
+        if (valid)
+        {
+            // read the request data straight into the request buffer
+            data.resize(size - headerSize);
+        }
+        else
+        {
+            headerSize = sizeof(header);
+        }
+        std::array<iovec, 2> iov{iovec{&header, headerSize},
+                                 iovec{data.data(), data.size()}};
+        msghdr msg{};
+        msg.msg_iov = iov.data();
+        msg.msg_iovlen = iov.size();
+        // a malformed packet is read into the header only, which drops it
+        if (recvmsg(conn->native_handle(), &msg, 0) < 0)
+        {
+            return;
+        }
+        if (!valid)
+        {
+            log<level::ERR>("Dropped a malformed native transport request",
+                            entry("SIZE=%zd", size),
+                            entry("VERSION=%u", header.version));
+            continue;
+        }
+
+        requestCoroutines.spawn([conn, header, data = std::move(data)](
+                                    boost::asio::yield_context yield) mutable {
+            serveRequest(conn, header, std::move(data), yield);
+        });
+    }
+}
+
+/* accept the bridges, only root may connect */
+static void acceptConnections(const std::shared_ptr<Descriptor>& listener,
+                              boost::asio::yield_context yield)
+{
+    while (listener->is_open())
+    {
+        boost::system::error_code ec;
+        listener->async_wait(Descriptor::wait_read, yield[ec]);
+        if (ec)
+        {
+            return;
+        }
+        int fd = accept4(listener->native_handle(), nullptr, nullptr,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        ucred cred{};
+        socklen_t len = sizeof(cred);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0 ||
+            cred.uid != 0)
+        {
+            log<level::ERR>("Refused a native transport connection",
+                            entry("PID=%d", cred.pid),
+                            entry("UID=%u", cred.uid));
+            close(fd);
+            continue;
+        }
+
+        auto conn = std::make_shared<Descriptor>(*getIoContext(), fd);
+        boost::asio::spawn(*getIoContext(),
+                           [conn](boost::asio::yield_context yield) {
+                               serveConnection(conn, yield);
+                           });
+    }
+}
+
+/* listen on the native transport socket next to the D-Bus execute method */
+static void start(boost::asio::io_context& io)
+{
+    std::error_code err;
+    fs::path path(socketPath);
+    fs::create_directories(path.parent_path(), err);
+    fs::remove(path, err);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        log<level::ERR>("Failed to create the native transport socket",
+                        entry("ERROR=%s", strerror(errno)));
+        return;
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        chmod(socketPath, S_IRUSR | S_IWUSR) < 0 || listen(fd, SOMAXCONN) < 0)
+    {
+        log<level::ERR>("Failed to listen on the native transport socket",
+                        entry("PATH=%s", socketPath),
+                        entry("ERROR=%s", strerror(errno)));
+        close(fd);
+        return;
+    }
+
+    auto listener = std::make_shared<Descriptor>(io, fd);
+    boost::asio::spawn(io, [listener](boost::asio::yield_context yield) {
+        acceptConnections(listener, yield);
+    });
 }
 
+} // namespace bridge
+#endif /* IPMI_NATIVE_TRANSPORT */
+
 /** @struct IpmiProvider
  *
  *  RAII wrapper for dlopen so that dlclose gets called on exit
@@ -668,15 +2178,33 @@ std::forward_list<IpmiProvider> loadProviders(const fs::path& ipmiLibsPath)
     }
     std::sort(libs.begin(), libs.end());
 
+    // startup profile: the libraries register their handlers and run their
+    // initialization from their constructors while they are opened
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
     std::forward_list<IpmiProvider> handles;
+    auto loadStart = std::chrono::steady_clock::now();
     for (auto& lib : libs)
     {
 #ifdef __IPMI_DEBUG__
         log<level::DEBUG>("Registering handler",
                           entry("HANDLER=%s", lib.c_str()));
 #endif
+        auto start = std::chrono::steady_clock::now();
         handles.emplace_front(lib.c_str());
+        auto elapsed = duration_cast<microseconds>(
+            std::chrono::steady_clock::now() - start);
+        log<level::INFO>("Loaded IPMI provider",
+                         entry("PROVIDER=%s", lib.c_str()),
+                         entry("USEC=%lld",
+                               static_cast<long long>(elapsed.count())));
     }
+    auto elapsed = duration_cast<microseconds>(
+        std::chrono::steady_clock::now() - loadStart);
+    log<level::INFO>("Loaded IPMI providers",
+                     entry("COUNT=%zu", libs.size()),
+                     entry("USEC=%lld",
+                           static_cast<long long>(elapsed.count())));
     return handles;
 }
 
@@ -766,20 +2294,34 @@ void handleLegacyIpmiCommand(sdbusplus::message::message& m)
 {
     // make a copy so the next two moves don't wreak havoc on the stack
     sdbusplus::message::message b{m};
-    boost::asio::spawn(*getIoContext(), [b = std::move(b)](
-                                            boost::asio::yield_context yield) {
+    ipmi::requestCoroutines.spawn([b = std::move(b)](
+                                      boost::asio::yield_context yield) {
         sdbusplus::message::message m{std::move(b)};
         unsigned char seq, netFn, lun, cmd;
         std::vector<uint8_t> data;
 
         m.read(seq, netFn, lun, cmd, data);
         std::shared_ptr<sdbusplus::asio::connection> bus = getSdBus();
-        auto ctx = std::make_shared<ipmi::Context>(
-            bus, netFn, lun, cmd, 0, 0, 0, ipmi::Privilege::Admin, 0, 0, yield);
-        auto request = std::make_shared<ipmi::message::Request>(
+        auto ctx = std::allocate_shared<ipmi::Context>(
+            ipmi::message::details::PoolAllocator<ipmi::Context>(), bus, netFn,
+            lun, cmd, 0, 0, 0, ipmi::Privilege::Admin, 0, 0, yield);
+        auto request = std::allocate_shared<ipmi::message::Request>(
+            ipmi::message::details::PoolAllocator<ipmi::message::Request>(),
             ctx, std::forward<std::vector<uint8_t>>(data));
-        ipmi::message::Response::ptr response =
-            ipmi::executeIpmiCommand(request);
+        // the legacy signal comes from the host interface bridges
+        std::optional<ipmi::RequestScheduler::Slot> slot;
+        ipmi::message::Response::ptr response;
+        if (ipmi::requestScheduler.acquire(
+                ipmi::channelSystemIface,
+                ipmi::RequestScheduler::Class::systemInterface, yield))
+        {
+            slot.emplace(ipmi::requestScheduler, ipmi::channelSystemIface);
+            response = ipmi::executeIpmiCommand(request);
+        }
+        else
+        {
+            response = ipmi::errorResponse(request, ipmi::ccBusy);
+        }
 
         // Responses in IPMI require a bit set.  So there ya go...
         netFn |= 0x01;
@@ -813,6 +2355,12 @@ void ipmid_send_cmd_to_host(CommandHandler&& cmd)
     return cmdManager->execute(std::forward<CommandHandler>(cmd));
 }
 
+void ipmid_send_cmd_to_host(CommandHandler&& cmd,
+                            phosphor::host::command::HostId hostId)
+{
+    return cmdManager->execute(std::forward<CommandHandler>(cmd), hostId);
+}
+
 std::unique_ptr<phosphor::host::command::Manager>& ipmid_get_host_cmd_manager()
 {
     return cmdManager;
@@ -823,6 +2371,44 @@ std::unique_ptr<phosphor::host::command::Manager>& ipmid_get_host_cmd_manager()
 extern void setIoContext(std::shared_ptr<boost::asio::io_context>& newIo);
 extern void setSdBus(std::shared_ptr<sdbusplus::asio::connection>& newBus);
 
+#ifdef IPMID_BENCHMARK
+namespace ipmi
+{
+namespace benchmark
+{
+
+/* the dispatcher benchmark brings its own io context and session bus; load
+ * the providers of a directory into the dense dispatch table like main does,
+ * they stay loaded for the life of the process */
+void loadProviders(const fs::path& ipmiLibsPath)
+{
+    // the legacy providers and the worker threads use the raw bus
+    ::bus = getSdBus()->get_bus();
+    sessionBus = true;
+    static std::forward_list<IpmiProvider> providers =
+        ipmi::loadProviders(ipmiLibsPath);
+    freezeDispatchTable();
+}
+
+/* run the handlers registered with Execution::worker on a pool, like main
+ * does when built with HANDLER_WORKER_THREADS */
+void startWorkers(size_t threads)
+{
+    workerPool = std::make_unique<boost::asio::thread_pool>(threads);
+}
+
+void stopWorkers()
+{
+    if (workerPool)
+    {
+        workerPool->join();
+        workerPool.reset();
+    }
+}
+
+} // namespace benchmark
+} // namespace ipmi
+#else
 int main(int argc, char* argv[])
 {
     // Connect to system bus
@@ -830,6 +2416,7 @@ int main(int argc, char* argv[])
     setIoContext(io);
     if (argc > 1 && std::string(argv[1]) == "-session")
     {
+        sessionBus = true;
         sd_bus_default_user(&bus);
     }
     else
@@ -850,9 +2437,20 @@ int main(int argc, char* argv[])
 
     cmdManager = std::make_unique<phosphor::host::command::Manager>(*sdbusp);
 
+    // ahead of the providers, so that theirs take over
+    ipmi::ipmb::registerBridging();
+    ipmi::pressure::startMonitor();
+
+    if constexpr (HANDLER_WORKER_THREADS > 0)
+    {
+        ipmi::workerPool =
+            std::make_unique<boost::asio::thread_pool>(HANDLER_WORKER_THREADS);
+    }
+
     // Register all command providers and filters
     std::forward_list<ipmi::IpmiProvider> providers =
         ipmi::loadProviders(HOST_IPMI_LIB_PATH);
+    ipmi::freezeDispatchTable();
 
 #ifdef ALLOW_DEPRECATED_API
     // listen on deprecated signal interface for kcs/bt commands
@@ -870,6 +2468,7 @@ int main(int argc, char* argv[])
                 ipmi::ipmiDbusChannelMatch),
         ipmi::nameChangeHandler);
     ipmi::doListNames(*io, *sdbusp);
+    ipmi::resolveIntraBmcChannel();
 
     int exitCode = 0;
     // set up boost::asio signal handling
@@ -890,11 +2489,23 @@ int main(int argc, char* argv[])
     auto iface = server.add_interface("/xyz/openbmc_project/Ipmi",
                                       "xyz.openbmc_project.Ipmi.Server");
     iface->register_method("execute", ipmi::executionEntry);
+    iface->register_method("executeBatch", ipmi::executionBatchEntry);
     iface->initialize();
+#ifdef IPMI_NATIVE_TRANSPORT
+    ipmi::bridge::start(*io);
+#endif
+    auto statsIface = ipmi::stats::registerStatistics(server);
 
     io->run();
 
+    // finish the worker handlers before their providers go away
+    if (ipmi::workerPool)
+    {
+        ipmi::workerPool->join();
+        ipmi::workerPool.reset();
+    }
     // destroy all the IPMI handlers so the providers can unload safely
+    ipmi::releaseDispatchTable();
     ipmi::handlerMap.clear();
     ipmi::groupHandlerMap.clear();
     ipmi::oemHandlerMap.clear();
@@ -904,3 +2515,4 @@ int main(int argc, char* argv[])
 
     std::exit(exitCode);
 }
+#endif /* IPMID_BENCHMARK */
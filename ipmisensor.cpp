@@ -2,6 +2,12 @@
 
 #include <malloc.h>
 
+#include <array>
+#include <cstring>
+#include <string>
+#include <variant>
+#include <vector>
+
 extern uint8_t find_type_for_sensor_number(uint8_t);
 
 struct sensorRES_t
@@ -22,25 +28,52 @@ struct sensorRES_t
 #define ASSERTINDEX 0
 #define DEASSERTINDEX 1
 
+// A D-Bus method call a reading triggers, with its string or byte value
+struct dbus_call_t
+{
+    const char* member;
+    std::variant<std::string, uint8_t> value;
+};
+
+// The calls of one reading, one per method.  The offsets of a reading are
+// reported in turn and a later one setting the same method replaces the
+// value of an earlier one, the way the calls used to land on the object.
+struct dbus_calls_t
+{
+    void set(const char* member, std::variant<std::string, uint8_t>&& value)
+    {
+        for (auto& call : calls)
+        {
+            if (!strcmp(call.member, member))
+            {
+                call.value = std::move(value);
+                return;
+            }
+        }
+        calls.push_back({member, std::move(value)});
+    }
+
+    std::vector<dbus_call_t> calls;
+};
+
 // Sensor Type,  Offset, function handler, Dbus Method, Assert value, Deassert
 // value
 struct lookup_t
 {
     uint8_t sensor_type;
     uint8_t offset;
-    int (*func)(const sensorRES_t*, const lookup_t*, const char*);
+    void (*func)(const sensorRES_t*, const lookup_t*, const char*,
+                 dbus_calls_t&);
     char member[16];
     char assertion[64];
     char deassertion[64];
 };
 
-extern int updateDbusInterface(uint8_t, const char*, const char*);
-
-int set_sensor_dbus_state_simple(const sensorRES_t* pRec,
-                                 const lookup_t* pTable, const char* value)
+void set_sensor_dbus_state_simple(const sensorRES_t* pRec,
+                                  const lookup_t* pTable, const char* value,
+                                  dbus_calls_t& calls)
 {
-
-    return set_sensor_dbus_state_s(pRec->sensor_number, pTable->member, value);
+    calls.set(pTable->member, value);
 }
 
 struct event_data_t
@@ -49,7 +82,7 @@ struct event_data_t
     char text[64];
 };
 
-event_data_t g_fwprogress02h[] = {{0x00, "Unspecified"},
+constexpr event_data_t g_fwprogress02h[] = {{0x00, "Unspecified"},
                                   {0x01, "Memory Init"},
                                   {0x02, "HD Init"},
                                   {0x03, "Secondary Proc Init"},
@@ -77,7 +110,7 @@ event_data_t g_fwprogress02h[] = {{0x00, "Unspecified"},
                                   {0x19, "Primary Proc Init"},
                                   {0xFF, "Unknown"}};
 
-event_data_t g_fwprogress00h[] = {
+constexpr event_data_t g_fwprogress00h[] = {
     {0x00, "Unspecified."},
     {0x01, "No system memory detected"},
     {0x02, "No usable system memory"},
@@ -95,25 +128,41 @@ event_data_t g_fwprogress00h[] = {
     {0xFF, "unknown"},
 };
 
-char* event_data_lookup(event_data_t* p, uint8_t b)
-{
+// Text of every event data byte, the text of the 0xFF terminator when the
+// table has none for it
+using event_text_t = std::array<const char*, 256>;
 
-    while (p->data != 0xFF)
+template <size_t N>
+constexpr event_text_t make_event_text(const event_data_t (&table)[N])
+{
+    event_text_t text{};
+    for (auto& t : text)
     {
-        if (p->data == b)
+        t = table[N - 1].text;
+    }
+    for (size_t i = 0; table[i].data != 0xFF; i++)
+    {
+        if (text[table[i].data] == table[N - 1].text)
         {
-            break;
+            text[table[i].data] = table[i].text;
         }
-        p++;
     }
+    return text;
+}
+
+constexpr event_text_t g_fwprogress02hText = make_event_text(g_fwprogress02h);
+constexpr event_text_t g_fwprogress00hText = make_event_text(g_fwprogress00h);
 
-    return p->text;
+const char* event_data_lookup(const event_text_t& text, uint8_t b)
+{
+    return text[b];
 }
 
 //  The fw progress sensor contains some additional information that needs to be
 //  processed prior to calling the dbus code.
-int set_sensor_dbus_state_fwprogress(const sensorRES_t* pRec,
-                                     const lookup_t* pTable, const char* value)
+void set_sensor_dbus_state_fwprogress(const sensorRES_t* pRec,
+                                      const lookup_t* pTable, const char* value,
+                                      dbus_calls_t& calls)
 {
 
     char valuestring[128];
@@ -125,18 +174,18 @@ int set_sensor_dbus_state_fwprogress(const sensorRES_t* pRec,
         case 0x00:
             std::snprintf(
                 p, sizeof(valuestring), "POST Error, %s",
-                event_data_lookup(g_fwprogress00h, pRec->event_data2));
+                event_data_lookup(g_fwprogress00hText, pRec->event_data2));
             break;
         case 0x01: /* Using g_fwprogress02h for 0x01 because that's what the
                       ipmi spec says to do */
             std::snprintf(
                 p, sizeof(valuestring), "FW Hang, %s",
-                event_data_lookup(g_fwprogress02h, pRec->event_data2));
+                event_data_lookup(g_fwprogress02hText, pRec->event_data2));
             break;
         case 0x02:
             std::snprintf(
                 p, sizeof(valuestring), "FW Progress, %s",
-                event_data_lookup(g_fwprogress02h, pRec->event_data2));
+                event_data_lookup(g_fwprogress02hText, pRec->event_data2));
             break;
         default:
             std::snprintf(
@@ -146,22 +195,22 @@ int set_sensor_dbus_state_fwprogress(const sensorRES_t* pRec,
             break;
     }
 
-    return set_sensor_dbus_state_s(pRec->sensor_number, pTable->member, p);
+    calls.set(pTable->member, p);
 }
 
 // Handling this special OEM sensor by coping what is in byte 4.  I also think
 // that is odd considering byte 3 is for sensor reading.  This seems like a
 // misuse of the IPMI spec
-int set_sensor_dbus_state_osbootcount(const sensorRES_t* pRec,
-                                      const lookup_t* pTable, const char* value)
+void set_sensor_dbus_state_osbootcount(const sensorRES_t* pRec,
+                                       const lookup_t* pTable,
+                                       const char* value, dbus_calls_t& calls)
 {
-    return set_sensor_dbus_state_y(pRec->sensor_number, "setValue",
-                                   pRec->assert_state7_0);
+    calls.set("setValue", pRec->assert_state7_0);
 }
 
-int set_sensor_dbus_state_system_event(const sensorRES_t* pRec,
-                                       const lookup_t* pTable,
-                                       const char* value)
+void set_sensor_dbus_state_system_event(const sensorRES_t* pRec,
+                                        const lookup_t* pTable,
+                                        const char* value, dbus_calls_t& calls)
 {
     char valuestring[128];
     char* p = valuestring;
@@ -199,13 +248,13 @@ int set_sensor_dbus_state_system_event(const sensorRES_t* pRec,
             break;
     }
 
-    return set_sensor_dbus_state_s(pRec->sensor_number, pTable->member, p);
+    calls.set(pTable->member, p);
 }
 
 //  This table lists only senors we care about telling dbus about.
 //  Offset definition cab be found in section 42.2 of the IPMI 2.0
 //  spec.  Add more if/when there are more items of interest.
-lookup_t g_ipmidbuslookup[] = {
+constexpr lookup_t g_ipmidbuslookup[] = {
 
     {0xe9, 0x00, set_sensor_dbus_state_simple, "setValue", "Disabled",
      ""}, // OCC Inactive 0
@@ -249,36 +298,55 @@ lookup_t g_ipmidbuslookup[] = {
     {0xCA, 0x01, set_sensor_dbus_state_simple, "setValue", "Enabled", ""},
     {0xFF, 0xFF, NULL, "", "", ""}};
 
-void reportSensorEventAssert(const sensorRES_t* pRec, int index)
+// Offsets a sensor type can report, section 42.2 of the IPMI 2.0 spec
+constexpr size_t maxOffsets = 16;
+
+// Index + 1 of the g_ipmidbuslookup entry of every sensor type and offset,
+// 0 for the ones not reported
+using lookup_index_t = std::array<std::array<uint8_t, maxOffsets>, 256>;
+
+constexpr lookup_index_t make_lookup_index()
 {
-    lookup_t* pTable = &g_ipmidbuslookup[index];
-    (*pTable->func)(pRec, pTable, pTable->assertion);
+    lookup_index_t index{};
+    for (size_t i = 0; g_ipmidbuslookup[i].sensor_type != 0xFF; i++)
+    {
+        const lookup_t& entry = g_ipmidbuslookup[i];
+        // the first entry of a sensor type and offset is the one reported
+        if (entry.offset < maxOffsets &&
+            index[entry.sensor_type][entry.offset] == 0)
+        {
+            index[entry.sensor_type][entry.offset] = i + 1;
+        }
+    }
+    return index;
 }
-void reportSensorEventDeassert(const sensorRES_t* pRec, int index)
+
+static_assert(std::size(g_ipmidbuslookup) <= 0xFF,
+              "lookup table indexes must fit a byte");
+constexpr lookup_index_t g_lookupIndex = make_lookup_index();
+
+void reportSensorEventAssert(const sensorRES_t* pRec, int index,
+                             dbus_calls_t& calls)
 {
-    lookup_t* pTable = &g_ipmidbuslookup[index];
-    (*pTable->func)(pRec, pTable, pTable->deassertion);
+    const lookup_t* pTable = &g_ipmidbuslookup[index];
+    (*pTable->func)(pRec, pTable, pTable->assertion, calls);
+}
+void reportSensorEventDeassert(const sensorRES_t* pRec, int index,
+                               dbus_calls_t& calls)
+{
+    const lookup_t* pTable = &g_ipmidbuslookup[index];
+    (*pTable->func)(pRec, pTable, pTable->deassertion, calls);
 }
 
 int findindex(const uint8_t sensor_type, int offset, int* index)
 {
-
-    int i = 0, rc = 0;
-    lookup_t* pTable = g_ipmidbuslookup;
-
-    do
+    if (offset < 0 || offset >= static_cast<int>(maxOffsets) ||
+        g_lookupIndex[sensor_type][offset] == 0)
     {
-        if (((pTable + i)->sensor_type == sensor_type) &&
-            ((pTable + i)->offset == offset))
-        {
-            rc = 1;
-            *index = i;
-            break;
-        }
-        i++;
-    } while ((pTable + i)->sensor_type != 0xFF);
-
-    return rc;
+        return 0;
+    }
+    *index = g_lookupIndex[sensor_type][offset] - 1;
+    return 1;
 }
 
 bool shouldReport(uint8_t sensorType, int offset, int* index)
@@ -306,6 +374,7 @@ int updateSensorRecordFromSSRAESC(const void* record)
     auto pRec = static_cast<const sensorRES_t*>(record);
     uint8_t stype;
     int index;
+    dbus_calls_t calls;
 
     stype = find_type_for_sensor_number(pRec->sensor_number);
 
@@ -314,8 +383,10 @@ int updateSensorRecordFromSSRAESC(const void* record)
     // function
     if (stype == 0xC3)
     {
-        shouldReport(stype, 0x00, &index);
-        reportSensorEventAssert(pRec, index);
+        if (shouldReport(stype, 0x00, &index))
+        {
+            reportSensorEventAssert(pRec, index, calls);
+        }
     }
     else
     {
@@ -327,25 +398,40 @@ int updateSensorRecordFromSSRAESC(const void* record)
             if ((ISBITSET(pRec->assert_state7_0, i)) &&
                 (shouldReport(stype, i, &index)))
             {
-                reportSensorEventAssert(pRec, index);
+                reportSensorEventAssert(pRec, index, calls);
             }
             if ((ISBITSET(pRec->assert_state14_8, i)) &&
                 (shouldReport(stype, i + 8, &index)))
             {
-                reportSensorEventAssert(pRec, index);
+                reportSensorEventAssert(pRec, index, calls);
             }
             if ((ISBITSET(pRec->deassert_state7_0, i)) &&
                 (shouldReport(stype, i, &index)))
             {
-                reportSensorEventDeassert(pRec, index);
+                reportSensorEventDeassert(pRec, index, calls);
             }
             if ((ISBITSET(pRec->deassert_state14_8, i)) &&
                 (shouldReport(stype, i + 8, &index)))
             {
-                reportSensorEventDeassert(pRec, index);
+                reportSensorEventDeassert(pRec, index, calls);
             }
         }
     }
 
+    // one call per method, whatever the number of offsets reporting it
+    for (const auto& call : calls.calls)
+    {
+        if (auto value = std::get_if<std::string>(&call.value))
+        {
+            set_sensor_dbus_state_s(pRec->sensor_number, call.member,
+                                    value->c_str());
+        }
+        else
+        {
+            set_sensor_dbus_state_y(pRec->sensor_number, call.member,
+                                    std::get<uint8_t>(call.value));
+        }
+    }
+
     return 0;
 }
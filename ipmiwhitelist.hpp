@@ -1,8 +1,43 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <utility>
-#include <vector>
 
 using netfncmd_pair = std::pair<unsigned char, unsigned char>;
 
-extern const std::vector<netfncmd_pair> whitelist;
+/** @brief bit per (NetFn, Command), the NetFn being 6 bits wide */
+static constexpr size_t whitelistNetFns = 64;
+static constexpr size_t whitelistCmds = 256;
+using WhitelistBits =
+    std::array<uint64_t, whitelistNetFns * whitelistCmds / 64>;
+
+/** @brief builds the whitelist bitmap of a list of (NetFn, Command) pairs,
+ *  at compile time when used to initialize a constexpr table
+ */
+template <size_t N>
+constexpr WhitelistBits makeWhitelist(const netfncmd_pair (&entries)[N])
+{
+    WhitelistBits bits{};
+    for (const auto& [netFn, cmd] : entries)
+    {
+        size_t bit = (netFn % whitelistNetFns) * whitelistCmds + cmd;
+        bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    return bits;
+}
+
+/** @brief checks if a (NetFn, Command) pair is whitelisted */
+inline bool isWhitelisted(const WhitelistBits& bits, uint8_t netFn,
+                          uint8_t cmd)
+{
+    if (netFn >= whitelistNetFns)
+    {
+        return false;
+    }
+    size_t bit = netFn * whitelistCmds + cmd;
+    return (bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+extern const WhitelistBits whitelist;
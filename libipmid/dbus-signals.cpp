@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <ipmid/api.hpp>
+#include <ipmid/dbus-signals.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message/types.hpp>
+#include <set>
+
+namespace ipmi
+{
+namespace dbus_signals
+{
+
+namespace
+{
+
+namespace rules = sdbusplus::bus::match::rules;
+
+constexpr auto root = "/";
+
+template <typename Event>
+using Handler = std::function<void(const Event&)>;
+
+/** @struct Signal
+ *  @brief the matches and the subscribers of one signal class
+ */
+template <typename Event>
+struct Signal
+{
+    // by the prefix they match under, the widest prefixes subscribed
+    std::map<std::string, std::unique_ptr<sdbusplus::bus::match_t>> matches;
+    // by subscription id, with their prefix
+    std::map<uint64_t, std::pair<std::string, std::shared_ptr<Handler<Event>>>>
+        subscribers;
+    // the match under a prefix, set by the first subscription
+    std::function<std::unique_ptr<sdbusplus::bus::match_t>(const std::string&)>
+        makeMatch;
+};
+
+// handlers running on the worker threads subscribe too
+std::mutex hubMutex;
+uint64_t lastId = 0;
+Signal<InterfacesAdded> added;
+Signal<InterfacesRemoved> removed;
+Signal<PropertiesChanged> changed;
+Signal<NameOwnerChanged> owners;
+
+bool covers(const std::string& prefix, const std::string& path)
+{
+    if (prefix == root || prefix == path)
+    {
+        return true;
+    }
+    return path.size() > prefix.size() &&
+           path.compare(0, prefix.size(), prefix) == 0 &&
+           path[prefix.size()] == '/';
+}
+
+/** @brief the prefix without a trailing slash, "/" when empty */
+std::string normalized(const std::string& prefix)
+{
+    std::string path(prefix);
+    while (path.size() > 1 && path.back() == '/')
+    {
+        path.pop_back();
+    }
+    return path.empty() ? root : path;
+}
+
+const std::string& pathOf(const InterfacesAdded& event)
+{
+    return event.path;
+}
+
+const std::string& pathOf(const InterfacesRemoved& event)
+{
+    return event.path;
+}
+
+const std::string& pathOf(const PropertiesChanged& event)
+{
+    return event.path;
+}
+
+const std::string& pathOf(const NameOwnerChanged&)
+{
+    // subscribed to under the root only
+    static const std::string all(root);
+    return all;
+}
+
+std::optional<InterfacesAdded> decodeAdded(sdbusplus::message::message& msg)
+{
+    InterfacesAdded event;
+    sdbusplus::message::object_path path;
+    try
+    {
+        msg.read(path);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        return std::nullopt;
+    }
+    event.path = std::move(path.str);
+    try
+    {
+        msg.read(event.interfaces);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        event.complete = false;
+    }
+    return event;
+}
+
+std::optional<InterfacesRemoved>
+    decodeRemoved(sdbusplus::message::message& msg)
+{
+    InterfacesRemoved event;
+    sdbusplus::message::object_path path;
+    try
+    {
+        msg.read(path);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        return std::nullopt;
+    }
+    event.path = std::move(path.str);
+    try
+    {
+        msg.read(event.interfaces);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        event.complete = false;
+    }
+    return event;
+}
+
+std::optional<PropertiesChanged>
+    decodeChanged(sdbusplus::message::message& msg)
+{
+    PropertiesChanged event;
+    event.path = msg.get_path();
+    try
+    {
+        msg.read(event.interface, event.changed, event.invalidated);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        event.complete = false;
+    }
+    return event;
+}
+
+std::optional<NameOwnerChanged> decodeOwner(sdbusplus::message::message& msg)
+{
+    NameOwnerChanged event;
+    try
+    {
+        msg.read(event.name, event.oldOwner, event.newOwner);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        return std::nullopt;
+    }
+    return event;
+}
+
+/** @brief the signal a match under a prefix got, to the subscribers it
+ *         covers, unless the match was retired
+ */
+template <typename Event, typename Decode>
+void deliver(Signal<Event>& signal, const std::string& prefix,
+             sdbusplus::message::message& msg, Decode&& decode)
+{
+    {
+        std::lock_guard<std::mutex> lock(hubMutex);
+        if (signal.subscribers.empty() || !signal.matches.count(prefix))
+        {
+            return;
+        }
+    }
+    std::optional<Event> event = decode(msg);
+    if (!event)
+    {
+        return;
+    }
+
+    std::vector<std::shared_ptr<Handler<Event>>> handlers;
+    {
+        std::lock_guard<std::mutex> lock(hubMutex);
+        for (const auto& subscriber : signal.subscribers)
+        {
+            if (covers(subscriber.second.first, pathOf(*event)))
+            {
+                handlers.push_back(subscriber.second.second);
+            }
+        }
+    }
+    for (const auto& handler : handlers)
+    {
+        (*handler)(*event);
+    }
+}
+
+/** @brief let go of a match taken off a signal
+ *
+ *  The match may be the one whose signal is being delivered, so while the
+ *  main loop runs it goes once the loop is back, it delivers nothing
+ *  meanwhile.
+ */
+void retire(std::unique_ptr<sdbusplus::bus::match_t>&& match)
+{
+    std::shared_ptr<boost::asio::io_context> io = getIoContext();
+    if (io && !io->stopped())
+    {
+        boost::asio::post(
+            *io, [retired = std::shared_ptr<sdbusplus::bus::match_t>(
+                      std::move(match))]() {});
+    }
+}
+
+/** @brief match the signal under the widest prefixes subscribed, and no
+ *         other
+ *
+ *  A wider prefix takes the place of the matches within it, and a match
+ *  no subscriber is left within goes, those of the narrower prefixes left
+ *  within it take its place. The new matches are made before the old ones
+ *  go, so no signal is missed. Called with the hub lock held.
+ */
+template <typename Event>
+void reconcile(Signal<Event>& signal)
+{
+    std::set<std::string> wanted;
+    for (const auto& subscriber : signal.subscribers)
+    {
+        const std::string& path = subscriber.second.first;
+        bool within = std::any_of(
+            signal.subscribers.begin(), signal.subscribers.end(),
+            [&path](const auto& other) {
+                return other.second.first != path &&
+                       covers(other.second.first, path);
+            });
+        if (!within)
+        {
+            wanted.insert(path);
+        }
+    }
+    for (const std::string& path : wanted)
+    {
+        if (!signal.matches.count(path))
+        {
+            signal.matches.emplace(path, signal.makeMatch(path));
+        }
+    }
+    for (auto match = signal.matches.begin(); match != signal.matches.end();)
+    {
+        if (wanted.count(match->first))
+        {
+            ++match;
+            continue;
+        }
+        retire(std::move(match->second));
+        match = signal.matches.erase(match);
+    }
+}
+
+template <typename Event, typename Rule, typename Decode>
+Subscription subscribe(Signal<Event>& signal, const std::string& prefix,
+                       Handler<Event>&& handler, Rule&& rule, Decode decode)
+{
+    std::string path = normalized(prefix);
+    std::lock_guard<std::mutex> lock(hubMutex);
+    if (!signal.makeMatch)
+    {
+        signal.makeMatch = [&signal, rule = std::forward<Rule>(rule),
+                            decode](const std::string& matched) {
+            return std::make_unique<sdbusplus::bus::match_t>(
+                *getSdBus(), rule(matched),
+                [&signal, matched, decode](sdbusplus::message::message& m) {
+                    deliver(signal, matched, m, decode);
+                });
+        };
+    }
+    uint64_t id = ++lastId;
+    signal.subscribers.emplace(
+        id, std::make_pair(path, std::make_shared<Handler<Event>>(
+                                     std::move(handler))));
+    reconcile(signal);
+    return Subscription(id);
+}
+
+/** @brief an object manager signal rule, for the objects under a prefix */
+std::string objectRule(std::string rule, const std::string& prefix)
+{
+    if (prefix != root)
+    {
+        rule += rules::argNpath(0, prefix + "/");
+    }
+    return rule;
+}
+
+} // namespace
+
+Subscription& Subscription::operator=(Subscription&& other) noexcept
+{
+    if (this != &other)
+    {
+        Subscription released(std::move(*this));
+        id = other.id;
+        other.id = 0;
+    }
+    return *this;
+}
+
+Subscription::~Subscription()
+{
+    if (!id)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(hubMutex);
+    if (added.subscribers.erase(id))
+    {
+        reconcile(added);
+    }
+    if (removed.subscribers.erase(id))
+    {
+        reconcile(removed);
+    }
+    if (changed.subscribers.erase(id))
+    {
+        reconcile(changed);
+    }
+    if (owners.subscribers.erase(id))
+    {
+        reconcile(owners);
+    }
+}
+
+Subscription
+    onInterfacesAdded(const std::string& prefix,
+                      std::function<void(const InterfacesAdded&)>&& handler)
+{
+    return subscribe(
+        added, prefix, std::move(handler),
+        [](const std::string& path) {
+            return objectRule(rules::interfacesAdded(), path);
+        },
+        decodeAdded);
+}
+
+Subscription onInterfacesRemoved(
+    const std::string& prefix,
+    std::function<void(const InterfacesRemoved&)>&& handler)
+{
+    return subscribe(
+        removed, prefix, std::move(handler),
+        [](const std::string& path) {
+            return objectRule(rules::interfacesRemoved(), path);
+        },
+        decodeRemoved);
+}
+
+Subscription onPropertiesChanged(
+    const std::string& prefix,
+    std::function<void(const PropertiesChanged&)>&& handler)
+{
+    return subscribe(
+        changed, prefix, std::move(handler),
+        [](const std::string& path) {
+            std::string rule =
+                rules::type::signal() + rules::member("PropertiesChanged") +
+                rules::interface("org.freedesktop.DBus.Properties");
+            if (path != root)
+            {
+                rule += rules::path_namespace(path);
+            }
+            return rule;
+        },
+        decodeChanged);
+}
+
+Subscription
+    onNameOwnerChanged(std::function<void(const NameOwnerChanged&)>&& handler)
+{
+    return subscribe(
+        owners, root, std::move(handler),
+        [](const std::string&) { return rules::nameOwnerChanged(); },
+        decodeOwner);
+}
+
+} // namespace dbus_signals
+} // namespace ipmi
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <ipmid/dbus-stats.hpp>
+#include <ipmid/probes.hpp>
+#include <mutex>
+#include <phosphor-logging/log.hpp>
+
+// the D-Bus helper probes, see ipmid/probes.hpp
+IPMID_PROBE_SEMAPHORE(dbus__call);
+IPMID_PROBE_SEMAPHORE(dbus__return);
+
+namespace ipmi
+{
+namespace dbus_stats
+{
+
+namespace
+{
+
+// handlers running on the worker threads make calls too
+std::mutex statsMutex;
+std::map<uint16_t, Counters> commands;
+std::map<uint16_t, Budget> budgets;
+
+// the request the calls of this thread are charged to
+thread_local Context* current = nullptr;
+
+uint16_t keyOf(const Context* ctx)
+{
+    return ctx ? makeKey(ctx->netFn, ctx->cmd) : unattributed;
+}
+
+} // namespace
+
+std::map<uint16_t, Counters> getStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return commands;
+}
+
+void reset()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    commands.clear();
+}
+
+void setBudget(NetFn netFn, Cmd cmd, const Budget& budget)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (budget.calls == 0 && budget.time.count() == 0)
+    {
+        budgets.erase(makeKey(netFn, cmd));
+        return;
+    }
+    budgets.insert_or_assign(makeKey(netFn, cmd), budget);
+}
+
+void attribute(Context& ctx)
+{
+    ctx.dbusNamed++;
+    current = &ctx;
+}
+
+void release(Context& ctx)
+{
+    ctx.dbusNamed--;
+    if (current == &ctx)
+    {
+        current = nullptr;
+    }
+}
+
+void checkBudget(const Context& ctx)
+{
+    if (ctx.dbusCalls == 0)
+    {
+        return;
+    }
+    uint16_t key = makeKey(ctx.netFn, ctx.cmd);
+    uint64_t timeUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(ctx.dbusTime)
+            .count();
+    uint64_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        auto budget = budgets.find(key);
+        if (budget == budgets.end())
+        {
+            return;
+        }
+        const Budget& limit = budget->second;
+        if ((limit.calls == 0 || ctx.dbusCalls <= limit.calls) &&
+            (limit.time.count() == 0 ||
+             timeUs <= static_cast<uint64_t>(limit.time.count())))
+        {
+            return;
+        }
+        count = ++commands[key].overBudget;
+    }
+
+    // every request over is counted, the log is thinned out to the powers
+    // of two
+    if ((count & (count - 1)) == 0)
+    {
+        phosphor::logging::log<phosphor::logging::level::WARNING>(
+            "IPMI command went over its D-Bus budget",
+            phosphor::logging::entry("NETFN=0x%X", ctx.netFn),
+            phosphor::logging::entry("CMD=0x%X", ctx.cmd),
+            phosphor::logging::entry("CALLS=%u", ctx.dbusCalls),
+            phosphor::logging::entry("TIME_US=%llu",
+                                     static_cast<unsigned long long>(timeUs)),
+            phosphor::logging::entry("TIMES=%llu",
+                                     static_cast<unsigned long long>(count)));
+    }
+}
+
+Call::Call() : exceptions(std::uncaught_exceptions())
+{
+    IPMID_PROBE(dbus__call, keyOf(current) >> 8, keyOf(current) & 0xFF);
+}
+
+Call::Call(Context& ctx) : ctx(&ctx), exceptions(std::uncaught_exceptions())
+{
+    IPMID_PROBE(dbus__call, ctx.netFn, ctx.cmd);
+}
+
+Call::~Call()
+{
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t us =
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    failed = failed || std::uncaught_exceptions() > exceptions;
+    // the Context of a background coroutine is never named, it may be gone
+    // by the time the next call on the thread is charged
+    if (ctx && ctx->dbusNamed)
+    {
+        // the request owns the thread again after its yield
+        current = ctx;
+    }
+    Context* charged = ctx ? ctx : current;
+    if (charged)
+    {
+        charged->dbusCalls++;
+        charged->dbusTime += elapsed;
+    }
+
+    uint16_t key = keyOf(charged);
+    IPMID_PROBE(dbus__return, key >> 8, key & 0xFF, failed, us);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    Counters& counters = commands[key];
+    counters.calls++;
+    counters.failures += failed;
+    counters.totalUs += us;
+    counters.maxUs = std::max(counters.maxUs, us);
+}
+
+} // namespace dbus_stats
+} // namespace ipmi
@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <boost/asio/steady_timer.hpp>
+#include <future>
+#include <ipmid/api.hpp>
+#include <ipmid/dbus-signals.hpp>
+#include <ipmid/dbus-stats.hpp>
+#include <ipmid/mapper.hpp>
+#include <ipmid/utils.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message/types.hpp>
+#include <tuple>
+
+namespace ipmi
+{
+namespace mapper
+{
+
+namespace
+{
+
+constexpr auto mapperPrivateIntf = "xyz.openbmc_project.ObjectMapper.Private";
+
+/** @brief most answers kept per query kind, a full cache is dropped */
+constexpr size_t maxCachedAnswers = 4096;
+
+using SubTreeKey = std::tuple<std::string, int32_t, InterfaceList>;
+using ObjectKey = std::pair<std::string, InterfaceList>;
+
+/** @struct Flight
+ *  @brief a yielding query in flight, the queries waiting for its answer
+ *         wait on the timer, which is cancelled once the answer is in
+ */
+template <typename Reply>
+struct Flight
+{
+    explicit Flight(boost::asio::io_context& io) :
+        done(io, boost::asio::steady_timer::time_point::max())
+    {
+    }
+
+    boost::asio::steady_timer done;
+    boost::system::error_code ec;
+    Reply reply;
+};
+
+/** @struct Queries
+ *  @brief the cached answers and the queries in flight of one query kind
+ */
+template <typename Key, typename Reply>
+struct Queries
+{
+    std::map<Key, Reply> answers;
+    std::map<Key, std::shared_ptr<Flight<Reply>>> yielding;
+    std::map<Key, std::shared_future<Reply>> blocking;
+};
+
+// handlers running on the worker threads query the mapper too
+std::mutex mapperMutex;
+Queries<SubTreeKey, ObjectTree> subTrees;
+Queries<ObjectKey, ServiceMap> objects;
+Stats stats;
+// bumped by every change, an answer is only cached when no change happened
+// while it was in flight
+uint64_t generation = 0;
+std::vector<dbus_signals::Subscription> watches;
+std::unique_ptr<sdbusplus::bus::match_t> introspectionMatch;
+
+/** @brief the interface filter of a key, in one order for all callers */
+InterfaceList sorted(const InterfaceList& interfaces)
+{
+    InterfaceList list(interfaces);
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+    return list;
+}
+
+bool covers(const std::string& root, const std::string& path)
+{
+    if (root == ROOT || root == path)
+    {
+        return true;
+    }
+    return path.size() > root.size() &&
+           path.compare(0, root.size(), root) == 0 && path[root.size()] == '/';
+}
+
+bool names(const ObjectTree& tree, const std::string& service)
+{
+    return std::any_of(tree.begin(), tree.end(), [&service](const auto& o) {
+        return o.second.find(service) != o.second.end();
+    });
+}
+
+bool names(const ServiceMap& services, const std::string& service)
+{
+    return services.find(service) != services.end();
+}
+
+/** @brief drop the cached answers matching a predicate; the caller holds
+ *         the lock
+ */
+template <typename Answers, typename Predicate>
+void drop(Answers& answers, Predicate&& predicate)
+{
+    for (auto it = answers.begin(); it != answers.end();)
+    {
+        if (predicate(*it))
+        {
+            it = answers.erase(it);
+            stats.invalidations++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void objectChanged(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mapperMutex);
+    generation++;
+    drop(subTrees.answers, [&path](const auto& answer) {
+        return covers(std::get<0>(answer.first), path);
+    });
+    drop(objects.answers,
+         [&path](const auto& answer) { return answer.first.first == path; });
+}
+
+void dropAll()
+{
+    generation++;
+    stats.invalidations += subTrees.answers.size() + objects.answers.size();
+    subTrees.answers.clear();
+    objects.answers.clear();
+}
+
+void ownerChanged(const dbus_signals::NameOwnerChanged& signal)
+{
+    // services that join are picked up by IntrospectionComplete
+    if (!signal.newOwner.empty())
+    {
+        return;
+    }
+
+    const std::string& name = signal.name;
+    std::lock_guard<std::mutex> lock(mapperMutex);
+    if (name == MAPPER_BUS_NAME)
+    {
+        dropAll();
+        return;
+    }
+    generation++;
+    drop(subTrees.answers,
+         [&name](const auto& answer) { return names(answer.second, name); });
+    drop(objects.answers,
+         [&name](const auto& answer) { return names(answer.second, name); });
+}
+
+/** @brief watch the changes that make cached answers stale, once */
+void watch(sdbusplus::bus::bus& bus)
+{
+    std::lock_guard<std::mutex> lock(mapperMutex);
+    if (!watches.empty())
+    {
+        return;
+    }
+    watches.emplace_back(dbus_signals::onInterfacesAdded(
+        ROOT, [](const dbus_signals::InterfacesAdded& signal) {
+            objectChanged(signal.path);
+        }));
+    watches.emplace_back(dbus_signals::onInterfacesRemoved(
+        ROOT, [](const dbus_signals::InterfacesRemoved& signal) {
+            objectChanged(signal.path);
+        }));
+    watches.emplace_back(dbus_signals::onNameOwnerChanged(ownerChanged));
+    // private to the mapper, nothing else listens to it
+    namespace rules = sdbusplus::bus::match::rules;
+    introspectionMatch = std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        rules::type::signal() + rules::interface(mapperPrivateIntf) +
+            rules::member("IntrospectionComplete"),
+        [](sdbusplus::message::message&) {
+            std::lock_guard<std::mutex> lock(mapperMutex);
+            dropAll();
+        });
+}
+
+/** @brief cache an answer unless a change happened while it was in flight;
+ *         the caller holds the lock
+ */
+template <typename Key, typename Reply>
+void store(std::map<Key, Reply>& answers, const Key& key, const Reply& reply,
+           uint64_t started)
+{
+    if (started != generation)
+    {
+        return;
+    }
+    if (answers.size() >= maxCachedAnswers)
+    {
+        stats.invalidations += answers.size();
+        answers.clear();
+    }
+    answers.insert_or_assign(key, reply);
+}
+
+template <typename Key, typename Reply, typename Call>
+Reply query(sdbusplus::bus::bus& bus, Queries<Key, Reply>& queries,
+            const Key& key, Call&& call)
+{
+    // watch before the call, so that no change can be missed
+    watch(bus);
+    std::unique_lock<std::mutex> lock(mapperMutex);
+    auto cached = queries.answers.find(key);
+    if (cached != queries.answers.end())
+    {
+        stats.hits++;
+        return cached->second;
+    }
+    auto inFlight = queries.blocking.find(key);
+    if (inFlight != queries.blocking.end())
+    {
+        stats.coalesced++;
+        std::shared_future<Reply> answer = inFlight->second;
+        lock.unlock();
+        return answer.get();
+    }
+
+    stats.misses++;
+    std::promise<Reply> promise;
+    queries.blocking.emplace(key, promise.get_future().share());
+    uint64_t started = generation;
+    lock.unlock();
+
+    try
+    {
+        Reply reply = call();
+        lock.lock();
+        queries.blocking.erase(key);
+        store(queries.answers, key, reply, started);
+        lock.unlock();
+        promise.set_value(reply);
+        return reply;
+    }
+    catch (...)
+    {
+        lock.lock();
+        queries.blocking.erase(key);
+        lock.unlock();
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+template <typename Key, typename Reply, typename Call>
+boost::system::error_code query(Context::ptr ctx,
+                                Queries<Key, Reply>& queries, const Key& key,
+                                Reply& reply, Call&& call)
+{
+    watch(*ctx->bus);
+    std::unique_lock<std::mutex> lock(mapperMutex);
+    auto cached = queries.answers.find(key);
+    if (cached != queries.answers.end())
+    {
+        stats.hits++;
+        reply = cached->second;
+        return {};
+    }
+    auto inFlight = queries.yielding.find(key);
+    if (inFlight != queries.yielding.end())
+    {
+        stats.coalesced++;
+        std::shared_ptr<Flight<Reply>> flight = inFlight->second;
+        lock.unlock();
+        // woken up by the cancel once the answer is in
+        boost::system::error_code ec;
+        flight->done.async_wait(ctx->yield[ec]);
+        reply = flight->reply;
+        return flight->ec;
+    }
+
+    stats.misses++;
+    auto flight = std::make_shared<Flight<Reply>>(*getIoContext());
+    queries.yielding.emplace(key, flight);
+    uint64_t started = generation;
+    lock.unlock();
+
+    boost::system::error_code ec;
+    try
+    {
+        flight->reply = call(ec);
+    }
+    catch (...)
+    {
+        ec = boost::system::errc::make_error_code(
+            boost::system::errc::io_error);
+    }
+    lock.lock();
+    queries.yielding.erase(key);
+    if (!ec)
+    {
+        store(queries.answers, key, flight->reply, started);
+    }
+    lock.unlock();
+    flight->ec = ec;
+    flight->done.cancel();
+    reply = flight->reply;
+    return ec;
+}
+
+} // namespace
+
+Stats getStats()
+{
+    std::lock_guard<std::mutex> lock(mapperMutex);
+    Stats current = stats;
+    current.cached = subTrees.answers.size() + objects.answers.size();
+    return current;
+}
+
+void clear()
+{
+    std::lock_guard<std::mutex> lock(mapperMutex);
+    dropAll();
+}
+
+ObjectTree getSubTree(sdbusplus::bus::bus& bus, const std::string& root,
+                      int32_t depth, const InterfaceList& interfaces)
+{
+    SubTreeKey key{root, depth, sorted(interfaces)};
+    return query(bus, subTrees, key, [&]() {
+        auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME, MAPPER_OBJ,
+                                              MAPPER_INTF, "GetSubTree");
+        mapperCall.append(root, depth, interfaces);
+        dbus_stats::Call call;
+        auto mapperReply = bus.call(mapperCall);
+        ObjectTree objectTree;
+        mapperReply.read(objectTree);
+        return objectTree;
+    });
+}
+
+ServiceMap getObject(sdbusplus::bus::bus& bus, const std::string& path,
+                     const InterfaceList& interfaces)
+{
+    ObjectKey key{path, sorted(interfaces)};
+    return query(bus, objects, key, [&]() {
+        auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME, MAPPER_OBJ,
+                                              MAPPER_INTF, "GetObject");
+        mapperCall.append(path, interfaces);
+        dbus_stats::Call call;
+        auto mapperReply = bus.call(mapperCall);
+        ServiceMap services;
+        mapperReply.read(services);
+        return services;
+    });
+}
+
+boost::system::error_code getSubTree(Context::ptr ctx, const std::string& root,
+                                     int32_t depth,
+                                     const InterfaceList& interfaces,
+                                     ObjectTree& objectTree)
+{
+    SubTreeKey key{root, depth, sorted(interfaces)};
+    return query(ctx, subTrees, key, objectTree,
+                 [&](boost::system::error_code& ec) {
+                     dbus_stats::Call call(*ctx);
+                     auto tree = ctx->bus->yield_method_call<ObjectTree>(
+                         ctx->yield, ec, MAPPER_BUS_NAME, MAPPER_OBJ,
+                         MAPPER_INTF, "GetSubTree", root, depth, interfaces);
+                     call.check(bool(ec));
+                     return tree;
+                 });
+}
+
+boost::system::error_code getObject(Context::ptr ctx, const std::string& path,
+                                    const InterfaceList& interfaces,
+                                    ServiceMap& services)
+{
+    ObjectKey key{path, sorted(interfaces)};
+    return query(ctx, objects, key, services,
+                 [&](boost::system::error_code& ec) {
+                     dbus_stats::Call call(*ctx);
+                     auto objectServices =
+                         ctx->bus->yield_method_call<ServiceMap>(
+                             ctx->yield, ec, MAPPER_BUS_NAME, MAPPER_OBJ,
+                             MAPPER_INTF, "GetObject", path, interfaces);
+                     call.check(bool(ec));
+                     return objectServices;
+                 });
+}
+
+} // namespace mapper
+} // namespace ipmi
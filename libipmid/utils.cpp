@@ -10,10 +10,17 @@
 
 #include <algorithm>
 #include <chrono>
+#include <ipmid/dbus-stats.hpp>
+#include <ipmid/mapper.hpp>
 #include <ipmid/utils.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/message/types.hpp>
+#include <tuple>
 #include <xyz/openbmc_project/Common/error.hpp>
 
 namespace ipmi
@@ -32,6 +39,131 @@ bool isLinkLocalIP(const std::string& ipaddress);
 
 } // namespace network
 
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct CachedService
+{
+    Clock::time_point fetched;
+    std::string service;
+};
+
+struct CachedProperties
+{
+    Clock::time_point fetched;
+    // a signal could not be decoded or invalidated properties
+    bool stale = true;
+    PropertyMap properties;
+    // keeps the properties current, see DbusCache::track
+    std::unique_ptr<sdbusplus::bus::match_t> changed;
+};
+
+using ServiceKey = std::pair<std::string, std::string>; // interface, path
+using PropertiesKey =
+    std::tuple<std::string, std::string, std::string>; // service, path, intf
+
+// handlers running on the worker threads use the cache too
+std::mutex dbusCacheMutex;
+std::map<ServiceKey, CachedService> cachedServices;
+std::map<PropertiesKey, CachedProperties> cachedProperties;
+std::unique_ptr<sdbusplus::bus::match_t> serviceOwnerChanged;
+
+bool usable(Clock::time_point fetched, const DbusCache& cache)
+{
+    return !cache.bypass && (cache.maxAge == Clock::duration::zero() ||
+                             Clock::now() - fetched < cache.maxAge);
+}
+
+void propertiesChanged(const PropertiesKey& key,
+                       sdbusplus::message::message& msg)
+{
+    std::string interface;
+    PropertyMap changed;
+    std::vector<std::string> invalidated;
+    bool decoded = true;
+    try
+    {
+        msg.read(interface, changed, invalidated);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        decoded = false;
+    }
+
+    std::lock_guard<std::mutex> lock(dbusCacheMutex);
+    auto it = cachedProperties.find(key);
+    if (it == cachedProperties.end())
+    {
+        return;
+    }
+    // the entry is only marked, erasing it would free the running match
+    if (!decoded || !invalidated.empty())
+    {
+        it->second.stale = true;
+        return;
+    }
+    for (auto& [name, value] : changed)
+    {
+        it->second.properties.insert_or_assign(name, std::move(value));
+    }
+}
+
+/** @brief forget the answers of the services that leave the bus */
+void watchServiceOwners(sdbusplus::bus::bus& bus)
+{
+    std::lock_guard<std::mutex> lock(dbusCacheMutex);
+    if (serviceOwnerChanged)
+    {
+        return;
+    }
+    serviceOwnerChanged = std::make_unique<sdbusplus::bus::match_t>(
+        bus, sdbusplus::bus::match::rules::nameOwnerChanged(),
+        [](sdbusplus::message::message& msg) {
+            std::string name, oldOwner, newOwner;
+            try
+            {
+                msg.read(name, oldOwner, newOwner);
+            }
+            catch (const sdbusplus::exception_t&)
+            {
+                return;
+            }
+            if (oldOwner.empty())
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(dbusCacheMutex);
+            for (auto it = cachedServices.begin(); it != cachedServices.end();)
+            {
+                it = it->second.service == name ? cachedServices.erase(it)
+                                                : std::next(it);
+            }
+            for (auto& [key, cached] : cachedProperties)
+            {
+                if (std::get<0>(key) == name)
+                {
+                    cached.stale = true;
+                }
+            }
+        });
+}
+
+void invalidateCachedProperties(const std::string& service,
+                                const std::string& objPath,
+                                const std::string& interface)
+{
+    std::lock_guard<std::mutex> lock(dbusCacheMutex);
+    auto it = cachedProperties.find({service, objPath, interface});
+    if (it != cachedProperties.end())
+    {
+        it->second.stale = true;
+    }
+}
+
+} // namespace
+
 // TODO There may be cases where an interface is implemented by multiple
 //  objects,to handle such cases we are interested on that object
 //  which are on interested busname.
@@ -43,25 +175,8 @@ DbusObjectInfo getDbusObject(sdbusplus::bus::bus& bus,
                              const std::string& serviceRoot,
                              const std::string& match)
 {
-    std::vector<DbusInterface> interfaces;
-    interfaces.emplace_back(interface);
-
-    auto depth = 0;
-
-    auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME, MAPPER_OBJ,
-                                          MAPPER_INTF, "GetSubTree");
-
-    mapperCall.append(serviceRoot, depth, interfaces);
-
-    auto mapperReply = bus.call(mapperCall);
-    if (mapperReply.is_method_error())
-    {
-        log<level::ERR>("Error in mapper call");
-        elog<InternalFailure>();
-    }
-
-    ObjectTree objectTree;
-    mapperReply.read(objectTree);
+    ObjectTree objectTree =
+        mapper::getSubTree(bus, serviceRoot, 0, {interface});
 
     if (objectTree.empty())
     {
@@ -111,6 +226,7 @@ Value getDbusProperty(sdbusplus::bus::bus& bus, const std::string& service,
 
     method.append(interface, property);
 
+    dbus_stats::Call call;
     auto reply = bus.call(method, timeout.count());
 
     if (reply.is_method_error())
@@ -140,6 +256,7 @@ PropertyMap getAllDbusProperties(sdbusplus::bus::bus& bus,
 
     method.append(interface);
 
+    dbus_stats::Call call;
     auto reply = bus.call(method, timeout.count());
 
     if (reply.is_method_error())
@@ -164,6 +281,7 @@ ObjectValueTree getManagedObjects(sdbusplus::bus::bus& bus,
                                       "org.freedesktop.DBus.ObjectManager",
                                       "GetManagedObjects");
 
+    dbus_stats::Call call;
     auto reply = bus.call(method);
 
     if (reply.is_method_error())
@@ -187,6 +305,7 @@ void setDbusProperty(sdbusplus::bus::bus& bus, const std::string& service,
 
     method.append(interface, property, value);
 
+    dbus_stats::Call call;
     if (!bus.call(method, timeout.count()))
     {
         log<level::ERR>("Failed to set property",
@@ -195,6 +314,7 @@ void setDbusProperty(sdbusplus::bus::bus& bus, const std::string& service,
                         entry("INTERFACE=%s", interface.c_str()));
         elog<InternalFailure>();
     }
+    invalidateCachedProperties(service, objPath, interface);
 }
 
 ServiceCache::ServiceCache(const std::string& intf, const std::string& path) :
@@ -238,26 +358,35 @@ bool ServiceCache::isValid(sdbusplus::bus::bus& bus) const
     return cachedService && cachedBusName == bus.get_unique_name();
 }
 
-std::string getService(sdbusplus::bus::bus& bus, const std::string& intf,
-                       const std::string& path)
+boost::system::error_code ServiceCache::getService(Context::ptr ctx,
+                                                   std::string& service)
 {
-    auto mapperCall =
-        bus.new_method_call("xyz.openbmc_project.ObjectMapper",
-                            "/xyz/openbmc_project/object_mapper",
-                            "xyz.openbmc_project.ObjectMapper", "GetObject");
-
-    mapperCall.append(path);
-    mapperCall.append(std::vector<std::string>({intf}));
-
-    auto mapperResponseMsg = bus.call(mapperCall);
-
-    if (mapperResponseMsg.is_method_error())
+    if (!isValid(ctx))
     {
-        throw std::runtime_error("ERROR in mapper call");
+        // the lookup yields, only a complete answer goes into the cache
+        std::string lookedUp;
+        boost::system::error_code ec =
+            ::ipmi::getService(ctx, intf, path, lookedUp);
+        if (ec)
+        {
+            return ec;
+        }
+        cachedBusName = ctx->bus->get_unique_name();
+        cachedService = std::move(lookedUp);
     }
+    service = cachedService.value();
+    return {};
+}
 
-    std::map<std::string, std::vector<std::string>> mapperResponse;
-    mapperResponseMsg.read(mapperResponse);
+bool ServiceCache::isValid(Context::ptr ctx) const
+{
+    return cachedService && cachedBusName == ctx->bus->get_unique_name();
+}
+
+std::string getService(sdbusplus::bus::bus& bus, const std::string& intf,
+                       const std::string& path)
+{
+    mapper::ServiceMap mapperResponse = mapper::getObject(bus, path, {intf});
 
     if (mapperResponse.begin() == mapperResponse.end())
     {
@@ -267,33 +396,124 @@ std::string getService(sdbusplus::bus::bus& bus, const std::string& intf,
     return mapperResponse.begin()->first;
 }
 
-ipmi::ObjectTree getAllDbusObjects(sdbusplus::bus::bus& bus,
-                                   const std::string& serviceRoot,
-                                   const std::string& interface,
-                                   const std::string& match)
+std::string getService(sdbusplus::bus::bus& bus, const std::string& intf,
+                       const std::string& path, const DbusCache& cache)
 {
-    std::vector<std::string> interfaces;
-    interfaces.emplace_back(interface);
+    ServiceKey key{intf, path};
+    {
+        std::lock_guard<std::mutex> lock(dbusCacheMutex);
+        auto it = cachedServices.find(key);
+        if (it != cachedServices.end() && usable(it->second.fetched, cache))
+        {
+            return it->second.service;
+        }
+    }
 
-    auto depth = 0;
+    std::string service = getService(bus, intf, path);
+    watchServiceOwners(bus);
+    std::lock_guard<std::mutex> lock(dbusCacheMutex);
+    cachedServices.insert_or_assign(
+        std::move(key), CachedService{Clock::now(), service});
+    return service;
+}
 
-    auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME, MAPPER_OBJ,
-                                          MAPPER_INTF, "GetSubTree");
+PropertyMap getAllDbusProperties(sdbusplus::bus::bus& bus,
+                                 const std::string& service,
+                                 const std::string& objPath,
+                                 const std::string& interface,
+                                 const DbusCache& cache)
+{
+    PropertiesKey key{service, objPath, interface};
+    bool watch = false;
+    {
+        std::lock_guard<std::mutex> lock(dbusCacheMutex);
+        auto it = cachedProperties.find(key);
+        if (it != cachedProperties.end() && !it->second.stale &&
+            usable(it->second.fetched, cache))
+        {
+            return it->second.properties;
+        }
+        watch = cache.track &&
+                (it == cachedProperties.end() || !it->second.changed);
+    }
+
+    if (watch)
+    {
+        // watch before reading so no change slips in between
+        namespace rules = sdbusplus::bus::match::rules;
+        auto changed = std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            rules::propertiesChanged(objPath, interface) +
+                rules::sender(service),
+            [key](sdbusplus::message::message& msg) {
+                propertiesChanged(key, msg);
+            });
+        std::lock_guard<std::mutex> lock(dbusCacheMutex);
+        CachedProperties& cached = cachedProperties[key];
+        if (!cached.changed)
+        {
+            cached.changed = std::move(changed);
+        }
+    }
 
-    mapperCall.append(serviceRoot, depth, interfaces);
+    PropertyMap properties =
+        getAllDbusProperties(bus, service, objPath, interface);
+    watchServiceOwners(bus);
+    std::lock_guard<std::mutex> lock(dbusCacheMutex);
+    CachedProperties& cached = cachedProperties[key];
+    cached.fetched = Clock::now();
+    cached.stale = false;
+    cached.properties = properties;
+    return properties;
+}
 
-    auto mapperReply = bus.call(mapperCall);
-    if (mapperReply.is_method_error())
+Value getDbusProperty(sdbusplus::bus::bus& bus, const std::string& service,
+                      const std::string& objPath, const std::string& interface,
+                      const std::string& property, const DbusCache& cache)
+{
     {
-        log<level::ERR>("Error in mapper call",
-                        entry("SERVICEROOT=%s", serviceRoot.c_str()),
-                        entry("INTERFACE=%s", interface.c_str()));
+        std::lock_guard<std::mutex> lock(dbusCacheMutex);
+        auto it = cachedProperties.find({service, objPath, interface});
+        if (it != cachedProperties.end() && !it->second.stale &&
+            usable(it->second.fetched, cache))
+        {
+            auto value = it->second.properties.find(property);
+            if (value != it->second.properties.end())
+            {
+                return value->second;
+            }
+        }
+    }
 
+    PropertyMap properties =
+        getAllDbusProperties(bus, service, objPath, interface,
+                             DbusCache{cache.maxAge, cache.track, true});
+    auto value = properties.find(property);
+    if (value == properties.end())
+    {
+        log<level::ERR>("Failed to get property",
+                        entry("PROPERTY=%s", property.c_str()),
+                        entry("PATH=%s", objPath.c_str()),
+                        entry("INTERFACE=%s", interface.c_str()));
         elog<InternalFailure>();
     }
+    return value->second;
+}
 
-    ObjectTree objectTree;
-    mapperReply.read(objectTree);
+void clearDbusCache()
+{
+    std::lock_guard<std::mutex> lock(dbusCacheMutex);
+    cachedServices.clear();
+    cachedProperties.clear();
+}
+
+ipmi::ObjectTree getAllDbusObjects(sdbusplus::bus::bus& bus,
+                                   const std::string& serviceRoot,
+                                   const std::string& interface,
+                                   const std::string& match)
+{
+    ObjectTree objectTree =
+        mapper::getSubTree(bus, serviceRoot, 0, {interface});
 
     for (auto it = objectTree.begin(); it != objectTree.end();)
     {
@@ -352,6 +572,7 @@ ObjectTree getAllAncestors(sdbusplus::bus::bus& bus, const std::string& path,
                                           MAPPER_INTF, "GetAncestors");
     mapperCall.append(path, interfaces);
 
+    dbus_stats::Call call;
     auto mapperReply = bus.call(mapperCall);
     if (mapperReply.is_method_error())
     {
@@ -388,6 +609,7 @@ void callDbusMethod(sdbusplus::bus::bus& bus, const std::string& service,
     auto busMethod = bus.new_method_call(service.c_str(), objPath.c_str(),
                                          interface.c_str(), method.c_str());
 
+    dbus_stats::Call call;
     auto reply = bus.call(busMethod);
 
     if (reply.is_method_error())
@@ -408,18 +630,27 @@ boost::system::error_code getService(Context::ptr ctx, const std::string& intf,
                                      const std::string& path,
                                      std::string& service)
 {
-    boost::system::error_code ec;
-    std::map<std::string, std::vector<std::string>> mapperResponse =
-        ctx->bus->yield_method_call<decltype(mapperResponse)>(
-            ctx->yield, ec, "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetObject", path,
-            std::vector<std::string>({intf}));
+    if (ctx->expired())
+    {
+        return requestExpired();
+    }
+    mapper::ServiceMap mapperResponse;
+    boost::system::error_code ec =
+        mapper::getObject(ctx, path, {intf}, mapperResponse);
 
-    if (!ec)
+    if (ec)
+    {
+        return ec;
+    }
+    if (mapperResponse.empty())
     {
-        service = std::move(mapperResponse.begin()->first);
+        log<level::ERR>("No service implements the interface",
+                        entry("INTERFACE=%s", intf.c_str()),
+                        entry("PATH=%s", path.c_str()));
+        return boost::system::errc::make_error_code(
+            boost::system::errc::no_such_process);
     }
+    service = std::move(mapperResponse.begin()->first);
     return ec;
 }
 
@@ -429,14 +660,13 @@ boost::system::error_code getDbusObject(Context::ptr ctx,
                                         const std::string& match,
                                         DbusObjectInfo& dbusObject)
 {
-    std::vector<DbusInterface> interfaces;
-    interfaces.emplace_back(interface);
-
-    auto depth = 0;
-    boost::system::error_code ec;
-    ObjectTree objectTree = ctx->bus->yield_method_call<ObjectTree>(
-        ctx->yield, ec, MAPPER_BUS_NAME, MAPPER_OBJ, MAPPER_INTF, "GetSubTree",
-        subtreePath, depth, interfaces);
+    if (ctx->expired())
+    {
+        return requestExpired();
+    }
+    ObjectTree objectTree;
+    boost::system::error_code ec =
+        mapper::getSubTree(ctx, subtreePath, 0, {interface}, objectTree);
 
     if (ec)
     {
@@ -490,10 +720,16 @@ boost::system::error_code getAllDbusProperties(Context::ptr ctx,
                                                const std::string& interface,
                                                PropertyMap& properties)
 {
+    if (ctx->expired())
+    {
+        return requestExpired();
+    }
     boost::system::error_code ec;
+    dbus_stats::Call call(*ctx);
     properties = ctx->bus->yield_method_call<PropertyMap>(
         ctx->yield, ec, service.c_str(), objPath.c_str(), PROP_INTF,
         METHOD_GET_ALL, interface);
+    call.check(bool(ec));
     return ec;
 }
 
@@ -503,9 +739,15 @@ boost::system::error_code
                     const std::string& property, const Value& value)
 {
     boost::system::error_code ec;
+    dbus_stats::Call call(*ctx);
     ctx->bus->yield_method_call(ctx->yield, ec, service.c_str(),
                                 objPath.c_str(), PROP_INTF, METHOD_SET,
                                 interface, property, value);
+    call.check(bool(ec));
+    if (!ec)
+    {
+        invalidateCachedProperties(service, objPath, interface);
+    }
     return ec;
 }
 
@@ -515,15 +757,12 @@ boost::system::error_code getAllDbusObjects(Context::ptr ctx,
                                             const std::string& match,
                                             ObjectTree& objectTree)
 {
-    boost::system::error_code ec;
-    std::vector<std::string> interfaces;
-    interfaces.emplace_back(interface);
-
-    auto depth = 0;
-
-    objectTree = ctx->bus->yield_method_call<ObjectTree>(
-        ctx->yield, ec, MAPPER_BUS_NAME, MAPPER_OBJ, MAPPER_INTF, "GetSubTree",
-        serviceRoot, depth, interfaces);
+    if (ctx->expired())
+    {
+        return requestExpired();
+    }
+    boost::system::error_code ec =
+        mapper::getSubTree(ctx, serviceRoot, 0, {interface}, objectTree);
 
     if (ec)
     {
@@ -560,9 +799,11 @@ boost::system::error_code deleteAllDbusObjects(Context::ptr ctx,
 
     for (auto& object : objectTree)
     {
+        dbus_stats::Call call(*ctx);
         ctx->bus->yield_method_call(ctx->yield, ec,
                                     object.second.begin()->first, object.first,
                                     DELETE_INTERFACE, "Delete");
+        call.check(bool(ec));
         if (ec)
         {
             log<level::ERR>("Failed to delete all objects",
@@ -582,10 +823,16 @@ boost::system::error_code getManagedObjects(Context::ptr ctx,
                                             const std::string& objPath,
                                             ObjectValueTree& objects)
 {
+    if (ctx->expired())
+    {
+        return requestExpired();
+    }
     boost::system::error_code ec;
+    dbus_stats::Call call(*ctx);
     objects = ctx->bus->yield_method_call<ipmi::ObjectValueTree>(
         ctx->yield, ec, service.c_str(), objPath.c_str(),
         "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+    call.check(bool(ec));
     return ec;
 }
 
@@ -594,12 +841,16 @@ boost::system::error_code getAllAncestors(Context::ptr ctx,
                                           const InterfaceList& interfaces,
                                           ObjectTree& objectTree)
 {
-    std::string interfaceList = convertToString(interfaces);
-
+    if (ctx->expired())
+    {
+        return requestExpired();
+    }
     boost::system::error_code ec;
+    dbus_stats::Call call(*ctx);
     objectTree = ctx->bus->yield_method_call<ObjectTree>(
         ctx->yield, ec, MAPPER_BUS_NAME, MAPPER_OBJ, MAPPER_INTF,
-        "GetAncestors", path, interfaceList);
+        "GetAncestors", path, interfaces);
+    call.check(bool(ec));
 
     if (ec)
     {
@@ -608,28 +859,91 @@ boost::system::error_code getAllAncestors(Context::ptr ctx,
 
     if (objectTree.empty())
     {
-        log<level::ERR>("No Object has implemented the interface",
-                        entry("PATH=%s", path.c_str()),
-                        entry("INTERFACES=%s", interfaceList.c_str()));
-        elog<InternalFailure>();
+        log<level::ERR>(
+            "No Object has implemented the interface",
+            entry("PATH=%s", path.c_str()),
+            entry("INTERFACES=%s", convertToString(interfaces).c_str()));
+        return boost::system::errc::make_error_code(
+            boost::system::errc::no_such_process);
     }
 
     return ec;
 }
 
+namespace method_no_args
+{
+
+boost::system::error_code callDbusMethod(Context::ptr ctx,
+                                         const std::string& service,
+                                         const std::string& objPath,
+                                         const std::string& interface,
+                                         const std::string& method)
+{
+    boost::system::error_code ec;
+    dbus_stats::Call call(*ctx);
+    ctx->bus->yield_method_call(ctx->yield, ec, service, objPath, interface,
+                                method);
+    call.check(bool(ec));
+    if (ec)
+    {
+        log<level::ERR>("Failed to execute method",
+                        entry("METHOD=%s", method.c_str()),
+                        entry("PATH=%s", objPath.c_str()),
+                        entry("INTERFACE=%s", interface.c_str()),
+                        entry("ERROR=%s", ec.message().c_str()));
+    }
+    return ec;
+}
+
+} // namespace method_no_args
+
 /********* End co-routine yielding alternatives ***************/
 
-ipmi::Cc i2cWriteRead(std::string i2cBus, const uint8_t slaveAddr,
-                      std::vector<uint8_t> writeData,
-                      std::vector<uint8_t>& readBuf)
+namespace
+{
+
+/** @brief an open i2c bus device, shared by the Master Write-Read commands
+ *         of that bus; the lock serializes the transfers on the bus
+ */
+struct I2cBus
 {
-    // Open the i2c device, for low-level combined data write/read
-    int i2cDev = ::open(i2cBus.c_str(), O_RDWR | O_CLOEXEC);
-    if (i2cDev < 0)
+    std::mutex lock;
+    int fd = -1;
+};
+
+std::mutex i2cBusesLock;
+std::map<std::string, std::unique_ptr<I2cBus>> i2cBuses;
+
+I2cBus& getI2cBus(const std::string& i2cBus)
+{
+    std::lock_guard<std::mutex> guard(i2cBusesLock);
+    auto& bus = i2cBuses[i2cBus];
+    if (!bus)
     {
-        log<level::ERR>("Failed to open i2c bus",
-                        phosphor::logging::entry("BUS=%s", i2cBus.c_str()));
-        return ipmi::ccInvalidFieldRequest;
+        bus = std::make_unique<I2cBus>();
+    }
+    return *bus;
+}
+
+} // namespace
+
+ipmi::Cc i2cWriteRead(const std::string& i2cBus, const uint8_t slaveAddr,
+                      const std::vector<uint8_t>& writeData,
+                      std::vector<uint8_t>& readBuf)
+{
+    I2cBus& bus = getI2cBus(i2cBus);
+    std::lock_guard<std::mutex> guard(bus.lock);
+    if (bus.fd < 0)
+    {
+        // Open the i2c device, for low-level combined data write/read; it is
+        // kept open for the next transfers on the bus
+        bus.fd = ::open(i2cBus.c_str(), O_RDWR | O_CLOEXEC);
+        if (bus.fd < 0)
+        {
+            log<level::ERR>("Failed to open i2c bus",
+                            phosphor::logging::entry("BUS=%s", i2cBus.c_str()));
+            return ipmi::ccInvalidFieldRequest;
+        }
     }
 
     const size_t writeCount = writeData.size();
@@ -638,11 +952,12 @@ ipmi::Cc i2cWriteRead(std::string i2cBus, const uint8_t slaveAddr,
     i2c_msg i2cmsg[2] = {0};
     if (writeCount)
     {
-        // Data will be writtern to the slave address
+        // Data will be writtern to the slave address; the kernel does not
+        // write to the buffer of a write message
         i2cmsg[msgCount].addr = slaveAddr;
         i2cmsg[msgCount].flags = 0x00;
         i2cmsg[msgCount].len = writeCount;
-        i2cmsg[msgCount].buf = writeData.data();
+        i2cmsg[msgCount].buf = const_cast<uint8_t*>(writeData.data());
         msgCount++;
     }
     if (readCount)
@@ -660,13 +975,14 @@ ipmi::Cc i2cWriteRead(std::string i2cBus, const uint8_t slaveAddr,
     msgReadWrite.nmsgs = msgCount;
 
     // Perform the combined write/read
-    int ret = ::ioctl(i2cDev, I2C_RDWR, &msgReadWrite);
-    ::close(i2cDev);
-
+    int ret = ::ioctl(bus.fd, I2C_RDWR, &msgReadWrite);
     if (ret < 0)
     {
         log<level::ERR>("I2C WR Failed!",
                         phosphor::logging::entry("RET=%d", ret));
+        // the adapter may have gone away, open it again on the next transfer
+        ::close(bus.fd);
+        bus.fd = -1;
         return ipmi::ccUnspecifiedError;
     }
     if (readCount)
@@ -0,0 +1,271 @@
+#include "pressure.hpp"
+
+#include <algorithm>
+#include <boost/asio/steady_timer.hpp>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <ipmid/api.hpp>
+#include <iterator>
+#include <memory>
+#include <phosphor-logging/log.hpp>
+#include <string>
+
+namespace ipmi
+{
+namespace pressure
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+constexpr auto cpuPressureFile = "/proc/pressure/cpu";
+constexpr auto memoryPressureFile = "/proc/pressure/memory";
+
+/** @struct Waiter
+ *  @brief an expensive command waiting for the pressure to go, on its timer
+ *         which is cancelled once it went
+ */
+struct Waiter
+{
+    boost::asio::steady_timer* timer;
+    bool resumed;
+};
+
+Stats stats;
+size_t fastLaneInUse = 0;
+std::deque<Waiter*> waiters;
+std::unique_ptr<boost::asio::steady_timer> sampleTimer;
+
+std::optional<double> readPressure(const char* file)
+{
+    std::ifstream stream(file);
+    if (!stream)
+    {
+        return std::nullopt;
+    }
+    std::string contents((std::istreambuf_iterator<char>(stream)),
+                         std::istreambuf_iterator<char>());
+    return parseSomeAvg10(contents);
+}
+
+void resumeAll()
+{
+    for (Waiter* waiter : waiters)
+    {
+        waiter->resumed = true;
+        waiter->timer->cancel();
+    }
+    waiters.clear();
+}
+
+void sample()
+{
+    // a kernel may report the CPU pressure but not the memory pressure
+    stats.cpu = readPressure(cpuPressureFile).value_or(0);
+    stats.memory = readPressure(memoryPressureFile).value_or(0);
+    if (!stats.active && (stats.cpu >= cpuHigh || stats.memory >= memoryHigh))
+    {
+        stats.active = true;
+        stats.episodes++;
+        log<level::WARNING>("Under CPU or memory pressure, shedding load",
+                            entry("CPU=%.2f", stats.cpu),
+                            entry("MEMORY=%.2f", stats.memory));
+    }
+    else if (stats.active && stats.cpu < cpuLow && stats.memory < memoryLow)
+    {
+        stats.active = false;
+        log<level::INFO>("CPU and memory pressure gone, not shedding load",
+                         entry("CPU=%.2f", stats.cpu),
+                         entry("MEMORY=%.2f", stats.memory));
+        resumeAll();
+    }
+}
+
+void schedule()
+{
+    sampleTimer->expires_after(samplePeriod);
+    sampleTimer->async_wait([](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        sample();
+        schedule();
+    });
+}
+
+} // namespace
+
+FastLane::FastLane() : held(fastLaneInUse < maxFastLane)
+{
+    if (held)
+    {
+        fastLaneInUse++;
+        stats.fastLane++;
+    }
+}
+
+FastLane::~FastLane()
+{
+    if (held)
+    {
+        fastLaneInUse--;
+    }
+}
+
+std::optional<double> parseSomeAvg10(std::string_view contents)
+{
+    constexpr std::string_view someLine = "some ";
+    constexpr std::string_view avg10 = "avg10=";
+    while (!contents.empty())
+    {
+        size_t end = contents.find('\n');
+        std::string_view line = contents.substr(0, end);
+        contents.remove_prefix(end == contents.npos ? contents.size()
+                                                    : end + 1);
+        if (line.substr(0, someLine.size()) != someLine)
+        {
+            continue;
+        }
+        size_t field = line.find(avg10);
+        if (field == line.npos)
+        {
+            return std::nullopt;
+        }
+        std::string value(line.substr(field + avg10.size()));
+        char* parsed = nullptr;
+        double percent = std::strtod(value.c_str(), &parsed);
+        if (parsed == value.c_str())
+        {
+            return std::nullopt;
+        }
+        return percent;
+    }
+    return std::nullopt;
+}
+
+Lane laneOf(NetFn netFn, Cmd cmd)
+{
+    switch (netFn)
+    {
+        case netFnApp:
+            switch (cmd)
+            {
+                // the heartbeat of most hosts
+                case app::cmdGetDeviceId:
+                case app::cmdResetWatchdogTimer:
+                case app::cmdSetWatchdogTimer:
+                case app::cmdGetWatchdogTimer:
+                case app::cmdClearMessageFlags:
+                case app::cmdGetMessageFlags:
+                case app::cmdGetMessage:
+                case app::cmdReadEventMessageBuffer:
+                    return Lane::critical;
+                default:
+                    return Lane::normal;
+            }
+        case netFnChassis:
+            switch (cmd)
+            {
+                case chassis::cmdGetChassisStatus:
+                case chassis::cmdChassisControl:
+                    return Lane::critical;
+                default:
+                    return Lane::normal;
+            }
+        case netFnSensor:
+            switch (cmd)
+            {
+                case sensor_event::cmdPlatformEvent:
+                    return Lane::critical;
+                case sensor_event::cmdGetDeviceSdr:
+                    return Lane::expensive;
+                default:
+                    return Lane::normal;
+            }
+        case netFnStorage:
+            switch (cmd)
+            {
+                case storage::cmdReadFruData:
+                case storage::cmdGetSdr:
+                case storage::cmdGetSelEntry:
+                    return Lane::expensive;
+                default:
+                    return Lane::normal;
+            }
+        default:
+            return Lane::normal;
+    }
+}
+
+bool active()
+{
+    return stats.active;
+}
+
+bool defer(boost::asio::yield_context yield,
+           std::optional<std::chrono::steady_clock::time_point> deadline)
+{
+    if (!stats.active)
+    {
+        return true;
+    }
+    if (waiters.size() >= maxDeferred)
+    {
+        stats.rejected++;
+        return false;
+    }
+
+    auto expiry = std::chrono::steady_clock::now() + maxDeferral;
+    if (deadline)
+    {
+        expiry = std::min(expiry, *deadline);
+    }
+    boost::asio::steady_timer timer(*getIoContext(), expiry);
+    Waiter waiter{&timer, false};
+    waiters.push_back(&waiter);
+    stats.deferred++;
+    boost::system::error_code ec;
+    timer.async_wait(yield[ec]);
+    if (waiter.resumed)
+    {
+        stats.resumed++;
+        return true;
+    }
+    waiters.erase(std::find(waiters.begin(), waiters.end(), &waiter));
+    stats.rejected++;
+    return false;
+}
+
+Stats getStats()
+{
+    return stats;
+}
+
+void reset()
+{
+    Stats current;
+    current.active = stats.active;
+    current.cpu = stats.cpu;
+    current.memory = stats.memory;
+    stats = current;
+}
+
+void startMonitor()
+{
+    if (!readPressure(cpuPressureFile))
+    {
+        log<level::INFO>("No CPU pressure information, not shedding load",
+                         entry("FILE=%s", cpuPressureFile));
+        return;
+    }
+    sampleTimer = std::make_unique<boost::asio::steady_timer>(*getIoContext());
+    sample();
+    schedule();
+}
+
+} // namespace pressure
+} // namespace ipmi
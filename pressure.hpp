@@ -0,0 +1,132 @@
+#pragma once
+
+#include <boost/asio/spawn.hpp>
+#include <chrono>
+#include <cstdint>
+#include <ipmid/api-types.hpp>
+#include <optional>
+#include <string_view>
+
+namespace ipmi
+{
+namespace pressure
+{
+
+/* Load shedding while the BMC is short of CPU or memory, as the kernel
+ * reports it in /proc/pressure (PSI).
+ *
+ * The share of the last 10 seconds some task stalled waiting for the CPU,
+ * or for memory, is sampled every second. Going over its high mark puts
+ * ipmid under pressure until both are back under their low marks.
+ *
+ * Under pressure the expensive read only commands a host repeats in walks
+ * wait for the pressure to go, up to a few seconds, and are answered Node
+ * Busy when they waited that long or too many of them already wait. The
+ * critical commands, those keeping the host watchdog, the host heartbeat
+ * and the messages of the host going, take a lane of their own instead of
+ * a slot of the request scheduler, so that they are not queued behind the
+ * others. Without pressure, every command is scheduled as usual. */
+
+/** @brief how often the pressure is sampled */
+constexpr std::chrono::seconds samplePeriod(1);
+
+/** @brief percent of stalled time, avg10 of the "some" line, that puts
+ *         ipmid under pressure and that it has to fall under again
+ */
+constexpr double cpuHigh = 50.0;
+constexpr double cpuLow = 25.0;
+constexpr double memoryHigh = 25.0;
+constexpr double memoryLow = 10.0;
+
+/** @brief longest wait of an expensive command, and most of them waiting */
+constexpr std::chrono::seconds maxDeferral(2);
+constexpr size_t maxDeferred = 16;
+
+/** @brief most critical commands run in their own lane at once, the ones
+ *         past it are scheduled as usual
+ */
+constexpr size_t maxFastLane = 8;
+
+enum class Lane
+{
+    critical,
+    expensive,
+    normal,
+};
+
+/** @struct Stats
+ *  @brief the pressure now and the counters of the shedding since the start
+ */
+struct Stats
+{
+    bool active = false;
+    double cpu = 0;
+    double memory = 0;
+    /** @brief times ipmid came under pressure */
+    uint64_t episodes = 0;
+    /** @brief critical commands run in their own lane */
+    uint64_t fastLane = 0;
+    /** @brief expensive commands that waited, and those run after */
+    uint64_t deferred = 0;
+    uint64_t resumed = 0;
+    /** @brief expensive commands answered Node Busy */
+    uint64_t rejected = 0;
+};
+
+/** @class FastLane
+ *  @brief a slot of the lane of the critical commands, held while in scope
+ */
+class FastLane
+{
+  public:
+    /** @brief take a slot, if one is free */
+    FastLane();
+    FastLane(const FastLane&) = delete;
+    FastLane& operator=(const FastLane&) = delete;
+    ~FastLane();
+
+    explicit operator bool() const
+    {
+        return held;
+    }
+
+  private:
+    bool held;
+};
+
+/** @brief the avg10 of the "some" line of a pressure file
+ *
+ *  @param[in] contents - the contents of /proc/pressure/cpu or memory
+ *
+ *  @return the percentage, nullopt if the contents do not have it
+ */
+std::optional<double> parseSomeAvg10(std::string_view contents);
+
+/** @brief get the lane of a command */
+Lane laneOf(NetFn netFn, Cmd cmd);
+
+/** @brief whether ipmid is under pressure */
+bool active();
+
+/** @brief wait while ipmid is under pressure, for an expensive command
+ *
+ *  @param[in] yield - the coroutine of the request
+ *  @param[in] deadline - when the requester gives up, if it says
+ *
+ *  @return false if the command has to be answered Node Busy
+ */
+bool defer(boost::asio::yield_context yield,
+           std::optional<std::chrono::steady_clock::time_point> deadline);
+
+Stats getStats();
+
+/** @brief clear the counters */
+void reset();
+
+/** @brief start sampling the pressure, nothing is shed on a kernel without
+ *         PSI
+ */
+void startMonitor();
+
+} // namespace pressure
+} // namespace ipmi
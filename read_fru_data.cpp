@@ -3,12 +3,18 @@
 #include "fruread.hpp"
 
 #include <algorithm>
+#include <boost/asio/spawn.hpp>
 #include <ipmid/api.hpp>
+#include <ipmid/dbus-signals.hpp>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
 #include <map>
+#include <memory>
 #include <phosphor-logging/elog-errors.hpp>
 #include <sdbusplus/message/types.hpp>
+#include <set>
+#include <stdexcept>
+#include <vector>
 #include <xyz/openbmc_project/Common/error.hpp>
 
 extern const FruMap frus;
@@ -20,9 +26,20 @@ namespace fru
 using namespace phosphor::logging;
 using InternalFailure =
     sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
-std::unique_ptr<sdbusplus::bus::match_t> matchPtr
+dbus_signals::Subscription propertiesChanged
     __attribute__((init_priority(101)));
 
+/** @struct FruPrefetch
+ *
+ *  Inventory data of one FRU being read by the startup prefetch.
+ */
+struct FruPrefetch
+{
+    FruInventoryData data;
+    size_t pending = 0; //!< interface reads still in flight
+    bool stale = false; //!< the FRU changed or a read failed meanwhile
+};
+
 namespace cache
 {
 // User initiate read FRU info area command followed by
@@ -31,6 +48,10 @@ namespace cache
 // Caching the data which will be invalidated when ever there
 // is a change in FRU properties.
 FRUAreaMap fruMap;
+
+// FRUs being read by the startup prefetch. Requests that arrive before it
+// finishes read the inventory themselves.
+std::map<FRUId, std::shared_ptr<FruPrefetch>> prefetching;
 } // namespace cache
 /**
  * @brief Read all the property value's for the specified interface
@@ -80,28 +101,145 @@ ipmi::PropertyMap readAllProperties(const std::string& intf,
     return properties;
 }
 
-void processFruPropChange(sdbusplus::message::message& msg)
+/**
+ * @brief Build the cached data of a FRU from its inventory data
+ *
+ * @param[in] inventory FRU properties values read from inventory
+ * @return the inventory data with its info areas and FRU area data
+ */
+FruCacheData buildFruCacheData(FruInventoryData&& inventory)
+{
+    FruCacheData fru;
+    fru.inventory = std::move(inventory);
+    for (const auto& [section, propMap] : fru.inventory)
+    {
+        FruAreaData area = buildInfoArea(section, propMap);
+        if (!area.empty())
+        {
+            fru.areas.emplace(section, std::move(area));
+        }
+    }
+    fru.data = assembleFruAreaData(fru.areas);
+    return fru;
+}
+
+/**
+ * @brief Apply changed properties of an interface to a cached FRU
+ *
+ * Only the info areas fed by the changed FRU properties are rebuilt.
+ *
+ * @param[in,out] fru cached FRU data
+ * @param[in] fruProperties FRU properties of the interface
+ * @param[in] changed changed properties and their new values
+ * @param[in] invalidated properties whose value is no longer known
+ * @return false if a new value can't be used and the FRU must be re-read
+ */
+bool updateFruCacheData(FruCacheData& fru, const DbusPropertyVec& fruProperties,
+                        const ipmi::PropertyMap& changed,
+                        const std::vector<std::string>& invalidated)
 {
-    if (cache::fruMap.empty())
+    std::set<Section> modified;
+    for (const auto& [property, fruData] : fruProperties)
+    {
+        auto iter = changed.find(std::string(property));
+        if (iter != changed.end())
+        {
+            auto value = std::get_if<std::string>(&iter->second);
+            if (value == nullptr)
+            {
+                return false;
+            }
+            auto& propMap = fru.inventory[std::string(fruData.section)];
+            auto prop = propMap.find(std::string(fruData.property));
+            if (prop != propMap.end() && prop->second == *value)
+            {
+                continue;
+            }
+            propMap[std::string(fruData.property)] = *value;
+            modified.emplace(fruData.section);
+        }
+        else if (std::find(invalidated.begin(), invalidated.end(),
+                           property) != invalidated.end())
+        {
+            // re-read the FRU to learn the new value
+            return false;
+        }
+    }
+    if (modified.empty())
+    {
+        return true;
+    }
+
+    for (const auto& section : modified)
+    {
+        FruAreaData area = buildInfoArea(section, fru.inventory[section]);
+        if (area.empty())
+        {
+            fru.areas.erase(section);
+        }
+        else
+        {
+            fru.areas[section] = std::move(area);
+        }
+    }
+    // the area offsets in the header depend on the sizes of all the areas
+    fru.data = assembleFruAreaData(fru.areas);
+    return true;
+}
+
+void processFruPropChange(const dbus_signals::PropertiesChanged& signal)
+{
+    if (cache::fruMap.empty() && cache::prefetching.empty())
     {
         return;
     }
-    std::string path = msg.get_path();
+    const std::string& objPath = signal.path;
+    std::string path = objPath;
     // trim the object base path, if found at the beginning
     if (path.compare(0, strlen(invObjPath), invObjPath) == 0)
     {
         path.erase(0, strlen(invObjPath));
     }
+
+    const std::string& intf = signal.interface;
+    // a property type we don't handle, drop the affected FRUs
+    bool incremental = signal.complete;
+
     for (const auto& [fruId, instanceList] : frus)
     {
-        auto found = std::find_if(
-            instanceList.begin(), instanceList.end(),
-            [&path](const auto& iter) { return (iter.path == path); });
-
-        if (found != instanceList.end())
+        for (const auto& instance : instanceList)
         {
-            cache::fruMap.erase(fruId);
-            break;
+            // the instance path is either relative or the full dbus path
+            if (instance.path != path && instance.path != objPath)
+            {
+                continue;
+            }
+
+            auto prefetch = cache::prefetching.find(fruId);
+            if (prefetch != cache::prefetching.end())
+            {
+                prefetch->second->stale = true;
+            }
+
+            auto fru = cache::fruMap.find(fruId);
+            if (fru == cache::fruMap.end())
+            {
+                continue;
+            }
+            if (!incremental)
+            {
+                cache::fruMap.erase(fru);
+                continue;
+            }
+            auto found = std::find_if(
+                instance.interfaces.begin(), instance.interfaces.end(),
+                [&intf](const auto& iter) { return iter.first == intf; });
+            if (found != instance.interfaces.end() &&
+                !updateFruCacheData(fru->second, found->second, signal.changed,
+                                    signal.invalidated))
+            {
+                cache::fruMap.erase(fru);
+            }
         }
     }
 }
@@ -109,19 +247,37 @@ void processFruPropChange(sdbusplus::message::message& msg)
 // register for fru property change
 int registerCallbackHandler()
 {
-    if (matchPtr == nullptr)
+    if (!propertiesChanged)
     {
-        using namespace sdbusplus::bus::match::rules;
-        sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-        matchPtr = std::make_unique<sdbusplus::bus::match_t>(
-            bus,
-            path_namespace(invObjPath) + type::signal() +
-                member("PropertiesChanged") + interface(propInterface),
-            std::bind(processFruPropChange, std::placeholders::_1));
+        propertiesChanged =
+            dbus_signals::onPropertiesChanged(invObjPath, processFruPropChange);
     }
     return 0;
 }
 
+/**
+ * @brief Add the FRU properties of an interface to the inventory data
+ *
+ * @param[in,out] data Inventory data
+ * @param[in] fruProperties FRU properties of the interface
+ * @param[in] allProp all the properties read from the interface
+ */
+void addInventoryData(FruInventoryData& data,
+                      const DbusPropertyVec& fruProperties,
+                      ipmi::PropertyMap& allProp)
+{
+    for (auto& properties : fruProperties)
+    {
+        auto iter = allProp.find(std::string(properties.first));
+        if (iter != allProp.end())
+        {
+            data[std::string(properties.second.section)].emplace(
+                properties.second.property,
+                std::move(std::get<std::string>(iter->second)));
+        }
+    }
+}
+
 /**
  * @brief Read FRU property values from Inventory
  *
@@ -144,18 +300,9 @@ FruInventoryData readDataFromInventory(const FRUId& fruNum)
         for (auto& intf : instance.interfaces)
         {
             ipmi::PropertyMap allProp =
-                readAllProperties(intf.first, instance.path);
-            for (auto& properties : intf.second)
-            {
-                auto iter = allProp.find(properties.first);
-                if (iter != allProp.end())
-                {
-                    data[properties.second.section].emplace(
-                        properties.second.property,
-                        std::move(
-                            std::get<std::string>(allProp[properties.first])));
-                }
-            }
+                readAllProperties(std::string(intf.first),
+                                  std::string(instance.path));
+            addInventoryData(data, intf.second, allProp);
         }
     }
     return data;
@@ -166,14 +313,151 @@ const FruAreaData& getFruAreaData(const FRUId& fruNum)
     auto iter = cache::fruMap.find(fruNum);
     if (iter != cache::fruMap.end())
     {
-        return iter->second;
+        return iter->second.data;
     }
     auto invData = readDataFromInventory(fruNum);
 
     // Build area info based on inventory data
-    FruAreaData newdata = buildFruAreaData(std::move(invData));
-    cache::fruMap.emplace(fruNum, std::move(newdata));
-    return cache::fruMap.at(fruNum);
+    auto newdata = buildFruCacheData(std::move(invData));
+    return cache::fruMap.emplace(fruNum, std::move(newdata)).first->second.data;
+}
+
+/**
+ * @brief Store the prefetched area data of a FRU once all reads are done
+ *
+ * @param[in] fruNum FRU id
+ * @param[in] prefetch the prefetch state of the FRU
+ */
+void finishPrefetch(FRUId fruNum, const std::shared_ptr<FruPrefetch>& prefetch)
+{
+    auto iter = cache::prefetching.find(fruNum);
+    if (iter != cache::prefetching.end() && iter->second == prefetch)
+    {
+        cache::prefetching.erase(iter);
+    }
+    if (prefetch->stale)
+    {
+        // leave it to the next request to read it again
+        return;
+    }
+    try
+    {
+        // keep the data of a request that already read the FRU
+        cache::fruMap.emplace(fruNum,
+                              buildFruCacheData(std::move(prefetch->data)));
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Error in building prefetched FRU area data",
+                        entry("FRUID=%d", fruNum),
+                        entry("EXCEPTION=%s", e.what()));
+    }
+}
+
+/**
+ * @brief Read the properties of one FRU interface without blocking
+ *
+ * @param[in] fruNum FRU id
+ * @param[in] prefetch the prefetch state of the FRU
+ * @param[in] path FRU instance path
+ * @param[in] intf interface and its FRU properties
+ */
+void prefetchInterface(FRUId fruNum, std::shared_ptr<FruPrefetch> prefetch,
+                       const FruInstancePath& path,
+                       const DbusInterfaceVec::value_type& intf)
+{
+    boost::asio::spawn(*getIoContext(), [fruNum, prefetch, &path,
+                                         &intf](boost::asio::yield_context
+                                                    yield) {
+        std::shared_ptr<sdbusplus::asio::connection> bus = getSdBus();
+        std::string fruIntf(intf.first);
+        std::string objPath(path);
+        std::string servicePath(path);
+        std::string serviceIntf = fruIntf;
+
+        // Is the path the full dbus path?
+        if (path.find(xyzPrefix) == std::string::npos)
+        {
+            objPath = invObjPath + objPath;
+            servicePath = invObjPath;
+            serviceIntf = invMgrInterface;
+        }
+
+        try
+        {
+            boost::system::error_code ec;
+            auto services = bus->yield_method_call<
+                std::map<std::string, std::vector<std::string>>>(
+                yield, ec, "xyz.openbmc_project.ObjectMapper",
+                "/xyz/openbmc_project/object_mapper",
+                "xyz.openbmc_project.ObjectMapper", "GetObject", servicePath,
+                std::vector<std::string>({serviceIntf}));
+            if (ec || services.empty())
+            {
+                throw std::runtime_error("ERROR in mapper call");
+            }
+
+            ipmi::PropertyMap allProp = bus->yield_method_call<
+                ipmi::PropertyMap>(yield, ec, services.begin()->first,
+                                   objPath, propInterface, "GetAll",
+                                   fruIntf);
+            if (ec)
+            {
+                // If property is not found simply return empty value
+                log<level::ERR>("Error in reading property values",
+                                entry("EXCEPTION=%s", ec.message().c_str()),
+                                entry("INTERFACE=%s", fruIntf.c_str()),
+                                entry("PATH=%s", objPath.c_str()));
+                allProp.clear();
+            }
+            addInventoryData(prefetch->data, intf.second, allProp);
+        }
+        catch (const std::exception& e)
+        {
+            log<level::ERR>("Error in prefetching FRU properties",
+                            entry("FRUID=%d", fruNum),
+                            entry("EXCEPTION=%s", e.what()));
+            prefetch->stale = true;
+        }
+
+        if (--prefetch->pending == 0)
+        {
+            finishPrefetch(fruNum, prefetch);
+        }
+    });
+}
+
+void prefetchFruAreaData()
+{
+    for (const auto& [fruId, instanceList] : frus)
+    {
+        FRUId fruNum = static_cast<FRUId>(fruId);
+        if (cache::fruMap.find(fruNum) != cache::fruMap.end() ||
+            cache::prefetching.find(fruNum) != cache::prefetching.end())
+        {
+            continue;
+        }
+
+        auto prefetch = std::make_shared<FruPrefetch>();
+        for (const auto& instance : instanceList)
+        {
+            prefetch->pending += instance.interfaces.size();
+        }
+        if (prefetch->pending == 0)
+        {
+            continue;
+        }
+        cache::prefetching.emplace(fruNum, prefetch);
+
+        // all the reads are issued at once and complete in any order
+        for (const auto& instance : instanceList)
+        {
+            for (const auto& intf : instance.interfaces)
+            {
+                prefetchInterface(fruNum, prefetch, instance.path, intf);
+            }
+        }
+    }
 }
 } // namespace fru
 } // namespace ipmi
@@ -9,7 +9,21 @@ namespace ipmi
 namespace fru
 {
 using FRUId = uint8_t;
-using FRUAreaMap = std::map<FRUId, FruAreaData>;
+
+/** @struct FruCacheData
+ *
+ *  Cached FRU area data of a FRU together with the inventory data and the
+ *  info areas it was built from, so that a property change rebuilds only the
+ *  info area the property feeds.
+ */
+struct FruCacheData
+{
+    FruInventoryData inventory;
+    FruAreas areas;
+    FruAreaData data;
+};
+
+using FRUAreaMap = std::map<FRUId, FruCacheData>;
 
 static constexpr auto xyzPrefix = "/xyz/openbmc_project/";
 static constexpr auto invMgrInterface = "xyz.openbmc_project.Inventory.Manager";
@@ -31,5 +45,13 @@ const FruAreaData& getFruAreaData(const FRUId& fruNum);
  * @return negative value on failure
  */
 int registerCallbackHandler();
+
+/**
+ * @brief Start reading the inventory data of all the FRUs in the background
+ *
+ * The property reads are issued as concurrent asynchronous calls. Requests
+ * for a FRU that is not fetched yet read it directly.
+ */
+void prefetchFruAreaData();
 } // namespace fru
 } // namespace ipmi
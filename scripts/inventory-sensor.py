@@ -7,7 +7,7 @@ import argparse
 from mako.template import Template
 
 
-def generate_cpp(sensor_yaml, output_dir):
+def generate_cpp(sensor_yaml, output_dir, static_table):
     with open(sensor_yaml, 'r') as f:
         ifile = yaml.safe_load(f)
         if not isinstance(ifile, dict):
@@ -21,7 +21,7 @@ def generate_cpp(sensor_yaml, output_dir):
 
         output_cpp = os.path.join(output_dir, "inventory-sensor-gen.cpp")
         with open(output_cpp, 'w') as fd:
-            fd.write(t.render(sensorDict=ifile))
+            fd.write(t.render(sensorDict=ifile, staticTable=static_table))
 
 
 def main():
@@ -41,6 +41,10 @@ def main():
         default=".",
         help="output directory")
 
+    parser.add_argument(
+        "--static-table", dest="static_table", action="store_true",
+        help="generate a constexpr table instead of a std::map")
+
     parser.add_argument(
         'command', metavar='COMMAND', type=str,
         choices=valid_commands.keys(),
@@ -52,7 +56,7 @@ def main():
         sys.exit("Can not find input yaml file " + args.sensor_yaml)
 
     function = valid_commands[args.command]
-    function(args.sensor_yaml, args.outputdir)
+    function(args.sensor_yaml, args.outputdir, args.static_table)
 
 
 if __name__ == '__main__':
@@ -2,10 +2,53 @@
 ## into the rendered file; feel free to edit this file.
 
 // !!! WARNING: This is a GENERATED Code..Please do NOT Edit !!!
+<%!
+from stringpool import StringPool
+%>\
+
+#include "sensortable.hpp"
 
 #include <ipmid/types.hpp>
 using namespace ipmi::sensor;
 
+% if staticTable:
+<%
+    # sorted the way std::string_view compares
+    keys = sorted((k for k in sensorDict.keys() if k),
+                  key=lambda k: k.encode())
+    pool = StringPool()
+    for key in keys:
+        pool.add(key)
+%>\
+namespace
+{
+
+constexpr char invSensorStrings[] =
+% for literal in pool.literals():
+    ${literal}
+% endfor
+    ;
+
+% if keys:
+constexpr InvSensorMap::value_type invSensorTable[] = {
+    % for key in keys:
+<%
+       objectPath = sensorDict[key]
+%>\
+    {std::string_view(invSensorStrings + ${pool.ref(key)}),
+     {${objectPath["sensorID"]}, ${objectPath["sensorType"]}, ${objectPath["eventReadingType"]}, ${objectPath["offset"]}}},
+    % endfor
+};
+% endif
+
+} // namespace
+
+% if keys:
+extern const InvSensorMap invSensors(invSensorTable);
+% else:
+extern const InvSensorMap invSensors{};
+% endif
+% else:
 extern const InvObjectIDMap invSensors = {
 % for key in sensorDict.keys():
    % if key:
@@ -24,4 +67,4 @@ extern const InvObjectIDMap invSensors = {
    % endif
 % endfor
 };
-
+% endif
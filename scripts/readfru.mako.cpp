@@ -1,7 +1,100 @@
 // !!! WARNING: This is a GENERATED Code..Please do NOT Edit !!!
+<%!
+from stringpool import StringPool
+
+def tableName(*parts):
+    return "fru" + "_".join(str(part) for part in parts)
+
+def fruDelimiter(property_value):
+    delimiter = property_value.get("IPMIFruValueDelimiter")
+    return chr(delimiter) if delimiter else ""
+%>\
 #include <iostream>
 #include "fruread.hpp"
 
+% if staticTable:
+<%
+    pool = StringPool()
+    for key in fruDict.keys():
+        for instancePath,instanceInfo in fruDict[key].items():
+            pool.add(instancePath)
+            for interface,properties in instanceInfo["interfaces"].items():
+                pool.add(interface)
+                for dbus_property,property_value in (properties or {}).items():
+                    pool.add(dbus_property)
+                    pool.add(property_value.get("IPMIFruSection", ""))
+                    pool.add(property_value.get("IPMIFruProperty", ""))
+                    pool.add(fruDelimiter(property_value))
+%>\
+namespace
+{
+
+constexpr char fruStrings[] =
+% for literal in pool.literals():
+    ${literal}
+% endfor
+    ;
+
+constexpr FruString fruString(size_t offset, size_t size)
+{
+    return FruString(fruStrings + offset, size);
+}
+
+% for key in sorted(fruDict.keys()):
+<%
+    instances = list(fruDict[key].items())
+%>\
+    % for i,(instancePath,instanceInfo) in enumerate(instances):
+<%
+        interfaces = list(instanceInfo["interfaces"].items())
+%>\
+        % for j,(interface,properties) in enumerate(interfaces):
+            % if properties:
+constexpr std::pair<DbusProperty, IPMIFruData> ${tableName(key, i, j)}[] = {
+                % for dbus_property,property_value in properties.items():
+    {fruString(${pool.ref(dbus_property)}),
+     {fruString(${pool.ref(property_value.get("IPMIFruSection", ""))}),
+      fruString(${pool.ref(property_value.get("IPMIFruProperty", ""))}),
+      fruString(${pool.ref(fruDelimiter(property_value))})}},
+                % endfor
+};
+
+            % endif
+        % endfor
+        % if interfaces:
+constexpr std::pair<DbusInterface, DbusPropertyVec> ${tableName(key, i)}[] = {
+            % for j,(interface,properties) in enumerate(interfaces):
+    {fruString(${pool.ref(interface)}), ${tableName(key, i, j) if properties else "{}"}},
+            % endfor
+};
+
+        % endif
+    % endfor
+constexpr FruInstance ${tableName(key)}[] = {
+    % for i,(instancePath,instanceInfo) in enumerate(instances):
+    {${instanceInfo["entityID"]}, ${instanceInfo["entityInstance"]},
+     fruString(${pool.ref(instancePath)}),
+     ${tableName(key, i) if instanceInfo["interfaces"] else "{}"}},
+    % endfor
+};
+
+% endfor
+% if fruDict:
+constexpr FruMap::value_type fruTable[] = {
+    % for key in sorted(fruDict.keys()):
+    {${key}, ${tableName(key)}},
+    % endfor
+};
+% endif
+
+} // namespace
+
+% if fruDict:
+extern const FruMap frus(fruTable);
+% else:
+extern const FruMap frus{};
+% endif
+% else:
 extern const FruMap frus = {
 % for key in fruDict.keys():
    {${key},{
@@ -40,3 +133,4 @@ extern const FruMap frus = {
    }},
 % endfor
 };
+% endif
@@ -0,0 +1,44 @@
+"""String pool of the constexpr tables the YAML generators emit."""
+
+
+def c_string(value):
+    """Return value escaped for a C++ string literal."""
+    out = ""
+    for byte in value.encode():
+        if byte in b'"\\':
+            out += "\\" + chr(byte)
+        elif 32 <= byte < 127:
+            out += chr(byte)
+        else:
+            out += "\\%03o" % byte
+    return out
+
+
+class StringPool:
+    """Interns strings into one character array.
+
+    Every distinct string is stored once, the tables refer to it by offset
+    and size.
+    """
+
+    def __init__(self):
+        self.strings = []
+        self.offsets = {}
+        self.size = 0
+
+    def add(self, value):
+        value = str(value)
+        if value not in self.offsets:
+            self.offsets[value] = self.size
+            self.strings.append(value)
+            self.size += len(value.encode())
+        return value
+
+    def ref(self, value):
+        """Return the offset and size of value as "offset, size"."""
+        value = self.add(value)
+        return "%d, %d" % (self.offsets[value], len(value.encode()))
+
+    def literals(self):
+        """Return the pool as C++ string literals, one per string."""
+        return ['"%s"' % c_string(value) for value in self.strings] or ['""']
@@ -1,9 +1,64 @@
 ## This file is a template.  The comment below is emitted
 ## into the rendered file; feel free to edit this file.
 // !!! WARNING: This is a GENERATED Code..Please do NOT Edit !!!
+<%!
+sensorNameMaxLength = 16
+
+def sensorInfo(sensor, interfaceDict):
+    interfaces = sensor["interfaces"]
+    serviceInterface = sensor["serviceInterface"]
+    valueReadingType = sensor["readingType"]
+    updateFunc = interfaceDict[serviceInterface]["updateFunc"]
+    updateFunc += valueReadingType
+    getFunc = interfaceDict[serviceInterface]["getFunc"]
+    getFunc += valueReadingType
+    sensorName = sensor.get("sensorName", None)
+    sensorNameFunc = None
+    if sensorName:
+        assert len(sensorName) <= sensorNameMaxLength, \
+                "sensor name '%s' is too long (%d bytes max)" % \
+                (sensorName, sensorNameMaxLength)
+    else:
+        sensorNameFunc = "get::" + sensor.get("sensorNamePattern",
+                "nameLeaf")
+
+    if "readingAssertion" == valueReadingType or "readingData" == valueReadingType:
+        for interface,properties in interfaces.items():
+            for dbus_property,property_value in properties.items():
+                for offset,values in property_value["Offsets"].items():
+                    valueType = values["type"]
+        updateFunc = "set::" + valueReadingType + "<" + valueType + ">"
+        getFunc = "get::" + valueReadingType + "<" + valueType + ">"
+    sensorInterface = serviceInterface
+    if serviceInterface == "org.freedesktop.DBus.Properties":
+        sensorInterface = next(iter(interfaces))
+    offsetB = sensor.get("offsetB", 0)
+    bExp = sensor.get("bExp", 0)
+    return {
+        "interfaces": interfaces,
+        "path": sensor["path"],
+        "sensorType": sensor["sensorType"],
+        "entityID": sensor.get("entityID", 0),
+        "instance": sensor.get("entityInstance", 0),
+        "readingType": sensor["sensorReadingType"],
+        "multiplier": sensor.get("multiplierM", 1),
+        "offsetB": offsetB,
+        "bExp": bExp,
+        "scaledOffset": offsetB * pow(10,bExp),
+        "rExp": sensor.get("rExp", 0),
+        "unit": sensor.get("unit", ""),
+        "scale": sensor.get("scale", 0),
+        "hasScale": "true" if "scale" in sensor.keys() else "false",
+        "updateFunc": updateFunc,
+        "getFunc": getFunc,
+        "sensorName": sensorName,
+        "sensorNameFunc": sensorNameFunc,
+        "sensorInterface": sensorInterface,
+        "mutability": sensor.get("mutability", "Mutability::Read"),
+    }
+%>\
 <%
 interfaceDict = {}
-sensorNameMaxLength = 16
 %>\
 %for key in sensorDict.keys():
 <%
@@ -26,81 +81,15 @@ sensorNameMaxLength = 16
 % endfor
 
 #include "sensordatahandler.hpp"
+#include "sensortable.hpp"
 
 #include <ipmid/types.hpp>
 
 namespace ipmi {
 namespace sensor {
 
-extern const IdInfoMap sensors = {
-% for key in sensorDict.keys():
-   % if key:
-{${key},{
-<%
-       sensor = sensorDict[key]
-       interfaces = sensor["interfaces"]
-       path = sensor["path"]
-       serviceInterface = sensor["serviceInterface"]
-       sensorType = sensor["sensorType"]
-       entityID = sensor.get("entityID", 0)
-       instance = sensor.get("entityInstance", 0)
-       readingType = sensor["sensorReadingType"]
-       multiplier = sensor.get("multiplierM", 1)
-       offsetB = sensor.get("offsetB", 0)
-       bExp = sensor.get("bExp", 0)
-       rExp = sensor.get("rExp", 0)
-       unit = sensor.get("unit", "")
-       scale = sensor.get("scale", 0)
-       hasScale = "true" if "scale" in sensor.keys() else "false"
-       valueReadingType = sensor["readingType"]
-       updateFunc = interfaceDict[serviceInterface]["updateFunc"]
-       updateFunc += sensor["readingType"]
-       getFunc = interfaceDict[serviceInterface]["getFunc"]
-       getFunc += sensor["readingType"]
-       sensorName = sensor.get("sensorName", None)
-       if sensorName:
-           assert len(sensorName) <= sensorNameMaxLength, \
-                   "sensor name '%s' is too long (%d bytes max)" % \
-                   (sensorName, sensorNameMaxLength)
-       else:
-           sensorNameFunc = "get::" + sensor.get("sensorNamePattern",
-                   "nameLeaf")
-
-       if "readingAssertion" == valueReadingType or "readingData" == valueReadingType:
-           for interface,properties in interfaces.items():
-               for dbus_property,property_value in properties.items():
-                   for offset,values in property_value["Offsets"].items():
-                       valueType = values["type"]
-           updateFunc = "set::" + valueReadingType + "<" + valueType + ">"
-           getFunc = "get::" + valueReadingType + "<" + valueType + ">"
-       sensorInterface = serviceInterface
-       if serviceInterface == "org.freedesktop.DBus.Properties":
-           sensorInterface = next(iter(interfaces))
-       mutability = sensor.get("mutability", "Mutability::Read")
-%>
-        .entityType = ${entityID},
-        .instance = ${instance},
-        .sensorType = ${sensorType},
-        .sensorPath = "${path}",
-        .sensorInterface = "${sensorInterface}",
-        .sensorReadingType = ${readingType},
-        .coefficientM = ${multiplier},
-        .coefficientB = ${offsetB},
-        .exponentB = ${bExp},
-        .scaledOffset = ${offsetB * pow(10,bExp)},
-        .exponentR = ${rExp},
-        .hasScale = ${hasScale},
-        .scale = ${scale},
-        .unit = "${unit}",
-        .updateFunc = ${updateFunc},
-        .getFunc = ${getFunc},
-        .mutability = Mutability(${mutability}),
-    % if sensorName:
-        .sensorName = "${sensorName}",
-    % else:
-        .sensorNameFunc = ${sensorNameFunc},
-    % endif
-        .propertyInterfaces = {
+<%def name="propertyInterfaces(interfaces)">\
+{
     % for interface,properties in interfaces.items():
             {"${interface}",{
             % if properties:
@@ -168,11 +157,98 @@ except KeyError:
             % endif
             }},
     % endfor
-     },
+     }\
+</%def>\
+% if staticTable:
+namespace
+{
+
+% for key in sorted(k for k in sensorDict.keys() if k):
+DbusInterfaceMap interfaces${key}()
+{
+    return ${propertyInterfaces(sensorDict[key]["interfaces"])};
+}
+
+% endfor
+constexpr std::array<StaticInfo, ${len([k for k in sensorDict.keys() if k])}> infos = {{
+% for key in sorted(k for k in sensorDict.keys() if k):
+<%
+    info = sensorInfo(sensorDict[key], interfaceDict)
+%>\
+    {
+        .id = ${key},
+        .entityType = ${info["entityID"]},
+        .instance = ${info["instance"]},
+        .sensorType = ${info["sensorType"]},
+        .sensorPath = "${info["path"]}",
+        .sensorInterface = "${info["sensorInterface"]}",
+        .sensorReadingType = ${info["readingType"]},
+        .coefficientM = ${info["multiplier"]},
+        .coefficientB = ${info["offsetB"]},
+        .exponentB = ${info["bExp"]},
+        .scaledOffset = ${info["scaledOffset"]},
+        .exponentR = ${info["rExp"]},
+        .hasScale = ${info["hasScale"]},
+        .scale = ${info["scale"]},
+        .unit = "${info["unit"]}",
+        .updateFunc = ${info["updateFunc"]},
+        .getFunc = ${info["getFunc"]},
+        .mutability = Mutability(${info["mutability"]}),
+    % if info["sensorName"]:
+        .sensorName = "${info["sensorName"]}",
+        .sensorNameFunc = nullptr,
+    % else:
+        .sensorName = "",
+        .sensorNameFunc = ${info["sensorNameFunc"]},
+    % endif
+        .propertyInterfaces = interfaces${key},
+    },
+% endfor
+}};
+
+constexpr auto index = SensorTable::makeIndex(infos);
+std::array<std::optional<SensorTable::value_type>, infos.size()> cache;
+
+} // namespace
+
+extern const SensorTable sensors(infos.data(), infos.size(), index,
+                                 cache.data());
+% else:
+extern const IdInfoMap sensors = {
+% for key in sensorDict.keys():
+   % if key:
+{${key},{
+<%
+       info = sensorInfo(sensorDict[key], interfaceDict)
+%>
+        .entityType = ${info["entityID"]},
+        .instance = ${info["instance"]},
+        .sensorType = ${info["sensorType"]},
+        .sensorPath = "${info["path"]}",
+        .sensorInterface = "${info["sensorInterface"]}",
+        .sensorReadingType = ${info["readingType"]},
+        .coefficientM = ${info["multiplier"]},
+        .coefficientB = ${info["offsetB"]},
+        .exponentB = ${info["bExp"]},
+        .scaledOffset = ${info["scaledOffset"]},
+        .exponentR = ${info["rExp"]},
+        .hasScale = ${info["hasScale"]},
+        .scale = ${info["scale"]},
+        .unit = "${info["unit"]}",
+        .updateFunc = ${info["updateFunc"]},
+        .getFunc = ${info["getFunc"]},
+        .mutability = Mutability(${info["mutability"]}),
+    % if info["sensorName"]:
+        .sensorName = "${info["sensorName"]}",
+    % else:
+        .sensorNameFunc = ${info["sensorNameFunc"]},
+    % endif
+        .propertyInterfaces = ${propertyInterfaces(info["interfaces"])},
 }},
    % endif
 % endfor
 };
+% endif
 
 } // namespace sensor
 } // namespace ipmi
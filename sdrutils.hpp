@@ -15,6 +15,7 @@
 */
 
 #include "sensorhandler.hpp"
+#include "sensortable.hpp"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/container/flat_map.hpp>
@@ -28,7 +29,7 @@ namespace ipmi
 {
 namespace sensor
 {
-extern const IdInfoMap sensors;
+extern const SensorMap sensors;
 } // namespace sensor
 } // namespace ipmi
 
@@ -159,19 +160,13 @@ inline static uint8_t getSensorEventTypeFromPath(const std::string& path)
 
 inline static std::string getPathFromSensorNumber(uint8_t sensorNum)
 {
-    std::string path;
-
     // Refer to sensor.yaml
-    for (auto sensor = ipmi::sensor::sensors.begin();
-         sensor != ipmi::sensor::sensors.end(); sensor++)
+    auto sensor = ipmi::sensor::sensors.find(sensorNum);
+    if (sensor == ipmi::sensor::sensors.end())
     {
-        if (sensor->first == sensorNum)
-        {
-            path = sensor->second.sensorPath;
-            break;
-        }
+        return std::string();
     }
 
-    return path;
+    return sensor->second.sensorPath;
 }
 #endif // JOURNAL_SEL
@@ -0,0 +1,356 @@
+#include "selindex.hpp"
+
+#include "selutility.hpp"
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/algorithm/string.hpp>
+#include <charconv>
+#include <ctime>
+#include <iomanip>
+#include <phosphor-logging/log.hpp>
+#include <sstream>
+#include <string_view>
+
+namespace ipmi
+{
+
+namespace sel
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+/** @brief parse the record ID and timestamp of an ipmi_sel line
+ *
+ *  The format of the ipmi_sel message is "<Timestamp>
+ *  <ID>,<Type>,<EventData>,[<Generator ID>,<Path>,<Direction>]".
+ */
+bool parseLine(std::string_view line, uint16_t& recordID, uint32_t& timestamp)
+{
+    size_t space = line.find_first_of(' ');
+    if (space == std::string_view::npos)
+    {
+        return false;
+    }
+    size_t idStart = line.find_first_not_of(' ', space);
+    if (idStart == std::string_view::npos)
+    {
+        return false;
+    }
+    size_t idEnd = line.find_first_of(',', idStart);
+    if (idEnd == std::string_view::npos)
+    {
+        return false;
+    }
+    auto [ptr, ec] =
+        std::from_chars(line.data() + idStart, line.data() + idEnd, recordID);
+    if (ec != std::errc() || ptr != line.data() + idEnd)
+    {
+        return false;
+    }
+
+    std::tm timeStruct = {};
+    std::istringstream entryStream(std::string(line.substr(0, space)));
+    timestamp = invalidTimeStamp;
+    if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
+    {
+        timestamp = std::mktime(&timeStruct);
+    }
+    return true;
+}
+
+} // namespace
+
+LogIndex::LogIndex(const std::filesystem::path& dir,
+                   const std::string& basename, Decoder decoder) :
+    dir(dir),
+    basename(basename), decoder(std::move(decoder)), lastAdd(invalidTimeStamp)
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        log<level::ERR>("Failed to create SEL inotify instance",
+                        entry("ERRNO=%d", errno));
+        return;
+    }
+    // rotation renames the files, clearing removes them and rsyslog creates
+    // the new one; appends to the newest file are checked on every access
+    if (inotify_add_watch(inotifyFd, dir.c_str(),
+                          IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                              IN_MOVED_TO) < 0)
+    {
+        log<level::ERR>("Failed to watch SEL log directory",
+                        entry("DIR=%s", dir.c_str()),
+                        entry("ERRNO=%d", errno));
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+}
+
+LogIndex::~LogIndex()
+{
+    closeFiles();
+    if (inotifyFd >= 0)
+    {
+        close(inotifyFd);
+    }
+}
+
+bool LogIndex::read(uint16_t recordID, std::string& line)
+{
+    update();
+    if (entries.empty())
+    {
+        return false;
+    }
+    if (recordID == firstEntry)
+    {
+        return readEntry(entries.front(), line);
+    }
+    if (recordID == lastEntry)
+    {
+        return readEntry(entries.back(), line);
+    }
+    auto it = recordIndex.find(recordID);
+    if (it == recordIndex.end())
+    {
+        return false;
+    }
+    return readEntry(entries[it->second], line);
+}
+
+bool LogIndex::readRecord(uint16_t recordID, std::optional<Record>& record)
+{
+    update();
+    if (entries.empty())
+    {
+        return false;
+    }
+    size_t index;
+    if (recordID == firstEntry)
+    {
+        index = 0;
+    }
+    else if (recordID == lastEntry)
+    {
+        index = entries.size() - 1;
+    }
+    else
+    {
+        auto it = recordIndex.find(recordID);
+        if (it == recordIndex.end())
+        {
+            return false;
+        }
+        index = it->second;
+    }
+    record = index < records.size() ? records[index] : std::nullopt;
+    return true;
+}
+
+uint16_t LogIndex::nextRecordID(uint16_t recordID)
+{
+    update();
+    uint16_t nextRecordID = recordID + 1;
+    if (recordIndex.find(nextRecordID) != recordIndex.end())
+    {
+        return nextRecordID;
+    }
+    return lastEntry;
+}
+
+uint16_t LogIndex::lastRecordID()
+{
+    update();
+    return entries.empty() ? 0 : entries.back().recordID;
+}
+
+size_t LogIndex::count()
+{
+    update();
+    return entries.size();
+}
+
+uint32_t LogIndex::lastAddTime()
+{
+    update();
+    return lastAdd;
+}
+
+void LogIndex::append()
+{
+    update();
+}
+
+void LogIndex::reset()
+{
+    closeFiles();
+    entries.clear();
+    records.clear();
+    recordIndex.clear();
+    lastAdd = invalidTimeStamp;
+    valid = false;
+}
+
+void LogIndex::update()
+{
+    if (inotifyFd < 0)
+    {
+        // without the watch a rotation can't be detected, so always rebuild
+        valid = false;
+    }
+    else
+    {
+        alignas(inotify_event) std::array<char, 4096> events;
+        ssize_t size;
+        while ((size = ::read(inotifyFd, events.data(), events.size())) > 0)
+        {
+            for (ssize_t pos = 0; pos < size;)
+            {
+                auto event = reinterpret_cast<const inotify_event*>(
+                    events.data() + pos);
+                std::string_view name(event->len ? event->name : "");
+                if ((event->mask & IN_Q_OVERFLOW) ||
+                    boost::starts_with(name, basename))
+                {
+                    valid = false;
+                }
+                pos += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    if (valid && !files.empty())
+    {
+        // pick up the lines appended to the newest file since the last access
+        scan(files.size() - 1);
+    }
+    if (!valid)
+    {
+        build();
+    }
+}
+
+void LogIndex::build()
+{
+    reset();
+
+    std::vector<std::filesystem::path> paths;
+    std::error_code ec;
+    for (const auto& dirEnt : std::filesystem::directory_iterator(dir, ec))
+    {
+        std::string filename = dirEnt.path().filename();
+        if (boost::starts_with(filename, basename))
+        {
+            paths.emplace_back(dirEnt.path());
+        }
+    }
+    // As the log files rotate, they are appended with a ".#" that is higher
+    // for the older logs, so the reverse sorted list is oldest to newest
+    std::sort(paths.rbegin(), paths.rend());
+
+    for (const auto& path : paths)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+        files.push_back({path, fd, 0});
+        scan(files.size() - 1);
+    }
+    valid = true;
+}
+
+void LogIndex::scan(size_t file)
+{
+    File& f = files[file];
+    struct stat st;
+    if (fstat(f.fd, &st) < 0 || st.st_size < f.indexed)
+    {
+        // the file was truncated underneath us
+        valid = false;
+        return;
+    }
+    if (file == files.size() - 1)
+    {
+        lastAdd = st.st_mtime;
+    }
+
+    std::array<char, 4096> buffer;
+    std::string line;
+    off_t pos = f.indexed;
+    off_t lineStart = pos;
+    while (pos < st.st_size)
+    {
+        size_t toRead = std::min<off_t>(buffer.size(), st.st_size - pos);
+        ssize_t size = pread(f.fd, buffer.data(), toRead, pos);
+        if (size <= 0)
+        {
+            break;
+        }
+        for (ssize_t i = 0; i < size; i++)
+        {
+            if (buffer[i] != '\n')
+            {
+                line.push_back(buffer[i]);
+                continue;
+            }
+            uint16_t recordID;
+            uint32_t timestamp;
+            if (parseLine(line, recordID, timestamp))
+            {
+                recordIndex[recordID] = entries.size();
+                entries.push_back({recordID, file, lineStart,
+                                   static_cast<uint32_t>(line.size()),
+                                   timestamp});
+                if (decoder)
+                {
+                    Record record;
+                    if (decoder(line, record))
+                    {
+                        records.emplace_back(record);
+                    }
+                    else
+                    {
+                        records.emplace_back(std::nullopt);
+                    }
+                }
+            }
+            line.clear();
+            lineStart = pos + i + 1;
+        }
+        pos += size;
+    }
+    // a partially written last line is indexed on a later access
+    f.indexed = lineStart;
+}
+
+void LogIndex::closeFiles()
+{
+    for (const File& f : files)
+    {
+        close(f.fd);
+    }
+    files.clear();
+}
+
+bool LogIndex::readEntry(const Entry& entry, std::string& line) const
+{
+    line.resize(entry.length);
+    ssize_t size =
+        pread(files[entry.file].fd, line.data(), entry.length, entry.offset);
+    return size == static_cast<ssize_t>(entry.length);
+}
+
+} // namespace sel
+
+} // namespace ipmi
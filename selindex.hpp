@@ -0,0 +1,141 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ipmi
+{
+
+namespace sel
+{
+
+/** @class LogIndex
+ *
+ *  Index of the records in the rsyslog written ipmi_sel text log and its
+ *  rotated copies. Each record ID maps to the file, byte offset and length
+ *  of its line, so a record is read back with a single pread.
+ *
+ *  When a decoder is given, every line is also decoded into a raw 16-byte
+ *  SEL record as it is indexed, so a record is read back without touching
+ *  the file or parsing the line again.
+ *
+ *  The index is built on first use. Lines appended to the newest file are
+ *  picked up incrementally, and the index is rebuilt from scratch when an
+ *  inotify watch on the log directory reports that the files were rotated,
+ *  removed or truncated.
+ */
+class LogIndex
+{
+  public:
+    struct Entry
+    {
+        uint16_t recordID;
+        size_t file;      //!< index into the list of log files
+        off_t offset;     //!< byte offset of the line in the file
+        uint32_t length;  //!< length of the line without the newline
+        uint32_t timestamp;
+    };
+
+    using Record = std::array<uint8_t, 16>;
+    /** @brief decodes a log line into a SEL record, false if it can't */
+    using Decoder = std::function<bool(std::string_view line, Record& record)>;
+
+    LogIndex(const std::filesystem::path& dir, const std::string& basename,
+             Decoder decoder = {});
+    ~LogIndex();
+
+    LogIndex(const LogIndex&) = delete;
+    LogIndex& operator=(const LogIndex&) = delete;
+
+    /** @brief read the line of a SEL record
+     *
+     *  @param[in] recordID - record ID, firstEntry and lastEntry are the
+     *                        oldest and the newest record
+     *  @param[out] line - the log line of the record
+     *
+     *  @return true if the record was found
+     */
+    bool read(uint16_t recordID, std::string& line);
+
+    /** @brief read the decoded SEL record of a line
+     *
+     *  @param[in] recordID - record ID, firstEntry and lastEntry are the
+     *                        oldest and the newest record
+     *  @param[out] record - the record, empty if the decoder rejected the
+     *                       line or there is no decoder
+     *
+     *  @return true if the record was found
+     */
+    bool readRecord(uint16_t recordID, std::optional<Record>& record);
+
+    /** @brief get the record ID following a record
+     *
+     *  @param[in] recordID - record ID
+     *
+     *  @return recordID + 1 if that record exists, lastEntry otherwise
+     */
+    uint16_t nextRecordID(uint16_t recordID);
+
+    /** @brief get the record ID of the newest record
+     *
+     *  @return the record ID, 0 if the SEL is empty
+     */
+    uint16_t lastRecordID();
+
+    /** @brief get the number of records in the SEL */
+    size_t count();
+
+    /** @brief get the time the newest log file was last written
+     *
+     *  @return the timestamp, invalidTimeStamp if there is no log file
+     */
+    uint32_t lastAddTime();
+
+    /** @brief pick up lines appended to the newest log file */
+    void append();
+
+    /** @brief drop the index, it is rebuilt on next use */
+    void reset();
+
+  private:
+    struct File
+    {
+        std::filesystem::path path;
+        int fd;
+        off_t indexed; //!< bytes of the file already indexed
+    };
+
+    /** @brief bring the index up to date with the log files */
+    void update();
+    void build();
+    void scan(size_t file);
+    void closeFiles();
+    bool readEntry(const Entry& entry, std::string& line) const;
+
+    std::filesystem::path dir;
+    std::string basename;
+    Decoder decoder;
+    int inotifyFd = -1;
+    bool valid = false;
+    uint32_t lastAdd;
+    // log files ordered from oldest to newest
+    std::vector<File> files;
+    // entries ordered from oldest to newest
+    std::vector<Entry> entries;
+    // decoded records, in the order of the entries, when there's a decoder
+    std::vector<std::optional<Record>> records;
+    std::unordered_map<uint16_t, size_t> recordIndex;
+};
+
+} // namespace sel
+
+} // namespace ipmi
@@ -0,0 +1,284 @@
+#include "selring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <phosphor-logging/log.hpp>
+
+namespace ipmi
+{
+
+namespace sel
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+constexpr uint32_t ringMagic = 0x4c455349; // "ISEL"
+constexpr uint16_t ringVersion = 1;
+constexpr uint32_t invalidTimeStamp = 0xFFFFFFFF;
+
+constexpr uint16_t firstRecord = 0x0000;
+constexpr uint16_t lastRecord = 0xFFFF;
+// record IDs run from 0001h to FFFEh
+constexpr size_t recordIDs = 0xFFFE;
+
+inline uint16_t followingID(uint16_t recordID)
+{
+    return recordID >= recordIDs ? 1 : recordID + 1;
+}
+
+} // namespace
+
+Ring::Ring(const std::filesystem::path& path, uint16_t capacity) :
+    path(path), slots(std::min<size_t>(capacity, recordIDs))
+{
+}
+
+Ring::~Ring()
+{
+    if (header)
+    {
+        munmap(header, fileSize());
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+bool Ring::map()
+{
+    if (header)
+    {
+        return true;
+    }
+
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        log<level::ERR>("Failed to open SEL ring",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        return false;
+    }
+    struct stat st;
+    bool valid = fstat(fd, &st) == 0 &&
+                 static_cast<size_t>(st.st_size) == fileSize();
+    if (!valid && (ftruncate(fd, 0) < 0 || ftruncate(fd, fileSize()) < 0))
+    {
+        log<level::ERR>("Failed to size SEL ring",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    // the mapping is read only, updates go through pwrite like the other
+    // IPMI record files so it also works on file systems without writable
+    // shared mappings
+    void* addr = mmap(nullptr, fileSize(), PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        log<level::ERR>("Failed to map SEL ring",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    header = static_cast<Header*>(addr);
+
+    if (!valid || header->magic != ringMagic ||
+        header->version != ringVersion || header->capacity != slots)
+    {
+        log<level::INFO>("Creating SEL ring", entry("FILE=%s", path.c_str()));
+        Header fresh{ringMagic,
+                     ringVersion,
+                     static_cast<uint16_t>(slots),
+                     1,
+                     0,
+                     0,
+                     0,
+                     0,
+                     invalidTimeStamp,
+                     invalidTimeStamp};
+        if (pwrite(fd, &fresh, sizeof(fresh), 0) !=
+            static_cast<ssize_t>(sizeof(fresh)))
+        {
+            log<level::ERR>("Failed to initialize SEL ring",
+                            entry("FILE=%s", path.c_str()),
+                            entry("ERRNO=%d", errno));
+            munmap(header, fileSize());
+            header = nullptr;
+            close(fd);
+            fd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+uint16_t Ring::oldestID() const
+{
+    size_t next = header->nextID - 1;
+    return (next + recordIDs - header->count) % recordIDs + 1;
+}
+
+size_t Ring::position(uint16_t recordID) const
+{
+    if (recordID == firstRecord || recordID > recordIDs)
+    {
+        return header->count;
+    }
+    size_t distance = (recordID + recordIDs - oldestID()) % recordIDs;
+    return distance < header->count ? distance : header->count;
+}
+
+uint8_t* Ring::slot(size_t position) const
+{
+    return reinterpret_cast<uint8_t*>(header) + sizeof(Header) +
+           (header->head + position) % slots * recordSize;
+}
+
+bool Ring::add(Record& record, uint32_t timestamp)
+{
+    if (!map())
+    {
+        return false;
+    }
+
+    Header updated = *header;
+    record[0] = static_cast<uint8_t>(updated.nextID);
+    record[1] = static_cast<uint8_t>(updated.nextID >> 8);
+    off_t offset = slot(updated.count) - reinterpret_cast<uint8_t*>(header);
+    if (pwrite(fd, record.data(), recordSize, offset) !=
+        static_cast<ssize_t>(recordSize))
+    {
+        log<level::ERR>("Failed to write SEL ring record",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        return false;
+    }
+
+    updated.nextID = followingID(updated.nextID);
+    if (updated.count < slots)
+    {
+        updated.count++;
+    }
+    else
+    {
+        // the record replaced the oldest one
+        updated.head = (updated.head + 1) % slots;
+        updated.overflow = 1;
+    }
+    updated.addTimestamp = timestamp;
+    if (pwrite(fd, &updated, sizeof(updated), 0) !=
+        static_cast<ssize_t>(sizeof(updated)))
+    {
+        log<level::ERR>("Failed to update SEL ring",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        return false;
+    }
+    return true;
+}
+
+bool Ring::read(uint16_t recordID, Record& record)
+{
+    if (!map() || header->count == 0)
+    {
+        return false;
+    }
+
+    size_t pos;
+    if (recordID == firstRecord)
+    {
+        pos = 0;
+    }
+    else if (recordID == lastRecord)
+    {
+        pos = header->count - 1;
+    }
+    else
+    {
+        pos = position(recordID);
+        if (pos == header->count)
+        {
+            return false;
+        }
+    }
+    std::memcpy(record.data(), slot(pos), recordSize);
+    return true;
+}
+
+uint16_t Ring::nextRecordID(uint16_t recordID)
+{
+    if (!map())
+    {
+        return lastRecord;
+    }
+    size_t pos = position(recordID);
+    if (pos + 1 >= header->count)
+    {
+        return lastRecord;
+    }
+    return followingID(recordID);
+}
+
+bool Ring::clear(uint32_t timestamp)
+{
+    if (!map())
+    {
+        return false;
+    }
+
+    // record IDs keep counting, so a record ID the host still holds never
+    // refers to a newer record
+    Header updated = *header;
+    updated.count = 0;
+    updated.head = 0;
+    updated.overflow = 0;
+    updated.eraseTimestamp = timestamp;
+    if (pwrite(fd, &updated, sizeof(updated), 0) !=
+        static_cast<ssize_t>(sizeof(updated)))
+    {
+        log<level::ERR>("Failed to clear SEL ring",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        return false;
+    }
+    return true;
+}
+
+size_t Ring::count()
+{
+    return map() ? header->count : 0;
+}
+
+uint32_t Ring::lastAddTime()
+{
+    return map() ? header->addTimestamp : invalidTimeStamp;
+}
+
+uint32_t Ring::lastEraseTime()
+{
+    return map() ? header->eraseTimestamp : invalidTimeStamp;
+}
+
+bool Ring::overflow()
+{
+    return map() && header->overflow;
+}
+
+} // namespace sel
+
+} // namespace ipmi
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace ipmi
+{
+
+namespace sel
+{
+
+/** @class Ring
+ *
+ *  SEL kept as raw 16-byte SEL records in a fixed capacity ring, in a file
+ *  mapped into memory. The file starts with a header holding the ID of the
+ *  next record, the ring position, the add and erase timestamps and the
+ *  overflow flag, so no SEL command parses or scans anything.
+ *
+ *  Record IDs are handed out in sequence from 0001h to FFFEh and then wrap,
+ *  so the slot of a record follows from its distance to the oldest record.
+ *  When the ring is full a new record replaces the oldest one and the
+ *  overflow flag is set until the SEL is cleared.
+ */
+class Ring
+{
+  public:
+    static constexpr size_t recordSize = 16;
+    using Record = std::array<uint8_t, recordSize>;
+
+    /** @brief constructs a ring, the file is mapped on first use
+     *
+     *  @param[in] path - ring file path, created if it does not exist or
+     *                    has another layout
+     *  @param[in] capacity - number of records in the ring
+     */
+    Ring(const std::filesystem::path& path, uint16_t capacity);
+    ~Ring();
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    /** @brief add a record
+     *
+     *  @param[in,out] record - the record, its record ID is filled in
+     *  @param[in] timestamp - time of the addition
+     *
+     *  @return true if the record was added
+     */
+    bool add(Record& record, uint32_t timestamp);
+
+    /** @brief read a record
+     *
+     *  @param[in] recordID - record ID, 0000h and FFFFh are the oldest and
+     *                        the newest record
+     *  @param[out] record - the record
+     *
+     *  @return true if the record was found
+     */
+    bool read(uint16_t recordID, Record& record);
+
+    /** @brief get the record ID following a record
+     *
+     *  @param[in] recordID - record ID
+     *
+     *  @return the ID of the next record, FFFFh if recordID is the newest
+     */
+    uint16_t nextRecordID(uint16_t recordID);
+
+    /** @brief remove all the records
+     *
+     *  @param[in] timestamp - time of the erasure
+     *
+     *  @return true for success
+     */
+    bool clear(uint32_t timestamp);
+
+    /** @brief get the number of records in the SEL */
+    size_t count();
+
+    /** @brief get the number of records the SEL holds */
+    size_t capacity() const
+    {
+        return slots;
+    }
+
+    /** @brief get the time of the last addition, FFFFFFFFh if none */
+    uint32_t lastAddTime();
+
+    /** @brief get the time of the last erasure, FFFFFFFFh if none */
+    uint32_t lastEraseTime();
+
+    /** @brief check if records were overwritten since the last erasure */
+    bool overflow();
+
+  private:
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t capacity;
+        uint16_t nextID;   //!< ID of the next record added
+        uint16_t count;    //!< number of records in the ring
+        uint16_t head;     //!< slot of the oldest record
+        uint8_t overflow;  //!< records were overwritten
+        uint8_t reserved;
+        uint32_t addTimestamp;
+        uint32_t eraseTimestamp;
+    };
+
+    size_t fileSize() const
+    {
+        return sizeof(Header) + slots * recordSize;
+    }
+
+    /** @brief map the ring file, creating it if needed */
+    bool map();
+
+    /** @brief get the record ID of the oldest record */
+    uint16_t oldestID() const;
+
+    /** @brief get the position of a record counted from the oldest one
+     *
+     *  @return the position, count if the record is not in the ring
+     */
+    size_t position(uint16_t recordID) const;
+
+    uint8_t* slot(size_t position) const;
+
+    std::filesystem::path path;
+    size_t slots;
+    int fd = -1;
+    Header* header = nullptr;
+};
+
+} // namespace sel
+
+} // namespace ipmi
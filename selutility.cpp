@@ -6,13 +6,19 @@
 #include <chrono>
 #include <filesystem>
 #include <ipmid/api.hpp>
+#include <ipmid/mapper.hpp>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
+#include <list>
+#include <memory>
 #include <phosphor-logging/elog-errors.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <xyz/openbmc_project/Common/error.hpp>
 
-extern const ipmi::sensor::InvObjectIDMap invSensors;
+extern const ipmi::sensor::InvSensorMap invSensors;
 using namespace phosphor::logging;
 using InternalFailure =
     sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
@@ -29,6 +35,9 @@ constexpr auto selDataSize = 3;
 constexpr auto oemCDDataSize = 9;
 constexpr auto oemEFDataSize = 13;
 
+// number of encoded SEL records kept by convertLogEntrytoSEL
+constexpr size_t selRecordCacheSize = 512;
+
 constexpr auto propAdditionalData = "AdditionalData";
 constexpr auto propResolved = "Resolved";
 
@@ -177,7 +186,7 @@ void constructSEL(uint8_t recordType, std::chrono::milliseconds timestamp,
 
 GetSELEntryResponse
     prepareSELEntry(const std::string& objPath,
-                    ipmi::sensor::InvObjectIDMap::const_iterator iter)
+                    ipmi::sensor::InvSensorMap::const_iterator iter)
 {
     GetSELEntryResponse record{};
 
@@ -303,9 +312,7 @@ GetSELEntryResponse
     return record;
 }
 
-} // namespace internal
-
-GetSELEntryResponse convertLogEntrytoSEL(const std::string& objPath)
+GetSELEntryResponse readLogEntry(const std::string& objPath)
 {
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
 
@@ -366,6 +373,88 @@ GetSELEntryResponse convertLogEntrytoSEL(const std::string& objPath)
     return internal::prepareSELEntry(objPath, iter);
 }
 
+/*
+ * Encoded SEL records of the logging entries, most recently used first. An
+ * entry is dropped when any of its properties change (Resolved flips the
+ * event direction) or when it is removed.
+ */
+using RecordList = std::list<std::pair<std::string, GetSELEntryResponse>>;
+RecordList recordCache;
+std::unordered_map<std::string, RecordList::iterator> recordCacheIndex;
+std::unique_ptr<sdbusplus::bus::match::match> entryChangedMatch;
+std::unique_ptr<sdbusplus::bus::match::match> entryRemovedMatch;
+
+void evictRecord(const std::string& objPath)
+{
+    auto it = recordCacheIndex.find(objPath);
+    if (it != recordCacheIndex.end())
+    {
+        recordCache.erase(it->second);
+        recordCacheIndex.erase(it);
+    }
+}
+
+void watchRecordCache()
+{
+    if (entryChangedMatch)
+    {
+        return;
+    }
+    entryChangedMatch = std::make_unique<sdbusplus::bus::match::match>(
+        *getSdBus(),
+        "type='signal',interface='org.freedesktop.DBus.Properties',"
+        "member='PropertiesChanged',path_namespace='" +
+            std::string(logBasePath) + "'",
+        [](sdbusplus::message::message& m) { evictRecord(m.get_path()); });
+    entryRemovedMatch = std::make_unique<sdbusplus::bus::match::match>(
+        *getSdBus(),
+        "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesRemoved',arg0path='" +
+            std::string(logBasePath) + "/'",
+        [](sdbusplus::message::message& m) {
+            sdbusplus::message::object_path path;
+            try
+            {
+                m.read(path);
+            }
+            catch (const sdbusplus::exception::SdBusError& e)
+            {
+                recordCache.clear();
+                recordCacheIndex.clear();
+                return;
+            }
+            evictRecord(path);
+        });
+}
+
+} // namespace internal
+
+GetSELEntryResponse convertLogEntrytoSEL(const std::string& objPath)
+{
+    using namespace internal;
+
+    // subscribe before reading, so a change meanwhile evicts the record
+    watchRecordCache();
+
+    auto it = recordCacheIndex.find(objPath);
+    if (it != recordCacheIndex.end())
+    {
+        recordCache.splice(recordCache.begin(), recordCache, it->second);
+        return it->second->second;
+    }
+
+    GetSELEntryResponse record = readLogEntry(objPath);
+
+    recordCache.emplace_front(objPath, record);
+    recordCacheIndex.emplace(objPath, recordCache.begin());
+    if (recordCache.size() > selRecordCacheSize)
+    {
+        recordCacheIndex.erase(recordCache.back().first);
+        recordCache.pop_back();
+    }
+    return record;
+}
+
 std::chrono::seconds getEntryTimeStamp(const std::string& objPath)
 {
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
@@ -395,37 +484,45 @@ std::chrono::seconds getEntryTimeStamp(const std::string& objPath)
     return std::chrono::duration_cast<std::chrono::seconds>(chronoTimeStamp);
 }
 
-void readLoggingObjectPaths(ObjectPaths& paths)
+bool getEntryId(const std::string& objPath, Id& id)
+{
+    std::string_view name(objPath);
+    size_t slash = name.find_last_of('/');
+    if (slash != std::string_view::npos)
+    {
+        name.remove_prefix(slash + 1);
+    }
+    const char* end = name.data() + name.size();
+    auto [ptr, ec] = std::from_chars(name.data(), end, id);
+    return ec == std::errc() && ptr == end && !name.empty();
+}
+
+void readLoggingObjectPaths(ObjectPathMap& paths)
 {
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    auto depth = 0;
     paths.clear();
 
-    auto mapperCall = bus.new_method_call(mapperBusName, mapperObjPath,
-                                          mapperIntf, "GetSubTreePaths");
-    mapperCall.append(logBasePath);
-    mapperCall.append(depth);
-    mapperCall.append(ObjectPaths({logEntryIntf}));
-
-    auto reply = bus.call(mapperCall);
-    if (reply.is_method_error())
+    // the paths of GetSubTree, so the answer is shared with the other
+    // callers of the mapper client
+    ipmi::ObjectTree objectTree;
+    try
+    {
+        objectTree =
+            ipmi::mapper::getSubTree(bus, logBasePath, 0, {logEntryIntf});
+    }
+    catch (const sdbusplus::exception_t& e)
     {
         log<level::INFO>("Error in reading logging entry object paths");
+        return;
     }
-    else
+
+    for (auto& object : objectTree)
     {
-        reply.read(paths);
-
-        std::sort(paths.begin(), paths.end(),
-                  [](const std::string& a, const std::string& b) {
-                      namespace fs = std::filesystem;
-                      fs::path pathA(a);
-                      fs::path pathB(b);
-                      auto idA = std::stoul(pathA.filename().string());
-                      auto idB = std::stoul(pathB.filename().string());
-
-                      return idA < idB;
-                  });
+        Id id;
+        if (getEntryId(object.first, id))
+        {
+            paths.emplace(id, object.first);
+        }
     }
 }
 
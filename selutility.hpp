@@ -1,8 +1,11 @@
 #pragma once
 
+#include "sensortable.hpp"
+
 #include <chrono>
 #include <cstdint>
 #include <ipmid/types.hpp>
+#include <map>
 #include <sdbusplus/server.hpp>
 
 namespace ipmi
@@ -18,6 +21,9 @@ static constexpr auto mapperIntf = "xyz.openbmc_project.ObjectMapper";
 static constexpr auto logBasePath = "/xyz/openbmc_project/logging/entry";
 static constexpr auto logEntryIntf = "xyz.openbmc_project.Logging.Entry";
 static constexpr auto logDeleteIntf = "xyz.openbmc_project.Object.Delete";
+static constexpr auto logObjPath = "/xyz/openbmc_project/logging";
+static constexpr auto logDeleteAllIntf =
+    "xyz.openbmc_project.Collection.DeleteAll";
 
 static constexpr auto propIntf = "org.freedesktop.DBus.Properties";
 
@@ -30,6 +36,7 @@ using Message = std::string;
 using AdditionalData = std::vector<std::string>;
 using PropertyType =
     std::variant<Resolved, Id, Timestamp, Message, AdditionalData>;
+using ObjectPathMap = std::map<Id, std::string>;
 
 static constexpr auto selVersion = 0x51;
 static constexpr auto invalidTimeStamp = 0xFFFFFFFF;
@@ -39,7 +46,7 @@ static constexpr auto lastEntry = 0xFFFF;
 static constexpr auto entireRecord = 0xFF;
 static constexpr auto selRecordSize = 16;
 
-#ifdef JOURNAL_SEL
+#if defined(JOURNAL_SEL) || defined(RING_SEL)
 // ID string generated using journalctl to include in the MESSAGE_ID field for
 // SEL entries.  Helps with filtering SEL entries in the journal.
 static constexpr const char* selMessageId = "b370836ccf2f4850ac5bee185b77893a";
@@ -146,7 +153,7 @@ struct DeleteSELEntryRequest
     uint16_t selRecordID;   //!< SEL Record ID.
 } __attribute__((packed));
 
-#else  // JOURNAL_SEL
+#else  // JOURNAL_SEL || RING_SEL
 namespace operationSupport
 {
 static constexpr bool overflow = false;
@@ -155,7 +162,7 @@ static constexpr bool partialAddSelEntry = false;
 static constexpr bool reserveSel = true;
 static constexpr bool getSelAllocationInfo = false;
 } // namespace operationSupport
-#endif // JOURNAL_SEL
+#endif // JOURNAL_SEL || RING_SEL
 
 /** @struct GetSELEntryRequest
  *
@@ -242,9 +249,13 @@ static_assert(sizeof(GetSELEntryResponse) ==
 
 static constexpr auto initiateErase = 0xAA;
 static constexpr auto getEraseStatus = 0x00;
+static constexpr auto eraseInProgress = 0x00;
 static constexpr auto eraseComplete = 0x01;
 
 /** @brief Convert logging entry to SEL
+ *
+ *  The encoded records are kept in a bounded LRU cache, entries are evicted
+ *  when their properties change or when they are removed.
  *
  *  @param[in] objPath - DBUS object path of the logging entry.
  *
@@ -261,20 +272,28 @@ GetSELEntryResponse convertLogEntrytoSEL(const std::string& objPath);
  */
 std::chrono::seconds getEntryTimeStamp(const std::string& objPath);
 
+/** @brief Get the numeric ID of a logging entry
+ *
+ *  @param[in] objPath - DBUS object path of the logging entry.
+ *  @param[out] id - the entry ID, which is the filename of the path.
+ *
+ *  @return true if the path ends in a numeric entry ID.
+ */
+bool getEntryId(const std::string& objPath, Id& id);
+
 /** @brief Read the logging entry object paths
  *
- *  This API would read the logging dbus logging entry object paths and sorting
- *  the filename in the numeric order. The paths is cleared before populating
+ *  This API would read the logging dbus logging entry object paths and key
+ *  them by their numeric entry ID. The paths is cleared before populating
  *  the object paths.
  *
- *  @param[in,out] paths - sorted list of logging entry object paths.
+ *  @param[in,out] paths - logging entry object paths ordered by entry ID.
  *
- *  @note This function is invoked when the Get SEL Info command or the Delete
- *        SEL entry command is invoked. The Get SEL Entry command is preceded
- *        typically by Get SEL Info command, so readLoggingObjectPaths is not
- *        invoked before each Get SEL entry command.
+ *  @note This function is invoked to fill the logging entry cache, which is
+ *        then kept up to date from the InterfacesAdded and InterfacesRemoved
+ *        signals of the logging service.
  */
-void readLoggingObjectPaths(ObjectPaths& paths);
+void readLoggingObjectPaths(ObjectPathMap& paths);
 
 namespace internal
 {
@@ -290,7 +309,16 @@ namespace internal
  */
 GetSELEntryResponse
     prepareSELEntry(const std::string& objPath,
-                    ipmi::sensor::InvObjectIDMap::const_iterator iter);
+                    ipmi::sensor::InvSensorMap::const_iterator iter);
+
+/** @brief Convert logging entry to SEL, bypassing the record cache
+ *
+ *  @param[in] objPath - DBUS object path of the logging entry.
+ *
+ *  @return On success return the response of Get SEL entry command, throw an
+ *          exception in case of failure.
+ */
+GetSELEntryResponse readLogEntry(const std::string& objPath);
 
 } // namespace internal
 
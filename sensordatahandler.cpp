@@ -3,12 +3,17 @@
 #include "sensorhandler.hpp"
 
 #include <bitset>
+#include <deque>
 #include <filesystem>
+#include <map>
+#include <memory>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
 #include <optional>
+#include <unordered_map>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/message/types.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
@@ -78,6 +83,60 @@ ServicePath getServiceAndPath(sdbusplus::bus::bus& bus,
     return std::make_pair(iter->first, iter->second.begin()->first);
 }
 
+namespace
+{
+
+/** @brief services of the sensor objects, by interface and path */
+std::map<std::pair<Interface, Path>, Service> sensorServices;
+std::unique_ptr<sdbusplus::bus::match_t> sensorServicesOwnerMatch;
+
+} // namespace
+
+Service getSensorService(sdbusplus::bus::bus& bus, const Interface& interface,
+                         const Path& path)
+{
+    auto key = std::make_pair(interface, path);
+    auto it = sensorServices.find(key);
+    if (it != sensorServices.end())
+    {
+        return it->second;
+    }
+
+    if (!sensorServicesOwnerMatch)
+    {
+        // a service that leaves or changes hands is resolved again
+        sensorServicesOwnerMatch = std::make_unique<sdbusplus::bus::match_t>(
+            *getSdBus(), sdbusplus::bus::match::rules::nameOwnerChanged(),
+            [](sdbusplus::message::message& msg) {
+                std::string name, oldOwner, newOwner;
+                try
+                {
+                    msg.read(name, oldOwner, newOwner);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                for (auto it = sensorServices.begin();
+                     it != sensorServices.end();)
+                {
+                    if (it->second == name || it->second == oldOwner)
+                    {
+                        it = sensorServices.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            });
+    }
+
+    auto service = ipmi::getService(bus, interface, path);
+    sensorServices.emplace(std::move(key), service);
+    return service;
+}
+
 AssertionSet getAssertionSet(const SetSensorReadingReq& cmdData)
 {
     Assertion assertionStates =
@@ -109,6 +168,58 @@ ipmi_ret_t updateToDbus(IpmiUpdateData& msg)
     return IPMI_CC_OK;
 }
 
+namespace
+{
+
+/** @brief the queued updates by key, and their keys in the order they were
+ *         queued
+ */
+std::unordered_map<std::string, IpmiUpdateData> queuedUpdates;
+std::deque<std::string> queuedOrder;
+bool updateInFlight = false;
+
+/** @brief send the oldest queued update, the next one goes once it is
+ *         answered so that the updates reach their services in order
+ */
+void sendQueuedUpdate()
+{
+    if (updateInFlight || queuedOrder.empty())
+    {
+        return;
+    }
+    std::string key = std::move(queuedOrder.front());
+    queuedOrder.pop_front();
+    auto queued = queuedUpdates.find(key);
+    IpmiUpdateData msg = std::move(queued->second);
+    queuedUpdates.erase(queued);
+
+    updateInFlight = true;
+    getSdBus()->async_send(
+        msg, [key{std::move(key)}](boost::system::error_code ec,
+                                   sdbusplus::message::message reply) {
+            updateInFlight = false;
+            if (ec || reply.is_method_error())
+            {
+                log<level::ERR>("Error in D-Bus call",
+                                entry("UPDATE=%s", key.c_str()));
+            }
+            sendQueuedUpdate();
+        });
+}
+
+} // namespace
+
+ipmi_ret_t queueToDbus(IpmiUpdateData&& msg, std::string&& key)
+{
+    auto [queued, added] = queuedUpdates.insert_or_assign(key, std::move(msg));
+    if (added)
+    {
+        queuedOrder.emplace_back(std::move(key));
+    }
+    sendQueuedUpdate();
+    return IPMI_CC_OK;
+}
+
 namespace get
 {
 
@@ -135,7 +246,7 @@ GetSensorResponse mapDbusToAssertion(const Info& sensorInfo,
 
     enableScanning(&response);
 
-    auto service = ipmi::getService(bus, interface, path);
+    auto service = getSensorService(bus, interface, path);
 
     const auto& interfaceList = sensorInfo.propertyInterfaces;
 
@@ -173,7 +284,7 @@ GetSensorResponse eventdata2(const Info& sensorInfo)
 
     enableScanning(&response);
 
-    auto service = ipmi::getService(bus, sensorInfo.sensorInterface,
+    auto service = getSensorService(bus, sensorInfo.sensorInterface,
                                     sensorInfo.sensorPath);
 
     const auto& interfaceList = sensorInfo.propertyInterfaces;
@@ -213,7 +324,7 @@ IpmiUpdateData makeDbusMsg(const std::string& updateInterface,
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
     using namespace std::string_literals;
 
-    auto dbusService = getService(bus, sensorInterface, sensorPath);
+    auto dbusService = getSensorService(bus, sensorInterface, sensorPath);
 
     return bus.new_method_call(dbusService.c_str(), sensorPath.c_str(),
                                updateInterface.c_str(), command.c_str());
@@ -239,7 +350,8 @@ ipmi_ret_t eventdata(const SetSensorReadingReq& cmdData, const Info& sensorInfo,
         }
         msg.append(iter->second.assert);
     }
-    return updateToDbus(msg);
+    return queueToDbus(std::move(msg),
+                       sensorInfo.sensorPath + " " + interface->first);
 }
 
 ipmi_ret_t assertion(const SetSensorReadingReq& cmdData, const Info& sensorInfo)
@@ -282,11 +394,9 @@ ipmi_ret_t assertion(const SetSensorReadingReq& cmdData, const Info& sensorInfo)
             msg.append(property.first);
             msg.append(*tmp);
 
-            auto rc = updateToDbus(msg);
-            if (rc)
-            {
-                return rc;
-            }
+            queueToDbus(std::move(msg), sensorInfo.sensorPath + " " +
+                                            interface->first + " " +
+                                            property.first);
         }
     }
 
@@ -307,7 +417,7 @@ IpmiUpdateData makeDbusMsg(const std::string& updateInterface,
     using namespace std::string_literals;
 
     static const auto dbusPath = "/xyz/openbmc_project/inventory"s;
-    std::string dbusService = ipmi::getService(bus, updateInterface, dbusPath);
+    std::string dbusService = getSensorService(bus, updateInterface, dbusPath);
 
     return bus.new_method_call(dbusService.c_str(), dbusPath.c_str(),
                                updateInterface.c_str(), command.c_str());
@@ -383,9 +493,19 @@ ipmi_ret_t assertion(const SetSensorReadingReq& cmdData, const Info& sensorInfo)
         }
     }
 
+    // updates that notify other properties don't replace each other
+    std::string key = sensorInfo.sensorPath;
+    for (const auto& [interface, props] : interfaces)
+    {
+        key += " " + interface;
+        for (const auto& property : props)
+        {
+            key += " " + property.first;
+        }
+    }
     objects.emplace(sensorInfo.sensorPath, std::move(interfaces));
     msg.append(std::move(objects));
-    return updateToDbus(msg);
+    return queueToDbus(std::move(msg), std::move(key));
 }
 
 } // namespace notify
@@ -39,6 +39,20 @@ ServicePath getServiceAndPath(sdbusplus::bus::bus& bus,
                               const std::string& interface,
                               const std::string& path = std::string());
 
+/** @brief get the D-Bus service of a sensor object
+ *
+ *  The service is resolved through the mapper once and then kept until its
+ *  owner changes on the bus, so reading a sensor again doesn't go through
+ *  the mapper.
+ *
+ *  @param[in] bus - The Dbus bus object
+ *  @param[in] interface - interface of the object
+ *  @param[in] path - object path
+ *  @return the service name
+ */
+Service getSensorService(sdbusplus::bus::bus& bus, const Interface& interface,
+                         const Path& path);
+
 /** @brief Make assertion set from input data
  *  @param[in] cmdData - Input sensor data
  *  @return pair of assertion and deassertion set
@@ -51,6 +65,20 @@ AssertionSet getAssertionSet(const SetSensorReadingReq& cmdData);
  */
 ipmi_ret_t updateToDbus(IpmiUpdateData& msg);
 
+/** @brief queue the message for DBus and answer without waiting for it
+ *
+ *  The queued messages are sent one at a time in the order they were
+ *  queued, and a message replaces a queued one of the same key, so a burst
+ *  of readings of a sensor only sends the newest. The host has its answer
+ *  by the time the message is sent, errors are logged. Called from the main
+ *  loop, like the Set Sensor Reading handler.
+ *
+ *  @param[in] msg - message to send
+ *  @param[in] key - the object and properties the message updates
+ *  @return IPMI_CC_OK
+ */
+ipmi_ret_t queueToDbus(IpmiUpdateData&& msg, std::string&& key);
+
 namespace get
 {
 
@@ -159,7 +187,7 @@ GetSensorResponse readingAssertion(const Info& sensorInfo)
 
     enableScanning(&response);
 
-    auto service = ipmi::getService(bus, sensorInfo.sensorInterface,
+    auto service = getSensorService(bus, sensorInfo.sensorInterface,
                                     sensorInfo.sensorPath);
 
     auto propValue = ipmi::getDbusProperty(
@@ -189,7 +217,7 @@ GetSensorResponse readingData(const Info& sensorInfo)
 
     enableScanning(&response);
 
-    auto service = ipmi::getService(bus, sensorInfo.sensorInterface,
+    auto service = getSensorService(bus, sensorInfo.sensorInterface,
                                     sensorInfo.sensorPath);
 
 #ifdef UPDATE_FUNCTIONAL_ON_FAIL
@@ -286,7 +314,8 @@ ipmi_ret_t readingAssertion(const SetSensorReadingReq& cmdData,
                                                cmdData.assertOffset0_7);
         msg.append(value);
     }
-    return updateToDbus(msg);
+    return queueToDbus(std::move(msg),
+                       sensorInfo.sensorPath + " " + interface->first);
 }
 
 /** @brief Update d-bus based on a discrete reading
@@ -316,7 +345,8 @@ ipmi_ret_t readingData(const SetSensorReadingReq& cmdData,
         std::variant<T> value = raw_value;
         msg.append(value);
     }
-    return updateToDbus(msg);
+    return queueToDbus(std::move(msg),
+                       sensorInfo.sensorPath + " " + interface->first);
 }
 
 /** @brief Update d-bus based on eventdata type sensor data
@@ -4,20 +4,29 @@
 
 #include "entity_map_json.hpp"
 #include "fruread.hpp"
+#include "sensordatahandler.hpp"
+#include "sensortable.hpp"
+#include "storagehandler.hpp"
 
-#include <mapper.h>
 #include <systemd/sd-bus.h>
 
+#include <algorithm>
 #include <bitset>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
 #include <cmath>
 #include <cstring>
+#include <deque>
 #include <ipmid/api.hpp>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
+#include <map>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/message/types.hpp>
 #include <set>
+#include <tuple>
 #include <xyz/openbmc_project/Common/error.hpp>
 #include <xyz/openbmc_project/Sensor/Value/server.hpp>
 
@@ -32,7 +41,7 @@ namespace ipmi
 {
 namespace sensor
 {
-extern const IdInfoMap sensors;
+extern const SensorMap sensors;
 } // namespace sensor
 } // namespace ipmi
 
@@ -79,18 +88,11 @@ struct sensor_data_t
     uint8_t sennum;
 } __attribute__((packed));
 
-int get_bus_for_path(const char* path, char** busname)
-{
-    return mapper_get_service(bus, path, busname);
-}
-
 // Use a lookup table to find the interface name of a specific sensor
 // This will be used until an alternative is found.  this is the first
 // step for mapping IPMI
 int find_openbmc_path(uint8_t num, dbus_interface_t* interface)
 {
-    int rc;
-
     const auto& sensor_it = ipmi::sensor::sensors.find(num);
     if (sensor_it == ipmi::sensor::sensors.end())
     {
@@ -100,17 +102,22 @@ int find_openbmc_path(uint8_t num, dbus_interface_t* interface)
 
     const auto& info = sensor_it->second;
 
-    char* busname = nullptr;
-    rc = get_bus_for_path(info.sensorPath.c_str(), &busname);
-    if (rc < 0)
+    std::string busname;
+    try
+    {
+        sdbusplus::bus::bus dbus{ipmid_get_sd_bus_connection()};
+        busname = ipmi::sensor::getSensorService(dbus, info.sensorInterface,
+                                                 info.sensorPath);
+    }
+    catch (const std::exception& e)
     {
         std::fprintf(stderr, "Failed to get %s busname: %s\n",
-                     info.sensorPath.c_str(), busname);
-        goto final;
+                     info.sensorPath.c_str(), e.what());
+        return -ENXIO;
     }
 
     interface->sensortype = info.sensorType;
-    strcpy(interface->bus, busname);
+    strcpy(interface->bus, busname.c_str());
     strcpy(interface->path, info.sensorPath.c_str());
     // Take the interface name from the beginning of the DbusInterfaceMap. This
     // works for the Value interface but may not suffice for more complex
@@ -120,9 +127,7 @@ int find_openbmc_path(uint8_t num, dbus_interface_t* interface)
            info.propertyInterfaces.begin()->first.c_str());
     interface->sensornumber = num;
 
-final:
-    free(busname);
-    return rc;
+    return 0;
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -367,7 +372,13 @@ ipmi::RspType<> ipmiSetSensorReading(uint8_t sensorNumber, uint8_t operation,
     const auto iter = ipmi::sensor::sensors.find(sensorNumber);
     if (iter == ipmi::sensor::sensors.end())
     {
-        updateSensorRecordFromSSRAESC(&sensorNumber);
+        // the legacy sensors take the request the way it came in
+        const uint8_t record[] = {sensorNumber,       operation,
+                                  reading,            assertOffset0_7,
+                                  assertOffset8_14,   deassertOffset0_7,
+                                  deassertOffset8_14, eventData1,
+                                  eventData2,         eventData3};
+        updateSensorRecordFromSSRAESC(record);
         return ipmi::responseSuccess();
     }
 
@@ -485,7 +496,8 @@ get_sdr::GetSensorThresholdsResponse getSensorThresholds(uint8_t sensorNum)
     const auto iter = ipmi::sensor::sensors.find(sensorNum);
     const auto info = iter->second;
 
-    auto service = ipmi::getService(bus, info.sensorInterface, info.sensorPath);
+    auto service = ipmi::sensor::getSensorService(bus, info.sensorInterface,
+                                                  info.sensorPath);
 
     auto warnThresholds = ipmi::getAllDbusProperties(
         bus, service, info.sensorPath, warningThreshIntf);
@@ -695,8 +707,7 @@ void setUnitFieldsForObject(const ipmi::sensor::Info* info,
 }
 
 ipmi_ret_t populate_record_from_dbus(get_sdr::SensorDataFullRecordBody* body,
-                                     const ipmi::sensor::Info* info,
-                                     ipmi_data_len_t data_len)
+                                     const ipmi::sensor::Info* info)
 {
     /* Functional sensor case */
     if (isAnalogSensor(info->propertyInterfaces.begin()->first))
@@ -737,23 +748,40 @@ ipmi_ret_t populate_record_from_dbus(get_sdr::SensorDataFullRecordBody* body,
     return IPMI_CC_OK;
 };
 
-ipmi_ret_t ipmi_fru_get_sdr(ipmi_request_t request, ipmi_response_t response,
-                            ipmi_data_len_t data_len)
+using GetSdrResponse = ipmi::RspType<uint16_t,            // next record ID
+                                     std::vector<uint8_t>>; // record data
+
+/** @brief answers the part of an SDR record a Get SDR request asks for
+ *  @param record - the SDR record
+ *  @param nextRecordID - record ID of the record that follows
+ *  @param offset - offset into the record
+ *  @param bytesToRead - bytes to read, FFh for the rest of the record
+ */
+template <typename Record>
+static GetSdrResponse sdrResponse(const Record& record, uint16_t nextRecordID,
+                                  uint8_t offset, uint8_t bytesToRead)
 {
-    auto req = reinterpret_cast<get_sdr::GetSdrReq*>(request);
-    auto resp = reinterpret_cast<get_sdr::GetSdrResp*>(response);
-    get_sdr::SensorDataFruRecord record{};
-    auto dataLength = 0;
+    if (offset > sizeof(record))
+    {
+        return ipmi::responseParmOutOfRange();
+    }
+    size_t size = std::min(static_cast<size_t>(bytesToRead),
+                           sizeof(record) - offset);
+    auto data = reinterpret_cast<const uint8_t*>(&record) + offset;
+    return ipmi::responseSuccess(nextRecordID,
+                                 std::vector<uint8_t>(data, data + size));
+}
 
-    auto fru = frus.begin();
-    uint8_t fruID{};
-    auto recordID = get_sdr::request::get_record_id(req);
+static GetSdrResponse getFruSdr(uint16_t recordID, uint8_t offset,
+                                uint8_t bytesToRead)
+{
+    get_sdr::SensorDataFruRecord record{};
 
-    fruID = recordID - FRU_RECORD_ID_START;
-    fru = frus.find(fruID);
+    uint8_t fruID = recordID - FRU_RECORD_ID_START;
+    auto fru = frus.find(fruID);
     if (fru == frus.end())
     {
-        return IPMI_CC_SENSOR_INVALID;
+        return ipmi::responseSensorInvalid();
     }
 
     /* Header */
@@ -774,9 +802,8 @@ ipmi_ret_t ipmi_fru_get_sdr(ipmi_request_t request, ipmi_response_t response,
     record.body.deviceTypeModifier = IPMIFruInventory;
 
     /* Device ID string */
-    auto deviceID =
-        fru->second[0].path.substr(fru->second[0].path.find_last_of('/') + 1,
-                                   fru->second[0].path.length());
+    const auto& fruPath = fru->second[0].path;
+    std::string deviceID(fruPath.substr(fruPath.find_last_of('/') + 1));
 
     if (deviceID.length() > get_sdr::FRU_RECORD_DEVICE_ID_MAX_LENGTH)
     {
@@ -791,6 +818,7 @@ ipmi_ret_t ipmi_fru_get_sdr(ipmi_request_t request, ipmi_response_t response,
     strncpy(record.body.deviceID, deviceID.c_str(),
             get_sdr::body::get_device_id_strlen(&(record.body)));
 
+    uint16_t nextRecordID;
     if (++fru == frus.end())
     {
         // we have reached till end of fru, so assign the next record id to
@@ -798,56 +826,46 @@ ipmi_ret_t ipmi_fru_get_sdr(ipmi_request_t request, ipmi_response_t response,
         const auto& entityRecords =
             ipmi::sensor::EntityInfoMapContainer::getContainer()
                 ->getIpmiEntityRecords();
-        auto next_record_id =
+        nextRecordID =
             (entityRecords.size())
                 ? entityRecords.begin()->first + ENTITY_RECORD_ID_START
                 : END_OF_RECORD;
-        get_sdr::response::set_next_record_id(next_record_id, resp);
     }
     else
     {
-        get_sdr::response::set_next_record_id(
-            (FRU_RECORD_ID_START + fru->first), resp);
-    }
-
-    // Check for invalid offset size
-    if (req->offset > sizeof(record))
-    {
-        return IPMI_CC_PARM_OUT_OF_RANGE;
+        nextRecordID = FRU_RECORD_ID_START + fru->first;
     }
 
-    dataLength = std::min(static_cast<size_t>(req->bytes_to_read),
-                          sizeof(record) - req->offset);
-
-    std::memcpy(resp->record_data,
-                reinterpret_cast<uint8_t*>(&record) + req->offset, dataLength);
-
-    *data_len = dataLength;
-    *data_len += 2; // additional 2 bytes for next record ID
-
-    return IPMI_CC_OK;
+    return sdrResponse(record, nextRecordID, offset, bytesToRead);
 }
 
-ipmi_ret_t ipmi_entity_get_sdr(ipmi_request_t request, ipmi_response_t response,
-                               ipmi_data_len_t data_len)
+static GetSdrResponse getEntitySdr(uint16_t recordID, uint8_t offset,
+                                   uint8_t bytesToRead)
 {
-    auto req = reinterpret_cast<get_sdr::GetSdrReq*>(request);
-    auto resp = reinterpret_cast<get_sdr::GetSdrResp*>(response);
     get_sdr::SensorDataEntityRecord record{};
-    auto dataLength = 0;
 
-    const auto& entityRecords =
-        ipmi::sensor::EntityInfoMapContainer::getContainer()
-            ->getIpmiEntityRecords();
-    auto entity = entityRecords.begin();
-    uint8_t entityRecordID;
-    auto recordID = get_sdr::request::get_record_id(req);
-
-    entityRecordID = recordID - ENTITY_RECORD_ID_START;
-    entity = entityRecords.find(entityRecordID);
+    auto container = ipmi::sensor::EntityInfoMapContainer::getContainer();
+    const auto& entityRecords = container->getIpmiEntityRecords();
+    uint8_t entityRecordID = recordID - ENTITY_RECORD_ID_START;
+    auto entity = entityRecords.find(entityRecordID);
     if (entity == entityRecords.end())
     {
-        return IPMI_CC_SENSOR_INVALID;
+        return ipmi::responseSensorInvalid();
+    }
+
+    // the records of a container are linked when it has more than one
+    bool isLinked = entity->second.isLinked;
+    auto [first, last] =
+        container->findEntity(entity->second.containerEntityId,
+                              entity->second.containerEntityInstance);
+    for (auto ref = first; !isLinked && ref != last; ref++)
+    {
+        const auto& other = entityRecords.at(ref->recordId);
+        isLinked = ref->recordId != entity->first &&
+                   other.containerEntityId ==
+                       entity->second.containerEntityId &&
+                   other.containerEntityInstance ==
+                       entity->second.containerEntityInstance;
     }
 
     /* Header */
@@ -859,8 +877,7 @@ ipmi_ret_t ipmi_entity_get_sdr(ipmi_request_t request, ipmi_response_t response,
     /* Key */
     record.key.containerEntityId = entity->second.containerEntityId;
     record.key.containerEntityInstance = entity->second.containerEntityInstance;
-    get_sdr::key::set_flags(entity->second.isList, entity->second.isLinked,
-                            &(record.key));
+    get_sdr::key::set_flags(entity->second.isList, isLinked, &(record.key));
     record.key.entityId1 = entity->second.containedEntities[0].first;
     record.key.entityInstance1 = entity->second.containedEntities[0].second;
 
@@ -872,48 +889,23 @@ ipmi_ret_t ipmi_entity_get_sdr(ipmi_request_t request, ipmi_response_t response,
     record.body.entityId4 = entity->second.containedEntities[3].first;
     record.body.entityInstance4 = entity->second.containedEntities[3].second;
 
-    if (++entity == entityRecords.end())
-    {
-        get_sdr::response::set_next_record_id(END_OF_RECORD,
-                                              resp); // last record
-    }
-    else
-    {
-        get_sdr::response::set_next_record_id(
-            (ENTITY_RECORD_ID_START + entity->first), resp);
-    }
-
-    // Check for invalid offset size
-    if (req->offset > sizeof(record))
+    uint16_t nextRecordID = END_OF_RECORD; // last record
+    if (++entity != entityRecords.end())
     {
-        return IPMI_CC_PARM_OUT_OF_RANGE;
+        nextRecordID = ENTITY_RECORD_ID_START + entity->first;
     }
 
-    dataLength = std::min(static_cast<size_t>(req->bytes_to_read),
-                          sizeof(record) - req->offset);
-
-    std::memcpy(resp->record_data,
-                reinterpret_cast<uint8_t*>(&record) + req->offset, dataLength);
-
-    *data_len = dataLength;
-    *data_len += 2; // additional 2 bytes for next record ID
-
-    return IPMI_CC_OK;
+    return sdrResponse(record, nextRecordID, offset, bytesToRead);
 }
 
-ipmi_ret_t ipmi_sen_get_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                            ipmi_request_t request, ipmi_response_t response,
-                            ipmi_data_len_t data_len, ipmi_context_t context)
+GetSdrResponse ipmiSensorGetSdr(uint16_t reservationID, uint16_t recordID,
+                                uint8_t offset, uint8_t bytesToRead)
 {
-    ipmi_ret_t ret = IPMI_CC_OK;
-    get_sdr::GetSdrReq* req = (get_sdr::GetSdrReq*)request;
-    get_sdr::GetSdrResp* resp = (get_sdr::GetSdrResp*)response;
     get_sdr::SensorDataFullRecord record = {0};
 
     // Note: we use an iterator so we can provide the next ID at the end of
     // the call.
     auto sensor = ipmi::sensor::sensors.begin();
-    auto recordID = get_sdr::request::get_record_id(req);
 
     // At the beginning of a scan, the host side will send us id=0.
     if (recordID != 0)
@@ -925,19 +917,19 @@ ipmi_ret_t ipmi_sen_get_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
         // record, FRU record and Enttiy Association record.
         if (recordID >= ENTITY_RECORD_ID_START)
         {
-            return ipmi_entity_get_sdr(request, response, data_len);
+            return getEntitySdr(recordID, offset, bytesToRead);
         }
         else if (recordID >= FRU_RECORD_ID_START &&
                  recordID < ENTITY_RECORD_ID_START)
         {
-            return ipmi_fru_get_sdr(request, response, data_len);
+            return getFruSdr(recordID, offset, bytesToRead);
         }
         else
         {
             sensor = ipmi::sensor::sensors.find(recordID);
             if (sensor == ipmi::sensor::sensors.end())
             {
-                return IPMI_CC_SENSOR_INVALID;
+                return ipmi::responseSensorInvalid();
             }
         }
     }
@@ -966,50 +958,252 @@ ipmi_ret_t ipmi_sen_get_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     }
 
     // Set the type-specific details given the DBus interface
-    ret =
-        populate_record_from_dbus(&(record.body), &(sensor->second), data_len);
+    populate_record_from_dbus(&(record.body), &(sensor->second));
 
+    uint16_t nextRecordID;
     if (++sensor == ipmi::sensor::sensors.end())
     {
         // we have reached till end of sensor, so assign the next record id
         // to 256(Max Sensor ID = 255) + FRU ID(may start with 0).
-        auto next_record_id = (frus.size())
-                                  ? frus.begin()->first + FRU_RECORD_ID_START
-                                  : END_OF_RECORD;
-
-        get_sdr::response::set_next_record_id(next_record_id, resp);
+        nextRecordID = (frus.size()) ? frus.begin()->first + FRU_RECORD_ID_START
+                                     : END_OF_RECORD;
     }
     else
     {
-        get_sdr::response::set_next_record_id(sensor->first, resp);
+        nextRecordID = sensor->first;
     }
 
-    if (req->offset > sizeof(record))
+    return sdrResponse(record, nextRecordID, offset, bytesToRead);
+}
+
+static bool isFromSystemChannel()
+{
+    // TODO we could not figure out where the request is from based on IPMI
+    // command handler parameters. because of it, we can not differentiate
+    // request from SMS/SMM or IPMB channel
+    return true;
+}
+
+/** @class PlatformEventQueue
+ *
+ *  Ingestion queue of the Platform Event messages. An event is answered as
+ *  soon as it is checked, and the queue is handed to the SEL in batches from
+ *  the io context. An event that repeats the last one taken for its sensor
+ *  within the dedup window is coalesced into it, any other event of the
+ *  sensor ends the repeat, so a deassertion and a new assertion are always
+ *  logged. The events beyond the rate limit are dropped, so a fault cascade
+ *  of the satellite controllers only logs a bounded number of entries. While
+ *  the queue is full the sender is answered Node Busy.
+ */
+class PlatformEventQueue
+{
+  public:
+    struct Event
+    {
+        uint16_t generatorID;
+        uint8_t sensorType;
+        uint8_t sensorNumber;
+        uint8_t eventDirectionType;
+        std::string sensorPath;
+        std::vector<uint8_t> eventData;
+    };
+
+    struct Stats
+    {
+        uint64_t received = 0;
+        uint64_t logged = 0;
+        uint64_t coalesced = 0;
+        uint64_t dropped = 0;
+    };
+
+    /** @brief take an event
+     *
+     *  @param[in] event - the event
+     *
+     *  @return false if the queue is full and the event was dropped
+     */
+    bool push(Event&& event)
+    {
+        stats.received++;
+        auto now = std::chrono::steady_clock::now();
+
+        SensorKey key{event.generatorID, event.sensorType,
+                      event.sensorNumber, event.sensorPath};
+        auto it = last.find(key);
+        if (it != last.end() && now - it->second.taken < dedupWindow &&
+            it->second.eventDirectionType == event.eventDirectionType &&
+            it->second.eventData == event.eventData)
+        {
+            stats.coalesced++;
+            return true;
+        }
+        if (queue.size() >= maxQueued)
+        {
+            stats.dropped++;
+            return false;
+        }
+        if (!takeToken(now))
+        {
+            stats.dropped++;
+            return true;
+        }
+        if (it == last.end())
+        {
+            if (last.size() >= maxSensors)
+            {
+                expire(now);
+            }
+            it = last.emplace(std::move(key), LastEvent{}).first;
+        }
+        it->second = {event.eventDirectionType, event.eventData, now};
+        queue.emplace_back(std::move(event));
+        if (queue.size() == 1)
+        {
+            schedule();
+        }
+        return true;
+    }
+
+    const Stats& getStats() const
+    {
+        return stats;
+    }
+
+    void resetStats()
+    {
+        stats = Stats{};
+    }
+
+  private:
+    /** @brief most events queued before Node Busy */
+    static constexpr size_t maxQueued = 256;
+    /** @brief most events handed to the SEL per batch */
+    static constexpr size_t maxBatch = 16;
+    /** @brief time a first event waits for others to join its batch */
+    static constexpr std::chrono::milliseconds batchDelay{20};
+    /** @brief time a repeat of an event is coalesced into it */
+    static constexpr std::chrono::milliseconds dedupWindow{1000};
+    /** @brief sensors whose last event is kept before the expired ones are
+     *         forgotten, over what the rate limit lets through in a window
+     */
+    static constexpr size_t maxSensors = 1024;
+    /** @brief events per second logged in the long run */
+    static constexpr double eventRate = 100;
+    /** @brief events logged in a burst over the rate */
+    static constexpr double eventBurst = 200;
+
+    using SensorKey = std::tuple<uint16_t, uint8_t, uint8_t, std::string>;
+    using Clock = std::chrono::steady_clock;
+
+    struct LastEvent
+    {
+        uint8_t eventDirectionType;
+        std::vector<uint8_t> eventData;
+        Clock::time_point taken;
+    };
+
+    /** @brief forget the last events that left the dedup window */
+    void expire(Clock::time_point now)
+    {
+        for (auto it = last.begin(); it != last.end();)
+        {
+            if (now - it->second.taken >= dedupWindow)
+            {
+                it = last.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /** @brief take a token of the rate limit, false when there is none */
+    bool takeToken(Clock::time_point now)
     {
-        return IPMI_CC_PARM_OUT_OF_RANGE;
+        std::chrono::duration<double> elapsed = now - refilled;
+        refilled = now;
+        tokens = std::min(eventBurst, tokens + elapsed.count() * eventRate);
+        if (tokens < 1)
+        {
+            return false;
+        }
+        tokens -= 1;
+        return true;
     }
 
-    // data_len will ultimately be the size of the record, plus
-    // the size of the next record ID:
-    *data_len = std::min(static_cast<size_t>(req->bytes_to_read),
-                         sizeof(record) - req->offset);
+    void schedule()
+    {
+        timer.expires_after(batchDelay);
+        timer.async_wait([this](const boost::system::error_code& ec) {
+            if (!ec)
+            {
+                flush();
+            }
+        });
+    }
 
-    std::memcpy(resp->record_data,
-                reinterpret_cast<uint8_t*>(&record) + req->offset, *data_len);
+    /** @brief hand the next batch of events to the SEL */
+    void flush()
+    {
+        for (size_t i = 0; i < maxBatch && !queue.empty(); i++)
+        {
+            const Event& event = queue.front();
+            bool assert = !(event.eventDirectionType & directionMask);
+            if (!ipmi::sel::addSystemEvent(
+                    event.sensorPath, std::vector<uint8_t>(event.eventData),
+                    assert, event.generatorID, event.sensorType,
+                    event.sensorNumber,
+                    event.eventDirectionType & ~directionMask))
+            {
+                // the SEL queue is full, try again with the next batch
+                break;
+            }
+            queue.pop_front();
+            stats.logged++;
+        }
+        if (!queue.empty())
+        {
+            schedule();
+        }
+    }
 
-    // data_len should include the LSB and MSB:
-    *data_len +=
-        sizeof(resp->next_record_id_lsb) + sizeof(resp->next_record_id_msb);
+    boost::asio::steady_timer timer{*getIoContext()};
+    std::deque<Event> queue;
+    std::map<SensorKey, LastEvent> last;
+    double tokens = eventBurst;
+    Clock::time_point refilled = Clock::now();
+    Stats stats;
+};
 
-    return ret;
+static PlatformEventQueue& getPlatformEventQueue()
+{
+    static PlatformEventQueue platformEventQueue;
+    return platformEventQueue;
 }
 
-static bool isFromSystemChannel()
+static std::shared_ptr<sdbusplus::asio::dbus_interface>
+    registerPlatformEventStatistics()
 {
-    // TODO we could not figure out where the request is from based on IPMI
-    // command handler parameters. because of it, we can not differentiate
-    // request from SMS/SMM or IPMB channel
-    return true;
+    constexpr auto statsPath =
+        "/xyz/openbmc_project/Ipmi/PlatformEventStatistics";
+    constexpr auto statsIntf =
+        "xyz.openbmc_project.Ipmi.PlatformEventStatistics";
+
+    std::shared_ptr<sdbusplus::asio::connection> bus = getSdBus();
+    // ipmid already serves the object manager
+    sdbusplus::asio::object_server server(bus, true);
+    auto statsIface = server.add_interface(statsPath, statsIntf);
+    statsIface->register_method("GetStatistics", []() {
+        const PlatformEventQueue::Stats& stats =
+            getPlatformEventQueue().getStats();
+        return std::make_tuple(stats.received, stats.logged, stats.coalesced,
+                               stats.dropped);
+    });
+    statsIface->register_method(
+        "Reset", []() { getPlatformEventQueue().resetStats(); });
+    statsIface->initialize();
+    return statsIface;
 }
 
 ipmi_ret_t ipmicmdPlatformEvent(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
@@ -1019,7 +1213,6 @@ ipmi_ret_t ipmicmdPlatformEvent(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
 {
     uint16_t generatorID;
     size_t count;
-    bool assert = true;
     std::string sensorPath;
     size_t paraLen = *dataLen;
     PlatformEventRequest* req;
@@ -1072,24 +1265,15 @@ ipmi_ret_t ipmicmdPlatformEvent(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     {
         count = 1;
     }
-    assert = req->eventDirectionType & directionMask ? false : true;
-    std::vector<uint8_t> eventData(req->data, req->data + count);
-
-    sdbusplus::bus::bus dbus(bus);
-    std::string service =
-        ipmi::getService(dbus, ipmiSELAddInterface, ipmiSELPath);
-    sdbusplus::message::message writeSEL = dbus.new_method_call(
-        service.c_str(), ipmiSELPath, ipmiSELAddInterface, "IpmiSelAdd");
-    writeSEL.append(ipmiSELAddMessage, sensorPath, eventData, assert,
-                    generatorID);
-    try
+    PlatformEventQueue::Event event{generatorID,
+                                    req->sensorType,
+                                    req->sensorNumber,
+                                    req->eventDirectionType,
+                                    std::move(sensorPath),
+                                    {req->data, req->data + count}};
+    if (!getPlatformEventQueue().push(std::move(event)))
     {
-        dbus.call(writeSEL);
-    }
-    catch (sdbusplus::exception_t& e)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(e.what());
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        return IPMI_CC_BUSY;
     }
     return IPMI_CC_OK;
 }
@@ -1099,6 +1283,7 @@ void register_netfn_sen_functions()
     // <Platform Event Message>
     ipmi_register_callback(NETFUN_SENSOR, IPMI_CMD_PLATFORM_EVENT, nullptr,
                            ipmicmdPlatformEvent, PRIVILEGE_OPERATOR);
+    static auto platformEventStatsIface = registerPlatformEventStatistics();
 
     // <Get Sensor Type>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnSensor,
@@ -1125,13 +1310,18 @@ void register_netfn_sen_functions()
                           ipmi::Privilege::User, ipmiSensorGetDeviceSdrInfo);
 
     // <Get Device SDR>
-    ipmi_register_callback(NETFUN_SENSOR, IPMI_CMD_GET_DEVICE_SDR, nullptr,
-                           ipmi_sen_get_sdr, PRIVILEGE_USER);
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnSensor,
+                          ipmi::sensor_event::cmdGetDeviceSdr,
+                          ipmi::Privilege::User, ipmiSensorGetSdr);
 
     // <Get Sensor Thresholds>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnSensor,
                           ipmi::sensor_event::cmdGetSensorThreshold,
                           ipmi::Privilege::User, ipmiSensorGetSensorThresholds);
 
+    // load the entity map before the first SDR request needs it
+    post_work(
+        []() { ipmi::sensor::EntityInfoMapContainer::getContainer(); });
+
     return;
 }
@@ -79,6 +79,8 @@ struct PlatformEventRequest
     uint8_t data[3];
 };
 
+static constexpr char const* ipmiSELService =
+    "xyz.openbmc_project.Logging.IPMI";
 static constexpr char const* ipmiSELPath = "/xyz/openbmc_project/Logging/IPMI";
 static constexpr char const* ipmiSELAddInterface =
     "xyz.openbmc_project.Logging.IPMI";
@@ -96,9 +98,20 @@ int set_sensor_dbus_state_s(uint8_t, const char*, const char*);
 int set_sensor_dbus_state_y(uint8_t, const char*, const uint8_t);
 int find_openbmc_path(uint8_t, dbus_interface_t*);
 
-ipmi_ret_t ipmi_sen_get_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                            ipmi_request_t request, ipmi_response_t response,
-                            ipmi_data_len_t data_len, ipmi_context_t context);
+/** @brief implements the Get SDR and Get Device SDR commands
+ *  @param reservationID - SDR reservation ID, not checked
+ *  @param recordID - record ID, 0000h for the first record
+ *  @param offset - offset into the record
+ *  @param bytesToRead - bytes to read, FFh for the rest of the record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - nextRecordID - record ID of the next record, FFFFh for the last one
+ *   - data - record data
+ */
+ipmi::RspType<uint16_t,            // next record ID
+              std::vector<uint8_t>> // record data
+    ipmiSensorGetSdr(uint16_t reservationID, uint16_t recordID,
+                     uint8_t offset, uint8_t bytesToRead);
 
 ipmi::RspType<uint16_t> ipmiSensorReserveSdr();
 
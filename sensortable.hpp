@@ -0,0 +1,223 @@
+#pragma once
+
+#include "statictable.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ipmid/types.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ipmi
+{
+namespace sensor
+{
+
+/** @struct StaticInfo
+ *
+ *  Literal counterpart of Info, the sensor YAML generator emits these in
+ *  constexpr tables. Strings are views of string literals, the sensor
+ *  functions are plain function pointers and the property interfaces are
+ *  built by a generated function when they are first needed.
+ */
+struct StaticInfo
+{
+    Id id;
+    EntityType entityType;
+    EntityInst instance;
+    Type sensorType;
+    std::string_view sensorPath;
+    std::string_view sensorInterface;
+    ReadingType sensorReadingType;
+    Multiplier coefficientM;
+    OffsetB coefficientB;
+    Exponent exponentB;
+    ScaledOffset scaledOffset;
+    Exponent exponentR;
+    bool hasScale;
+    Scale scale;
+    std::string_view unit;
+    uint8_t (*updateFunc)(const SetSensorReadingReq&, const Info&);
+    GetSensorResponse (*getFunc)(const Info&);
+    Mutability mutability;
+    std::string_view sensorName;
+    SensorName (*sensorNameFunc)(const Info&);
+    DbusInterfaceMap (*propertyInterfaces)();
+};
+
+/** @class SensorTable
+ *
+ *  Sensors of the sensor YAML as a constexpr array of StaticInfo sorted by
+ *  sensor number, with an index from sensor number to array position, so
+ *  the table needs no static initialization and a lookup is one array
+ *  access. An Info is built from its StaticInfo the first time the sensor
+ *  is looked up and kept for the life of the process, the sensor functions
+ *  take an Info.
+ *
+ *  Provides the part of the IdInfoMap interface the sensor handlers use.
+ */
+class SensorTable
+{
+  public:
+    using value_type = std::pair<const Id, Info>;
+    using Index = std::array<uint16_t, 256>;
+
+    static constexpr uint16_t noSensor = 0xFFFF;
+
+    class const_iterator
+    {
+      public:
+        const_iterator(const SensorTable* table, size_t pos) :
+            table(table), pos(pos)
+        {
+        }
+
+        const value_type& operator*() const
+        {
+            return table->at(pos);
+        }
+
+        const value_type* operator->() const
+        {
+            return &table->at(pos);
+        }
+
+        const_iterator& operator++()
+        {
+            pos++;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            pos++;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return pos == other.pos;
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return pos != other.pos;
+        }
+
+      private:
+        const SensorTable* table;
+        size_t pos;
+    };
+    using iterator = const_iterator;
+
+    /** @brief build the index of a generated table
+     *
+     *  @param[in] infos - sensors sorted by sensor number
+     *
+     *  @return the array position of every sensor number, noSensor if the
+     *          sensor does not exist
+     */
+    template <size_t N>
+    static constexpr Index makeIndex(const std::array<StaticInfo, N>& infos)
+    {
+        Index index{};
+        for (size_t id = 0; id < index.size(); id++)
+        {
+            index[id] = noSensor;
+        }
+        for (size_t pos = 0; pos < N; pos++)
+        {
+            index[infos[pos].id] = static_cast<uint16_t>(pos);
+        }
+        return index;
+    }
+
+    /** @brief constructs a table on a generated array
+     *
+     *  @param[in] infos - sensors sorted by sensor number
+     *  @param[in] count - number of sensors
+     *  @param[in] index - index made by makeIndex
+     *  @param[in] cache - storage for count Info, empty
+     */
+    constexpr SensorTable(const StaticInfo* infos, size_t count,
+                          const Index& index,
+                          std::optional<value_type>* cache) :
+        infos(infos),
+        count(count), index(index), cache(cache)
+    {
+    }
+
+    const_iterator begin() const
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const
+    {
+        return {this, count};
+    }
+
+    const_iterator find(Id id) const
+    {
+        uint16_t pos = index[id];
+        return {this, pos == noSensor ? count : pos};
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+  private:
+    const value_type& at(size_t pos) const
+    {
+        std::optional<value_type>& entry = cache[pos];
+        if (!entry)
+        {
+            const StaticInfo& info = infos[pos];
+            entry.emplace(
+                info.id,
+                Info{info.entityType,
+                     info.instance,
+                     info.sensorType,
+                     std::string(info.sensorPath),
+                     std::string(info.sensorInterface),
+                     info.sensorReadingType,
+                     info.coefficientM,
+                     info.coefficientB,
+                     info.exponentB,
+                     info.scaledOffset,
+                     info.exponentR,
+                     info.hasScale,
+                     info.scale,
+                     std::string(info.unit),
+                     info.updateFunc,
+                     info.getFunc,
+                     info.mutability,
+                     std::string(info.sensorName),
+                     info.sensorNameFunc,
+                     info.propertyInterfaces()});
+        }
+        return *entry;
+    }
+
+    const StaticInfo* infos;
+    size_t count;
+    Index index;
+    std::optional<value_type>* cache;
+};
+
+#ifdef STATIC_SENSOR_TABLE
+using SensorMap = SensorTable;
+using InvSensorMap = SortedTable<std::string_view, SelData>;
+#else
+using SensorMap = IdInfoMap;
+using InvSensorMap = InvObjectIDMap;
+#endif
+
+} // namespace sensor
+} // namespace ipmi
@@ -1,5 +1,6 @@
 #include "settings.hpp"
 
+#include <ipmid/mapper.hpp>
 #include <ipmid/utils.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
@@ -12,32 +13,11 @@ namespace settings
 using namespace phosphor::logging;
 using namespace sdbusplus::xyz::openbmc_project::Common::Error;
 
-constexpr auto mapperService = "xyz.openbmc_project.ObjectMapper";
-constexpr auto mapperPath = "/xyz/openbmc_project/object_mapper";
-constexpr auto mapperIntf = "xyz.openbmc_project.ObjectMapper";
-
 Objects::Objects(sdbusplus::bus::bus& bus,
                  const std::vector<Interface>& filter) :
     bus(bus)
 {
-    auto depth = 0;
-
-    auto mapperCall = bus.new_method_call(mapperService, mapperPath, mapperIntf,
-                                          "GetSubTree");
-    mapperCall.append(root);
-    mapperCall.append(depth);
-    mapperCall.append(filter);
-    auto response = bus.call(mapperCall);
-    if (response.is_method_error())
-    {
-        log<level::ERR>("Error in mapper GetSubTree");
-        elog<InternalFailure>();
-    }
-
-    using Interfaces = std::vector<Interface>;
-    using MapperResponse = std::map<Path, std::map<Service, Interfaces>>;
-    MapperResponse result;
-    response.read(result);
+    ipmi::ObjectTree result = ipmi::mapper::getSubTree(bus, root, 0, filter);
     if (result.empty())
     {
         log<level::ERR>("Invalid response from mapper");
@@ -47,7 +27,7 @@ Objects::Objects(sdbusplus::bus::bus& bus,
     for (auto& iter : result)
     {
         const auto& path = iter.first;
-        for (auto& interface : iter.second.begin()->second)
+        for (const auto& interface : iter.second.begin()->second)
         {
             auto found = map.find(interface);
             if (map.end() != found)
@@ -57,7 +37,7 @@ Objects::Objects(sdbusplus::bus::bus& bus,
             }
             else
             {
-                map.emplace(std::move(interface), std::vector<Path>({path}));
+                map.emplace(interface, std::vector<Path>({path}));
             }
         }
     }
@@ -65,39 +45,66 @@ Objects::Objects(sdbusplus::bus::bus& bus,
 
 Service Objects::service(const Path& path, const Interface& interface) const
 {
-    using Interfaces = std::vector<Interface>;
-    auto mapperCall =
-        bus.new_method_call(mapperService, mapperPath, mapperIntf, "GetObject");
-    mapperCall.append(path);
-    mapperCall.append(Interfaces({interface}));
-
-    auto response = bus.call(mapperCall);
-    if (response.is_method_error())
+    auto key = std::make_pair(path, interface);
+    auto cached = serviceCache->services.find(key);
+    if (cached != serviceCache->services.end())
     {
-        log<level::ERR>("Error in mapper GetObject");
-        elog<InternalFailure>();
+        return cached->second;
     }
 
-    std::map<Service, Interfaces> result;
-    response.read(result);
+    ipmi::mapper::ServiceMap result =
+        ipmi::mapper::getObject(bus, path, {interface});
     if (result.empty())
     {
         log<level::ERR>("Invalid response from mapper");
         elog<InternalFailure>();
     }
 
-    return result.begin()->first;
+    if (!serviceCache->ownerMatch)
+    {
+        ServiceCache* cache = serviceCache.get();
+        serviceCache->ownerMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, sdbusplus::bus::match::rules::nameOwnerChanged(),
+            [cache](sdbusplus::message::message& msg) {
+                std::string name, oldOwner, newOwner;
+                try
+                {
+                    msg.read(name, oldOwner, newOwner);
+                }
+                catch (const std::exception& e)
+                {
+                    return;
+                }
+                if (!newOwner.empty())
+                {
+                    return;
+                }
+                for (auto it = cache->services.begin();
+                     it != cache->services.end();)
+                {
+                    if (it->second == name || it->second == oldOwner)
+                    {
+                        it = cache->services.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            });
+    }
+    return serviceCache->services.emplace(key, result.begin()->first)
+        .first->second;
 }
 
 namespace boot
 {
 
-std::tuple<Path, OneTimeEnabled> setting(const Objects& objects,
-                                         const Interface& iface)
+std::tuple<Path, Path> settingPaths(const Objects& objects,
+                                    const Interface& iface)
 {
     constexpr auto bootObjCount = 2;
     constexpr auto oneTime = "one_time";
-    constexpr auto enabledIntf = "xyz.openbmc_project.Object.Enable";
 
     const std::vector<Path>& paths = objects.map.at(iface);
     auto count = paths.size();
@@ -113,8 +120,15 @@ std::tuple<Path, OneTimeEnabled> setting(const Objects& objects,
     {
         index = 1;
     }
-    const Path& oneTimeSetting = paths[index];
-    const Path& regularSetting = paths[!index];
+    return std::make_tuple(paths[index], paths[!index]);
+}
+
+std::tuple<Path, OneTimeEnabled> setting(const Objects& objects,
+                                         const Interface& iface)
+{
+    constexpr auto enabledIntf = "xyz.openbmc_project.Object.Enable";
+
+    const auto [oneTimeSetting, regularSetting] = settingPaths(objects, iface);
 
     auto method = objects.bus.new_method_call(
         objects.service(oneTimeSetting, iface).c_str(), oneTimeSetting.c_str(),
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <map>
+#include <memory>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace settings
 {
@@ -32,9 +37,9 @@ struct Objects
     Objects& operator=(Objects&&) = delete;
     ~Objects() = default;
 
-    /** @brief Fetch d-bus service, given a path and an interface. The
-     *         service can't be cached because mapper returns unique
-     *         service names.
+    /** @brief Fetch d-bus service, given a path and an interface. Mapper
+     *         returns unique service names, so a service is kept until
+     *         its name leaves the bus. Copies share the kept services.
      *
      * @param[in] path - The Dbus object
      * @param[in] interface - The Dbus interface
@@ -48,6 +53,17 @@ struct Objects
 
     /** @brief The Dbus bus object */
     sdbusplus::bus::bus& bus;
+
+  private:
+    struct ServiceCache
+    {
+        std::map<std::pair<Path, Interface>, Service> services;
+        /** @brief drops the services whose name leaves the bus */
+        std::unique_ptr<sdbusplus::bus::match_t> ownerMatch;
+    };
+
+    std::shared_ptr<ServiceCache> serviceCache =
+        std::make_shared<ServiceCache>();
 };
 
 namespace boot
@@ -55,6 +71,17 @@ namespace boot
 
 using OneTimeEnabled = bool;
 
+/** @brief Return the one-time and the regular boot setting object paths.
+ *
+ * @param[in] objects - const reference to an object of type Objects
+ * @param[in] iface - boot setting interface
+ *
+ * @return A tuple - one-time boot setting object path, regular boot setting
+ *                   object path.
+ */
+std::tuple<Path, Path> settingPaths(const Objects& objects,
+                                    const Interface& iface);
+
 /** @brief Return the one-time boot setting object path if enabled, otherwise
  *         the regular boot setting object path.
  *
@@ -16,13 +16,23 @@
 
 #include "smbiosmdrv2handler.hpp"
 
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <ipmid/api.hpp>
 #include <ipmid/utils.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <xyz/openbmc_project/Common/error.hpp>
-#include <fstream>
 
 std::unique_ptr<MDRV2> mdrv2 = nullptr;
 
@@ -78,30 +88,106 @@ void MDRV2::RestartMDRV2()
     bus->call_noreply(method);
 }
 
-bool MDRV2::storeDatatoFlash(MDRSMBIOSHeader *mdrHdr, uint8_t *data)
+/** @brief have the MDRV2 service load the new SMBIOS table file, restarting
+ *  it only if it does not answer the synchronize request
+ */
+void MDRV2::syncMDRV2(const std::string &service)
+{
+    std::shared_ptr<sdbusplus::asio::connection> bus = getSdBus();
+    sdbusplus::message::message method = bus->new_method_call(
+        service.c_str(), mdrv2Path, mdrv2Interface, "AgentSynchronizeData");
+    try
+    {
+        bool synced = false;
+        bus->call(method).read(synced);
+        if (synced)
+        {
+            return;
+        }
+    }
+    catch (const sdbusplus::exception::SdBusError &e)
+    {
+        phosphor::logging::log<phosphor::logging::level::WARNING>(
+            "MDRV2 synchronize failed, restarting the service",
+            phosphor::logging::entry("ERROR=%s", e.what()));
+    }
+    RestartMDRV2();
+}
+
+static size_t hashTable(const MDRSMBIOSHeader *mdrHdr, const uint8_t *data)
+{
+    std::hash<std::string_view> hash;
+    size_t headerHash = hash(std::string_view(
+        reinterpret_cast<const char *>(mdrHdr), sizeof(MDRSMBIOSHeader)));
+    size_t dataHash = hash(std::string_view(
+        reinterpret_cast<const char *>(data), mdrHdr->dataSize));
+    return headerHash ^ (dataHash + 0x9e3779b9 + (headerHash << 6) +
+                         (headerHash >> 2));
+}
+
+/** @brief checks if the table file already holds this header and table, so
+ *  the BIOS sending the same table on every boot costs no flash write
+ */
+bool MDRV2::isStoredTable(const MDRSMBIOSHeader *mdrHdr, const uint8_t *data)
 {
-    std::ofstream smbiosFile(mdrType2File,
-                             std::ios_base::binary | std::ios_base::trunc);
-    if (!smbiosFile.good())
+    if (!storedTableHash)
+    {
+        std::ifstream smbiosFile(mdrType2File, std::ios_base::binary);
+        MDRSMBIOSHeader storedHdr;
+        if (!smbiosFile.read(reinterpret_cast<char *>(&storedHdr),
+                             sizeof(storedHdr)) ||
+            storedHdr.dataSize > smbiosTableStorageSize)
+        {
+            return false;
+        }
+        std::vector<uint8_t> storedData(storedHdr.dataSize);
+        if (!smbiosFile.read(reinterpret_cast<char *>(storedData.data()),
+                             storedData.size()))
+        {
+            return false;
+        }
+        storedTableHash = hashTable(&storedHdr, storedData.data());
+    }
+    return *storedTableHash == hashTable(mdrHdr, data);
+}
+
+bool MDRV2::storeDatatoFlash(MDRSMBIOSHeader *mdrHdr, const uint8_t *data)
+{
+    // written straight from the shared memory, to a temporary file that
+    // replaces the table so the service never reads a partial one
+    const std::string tmpFile = std::string(mdrType2File) + "_tmp";
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR);
+    if (fd < 0)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "Write data from flash error - Open MDRV2 table file failure");
         return false;
     }
 
-    try
+    iovec parts[] = {{mdrHdr, sizeof(MDRSMBIOSHeader)},
+                     {const_cast<uint8_t *>(data), mdrHdr->dataSize}};
+    size_t total = sizeof(MDRSMBIOSHeader) + mdrHdr->dataSize;
+    ssize_t written = writev(fd, parts, 2);
+    int err = errno;
+    close(fd);
+    if (written != static_cast<ssize_t>(total))
     {
-        smbiosFile.write(reinterpret_cast<char *>(mdrHdr),
-                         sizeof(MDRSMBIOSHeader));
-        smbiosFile.write(reinterpret_cast<char *>(data), mdrHdr->dataSize);
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "Write data from flash error - write data error",
+            phosphor::logging::entry("ERRNO=%d", err));
+        unlink(tmpFile.c_str());
+        return false;
     }
-    catch (std::ofstream::failure &e)
+    storedTableHash.reset();
+    if (std::rename(tmpFile.c_str(), mdrType2File) != 0)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Write data from flash error - write data error",
-            phosphor::logging::entry("ERROR=%s", e.what()));
+            "Write data from flash error - rename table file failure");
+        unlink(tmpFile.c_str());
         return false;
     }
+    storedTableHash = hashTable(mdrHdr, data);
 
     return true;
 }
@@ -120,25 +206,33 @@ ipmi::RspType<> cmd_mdr2_get_mbox_shared_mem()
         mdrv2 = std::make_unique<MDRV2>();
     }
 
-    try
+    // the mailbox stays mapped from one transfer to the next
+    if (!mdrv2->area)
     {
-        mdrv2->area =
-            std::make_unique<SharedMemoryArea>(MboxAddress, MboxLength);
-    }
-    catch (const std::system_error &e)
-    {
-        return ipmi::responseUnspecifiedError();
+        try
+        {
+            mdrv2->area =
+                std::make_unique<SharedMemoryArea>(MboxAddress, MboxLength);
+        }
+        catch (const std::system_error &e)
+        {
+            return ipmi::responseUnspecifiedError();
+        }
     }
 
-    std::vector<std::uint8_t> results(MboxLength);
-    std::memcpy(results.data(), mdrv2->area->vPtr, MboxLength);
-
-    mdrv2->area.reset(nullptr);
     MDRSMBIOSHeader mdr2Smbios;
     mdr2Smbios.mdrType = mdrTypeII;
     mdr2Smbios.dirVer = mdrv2->smbiosDir.dir[0].common.dataVersion;
     mdr2Smbios.timestamp = mdrv2->smbiosDir.dir[0].common.timestamp;
-    mdr2Smbios.dataSize = mdrv2->smbiosDir.dir[0].common.size;
+    mdr2Smbios.dataSize =
+        std::min(mdrv2->smbiosDir.dir[0].common.size, MboxLength);
+
+    const uint8_t *data = static_cast<const uint8_t *>(mdrv2->area->vPtr);
+    if (mdrv2->isStoredTable(&mdr2Smbios, data))
+    {
+        // nothing changed, the service already has this table
+        return ipmi::responseSuccess();
+    }
 
     if (access(smbiosPath, 0) == -1)
     {
@@ -149,14 +243,14 @@ ipmi::RspType<> cmd_mdr2_get_mbox_shared_mem()
                 "create folder failed for writting smbios file");
         }
     }
-    if (!mdrv2->storeDatatoFlash(&mdr2Smbios, results.data()))
+    if (!mdrv2->storeDatatoFlash(&mdr2Smbios, data))
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "MDR2 Store data to flash failed");
         return ipmi::responseDestinationUnavailable();
     }
 
-    mdrv2->RestartMDRV2();
+    mdrv2->syncMDRV2(service);
     return ipmi::responseSuccess();
 }
 
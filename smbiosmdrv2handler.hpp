@@ -20,9 +20,11 @@
 #include <sys/mman.h>
 
 #include <oemcommands.hpp>
+#include <optional>
 #include <sdbusplus/timer.hpp>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/message/types.hpp>
+#include <string>
 
 static constexpr const uint32_t MboxAddress = 0xF0848000;
 static constexpr const uint32_t MboxLength  = 0x4000;
@@ -271,7 +273,9 @@ class MDRV2
     }
 
     void RestartMDRV2();
-    bool storeDatatoFlash(MDRSMBIOSHeader *mdrHdr, uint8_t *data);
+    void syncMDRV2(const std::string &service);
+    bool storeDatatoFlash(MDRSMBIOSHeader *mdrHdr, const uint8_t *data);
+    bool isStoredTable(const MDRSMBIOSHeader *mdrHdr, const uint8_t *data);
     void timeoutHandler();
 
     Mdr2DirStruct smbiosDir{smbiosAgentVersion,
@@ -313,4 +317,7 @@ class MDRV2
   private:
     uint8_t lockIndex = 0;
     uint8_t smbiosTableStorage[smbiosTableStorageSize];
+    // hash of the header and table in mdrType2File, read from the file the
+    // first time it is needed
+    std::optional<size_t> storedTableHash;
 };
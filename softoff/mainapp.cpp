@@ -17,18 +17,55 @@
 
 #include "softoff.hpp"
 
+#include <algorithm>
+#include <memory>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/exception.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include <xyz/openbmc_project/State/Host/error.hpp>
 
+/** @brief the SoftPowerOff object of a host, host 0 keeps the path ipmid
+ *         sends its Host Shutdown response to
+ */
+static std::string objectPath(unsigned int hostId)
+{
+    return hostId == 0 ? std::string{SOFTOFF_OBJPATH}
+                       : phosphor::ipmi::hostPath(SOFTOFF_OBJPATH, hostId);
+}
+
+// Powers off the hosts given on the command line, host 0 without any, all at
+// once: each host acknowledges and times out on its own and the application
+// exits once every host is done.
 // Return -1 on any errors to ensure we follow the calling targets OnFailure=
 // path
 int main(int argc, char** argv)
 {
     using namespace phosphor::logging;
 
+    std::vector<unsigned int> hostIds;
+    for (int i = 1; i < argc; i++)
+    {
+        try
+        {
+            hostIds.push_back(std::stoul(argv[i]));
+        }
+        catch (const std::logic_error&)
+        {
+            log<level::ERR>("Invalid host id", entry("HOST=%s", argv[i]));
+            return -1;
+        }
+    }
+    if (hostIds.empty())
+    {
+        hostIds.push_back(0);
+    }
+    std::sort(hostIds.begin(), hostIds.end());
+    hostIds.erase(std::unique(hostIds.begin(), hostIds.end()), hostIds.end());
+
     // Get a handle to system dbus.
     auto bus = sdbusplus::bus::new_default();
 
@@ -46,12 +83,41 @@ int main(int argc, char** argv)
     // message as a response to ack from host.
     bus.request_name(SOFTOFF_BUSNAME);
 
-    // Create the SoftPowerOff object.
-    phosphor::ipmi::SoftPowerOff powerObj(bus, event.get(), SOFTOFF_OBJPATH);
+    // Create the SoftPowerOff objects, each sends its host the shutdown
+    // command right away
+    // the objects keep the path they are given, it must not move
+    std::vector<std::string> paths;
+    paths.reserve(hostIds.size());
+    std::vector<std::unique_ptr<phosphor::ipmi::SoftPowerOff>> powerObjs;
+    bool failed = false;
+    for (unsigned int hostId : hostIds)
+    {
+        paths.push_back(objectPath(hostId));
+        try
+        {
+            powerObjs.push_back(std::make_unique<phosphor::ipmi::SoftPowerOff>(
+                bus, event.get(), paths.back().c_str(), hostId));
+        }
+        catch (const std::exception& e)
+        {
+            log<level::ERR>("Failed to start host soft power off",
+                            entry("HOST=%u", hostId),
+                            entry("ERROR=%s", e.what()));
+            failed = true;
+        }
+    }
 
-    // Wait for client requests until this application has processed
-    // at least one successful SoftPowerOff or we timed out
-    while (!powerObj.isCompleted() && !powerObj.isTimerExpired())
+    auto pending = [&powerObjs]() {
+        return std::any_of(powerObjs.begin(), powerObjs.end(),
+                           [](const auto& powerObj) {
+                               return !powerObj->isCompleted() &&
+                                      !powerObj->isTimerExpired();
+                           });
+    };
+
+    // Wait for client requests until every host has processed at least one
+    // successful SoftPowerOff or timed out
+    while (pending())
     {
         try
         {
@@ -65,18 +131,36 @@ int main(int argc, char** argv)
         }
     }
 
-    // Log an error if we timed out after getting Ack for SMS_ATN and before
-    // getting the Host Shutdown response
-    if (powerObj.isTimerExpired() &&
-        (powerObj.responseReceived() ==
-         phosphor::ipmi::Base::SoftPowerOff::HostResponse::SoftOffReceived))
+    size_t timedOut = 0;
+    for (const auto& powerObj : powerObjs)
+    {
+        if (!powerObj->isTimerExpired())
+        {
+            continue;
+        }
+        powerObj->logPhases("Timeout");
+
+        // Log an error if we timed out after getting Ack for SMS_ATN and
+        // before getting the Host Shutdown response
+        if (powerObj->responseReceived() ==
+            phosphor::ipmi::Base::SoftPowerOff::HostResponse::SoftOffReceived)
+        {
+            using error = sdbusplus::xyz::openbmc_project::State::Host::Error::
+                SoftOffTimeout;
+            using errorMetadata =
+                xyz::openbmc_project::State::Host::SoftOffTimeout;
+            report<error>(prev_entry<errorMetadata::TIMEOUT_IN_MSEC>());
+            timedOut++;
+        }
+    }
+
+    if (hostIds.size() > 1)
     {
-        using error =
-            sdbusplus::xyz::openbmc_project::State::Host::Error::SoftOffTimeout;
-        using errorMetadata = xyz::openbmc_project::State::Host::SoftOffTimeout;
-        report<error>(prev_entry<errorMetadata::TIMEOUT_IN_MSEC>());
-        return -1;
+        log<level::INFO>("Soft power off of all hosts done",
+                         entry("HOSTS=%zu", hostIds.size()),
+                         entry("FAILED=%zu", hostIds.size() - powerObjs.size()),
+                         entry("TIMED_OUT=%zu", timedOut));
     }
 
-    return 0;
+    return failed || timedOut ? -1 : 0;
 }
@@ -21,6 +21,8 @@
 #include <ipmid/utils.hpp>
 #include <phosphor-logging/log.hpp>
 #include <xyz/openbmc_project/Control/Host/server.hpp>
+#include <xyz/openbmc_project/Control/Power/ACPIPowerState/server.hpp>
+#include <xyz/openbmc_project/State/Host/server.hpp>
 namespace phosphor
 {
 namespace ipmi
@@ -28,11 +30,46 @@ namespace ipmi
 
 using namespace phosphor::logging;
 using namespace sdbusplus::xyz::openbmc_project::Control::server;
+namespace State = sdbusplus::xyz::openbmc_project::State::server;
+using ACPIPowerState =
+    sdbusplus::xyz::openbmc_project::Control::Power::server::ACPIPowerState;
+
+/** @brief reads the properties of a PropertiesChanged signal */
+static ::ipmi::PropertyMap changedProperties(sdbusplus::message::message& msg)
+{
+    std::string interface;
+    ::ipmi::PropertyMap properties;
+    try
+    {
+        msg.read(interface, properties);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        log<level::ERR>("Failed to read changed properties",
+                        entry("ERROR=%s", e.what()));
+        properties.clear();
+    }
+    return properties;
+}
+
+/** @brief the value of a changed string property, empty when it did not
+ *         change
+ */
+static std::string changedString(const ::ipmi::PropertyMap& properties,
+                                 const std::string& name)
+{
+    auto property = properties.find(name);
+    if (property == properties.end())
+    {
+        return {};
+    }
+    const auto* value = std::get_if<std::string>(&property->second);
+    return value ? *value : std::string{};
+}
 
 void SoftPowerOff::sendHostShutDownCmd()
 {
-    auto ctrlHostPath =
-        std::string{CONTROL_HOST_OBJ_MGR} + '/' + HOST_NAME + '0';
+    auto ctrlHostPath = hostPath(CONTROL_HOST_OBJ_MGR, hostId);
     auto host = ::ipmi::getService(this->bus, CONTROL_HOST_BUSNAME,
                                    ctrlHostPath.c_str());
 
@@ -66,6 +103,8 @@ void SoftPowerOff::hostControlEvent(sdbusplus::message::message& msg)
 
     if (Host::convertResultFromString(cmdStatus) == Host::Result::Success)
     {
+        acked = Clock::now();
+
         // Set our internal property indicating we got host attention
         sdbusplus::xyz::openbmc_project::Ipmi::Internal ::server::SoftPowerOff::
             responseReceived(HostResponse::SoftOffReceived);
@@ -94,8 +133,10 @@ void SoftPowerOff::hostControlEvent(sdbusplus::message::message& msg)
     {
         // An error on the initial attention is not considered an error, just
         // exit normally and allow remaining shutdown targets to run
-        log<level::INFO>("Timeout on host attention, continue with power down");
+        log<level::INFO>("Timeout on host attention, continue with power down",
+                         entry("HOST=%u", hostId));
         completed = true;
+        logPhases("NoHostAttention");
     }
     return;
 }
@@ -106,12 +147,124 @@ int SoftPowerOff::startTimer(const std::chrono::microseconds& usec)
     return timer.start(usec);
 }
 
+// Host is done before telling us so, no need to wait for the timer
+void SoftPowerOff::completeEarly(const char* outcome)
+{
+    if (completed)
+    {
+        return;
+    }
+    if (acked)
+    {
+        auto r = timer.stop();
+        if (r < 0)
+        {
+            log<level::ERR>("Failure to STOP the timer",
+                            entry("ERRNO=0x%X", -r));
+        }
+    }
+    completed = true;
+    logPhases(outcome);
+}
+
+// Host state changes, Off means the host no longer runs
+void SoftPowerOff::hostStateEvent(sdbusplus::message::message& msg)
+{
+    auto state = changedString(changedProperties(msg), "CurrentHostState");
+    if (state == State::convertForMessage(State::Host::HostState::Off))
+    {
+        completeEarly("HostOff");
+    }
+}
+
+// ACPI state changes, set by the host through Set ACPI Power State. Only a
+// change seen after the shutdown command counts, the state left over from
+// the last shutdown must not end this one.
+void SoftPowerOff::acpiStateEvent(sdbusplus::message::message& msg)
+{
+    auto state = changedString(changedProperties(msg), "SysACPIStatus");
+    if (state.empty())
+    {
+        return;
+    }
+    try
+    {
+        switch (ACPIPowerState::convertACPIFromString(state))
+        {
+            case ACPIPowerState::ACPI::S5_G2:
+            case ACPIPowerState::ACPI::S4_S5:
+            case ACPIPowerState::ACPI::G3:
+            case ACPIPowerState::ACPI::LEGACY_OFF:
+                completeEarly("HostACPIOff");
+                break;
+            default:
+                break;
+        }
+    }
+    catch (const sdbusplus::exception::InvalidEnumString&)
+    {
+        log<level::ERR>("Unknown ACPI power state",
+                        entry("STATE=%s", state.c_str()));
+    }
+}
+
+// Host watchdog changes. While the host shuts down they show it is still
+// alive; the watchdog expiring means it stopped before telling us it is
+// done, so there is nothing left to wait for.
+void SoftPowerOff::watchdogEvent(sdbusplus::message::message& msg)
+{
+    if (!acked || completed)
+    {
+        return;
+    }
+    // the host clearing the expiration flags sets it back to Reserved
+    constexpr auto notExpired =
+        "xyz.openbmc_project.State.Watchdog.TimerUse.Reserved";
+    auto properties = changedProperties(msg);
+    auto expired = changedString(properties, "ExpiredTimerUse");
+    if (!expired.empty() && expired != notExpired)
+    {
+        log<level::ERR>("Host watchdog expired during soft power off",
+                        entry("HOST=%u", hostId));
+        completeEarly("HostWatchdogExpired");
+        return;
+    }
+    if (!properties.empty())
+    {
+        hostActivity++;
+    }
+}
+
+void SoftPowerOff::logPhases(const char* outcome)
+{
+    using namespace std::chrono;
+
+    auto now = Clock::now();
+    auto msec = [](Clock::duration d) {
+        return static_cast<unsigned long long>(
+            duration_cast<milliseconds>(d).count());
+    };
+    if (!acked)
+    {
+        log<level::INFO>("Soft power off phases", entry("HOST=%u", hostId),
+                         entry("OUTCOME=%s", outcome),
+                         entry("TOTAL_MSEC=%llu", msec(now - sent)));
+        return;
+    }
+    log<level::INFO>("Soft power off phases", entry("HOST=%u", hostId),
+                     entry("OUTCOME=%s", outcome),
+                     entry("ACK_MSEC=%llu", msec(*acked - sent)),
+                     entry("SHUTDOWN_MSEC=%llu", msec(now - *acked)),
+                     entry("TOTAL_MSEC=%llu", msec(now - sent)),
+                     entry("HOST_ACTIVITY=%zu", hostActivity));
+}
+
 // Host Response handler
 auto SoftPowerOff::responseReceived(HostResponse response) -> HostResponse
 {
     using namespace std::chrono;
 
-    if (response == HostResponse::HostShutdown)
+    if (response == HostResponse::HostShutdown && !completed)
     {
         // Disable the timer since Host has quiesced and we are
         // done with soft power off part
@@ -124,6 +277,7 @@ auto SoftPowerOff::responseReceived(HostResponse response) -> HostResponse
 
         // This marks the completion of soft power off sequence.
         completed = true;
+        logPhases("HostShutdown");
     }
 
     return sdbusplus::xyz::openbmc_project::Ipmi::Internal ::server::
@@ -2,10 +2,13 @@
 
 #include "config.h"
 
+#include <chrono>
 #include <functional>
+#include <optional>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/server/object.hpp>
 #include <sdbusplus/timer.hpp>
+#include <string>
 #include <xyz/openbmc_project/Control/Host/server.hpp>
 #include <xyz/openbmc_project/Ipmi/Internal/SoftPowerOff/server.hpp>
 namespace phosphor
@@ -18,6 +21,16 @@ using namespace sdbusplus::xyz::openbmc_project::Control::server;
 
 namespace sdbusRule = sdbusplus::bus::match::rules;
 
+using Clock = std::chrono::steady_clock;
+
+/** @brief the object of a host below a root, like /xyz/openbmc_project/
+ *         state/host1
+ */
+inline std::string hostPath(const std::string& root, unsigned int hostId)
+{
+    return root + '/' + HOST_NAME + std::to_string(hostId);
+}
+
 /** @class SoftPowerOff
  *  @brief Responsible for coordinating Host SoftPowerOff operation
  */
@@ -30,19 +43,44 @@ class SoftPowerOff
      *  @param[in] bus       - system dbus handler
      *  @param[in] event     - sd_event handler
      *  @param[in] objPath   - The Dbus path hosting SoftPowerOff function
+     *  @param[in] hostId    - The host to power off
      */
     SoftPowerOff(sdbusplus::bus::bus& bus, sd_event* event,
-                 const char* objPath) :
+                 const char* objPath, unsigned int hostId = 0) :
         sdbusplus::server::object::object<Base::SoftPowerOff>(bus, objPath,
                                                               false),
-        bus(bus), timer(event),
+        bus(bus), hostId(hostId), timer(event),
         hostControlSignal(
             bus,
             sdbusRule::type::signal() + sdbusRule::member("CommandComplete") +
-                sdbusRule::path("/xyz/openbmc_project/control/host0") +
+                sdbusRule::path(hostPath(CONTROL_HOST_OBJ_MGR, hostId)) +
                 sdbusRule::interface(CONTROL_HOST_BUSNAME) +
                 sdbusRule::argN(0, convertForMessage(Host::Command::SoftOff)),
             std::bind(std::mem_fn(&SoftPowerOff::hostControlEvent), this,
+                      std::placeholders::_1)),
+        hostStateSignal(
+            bus,
+            sdbusRule::propertiesChanged(
+                hostPath("/xyz/openbmc_project/state", hostId),
+                "xyz.openbmc_project.State.Host"),
+            std::bind(std::mem_fn(&SoftPowerOff::hostStateEvent), this,
+                      std::placeholders::_1)),
+        acpiStateSignal(
+            bus,
+            sdbusRule::type::signal() + sdbusRule::member("PropertiesChanged") +
+                sdbusRule::interface("org.freedesktop.DBus.Properties") +
+                sdbusRule::path_namespace(
+                    hostPath(CONTROL_HOST_OBJ_MGR, hostId)) +
+                sdbusRule::argN(
+                    0, "xyz.openbmc_project.Control.Power.ACPIPowerState"),
+            std::bind(std::mem_fn(&SoftPowerOff::acpiStateEvent), this,
+                      std::placeholders::_1)),
+        watchdogSignal(
+            bus,
+            sdbusRule::propertiesChanged(
+                hostPath("/xyz/openbmc_project/watchdog", hostId),
+                "xyz.openbmc_project.State.Watchdog"),
+            std::bind(std::mem_fn(&SoftPowerOff::watchdogEvent), this,
                       std::placeholders::_1))
     {
         // Need to announce since we may get the response
@@ -53,6 +91,7 @@ class SoftPowerOff
         // command and watch for the soft power off to go through. We need
         // the interface added signal emitted before we send the shutdown
         // command just to attend to lightning fast response from host
+        sent = Clock::now();
         sendHostShutDownCmd();
     }
 
@@ -87,6 +126,12 @@ class SoftPowerOff
      */
     int startTimer(const std::chrono::microseconds& usec);
 
+    /** @brief Logs how long each phase of the soft power off took
+     *
+     *  @param[in] outcome - What ended the wait for the host
+     */
+    void logPhases(const char* outcome);
+
   private:
     // Need this to send SMS_ATTN
     // TODO : Switch over to using mapper service in a different patch
@@ -97,6 +142,9 @@ class SoftPowerOff
     /* @brief sdbusplus handle */
     sdbusplus::bus::bus& bus;
 
+    /** @brief The host this object powers off */
+    const unsigned int hostId;
+
     /** @brief Reference to Timer object */
     Timer timer;
 
@@ -114,6 +162,30 @@ class SoftPowerOff
      **/
     sdbusplus::bus::match_t hostControlSignal;
 
+    /** @brief When the shutdown command went to the host */
+    Clock::time_point sent;
+
+    /** @brief When the host acknowledged the shutdown command */
+    std::optional<Clock::time_point> acked;
+
+    /** @brief Watchdog updates seen while the host shuts down */
+    size_t hostActivity = 0;
+
+    /** @brief Subscribe to host state changes, the host going Off ends
+     *         the wait early
+     */
+    sdbusplus::bus::match_t hostStateSignal;
+
+    /** @brief Subscribe to ACPI state changes, the host reporting a soft
+     *         off state through Set ACPI Power State ends the wait early
+     */
+    sdbusplus::bus::match_t acpiStateSignal;
+
+    /** @brief Subscribe to host watchdog changes, updates show the host is
+     *         still shutting down and an expiry that it stopped
+     */
+    sdbusplus::bus::match_t watchdogSignal;
+
     /** @brief Sends host control command to tell host to shut down
      *
      *  After sending the command, wait for a signal indicating the status
@@ -136,6 +208,30 @@ class SoftPowerOff
      *
      */
     void hostControlEvent(sdbusplus::message::message& msg);
+
+    /** @brief Callback function on host state changes
+     *
+     * @param[in]  msg       - Data associated with subscribed signal
+     */
+    void hostStateEvent(sdbusplus::message::message& msg);
+
+    /** @brief Callback function on ACPI power state changes
+     *
+     * @param[in]  msg       - Data associated with subscribed signal
+     */
+    void acpiStateEvent(sdbusplus::message::message& msg);
+
+    /** @brief Callback function on host watchdog changes
+     *
+     * @param[in]  msg       - Data associated with subscribed signal
+     */
+    void watchdogEvent(sdbusplus::message::message& msg);
+
+    /** @brief Ends the soft power off ahead of the host shutdown response
+     *
+     *  @param[in] outcome - What showed the host is done
+     */
+    void completeEarly(const char* outcome);
 };
 } // namespace ipmi
 } // namespace phosphor
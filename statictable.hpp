@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace ipmi
+{
+
+/** @class TableView
+ *
+ *  View of a constexpr array emitted by the YAML generators, stands in for
+ *  the std::vector of the generated maps.
+ */
+template <typename T>
+class TableView
+{
+  public:
+    using value_type = T;
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+    constexpr TableView() = default;
+
+    template <size_t N>
+    constexpr TableView(const T (&array)[N]) : first(array), count(N)
+    {
+    }
+
+    constexpr const_iterator begin() const
+    {
+        return first;
+    }
+
+    constexpr const_iterator end() const
+    {
+        return first + count;
+    }
+
+    constexpr size_t size() const
+    {
+        return count;
+    }
+
+    constexpr bool empty() const
+    {
+        return count == 0;
+    }
+
+    constexpr const T& operator[](size_t pos) const
+    {
+        return first[pos];
+    }
+
+  private:
+    const T* first = nullptr;
+    size_t count = 0;
+};
+
+/** @class SortedTable
+ *
+ *  Constexpr array of key and value pairs sorted by key, with the lookup
+ *  interface of the std::map the YAML generators emit otherwise.
+ */
+template <typename Key, typename T>
+class SortedTable
+{
+  public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using const_iterator = const value_type*;
+    using iterator = const_iterator;
+
+    constexpr SortedTable() = default;
+
+    template <size_t N>
+    constexpr SortedTable(const value_type (&array)[N]) : entries(array)
+    {
+    }
+
+    const_iterator begin() const
+    {
+        return entries.begin();
+    }
+
+    const_iterator end() const
+    {
+        return entries.end();
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        auto entry = std::lower_bound(
+            begin(), end(), key,
+            [](const value_type& e, const Key& k) { return e.first < k; });
+        if (entry == end() || key < entry->first)
+        {
+            return end();
+        }
+        return entry;
+    }
+
+  private:
+    TableView<value_type> entries;
+};
+
+} // namespace ipmi
@@ -3,10 +3,16 @@
 #include "sensorhandler.hpp"
 #include "storagehandler.hpp"
 
+#include <fcntl.h>
 #include <mapper.h>
+#include <sys/stat.h>
 #include <systemd/sd-bus.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -42,22 +48,57 @@ std::string readESEL(const char* fileName)
     return content;
 }
 
-void createProcedureLogEntry(uint8_t procedureNum)
+namespace
 {
-    // Read the eSEL data from the file.
-    static constexpr auto eSELFile = "/tmp/esel";
-    auto eSELData = readESEL(eSELFile);
 
-    // Each byte in eSEL is formatted as %02x with a space between bytes and
-    // insert '/0' at the end of the character array.
-    static constexpr auto byteSeparator = 3;
-    std::unique_ptr<char[]> data(
-        new char[(eSELData.size() * byteSeparator) + 1]());
+constexpr auto eSELFile = "/tmp/esel";
+
+// Each byte in eSEL is formatted as %02x followed by a space.
+constexpr size_t byteSeparator = 3;
+
+/** @brief the "%02x " text of every byte value */
+constexpr std::array<std::array<char, byteSeparator>, 256> makeHexTable()
+{
+    constexpr char digits[] = "0123456789abcdef";
+    std::array<std::array<char, byteSeparator>, 256> table{};
+    for (size_t i = 0; i < table.size(); i++)
+    {
+        table[i] = {digits[i >> 4], digits[i & 0xf], ' '};
+    }
+    return table;
+}
 
-    for (size_t i = 0; i < eSELData.size(); i++)
+constexpr auto hexTable = makeHexTable();
+
+/** @brief format eSEL bytes as text
+ *
+ *  @param[in] data - eSEL bytes
+ *  @param[in] size - number of bytes
+ *  @param[out] text - size * byteSeparator characters
+ */
+void encodeESEL(const uint8_t* data, size_t size, char* text)
+{
+    for (size_t i = 0; i < size; i++)
     {
-        sprintf(&data[i * byteSeparator], "%02x ", eSELData[i]);
+        std::memcpy(text + (i * byteSeparator), hexTable[data[i]].data(),
+                    byteSeparator);
     }
+}
+
+/** @brief report the procedure error with the eSEL text, through the
+ *         journal
+ *
+ *  @param[in] procedureNum - procedure number associated with the log entry
+ */
+void reportProcedureLogEntry(uint8_t procedureNum)
+{
+    auto eSELData = readESEL(eSELFile);
+
+    // Insert '/0' at the end of the character array.
+    std::unique_ptr<char[]> data(
+        new char[(eSELData.size() * byteSeparator) + 1]());
+    encodeESEL(reinterpret_cast<const uint8_t*>(eSELData.data()),
+               eSELData.size(), data.get());
     data[eSELData.size() * byteSeparator] = '\0';
 
     using error = sdbusplus::org::open_power::Host::Error::MaintenanceProcedure;
@@ -66,3 +107,138 @@ void createProcedureLogEntry(uint8_t procedureNum)
     report<error>(metadata::ESEL(data.get()),
                   metadata::PROCEDURE(static_cast<uint32_t>(procedureNum)));
 }
+
+/** @brief the reply to the logging Create method, reporting the error
+ *         instead when the log entry was not created
+ *
+ *  @param[in] reply - the method reply or error
+ *  @param[in] userdata - procedure number associated with the log entry
+ */
+int procedureLogEntryCreated(sd_bus_message* reply, void* userdata,
+                             sd_bus_error*)
+{
+    const sd_bus_error* error = sd_bus_message_get_error(reply);
+    if (error)
+    {
+        log<level::ERR>("Failed to create the eSEL log entry",
+                        entry("ERROR=%s", error->message));
+        // the eSEL is read again, the file is only replaced by the next one
+        reportProcedureLogEntry(
+            static_cast<uint8_t>(reinterpret_cast<uintptr_t>(userdata)));
+    }
+    return 0;
+}
+
+/** @brief create the log entry through the logging Create method, with the
+ *         eSEL text encoded straight from the file into the message
+ *
+ *  The method is called asynchronously, so ipmid does not wait on the
+ *  logging service; the reply is handled by procedureLogEntryCreated.
+ *
+ *  @param[in] procedureNum - procedure number associated with the log entry
+ *
+ *  @return true if the method call was sent
+ */
+bool createProcedureLogEntryFromFile(uint8_t procedureNum)
+{
+    int fd = open(eSELFile, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return false;
+    }
+    const size_t size = st.st_size;
+
+    sd_bus* bus = ipmid_get_sd_bus_connection();
+    sd_bus_message* msg = nullptr;
+    char* text = nullptr;
+    std::string procedure = std::to_string(procedureNum);
+
+    int r = sd_bus_message_new_method_call(
+        bus, &msg, "xyz.openbmc_project.Logging",
+        "/xyz/openbmc_project/logging", "xyz.openbmc_project.Logging.Create",
+        "Create");
+    if (r >= 0)
+    {
+        r = sd_bus_message_append(
+            msg, "ss", "org.open_power.Host.Error.MaintenanceProcedure",
+            "xyz.openbmc_project.Logging.Entry.Level.Error");
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_open_container(msg, 'a', "{ss}");
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_append(msg, "{ss}", "PROCEDURE", procedure.c_str());
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_open_container(msg, 'e', "ss");
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_append(msg, "s", "ESEL");
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_append_string_space(msg, size * byteSeparator,
+                                               &text);
+    }
+    // Stream the file through a small buffer instead of reading it whole.
+    std::array<uint8_t, 4096> chunk;
+    size_t done = 0;
+    while (r >= 0 && done < size)
+    {
+        ssize_t count =
+            read(fd, chunk.data(), std::min(chunk.size(), size - done));
+        if (count <= 0)
+        {
+            r = -EIO;
+            break;
+        }
+        encodeESEL(chunk.data(), count, text + (done * byteSeparator));
+        done += count;
+    }
+    close(fd);
+    if (r >= 0)
+    {
+        r = sd_bus_message_close_container(msg);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_close_container(msg);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_call_async(bus, nullptr, msg, procedureLogEntryCreated,
+                              reinterpret_cast<void*>(
+                                  static_cast<uintptr_t>(procedureNum)),
+                              0);
+    }
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to create the eSEL log entry",
+                        entry("ERRNO=%d", -r));
+    }
+    sd_bus_message_unref(msg);
+    return r >= 0;
+}
+
+} // namespace
+
+void createProcedureLogEntry(uint8_t procedureNum)
+{
+    if (createProcedureLogEntryFromFile(procedureNum))
+    {
+        return;
+    }
+
+    // Fall back to reporting the error, which goes through the journal.
+    reportProcedureLogEntry(procedureNum);
+}
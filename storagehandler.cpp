@@ -2,8 +2,11 @@
 
 #include "fruread.hpp"
 #include "read_fru_data.hpp"
+#include "selindex.hpp"
+#include "selring.hpp"
 #include "selutility.hpp"
 #include "sensorhandler.hpp"
+#include "sensortable.hpp"
 #include "storageaddsel.hpp"
 
 #include <arpa/inet.h>
@@ -11,21 +14,30 @@
 #include <systemd/sd-bus.h>
 
 #include <algorithm>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core/span.hpp>
 #include <boost/process.hpp>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
+#include <ctime>
+#include <deque>
 #include <filesystem>
 #include <ipmid/api.hpp>
+#include <ipmid/iana.hpp>
+#include <ipmid/oemopenbmc.hpp>
 #include <ipmid/utils.hpp>
+#include <memory>
+#include <optional>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/server.hpp>
 #include <sdrutils.hpp>
 #include <string>
 #include <string_view>
 #include <variant>
+#include <vector>
 #include <xyz/openbmc_project/Common/error.hpp>
 
 void register_netfn_storage_functions() __attribute__((constructor));
@@ -35,7 +47,7 @@ namespace ipmi
 {
 namespace sensor
 {
-extern const IdInfoMap sensors;
+extern const SensorMap sensors;
 } // namespace sensor
 } // namespace ipmi
 
@@ -51,23 +63,117 @@ constexpr auto PROPERTY_ELAPSED = "Elapsed";
 } // namespace
 
 
-#ifndef JOURNAL_SEL
+#if !defined(JOURNAL_SEL) && !defined(RING_SEL)
 namespace cache
 {
 /*
- * This cache contains the object paths of the logging entries sorted in the
- * order of the filename(numeric order). The cache is initialized by
- * invoking readLoggingObjectPaths with the cache as the parameter. The
- * cache is invoked in the execution of the Get SEL info and Delete SEL
- * entry command. The Get SEL Info command is typically invoked before the
- * Get SEL entry command, so the cache is utilized for responding to Get SEL
- * entry command. The cache is invalidated by clearing after Delete SEL
- * entry and Clear SEL command.
+ * This cache contains the object paths of the logging entries keyed by their
+ * numeric entry ID. It is filled from the mapper on first use by invoking
+ * readLoggingObjectPaths, and from then on kept current from the
+ * InterfacesAdded and InterfacesRemoved signals of the logging service, so
+ * the Get SEL Info, Get SEL Entry and Delete SEL entry commands don't
+ * re-query the mapper. A failed signal decode invalidates the cache, which
+ * is then read again on next use.
  */
-ipmi::sel::ObjectPaths paths;
+ipmi::sel::ObjectPathMap paths;
+bool valid = false;
+
+std::unique_ptr<sdbusplus::bus::match::match> entryAddedMatch;
+std::unique_ptr<sdbusplus::bus::match::match> entryRemovedMatch;
+
+void entryAdded(sdbusplus::message::message& m)
+{
+    // every object below logBasePath is a logging entry, so the interface
+    // properties that follow the path don't need to be decoded
+    sdbusplus::message::object_path path;
+    try
+    {
+        m.read(path);
+    }
+    catch (const sdbusplus::exception::SdBusError& e)
+    {
+        valid = false;
+        return;
+    }
+    ipmi::sel::Id id;
+    if (ipmi::sel::getEntryId(path, id))
+    {
+        paths.insert_or_assign(id, std::move(path.str));
+    }
+}
+
+void entryRemoved(sdbusplus::message::message& m)
+{
+    sdbusplus::message::object_path path;
+    std::vector<std::string> interfaces;
+    try
+    {
+        m.read(path, interfaces);
+    }
+    catch (const sdbusplus::exception::SdBusError& e)
+    {
+        valid = false;
+        return;
+    }
+    ipmi::sel::Id id;
+    if (std::find(interfaces.begin(), interfaces.end(),
+                  ipmi::sel::logEntryIntf) != interfaces.end() &&
+        ipmi::sel::getEntryId(path, id))
+    {
+        paths.erase(id);
+    }
+}
+
+/** @brief make sure the cache holds the current logging entries
+ *
+ *  On failure the cache is left empty and is read again on next use.
+ */
+void load()
+{
+    if (!entryAddedMatch)
+    {
+        // subscribe before reading, so no entry added meanwhile is missed
+        const std::string entryNamespace =
+            "arg0path='" + std::string(ipmi::sel::logBasePath) + "/'";
+        entryAddedMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *getSdBus(),
+            "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+            "member='InterfacesAdded'," +
+                entryNamespace,
+            entryAdded);
+        entryRemovedMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *getSdBus(),
+            "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+            "member='InterfacesRemoved'," +
+                entryNamespace,
+            entryRemoved);
+    }
+    if (valid)
+    {
+        return;
+    }
+
+    try
+    {
+        ipmi::sel::readLoggingObjectPaths(paths);
+        valid = true;
+    }
+    catch (const sdbusplus::exception::SdBusError& e)
+    {
+        // readLoggingObjectPaths will throw exception if there are no log
+        // entries.
+        paths.clear();
+    }
+}
+
+/** @brief get the SEL record ID of a cache entry */
+uint16_t recordID(ipmi::sel::ObjectPathMap::const_iterator iter)
+{
+    return static_cast<uint16_t>(iter->first);
+}
 
 } // namespace cache
-#endif
+#endif // !JOURNAL_SEL && !RING_SEL
 
 using InternalFailure =
     sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
@@ -83,11 +189,203 @@ enum class AccessMode
     words  ///< Device is accessed by words
 };
 
-#ifdef JOURNAL_SEL
+#if defined(RING_SEL)
+static constexpr const char* selRingPath = "/var/lib/ipmi/sel_ring";
+static constexpr uint16_t selRingCapacity = 2048;
+static constexpr uint8_t selOverflowFlag = 0x80;
+
+static ipmi::sel::Ring& getSELRing()
+{
+    static ipmi::sel::Ring selRing(selRingPath, selRingCapacity);
+    return selRing;
+}
+
+ipmi::RspType<uint8_t,  // SEL version
+              uint16_t, // SEL entry count
+              uint16_t, // free space
+              uint32_t, // last add timestamp
+              uint32_t, // last erase timestamp
+              uint8_t>  // operation support
+    ipmiStorageGetSelInfo()
+{
+    ipmi::sel::Ring& ring = getSELRing();
+    uint16_t entries = ring.count();
+    uint16_t freeSpace = std::min<size_t>(
+        (ring.capacity() - entries) * ipmi::sel::selRecordSize, 0xFFFF);
+    uint8_t operationSupport = ipmi::sel::selOperationSupport;
+    if (ring.overflow())
+    {
+        operationSupport |= selOverflowFlag;
+    }
+
+    return ipmi::responseSuccess(ipmi::sel::selVersion, entries, freeSpace,
+                                 ring.lastAddTime(), ring.lastEraseTime(),
+                                 operationSupport);
+}
+
+/** @brief implements the Get SEL Entry command on the SEL ring
+ *  @param reservationID - SEL reservation ID, required for partial reads
+ *  @param targetID - record ID, 0000h and FFFFh for the oldest and newest
+ *  @param offset - offset into the record
+ *  @param size - bytes to read, FFh for the rest of the record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - nextRecordID - record ID of the next record, FFFFh for the last one
+ *   - data - record data
+ */
+ipmi::RspType<uint16_t,            // Next Record ID
+              std::vector<uint8_t>> // Record Data
+    ipmiStorageGetSELEntry(uint16_t reservationID, uint16_t targetID,
+                           uint8_t offset, uint8_t size)
+{
+    if (reservationID != 0 || offset != 0)
+    {
+        if (!checkSELReservation(reservationID))
+        {
+            return ipmi::responseInvalidReservationId();
+        }
+    }
+    if (offset >= ipmi::sel::selRecordSize)
+    {
+        return ipmi::responseParmOutOfRange();
+    }
+
+    ipmi::sel::Ring& ring = getSELRing();
+    ipmi::sel::Ring::Record record;
+    if (!ring.read(targetID, record))
+    {
+        return ipmi::responseSensorInvalid();
+    }
+    uint16_t recordID = record[0] | (record[1] << 8);
+
+    size_t length = ipmi::sel::selRecordSize - offset;
+    if (size != ipmi::sel::entireRecord)
+    {
+        length = std::min<size_t>(length, size);
+    }
+    return ipmi::responseSuccess(
+        ring.nextRecordID(recordID),
+        std::vector<uint8_t>(record.begin() + offset,
+                             record.begin() + offset + length));
+}
+
+/** @brief implements the OpenBMC OEM Read SEL Chunk command on the SEL ring
+ *  @param ctx - context of the request
+ *  @param reservationID - SEL reservation ID, 0 if none is held
+ *  @param startID - record ID to start from, 0000h for the oldest record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - nextRecordID - record ID to continue from, FFFFh when done
+ *   - count - number of records that follow
+ *   - records - packed 16-byte SEL records
+ */
+ipmi::RspType<uint16_t,               // Next Record ID
+              uint8_t,                // Record count
+              ipmi::message::Payload> // Records
+    ipmiStorageReadSELChunk(ipmi::Context::ptr ctx, uint16_t reservationID,
+                            uint16_t startID)
+{
+    // NetFn/LUN, Cmd, CC, IANA, next record ID and count bytes
+    constexpr size_t responseOverhead = 9;
+
+    if (reservationID != 0 && !checkSELReservation(reservationID))
+    {
+        return ipmi::responseInvalidReservationId();
+    }
+
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxRecords = 0;
+    if (maxTransfer > responseOverhead)
+    {
+        maxRecords =
+            (maxTransfer - responseOverhead) / ipmi::sel::selRecordSize;
+    }
+    maxRecords = std::min<size_t>(maxRecords, 0xFF);
+    if (maxRecords == 0)
+    {
+        return ipmi::responseRetBytesUnavailable();
+    }
+
+    ipmi::sel::Ring& ring = getSELRing();
+    ipmi::sel::Ring::Record record;
+    if (!ring.read(startID, record))
+    {
+        return ipmi::responseSensorInvalid();
+    }
+
+    ipmi::message::Payload records;
+    uint8_t count = 0;
+    uint16_t nextRecordID;
+    while (true)
+    {
+        records.pack(record);
+        count++;
+
+        nextRecordID = ring.nextRecordID(record[0] | (record[1] << 8));
+        if (nextRecordID == ipmi::sel::lastEntry || count == maxRecords ||
+            !ring.read(nextRecordID, record))
+        {
+            break;
+        }
+    }
+
+    return ipmi::responseSuccess(nextRecordID, count, records);
+}
+
+ipmi::RspType<uint8_t> ipmiStorageClearSEL(ipmi::Context::ptr ctx,
+                                           uint16_t reservationID,
+                                           const std::array<uint8_t, 3>& clr,
+                                           uint8_t eraseOperation)
+{
+    if (!checkSELReservation(reservationID))
+    {
+        return ipmi::responseInvalidReservationId();
+    }
+
+    static constexpr std::array<uint8_t, 3> clrExpected = {'C', 'L', 'R'};
+    if (clr != clrExpected)
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
+
+    // The ring is cleared synchronously, so erasure is always complete
+    if (eraseOperation == ipmi::sel::getEraseStatus)
+    {
+        return ipmi::responseSuccess(ipmi::sel::eraseComplete);
+    }
+    if (eraseOperation != ipmi::sel::initiateErase)
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
+
+    // Per the IPMI spec, need to cancel any reservation when the SEL is
+    // cleared
+    cancelSELReservation();
+
+    if (!getSELRing().clear(std::time(nullptr)))
+    {
+        return ipmi::responseUnspecifiedError();
+    }
+    return ipmi::responseSuccess(ipmi::sel::eraseComplete);
+}
+#elif defined(JOURNAL_SEL)
 namespace ipmi::sel::erase_time
 {
 static constexpr const char* selEraseTimestamp = "/var/lib/ipmi/sel_erase_time";
 
+// last erase time, read from the file once and then kept up to date by save()
+static std::optional<int> eraseTimestamp;
+
+static int readTimestamp(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) >= 0)
+    {
+        return st.st_mtime;
+    }
+    return ::ipmi::sel::invalidTimeStamp;
+}
+
 void save()
 {
     // open the file, creating it if necessary
@@ -95,6 +393,7 @@ void save()
     if (fd < 0)
     {
         std::cerr << "Failed to open file\n";
+        eraseTimestamp.reset();
         return;
     }
 
@@ -104,26 +403,29 @@ void save()
         std::cerr << "Failed to update timestamp: "
                   << std::string(strerror(errno));
     }
+    eraseTimestamp = readTimestamp(fd);
     close(fd);
 }
 
 int get()
 {
-    struct stat st;
+    if (eraseTimestamp)
+    {
+        return *eraseTimestamp;
+    }
+
     // default to an invalid timestamp
     int timestamp = ::ipmi::sel::invalidTimeStamp;
 
-    int fd = open(selEraseTimestamp, O_RDWR | O_CLOEXEC, 0644);
+    int fd = open(selEraseTimestamp, O_RDONLY | O_CLOEXEC);
     if (fd < 0)
     {
         return timestamp;
     }
+    timestamp = readTimestamp(fd);
+    close(fd);
 
-    if (fstat(fd, &st) >= 0)
-    {
-        timestamp = st.st_mtime;
-    }
-
+    eraseTimestamp = timestamp;
     return timestamp;
 }
 } // namespace ipmi::sel::erase_time
@@ -176,87 +478,189 @@ static bool getSELLogFiles(std::vector<std::filesystem::path>& selLogFiles)
     return !selLogFiles.empty();
 }
 
-static int countSELEntries()
+static ipmi::sel::LogIndex& getSELLogIndex()
 {
-    // Get the list of ipmi_sel log files
-    std::vector<std::filesystem::path> selLogFiles;
-    if (!getSELLogFiles(selLogFiles))
-    {
-        return 0;
-    }
-    int numSELEntries = 0;
-    // Loop through each log file and count the number of logs
-    for (const std::filesystem::path& file : selLogFiles)
+    static ipmi::sel::LogIndex selLogIndex(selLogDir, selLogFilename);
+    return selLogIndex;
+}
+
+/** @class SELAddQueue
+ *
+ *  Write-behind queue of the Add SEL Entry requests. A request is answered
+ *  as soon as it is queued, with the record ID the SEL logger is expected to
+ *  assign next, and the queue is flushed to the logger in batches from the
+ *  io context. While the queue is full the host is answered Node Busy so it
+ *  backs off instead of timing out and retrying.
+ *
+ *  The SEL logger hands out record IDs in the order it receives the calls,
+ *  and the calls of a batch are sent in queue order, so the prediction only
+ *  drifts if another client adds SEL entries; the logged ID is then taken
+ *  over for the following requests.
+ */
+class SELAddQueue
+{
+  public:
+    struct Entry
+    {
+        uint8_t recordType;
+        std::string sensorPath;
+        std::vector<uint8_t> eventData;
+        bool assert;
+        uint16_t generatorID;
+        uint16_t recordID;
+        std::string message = ipmiSELAddMessage;
+    };
+
+    /** @brief queue a SEL entry
+     *
+     *  @param[in] entry - the entry, its record ID is assigned here
+     *
+     *  @return the record ID of the entry, nullopt if the queue is full
+     */
+    std::optional<uint16_t> push(Entry&& entry)
     {
-        std::ifstream logStream(file);
-        if (!logStream.is_open())
+        if (queue.size() + inFlight >= maxQueued)
         {
-            continue;
+            return std::nullopt;
         }
+        if (!nextRecordID)
+        {
+            nextRecordID = advance(getSELLogIndex().lastRecordID());
+        }
+        entry.recordID = *nextRecordID;
+        nextRecordID = advance(entry.recordID);
+        queue.emplace_back(std::move(entry));
 
-        std::string line;
-        while (std::getline(logStream, line))
+        if (!inFlight && queue.size() == 1)
         {
-            numSELEntries++;
+            timer.expires_after(batchDelay);
+            timer.async_wait([this](const boost::system::error_code& ec) {
+                if (!ec)
+                {
+                    flush();
+                }
+            });
         }
+        return queue.back().recordID;
     }
-    return numSELEntries;
-}
 
-static bool findSELEntry(const int recordID,
-                         const std::vector<std::filesystem::path>& selLogFiles,
-                         std::string& entry)
-{
-    // Record ID is the first entry field following the timestamp. It is
-    // preceded by a space and followed by a comma
-    std::string search = " " + std::to_string(recordID) + ",";
-
-    // Loop through the ipmi_sel log entries
-    for (const std::filesystem::path& file : selLogFiles)
+    /** @brief forget the predicted record ID, after the SEL was cleared */
+    void reset()
     {
-        std::ifstream logStream(file);
-        if (!logStream.is_open())
+        if (!inFlight && queue.empty())
         {
-            continue;
+            nextRecordID.reset();
         }
+    }
 
-        while (std::getline(logStream, entry))
+  private:
+    /** @brief most entries queued or in flight before Node Busy */
+    static constexpr size_t maxQueued = 64;
+    /** @brief most calls to the SEL logger outstanding at a time */
+    static constexpr size_t maxBatch = 16;
+    /** @brief time a first entry waits for others to join its batch */
+    static constexpr std::chrono::milliseconds batchDelay{20};
+
+    static constexpr char const* ipmiSELObject =
+        "xyz.openbmc_project.Logging.IPMI";
+    static constexpr char const* ipmiSELPath =
+        "/xyz/openbmc_project/Logging/IPMI";
+    static constexpr char const* ipmiSELAddInterface =
+        "xyz.openbmc_project.Logging.IPMI";
+    static constexpr char const* ipmiSELAddMessage =
+        "IPMI SEL entry logged using IPMI Add SEL Entry command.";
+
+    /** @brief the record ID the SEL logger assigns after recordID */
+    static uint16_t advance(uint16_t recordID)
+    {
+        return recordID >= ipmi::sel::lastEntry - 1 ? ipmi::sel::firstEntry + 1
+                                                    : recordID + 1;
+    }
+
+    /** @brief send the next batch of entries to the SEL logger */
+    void flush()
+    {
+        std::shared_ptr<sdbusplus::asio::connection> bus = getSdBus();
+        while (!queue.empty() && inFlight < maxBatch)
         {
-            // Check if the record ID matches
-            if (entry.find(search) != std::string::npos)
+            Entry entry = std::move(queue.front());
+            queue.pop_front();
+            inFlight++;
+
+            auto done = [this, expected = entry.recordID](
+                            const boost::system::error_code& ec,
+                            uint16_t recordID) {
+                logged(ec, expected, recordID);
+            };
+            if (entry.recordType == ipmi::sel::systemEvent)
+            {
+                bus->async_method_call(
+                    std::move(done), ipmiSELObject, ipmiSELPath,
+                    ipmiSELAddInterface, "IpmiSelAdd", entry.message,
+                    entry.sensorPath, entry.eventData, entry.assert,
+                    entry.generatorID);
+            }
+            else
             {
-                return true;
+                bus->async_method_call(
+                    std::move(done), ipmiSELObject, ipmiSELPath,
+                    ipmiSELAddInterface, "IpmiSelAddOem", entry.message,
+                    entry.eventData, entry.recordType);
             }
         }
     }
-    return false;
-}
 
-static uint16_t
-    getNextRecordID(const uint16_t recordID,
-                    const std::vector<std::filesystem::path>& selLogFiles)
-{
-    uint16_t nextRecordID = recordID + 1;
-    std::string entry;
-    if (findSELEntry(nextRecordID, selLogFiles, entry))
+    /** @brief handle the reply of the SEL logger to one entry */
+    void logged(const boost::system::error_code& ec, uint16_t expected,
+                uint16_t recordID)
     {
-        return nextRecordID;
-    }
-    else
-    {
-        return ipmi::sel::lastEntry;
+        inFlight--;
+        if (ec)
+        {
+            log<level::ERR>("Failed to log queued SEL entry",
+                            entry("RECORD_ID=%u", expected),
+                            entry("ERROR=%s", ec.message().c_str()));
+            // the ID was not used, the following ones come one too early
+            recordID = expected == ipmi::sel::firstEntry + 1
+                           ? ipmi::sel::lastEntry - 1
+                           : expected - 1;
+        }
+        else if (recordID != expected)
+        {
+            log<level::WARNING>("SEL logger assigned an unexpected record ID",
+                                entry("EXPECTED=%u", expected),
+                                entry("RECORD_ID=%u", recordID));
+        }
+        if (ec || recordID != expected)
+        {
+            // entries already answered keep their IDs, only the ones
+            // assigned from now on follow the logger again
+            uint16_t next = recordID;
+            for (size_t i = 0; i <= inFlight + queue.size(); i++)
+            {
+                next = advance(next);
+            }
+            nextRecordID = next;
+        }
+
+        if (!inFlight)
+        {
+            // index whatever part of the batch already reached the log
+            getSELLogIndex().append();
+            flush();
+        }
     }
-}
 
-static int getFileTimestamp(const std::filesystem::path& file)
-{
-    struct stat st;
+    boost::asio::steady_timer timer{*getIoContext()};
+    std::deque<Entry> queue;
+    size_t inFlight = 0;
+    std::optional<uint16_t> nextRecordID;
+};
 
-    if (stat(file.c_str(), &st) >= 0)
-    {
-        return st.st_mtime;
-    }
-    return ::ipmi::sel::invalidTimeStamp;
+static SELAddQueue& getSELAddQueue()
+{
+    static SELAddQueue selAddQueue;
+    return selAddQueue;
 }
 
 using systemEventType = std::tuple<
@@ -274,91 +678,35 @@ using oemTsEventType = std::tuple<
 using oemEventType =
     std::array<uint8_t, ipmi::sel::oemEventSize>; // Event Data
 
-ipmi::RspType<uint16_t, // Next Record ID
-              uint16_t, // Record ID
-              uint8_t,  // Record Type
-              std::variant<systemEventType, oemTsEventType,
-                           oemEventType>> // Record Content
-    ipmiStorageGetSELEntry(uint16_t reservationID, uint16_t targetID,
-                           uint8_t offset, uint8_t size)
-{
-    // Only support getting the entire SEL record. If a partial size or non-zero
-    // offset is requested, return an error
-    if (offset != 0 || size != ipmi::sel::entireRecord)
-    {
-        return ipmi::responseRetBytesUnavailable();
-    }
-
-    // Check the reservation ID if one is provided or required (only if the
-    // offset is non-zero)
-    if (reservationID != 0 || offset != 0)
-    {
-        if (!checkSELReservation(reservationID))
-        {
-            return ipmi::responseInvalidReservationId();
-        }
-    }
-
-    // Get the ipmi_sel log files
-    std::vector<std::filesystem::path> selLogFiles;
-    if (!getSELLogFiles(selLogFiles))
-    {
-        return ipmi::responseSensorInvalid();
-    }
-
-    std::string targetEntry;
-
-    if (targetID == ipmi::sel::firstEntry)
-    {
-        // The first entry will be at the top of the oldest log file
-        std::ifstream logStream(selLogFiles.back());
-        if (!logStream.is_open())
-        {
-            return ipmi::responseUnspecifiedError();
-        }
-
-        if (!std::getline(logStream, targetEntry))
-        {
-            return ipmi::responseUnspecifiedError();
-        }
-    }
-    else if (targetID == ipmi::sel::lastEntry)
-    {
-        // The last entry will be at the bottom of the newest log file
-        std::ifstream logStream(selLogFiles.front());
-        if (!logStream.is_open())
-        {
-            return ipmi::responseUnspecifiedError();
-        }
-
-        std::string line;
-        while (std::getline(logStream, line))
-        {
-            targetEntry = line;
-        }
-    }
-    else
-    {
-        if (!findSELEntry(targetID, selLogFiles, targetEntry))
-        {
-            return ipmi::responseSensorInvalid();
-        }
-    }
+using SELEntryContent =
+    std::variant<systemEventType, oemTsEventType, oemEventType>;
 
+/** @brief parse an ipmi_sel log line into a SEL record
+ *  @param[in] targetEntry - the log line
+ *  @param[out] recordID - record ID
+ *  @param[out] recordType - record type
+ *  @param[out] content - record content
+ *
+ *  @returns IPMI completion code
+ */
+static ipmi::Cc parseSELEntry(const std::string& targetEntry,
+                              uint16_t& recordID, uint8_t& recordType,
+                              SELEntryContent& content)
+{
     // The format of the ipmi_sel message is "<Timestamp>
     // <ID>,<Type>,<EventData>,[<Generator ID>,<Path>,<Direction>]".
     // First get the Timestamp
     size_t space = targetEntry.find_first_of(" ");
     if (space == std::string::npos)
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
     std::string entryTimestamp = targetEntry.substr(0, space);
     // Then get the log contents
     size_t entryStart = targetEntry.find_first_not_of(" ", space);
     if (entryStart == std::string::npos)
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
     std::string_view entry(targetEntry);
     entry.remove_prefix(entryStart);
@@ -368,14 +716,12 @@ ipmi::RspType<uint16_t, // Next Record ID
                  boost::token_compress_on);
     if (targetEntryFields.size() < 3)
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
     std::string& recordIDStr = targetEntryFields[0];
     std::string& recordTypeStr = targetEntryFields[1];
     std::string& eventDataStr = targetEntryFields[2];
 
-    uint16_t recordID;
-    uint8_t recordType;
     try
     {
         recordID = std::stoul(recordIDStr);
@@ -383,13 +729,12 @@ ipmi::RspType<uint16_t, // Next Record ID
     }
     catch (const std::invalid_argument&)
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
-    uint16_t nextRecordID = getNextRecordID(recordID, selLogFiles);
     std::vector<uint8_t> eventDataBytes;
     if (fromHexStr(eventDataStr, eventDataBytes) < 0)
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
     if (recordType == ipmi::sel::systemEvent)
@@ -454,10 +799,10 @@ ipmi::RspType<uint16_t, // Next Record ID
                     std::min(eventDataBytes.size(), eventData.size()),
                     eventData.begin());
 
-        return ipmi::responseSuccess(
-            nextRecordID, recordID, recordType,
-            systemEventType{timestamp, generatorID, evmRev, sensorType,
-                            sensorNum, eventType, eventDir, eventData});
+        content = systemEventType{timestamp, generatorID, evmRev,
+                                  sensorType, sensorNum,   eventType,
+                                  eventDir,   eventData};
+        return ipmi::ccSuccess;
     }
     else if (recordType >= ipmi::sel::oemTsEventFirst &&
              recordType <= ipmi::sel::oemTsEventLast)
@@ -466,34 +811,159 @@ ipmi::RspType<uint16_t, // Next Record ID
         std::tm timeStruct = {};
         std::istringstream entryStream(entryTimestamp);
 
-        uint32_t timestamp = ipmi::sel::invalidTimeStamp;
-        if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
-        {
-            timestamp = std::mktime(&timeStruct);
-        }
+        uint32_t timestamp = ipmi::sel::invalidTimeStamp;
+        if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
+        {
+            timestamp = std::mktime(&timeStruct);
+        }
+
+        // Only keep the bytes that fit in the record
+        std::array<uint8_t, ipmi::sel::oemTsEventSize> eventData{};
+        std::copy_n(eventDataBytes.begin(),
+                    std::min(eventDataBytes.size(), eventData.size()),
+                    eventData.begin());
+
+        content = oemTsEventType{timestamp, eventData};
+        return ipmi::ccSuccess;
+    }
+    else if (recordType >= ipmi::sel::oemEventFirst)
+    {
+        // Only keep the bytes that fit in the record
+        std::array<uint8_t, ipmi::sel::oemEventSize> eventData{};
+        std::copy_n(eventDataBytes.begin(),
+                    std::min(eventDataBytes.size(), eventData.size()),
+                    eventData.begin());
+
+        content = eventData;
+        return ipmi::ccSuccess;
+    }
+
+    return ipmi::ccUnspecifiedError;
+}
+
+ipmi::RspType<uint16_t, // Next Record ID
+              uint16_t, // Record ID
+              uint8_t,  // Record Type
+              SELEntryContent> // Record Content
+    ipmiStorageGetSELEntry(uint16_t reservationID, uint16_t targetID,
+                           uint8_t offset, uint8_t size)
+{
+    // Only support getting the entire SEL record. If a partial size or non-zero
+    // offset is requested, return an error
+    if (offset != 0 || size != ipmi::sel::entireRecord)
+    {
+        return ipmi::responseRetBytesUnavailable();
+    }
+
+    // Check the reservation ID if one is provided or required (only if the
+    // offset is non-zero)
+    if (reservationID != 0 || offset != 0)
+    {
+        if (!checkSELReservation(reservationID))
+        {
+            return ipmi::responseInvalidReservationId();
+        }
+    }
+
+    // The index reads the first entry from the top of the oldest log file
+    // and the last entry from the bottom of the newest one
+    std::string targetEntry;
+    if (!getSELLogIndex().read(targetID, targetEntry))
+    {
+        return ipmi::responseSensorInvalid();
+    }
+
+    uint16_t recordID;
+    uint8_t recordType;
+    SELEntryContent content;
+    ipmi::Cc cc = parseSELEntry(targetEntry, recordID, recordType, content);
+    if (cc != ipmi::ccSuccess)
+    {
+        return ipmi::response(cc);
+    }
+    uint16_t nextRecordID = getSELLogIndex().nextRecordID(recordID);
+
+    return ipmi::responseSuccess(nextRecordID, recordID, recordType, content);
+}
+
+/** @brief implements the OpenBMC OEM Read SEL Chunk command
+ *  @param ctx - context of the request
+ *  @param reservationID - SEL reservation ID, 0 if none is held
+ *  @param startID - record ID to start from, 0000h for the oldest record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - nextRecordID - record ID to continue from, FFFFh when done
+ *   - count - number of records that follow
+ *   - records - packed 16-byte SEL records
+ */
+ipmi::RspType<uint16_t,               // Next Record ID
+              uint8_t,                // Record count
+              ipmi::message::Payload> // Records
+    ipmiStorageReadSELChunk(ipmi::Context::ptr ctx, uint16_t reservationID,
+                            uint16_t startID)
+{
+    // NetFn/LUN, Cmd, CC, IANA, next record ID and count bytes
+    constexpr size_t responseOverhead = 9;
+
+    if (reservationID != 0 && !checkSELReservation(reservationID))
+    {
+        return ipmi::responseInvalidReservationId();
+    }
 
-        // Only keep the bytes that fit in the record
-        std::array<uint8_t, ipmi::sel::oemTsEventSize> eventData{};
-        std::copy_n(eventDataBytes.begin(),
-                    std::min(eventDataBytes.size(), eventData.size()),
-                    eventData.begin());
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxRecords = 0;
+    if (maxTransfer > responseOverhead)
+    {
+        maxRecords =
+            (maxTransfer - responseOverhead) / ipmi::sel::selRecordSize;
+    }
+    maxRecords = std::min<size_t>(maxRecords, 0xFF);
+    if (maxRecords == 0)
+    {
+        return ipmi::responseRetBytesUnavailable();
+    }
 
-        return ipmi::responseSuccess(nextRecordID, recordID, recordType,
-                                     oemTsEventType{timestamp, eventData});
+    ipmi::sel::LogIndex& selLogIndex = getSELLogIndex();
+    std::string targetEntry;
+    if (!selLogIndex.read(startID, targetEntry))
+    {
+        return ipmi::responseSensorInvalid();
     }
-    else if (recordType >= ipmi::sel::oemEventFirst)
+
+    ipmi::message::Payload records;
+    uint8_t count = 0;
+    uint16_t nextRecordID = ipmi::sel::lastEntry;
+    while (true)
     {
-        // Only keep the bytes that fit in the record
-        std::array<uint8_t, ipmi::sel::oemEventSize> eventData{};
-        std::copy_n(eventDataBytes.begin(),
-                    std::min(eventDataBytes.size(), eventData.size()),
-                    eventData.begin());
+        uint16_t recordID;
+        uint8_t recordType;
+        SELEntryContent content;
+        ipmi::Cc cc = parseSELEntry(targetEntry, recordID, recordType, content);
+        if (cc != ipmi::ccSuccess)
+        {
+            if (count == 0)
+            {
+                return ipmi::response(cc);
+            }
+            // resume at the bad record, Get SEL Entry reports its error
+            break;
+        }
+        records.pack(recordID, recordType, content);
+        count++;
 
-        return ipmi::responseSuccess(nextRecordID, recordID, recordType,
-                                     eventData);
+        nextRecordID = selLogIndex.nextRecordID(recordID);
+        if (nextRecordID == ipmi::sel::lastEntry || count == maxRecords)
+        {
+            break;
+        }
+        if (!selLogIndex.read(nextRecordID, targetEntry))
+        {
+            nextRecordID = ipmi::sel::lastEntry;
+            break;
+        }
     }
 
-    return ipmi::responseUnspecifiedError();
+    return ipmi::responseSuccess(nextRecordID, count, records);
 }
 
 
@@ -543,6 +1013,8 @@ ipmi::RspType<uint8_t> ipmiStorageClearSEL(ipmi::Context::ptr ctx,
             std::filesystem::remove(file, ec);
         }
     }
+    getSELLogIndex().reset();
+    getSELAddQueue().reset();
 
     // Reload rsyslog so it knows to start new log files
     std::shared_ptr<sdbusplus::asio::connection> dbus = getSdBus();
@@ -573,9 +1045,8 @@ ipmi::RspType<uint8_t,  // SEL version
     ipmiStorageGetSelInfo()
 {
     constexpr uint8_t selVersion = ipmi::sel::selVersion;
-    uint16_t entries = countSELEntries();
-    uint32_t addTimeStamp = getFileTimestamp(
-        selLogDir / selLogFilename);
+    uint16_t entries = getSELLogIndex().count();
+    uint32_t addTimeStamp = getSELLogIndex().lastAddTime();
     uint32_t eraseTimeStamp = ipmi::sel::erase_time::get();
     constexpr uint8_t operationSupport =
         ipmi::sel::selOperationSupport;
@@ -615,17 +1086,9 @@ ipmi::RspType<uint8_t,  // SEL revision.
     // Most recent addition timestamp.
     uint32_t addTimeStamp = ipmi::sel::invalidTimeStamp;
 
-    try
-    {
-        ipmi::sel::readLoggingObjectPaths(cache::paths);
-    }
-    catch (const sdbusplus::exception::SdBusError& e)
-    {
-        // No action if reading log objects have failed for this command.
-        // readLoggingObjectPaths will throw exception if there are no log
-        // entries. The command will be responded with number of SEL entries
-        // as 0.
-    }
+    // If the log objects can't be read, the command will be responded with
+    // number of SEL entries as 0.
+    cache::load();
 
     if (!cache::paths.empty())
     {
@@ -634,7 +1097,8 @@ ipmi::RspType<uint8_t,  // SEL revision.
         try
         {
             addTimeStamp = static_cast<uint32_t>(
-                (ipmi::sel::getEntryTimeStamp(cache::paths.back()).count()));
+                (ipmi::sel::getEntryTimeStamp(cache::paths.rbegin()->second)
+                     .count()));
         }
         catch (InternalFailure& e)
         {
@@ -659,55 +1123,53 @@ ipmi::RspType<uint8_t,  // SEL revision.
         ipmi::sel::operationSupport::overflow);
 }
 
-ipmi_ret_t getSELEntry(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                       ipmi_request_t request, ipmi_response_t response,
-                       ipmi_data_len_t data_len, ipmi_context_t context)
+/** @brief implements the get SEL entry command
+ *  @param reservationID - SEL reservation ID, 0000h when reading the whole
+ *                         record
+ *  @param targetID - SEL record ID, 0000h first and FFFFh last entry
+ *  @param offset - offset into the record
+ *  @param size - bytes to read, FFh for the entire record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - next record ID, FFFFh after the last entry
+ *   - record data
+ */
+ipmi::RspType<uint16_t,            // next record ID
+              std::vector<uint8_t>> // record data
+    ipmiStorageGetSELEntry(uint16_t reservationID, uint16_t targetID,
+                           uint8_t offset, uint8_t size)
 {
-    if (*data_len != sizeof(ipmi::sel::GetSELEntryRequest))
-    {
-        *data_len = 0;
-        return IPMI_CC_REQ_DATA_LEN_INVALID;
-    }
-
-    auto requestData =
-        reinterpret_cast<const ipmi::sel::GetSELEntryRequest*>(request);
-
-    if (requestData->reservationID != 0)
+    if (reservationID != 0)
     {
-        if (!checkSELReservation(requestData->reservationID))
+        if (!checkSELReservation(reservationID))
         {
-            *data_len = 0;
-            return IPMI_CC_INVALID_RESERVATION_ID;
+            return ipmi::responseInvalidReservationId();
         }
     }
 
+    cache::load();
     if (cache::paths.empty())
     {
-        *data_len = 0;
-        return IPMI_CC_SENSOR_INVALID;
+        return ipmi::responseSensorInvalid();
     }
 
-    ipmi::sel::ObjectPaths::const_iterator iter;
+    ipmi::sel::ObjectPathMap::const_iterator iter;
 
     // Check for the requested SEL Entry.
-    if (requestData->selRecordID == ipmi::sel::firstEntry)
+    if (targetID == ipmi::sel::firstEntry)
     {
         iter = cache::paths.begin();
     }
-    else if (requestData->selRecordID == ipmi::sel::lastEntry)
+    else if (targetID == ipmi::sel::lastEntry)
     {
-        iter = cache::paths.end();
+        iter = std::prev(cache::paths.end());
     }
     else
     {
-        std::string objPath = std::string(ipmi::sel::logBasePath) + "/" +
-                              std::to_string(requestData->selRecordID);
-
-        iter = std::find(cache::paths.begin(), cache::paths.end(), objPath);
+        iter = cache::paths.find(targetID);
         if (iter == cache::paths.end())
         {
-            *data_len = 0;
-            return IPMI_CC_SENSOR_INVALID;
+            return ipmi::responseSensorInvalid();
         }
     }
 
@@ -716,69 +1178,134 @@ ipmi_ret_t getSELEntry(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     // Convert the log entry into SEL record.
     try
     {
-        record = ipmi::sel::convertLogEntrytoSEL(*iter);
+        record = ipmi::sel::convertLogEntrytoSEL(iter->second);
     }
     catch (InternalFailure& e)
     {
-        *data_len = 0;
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        return ipmi::responseUnspecifiedError();
     }
     catch (const std::runtime_error& e)
     {
         log<level::ERR>(e.what());
-        *data_len = 0;
-        return IPMI_CC_UNSPECIFIED_ERROR;
+        return ipmi::responseUnspecifiedError();
     }
 
     // Identify the next SEL record ID
-    if (iter != cache::paths.end())
+    ++iter;
+    uint16_t nextRecordID = (iter == cache::paths.end())
+                                ? ipmi::sel::lastEntry
+                                : cache::recordID(iter);
+
+    auto event = reinterpret_cast<const uint8_t*>(&record.event);
+    if (size == ipmi::sel::entireRecord)
     {
-        ++iter;
-        if (iter == cache::paths.end())
-        {
-            record.nextRecordID = ipmi::sel::lastEntry;
-        }
-        else
-        {
-            namespace fs = std::filesystem;
-            fs::path path(*iter);
-            record.nextRecordID = static_cast<uint16_t>(
-                std::stoul(std::string(path.filename().c_str())));
-        }
+        return ipmi::responseSuccess(
+            nextRecordID,
+            std::vector<uint8_t>(event, event + sizeof(record.event)));
     }
-    else
+
+    if (offset >= ipmi::sel::selRecordSize ||
+        size > ipmi::sel::selRecordSize)
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
+
+    auto readLength = std::min(ipmi::sel::selRecordSize - offset,
+                               static_cast<int>(size));
+    return ipmi::responseSuccess(
+        nextRecordID,
+        std::vector<uint8_t>(event + offset, event + offset + readLength));
+}
+
+/** @brief implements the OpenBMC OEM Read SEL Chunk command
+ *  @param ctx - context of the request
+ *  @param reservationID - SEL reservation ID, 0 if none is held
+ *  @param startID - record ID to start from, 0000h for the oldest record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - nextRecordID - record ID to continue from, FFFFh when done
+ *   - count - number of records that follow
+ *   - records - packed 16-byte SEL records
+ */
+ipmi::RspType<uint16_t,               // Next Record ID
+              uint8_t,                // Record count
+              ipmi::message::Payload> // Records
+    ipmiStorageReadSELChunk(ipmi::Context::ptr ctx, uint16_t reservationID,
+                            uint16_t startID)
+{
+    // NetFn/LUN, Cmd, CC, IANA, next record ID and count bytes
+    constexpr size_t responseOverhead = 9;
+
+    if (reservationID != 0 && !checkSELReservation(reservationID))
+    {
+        return ipmi::responseInvalidReservationId();
+    }
+
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxRecords = 0;
+    if (maxTransfer > responseOverhead)
     {
-        record.nextRecordID = ipmi::sel::lastEntry;
+        maxRecords =
+            (maxTransfer - responseOverhead) / ipmi::sel::selRecordSize;
+    }
+    maxRecords = std::min<size_t>(maxRecords, 0xFF);
+    if (maxRecords == 0)
+    {
+        return ipmi::responseRetBytesUnavailable();
+    }
+
+    cache::load();
+    if (cache::paths.empty())
+    {
+        return ipmi::responseSensorInvalid();
     }
 
-    if (requestData->readLength == ipmi::sel::entireRecord)
+    ipmi::sel::ObjectPathMap::const_iterator iter;
+    if (startID == ipmi::sel::firstEntry)
     {
-        std::memcpy(response, &record, sizeof(record));
-        *data_len = sizeof(record);
+        iter = cache::paths.begin();
+    }
+    else if (startID == ipmi::sel::lastEntry)
+    {
+        iter = std::prev(cache::paths.end());
     }
     else
     {
-        if (requestData->offset >= ipmi::sel::selRecordSize ||
-            requestData->readLength > ipmi::sel::selRecordSize)
+        iter = cache::paths.find(startID);
+        if (iter == cache::paths.end())
         {
-            *data_len = 0;
-            return IPMI_CC_INVALID_FIELD_REQUEST;
+            return ipmi::responseSensorInvalid();
         }
+    }
 
-        auto diff = ipmi::sel::selRecordSize - requestData->offset;
-        auto readLength =
-            std::min(diff, static_cast<int>(requestData->readLength));
-
-        std::memcpy(response, &record.nextRecordID,
-                    sizeof(record.nextRecordID));
-        std::memcpy(static_cast<uint8_t*>(response) +
-                        sizeof(record.nextRecordID),
-                    &record.event.eventRecord.recordID + requestData->offset,
-                    readLength);
-        *data_len = sizeof(record.nextRecordID) + readLength;
+    ipmi::message::Payload records;
+    uint8_t count = 0;
+    for (; iter != cache::paths.end() && count < maxRecords; ++iter)
+    {
+        ipmi::sel::GetSELEntryResponse record{};
+        try
+        {
+            record = ipmi::sel::convertLogEntrytoSEL(iter->second);
+        }
+        catch (const std::exception& e)
+        {
+            if (count == 0)
+            {
+                return ipmi::responseUnspecifiedError();
+            }
+            // resume at the bad record, Get SEL Entry reports its error
+            break;
+        }
+        std::array<uint8_t, ipmi::sel::selRecordSize> event;
+        std::memcpy(event.data(), &record.event, event.size());
+        records.pack(event);
+        count++;
     }
+    uint16_t nextRecordID = (iter == cache::paths.end())
+                                ? ipmi::sel::lastEntry
+                                : cache::recordID(iter);
 
-    return IPMI_CC_OK;
+    return ipmi::responseSuccess(nextRecordID, count, records);
 }
 
 /** @brief implements the delete SEL entry command
@@ -793,9 +1320,6 @@ ipmi::RspType<uint16_t // deleted record ID
               >
     deleteSELEntry(uint16_t reservationID, uint16_t selRecordID)
 {
-
-    namespace fs = std::filesystem;
-
     if (!checkSELReservation(reservationID))
     {
         return ipmi::responseInvalidReservationId();
@@ -805,58 +1329,39 @@ ipmi::RspType<uint16_t // deleted record ID
     // deleted
     cancelSELReservation();
 
-    try
-    {
-        ipmi::sel::readLoggingObjectPaths(cache::paths);
-    }
-    catch (const sdbusplus::exception::SdBusError& e)
-    {
-        // readLoggingObjectPaths will throw exception if there are no error
-        // log entries.
-        return ipmi::responseSensorInvalid();
-    }
-
+    cache::load();
     if (cache::paths.empty())
     {
         return ipmi::responseSensorInvalid();
     }
 
-    ipmi::sel::ObjectPaths::const_iterator iter;
-    uint16_t delRecordID = 0;
+    ipmi::sel::ObjectPathMap::const_iterator iter;
 
     if (selRecordID == ipmi::sel::firstEntry)
     {
         iter = cache::paths.begin();
-        fs::path path(*iter);
-        delRecordID = static_cast<uint16_t>(
-            std::stoul(std::string(path.filename().c_str())));
     }
     else if (selRecordID == ipmi::sel::lastEntry)
     {
-        iter = cache::paths.end();
-        fs::path path(*iter);
-        delRecordID = static_cast<uint16_t>(
-            std::stoul(std::string(path.filename().c_str())));
+        iter = std::prev(cache::paths.end());
     }
     else
     {
-        std::string objPath = std::string(ipmi::sel::logBasePath) + "/" +
-                              std::to_string(selRecordID);
-
-        iter = std::find(cache::paths.begin(), cache::paths.end(), objPath);
+        iter = cache::paths.find(selRecordID);
         if (iter == cache::paths.end())
         {
             return ipmi::responseSensorInvalid();
         }
-        delRecordID = selRecordID;
     }
+    uint16_t delRecordID = cache::recordID(iter);
 
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
     std::string service;
 
     try
     {
-        service = ipmi::getService(bus, ipmi::sel::logDeleteIntf, *iter);
+        service =
+            ipmi::getService(bus, ipmi::sel::logDeleteIntf, iter->second);
     }
     catch (const std::runtime_error& e)
     {
@@ -864,20 +1369,123 @@ ipmi::RspType<uint16_t // deleted record ID
         return ipmi::responseUnspecifiedError();
     }
 
-    auto methodCall = bus.new_method_call(service.c_str(), (*iter).c_str(),
-                                          ipmi::sel::logDeleteIntf, "Delete");
+    auto methodCall =
+        bus.new_method_call(service.c_str(), iter->second.c_str(),
+                            ipmi::sel::logDeleteIntf, "Delete");
     auto reply = bus.call(methodCall);
     if (reply.is_method_error())
     {
         return ipmi::responseUnspecifiedError();
     }
 
-    // Invalidate the cache of dbus entry objects.
-    cache::paths.clear();
+    // The InterfacesRemoved signal would drop it too, don't wait for it
+    cache::paths.erase(iter);
 
     return ipmi::responseSuccess(delRecordID);
 }
 
+namespace erase
+{
+/*
+ * Clear SEL only starts the erasure, which then runs from the io context:
+ * a single DeleteAll call when the logging service implements it,
+ * otherwise one Delete call per entry, sent one after the other. Get Erase
+ * Status reports erasure in progress until the last call returned.
+ */
+static bool inProgress = false;
+// entries left to delete one by one, with their service
+static std::vector<std::pair<std::string, std::string>> pending;
+static size_t deleted = 0;
+
+static void finish()
+{
+    log<level::INFO>("SEL erasure complete",
+                     entry("DELETED=%zu", deleted));
+    pending.clear();
+    inProgress = false;
+}
+
+static void deleteNext()
+{
+    if (pending.empty())
+    {
+        finish();
+        return;
+    }
+    auto [path, service] = std::move(pending.back());
+    pending.pop_back();
+    getSdBus()->async_method_call(
+        [path = path](const boost::system::error_code& ec) {
+            if (ec)
+            {
+                log<level::ERR>("Failed to delete SEL entry",
+                                entry("PATH=%s", path.c_str()),
+                                entry("ERROR=%s", ec.message().c_str()));
+            }
+            else
+            {
+                deleted++;
+            }
+            deleteNext();
+        },
+        service, path, ipmi::sel::logDeleteIntf, "Delete");
+}
+
+static void deleteEach()
+{
+    getSdBus()->async_method_call(
+        [](const boost::system::error_code& ec,
+           const ipmi::ObjectTree& objectTree) {
+            if (ec)
+            {
+                // no entries or no mapper, nothing left to erase
+                finish();
+                return;
+            }
+            for (const auto& [path, services] : objectTree)
+            {
+                if (!services.empty())
+                {
+                    pending.emplace_back(path, services.begin()->first);
+                }
+            }
+            deleteNext();
+        },
+        ipmi::sel::mapperBusName, ipmi::sel::mapperObjPath,
+        ipmi::sel::mapperIntf, "GetSubTree", ipmi::sel::logBasePath, 0,
+        std::vector<std::string>{ipmi::sel::logEntryIntf});
+}
+
+static void start()
+{
+    inProgress = true;
+    deleted = 0;
+    getSdBus()->async_method_call(
+        [](const boost::system::error_code& ec,
+           const std::map<std::string, std::vector<std::string>>& services) {
+            if (ec || services.empty())
+            {
+                deleteEach();
+                return;
+            }
+            getSdBus()->async_method_call(
+                [](const boost::system::error_code& ec) {
+                    if (ec)
+                    {
+                        deleteEach();
+                        return;
+                    }
+                    finish();
+                },
+                services.begin()->first, ipmi::sel::logObjPath,
+                ipmi::sel::logDeleteAllIntf, "DeleteAll");
+        },
+        ipmi::sel::mapperBusName, ipmi::sel::mapperObjPath,
+        ipmi::sel::mapperIntf, "GetObject", ipmi::sel::logObjPath,
+        std::vector<std::string>{ipmi::sel::logDeleteAllIntf});
+}
+} // namespace erase
+
 /** @brief implements the Clear SEL command
  * @request
  *   - reservationID   // Reservation ID.
@@ -885,7 +1493,8 @@ ipmi::RspType<uint16_t // deleted record ID
  *   - eraseOperation; // requested operation.
  *
  *  @returns ipmi completion code plus response data
- *   - erase status
+ *   - erase status, erasure in progress until the background erasure of
+ *     the logging entries is done
  */
 
 ipmi::RspType<uint8_t // erase status
@@ -904,81 +1513,24 @@ ipmi::RspType<uint8_t // erase status
         return ipmi::responseInvalidReservationId();
     }
 
-    /*
-     * Erasure status cannot be fetched from DBUS, so always return erasure
-     * status as `erase completed`.
-     */
     if (eraseOperation == ipmi::sel::getEraseStatus)
     {
-        return ipmi::responseSuccess(
-            static_cast<uint8_t>(ipmi::sel::eraseComplete));
+        return ipmi::responseSuccess(static_cast<uint8_t>(
+            erase::inProgress ? ipmi::sel::eraseInProgress
+                              : ipmi::sel::eraseComplete));
     }
 
     // Per the IPMI spec, need to cancel any reservation when the SEL is cleared
     cancelSELReservation();
 
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    ipmi::sel::ObjectPaths objectPaths;
-    auto depth = 0;
-
-    auto mapperCall =
-        bus.new_method_call(ipmi::sel::mapperBusName, ipmi::sel::mapperObjPath,
-                            ipmi::sel::mapperIntf, "GetSubTreePaths");
-    mapperCall.append(ipmi::sel::logBasePath);
-    mapperCall.append(depth);
-    mapperCall.append(ipmi::sel::ObjectPaths({ipmi::sel::logEntryIntf}));
-
-    try
-    {
-        auto reply = bus.call(mapperCall);
-        if (reply.is_method_error())
-        {
-            return ipmi::responseSuccess(
-                static_cast<uint8_t>(ipmi::sel::eraseComplete));
-        }
-
-        reply.read(objectPaths);
-        if (objectPaths.empty())
-        {
-            return ipmi::responseSuccess(
-                static_cast<uint8_t>(ipmi::sel::eraseComplete));
-        }
-    }
-    catch (const sdbusplus::exception::SdBusError& e)
-    {
-        return ipmi::responseSuccess(
-            static_cast<uint8_t>(ipmi::sel::eraseComplete));
-    }
-
-    std::string service;
-
-    try
-    {
-        service = ipmi::getService(bus, ipmi::sel::logDeleteIntf,
-                                   objectPaths.front());
-    }
-    catch (const std::runtime_error& e)
-    {
-        log<level::ERR>(e.what());
-        return ipmi::responseUnspecifiedError();
-    }
-
-    for (const auto& iter : objectPaths)
+    // The removed entries leave the cache through the InterfacesRemoved
+    // signals as they are deleted.
+    if (!erase::inProgress)
     {
-        auto methodCall = bus.new_method_call(
-            service.c_str(), iter.c_str(), ipmi::sel::logDeleteIntf, "Delete");
-
-        auto reply = bus.call(methodCall);
-        if (reply.is_method_error())
-        {
-            return ipmi::responseUnspecifiedError();
-        }
+        erase::start();
     }
-
-    // Invalidate the cache of dbus entry objects.
-    cache::paths.clear();
     return ipmi::responseSuccess(
-        static_cast<uint8_t>(ipmi::sel::eraseComplete));
+        static_cast<uint8_t>(ipmi::sel::eraseInProgress));
 }
 #endif
 
@@ -1090,7 +1642,48 @@ ipmi::RspType<uint16_t> ipmiStorageReserveSel()
     return ipmi::responseSuccess(reserveSel());
 }
 
-#ifdef JOURNAL_SEL
+#if defined(RING_SEL)
+/** @brief implements the Add SEL Entry command on the SEL ring
+ *  @param recordID - ignored, the ring assigns the record ID
+ *  @param recordType - record type
+ *  @param content - the rest of the record
+ *
+ *  @returns IPMI completion code plus response data
+ *   - recordID - record ID of the added record
+ */
+ipmi::RspType<uint16_t> ipmiStorageAddSEL(
+    uint16_t recordID, uint8_t recordType,
+    std::array<uint8_t, ipmi::sel::oemEventSize> content)
+{
+    // Per the IPMI spec, need to cancel any reservation when a SEL entry is
+    // added
+    cancelSELReservation();
+
+    // not queued like the SEL logger calls: the ring assigns the record ID
+    // as it writes the record to the page cache, without a D-Bus round trip
+    // or an fsync to wait for
+    ipmi::sel::Ring::Record record;
+    record[2] = recordType;
+    std::copy(content.begin(), content.end(), record.begin() + 3);
+
+    // the SEL device timestamps every record that has a timestamp field
+    uint32_t timestamp = std::time(nullptr);
+    if (recordType < ipmi::sel::oemEventFirst)
+    {
+        record[3] = static_cast<uint8_t>(timestamp);
+        record[4] = static_cast<uint8_t>(timestamp >> 8);
+        record[5] = static_cast<uint8_t>(timestamp >> 16);
+        record[6] = static_cast<uint8_t>(timestamp >> 24);
+    }
+
+    if (!getSELRing().add(record, timestamp))
+    {
+        return ipmi::responseUnspecifiedError();
+    }
+    recordID = record[0] | (record[1] << 8);
+    return ipmi::responseSuccess(recordID);
+}
+#elif defined(JOURNAL_SEL)
 #if 0
 static void toHexStr(const boost::beast::span<uint8_t> bytes,
                      std::string& hexStr)
@@ -1167,66 +1760,34 @@ ipmi::RspType<uint16_t> ipmiStorageAddSEL(
         recordID, recordType, timestamp, generatorID, evmRev, sensorType,
         sensorNum, eventType, eventData);
 #endif
-    static constexpr char const* ipmiSELObject =
-        "xyz.openbmc_project.Logging.IPMI";
-    static constexpr char const* ipmiSELPath =
-        "/xyz/openbmc_project/Logging/IPMI";
-    static constexpr char const* ipmiSELAddInterface =
-        "xyz.openbmc_project.Logging.IPMI";
-    static const std::string ipmiSELAddMessage =
-        "IPMI SEL entry logged using IPMI Add SEL Entry command.";
-
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-
+    SELAddQueue::Entry entry{recordType,
+                             {},
+                             {eventData.begin(), eventData.end()},
+                             true,
+                             generatorID,
+                             0};
     if (recordType == ipmi::sel::systemEvent)
     {
-        std::string sensorPath = getPathFromSensorNumber(sensorNum);
-        if(sensorPath.length() == 0){
-            return ipmi::responseSensorInvalid();
-        }
-
-        bool assert =
-            (eventType & ipmi::sel::deassertionEvent) ? false : true;
-        uint16_t genId = generatorID;
-        sdbusplus::message::message writeSEL = bus.new_method_call(
-            ipmiSELObject, ipmiSELPath, ipmiSELAddInterface, "IpmiSelAdd");
-        writeSEL.append(ipmiSELAddMessage, sensorPath, eventData, assert,
-                        genId);
-        try
-        {
-            sdbusplus::message::message writeSELResp = bus.call(writeSEL);
-            writeSELResp.read(recordID);
-        }
-        catch (sdbusplus::exception_t& e)
-        {
-            log<level::ERR>(e.what());
-            return ipmi::responseUnspecifiedError();
-        }
-    }
-    else if (recordType >= ipmi::sel::oemTsEventFirst &&
-             recordType <= ipmi::sel::oemEventLast)
-    {
-        sdbusplus::message::message writeSEL = bus.new_method_call(
-            ipmiSELObject, ipmiSELPath, ipmiSELAddInterface, "IpmiSelAddOem");
-        writeSEL.append(ipmiSELAddMessage, eventData, recordType);
-        try
-        {
-            sdbusplus::message::message writeSELResp = bus.call(writeSEL);
-            writeSELResp.read(recordID);
-        }
-        catch (sdbusplus::exception_t& e)
+        entry.sensorPath = getPathFromSensorNumber(sensorNum);
+        if (entry.sensorPath.empty())
         {
-            log<level::ERR>(e.what());
-            return ipmi::responseUnspecifiedError();
+            return ipmi::responseSensorInvalid();
         }
+        entry.assert = !(eventType & ipmi::sel::deassertionEvent);
     }
-    else
+    else if (recordType < ipmi::sel::oemTsEventFirst ||
+             recordType > ipmi::sel::oemEventLast)
     {
         return ipmi::responseUnspecifiedError();
     }
 
-   // uint16_t responseID = 0xFFFF;
-    return ipmi::responseSuccess(recordID);
+    std::optional<uint16_t> queuedID =
+        getSELAddQueue().push(std::move(entry));
+    if (!queuedID)
+    {
+        return ipmi::responseBusy();
+    }
+    return ipmi::responseSuccess(*queuedID);
 }
 #else  // JOURNAL_SEL not used
 /** @brief implements the Add SEL entry command
@@ -1271,6 +1832,64 @@ ipmi::RspType<uint16_t // recordID of the Added SEL entry
 }
 #endif // JOURNAL_SEL
 
+namespace ipmi::sel
+{
+
+bool addSystemEvent(const std::string& sensorPath,
+                    std::vector<uint8_t>&& eventData, bool assert,
+                    uint16_t generatorID, uint8_t sensorType,
+                    uint8_t sensorNumber, uint8_t eventType)
+{
+#if defined(RING_SEL)
+    // Per the IPMI spec, need to cancel any reservation when a SEL entry is
+    // added
+    cancelSELReservation();
+
+    uint32_t timestamp = std::time(nullptr);
+    ipmi::sel::Ring::Record record;
+    record.fill(0xFF);
+    record[2] = systemEvent;
+    record[3] = static_cast<uint8_t>(timestamp);
+    record[4] = static_cast<uint8_t>(timestamp >> 8);
+    record[5] = static_cast<uint8_t>(timestamp >> 16);
+    record[6] = static_cast<uint8_t>(timestamp >> 24);
+    record[7] = static_cast<uint8_t>(generatorID);
+    record[8] = static_cast<uint8_t>(generatorID >> 8);
+    record[9] = eventMsgRev;
+    record[10] = sensorType;
+    record[11] = sensorNumber;
+    record[12] = (assert ? 0 : directionMask) | (eventType & ~directionMask);
+    std::copy_n(eventData.begin(), std::min<size_t>(eventData.size(), 3),
+                record.begin() + 13);
+    if (!getSELRing().add(record, timestamp))
+    {
+        log<level::ERR>("Failed to log platform event",
+                        entry("PATH=%s", sensorPath.c_str()));
+    }
+    return true;
+#elif defined(JOURNAL_SEL)
+    // through the Add SEL Entry queue, so that its record IDs stay right
+    SELAddQueue::Entry entry{systemEvent, sensorPath, std::move(eventData),
+                             assert,      generatorID, 0,
+                             ipmiSELAddMessage};
+    return getSELAddQueue().push(std::move(entry)).has_value();
+#else
+    getSdBus()->async_method_call(
+        [](const boost::system::error_code& ec, uint16_t) {
+            if (ec)
+            {
+                log<level::ERR>("Failed to log platform event",
+                                entry("ERROR=%s", ec.message().c_str()));
+            }
+        },
+        ipmiSELService, ipmiSELPath, ipmiSELAddInterface, "IpmiSelAdd",
+        ipmiSELAddMessage, sensorPath, eventData, assert, generatorID);
+    return true;
+#endif
+}
+
+} // namespace ipmi::sel
+
 /** @brief implements the get FRU Inventory Area Info command
  *
  *  @returns IPMI completion code plus response data
@@ -1408,7 +2027,12 @@ void register_netfn_storage_functions()
                           ipmi::storage::cmdGetSelEntry, ipmi::Privilege::User,
                           ipmiStorageGetSELEntry);
 
-#ifndef JOURNAL_SEL
+    // <Read SEL Chunk>
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::readSelChunkCmd, ipmi::Privilege::User,
+                             ipmiStorageReadSELChunk);
+
+#if !defined(JOURNAL_SEL) && !defined(RING_SEL)
     // <Delete SEL Entry>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnStorage,
                           ipmi::storage::cmdDeleteSelEntry,
@@ -1437,7 +2061,8 @@ void register_netfn_storage_functions()
     // <Get Repository Info>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnStorage,
                           ipmi::storage::cmdGetSdrRepositoryInfo,
-                          ipmi::Privilege::User, ipmiGetRepositoryInfo);
+                          ipmi::Privilege::User, ipmi::CachePolicy{},
+                          ipmiGetRepositoryInfo);
 
     // <Reserve SDR Repository>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnStorage,
@@ -1445,9 +2070,11 @@ void register_netfn_storage_functions()
                           ipmi::Privilege::User, ipmiSensorReserveSdr);
 
     // <Get SDR>
-    ipmi_register_callback(NETFUN_STORAGE, IPMI_CMD_GET_SDR, nullptr,
-                           ipmi_sen_get_sdr, PRIVILEGE_USER);
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnStorage,
+                          ipmi::storage::cmdGetSdr, ipmi::Privilege::User,
+                          ipmiSensorGetSdr);
 
     ipmi::fru::registerCallbackHandler();
+    ipmi::fru::prefetchFruAreaData();
     return;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 // IPMI commands for Storage net functions.
 enum ipmi_netfn_storage_cmds
@@ -21,3 +23,32 @@ enum ipmi_netfn_storage_cmds
     IPMI_CMD_SET_SEL_TIME = 0x49,
 
 };
+
+namespace ipmi
+{
+namespace sel
+{
+
+/** @brief log a system event SEL entry without waiting for the SEL logger
+ *
+ *  With the journal SEL the entry joins the Add SEL Entry write-behind
+ *  queue, with the SEL ring it is added to the ring, the other builds send
+ *  it to the SEL logger asynchronously.
+ *
+ *  @param[in] sensorPath - D-Bus path, or origin, of the event
+ *  @param[in] eventData - the 1 to 3 event data bytes
+ *  @param[in] assert - assertion or deassertion event
+ *  @param[in] generatorID - generator ID of the event
+ *  @param[in] sensorType - sensor type of the event
+ *  @param[in] sensorNumber - sensor number of the event
+ *  @param[in] eventType - event/reading type code of the event
+ *
+ *  @return false if the SEL queue is full and the entry was not taken
+ */
+bool addSystemEvent(const std::string& sensorPath,
+                    std::vector<uint8_t>&& eventData, bool assert,
+                    uint16_t generatorID, uint8_t sensorType,
+                    uint8_t sensorNumber, uint8_t eventType);
+
+} // namespace sel
+} // namespace ipmi
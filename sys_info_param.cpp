@@ -1,33 +1,98 @@
 #include "sys_info_param.hpp"
 
-std::tuple<bool, std::string>
-    SysInfoParamStore::lookup(uint8_t paramSelector) const
+#include <algorithm>
+
+namespace
+{
+
+constexpr size_t blockSize = 16;
+constexpr size_t blockOverhead = 2;
+
+std::vector<uint8_t> makeBlocks(const std::string& s)
+{
+    size_t size = s.length() + blockOverhead;
+    std::vector<uint8_t> blocks(std::max(size, blockSize), 0x00);
+    blocks[0] = 0;          // encoding
+    blocks[1] = s.length(); // string length
+    std::copy(s.begin(), s.end(), blocks.begin() + blockOverhead);
+    return blocks;
+}
+
+} // namespace
+
+const SysInfoParamStore::Param*
+    SysInfoParamStore::fetch(uint8_t paramSelector) const
 {
     const auto iterator = params.find(paramSelector);
     if (iterator == params.end())
+    {
+        return nullptr;
+    }
+
+    Param& param = iterator->second;
+    if (!param.value)
+    {
+        param.value = param.callback();
+        param.blocks = makeBlocks(*param.value);
+    }
+    return &param;
+}
+
+std::tuple<bool, std::string>
+    SysInfoParamStore::lookup(uint8_t paramSelector) const
+{
+    const Param* param = fetch(paramSelector);
+    if (!param)
     {
         return std::make_tuple(false, "");
     }
+    return std::make_tuple(true, *param->value);
+}
 
-    auto& callback = iterator->second;
-    auto s = callback();
-    return std::make_tuple(true, s);
+std::tuple<bool, std::optional<std::vector<uint8_t>>>
+    SysInfoParamStore::lookup(uint8_t paramSelector, uint8_t setSelector) const
+{
+    const Param* param = fetch(paramSelector);
+    if (!param)
+    {
+        return std::make_tuple(false, std::nullopt);
+    }
+
+    // Block 0 is always whole, the others end with the string.
+    size_t size = param->value->length() + blockOverhead;
+    size_t offset = setSelector * blockSize;
+    if (setSelector != 0 && offset >= size)
+    {
+        return std::make_tuple(true, std::nullopt);
+    }
+    size_t count = setSelector ? std::min(size - offset, blockSize) : blockSize;
+    auto begin = param->blocks.begin() + offset;
+    return std::make_tuple(true, std::vector<uint8_t>(begin, begin + count));
 }
 
 void SysInfoParamStore::update(uint8_t paramSelector, const std::string& s)
 {
-    // Add a callback that captures a copy of the string passed and returns it
-    // when invoked.
-
-    // clang-format off
-    update(paramSelector, [s]() {
-        return s;
-    });
-    // clang-format on
+    Param& param = params[paramSelector];
+    param.callback = nullptr;
+    param.value = s;
+    param.blocks = makeBlocks(s);
 }
 
 void SysInfoParamStore::update(uint8_t paramSelector,
                                const std::function<std::string()>& callback)
 {
-    params[paramSelector] = callback;
+    Param& param = params[paramSelector];
+    param.callback = callback;
+    param.value.reset();
+    param.blocks.clear();
+}
+
+void SysInfoParamStore::invalidate(uint8_t paramSelector)
+{
+    const auto iterator = params.find(paramSelector);
+    if (iterator != params.end() && iterator->second.callback)
+    {
+        iterator->second.value.reset();
+        iterator->second.blocks.clear();
+    }
 }
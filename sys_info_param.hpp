@@ -3,8 +3,10 @@
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <optional>
 #include <string>
 #include <tuple>
+#include <vector>
 
 /**
  * Key-value store for string-type system info parameters.
@@ -27,6 +29,20 @@ class SysInfoParamStoreIntf
     virtual std::tuple<bool, std::string>
         lookup(uint8_t paramSelector) const = 0;
 
+    /**
+     * Returns one block of a parameter as sent in the Get System Info
+     * Parameters response: block 0 holds the encoding, the string length and
+     * the first 14 bytes of the string, padded to 16 bytes, the following
+     * blocks hold 16 bytes of the string each.
+     *
+     * @param[in] paramSelector - the key to lookup.
+     * @param[in] setSelector - the block to return.
+     * @return tuple of bool and block, true if parameter is found, the block
+     * is unset if it is past the end of the parameter.
+     */
+    virtual std::tuple<bool, std::optional<std::vector<uint8_t>>>
+        lookup(uint8_t paramSelector, uint8_t setSelector) const = 0;
+
     /**
      * Update a parameter by its code with a string value.
      *
@@ -37,8 +53,8 @@ class SysInfoParamStoreIntf
 
     /**
      * Update a parameter by its code with a callback that is called to retrieve
-     * its value whenever called. Callback must be idempotent, as it may be
-     * called multiple times by the host to retrieve the parameter by chunks.
+     * its value. The value is kept until the parameter is invalidated, so the
+     * host reading the parameter by blocks gets a consistent value.
      *
      * @param[in] paramSelector - the key to update.
      * @param[in] callback - the callback to use for parameter retrieval.
@@ -46,21 +62,46 @@ class SysInfoParamStoreIntf
     virtual void update(uint8_t paramSelector,
                         const std::function<std::string()>& callback) = 0;
 
+    /**
+     * Drop the value retrieved from the callback of a parameter, so the next
+     * lookup calls it again. Meant to be called when the source of the value
+     * signals a change.
+     *
+     * @param[in] paramSelector - the key to invalidate.
+     */
+    virtual void invalidate(uint8_t paramSelector) = 0;
+
     // TODO: Store "read-only" flag for each parameter.
     // TODO: Function to erase a parameter?
 };
 
 /**
- * Implement the system info parameters store as a map of callbacks.
+ * Implement the system info parameters store as a map of callbacks, each
+ * with the response blocks of its last value.
  */
 class SysInfoParamStore : public SysInfoParamStoreIntf
 {
   public:
     std::tuple<bool, std::string> lookup(uint8_t paramSelector) const override;
+    std::tuple<bool, std::optional<std::vector<uint8_t>>>
+        lookup(uint8_t paramSelector, uint8_t setSelector) const override;
     void update(uint8_t paramSelector, const std::string& s) override;
     void update(uint8_t paramSelector,
                 const std::function<std::string()>& callback) override;
+    void invalidate(uint8_t paramSelector) override;
 
   private:
-    std::map<uint8_t, std::function<std::string()>> params;
+    struct Param
+    {
+        /** @brief producer of the value, unset for string values */
+        std::function<std::string()> callback;
+        std::optional<std::string> value;
+        /** @brief encoding, length and string, padded to a whole block */
+        std::vector<uint8_t> blocks;
+    };
+
+    /** @brief gets the parameter with its value and blocks built */
+    const Param* fetch(uint8_t paramSelector) const;
+
+    mutable std::map<uint8_t, Param> params;
 };
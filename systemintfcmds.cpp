@@ -4,10 +4,13 @@
 
 #include "host-cmd-manager.hpp"
 #include "host-interface.hpp"
+#include "ipmb-bridge.hpp"
 
-#include <cstring>
+#include <array>
 #include <ipmid-host/cmd.hpp>
 #include <ipmid/api.hpp>
+#include <string>
+#include <vector>
 
 void register_netfn_app_functions() __attribute__((constructor));
 
@@ -20,47 +23,20 @@ extern cmdManagerPtr& ipmid_get_host_cmd_manager();
 //-------------------------------------------------------------------
 // Called by Host post response from Get_Message_Flags
 //-------------------------------------------------------------------
-ipmi_ret_t ipmi_app_read_event(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                               ipmi_request_t request, ipmi_response_t response,
-                               ipmi_data_len_t data_len, ipmi_context_t context)
+ipmi::RspType<phosphor::host::command::EventRecord>
+    ipmiAppReadEventBuffer(ipmi::Context::ptr ctx)
 {
-    ipmi_ret_t rc = IPMI_CC_OK;
-
-    struct oem_sel_timestamped oem_sel = {0};
-    *data_len = sizeof(struct oem_sel_timestamped);
-
-    // either id[0] -or- id[1] can be filled in. We will use id[0]
-    oem_sel.id[0] = SEL_OEM_ID_0;
-    oem_sel.id[1] = SEL_OEM_ID_0;
-    oem_sel.type = SEL_RECORD_TYPE_OEM;
-
-    // Following 3 bytes are from IANA Manufactre_Id field. See below
-    oem_sel.manuf_id[0] = 0x41;
-    oem_sel.manuf_id[1] = 0xA7;
-    oem_sel.manuf_id[2] = 0x00;
-
-    // per IPMI spec NetFuntion for OEM
-    oem_sel.netfun = 0x3A;
-
-    // Read from the Command Manager queue. What gets returned is a
-    // pair of <command, data> that can be directly used here
-    auto hostCmd = ipmid_get_host_cmd_manager()->getNextCommand();
-    oem_sel.cmd = hostCmd.first;
-    oem_sel.data[0] = hostCmd.second;
-
-    // All '0xFF' since unused.
-    std::memset(&oem_sel.data[1], 0xFF, 3);
-
-    // Pack the actual response
-    std::memcpy(response, &oem_sel, *data_len);
-    return rc;
+    // Read from the Command Manager ring of the host asking. What gets
+    // returned is the OEM SEL record the command was staged in, encoded
+    return ipmi::responseSuccess(ipmid_get_host_cmd_manager()->readEvent(
+        static_cast<phosphor::host::command::HostId>(ctx->hostIdx)));
 }
 
 //---------------------------------------------------------------------
-// Called by Host on seeing a SMS_ATN bit set. Return a hardcoded
-// value of 0x2 indicating we need Host read some data.
+// Called by Host on seeing a SMS_ATN bit set. Return 0x2 indicating we
+// need Host read some data, while the Command Manager has some.
 //-------------------------------------------------------------------
-ipmi::RspType<uint8_t> ipmiAppGetMessageFlags()
+ipmi::RspType<uint8_t> ipmiAppGetMessageFlags(ipmi::Context::ptr ctx)
 {
     // From IPMI spec V2.0 for Get Message Flags Command :
     // bit:[1] from LSB : 1b = Event Message Buffer Full.
@@ -68,8 +44,21 @@ ipmi::RspType<uint8_t> ipmiAppGetMessageFlags()
     // or when the Event Message buffer is disabled.
     // This path is used to communicate messages to the host
     // from within the phosphor::host::command::Manager
+    // bit:[0] from LSB : 1b = Receive Message Available, the responses
+    // to the requests the host bridged with Send Message.
+    constexpr uint8_t setReceiveMsgAvailable = 0x1;
     constexpr uint8_t setEventMsgBufferFull = 0x2;
-    return ipmi::responseSuccess(setEventMsgBufferFull);
+    uint8_t flags = 0;
+    if (ipmi::ipmb::messageAvailable(static_cast<uint8_t>(ctx->channel)))
+    {
+        flags |= setReceiveMsgAvailable;
+    }
+    if (ipmid_get_host_cmd_manager()->eventBufferFull(
+            static_cast<phosphor::host::command::HostId>(ctx->hostIdx)))
+    {
+        flags |= setEventMsgBufferFull;
+    }
+    return ipmi::responseSuccess(flags);
 }
 
 ipmi::RspType<bool,    // Receive Message Queue Interrupt Enabled
@@ -127,7 +116,7 @@ ipmi::RspType<> ipmiAppSetBMCGlobalEnable(
 namespace
 {
 // Static storage to keep the object alive during process life
-std::unique_ptr<phosphor::host::command::Host> host
+std::vector<std::unique_ptr<phosphor::host::command::Host>> hosts
     __attribute__((init_priority(101)));
 std::unique_ptr<sdbusplus::server::manager::manager> objManager
     __attribute__((init_priority(101)));
@@ -137,8 +126,9 @@ void register_netfn_app_functions()
 {
 
     // <Read Event Message Buffer>
-    ipmi_register_callback(NETFUN_APP, IPMI_CMD_READ_EVENT, NULL,
-                           ipmi_app_read_event, SYSTEM_INTERFACE);
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
+                          ipmi::app::cmdReadEventMessageBuffer,
+                          ipmi::Privilege::Admin, ipmiAppReadEventBuffer);
 
     // <Set BMC Global Enables>
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
@@ -155,9 +145,6 @@ void register_netfn_app_functions()
                           ipmi::app::cmdGetMessageFlags, ipmi::Privilege::Admin,
                           ipmiAppGetMessageFlags);
 
-    // Create new xyz.openbmc_project.host object on the bus
-    auto objPath = std::string{CONTROL_HOST_OBJ_MGR} + '/' + HOST_NAME + '0';
-
     std::unique_ptr<sdbusplus::asio::connection>& sdbusp =
         ipmid_get_sdbus_plus_handler();
 
@@ -165,8 +152,15 @@ void register_netfn_app_functions()
     objManager = std::make_unique<sdbusplus::server::manager::manager>(
         *sdbusp, CONTROL_HOST_OBJ_MGR);
 
-    host = std::make_unique<phosphor::host::command::Host>(*sdbusp,
-                                                           objPath.c_str());
+    // Create new xyz.openbmc_project.host object on the bus for every host
+    for (phosphor::host::command::HostId hostId = 0;
+         hostId < CONTROL_HOST_INSTANCES; hostId++)
+    {
+        auto objPath = std::string{CONTROL_HOST_OBJ_MGR} + '/' + HOST_NAME +
+                       std::to_string(hostId);
+        hosts.emplace_back(std::make_unique<phosphor::host::command::Host>(
+            *sdbusp, objPath.c_str(), hostId));
+    }
     sdbusp->request_name(CONTROL_HOST_BUSNAME);
 
     return;
@@ -0,0 +1,250 @@
+#include "harness.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <ipmid/handler.hpp>
+#include <memory>
+#include <sdbusplus/bus/match.hpp>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/* The response cache of the dispatcher of ipmid, as handlers registered
+ * with a CachePolicy use it, on a session bus (dbus-run-session). */
+
+namespace
+{
+
+constexpr const char* testPath = "/xyz/openbmc_project/ipmi/cache_unittest";
+constexpr const char* testIntf = "xyz.openbmc_project.Ipmi.CacheUnittest";
+constexpr const char* testSignal = "Changed";
+
+const std::string changedRule =
+    sdbusplus::bus::match::rules::type::signal() +
+    sdbusplus::bus::match::rules::path(testPath) +
+    sdbusplus::bus::match::rules::interface(testIntf) +
+    sdbusplus::bus::match::rules::member(testSignal);
+
+bool haveSessionBus()
+{
+    sd_bus* bus = nullptr;
+    if (sd_bus_open_user(&bus) < 0)
+    {
+        return false;
+    }
+    sd_bus_flush_close_unref(bus);
+    return true;
+}
+
+class ResponseCache : public testing::Test
+{
+  protected:
+    static void SetUpTestSuite()
+    {
+        if (!haveSessionBus())
+        {
+            return;
+        }
+        providers = std::filesystem::temp_directory_path() /
+                    "ipmid-cache-unittest";
+        std::filesystem::create_directories(providers);
+        io = std::make_shared<boost::asio::io_context>();
+        ipmi::benchmark::startDispatcher(io, providers);
+    }
+
+    static void TearDownTestSuite()
+    {
+        if (io)
+        {
+            std::filesystem::remove(providers);
+        }
+    }
+
+    void SetUp() override
+    {
+        if (!io)
+        {
+            GTEST_SKIP() << "no session bus, run under dbus-run-session";
+        }
+        io->restart();
+        changed = std::make_unique<sdbusplus::bus::match_t>(
+            *ipmi::getSdBus(), changedRule,
+            [this](sdbusplus::message::message&) { signals++; });
+    }
+
+    void TearDown() override
+    {
+        changed.reset();
+    }
+
+    /* one request through the cache, answered by the handler with cc and
+     * the number of times it was called */
+    ipmi::message::Response::ptr
+        call(ipmi::impl::ResponseCache& cache, std::vector<uint8_t> data,
+             const std::function<void(ipmi::Context::ptr)>& handler = {})
+    {
+        ipmi::message::Response::ptr response;
+        boost::asio::spawn(*io, [&](boost::asio::yield_context yield) {
+            auto ctx = std::make_shared<ipmi::Context>(
+                ipmi::getSdBus(), ipmi::netFnOemOne, 0, 0x01,
+                ipmi::channelSystemIface, 0, 0, ipmi::Privilege::Admin, 0, 0,
+                yield);
+            auto request =
+                std::make_shared<ipmi::message::Request>(ctx, std::move(data));
+            response = ipmi::impl::callCached(cache, request, [&]() {
+                calls++;
+                if (handler)
+                {
+                    handler(ctx);
+                }
+                auto response = request->makeResponse();
+                response->cc = cc;
+                response->payload.pack(static_cast<uint8_t>(calls));
+                return response;
+            });
+            io->stop();
+        });
+        io->run();
+        io->restart();
+        return response;
+    }
+
+    void emitChanged()
+    {
+        auto signal =
+            ipmi::getSdBus()->new_signal(testPath, testIntf, testSignal);
+        signal.signal_send();
+    }
+
+    /* yield until the signals sent so far are dispatched, the matches of
+     * the cache see them along with the one of the test */
+    void awaitChanged(ipmi::Context::ptr ctx, size_t count)
+    {
+        boost::asio::steady_timer timer(*io);
+        for (int i = 0; signals < count && i < 100; i++)
+        {
+            timer.expires_after(std::chrono::milliseconds(10));
+            boost::system::error_code ec;
+            timer.async_wait(ctx->yield[ec]);
+        }
+    }
+
+    static std::vector<uint8_t> data(ipmi::message::Response::ptr response)
+    {
+        return response->payload.raw;
+    }
+
+    static inline std::shared_ptr<boost::asio::io_context> io;
+    static inline std::filesystem::path providers;
+    std::unique_ptr<sdbusplus::bus::match_t> changed;
+    size_t signals = 0;
+    size_t calls = 0;
+    ipmi::Cc cc = ipmi::ccSuccess;
+};
+
+TEST_F(ResponseCache, RepeatedRequestIsAHit)
+{
+    auto cache = ipmi::impl::makeResponseCache({});
+
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {0x10})));
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {0x10})));
+    EXPECT_EQ(1u, calls);
+
+    // other request data is another entry
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {0x11})));
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {0x10})));
+    EXPECT_EQ(2u, calls);
+}
+
+TEST_F(ResponseCache, FailedResponseIsNotCached)
+{
+    auto cache = ipmi::impl::makeResponseCache({});
+
+    cc = ipmi::ccBusy;
+    EXPECT_EQ(ipmi::ccBusy, call(*cache, {})->cc);
+    cc = ipmi::ccSuccess;
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(2u, calls);
+}
+
+TEST_F(ResponseCache, SignalDropsTheEntries)
+{
+    auto cache = ipmi::impl::makeResponseCache({{changedRule}, {}, {}});
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {})));
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {})));
+
+    // another request waits for the signal to come in
+    emitChanged();
+    call(*cache, {0xff},
+         [this](ipmi::Context::ptr ctx) { awaitChanged(ctx, 1); });
+    ASSERT_EQ(1u, signals);
+    EXPECT_EQ(std::vector<uint8_t>{3}, data(call(*cache, {})));
+    EXPECT_EQ(3u, calls);
+}
+
+TEST_F(ResponseCache, InvalidationDuringTheCallIsNotCached)
+{
+    auto cache = ipmi::impl::makeResponseCache({{changedRule}, {}, {}});
+    auto invalidate = [this](ipmi::Context::ptr ctx) {
+        emitChanged();
+        awaitChanged(ctx, 1);
+    };
+
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {}, invalidate)));
+    ASSERT_EQ(1u, signals);
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(2u, calls);
+}
+
+TEST_F(ResponseCache, GenerationMismatchDropsTheEntry)
+{
+    uint64_t generation = 0;
+    auto cache = ipmi::impl::makeResponseCache(
+        {{}, {}, [&generation]() { return generation; }});
+
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {})));
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {})));
+    generation++;
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(2u, calls);
+}
+
+TEST_F(ResponseCache, GenerationChangeDuringTheCallIsNotCached)
+{
+    uint64_t generation = 0;
+    auto cache = ipmi::impl::makeResponseCache(
+        {{}, {}, [&generation]() { return generation; }});
+
+    EXPECT_EQ(std::vector<uint8_t>{1},
+              data(call(*cache, {},
+                        [&generation](ipmi::Context::ptr) { generation++; })));
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(std::vector<uint8_t>{2}, data(call(*cache, {})));
+    EXPECT_EQ(2u, calls);
+}
+
+TEST_F(ResponseCache, EntriesExpire)
+{
+    auto cache = ipmi::impl::makeResponseCache(
+        {{}, std::chrono::milliseconds(20), {}});
+
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {})));
+    EXPECT_EQ(std::vector<uint8_t>{1}, data(call(*cache, {})));
+    call(*cache, {0xff}, [](ipmi::Context::ptr ctx) {
+        boost::asio::steady_timer timer(*ipmi::getIoContext(),
+                                        std::chrono::milliseconds(30));
+        boost::system::error_code ec;
+        timer.async_wait(ctx->yield[ec]);
+    });
+    EXPECT_EQ(std::vector<uint8_t>{3}, data(call(*cache, {})));
+}
+
+} // namespace
@@ -0,0 +1,171 @@
+#include "config.h"
+
+#include "harness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/* End to end benchmark of the IPMI dispatcher with the providers of a
+ * directory loaded the way ipmid loads them. The D-Bus objects the providers
+ * query are served by fake services on a second connection in this process,
+ * so it runs on any dev box with a session bus:
+ *
+ *     dbus-run-session -- ./dispatch_benchmark <providers dir>
+ *
+ * Every request is timed from executeIpmiCommand to its response; each
+ * benchmark reports requests per second and the p50 and p99 latency. */
+
+namespace
+{
+
+using ipmi::benchmark::Client;
+using Duration = Client::Duration;
+
+constexpr size_t fakeSensors = 32;
+
+// Get SDR and Get SEL Entry walks stop after this many records
+constexpr size_t maxWalk = 256;
+constexpr uint16_t lastRecord = 0xFFFF;
+
+std::shared_ptr<boost::asio::io_context> io;
+
+/* walk a record repository from the first record, the requests take 6 bytes
+ * of data and answer the next record ID first */
+void walk(Client& client, ipmi::NetFn netFn, ipmi::Cmd reserveCmd,
+          ipmi::Cmd getCmd)
+{
+    uint16_t reservation = 0;
+    auto reserved = client.execute(netFn, reserveCmd, {});
+    if (reserved->cc != ipmi::ccSuccess ||
+        reserved->payload.unpack(reservation) != 0)
+    {
+        return;
+    }
+    uint16_t recordID = 0;
+    for (size_t i = 0; i < maxWalk && recordID != lastRecord; i++)
+    {
+        auto record = client.execute(
+            netFn, getCmd,
+            {static_cast<uint8_t>(reservation),
+             static_cast<uint8_t>(reservation >> 8),
+             static_cast<uint8_t>(recordID),
+             static_cast<uint8_t>(recordID >> 8), 0x00, 0xFF});
+        if (record->cc != ipmi::ccSuccess ||
+            record->payload.unpack(recordID) != 0)
+        {
+            return;
+        }
+    }
+}
+
+/* run a request mix on the dispatcher io, the way requests arrive there */
+template <typename Mix>
+void run(benchmark::State& state, Mix&& mix)
+{
+    std::vector<Duration> latencies;
+    boost::asio::spawn(*io, [&](boost::asio::yield_context yield) {
+        Client client(yield);
+        for (auto _ : state)
+        {
+            mix(client);
+        }
+        latencies = std::move(client.latencies);
+        io->stop();
+    });
+    io->restart();
+    io->run();
+
+    if (latencies.empty())
+    {
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto usec = [](Duration d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    };
+    state.SetItemsProcessed(latencies.size());
+    state.counters["requests/s"] =
+        benchmark::Counter(latencies.size(), benchmark::Counter::kIsRate);
+    state.counters["p50_us"] = usec(latencies[latencies.size() / 2]);
+    state.counters["p99_us"] = usec(latencies[latencies.size() * 99 / 100]);
+}
+
+void getDeviceId(benchmark::State& state)
+{
+    run(state, [](Client& client) {
+        client.execute(ipmi::netFnApp, ipmi::app::cmdGetDeviceId, {});
+    });
+}
+BENCHMARK(getDeviceId)->UseRealTime();
+
+void getSensorReadings(benchmark::State& state)
+{
+    size_t count = state.range(0);
+    run(state, [count](Client& client) {
+        for (size_t i = 0; i < count; i++)
+        {
+            client.execute(ipmi::netFnSensor,
+                           ipmi::sensor_event::cmdGetSensorReading,
+                           {static_cast<uint8_t>(i)});
+        }
+    });
+}
+BENCHMARK(getSensorReadings)->Arg(1)->Arg(8)->Arg(fakeSensors)->UseRealTime();
+
+void getSdrWalk(benchmark::State& state)
+{
+    run(state, [](Client& client) {
+        walk(client, ipmi::netFnStorage,
+             ipmi::storage::cmdReserveSdrRepository, ipmi::storage::cmdGetSdr);
+    });
+}
+BENCHMARK(getSdrWalk)->UseRealTime();
+
+void getSelEntries(benchmark::State& state)
+{
+    run(state, [](Client& client) {
+        walk(client, ipmi::netFnStorage, ipmi::storage::cmdReserveSel,
+             ipmi::storage::cmdGetSelEntry);
+    });
+}
+BENCHMARK(getSelEntries)->UseRealTime();
+
+/* what a host agent polls: its identity, every sensor and the newest
+ * events */
+void pollingMix(benchmark::State& state)
+{
+    run(state, [](Client& client) {
+        client.execute(ipmi::netFnApp, ipmi::app::cmdGetDeviceId, {});
+        for (size_t i = 0; i < fakeSensors; i++)
+        {
+            client.execute(ipmi::netFnSensor,
+                           ipmi::sensor_event::cmdGetSensorReading,
+                           {static_cast<uint8_t>(i)});
+        }
+        client.execute(ipmi::netFnStorage, ipmi::storage::cmdGetSelInfo, {});
+    });
+}
+BENCHMARK(pollingMix)->UseRealTime();
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    std::filesystem::path providers =
+        argc > 1 ? argv[1] : HOST_IPMI_LIB_PATH;
+
+    ipmi::benchmark::Dataset dataset;
+    dataset.sensors = fakeSensors;
+    ipmi::benchmark::FakeBus fakeBus(dataset);
+    io = std::make_shared<boost::asio::io_context>();
+    ipmi::benchmark::startDispatcher(io, providers);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
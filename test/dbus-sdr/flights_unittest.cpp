@@ -0,0 +1,207 @@
+#include "harness.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <ipmid/handler.hpp>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/* The request flights of the dispatcher of ipmid, as handlers registered
+ * as Idempotent share them, on a session bus (dbus-run-session). */
+
+namespace
+{
+
+bool haveSessionBus()
+{
+    sd_bus* bus = nullptr;
+    if (sd_bus_open_user(&bus) < 0)
+    {
+        return false;
+    }
+    sd_bus_flush_close_unref(bus);
+    return true;
+}
+
+class RequestFlights : public testing::Test
+{
+  protected:
+    static void SetUpTestSuite()
+    {
+        if (!haveSessionBus())
+        {
+            return;
+        }
+        providers = std::filesystem::temp_directory_path() /
+                    "ipmid-flights-unittest";
+        std::filesystem::create_directories(providers);
+        io = std::make_shared<boost::asio::io_context>();
+        ipmi::benchmark::startDispatcher(io, providers);
+    }
+
+    static void TearDownTestSuite()
+    {
+        if (io)
+        {
+            std::filesystem::remove(providers);
+        }
+    }
+
+    void SetUp() override
+    {
+        if (!io)
+        {
+            GTEST_SKIP() << "no session bus, run under dbus-run-session";
+        }
+        io->restart();
+        flights = ipmi::impl::makeRequestFlights();
+    }
+
+    struct Result
+    {
+        ipmi::message::Response::ptr response;
+        std::exception_ptr error;
+    };
+
+    /* issue the requests at once, the handler answers each with cc and the
+     * number of times it was called, after a delay */
+    std::vector<Result> call(const std::vector<std::vector<uint8_t>>& data)
+    {
+        std::vector<Result> results(data.size());
+        size_t pending = data.size();
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            boost::asio::spawn(*io, [&, i](boost::asio::yield_context yield) {
+                auto ctx = std::make_shared<ipmi::Context>(
+                    ipmi::getSdBus(), ipmi::netFnOemOne, 0, 0x01,
+                    ipmi::channelSystemIface, 0, 0, ipmi::Privilege::Admin, 0,
+                    0, yield);
+                auto request = std::make_shared<ipmi::message::Request>(
+                    ctx, std::vector<uint8_t>(data[i]));
+                try
+                {
+                    results[i].response = ipmi::impl::callCoalesced(
+                        *flights, request, [&]() { return handle(request); });
+                }
+                catch (...)
+                {
+                    results[i].error = std::current_exception();
+                }
+                if (--pending == 0)
+                {
+                    io->stop();
+                }
+            });
+        }
+        io->run();
+        io->restart();
+        return results;
+    }
+
+    ipmi::message::Response::ptr handle(ipmi::message::Request::ptr request)
+    {
+        calls++;
+        boost::asio::steady_timer timer(*io, std::chrono::milliseconds(20));
+        boost::system::error_code ec;
+        timer.async_wait(request->ctx->yield[ec]);
+        if (error)
+        {
+            throw std::runtime_error("handler failed");
+        }
+        auto response = request->makeResponse();
+        response->cc = cc;
+        response->payload.pack(static_cast<uint8_t>(calls));
+        return response;
+    }
+
+    static inline std::shared_ptr<boost::asio::io_context> io;
+    static inline std::filesystem::path providers;
+    std::shared_ptr<ipmi::impl::RequestFlights> flights;
+    size_t calls = 0;
+    ipmi::Cc cc = ipmi::ccSuccess;
+    bool error = false;
+};
+
+TEST_F(RequestFlights, IdenticalRequestsShareOneCall)
+{
+    auto results = call({{0x10}, {0x10}, {0x10}});
+
+    EXPECT_EQ(1u, calls);
+    for (const auto& result : results)
+    {
+        ASSERT_TRUE(result.response);
+        EXPECT_EQ(ipmi::ccSuccess, result.response->cc);
+        EXPECT_EQ(std::vector<uint8_t>{1}, result.response->payload.raw);
+    }
+}
+
+TEST_F(RequestFlights, WaitersGetTheCompletionCodeAndData)
+{
+    cc = ipmi::ccBusy;
+    auto results = call({{}, {}});
+
+    EXPECT_EQ(1u, calls);
+    for (const auto& result : results)
+    {
+        ASSERT_TRUE(result.response);
+        EXPECT_EQ(ipmi::ccBusy, result.response->cc);
+        EXPECT_EQ(std::vector<uint8_t>{1}, result.response->payload.raw);
+    }
+}
+
+TEST_F(RequestFlights, OtherRequestDataRunsApart)
+{
+    auto results = call({{0x10}, {0x11}, {0x10}});
+
+    EXPECT_EQ(2u, calls);
+    ASSERT_TRUE(results[0].response);
+    ASSERT_TRUE(results[1].response);
+    ASSERT_TRUE(results[2].response);
+    EXPECT_EQ(results[0].response->payload.raw,
+              results[2].response->payload.raw);
+    EXPECT_NE(results[0].response->payload.raw,
+              results[1].response->payload.raw);
+}
+
+TEST_F(RequestFlights, FlightEndsWithItsResponse)
+{
+    call({{}});
+    auto results = call({{}});
+
+    EXPECT_EQ(2u, calls);
+    ASSERT_TRUE(results[0].response);
+    EXPECT_EQ(std::vector<uint8_t>{2}, results[0].response->payload.raw);
+}
+
+TEST_F(RequestFlights, ExceptionReachesEveryWaiter)
+{
+    error = true;
+    auto results = call({{}, {}, {}});
+
+    EXPECT_EQ(1u, calls);
+    for (const auto& result : results)
+    {
+        EXPECT_FALSE(result.response);
+        ASSERT_TRUE(result.error);
+        EXPECT_THROW(std::rethrow_exception(result.error),
+                     std::runtime_error);
+    }
+
+    // the flight is erased, the next request calls the handler again
+    error = false;
+    results = call({{}});
+    EXPECT_EQ(2u, calls);
+    ASSERT_TRUE(results[0].response);
+    EXPECT_EQ(std::vector<uint8_t>{2}, results[0].response->payload.raw);
+}
+
+} // namespace
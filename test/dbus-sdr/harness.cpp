@@ -0,0 +1,192 @@
+#include "harness.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+extern void setIoContext(std::shared_ptr<boost::asio::io_context>& newIo);
+extern void setSdBus(std::shared_ptr<sdbusplus::asio::connection>& newBus);
+
+namespace ipmi
+{
+namespace benchmark
+{
+
+namespace
+{
+
+using Interfaces = std::vector<std::string>;
+using Services = std::map<std::string, Interfaces>;
+using Objects = std::map<std::string, Services>;
+
+constexpr const char* mapperService = "xyz.openbmc_project.ObjectMapper";
+constexpr const char* sensorService = "xyz.openbmc_project.FakeSensors";
+constexpr const char* loggingService = "xyz.openbmc_project.Logging";
+constexpr const char* sensorValueInterface = "xyz.openbmc_project.Sensor.Value";
+constexpr const char* logEntryInterface = "xyz.openbmc_project.Logging.Entry";
+constexpr const char* logEntryPrefix = "/xyz/openbmc_project/logging/entry/";
+
+sd_bus* openUserBus()
+{
+    sd_bus* bus = nullptr;
+    sd_bus_open_user(&bus);
+    return bus;
+}
+
+/* sd-bus filter, sees every message the fake services receive */
+int countCall(sd_bus_message* m, void* userdata, sd_bus_error*)
+{
+    uint8_t type = 0;
+    if (sd_bus_message_get_type(m, &type) >= 0 &&
+        type == SD_BUS_MESSAGE_METHOD_CALL)
+    {
+        static_cast<std::atomic<size_t>*>(userdata)->fetch_add(
+            1, std::memory_order_relaxed);
+    }
+    return 0;
+}
+
+/* the objects below root implementing any of the interfaces, all of them
+ * when no interface is given */
+Objects subTree(const Objects& objects, const std::string& root,
+                const Interfaces& filter)
+{
+    Objects found;
+    for (auto object = objects.lower_bound(root);
+         object != objects.end() && object->first.compare(0, root.size(),
+                                                           root) == 0;
+         object++)
+    {
+        bool match = filter.empty();
+        for (const auto& [service, interfaces] : object->second)
+        {
+            for (const std::string& interface : interfaces)
+            {
+                match = match || std::find(filter.begin(), filter.end(),
+                                           interface) != filter.end();
+            }
+        }
+        if (match)
+        {
+            found.emplace(*object);
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+FakeBus::FakeBus(const Dataset& dataset) :
+    conn(std::make_shared<sdbusplus::asio::connection>(io, openUserBus())),
+    server(conn)
+{
+    sd_bus_add_filter(conn->get_bus(), nullptr, countCall, &callCount);
+
+    Objects objects;
+    for (size_t i = 0; i < dataset.sensors; i++)
+    {
+        std::string path = fakeSensorPrefix + std::to_string(i);
+        auto iface = server.add_interface(path, sensorValueInterface);
+        iface->register_property("Value", 20.0 + i);
+        iface->register_property("MaxValue", 127.0);
+        iface->register_property("MinValue", -128.0);
+        iface->initialize();
+        interfaces.push_back(std::move(iface));
+        objects[path][sensorService] = {sensorValueInterface};
+    }
+
+    // SEL entries the way phosphor-sel-logger records them
+    std::string sensorPath = std::string(fakeSensorPrefix) + "0";
+    for (size_t i = 1; i <= dataset.selEntries; i++)
+    {
+        std::string path = logEntryPrefix + std::to_string(i);
+        auto iface = server.add_interface(path, logEntryInterface);
+        iface->register_property("Id", static_cast<uint32_t>(i));
+        iface->register_property("Timestamp",
+                                 static_cast<uint64_t>(1600000000000 + i));
+        iface->register_property("Resolved", false);
+        iface->register_property(
+            "Severity",
+            std::string(
+                "xyz.openbmc_project.Logging.Entry.Level.Informational"));
+        iface->register_property("Message",
+                                 std::string("xyz.openbmc_project.Fake.SEL"));
+        iface->register_property(
+            "AdditionalData",
+            std::vector<std::string>{
+                "RECORD_TYPE=2", "GENERATOR_ID=32", "SENSOR_DATA=010203",
+                "SENSOR_PATH=" + sensorPath, "EVENT_DIR=1"});
+        iface->initialize();
+        interfaces.push_back(std::move(iface));
+        objects[path][loggingService] = {logEntryInterface};
+    }
+
+    auto mapper = server.add_interface("/xyz/openbmc_project/object_mapper",
+                                       "xyz.openbmc_project.ObjectMapper");
+    mapper->register_method(
+        "GetSubTree", [objects](const std::string& root, int32_t,
+                                const Interfaces& filter) {
+            return subTree(objects, root, filter);
+        });
+    mapper->register_method(
+        "GetSubTreePaths", [objects](const std::string& root, int32_t,
+                                     const Interfaces& filter) {
+            std::vector<std::string> paths;
+            for (const auto& object : subTree(objects, root, filter))
+            {
+                paths.push_back(object.first);
+            }
+            return paths;
+        });
+    mapper->register_method(
+        "GetObject", [objects](const std::string& path, const Interfaces&) {
+            auto object = objects.find(path);
+            if (object == objects.end())
+            {
+                return Services{};
+            }
+            return object->second;
+        });
+    mapper->initialize();
+    interfaces.push_back(std::move(mapper));
+
+    conn->request_name(mapperService);
+    conn->request_name(sensorService);
+    conn->request_name(loggingService);
+    thread = std::thread([this]() { io.run(); });
+}
+
+FakeBus::~FakeBus()
+{
+    io.stop();
+    thread.join();
+}
+
+void startDispatcher(std::shared_ptr<boost::asio::io_context>& io,
+                     const std::filesystem::path& providers)
+{
+    setIoContext(io);
+    sd_bus* bus = nullptr;
+    sd_bus_default_user(&bus);
+    auto sdbusp = std::make_shared<sdbusplus::asio::connection>(*io, bus);
+    setSdBus(sdbusp);
+    loadProviders(providers);
+}
+
+message::Response::ptr Client::execute(NetFn netFn, Cmd cmd,
+                                       std::vector<uint8_t>&& data)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto ctx = std::make_shared<Context>(getSdBus(), netFn, 0, cmd,
+                                         channelSystemIface, 0, 0,
+                                         Privilege::Admin, 0, 0, yield);
+    auto request = std::make_shared<message::Request>(ctx, std::move(data));
+    auto response = executeIpmiCommand(request);
+    latencies.push_back(std::chrono::steady_clock::now() - start);
+    return response;
+}
+
+} // namespace benchmark
+} // namespace ipmi
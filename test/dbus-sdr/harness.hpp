@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/spawn.hpp>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <ipmid/api.hpp>
+#include <ipmid/message.hpp>
+#include <memory>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+#include <thread>
+#include <vector>
+
+/* Harness of the dispatcher benchmarks: the dispatcher of ipmid built with
+ * IPMID_BENCHMARK, the providers of a directory and fake D-Bus services, all
+ * in one process on a session bus (dbus-run-session). */
+
+namespace ipmi
+{
+
+message::Response::ptr executeIpmiCommand(message::Request::ptr request);
+
+namespace benchmark
+{
+
+/** @brief load the providers of a directory into the dispatcher, from
+ *         ipmid-new.cpp
+ */
+void loadProviders(const std::filesystem::path& ipmiLibsPath);
+
+/** @brief start and stop the handler worker pool, from ipmid-new.cpp; only
+ *         built with HANDLER_WORKER_THREADS can asio run it
+ */
+void startWorkers(size_t threads);
+void stopWorkers();
+
+/** @struct Dataset
+ *
+ *  Size of the synthetic objects the fake services serve.
+ */
+struct Dataset
+{
+    size_t sensors = 32;
+    size_t selEntries = 0;
+};
+
+constexpr const char* fakeSensorPrefix =
+    "/xyz/openbmc_project/sensors/temperature/fake_";
+
+/** @class FakeBus
+ *
+ *  ObjectMapper, sensor and logging services on their own connection and
+ *  thread, so the blocking calls some providers make are answered like on a
+ *  BMC. Every method call the services receive is counted.
+ */
+class FakeBus
+{
+  public:
+    explicit FakeBus(const Dataset& dataset);
+    ~FakeBus();
+
+    FakeBus(const FakeBus&) = delete;
+    FakeBus& operator=(const FakeBus&) = delete;
+
+    /** @brief method calls received so far */
+    size_t calls() const
+    {
+        return callCount.load(std::memory_order_relaxed);
+    }
+
+  private:
+    boost::asio::io_context io;
+    std::shared_ptr<sdbusplus::asio::connection> conn;
+    sdbusplus::asio::object_server server;
+    std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> interfaces;
+    std::atomic<size_t> callCount{0};
+    std::thread thread;
+};
+
+/** @brief connect the dispatcher to the session bus on io and load the
+ *         providers of a directory
+ */
+void startDispatcher(std::shared_ptr<boost::asio::io_context>& io,
+                     const std::filesystem::path& providers);
+
+/** @class Client
+ *
+ *  Issues requests like the system interface channel does and keeps the
+ *  latency of every one of them.
+ */
+class Client
+{
+  public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    explicit Client(boost::asio::yield_context& yield) : yield(yield)
+    {
+    }
+
+    message::Response::ptr execute(NetFn netFn, Cmd cmd,
+                                   std::vector<uint8_t>&& data);
+
+    std::vector<Duration> latencies;
+
+  private:
+    boost::asio::yield_context& yield;
+};
+
+} // namespace benchmark
+} // namespace ipmi
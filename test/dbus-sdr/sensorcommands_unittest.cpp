@@ -486,3 +486,82 @@ TEST(sensorUtils, TestRanges)
     // because they are tested through actual use, relating "x" to "y".
     testRanges();
 }
+
+TEST(sensorUtils, CachedAttributes)
+{
+    // The cached conversion of a range must scale exactly as the
+    // coefficients solved for the same range
+    for (const auto& [maxValue, minValue] :
+         {std::pair{255.0, 0.0}, {127.0, -128.0}, {1000.0, 0.0},
+          {3.3, 0.0}, {100.0, -40.0}, {2.5, 1.5}})
+    {
+        int16_t mValue;
+        int8_t rExp;
+        int16_t bValue;
+        int8_t bExp;
+        bool bSigned;
+        ASSERT_TRUE(ipmi::getSensorAttributes(maxValue, minValue, mValue,
+                                              rExp, bValue, bExp, bSigned));
+
+        auto attributes = ipmi::getSensorAttributes(maxValue, minValue);
+        ASSERT_TRUE(attributes);
+        EXPECT_EQ(attributes->mValue, mValue);
+        EXPECT_EQ(attributes->rExp, rExp);
+        EXPECT_EQ(attributes->bValue, bValue);
+        EXPECT_EQ(attributes->bExp, bExp);
+        EXPECT_EQ(attributes->bSigned, bSigned);
+
+        for (int step = -10; step <= 1010; step++)
+        {
+            double y = minValue + (maxValue - minValue) * step / 1000.0;
+            EXPECT_EQ(ipmi::scaleIPMIValueFromDouble(y, *attributes),
+                      ipmi::scaleIPMIValueFromDouble(y, mValue, rExp, bValue,
+                                                     bExp, bSigned));
+        }
+    }
+
+    // unusable ranges are rejected, also once cached
+    EXPECT_FALSE(ipmi::getSensorAttributes(0.0, 255.0));
+    EXPECT_FALSE(ipmi::getSensorAttributes(0.0, 255.0));
+    EXPECT_FALSE(ipmi::getSensorAttributes(NAN, 0.0));
+}
+
+TEST(sensorUtils, ScalingBatch)
+{
+    // a batch mixing several ranges scales every reading to the same byte
+    // as the scalar path, including the readings out of range and NaN
+    ipmi::SensorScalingBatch batch;
+    std::vector<std::pair<double, ipmi::SensorAttributes>> readings;
+    for (const auto& [maxValue, minValue] :
+         {std::pair{255.0, 0.0}, {127.0, -128.0}, {100.0, -40.0}, {3.3, 0.0}})
+    {
+        auto attributes = ipmi::getSensorAttributes(maxValue, minValue);
+        ASSERT_TRUE(attributes);
+        for (int step = -100; step <= 1100; step++)
+        {
+            double y = minValue + (maxValue - minValue) * step / 1000.0;
+            readings.emplace_back(y, *attributes);
+        }
+        readings.emplace_back(NAN, *attributes);
+        readings.emplace_back(1e12, *attributes);
+        readings.emplace_back(-1e12, *attributes);
+    }
+
+    batch.reserve(readings.size());
+    for (const auto& [value, attributes] : readings)
+    {
+        batch.add(value, attributes);
+    }
+    ASSERT_EQ(batch.size(), readings.size());
+
+    std::vector<uint8_t> bytes(batch.size());
+    batch.scale(bytes.data());
+    for (size_t i = 0; i < readings.size(); i++)
+    {
+        EXPECT_EQ(bytes[i], ipmi::scaleIPMIValueFromDouble(
+                                readings[i].first, readings[i].second));
+    }
+
+    batch.clear();
+    EXPECT_EQ(batch.size(), 0);
+}
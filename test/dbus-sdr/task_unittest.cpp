@@ -0,0 +1,177 @@
+#include "config.h"
+
+#include "harness.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <chrono>
+#include <filesystem>
+#include <ipmid/handler.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/* Runs handlers returning an ipmi::Task through the dispatcher of ipmid, on
+ * a session bus (dbus-run-session). Only built with
+ * --enable-cxx20-coroutines. */
+
+namespace
+{
+
+constexpr ipmi::NetFn taskNetFn = ipmi::netFnOemOne;
+constexpr ipmi::Cmd timerCmd = 0x01;
+constexpr ipmi::Cmd throwCmd = 0x02;
+constexpr auto timerDelay = std::chrono::milliseconds(20);
+
+std::thread::id handlerThread;
+
+ipmi::Task<ipmi::RspType<uint8_t, uint8_t>> timerHandler(ipmi::Context::ptr ctx,
+                                                         uint8_t value)
+{
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor,
+                                    timerDelay);
+    co_await timer.async_wait(boost::asio::use_awaitable);
+    handlerThread = std::this_thread::get_id();
+    co_return ipmi::responseSuccess(ctx->cmd, value);
+}
+
+ipmi::Task<ipmi::RspType<>> throwHandler()
+{
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor,
+                                    timerDelay);
+    co_await timer.async_wait(boost::asio::use_awaitable);
+    throw ipmi::HandlerException(ipmi::ccInvalidFieldRequest, "thrown");
+}
+
+bool haveSessionBus()
+{
+    sd_bus* bus = nullptr;
+    if (sd_bus_open_user(&bus) < 0)
+    {
+        return false;
+    }
+    sd_bus_flush_close_unref(bus);
+    return true;
+}
+
+class TaskHandler : public testing::Test
+{
+  protected:
+    static void SetUpTestSuite()
+    {
+        if (!haveSessionBus())
+        {
+            return;
+        }
+        providers = std::filesystem::temp_directory_path() /
+                    "ipmid-task-unittest";
+        std::filesystem::create_directories(providers);
+        io = std::make_shared<boost::asio::io_context>();
+        ipmi::benchmark::startDispatcher(io, providers);
+        ipmi::registerHandler(ipmi::prioOpenBmcBase, taskNetFn, timerCmd,
+                              ipmi::Privilege::User, timerHandler);
+        ipmi::registerHandler(ipmi::prioOpenBmcBase, taskNetFn, throwCmd,
+                              ipmi::Privilege::User, throwHandler);
+    }
+
+    static void TearDownTestSuite()
+    {
+        if (io)
+        {
+            std::filesystem::remove(providers);
+        }
+    }
+
+    void SetUp() override
+    {
+        if (!io)
+        {
+            GTEST_SKIP() << "no session bus, run under dbus-run-session";
+        }
+        io->restart();
+    }
+
+    /* issue the requests at once, and wait for all of their responses */
+    std::vector<ipmi::message::Response::ptr>
+        execute(ipmi::Cmd cmd, const std::vector<std::vector<uint8_t>>& data)
+    {
+        std::vector<ipmi::message::Response::ptr> responses(data.size());
+        size_t pending = data.size();
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            boost::asio::spawn(*io, [&, i](boost::asio::yield_context yield) {
+                ipmi::benchmark::Client client(yield);
+                std::vector<uint8_t> request = data[i];
+                responses[i] = client.execute(taskNetFn, cmd,
+                                              std::move(request));
+                if (--pending == 0)
+                {
+                    io->stop();
+                }
+            });
+        }
+        io->run();
+        return responses;
+    }
+
+    static inline std::shared_ptr<boost::asio::io_context> io;
+    static inline std::filesystem::path providers;
+};
+
+TEST_F(TaskHandler, CompletesOnTheMainLoop)
+{
+    handlerThread = std::thread::id();
+    auto responses = execute(timerCmd, {{0x5a}});
+
+    ASSERT_TRUE(responses[0]);
+    EXPECT_EQ(ipmi::ccSuccess, responses[0]->cc);
+    uint8_t cmd = 0;
+    uint8_t value = 0;
+    EXPECT_EQ(0, responses[0]->payload.unpack(cmd, value));
+    EXPECT_EQ(timerCmd, cmd);
+    EXPECT_EQ(0x5a, value);
+    EXPECT_EQ(std::this_thread::get_id(), handlerThread);
+}
+
+TEST_F(TaskHandler, RequestsAwaitTogether)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto responses = execute(timerCmd, {{0x01}, {0x02}, {0x03}, {0x04}});
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (uint8_t i = 0; i < responses.size(); i++)
+    {
+        ASSERT_TRUE(responses[i]);
+        EXPECT_EQ(ipmi::ccSuccess, responses[i]->cc);
+        uint8_t cmd = 0;
+        uint8_t value = 0;
+        EXPECT_EQ(0, responses[i]->payload.unpack(cmd, value));
+        EXPECT_EQ(i + 1, value);
+    }
+    // the timers of the four tasks run at the same time
+    EXPECT_LT(elapsed, timerDelay * responses.size());
+}
+
+TEST_F(TaskHandler, ThrownCompletionCodeIsTheResponse)
+{
+    auto responses = execute(throwCmd, {{}});
+
+    ASSERT_TRUE(responses[0]);
+    EXPECT_EQ(ipmi::ccInvalidFieldRequest, responses[0]->cc);
+}
+
+TEST_F(TaskHandler, BadRequestDoesNotStartTheTask)
+{
+    auto responses = execute(timerCmd, {{0x01, 0x02}});
+
+    ASSERT_TRUE(responses[0]);
+    EXPECT_EQ(ipmi::ccReqDataLenInvalid, responses[0]->cc);
+}
+
+} // namespace
@@ -0,0 +1,388 @@
+#include "harness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Replays captured ipmitool request sequences, like the ones of
+ * 'ipmitool sdr elist' and 'ipmitool sel list', against the storage and
+ * sensor providers of a directory, with synthetic sensors and SEL entries
+ * served by the fake services of the harness:
+ *
+ *     dbus-run-session -- ./walk_replay [--sensors=N] [--sel-entries=N]
+ *         [--repeat=N] <providers dir> <trace>...
+ *
+ * A trace holds one request per line, the NetFn and command in hex and the
+ * request data in hex bytes, where
+ *     R  is the reservation ID answered by the last Reserve SDR Repository
+ *        or Reserve SEL
+ *     I  is the record ID of the current record
+ *     S  is the sensor number of the current SDR record
+ * The lines between 'loop' and 'end' are replayed for every record of the
+ * walk, starting at record 0000h and following the next record ID answered
+ * by Get SDR or Get SEL Entry up to FFFFh. '#' starts a comment.
+ *
+ * The wall time, the requests and the D-Bus method calls the fake services
+ * received are printed for every walk; growing the dataset shows how a walk
+ * scales. */
+
+namespace
+{
+
+using ipmi::benchmark::Client;
+
+constexpr uint16_t lastRecord = 0xFFFF;
+// walks stop after this many records, whatever the trace says
+constexpr size_t maxWalk = 4096;
+
+// offset of the sensor number in an SDR record
+constexpr size_t sdrSensorNumber = 7;
+
+/** @struct Token
+ *
+ *  One byte of request data, or a placeholder filled in at replay.
+ */
+struct Token
+{
+    enum class Kind
+    {
+        byte,
+        reservation,
+        recordID,
+        sensorNumber,
+    };
+
+    Kind kind;
+    uint8_t value;
+};
+
+struct Line
+{
+    ipmi::NetFn netFn;
+    ipmi::Cmd cmd;
+    std::vector<Token> data;
+};
+
+/** @struct Trace
+ *
+ *  Requests ahead of the walk, the requests repeated for every record and
+ *  the requests after it.
+ */
+struct Trace
+{
+    std::string name;
+    std::vector<Line> prologue;
+    std::vector<Line> loop;
+    std::vector<Line> epilogue;
+};
+
+std::optional<Trace> readTrace(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Cannot open trace " << path << "\n";
+        return std::nullopt;
+    }
+
+    Trace trace;
+    trace.name = path.filename();
+    std::vector<Line>* section = &trace.prologue;
+    std::string text;
+    for (size_t number = 1; std::getline(file, text); number++)
+    {
+        text = text.substr(0, text.find('#'));
+        std::istringstream words(text);
+        std::string word;
+        std::vector<std::string> tokens;
+        while (words >> word)
+        {
+            tokens.push_back(word);
+        }
+        if (tokens.empty())
+        {
+            continue;
+        }
+        if (tokens.size() == 1 && tokens[0] == "loop" &&
+            section == &trace.prologue)
+        {
+            section = &trace.loop;
+            continue;
+        }
+        if (tokens.size() == 1 && tokens[0] == "end" && section == &trace.loop)
+        {
+            section = &trace.epilogue;
+            continue;
+        }
+
+        try
+        {
+            if (tokens.size() < 2)
+            {
+                throw std::invalid_argument("no command");
+            }
+            Line line{};
+            line.netFn = std::stoul(tokens[0], nullptr, 16);
+            line.cmd = std::stoul(tokens[1], nullptr, 16);
+            for (size_t i = 2; i < tokens.size(); i++)
+            {
+                if (tokens[i] == "R")
+                {
+                    line.data.push_back({Token::Kind::reservation, 0});
+                }
+                else if (tokens[i] == "I")
+                {
+                    line.data.push_back({Token::Kind::recordID, 0});
+                }
+                else if (tokens[i] == "S")
+                {
+                    line.data.push_back({Token::Kind::sensorNumber, 0});
+                }
+                else
+                {
+                    line.data.push_back(
+                        {Token::Kind::byte, static_cast<uint8_t>(std::stoul(
+                                                tokens[i], nullptr, 16))});
+                }
+            }
+            section->push_back(std::move(line));
+        }
+        catch (const std::logic_error&)
+        {
+            std::cerr << path.string() << ":" << number
+                      << ": malformed request\n";
+            return std::nullopt;
+        }
+    }
+    if (section == &trace.loop)
+    {
+        std::cerr << path.string() << ": loop without end\n";
+        return std::nullopt;
+    }
+    return trace;
+}
+
+/** @class Replay
+ *
+ *  Walk state of one replay of a trace.
+ */
+class Replay
+{
+  public:
+    explicit Replay(Client& client) : client(client)
+    {
+    }
+
+    bool run(const std::vector<Line>& lines)
+    {
+        for (const Line& line : lines)
+        {
+            if (!execute(line))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void walk(const std::vector<Line>& lines)
+    {
+        recordID = 0;
+        for (size_t i = 0; i < maxWalk && recordID != lastRecord; i++)
+        {
+            record.clear();
+            nextRecordID.reset();
+            if (!run(lines) || !nextRecordID)
+            {
+                return;
+            }
+            recordID = *nextRecordID;
+        }
+    }
+
+    size_t failed = 0;
+
+  private:
+    bool execute(const Line& line)
+    {
+        std::vector<uint8_t> data;
+        for (const Token& token : line.data)
+        {
+            switch (token.kind)
+            {
+                case Token::Kind::byte:
+                    data.push_back(token.value);
+                    break;
+                case Token::Kind::reservation:
+                    data.push_back(static_cast<uint8_t>(reservation));
+                    data.push_back(static_cast<uint8_t>(reservation >> 8));
+                    break;
+                case Token::Kind::recordID:
+                    data.push_back(static_cast<uint8_t>(recordID));
+                    data.push_back(static_cast<uint8_t>(recordID >> 8));
+                    break;
+                case Token::Kind::sensorNumber:
+                    data.push_back(record.size() > sdrSensorNumber
+                                       ? record[sdrSensorNumber]
+                                       : 0xFF);
+                    break;
+            }
+        }
+        // offset of a Get SDR read, to put the SDR record back together
+        uint8_t offset = data.size() > 4 ? data[4] : 0;
+
+        auto response = client.execute(line.netFn, line.cmd, std::move(data));
+        if (response->cc != ipmi::ccSuccess)
+        {
+            // like ipmitool, only a failed storage request ends the walk
+            failed++;
+            return line.netFn != ipmi::netFnStorage;
+        }
+        if (line.netFn != ipmi::netFnStorage)
+        {
+            return true;
+        }
+        switch (line.cmd)
+        {
+            case ipmi::storage::cmdReserveSdrRepository:
+            case ipmi::storage::cmdReserveSel:
+                response->payload.unpack(reservation);
+                break;
+            case ipmi::storage::cmdGetSdr:
+            case ipmi::storage::cmdGetSelEntry:
+            {
+                uint16_t next = 0;
+                if (response->payload.unpack(next) != 0)
+                {
+                    failed++;
+                    return false;
+                }
+                nextRecordID = next;
+                const std::vector<uint8_t>& raw = response->payload.raw;
+                if (line.cmd == ipmi::storage::cmdGetSdr && raw.size() > 2)
+                {
+                    size_t size = offset + raw.size() - 2;
+                    record.resize(std::max(record.size(), size));
+                    std::copy(raw.begin() + 2, raw.end(),
+                              record.begin() + offset);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return true;
+    }
+
+    Client& client;
+    uint16_t reservation = 0;
+    uint16_t recordID = 0;
+    std::optional<uint16_t> nextRecordID;
+    std::vector<uint8_t> record;
+};
+
+void replay(boost::asio::io_context& io, const ipmi::benchmark::FakeBus& bus,
+            const Trace& trace, size_t pass)
+{
+    size_t requests = 0;
+    size_t failed = 0;
+    size_t calls = bus.calls();
+    auto start = std::chrono::steady_clock::now();
+    boost::asio::spawn(io, [&](boost::asio::yield_context yield) {
+        Client client(yield);
+        Replay walk(client);
+        if (walk.run(trace.prologue))
+        {
+            walk.walk(trace.loop);
+            walk.run(trace.epilogue);
+        }
+        requests = client.latencies.size();
+        failed = walk.failed;
+        io.stop();
+    });
+    io.restart();
+    io.run();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::cout << trace.name << " pass " << pass << ": " << requests
+              << " requests, " << failed << " failed, " << std::fixed
+              << std::setprecision(3) << elapsed.count() << " ms, "
+              << bus.calls() - calls << " D-Bus calls\n";
+}
+
+/* value of a --name=value option */
+bool option(const std::string& arg, const std::string& name, size_t& value)
+{
+    std::string prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0)
+    {
+        return false;
+    }
+    value = std::stoul(arg.substr(prefix.size()));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ipmi::benchmark::Dataset dataset;
+    size_t repeat = 3;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (!option(arg, "sensors", dataset.sensors) &&
+            !option(arg, "sel-entries", dataset.selEntries) &&
+            !option(arg, "repeat", repeat))
+        {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--sensors=N] [--sel-entries=N] [--repeat=N]"
+                     " <providers dir> <trace>...\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Trace> traces;
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        std::optional<Trace> trace = readTrace(args[i]);
+        if (!trace)
+        {
+            return EXIT_FAILURE;
+        }
+        traces.push_back(std::move(*trace));
+    }
+
+    ipmi::benchmark::FakeBus bus(dataset);
+    auto io = std::make_shared<boost::asio::io_context>();
+    ipmi::benchmark::startDispatcher(io, args[0]);
+
+    std::cout << dataset.sensors << " sensors, " << dataset.selEntries
+              << " SEL entries\n";
+    for (const Trace& trace : traces)
+    {
+        // the first pass also fills the caches of the providers
+        for (size_t pass = 1; pass <= repeat; pass++)
+        {
+            replay(*io, bus, trace, pass);
+        }
+    }
+    return EXIT_SUCCESS;
+}
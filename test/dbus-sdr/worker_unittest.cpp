@@ -0,0 +1,83 @@
+#include "config.h"
+
+#include "harness.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <boost/asio/spawn.hpp>
+#include <filesystem>
+#include <ipmid/handler.hpp>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+/* Runs a handler registered with ipmi::Execution::worker through the
+ * dispatcher of ipmid, on a session bus (dbus-run-session). */
+
+namespace
+{
+
+constexpr ipmi::NetFn workerNetFn = ipmi::netFnOemOne;
+constexpr ipmi::Cmd workerCmd = 0x01;
+
+std::thread::id handlerThread;
+
+ipmi::RspType<uint8_t> workerHandler(ipmi::Context::ptr ctx)
+{
+    handlerThread = std::this_thread::get_id();
+    return ipmi::responseSuccess(ctx->cmd);
+}
+
+bool haveSessionBus()
+{
+    sd_bus* bus = nullptr;
+    if (sd_bus_open_user(&bus) < 0)
+    {
+        return false;
+    }
+    sd_bus_flush_close_unref(bus);
+    return true;
+}
+
+} // namespace
+
+TEST(HandlerWorker, RunsOffTheMainLoop)
+{
+    if (HANDLER_WORKER_THREADS == 0)
+    {
+        GTEST_SKIP() << "built without HANDLER_WORKER_THREADS";
+    }
+    if (!haveSessionBus())
+    {
+        GTEST_SKIP() << "no session bus, run under dbus-run-session";
+    }
+
+    auto providers = std::filesystem::temp_directory_path() /
+                     "ipmid-worker-unittest";
+    std::filesystem::create_directories(providers);
+    auto io = std::make_shared<boost::asio::io_context>();
+    ipmi::benchmark::startDispatcher(io, providers);
+    ipmi::benchmark::startWorkers(HANDLER_WORKER_THREADS);
+    ASSERT_TRUE(ipmi::registerHandler(ipmi::prioOpenBmcBase, workerNetFn,
+                                      workerCmd, ipmi::Privilege::User,
+                                      ipmi::Execution::worker, workerHandler));
+
+    ipmi::message::Response::ptr response;
+    boost::asio::spawn(*io, [&](boost::asio::yield_context yield) {
+        ipmi::benchmark::Client client(yield);
+        response = client.execute(workerNetFn, workerCmd, {});
+        io->stop();
+    });
+    io->run();
+    ipmi::benchmark::stopWorkers();
+    std::filesystem::remove(providers);
+
+    ASSERT_TRUE(response);
+    EXPECT_EQ(ipmi::ccSuccess, response->cc);
+    uint8_t cmd = 0;
+    EXPECT_EQ(0, response->payload.unpack(cmd));
+    EXPECT_EQ(workerCmd, cmd);
+    EXPECT_NE(std::thread::id(), handlerThread);
+    EXPECT_NE(std::this_thread::get_id(), handlerThread);
+}
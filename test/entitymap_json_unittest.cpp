@@ -1,7 +1,10 @@
 #include "entity_map_json.hpp"
 
 #include <ipmid/types.hpp>
+#include <algorithm>
+#include <iterator>
 #include <nlohmann/json.hpp>
+#include <tuple>
 #include <utility>
 
 #include <gmock/gmock.h>
@@ -218,6 +221,94 @@ TEST(ValidateJson, ThereAreTwoEntriesBothValidReturnsBoth)
     EXPECT_EQ(entry->second.containedEntities, expected);
 }
 
+TEST(EntityIndex, IndexesContainerAndContainedEntities)
+{
+    EntityInfoMap map;
+    map[1] = {2, 3, false, false, {std::make_pair(1, 2), std::make_pair(1, 3),
+                                   std::make_pair(0, 0), std::make_pair(0, 0)}};
+    map[2] = {2, 3, true, false, {std::make_pair(1, 2), std::make_pair(0, 0),
+                                  std::make_pair(0, 0), std::make_pair(0, 0)}};
+
+    auto index = buildEntityIndex(map);
+    ASSERT_EQ(index.size(), 5);
+    EXPECT_TRUE(std::is_sorted(index.begin(), index.end()));
+
+    // the container of both records
+    EXPECT_EQ(index[3].entityId, 2);
+    EXPECT_EQ(index[3].recordId, 1);
+    EXPECT_EQ(index[4].recordId, 2);
+
+    // entity 1.2 is contained in both records, 1.3 in the first one
+    EXPECT_EQ(index[0].entityInstance, 2);
+    EXPECT_EQ(index[0].recordId, 1);
+    EXPECT_EQ(index[1].entityInstance, 2);
+    EXPECT_EQ(index[1].recordId, 2);
+    EXPECT_EQ(index[2].entityInstance, 3);
+}
+
+TEST(EntityIndex, IndexesEveryInstanceOfARange)
+{
+    EntityInfoMap map;
+    map[1] = {2, 3, false, false, {std::make_pair(3, 1), std::make_pair(3, 4),
+                                   std::make_pair(5, 7), std::make_pair(5, 7)}};
+
+    auto index = buildEntityIndex(map);
+    ASSERT_EQ(index.size(), 6);
+
+    // 3.1 to 3.4, 5.7 once and the container
+    for (uint8_t instance = 1; instance <= 4; instance++)
+    {
+        auto [first, last] = findEntity(index, 3, instance);
+        ASSERT_EQ(std::distance(first, last), 1);
+        EXPECT_EQ(first->recordId, 1);
+    }
+    auto [first, last] = findEntity(index, 5, 7);
+    EXPECT_EQ(std::distance(first, last), 1);
+    std::tie(first, last) = findEntity(index, 3, 5);
+    EXPECT_EQ(first, last);
+}
+
+TEST(EntityIndex, ListsAreNotRanges)
+{
+    EntityInfoMap map;
+    map[1] = {2, 3, true, false, {std::make_pair(3, 1), std::make_pair(3, 4),
+                                  std::make_pair(0, 0), std::make_pair(0, 0)}};
+
+    auto index = buildEntityIndex(map);
+    EXPECT_EQ(index.size(), 3);
+    auto [first, last] = findEntity(index, 3, 2);
+    EXPECT_EQ(first, last);
+    std::tie(first, last) = findEntity(index, 3, 4);
+    EXPECT_EQ(std::distance(first, last), 1);
+}
+
+TEST(EntityIndex, FindsTheRecordsOfAnEntityInOrder)
+{
+    EntityInfoMap map;
+    map[4] = {7, 1, false, false, {std::make_pair(3, 1), std::make_pair(3, 2),
+                                   std::make_pair(0, 0), std::make_pair(0, 0)}};
+    map[2] = {7, 1, true, false, {std::make_pair(3, 2), std::make_pair(0, 0),
+                                  std::make_pair(0, 0), std::make_pair(0, 0)}};
+    map[3] = {8, 1, true, false, {std::make_pair(7, 1), std::make_pair(0, 0),
+                                  std::make_pair(0, 0), std::make_pair(0, 0)}};
+
+    auto index = buildEntityIndex(map);
+    auto [first, last] = findEntity(index, 3, 2);
+    ASSERT_EQ(std::distance(first, last), 2);
+    EXPECT_EQ(first[0].recordId, 2);
+    EXPECT_EQ(first[1].recordId, 4);
+
+    // the container of two records and contained in a third
+    std::tie(first, last) = findEntity(index, 7, 1);
+    ASSERT_EQ(std::distance(first, last), 3);
+    EXPECT_EQ(first[0].recordId, 2);
+    EXPECT_EQ(first[1].recordId, 3);
+    EXPECT_EQ(first[2].recordId, 4);
+
+    std::tie(first, last) = findEntity(index, 9, 1);
+    EXPECT_EQ(first, last);
+}
+
 } // namespace
 } // namespace sensor
 } // namespace ipmi
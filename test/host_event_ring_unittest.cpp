@@ -0,0 +1,109 @@
+#include "host-event-ring.hpp"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace host
+{
+namespace command
+{
+
+namespace
+{
+
+EventRecord record(uint8_t cmd)
+{
+    EventRecord r{};
+    r[11] = cmd;
+    return r;
+}
+
+TEST(EventRingTest, PopsInPushOrder)
+{
+    EventRing<4> ring;
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.pop());
+
+    EXPECT_TRUE(ring.push(record(1)));
+    EXPECT_TRUE(ring.push(record(2)));
+    EXPECT_FALSE(ring.empty());
+    EXPECT_EQ(record(1), ring.pop());
+    EXPECT_EQ(record(2), ring.pop());
+    EXPECT_FALSE(ring.pop());
+    EXPECT_EQ(2u, ring.taken());
+}
+
+TEST(EventRingTest, FullRingRefusesRecords)
+{
+    EventRing<2> ring;
+    EXPECT_TRUE(ring.push(record(1)));
+    EXPECT_TRUE(ring.push(record(2)));
+    EXPECT_FALSE(ring.push(record(3)));
+
+    EXPECT_EQ(record(1), ring.pop());
+    EXPECT_TRUE(ring.push(record(3)));
+    EXPECT_EQ(record(2), ring.pop());
+    EXPECT_EQ(record(3), ring.pop());
+}
+
+TEST(EventRingTest, DropsOnlyTheUntakenHead)
+{
+    EventRing<4> ring;
+    ring.push(record(1));
+    ring.push(record(2));
+
+    EXPECT_EQ(record(1), ring.pop());
+    // record 1 sits at index 0 and was taken already
+    EXPECT_FALSE(ring.drop(0));
+    EXPECT_TRUE(ring.drop(1));
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.pop());
+}
+
+TEST(EventRingTest, EveryRecordIsTakenOnce)
+{
+    constexpr size_t records = 1000;
+    EventRing<4> ring;
+    std::vector<size_t> seen(256);
+    std::thread reader([&]() {
+        size_t count = 0;
+        while (count < records)
+        {
+            if (auto r = ring.pop())
+            {
+                seen[(*r)[11]]++;
+                count++;
+                continue;
+            }
+            std::this_thread::yield();
+        }
+    });
+    for (size_t i = 0; i < records;)
+    {
+        if (ring.push(record(i % 256)))
+        {
+            i++;
+            continue;
+        }
+        std::this_thread::yield();
+    }
+    reader.join();
+
+    size_t total = 0;
+    for (size_t count : seen)
+    {
+        total += count;
+    }
+    EXPECT_EQ(records, total);
+    EXPECT_TRUE(ring.empty());
+}
+
+} // namespace
+
+} // namespace command
+} // namespace host
+} // namespace phosphor
@@ -0,0 +1,95 @@
+#include "ipmb-message.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace ipmi
+{
+namespace ipmb
+{
+
+namespace
+{
+
+// Get Device ID from the requester at 20h, sequence 5, to the controller at
+// 2Ch on channel 6
+const std::vector<uint8_t> getDeviceId{0x2C, 0x18, 0xBC, 0x20,
+                                       0x14, 0x01, 0xCB};
+
+TEST(IpmbMessageTest, DecodesSendMessageRequest)
+{
+    std::optional<Request> request = decode(6, getDeviceId);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(6, request->channel);
+    EXPECT_EQ(0x2C, request->rsSA);
+    EXPECT_EQ(0x06, request->netFn);
+    EXPECT_EQ(0, request->rsLun);
+    EXPECT_EQ(0x20, request->rqSA);
+    EXPECT_EQ(5, request->rqSeq);
+    EXPECT_EQ(0, request->rqLun);
+    EXPECT_EQ(0x01, request->cmd);
+    EXPECT_TRUE(request->data.empty());
+}
+
+TEST(IpmbMessageTest, DecodesRequestData)
+{
+    // Get Sensor Reading of sensor 12h, from LUN 1 to LUN 2
+    std::vector<uint8_t> message{0x2C, 0x12, 0xC2, 0x20, 0x15, 0x2D, 0x12};
+    message.push_back(checksum(message.begin() + 3, message.end()));
+    std::optional<Request> request = decode(6, message);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(0x04, request->netFn);
+    EXPECT_EQ(2, request->rsLun);
+    EXPECT_EQ(1, request->rqLun);
+    EXPECT_EQ(0x2D, request->cmd);
+    EXPECT_EQ(std::vector<uint8_t>{0x12}, request->data);
+}
+
+TEST(IpmbMessageTest, RejectsMalformedRequests)
+{
+    EXPECT_FALSE(decode(6, {}));
+    EXPECT_FALSE(decode(6, std::vector<uint8_t>(getDeviceId.begin(),
+                                                getDeviceId.end() - 1)));
+
+    std::vector<uint8_t> badHeader = getDeviceId;
+    badHeader[2]++;
+    EXPECT_FALSE(decode(6, badHeader));
+
+    std::vector<uint8_t> badBody = getDeviceId;
+    badBody.back()++;
+    EXPECT_FALSE(decode(6, badBody));
+}
+
+TEST(IpmbMessageTest, EncodesSendMessageResponse)
+{
+    std::optional<Request> request = decode(6, getDeviceId);
+    ASSERT_TRUE(request);
+    std::vector<uint8_t> frame = encode(*request, {0x00, {0x20, 0x81}});
+
+    std::vector<uint8_t> expected{0x20, 0x1C, 0xC4, 0x2C, 0x14,
+                                  0x01, 0x00, 0x20, 0x81};
+    expected.push_back(checksum(expected.begin() + 3, expected.end()));
+    EXPECT_EQ(expected, frame);
+    EXPECT_EQ(0, checksum(frame.begin(), frame.begin() + ipmbHeaderSize));
+    EXPECT_EQ(0, checksum(frame.begin() + ipmbHeaderSize, frame.end()));
+}
+
+TEST(IpmbMessageTest, EncodesGetMessageResponse)
+{
+    std::optional<Request> request = decode(6, getDeviceId);
+    ASSERT_TRUE(request);
+    std::vector<uint8_t> sent = encode(*request, {0xC3, {}});
+    std::vector<uint8_t> queued = encodeGetMessage(*request, {0xC3, {}});
+
+    // the channel in place of the rqSA, the rest as sent
+    ASSERT_EQ(sent.size(), queued.size());
+    EXPECT_EQ(6, queued[0]);
+    EXPECT_TRUE(std::equal(sent.begin() + 1, sent.end(), queued.begin() + 1));
+    EXPECT_EQ(0xC3, queued[6]);
+}
+
+} // namespace
+} // namespace ipmb
+} // namespace ipmi
@@ -0,0 +1,209 @@
+#include <ipmid/api.hpp>
+#include <ipmid/message.hpp>
+
+#include <atomic>
+#include <bitset>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/* Pack and unpack throughput of representative response and request
+ * signatures. Every allocation of the process is counted, so each benchmark
+ * also reports the allocations of one pack or unpack. */
+
+namespace
+{
+std::atomic<size_t> allocations{0};
+} // namespace
+
+void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+
+using ipmi::uint24_t;
+using ipmi::uint3_t;
+using ipmi::uint5_t;
+using ipmi::uint7_t;
+
+using BitFields = std::tuple<uint3_t, uint5_t, bool, uint7_t, std::bitset<8>>;
+using Nested =
+    std::tuple<uint8_t, std::tuple<uint16_t, std::tuple<uint8_t, uint32_t>>>;
+
+/* run the benchmark loop, report the bytes handled and the allocations per
+ * iteration */
+template <typename Operation>
+void run(benchmark::State& state, size_t bytes, Operation&& operation)
+{
+    size_t start = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state)
+    {
+        operation();
+    }
+    size_t allocated = allocations.load(std::memory_order_relaxed) - start;
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["allocs/op"] = benchmark::Counter(
+        static_cast<double>(allocated), benchmark::Counter::kAvgIterations);
+}
+
+/* pack the payload of a response the way the handlers do */
+template <typename... Types>
+void packResponse(benchmark::State& state, ipmi::RspType<Types...> response)
+{
+    auto& payload = *std::get<1>(response);
+    size_t bytes = 0;
+    {
+        ipmi::message::Payload p;
+        p.pack(payload);
+        bytes = p.size();
+    }
+    run(state, bytes, [&payload]() {
+        ipmi::message::Payload p;
+        p.pack(payload);
+        benchmark::DoNotOptimize(p.raw.data());
+    });
+}
+
+/* unpack a request the way the handlers do, into a fresh request each
+ * time; the payload is rewound instead of copied for every iteration */
+template <typename Request>
+void unpackRequest(benchmark::State& state, std::vector<uint8_t> data)
+{
+    ipmi::message::Payload p(std::move(data));
+    Request request;
+    if (p.unpack(request) != 0 || !p.fullyUnpacked())
+    {
+        state.SkipWithError("request does not unpack");
+        return;
+    }
+    run(state, p.size(), [&p]() {
+        p.rawIndex = 0;
+        p.bitCount = 0;
+        p.unpackError = false;
+        Request request;
+        p.unpack(request);
+        benchmark::DoNotOptimize(request);
+    });
+}
+
+void packUints(benchmark::State& state)
+{
+    packResponse(state,
+                 ipmi::responseSuccess(uint8_t{0x02}, uint16_t{0x0604},
+                                       uint32_t{0x44332211}));
+}
+BENCHMARK(packUints);
+
+void packBitFields(benchmark::State& state)
+{
+    packResponse(state,
+                 ipmi::responseSuccess(uint3_t{5}, uint5_t{17}, true,
+                                       uint7_t{0x55}, std::bitset<8>{0xa5}));
+}
+BENCHMARK(packBitFields);
+
+void packUint24(benchmark::State& state)
+{
+    packResponse(state,
+                 ipmi::responseSuccess(uint24_t{0x563412}, uint8_t{0x78}));
+}
+BENCHMARK(packUint24);
+
+void packOptional(benchmark::State& state)
+{
+    packResponse(state,
+                 ipmi::responseSuccess(uint8_t{0x01},
+                                       std::optional<uint16_t>{0x0302}));
+}
+BENCHMARK(packOptional);
+
+void packVector(benchmark::State& state)
+{
+    packResponse(state, ipmi::responseSuccess(
+                            uint8_t{0x20}, std::vector<uint8_t>(32, 0x5a)));
+}
+BENCHMARK(packVector);
+
+void packNestedTuples(benchmark::State& state)
+{
+    auto inner = std::make_tuple(uint8_t{0x04}, uint32_t{0x08070605});
+    auto outer = std::make_tuple(uint16_t{0x0302}, inner);
+    packResponse(state, ipmi::responseSuccess(uint8_t{0x01}, outer));
+}
+BENCHMARK(packNestedTuples);
+
+void unpackUints(benchmark::State& state)
+{
+    unpackRequest<std::tuple<uint8_t, uint16_t, uint32_t>>(
+        state, {0x02, 0x04, 0x06, 0x11, 0x22, 0x33, 0x44});
+}
+BENCHMARK(unpackUints);
+
+void unpackBitFields(benchmark::State& state)
+{
+    unpackRequest<BitFields>(state, {0x8d, 0xab, 0xa5});
+}
+BENCHMARK(unpackBitFields);
+
+void unpackUint24(benchmark::State& state)
+{
+    unpackRequest<std::tuple<uint24_t, uint8_t>>(state,
+                                                 {0x12, 0x34, 0x56, 0x78});
+}
+BENCHMARK(unpackUint24);
+
+void unpackOptionalPresent(benchmark::State& state)
+{
+    unpackRequest<std::tuple<uint8_t, std::optional<uint16_t>>>(
+        state, {0x01, 0x02, 0x03});
+}
+BENCHMARK(unpackOptionalPresent);
+
+void unpackOptionalAbsent(benchmark::State& state)
+{
+    unpackRequest<std::tuple<uint8_t, std::optional<uint16_t>>>(state,
+                                                                {0x01});
+}
+BENCHMARK(unpackOptionalAbsent);
+
+void unpackVector(benchmark::State& state)
+{
+    std::vector<uint8_t> data(33, 0x5a);
+    data[0] = 0x20;
+    unpackRequest<std::tuple<uint8_t, std::vector<uint8_t>>>(state,
+                                                             std::move(data));
+}
+BENCHMARK(unpackVector);
+
+void unpackNestedTuples(benchmark::State& state)
+{
+    unpackRequest<Nested>(state, {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                  0x08});
+}
+BENCHMARK(unpackNestedTuples);
+
+} // namespace
+
+BENCHMARK_MAIN();
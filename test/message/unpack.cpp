@@ -733,6 +733,23 @@ TEST(Vectors, VectorOfTuplesInsufficientBytes)
 
 // Cannot test TooManyBytes or InsufficientBytes for vector<uint8_t>
 // because it will always unpack whatever bytes are remaining
+TEST(Vectors, ByteSpan)
+{
+    // a span of bytes views the remainder of the payload without a copy
+    std::vector<uint8_t> i = {0xbe, 0x02, 0x00, 0x86, 0x04};
+    ipmi::message::Payload p(std::forward<std::vector<uint8_t>>(i));
+    uint8_t u8;
+    ipmi::message::ByteSpan v;
+    // check that the number of bytes matches
+    ASSERT_EQ(p.unpack(u8, v), 0);
+    // check that the payload was fully unpacked
+    ASSERT_TRUE(p.fullyUnpacked());
+    // check that the span points into the payload
+    ASSERT_EQ(v.data(), p.data() + 1);
+    std::vector<uint8_t> k = {0x02, 0x00, 0x86, 0x04};
+    ASSERT_EQ(std::vector<uint8_t>(v.begin(), v.end()), k);
+}
+
 // TEST(Vectors, VectorUint8TooManyBytes) {}
 // TEST(Vectors, VectorUint8InsufficientBytes) {}
 
@@ -823,6 +840,60 @@ TEST(UnpackAdvanced, TupleInts)
     ASSERT_EQ(v, k);
 }
 
+TEST(UnpackAdvanced, TupleFixedLayout)
+{
+    // a tuple of whole-byte integers and arrays is decoded in one step,
+    // with the same LSByte first layout as the element by element unpack
+    static_assert(ipmi::message::details::UnpackFixed<
+                      std::tuple<uint8_t, uint16_t, std::array<uint8_t, 2>,
+                                 std::array<uint16_t, 2>>>::size == 9);
+    static_assert(ipmi::message::details::UnpackFixed<
+                      std::tuple<uint8_t, bool, uint7_t>>::size == 0);
+    std::vector<uint8_t> i = {0x02, 0x04, 0x06, 0x11,
+                              0x22, 0x33, 0x44, 0x55, 0x66};
+    ipmi::message::Payload p(std::forward<std::vector<uint8_t>>(i));
+    std::tuple<uint8_t, uint16_t, std::array<uint8_t, 2>,
+               std::array<uint16_t, 2>>
+        v;
+    // check that the number of bytes matches
+    ASSERT_EQ(p.unpack(v), 0);
+    // check that the payload was fully unpacked
+    ASSERT_TRUE(p.fullyUnpacked());
+    auto k = std::make_tuple(uint8_t{0x02}, uint16_t{0x0604},
+                             std::array<uint8_t, 2>{0x11, 0x22},
+                             std::array<uint16_t, 2>{0x4433, 0x6655});
+    // check that the bytes were correctly unpacked (LSB first)
+    ASSERT_EQ(v, k);
+}
+
+TEST(UnpackAdvanced, TupleFixedLayoutInsufficientBytes)
+{
+    std::vector<uint8_t> i = {0x02, 0x04, 0x06};
+    ipmi::message::Payload p(std::forward<std::vector<uint8_t>>(i));
+    std::tuple<uint8_t, uint32_t> v;
+    // check that the number of bytes matches
+    ASSERT_NE(p.unpack(v), 0);
+    // check that no bytes were consumed and the error is reported
+    ASSERT_EQ(p.rawIndex, 0u);
+    ASSERT_FALSE(p.fullyUnpacked());
+}
+
+TEST(UnpackAdvanced, TupleFixedLayoutAfterBits)
+{
+    // with partial bits pending the generic bit unpacker is used
+    std::vector<uint8_t> i = {0x96, 0xd2};
+    ipmi::message::Payload p(std::forward<std::vector<uint8_t>>(i));
+    uint2_t v1;
+    std::tuple<uint8_t> v2;
+    uint6_t v3;
+    ASSERT_EQ(p.unpack(v1, v2, v3), 0);
+    // check that the payload was fully unpacked
+    ASSERT_TRUE(p.fullyUnpacked());
+    ASSERT_EQ(v1, uint2_t{2});
+    ASSERT_EQ(std::get<0>(v2), 0xa5);
+    ASSERT_EQ(v3, uint6_t{0x34});
+}
+
 TEST(UnpackAdvanced, BoolsnBitfieldsnFixedIntsOhMy)
 {
     // each element will be unpacked, filling the low-order bits first
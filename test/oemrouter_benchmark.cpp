@@ -0,0 +1,74 @@
+#include <ipmid/api.h>
+
+#include <cstring>
+#include <ipmid/oemrouter.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/* Routing cost of the static OEM router, against the map of std::function
+ * handlers the legacy router registers, which also resizes a 64K reply
+ * buffer for every request. */
+
+namespace oem
+{
+namespace
+{
+
+constexpr Number oen = 0x123456;
+constexpr ipmi_cmd_t cmd = 0x78;
+const std::vector<uint8_t> request = {0x10, 0x20, 0x30, 0x40};
+
+ipmi_ret_t echoHandler(ipmi_cmd_t, const uint8_t* reqBuf, size_t reqLen,
+                       uint8_t* replyBuf, size_t* replyLen)
+{
+    *replyLen = reqLen;
+    std::memcpy(replyBuf, reqBuf, reqLen);
+    return 0;
+}
+
+void legacyRouter(benchmark::State& state)
+{
+    std::unordered_map<unsigned int, Handler> handlers;
+    handlers[(oen << 8) | cmd] = [](ipmi_cmd_t command, const uint8_t* reqBuf,
+                                    uint8_t* replyBuf, size_t* len) {
+        return echoHandler(command, reqBuf, *len, replyBuf, len);
+    };
+    std::vector<uint8_t> reply;
+    for (auto _ : state)
+    {
+        auto handler = handlers.find((oen << 8) | cmd);
+        std::vector<uint8_t> req(request);
+        reply.resize(64 * 1024);
+        size_t len = req.size();
+        handler->second(cmd, req.data(), reply.data(), &len);
+        reply.resize(len);
+        benchmark::DoNotOptimize(reply.data());
+        reply.clear();
+    }
+}
+BENCHMARK(legacyRouter);
+
+void staticRouter(benchmark::State& state)
+{
+    StaticRouter<oen> router;
+    router.registerHandler(oen, cmd, echoHandler);
+    std::vector<uint8_t> reply;
+    for (auto _ : state)
+    {
+        reply.resize(maxSpanReplySize);
+        size_t len = reply.size();
+        router.route(oen, cmd, request.data(), request.size(), reply.data(),
+                     &len);
+        reply.resize(len);
+        benchmark::DoNotOptimize(reply.data());
+        reply.clear();
+    }
+}
+BENCHMARK(staticRouter);
+
+} // namespace
+} // namespace oem
+
+BENCHMARK_MAIN();
@@ -0,0 +1,101 @@
+#include <ipmid/api.h>
+
+#include <cstring>
+#include <ipmid/oemrouter.hpp>
+
+#include <gtest/gtest.h>
+
+namespace oem
+{
+
+namespace
+{
+
+constexpr Number oenPlain = 0x123456;
+constexpr Number oenWild = 0x234567;
+
+using TestRouter = StaticRouter<oenPlain, oenWild>;
+
+const uint8_t replyPlain[] = {0x31, 0x41};
+
+ipmi_ret_t plainHandler(ipmi_cmd_t cmd, const uint8_t*, size_t reqLen,
+                        uint8_t* replyBuf, size_t* replyLen)
+{
+    EXPECT_EQ(0x78, cmd);
+    EXPECT_EQ(0, reqLen); // Excludes OEN
+    EXPECT_LE(sizeof(replyPlain), *replyLen);
+    *replyLen = sizeof(replyPlain);
+    std::memcpy(replyBuf, replyPlain, *replyLen);
+    return 0;
+}
+
+ipmi_ret_t echoHandler(ipmi_cmd_t, const uint8_t* reqBuf, size_t reqLen,
+                       uint8_t* replyBuf, size_t* replyLen)
+{
+    *replyLen = reqLen;
+    std::memcpy(replyBuf, reqBuf, reqLen);
+    return 0;
+}
+
+TestRouter makeRouter()
+{
+    TestRouter router;
+    EXPECT_TRUE(router.registerHandler(oenPlain, 0x78, plainHandler));
+    EXPECT_TRUE(
+        router.registerHandler(oenWild, IPMI_CMD_WILDCARD, echoHandler));
+    return router;
+}
+
+} // namespace
+
+TEST(StaticOemRouterTest, IndexesAreResolvedAtCompileTime)
+{
+    static_assert(TestRouter::indexOf(oenPlain) == 0);
+    static_assert(TestRouter::indexOf(oenWild) == 1);
+    static_assert(TestRouter::indexOf(0x345678) == TestRouter::oenCount);
+}
+
+TEST(StaticOemRouterTest, VerifiesSpecificCommandMatches)
+{
+    TestRouter router = makeRouter();
+    uint8_t reply[maxSpanReplySize];
+    size_t replyLen = sizeof(reply);
+
+    EXPECT_EQ(0, router.route(oenPlain, 0x78, nullptr, 0, reply, &replyLen));
+    ASSERT_EQ(sizeof(replyPlain), replyLen);
+    EXPECT_EQ(0, std::memcmp(replyPlain, reply, replyLen));
+}
+
+TEST(StaticOemRouterTest, WildCardMatchesTwoRandomCodes)
+{
+    TestRouter router = makeRouter();
+    const uint8_t req[] = {0x10, 0x20};
+    uint8_t reply[maxSpanReplySize];
+
+    for (ipmi_cmd_t cmd : {0x89, 0x67})
+    {
+        size_t replyLen = sizeof(reply);
+        EXPECT_EQ(0, router.route(oenWild, cmd, req, sizeof(req), reply,
+                                  &replyLen));
+        ASSERT_EQ(sizeof(req), replyLen);
+        EXPECT_EQ(0, std::memcmp(req, reply, replyLen));
+    }
+}
+
+TEST(StaticOemRouterTest, CommandsAreRejectedIfInvalid)
+{
+    TestRouter router = makeRouter();
+    uint8_t reply[maxSpanReplySize];
+    size_t replyLen = sizeof(reply);
+
+    // Wrong specific command?
+    EXPECT_EQ(IPMI_CC_INVALID,
+              router.route(oenPlain, 0x89, nullptr, 0, reply, &replyLen));
+    EXPECT_EQ(0, replyLen);
+
+    // Wrong OEN?
+    EXPECT_EQ(nullptr, router.find(0x345678, 0x78));
+    EXPECT_FALSE(router.registerHandler(0x345678, 0x78, plainHandler));
+}
+
+} // namespace oem
@@ -0,0 +1,100 @@
+#include "user_channel/pam_verifier_cache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace ipmi
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+class PamVerifierCacheTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::string dir = (fs::temp_directory_path() / "pamcacheXXXXXX");
+        ASSERT_NE(nullptr, mkdtemp(dir.data()));
+        root = dir;
+        fs::create_directories(root / "etc");
+        fs::create_directories(root / "var/log");
+        fs::create_directories(root / "var/run/faillock");
+        write("etc/passwd", "root:x:0:0::/root:/bin/sh\n");
+        write("etc/shadow", "root:$6$salt$hash:1::::::\n");
+        write("var/log/tallylog", "");
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(root);
+    }
+
+    void write(const std::string& file, const std::string& content)
+    {
+        std::ofstream(root / file, std::ios::trunc) << content;
+    }
+
+    /** @brief what a successful PAM login does to the files: pam_tally2
+     *         resets the count of the user in the tallylog
+     */
+    void pamAuthenticate()
+    {
+        write("var/log/tallylog", std::string(64, '\0'));
+    }
+
+    fs::path root;
+};
+
+TEST_F(PamVerifierCacheTest, SecondLoginIsAnsweredFromTheCache)
+{
+    PamVerifierCache cache(root);
+    EXPECT_FALSE(cache.verify("root", "0penBmc"));
+    pamAuthenticate();
+    cache.store("root", "0penBmc");
+
+    EXPECT_TRUE(cache.verify("root", "0penBmc"));
+    EXPECT_TRUE(cache.verify("root", "0penBmc"));
+}
+
+TEST_F(PamVerifierCacheTest, OtherPasswordIsNotAnswered)
+{
+    PamVerifierCache cache(root);
+    pamAuthenticate();
+    cache.store("root", "0penBmc");
+
+    EXPECT_FALSE(cache.verify("root", "wrong"));
+    EXPECT_FALSE(cache.verify("admin", "0penBmc"));
+}
+
+TEST_F(PamVerifierCacheTest, FileChangesDropTheVerifier)
+{
+    PamVerifierCache cache(root);
+    pamAuthenticate();
+    cache.store("root", "0penBmc");
+    write("etc/shadow", "root:$6$salt$otherhash:1::::::\n");
+    EXPECT_FALSE(cache.verify("root", "0penBmc"));
+
+    pamAuthenticate();
+    cache.store("root", "0penBmc");
+    write("var/run/faillock/root", "failure");
+    EXPECT_FALSE(cache.verify("root", "0penBmc"));
+}
+
+TEST_F(PamVerifierCacheTest, ForgetDropsTheVerifier)
+{
+    PamVerifierCache cache(root);
+    pamAuthenticate();
+    cache.store("root", "0penBmc");
+    cache.forget("root");
+    EXPECT_FALSE(cache.verify("root", "0penBmc"));
+}
+
+} // namespace
+
+} // namespace ipmi
@@ -0,0 +1,105 @@
+#include "pressure.hpp"
+
+#include <ipmid/api-types.hpp>
+
+#include <gtest/gtest.h>
+
+namespace ipmi
+{
+namespace pressure
+{
+namespace
+{
+
+TEST(ParseSomeAvg10, ReadsTheSomeLine)
+{
+    auto avg10 = parseSomeAvg10(
+        "some avg10=12.34 avg60=5.00 avg300=1.00 total=123456\n"
+        "full avg10=56.78 avg60=9.00 avg300=2.00 total=654321\n");
+    ASSERT_TRUE(avg10);
+    EXPECT_DOUBLE_EQ(*avg10, 12.34);
+}
+
+TEST(ParseSomeAvg10, SkipsTheFullLine)
+{
+    auto avg10 = parseSomeAvg10(
+        "full avg10=56.78 avg60=9.00 avg300=2.00 total=654321\n"
+        "some avg10=0.50 avg60=0.10 avg300=0.00 total=42\n");
+    ASSERT_TRUE(avg10);
+    EXPECT_DOUBLE_EQ(*avg10, 0.5);
+}
+
+TEST(ParseSomeAvg10, ReadsALastLineWithoutNewline)
+{
+    auto avg10 = parseSomeAvg10("some avg10=0.00 avg60=0.00 avg300=0.00 "
+                                "total=0");
+    ASSERT_TRUE(avg10);
+    EXPECT_DOUBLE_EQ(*avg10, 0.0);
+}
+
+TEST(ParseSomeAvg10, MissingAvg10IsNotAPressure)
+{
+    EXPECT_FALSE(parseSomeAvg10("some avg60=5.00 avg300=1.00 total=1\n"
+                                "full avg10=56.78 avg60=9.00 total=2\n"));
+}
+
+TEST(ParseSomeAvg10, OnlyAFullLineIsNotAPressure)
+{
+    EXPECT_FALSE(parseSomeAvg10("full avg10=56.78 avg60=9.00 total=2\n"));
+}
+
+TEST(ParseSomeAvg10, GarbageIsNotAPressure)
+{
+    EXPECT_FALSE(parseSomeAvg10(""));
+    EXPECT_FALSE(parseSomeAvg10("\n\n"));
+    EXPECT_FALSE(parseSomeAvg10("not a pressure file"));
+    EXPECT_FALSE(parseSomeAvg10("some avg10=high avg60=0.00\n"));
+    EXPECT_FALSE(parseSomeAvg10("something avg10=1.00\n"));
+}
+
+TEST(LaneOf, HeartbeatCommandsAreCritical)
+{
+    EXPECT_EQ(laneOf(netFnApp, app::cmdGetDeviceId), Lane::critical);
+    EXPECT_EQ(laneOf(netFnApp, app::cmdResetWatchdogTimer), Lane::critical);
+    EXPECT_EQ(laneOf(netFnApp, app::cmdSetWatchdogTimer), Lane::critical);
+    EXPECT_EQ(laneOf(netFnApp, app::cmdGetWatchdogTimer), Lane::critical);
+    EXPECT_EQ(laneOf(netFnApp, app::cmdClearMessageFlags), Lane::critical);
+    EXPECT_EQ(laneOf(netFnApp, app::cmdGetMessageFlags), Lane::critical);
+    EXPECT_EQ(laneOf(netFnApp, app::cmdGetMessage), Lane::critical);
+    EXPECT_EQ(laneOf(netFnApp, app::cmdReadEventMessageBuffer),
+              Lane::critical);
+    EXPECT_EQ(laneOf(netFnChassis, chassis::cmdGetChassisStatus),
+              Lane::critical);
+    EXPECT_EQ(laneOf(netFnChassis, chassis::cmdChassisControl),
+              Lane::critical);
+    EXPECT_EQ(laneOf(netFnSensor, sensor_event::cmdPlatformEvent),
+              Lane::critical);
+}
+
+TEST(LaneOf, RepositoryWalksAreExpensive)
+{
+    EXPECT_EQ(laneOf(netFnSensor, sensor_event::cmdGetDeviceSdr),
+              Lane::expensive);
+    EXPECT_EQ(laneOf(netFnStorage, storage::cmdReadFruData),
+              Lane::expensive);
+    EXPECT_EQ(laneOf(netFnStorage, storage::cmdGetSdr), Lane::expensive);
+    EXPECT_EQ(laneOf(netFnStorage, storage::cmdGetSelEntry),
+              Lane::expensive);
+}
+
+TEST(LaneOf, OtherCommandsAreNormal)
+{
+    EXPECT_EQ(laneOf(netFnApp, app::cmdGetSelfTestResults), Lane::normal);
+    EXPECT_EQ(laneOf(netFnChassis, chassis::cmdGetChassisCapabilities),
+              Lane::normal);
+    EXPECT_EQ(laneOf(netFnSensor, sensor_event::cmdGetSensorReading),
+              Lane::normal);
+    EXPECT_EQ(laneOf(netFnStorage, storage::cmdGetSelInfo), Lane::normal);
+    EXPECT_EQ(laneOf(netFnTransport, transport::cmdGetLanConfigParameters),
+              Lane::normal);
+    EXPECT_EQ(laneOf(netFnOemOne, app::cmdGetDeviceId), Lane::normal);
+}
+
+} // namespace
+} // namespace pressure
+} // namespace ipmi
@@ -0,0 +1,277 @@
+#include "selindex.hpp"
+
+#include "selutility.hpp"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace ipmi
+{
+namespace sel
+{
+
+namespace
+{
+
+class SelIndexTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char dir[] = "/tmp/selindex_XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(dir));
+        tmpDir = dir;
+        path = tmpDir / "ipmi_sel";
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(tmpDir);
+    }
+
+    static std::string makeLine(uint16_t recordID)
+    {
+        return "2021-03-04T05:06:07.000000+00:00 " + std::to_string(recordID) +
+               ",2,00112233445566778899AABBCCDD,20,/xyz/sensor,1";
+    }
+
+    static void append(const std::filesystem::path& file,
+                       const std::string& text)
+    {
+        std::ofstream out(file, std::ios::app);
+        out << text;
+    }
+
+    static void appendLine(const std::filesystem::path& file,
+                           uint16_t recordID)
+    {
+        append(file, makeLine(recordID) + "\n");
+    }
+
+    std::filesystem::path tmpDir;
+    std::filesystem::path path;
+};
+
+} // namespace
+
+TEST_F(SelIndexTest, NoLogIsEmpty)
+{
+    LogIndex index(tmpDir, "ipmi_sel");
+    std::string line;
+    EXPECT_EQ(0u, index.count());
+    EXPECT_EQ(0, index.lastRecordID());
+    EXPECT_FALSE(index.read(firstEntry, line));
+    EXPECT_FALSE(index.read(1, line));
+    EXPECT_EQ(invalidTimeStamp, index.lastAddTime());
+}
+
+TEST_F(SelIndexTest, ReadsTheLineOfARecord)
+{
+    appendLine(path, 1);
+    appendLine(path, 2);
+    LogIndex index(tmpDir, "ipmi_sel");
+
+    std::string line;
+    ASSERT_TRUE(index.read(2, line));
+    EXPECT_EQ(makeLine(2), line);
+    ASSERT_TRUE(index.read(1, line));
+    EXPECT_EQ(makeLine(1), line);
+    EXPECT_FALSE(index.read(3, line));
+    EXPECT_NE(invalidTimeStamp, index.lastAddTime());
+}
+
+TEST_F(SelIndexTest, PicksUpAppendedLines)
+{
+    appendLine(path, 1);
+    LogIndex index(tmpDir, "ipmi_sel");
+    EXPECT_EQ(1u, index.count());
+
+    appendLine(path, 2);
+    index.append();
+    EXPECT_EQ(2u, index.count());
+    EXPECT_EQ(2, index.lastRecordID());
+    std::string line;
+    ASSERT_TRUE(index.read(2, line));
+    EXPECT_EQ(makeLine(2), line);
+}
+
+TEST_F(SelIndexTest, PartialLineWaitsForItsNewline)
+{
+    appendLine(path, 1);
+    std::string second = makeLine(2);
+    append(path, second.substr(0, 20));
+    LogIndex index(tmpDir, "ipmi_sel");
+    EXPECT_EQ(1u, index.count());
+
+    append(path, second.substr(20) + "\n");
+    EXPECT_EQ(2u, index.count());
+    std::string line;
+    ASSERT_TRUE(index.read(2, line));
+    EXPECT_EQ(second, line);
+}
+
+TEST_F(SelIndexTest, FirstAndLastEntry)
+{
+    appendLine(path, 5);
+    appendLine(path, 6);
+    appendLine(path, 7);
+    LogIndex index(tmpDir, "ipmi_sel");
+
+    std::string line;
+    ASSERT_TRUE(index.read(firstEntry, line));
+    EXPECT_EQ(makeLine(5), line);
+    ASSERT_TRUE(index.read(lastEntry, line));
+    EXPECT_EQ(makeLine(7), line);
+    EXPECT_EQ(7, index.lastRecordID());
+}
+
+TEST_F(SelIndexTest, NextRecordID)
+{
+    appendLine(path, 1);
+    appendLine(path, 2);
+    appendLine(path, 3);
+    LogIndex index(tmpDir, "ipmi_sel");
+
+    EXPECT_EQ(2, index.nextRecordID(1));
+    EXPECT_EQ(3, index.nextRecordID(2));
+    EXPECT_EQ(lastEntry, index.nextRecordID(3));
+}
+
+TEST_F(SelIndexTest, RotatedFilesAreOlder)
+{
+    appendLine(tmpDir / "ipmi_sel.2", 1);
+    appendLine(tmpDir / "ipmi_sel.1", 2);
+    appendLine(path, 3);
+    LogIndex index(tmpDir, "ipmi_sel");
+
+    EXPECT_EQ(3u, index.count());
+    std::string line;
+    ASSERT_TRUE(index.read(firstEntry, line));
+    EXPECT_EQ(makeLine(1), line);
+    ASSERT_TRUE(index.read(2, line));
+    EXPECT_EQ(makeLine(2), line);
+    ASSERT_TRUE(index.read(lastEntry, line));
+    EXPECT_EQ(makeLine(3), line);
+}
+
+TEST_F(SelIndexTest, RebuildsAfterARotation)
+{
+    appendLine(path, 1);
+    appendLine(path, 2);
+    LogIndex index(tmpDir, "ipmi_sel");
+    EXPECT_EQ(2u, index.count());
+
+    std::filesystem::rename(path, tmpDir / "ipmi_sel.1");
+    appendLine(path, 3);
+    EXPECT_EQ(3u, index.count());
+    std::string line;
+    ASSERT_TRUE(index.read(1, line));
+    EXPECT_EQ(makeLine(1), line);
+    ASSERT_TRUE(index.read(3, line));
+    EXPECT_EQ(makeLine(3), line);
+}
+
+TEST_F(SelIndexTest, ClearRemovesTheRecords)
+{
+    appendLine(tmpDir / "ipmi_sel.1", 1);
+    appendLine(path, 2);
+    LogIndex index(tmpDir, "ipmi_sel");
+    EXPECT_EQ(2u, index.count());
+
+    std::filesystem::remove(tmpDir / "ipmi_sel.1");
+    std::filesystem::remove(path);
+    std::string line;
+    EXPECT_EQ(0u, index.count());
+    EXPECT_FALSE(index.read(2, line));
+    EXPECT_EQ(invalidTimeStamp, index.lastAddTime());
+
+    // rsyslog creates the log again with the next record
+    appendLine(path, 1);
+    EXPECT_EQ(1u, index.count());
+    ASSERT_TRUE(index.read(1, line));
+    EXPECT_EQ(makeLine(1), line);
+    EXPECT_FALSE(index.read(2, line));
+}
+
+TEST_F(SelIndexTest, TruncatedLogIsIndexedAgain)
+{
+    appendLine(path, 1);
+    appendLine(path, 2);
+    LogIndex index(tmpDir, "ipmi_sel");
+    EXPECT_EQ(2u, index.count());
+
+    std::filesystem::resize_file(path, 0);
+    appendLine(path, 9);
+    EXPECT_EQ(1u, index.count());
+    EXPECT_EQ(9, index.lastRecordID());
+}
+
+TEST_F(SelIndexTest, MalformedLinesAreSkipped)
+{
+    append(path, "not a sel line\n");
+    appendLine(path, 1);
+    append(path, "\n");
+    append(path, "2021-03-04T05:06:07.000000+00:00 x2,2,00\n");
+    append(path, "2021-03-04T05:06:07.000000+00:00 3\n");
+    appendLine(path, 4);
+    LogIndex index(tmpDir, "ipmi_sel");
+
+    EXPECT_EQ(2u, index.count());
+    EXPECT_EQ(lastEntry, index.nextRecordID(1));
+    std::string line;
+    ASSERT_TRUE(index.read(4, line));
+    EXPECT_EQ(makeLine(4), line);
+}
+
+TEST_F(SelIndexTest, ResetRebuildsTheIndex)
+{
+    appendLine(path, 1);
+    LogIndex index(tmpDir, "ipmi_sel");
+    EXPECT_EQ(1u, index.count());
+
+    index.reset();
+    EXPECT_EQ(1u, index.count());
+}
+
+TEST_F(SelIndexTest, DecodedRecords)
+{
+    appendLine(path, 1);
+    appendLine(path, 2);
+    LogIndex index(tmpDir, "ipmi_sel",
+                   [](std::string_view line, LogIndex::Record& record) {
+                       if (line.find(" 2,") != std::string_view::npos)
+                       {
+                           return false;
+                       }
+                       record.fill(0);
+                       record[0] = 0x01;
+                       return true;
+                   });
+
+    std::optional<LogIndex::Record> record;
+    ASSERT_TRUE(index.readRecord(1, record));
+    ASSERT_TRUE(record);
+    EXPECT_EQ(0x01, (*record)[0]);
+    // the decoder rejected the line, the record is still there
+    ASSERT_TRUE(index.readRecord(2, record));
+    EXPECT_FALSE(record);
+    EXPECT_FALSE(index.readRecord(3, record));
+}
+
+TEST_F(SelIndexTest, NoDecoderHasNoRecords)
+{
+    appendLine(path, 1);
+    LogIndex index(tmpDir, "ipmi_sel");
+
+    std::optional<LogIndex::Record> record;
+    ASSERT_TRUE(index.readRecord(1, record));
+    EXPECT_FALSE(record);
+}
+
+} // namespace sel
+} // namespace ipmi
@@ -0,0 +1,144 @@
+#include "selring.hpp"
+
+#include <unistd.h>
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+namespace ipmi
+{
+namespace sel
+{
+
+namespace
+{
+
+class SelRingTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char dir[] = "/tmp/selring_XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(dir));
+        tmpDir = dir;
+        path = tmpDir / "sel_ring";
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(tmpDir);
+    }
+
+    static Ring::Record makeRecord(uint8_t data)
+    {
+        Ring::Record record{};
+        record[2] = 0x02;
+        record[15] = data;
+        return record;
+    }
+
+    std::filesystem::path tmpDir;
+    std::filesystem::path path;
+};
+
+} // namespace
+
+TEST_F(SelRingTest, NewRingIsEmpty)
+{
+    Ring ring(path, 4);
+    Ring::Record record;
+    EXPECT_EQ(0, ring.count());
+    EXPECT_FALSE(ring.read(0x0000, record));
+    EXPECT_FALSE(ring.overflow());
+    EXPECT_EQ(0xFFFFFFFF, ring.lastAddTime());
+    EXPECT_EQ(0xFFFFFFFF, ring.lastEraseTime());
+}
+
+TEST_F(SelRingTest, AssignsSequentialRecordIDs)
+{
+    Ring ring(path, 4);
+    for (uint8_t i = 1; i <= 3; i++)
+    {
+        Ring::Record record = makeRecord(i);
+        ASSERT_TRUE(ring.add(record, 100 + i));
+        EXPECT_EQ(i, record[0] | record[1] << 8);
+    }
+    EXPECT_EQ(3, ring.count());
+    EXPECT_EQ(103, ring.lastAddTime());
+
+    Ring::Record record;
+    ASSERT_TRUE(ring.read(0x0000, record));
+    EXPECT_EQ(1, record[15]);
+    ASSERT_TRUE(ring.read(0xFFFF, record));
+    EXPECT_EQ(3, record[15]);
+    ASSERT_TRUE(ring.read(2, record));
+    EXPECT_EQ(2, record[15]);
+    EXPECT_FALSE(ring.read(4, record));
+
+    EXPECT_EQ(2, ring.nextRecordID(1));
+    EXPECT_EQ(0xFFFF, ring.nextRecordID(3));
+}
+
+TEST_F(SelRingTest, OverwritesOldestWhenFull)
+{
+    Ring ring(path, 4);
+    for (uint8_t i = 1; i <= 6; i++)
+    {
+        Ring::Record record = makeRecord(i);
+        ASSERT_TRUE(ring.add(record, i));
+    }
+    EXPECT_EQ(4, ring.count());
+    EXPECT_TRUE(ring.overflow());
+
+    Ring::Record record;
+    EXPECT_FALSE(ring.read(2, record));
+    ASSERT_TRUE(ring.read(0x0000, record));
+    EXPECT_EQ(3, record[0]);
+    EXPECT_EQ(3, record[15]);
+    ASSERT_TRUE(ring.read(6, record));
+    EXPECT_EQ(6, record[15]);
+    EXPECT_EQ(5, ring.nextRecordID(4));
+}
+
+TEST_F(SelRingTest, ClearKeepsCountingRecordIDs)
+{
+    Ring ring(path, 4);
+    for (uint8_t i = 1; i <= 5; i++)
+    {
+        Ring::Record record = makeRecord(i);
+        ASSERT_TRUE(ring.add(record, i));
+    }
+    ASSERT_TRUE(ring.clear(200));
+    EXPECT_EQ(0, ring.count());
+    EXPECT_FALSE(ring.overflow());
+    EXPECT_EQ(200, ring.lastEraseTime());
+
+    Ring::Record record = makeRecord(7);
+    ASSERT_TRUE(ring.add(record, 201));
+    EXPECT_EQ(6, record[0]);
+    ASSERT_TRUE(ring.read(0x0000, record));
+    EXPECT_EQ(7, record[15]);
+}
+
+TEST_F(SelRingTest, PersistsAcrossInstances)
+{
+    {
+        Ring ring(path, 4);
+        Ring::Record record = makeRecord(9);
+        ASSERT_TRUE(ring.add(record, 300));
+    }
+
+    Ring ring(path, 4);
+    Ring::Record record;
+    ASSERT_TRUE(ring.read(1, record));
+    EXPECT_EQ(9, record[15]);
+    EXPECT_EQ(300, ring.lastAddTime());
+
+    // another capacity is another layout, the ring starts over
+    Ring resized(path, 8);
+    EXPECT_EQ(0, resized.count());
+}
+
+} // namespace sel
+} // namespace ipmi
@@ -57,9 +57,75 @@ const std::unordered_set<IP::AddressOrigin> originsV4 = {
 static constexpr uint8_t oemCmdStart = 192;
 static constexpr uint8_t oemCmdEnd = 255;
 
+/** @brief Channel params already resolved, by channel. Cleared whenever the
+ *         network daemon adds or removes objects, as the interface paths or
+ *         the VLAN of a channel may have changed.
+ */
+static std::unordered_map<uint8_t, ChannelParams> channelParamsCache;
+
+/** @brief LAN configuration of a channel read with a single GetManagedObjects
+ *         of the network daemon, used to answer the bursts of Get LAN
+ *         Configuration Parameters commands of tools like ipmitool.
+ */
+struct LanConfig
+{
+    std::chrono::steady_clock::time_point time;
+    std::optional<IfAddr<AF_INET>> ifaddr4;
+    EthernetInterface::DHCPConf dhcp;
+    ether_addr mac;
+    std::optional<in_addr> gateway4;
+    std::optional<IfNeigh<AF_INET>> neighbor4;
+    uint16_t vlan;
+    bool ipv6AcceptRA;
+    std::optional<in6_addr> gateway6;
+    std::optional<IfNeigh<AF_INET6>> neighbor6;
+    std::vector<IfAddr<AF_INET6>> ifaddrs6Static;
+    std::vector<IfAddr<AF_INET6>> ifaddrs6Dynamic;
+};
+
+/** @brief How long a LAN configuration snapshot is used at most. It is
+ *         dropped when the channel is configured through IPMI and when the
+ *         network daemon adds or removes objects or changes a property, so
+ *         this only bounds the life of one whose signal was missed.
+ */
+constexpr std::chrono::seconds lanConfigValidity(60);
+static std::unordered_map<uint8_t, LanConfig> lanConfigCache;
+
+static ipmi::dbus_signals::Subscription ifAdded;
+static ipmi::dbus_signals::Subscription ifRemoved;
+static ipmi::dbus_signals::Subscription propertiesChanged;
+
+/** @brief Subscribes to the signals that invalidate the channel params
+ *         cache
+ */
+static void watchNetworkInterfaces()
+{
+    if (ifAdded)
+    {
+        return;
+    }
+    auto invalidate = [](const auto&) {
+        channelParamsCache.clear();
+        lanConfigCache.clear();
+    };
+    ifAdded = ipmi::dbus_signals::onInterfacesAdded(PATH_ROOT, invalidate);
+    ifRemoved = ipmi::dbus_signals::onInterfacesRemoved(PATH_ROOT, invalidate);
+    // the addresses, DHCP state and gateways of the snapshots
+    propertiesChanged = ipmi::dbus_signals::onPropertiesChanged(
+        PATH_ROOT, [](const auto&) { lanConfigCache.clear(); });
+}
+
 std::optional<ChannelParams> maybeGetChannelParams(sdbusplus::bus::bus& bus,
                                                    uint8_t channel)
 {
+    // watch before the lookup, so that no change can be missed
+    watchNetworkInterfaces();
+    auto cached = channelParamsCache.find(channel);
+    if (cached != channelParamsCache.end())
+    {
+        return cached->second;
+    }
+
     auto ifname = getChannelName(channel);
     if (ifname.empty())
     {
@@ -67,13 +133,8 @@ std::optional<ChannelParams> maybeGetChannelParams(sdbusplus::bus::bus& bus,
     }
 
     // Enumerate all VLAN + ETHERNET interfaces
-    auto req = bus.new_method_call(MAPPER_BUS_NAME, MAPPER_OBJ, MAPPER_INTF,
-                                   "GetSubTree");
-    req.append(PATH_ROOT, 0,
-               std::vector<std::string>{INTF_VLAN, INTF_ETHERNET});
-    auto reply = bus.call(req);
-    ObjectTree objs;
-    reply.read(objs);
+    ObjectTree objs =
+        mapper::getSubTree(bus, PATH_ROOT, 0, {INTF_VLAN, INTF_ETHERNET});
 
     ChannelParams params;
     for (const auto& [path, impls] : objs)
@@ -125,6 +186,7 @@ std::optional<ChannelParams> maybeGetChannelParams(sdbusplus::bus::bus& bus,
 
     params.id = channel;
     params.ifname = std::move(ifname);
+    channelParamsCache.emplace(channel, params);
     return std::move(params);
 }
 
@@ -279,19 +341,6 @@ ether_addr stringToMAC(const char* mac)
     return *ret;
 }
 
-/** @brief Determines the MAC of the ethernet interface
- *
- *  @param[in] bus    - The bus object used for lookups
- *  @param[in] params - The parameters for the channel
- *  @return The configured mac address
- */
-ether_addr getMACProperty(sdbusplus::bus::bus& bus, const ChannelParams& params)
-{
-    auto macStr = std::get<std::string>(getDbusProperty(
-        bus, params.service, params.ifPath, INTF_MAC, "MACAddress"));
-    return stringToMAC(macStr.c_str());
-}
-
 /** @brief Sets the system value for MAC address on the given interface
  *
  *  @param[in] bus    - The bus object used for lookups
@@ -407,14 +456,6 @@ std::optional<IfNeigh<family>> findGatewayNeighbor(sdbusplus::bus::bus& bus,
     return findStaticNeighbor<family>(bus, params, *gateway, neighbors);
 }
 
-template <int family>
-std::optional<IfNeigh<family>> getGatewayNeighbor(sdbusplus::bus::bus& bus,
-                                                  const ChannelParams& params)
-{
-    ObjectLookupCache neighbors(bus, params, INTF_NEIGHBOR);
-    return findGatewayNeighbor<family>(bus, params, neighbors);
-}
-
 template <int family>
 void reconfigureGatewayMAC(sdbusplus::bus::bus& bus,
                            const ChannelParams& params, const ether_addr& mac)
@@ -498,12 +539,11 @@ IPv6Source originToSourceType(IP::AddressOrigin origin)
 /** @brief Packs the IPMI message response with IPv6 address data
  *
  *  @param[out] ret     - The IPMI response payload to be packed
- *  @param[in]  channel - The channel id corresponding to an ethernet interface
  *  @param[in]  set     - The set selector for determining address index
- *  @param[in]  origins - Set of valid origins for address filtering
+ *  @param[in]  ifaddrs - The addresses of the interface with valid origins
  */
-void getLanIPv6Address(message::Payload& ret, uint8_t channel, uint8_t set,
-                       const std::unordered_set<IP::AddressOrigin>& origins)
+void getLanIPv6Address(message::Payload& ret, uint8_t set,
+                       const std::vector<IfAddr<AF_INET6>>& ifaddrs)
 {
     auto source = IPv6Source::Static;
     bool enabled = false;
@@ -511,7 +551,11 @@ void getLanIPv6Address(message::Payload& ret, uint8_t channel, uint8_t set,
     uint8_t prefix = AddrFamily<AF_INET6>::defaultPrefix;
     auto status = IPv6AddressStatus::Disabled;
 
-    auto ifaddr = channelCall<getIfAddr<AF_INET6>>(channel, set, origins);
+    const IfAddr<AF_INET6>* ifaddr = nullptr;
+    if (set < ifaddrs.size())
+    {
+        ifaddr = &ifaddrs[set];
+    }
     if (ifaddr)
     {
         source = originToSourceType(ifaddr->origin);
@@ -528,31 +572,6 @@ void getLanIPv6Address(message::Payload& ret, uint8_t channel, uint8_t set,
     ret.pack(types::enum_cast<uint8_t>(status));
 }
 
-/** @brief Gets the vlan ID configured on the interface
- *
- *  @param[in] bus    - The bus object used for lookups
- *  @param[in] params - The parameters for the channel
- *  @return VLAN id or the standard 0 for no VLAN
- */
-uint16_t getVLANProperty(sdbusplus::bus::bus& bus, const ChannelParams& params)
-{
-    // VLAN devices will always have a separate logical object
-    if (params.ifPath == params.logicalPath)
-    {
-        return 0;
-    }
-
-    auto vlan = std::get<uint32_t>(getDbusProperty(
-        bus, params.service, params.logicalPath, INTF_VLAN, "Id"));
-    if ((vlan & VLAN_VALUE_MASK) != vlan)
-    {
-        logWithChannel<level::ERR>(params, "networkd returned an invalid vlan",
-                                   entry("VLAN=%" PRIu32, vlan));
-        elog<InternalFailure>();
-    }
-    return vlan;
-}
-
 /** @brief Deletes all of the possible configuration parameters for a channel
  *
  *  @param[in] bus    - The bus object used for lookups
@@ -584,6 +603,9 @@ void deconfigureChannel(sdbusplus::bus::bus& bus, ChannelParams& params)
         }
     }
 
+    // the signals of the deletions are only processed after this request
+    channelParamsCache.erase(params.id);
+
     // Clear out any settings on the lower physical interface
     setDHCPv6Property(bus, params, EthernetInterface::DHCPConf::none, false);
 }
@@ -608,6 +630,7 @@ void createVLAN(sdbusplus::bus::bus& bus, ChannelParams& params, uint16_t vlan)
     sdbusplus::message::object_path newPath;
     reply.read(newPath);
     params.logicalPath = std::move(newPath);
+    channelParamsCache.erase(params.id);
 }
 
 /** @brief Performs the necessary reconfiguration to change the VLAN
@@ -732,19 +755,242 @@ SetStatus& getSetStatus(uint8_t channel)
     return setStatus[channel] = SetStatus::Complete;
 }
 
-/** @brief Gets the IPv6 Router Advertisement value
+/** @brief Address parameters set while the Set In Progress status of a
+ *         channel is in progress. They are applied together when the set is
+ *         committed, so that the interface is reconfigured once instead of
+ *         once per parameter.
+ */
+struct PendingLanConfig
+{
+    std::optional<in_addr> ip;
+    std::optional<uint8_t> prefix;
+    std::optional<in_addr> gateway;
+    std::optional<ether_addr> gatewayMAC;
+    std::optional<uint16_t> vlan;
+};
+static std::unordered_map<uint8_t, PendingLanConfig> pendingLanConfig;
+
+/** @brief The staged parameters are applied when no parameter was set for
+ *         this long, in case the set is never committed
+ */
+constexpr std::chrono::seconds lanConfigIdleTimeout(10);
+static std::unordered_map<uint8_t, std::unique_ptr<boost::asio::steady_timer>>
+    lanConfigTimers;
+
+/** @brief Applies the staged parameters of the channel
+ *
+ *  @param[in] channel - The channel id corresponding to an ethernet interface
+ */
+static void applyLanConfig(uint8_t channel)
+{
+    auto it = pendingLanConfig.find(channel);
+    if (it == pendingLanConfig.end())
+    {
+        return;
+    }
+    PendingLanConfig pending = it->second;
+    pendingLanConfig.erase(it);
+    lanConfigCache.erase(channel);
+
+    try
+    {
+        // The VLAN change carries the addresses over, so do it first
+        if (pending.vlan)
+        {
+            channelCall<reconfigureVLAN>(channel, *pending.vlan);
+        }
+        if (pending.ip || pending.prefix)
+        {
+            channelCall<reconfigureIfAddr4>(channel, pending.ip,
+                                            pending.prefix);
+        }
+        if (pending.gateway)
+        {
+            channelCall<setGatewayProperty<AF_INET>>(channel,
+                                                     *pending.gateway);
+        }
+        if (pending.gatewayMAC)
+        {
+            channelCall<reconfigureGatewayMAC<AF_INET>>(channel,
+                                                        *pending.gatewayMAC);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Failed to apply the LAN configuration",
+                        entry("CHANNEL=%" PRIu8, channel),
+                        entry("ERROR=%s", e.what()));
+    }
+    lanConfigCache.erase(channel);
+}
+
+/** @brief Applies the staged parameters of the channel once the current
+ *         request is answered
+ *
+ *  @param[in] channel - The channel id corresponding to an ethernet interface
+ */
+static void commitLanConfig(uint8_t channel)
+{
+    auto timer = lanConfigTimers.find(channel);
+    if (timer != lanConfigTimers.end())
+    {
+        timer->second->cancel();
+    }
+    if (pendingLanConfig.find(channel) != pendingLanConfig.end())
+    {
+        post_work([channel]() { applyLanConfig(channel); });
+    }
+}
+
+/** @brief Gets the staged parameters of the channel, if the Set In Progress
+ *         status is in progress, and restarts the idle timeout
+ *
+ *  @param[in] channel - The channel id corresponding to an ethernet interface
+ *  @return The staged parameters, or nullptr to apply the parameter now
+ */
+static PendingLanConfig* stageLanConfig(uint8_t channel)
+{
+    if (getSetStatus(channel) != SetStatus::InProgress)
+    {
+        return nullptr;
+    }
+    auto& timer = lanConfigTimers[channel];
+    if (!timer)
+    {
+        timer = std::make_unique<boost::asio::steady_timer>(*getIoContext());
+    }
+    timer->expires_after(lanConfigIdleTimeout);
+    timer->async_wait([channel](const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        log<level::WARNING>("Set LAN Configuration timed out, applying",
+                            entry("CHANNEL=%" PRIu8, channel));
+        getSetStatus(channel) = SetStatus::Complete;
+        applyLanConfig(channel);
+    });
+    return &pendingLanConfig[channel];
+}
+
+/** @brief Reads the LAN configuration of a channel from the objects of the
+ *         network daemon
  *
  *  @param[in] bus    - The bus object used for lookups
  *  @param[in] params - The parameters for the channel
- *  @return networkd IPV6AcceptRA value
+ *  @return The LAN configuration
  */
-static bool getIPv6AcceptRA(sdbusplus::bus::bus& bus,
-                            const ChannelParams& params)
+static LanConfig readLanConfig(sdbusplus::bus::bus& bus,
+                               const ChannelParams& params)
 {
-    auto raEnabled =
-        std::get<bool>(getDbusProperty(bus, params.service, params.logicalPath,
-                                       INTF_ETHERNET, "IPv6AcceptRA"));
-    return raEnabled;
+    ObjectValueTree objs = getManagedObjects(bus, params.service, PATH_ROOT);
+
+    // The address and neighbor objects of the logical interface, ordered by
+    // path like the mapper lookups of ObjectLookupCache
+    std::map<std::string, PropertyMap> ips;
+    std::map<std::string, PropertyMap> neighbors;
+    const std::string prefix = params.logicalPath + "/";
+    for (auto& [path, intfs] : objs)
+    {
+        const std::string& objPath = path.str;
+        if (objPath != params.logicalPath &&
+            objPath.compare(0, prefix.size(), prefix) != 0)
+        {
+            continue;
+        }
+        auto ip = intfs.find(INTF_IP);
+        if (ip != intfs.end())
+        {
+            ips.emplace(objPath, std::move(ip->second));
+        }
+        auto neighbor = intfs.find(INTF_NEIGHBOR);
+        if (neighbor != intfs.end())
+        {
+            neighbors.emplace(objPath, std::move(neighbor->second));
+        }
+    }
+    auto properties = [&objs](const std::string& path, const char* intf)
+        -> const PropertyMap& {
+        return objs.at(sdbusplus::message::object_path(path)).at(intf);
+    };
+
+    LanConfig lan;
+    lan.ifaddr4 = findIfAddr<AF_INET>(bus, params, 0, originsV4, ips);
+    // the set selectors index these directly
+    lan.ifaddrs6Static = findIfAddrs<AF_INET6>(originsV6Static, ips,
+                                               MAX_IPV6_STATIC_ADDRESSES);
+    lan.ifaddrs6Dynamic = findIfAddrs<AF_INET6>(originsV6Dynamic, ips,
+                                                MAX_IPV6_DYNAMIC_ADDRESSES);
+
+    const PropertyMap& ethernet =
+        properties(params.logicalPath, INTF_ETHERNET);
+    lan.dhcp = EthernetInterface::convertDHCPConfFromString(
+        std::get<std::string>(ethernet.at("DHCPEnabled")));
+    lan.ipv6AcceptRA = std::get<bool>(ethernet.at("IPv6AcceptRA"));
+
+    const auto& macStr = std::get<std::string>(
+        properties(params.ifPath, INTF_MAC).at("MACAddress"));
+    lan.mac = stringToMAC(macStr.c_str());
+
+    // VLAN devices will always have a separate logical object
+    lan.vlan = 0;
+    if (params.ifPath != params.logicalPath)
+    {
+        auto vlan = std::get<uint32_t>(
+            properties(params.logicalPath, INTF_VLAN).at("Id"));
+        if ((vlan & VLAN_VALUE_MASK) != vlan)
+        {
+            logWithChannel<level::ERR>(params,
+                                       "networkd returned an invalid vlan",
+                                       entry("VLAN=%" PRIu32, vlan));
+            elog<InternalFailure>();
+        }
+        lan.vlan = vlan;
+    }
+
+    const PropertyMap& sysConfig =
+        properties(PATH_SYSTEMCONFIG, INTF_SYSTEMCONFIG);
+    const auto& gateway4Str = std::get<std::string>(
+        sysConfig.at(AddrFamily<AF_INET>::propertyGateway));
+    if (!gateway4Str.empty())
+    {
+        lan.gateway4 = stringToAddr<AF_INET>(gateway4Str.c_str());
+        lan.neighbor4 = findStaticNeighbor<AF_INET>(bus, params,
+                                                    *lan.gateway4, neighbors);
+    }
+    const auto& gateway6Str = std::get<std::string>(
+        sysConfig.at(AddrFamily<AF_INET6>::propertyGateway));
+    if (!gateway6Str.empty())
+    {
+        lan.gateway6 = stringToAddr<AF_INET6>(gateway6Str.c_str());
+        lan.neighbor6 = findStaticNeighbor<AF_INET6>(bus, params,
+                                                     *lan.gateway6, neighbors);
+    }
+
+    return lan;
+}
+
+/** @brief Gets the LAN configuration of a channel, reusing the last snapshot
+ *         while it is recent enough
+ *
+ *  @param[in] channel - The channel id corresponding to an ethernet interface
+ *  @return The LAN configuration
+ */
+static const LanConfig& getLanConfig(uint8_t channel)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto it = lanConfigCache.find(channel);
+    if (it != lanConfigCache.end() && now - it->second.time < lanConfigValidity)
+    {
+        return it->second;
+    }
+
+    sdbusplus::bus::bus bus(ipmid_get_sd_bus_connection());
+    auto params = getChannelParams(bus, channel);
+    LanConfig lan = readLanConfig(bus, params);
+    lan.time = now;
+    return lanConfigCache.insert_or_assign(channel, std::move(lan))
+        .first->second;
 }
 
 /** @brief Sets the IPv6AcceptRA flag
@@ -850,6 +1096,8 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
         req.trailingOk = true;
         return responseInvalidFieldRequest();
     }
+    // show the new configuration on the next Get LAN Configuration
+    lanConfigCache.erase(channel);
 
     switch (static_cast<LanParam>(parameter))
     {
@@ -870,7 +1118,10 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
             {
                 case SetStatus::Complete:
                 {
+                    // Without rollback support, completing the set applies
+                    // the pending parameters like a commit
                     getSetStatus(channel) = status;
+                    commitLanConfig(channel);
                     return responseSuccess();
                 }
                 case SetStatus::InProgress:
@@ -888,6 +1139,7 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
                     {
                         return responseInvalidFieldRequest();
                     }
+                    commitLanConfig(channel);
                     return responseSuccess();
             }
             return response(ccParamNotSupported);
@@ -918,6 +1170,11 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
                 return responseReqDataLenInvalid();
             }
             copyInto(ip, bytes);
+            if (auto pending = stageLanConfig(channel))
+            {
+                pending->ip = ip;
+                return responseSuccess();
+            }
             channelCall<reconfigureIfAddr4>(channel, ip, std::nullopt);
             return responseSuccess();
         }
@@ -993,6 +1250,11 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
                 return responseReqDataLenInvalid();
             }
             copyInto(netmask, bytes);
+            if (auto pending = stageLanConfig(channel))
+            {
+                pending->prefix = netmaskToPrefix(netmask);
+                return responseSuccess();
+            }
             channelCall<reconfigureIfAddr4>(channel, std::nullopt,
                                             netmaskToPrefix(netmask));
             return responseSuccess();
@@ -1013,6 +1275,11 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
                 return responseReqDataLenInvalid();
             }
             copyInto(gateway, bytes);
+            if (auto pending = stageLanConfig(channel))
+            {
+                pending->gateway = gateway;
+                return responseSuccess();
+            }
             channelCall<setGatewayProperty<AF_INET>>(channel, gateway);
             return responseSuccess();
         }
@@ -1025,6 +1292,11 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
                 return responseReqDataLenInvalid();
             }
             copyInto(gatewayMAC, bytes);
+            if (auto pending = stageLanConfig(channel))
+            {
+                pending->gatewayMAC = gatewayMAC;
+                return responseSuccess();
+            }
             channelCall<reconfigureGatewayMAC<AF_INET>>(channel, gatewayMAC);
             return responseSuccess();
         }
@@ -1057,6 +1329,11 @@ RspType<> setLan(Context::ptr ctx, uint4_t channelBits, uint4_t reserved1,
                 return responseInvalidFieldRequest();
             }
 
+            if (auto pending = stageLanConfig(channel))
+            {
+                pending->vlan = vlan;
+                return responseSuccess();
+            }
             channelCall<reconfigureVLAN>(channel, vlan);
             return responseSuccess();
         }
@@ -1297,7 +1574,7 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
         }
         case LanParam::IP:
         {
-            auto ifaddr = channelCall<getIfAddr4>(channel);
+            const auto& ifaddr = getLanConfig(channel).ifaddr4;
             in_addr addr{};
             if (ifaddr)
             {
@@ -1309,8 +1586,7 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
         case LanParam::IPSrc:
         {
             auto src = IPSrc::Static;
-            EthernetInterface::DHCPConf dhcp =
-                channelCall<getDHCPProperty>(channel);
+            EthernetInterface::DHCPConf dhcp = getLanConfig(channel).dhcp;
             if ((dhcp == EthernetInterface::DHCPConf::v4) ||
                 (dhcp == EthernetInterface::DHCPConf::both))
             {
@@ -1321,13 +1597,13 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
         }
         case LanParam::MAC:
         {
-            ether_addr mac = channelCall<getMACProperty>(channel);
+            ether_addr mac = getLanConfig(channel).mac;
             ret.pack(dataRef(mac));
             return responseSuccess(std::move(ret));
         }
         case LanParam::SubnetMask:
         {
-            auto ifaddr = channelCall<getIfAddr4>(channel);
+            const auto& ifaddr = getLanConfig(channel).ifaddr4;
             uint8_t prefix = AddrFamily<AF_INET>::defaultPrefix;
             if (ifaddr)
             {
@@ -1339,16 +1615,14 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
         }
         case LanParam::Gateway1:
         {
-            auto gateway =
-                channelCall<getGatewayProperty<AF_INET>>(channel).value_or(
-                    in_addr{});
+            auto gateway = getLanConfig(channel).gateway4.value_or(in_addr{});
             ret.pack(dataRef(gateway));
             return responseSuccess(std::move(ret));
         }
         case LanParam::Gateway1MAC:
         {
             ether_addr mac{};
-            auto neighbor = channelCall<getGatewayNeighbor<AF_INET>>(channel);
+            const auto& neighbor = getLanConfig(channel).neighbor4;
             if (neighbor)
             {
                 mac = neighbor->mac;
@@ -1358,7 +1632,7 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
         }
         case LanParam::VLANId:
         {
-            uint16_t vlan = channelCall<getVLANProperty>(channel);
+            uint16_t vlan = getLanConfig(channel).vlan;
             if (vlan != 0)
             {
                 vlan |= VLAN_ENABLE_FLAG;
@@ -1428,7 +1702,7 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
             {
                 return responseParmOutOfRange();
             }
-            getLanIPv6Address(ret, channel, set, originsV6Static);
+            getLanIPv6Address(ret, set, getLanConfig(channel).ifaddrs6Static);
             return responseSuccess(std::move(ret));
         }
         case LanParam::IPv6DynamicAddresses:
@@ -1437,14 +1711,14 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
             {
                 return responseParmOutOfRange();
             }
-            getLanIPv6Address(ret, channel, set, originsV6Dynamic);
+            getLanIPv6Address(ret, set, getLanConfig(channel).ifaddrs6Dynamic);
             return responseSuccess(std::move(ret));
         }
         case LanParam::IPv6RouterControl:
         {
             std::bitset<8> control;
             control[IPv6RouterControlFlag::Dynamic] =
-                channelCall<getIPv6AcceptRA>(channel);
+                getLanConfig(channel).ipv6AcceptRA;
             control[IPv6RouterControlFlag::Static] = 1;
             ret.pack(control);
             return responseSuccess(std::move(ret));
@@ -1452,14 +1726,11 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
         case LanParam::IPv6StaticRouter1IP:
         {
             in6_addr gateway{};
-            EthernetInterface::DHCPConf dhcp =
-                channelCall<getDHCPProperty>(channel);
-            if ((dhcp == EthernetInterface::DHCPConf::v4) ||
-                (dhcp == EthernetInterface::DHCPConf::none))
+            const LanConfig& lan = getLanConfig(channel);
+            if ((lan.dhcp == EthernetInterface::DHCPConf::v4) ||
+                (lan.dhcp == EthernetInterface::DHCPConf::none))
             {
-                gateway =
-                    channelCall<getGatewayProperty<AF_INET6>>(channel).value_or(
-                        in6_addr{});
+                gateway = lan.gateway6.value_or(in6_addr{});
             }
             ret.pack(dataRef(gateway));
             return responseSuccess(std::move(ret));
@@ -1467,7 +1738,7 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
         case LanParam::IPv6StaticRouter1MAC:
         {
             ether_addr mac{};
-            auto neighbor = channelCall<getGatewayNeighbor<AF_INET6>>(channel);
+            const auto& neighbor = getLanConfig(channel).neighbor6;
             if (neighbor)
             {
                 mac = neighbor->mac;
@@ -1513,6 +1784,126 @@ RspType<message::Payload> getLan(Context::ptr ctx, uint4_t channelBits,
 
     return response(ccParamNotSupported);
 }
+
+/** @brief Packs an IPv6 address entry of the Get LAN Configuration snapshot
+ *
+ *  @param[out] ret    - The IPMI response payload to be packed
+ *  @param[in]  set    - The set selector of the address
+ *  @param[in]  ifaddr - The address
+ */
+static void packIPv6Address(message::Payload& ret, uint8_t set,
+                            const IfAddr<AF_INET6>& ifaddr)
+{
+    ret.pack(set);
+    ret.pack(types::enum_cast<uint4_t>(originToSourceType(ifaddr.origin)),
+             uint3_t{}, true);
+    ret.pack(dataRef(ifaddr.address));
+    ret.pack(ifaddr.prefix);
+    ret.pack(types::enum_cast<uint8_t>(IPv6AddressStatus::Active));
+}
+
+/** @brief Implements the Get LAN Configuration snapshot OEM command, which
+ *         returns the whole LAN configuration of a channel in one response
+ *
+ *  @param[in] ctx         - context of the request
+ *  @param[in] channelBits - channel number
+ *  @param[in] reserved    - reserved bits
+ *
+ *  @return IPMI completion code and the LAN configuration
+ */
+RspType<message::Payload> getLanSnapshot(Context::ptr ctx, uint4_t channelBits,
+                                         uint4_t reserved)
+{
+    const uint8_t channel = convertCurrentChannelNum(
+        static_cast<uint8_t>(channelBits), ctx->channel);
+    if (reserved || !isValidChannel(channel))
+    {
+        log<level::ERR>("Get Lan Snapshot - Invalid field in request");
+        return responseInvalidFieldRequest();
+    }
+
+    const LanConfig& lan = getLanConfig(channel);
+    message::Payload ret;
+
+    in_addr addr{};
+    uint8_t prefix = AddrFamily<AF_INET>::defaultPrefix;
+    if (lan.ifaddr4)
+    {
+        addr = lan.ifaddr4->address;
+        prefix = lan.ifaddr4->prefix;
+    }
+    ret.pack(dataRef(addr));
+
+    auto src = IPSrc::Static;
+    if ((lan.dhcp == EthernetInterface::DHCPConf::v4) ||
+        (lan.dhcp == EthernetInterface::DHCPConf::both))
+    {
+        src = IPSrc::DHCP;
+    }
+    ret.pack(types::enum_cast<uint4_t>(src), uint4_t{});
+    ret.pack(dataRef(lan.mac));
+    ret.pack(dataRef(prefixToNetmask(prefix)));
+    ret.pack(dataRef(lan.gateway4.value_or(in_addr{})));
+    ether_addr mac4{};
+    if (lan.neighbor4)
+    {
+        mac4 = lan.neighbor4->mac;
+    }
+    ret.pack(dataRef(mac4));
+
+    uint16_t vlan = lan.vlan;
+    if (vlan != 0)
+    {
+        vlan |= VLAN_ENABLE_FLAG;
+    }
+    else
+    {
+        vlan = lastDisabledVlan[channel];
+    }
+    ret.pack(vlan);
+
+    std::bitset<8> control;
+    control[IPv6RouterControlFlag::Dynamic] = lan.ipv6AcceptRA;
+    control[IPv6RouterControlFlag::Static] = 1;
+    ret.pack(control);
+    in6_addr gateway6{};
+    if ((lan.dhcp == EthernetInterface::DHCPConf::v4) ||
+        (lan.dhcp == EthernetInterface::DHCPConf::none))
+    {
+        gateway6 = lan.gateway6.value_or(in6_addr{});
+    }
+    ret.pack(dataRef(gateway6));
+    ether_addr mac6{};
+    if (lan.neighbor6)
+    {
+        mac6 = lan.neighbor6->mac;
+    }
+    ret.pack(dataRef(mac6));
+
+    // As many IPv6 addresses as fit in the response, static ones first
+    constexpr size_t responseOverhead = 1 + 52;
+    constexpr size_t ipv6EntrySize = 20;
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxEntries = 0;
+    if (maxTransfer > responseOverhead)
+    {
+        maxEntries = (maxTransfer - responseOverhead) / ipv6EntrySize;
+    }
+    uint8_t staticCount = std::min(lan.ifaddrs6Static.size(), maxEntries);
+    uint8_t dynamicCount =
+        std::min(lan.ifaddrs6Dynamic.size(), maxEntries - staticCount);
+    ret.pack(staticCount, dynamicCount);
+    for (uint8_t i = 0; i < staticCount; i++)
+    {
+        packIPv6Address(ret, i, lan.ifaddrs6Static[i]);
+    }
+    for (uint8_t i = 0; i < dynamicCount; i++)
+    {
+        packIPv6Address(ret, i, lan.ifaddrs6Dynamic[i]);
+    }
+
+    return responseSuccess(std::move(ret));
+}
 #if 0
 RspType<message::Payload> getSol(uint4_t channelBits, uint3_t, bool revOnly,
                                  uint8_t parameter, uint8_t set, uint8_t block)
@@ -1593,56 +1984,55 @@ RspType<message::Payload> getSol(uint4_t channelBits, uint3_t, bool revOnly,
 constexpr const char* solInterface = "xyz.openbmc_project.Ipmi.SOL";
 constexpr const char* solPath = "/xyz/openbmc_project/ipmi/sol/";
 
+// The SOL and console objects are read from the D-Bus cache: the first read
+// takes all the properties of the object at once and PropertiesChanged
+// keeps them current, so a console querying every parameter on connect makes
+// no D-Bus call. Services are kept until they leave the bus.
+static const ipmi::DbusCache solCache{{}, true};
+
 void register_netfn_transport_functions() __attribute__((constructor));
 
-static std::string
-    getSOLService(std::shared_ptr<sdbusplus::asio::connection> dbus,
-                  const std::string& solPathWitheEthName)
+/** @brief the SOL object of a channel and its service, false when the
+ *         service is not found
+ */
+static bool getSOLObject(const uint8_t& channelNum, std::string& path,
+                         std::string& service)
 {
-    static std::string solService{};
-    if (solService.empty())
+    path = std::string(solPath) + ipmi::getChannelName(channelNum);
+    try
     {
-        try
-        {
-            solService =
-                ipmi::getService(*dbus, solInterface, solPathWitheEthName);
-        }
-        catch (const sdbusplus::exception::SdBusError& e)
-        {
-            solService.clear();
-            phosphor::logging::log<phosphor::logging::level::ERR>(
-                "Error: get SOL service failed");
-            return solService;
-        }
+        service = ipmi::getService(*getSdBus(), solInterface, path, solCache);
     }
-    return solService;
+    catch (const std::exception& e)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "Error: get SOL service failed",
+            phosphor::logging::entry("PATH=%s", path.c_str()));
+        return false;
+    }
+    return true;
 }
 
-static int setSOLParameter(const std::string& property,
+static int setSOLParameter(ipmi::Context::ptr ctx, const std::string& property,
                            const ipmi::Value& value, const uint8_t& channelNum)
 {
-    auto dbus = getSdBus();
-
-    std::string ethdevice = ipmi::getChannelName(channelNum);
-
-    std::string solPathWitheEthName = std::string(solPath) + ethdevice;
-
-    std::string service = getSOLService(dbus, solPathWitheEthName);
-    if (service.empty())
+    std::string solPathWitheEthName;
+    std::string service;
+    if (!getSOLObject(channelNum, solPathWitheEthName, service))
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Unable to get SOL service failed");
         return -1;
     }
-    try
-    {
-        ipmi::setDbusProperty(*dbus, service, solPathWitheEthName, solInterface,
-                              property, value);
-    }
-    catch (sdbusplus::exception_t&)
+
+    // yields until the SOL service answered, the cached properties are
+    // dropped once it did
+    boost::system::error_code ec = ipmi::setDbusProperty(
+        ctx, service, solPathWitheEthName, solInterface, property, value);
+    if (ec)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Error setting sol parameter");
+            "Error setting sol parameter",
+            phosphor::logging::entry("PROPERTY=%s", property.c_str()),
+            phosphor::logging::entry("ERROR=%s", ec.message().c_str()));
         return -1;
     }
 
@@ -1652,25 +2042,18 @@ static int setSOLParameter(const std::string& property,
 static int getSOLParameter(const std::string& property, ipmi::Value& value,
                            const uint8_t& channelNum)
 {
-    auto dbus = getSdBus();
-
-    std::string ethdevice = ipmi::getChannelName(channelNum);
-
-    std::string solPathWitheEthName = std::string(solPath) + ethdevice;
-
-    std::string service = getSOLService(dbus, solPathWitheEthName);
-    if (service.empty())
+    std::string solPathWitheEthName;
+    std::string service;
+    if (!getSOLObject(channelNum, solPathWitheEthName, service))
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Unable to get SOL service failed");
         return -1;
     }
     try
     {
-        value = ipmi::getDbusProperty(*dbus, service, solPathWitheEthName,
-                                      solInterface, property);
+        value = ipmi::getDbusProperty(*getSdBus(), service, solPathWitheEthName,
+                                      solInterface, property, solCache);
     }
-    catch (sdbusplus::exception_t&)
+    catch (const std::exception&)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "Error getting sol parameter");
@@ -1684,15 +2067,13 @@ constexpr const char* consoleInterface = "xyz.openbmc_project.console";
 constexpr const char* consolePath = "/xyz/openbmc_project/console";
 static int getSOLBaudRate(ipmi::Value& value)
 {
-    auto dbus = getSdBus();
-
     try
     {
-        value =
-            ipmi::getDbusProperty(*dbus, "xyz.openbmc_project.console",
-                                  consolePath, consoleInterface, "baudrate");
+        value = ipmi::getDbusProperty(
+            *getSdBus(), "xyz.openbmc_project.console", consolePath,
+            consoleInterface, "baudrate", solCache);
     }
-    catch (sdbusplus::exception_t&)
+    catch (const std::exception&)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "Error getting sol baud rate");
@@ -1803,7 +2184,7 @@ ipmi::RspType<> setSOLConfParams(ipmi::Context::ptr ctx, uint4_t chNum,
                 return ipmi::responseSetInProgressActive();
             }
 
-            if (setSOLParameter("Progress", progress, channelNum) < 0)
+            if (setSOLParameter(ctx, "Progress", progress, channelNum) < 0)
             {
                 return ipmi::responseUnspecifiedError();
             }
@@ -1816,7 +2197,7 @@ ipmi::RspType<> setSOLConfParams(ipmi::Context::ptr ctx, uint4_t chNum,
                 return ipmi::responseReqDataLenInvalid();
             }
             bool enable = configParamData1 & enableMask;
-            if (setSOLParameter("Enable", enable, channelNum) < 0)
+            if (setSOLParameter(ctx, "Enable", enable, channelNum) < 0)
             {
                 return ipmi::responseUnspecifiedError();
             }
@@ -1845,7 +2226,7 @@ ipmi::RspType<> setSOLConfParams(ipmi::Context::ptr ctx, uint4_t chNum,
                 return ipmi::responseInvalidFieldRequest();
             }
 
-            if (setSOLParameter("Privilege", privilege, channelNum) < 0)
+            if (setSOLParameter(ctx, "Privilege", privilege, channelNum) < 0)
             {
                 return ipmi::responseUnspecifiedError();
             }
@@ -1862,12 +2243,13 @@ ipmi::RspType<> setSOLConfParams(ipmi::Context::ptr ctx, uint4_t chNum,
             {
                 return ipmi::responseInvalidFieldRequest();
             }
-            if (setSOLParameter("AccumulateIntervalMS", configParamData1,
+            if (setSOLParameter(ctx, "AccumulateIntervalMS", configParamData1,
                                 channelNum) < 0)
             {
                 return ipmi::responseUnspecifiedError();
             }
-            if (setSOLParameter("Threshold", *configParamData2, channelNum) < 0)
+            if (setSOLParameter(ctx, "Threshold", *configParamData2,
+                                channelNum) < 0)
             {
                 return ipmi::responseUnspecifiedError();
             }
@@ -1880,10 +2262,10 @@ ipmi::RspType<> setSOLConfParams(ipmi::Context::ptr ctx, uint4_t chNum,
                 return ipmi::responseReqDataLenInvalid();
             }
             if ((setSOLParameter(
-                     "RetryCount",
+                     ctx, "RetryCount",
                      static_cast<uint8_t>(configParamData1 & retryMask),
                      channelNum) < 0) ||
-                (setSOLParameter("RetryIntervalMS", *configParamData2,
+                (setSOLParameter(ctx, "RetryIntervalMS", *configParamData2,
                                  channelNum) < 0))
             {
                 return ipmi::responseUnspecifiedError();
@@ -2079,6 +2461,9 @@ void register_netfn_transport_functions()
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnTransport,
                           ipmi::transport::cmdGetLanConfigParameters,
                           ipmi::Privilege::Admin, ipmi::transport::getLan);
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getLanSnapshotCmd, ipmi::Privilege::Admin,
+                             ipmi::transport::getLanSnapshot);
 
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnTransport,
                           ipmi::transport::cmdSetSolConfigParameters,
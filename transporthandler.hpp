@@ -6,17 +6,25 @@
 #include <arpa/inet.h>
 #include <netinet/ether.h>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <boost/asio/steady_timer.hpp>
 #include <cinttypes>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <chrono>
 #include <functional>
+#include <map>
+#include <memory>
 #include <ipmid/api-types.hpp>
 #include <ipmid/api.hpp>
+#include <ipmid/dbus-signals.hpp>
+#include <ipmid/mapper.hpp>
 #include <ipmid/message.hpp>
 #include <ipmid/message/types.hpp>
+#include <ipmid/oemopenbmc.hpp>
 #include <ipmid/types.hpp>
 #include <ipmid/utils.hpp>
 #include <optional>
@@ -24,6 +32,7 @@
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/exception.hpp>
 #include <string>
 #include <string_view>
@@ -223,6 +232,9 @@ std::string_view dataRef(const T& t)
  *         is accurate. Otherwise it gets the standard ethernet interface.
  *
  *  @param[in] bus     - The bus object used for lookups
+ *         The result is cached until the network daemon adds or removes
+ *         objects.
+ *
  *  @param[in] channel - The channel id corresponding to an ethernet interface
  *  @return Ethernet interface service and object path if it exists
  */
@@ -468,16 +480,17 @@ ether_addr stringToMAC(const char* mac);
  *  @param[in] params  - The parameters for the channel
  *  @param[in] idx     - The index of the desired address on the interface
  *  @param[in] origins - The allowed origins for the address objects
- *  @param[in] ips     - The object lookup cache holding all of the address info
+ *  @param[in] ips     - The object lookup cache holding all of the address
+ *                       info, or any other map of object path to properties
  *  @return The address and prefix if it was found
  */
-template <int family>
+template <int family, typename Objects>
 std::optional<IfAddr<family>> findIfAddr(
     sdbusplus::bus::bus& bus, const ChannelParams& params, uint8_t idx,
     const std::unordered_set<
         sdbusplus::xyz::openbmc_project::Network::server::IP::AddressOrigin>&
         origins,
-    ObjectLookupCache& ips)
+    Objects& ips)
 {
     for (const auto& [path, properties] : ips)
     {
@@ -513,6 +526,54 @@ std::optional<IfAddr<family>> findIfAddr(
 
     return std::nullopt;
 }
+
+/** @brief Collects the addresses matching the input parameters in a single
+ *         pass over the ip objects, in the order findIfAddr indexes them
+ *
+ *  @param[in] origins - The allowed origins for the address objects
+ *  @param[in] ips     - Any map of object path to address properties
+ *  @param[in] max     - The most addresses to collect
+ *  @return The addresses, the one of index idx at position idx
+ */
+template <int family, typename Objects>
+std::vector<IfAddr<family>> findIfAddrs(
+    const std::unordered_set<
+        sdbusplus::xyz::openbmc_project::Network::server::IP::AddressOrigin>&
+        origins,
+    const Objects& ips, size_t max)
+{
+    std::vector<IfAddr<family>> ifaddrs;
+    for (const auto& [path, properties] : ips)
+    {
+        if (ifaddrs.size() == max)
+        {
+            break;
+        }
+        const auto& addrStr = std::get<std::string>(properties.at("Address"));
+        auto addr = maybeStringToAddr<family>(addrStr.c_str());
+        if (!addr)
+        {
+            continue;
+        }
+
+        sdbusplus::xyz::openbmc_project::Network::server::IP::AddressOrigin
+            origin = sdbusplus::xyz::openbmc_project::Network::server::IP::
+                convertAddressOriginFromString(
+                    std::get<std::string>(properties.at("Origin")));
+        if (origins.find(origin) == origins.end())
+        {
+            continue;
+        }
+
+        IfAddr<family>& ifaddr = ifaddrs.emplace_back();
+        ifaddr.path = path;
+        ifaddr.address = *addr;
+        ifaddr.prefix = std::get<uint8_t>(properties.at("PrefixLength"));
+        ifaddr.origin = origin;
+    }
+    return ifaddrs;
+}
+
 /** @brief Trivial helper around findIfAddr that simplifies calls
  *         for one off lookups. Don't use this if you intend to do multiple
  *         lookups at a time.
@@ -588,11 +649,11 @@ std::optional<typename AddrFamily<family>::addr>
     return stringToAddr<family>(gatewayStr.c_str());
 }
 
-template <int family>
+template <int family, typename Objects>
 std::optional<IfNeigh<family>>
     findStaticNeighbor(sdbusplus::bus::bus& bus, const ChannelParams& params,
                        const typename AddrFamily<family>::addr& ip,
-                       ObjectLookupCache& neighbors)
+                       Objects& neighbors)
 {
     using sdbusplus::xyz::openbmc_project::Network::server::Neighbor;
     const auto state =
@@ -17,6 +17,7 @@
 #include "channel_mgmt.hpp"
 
 #include "apphandler.hpp"
+#include "record_store.hpp"
 #include "user_layer.hpp"
 
 #include <ifaddrs.h>
@@ -30,6 +31,7 @@
 #include <exception>
 #include <experimental/filesystem>
 #include <fstream>
+#include <memory>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/server/object.hpp>
@@ -48,6 +50,49 @@ static constexpr const char* channelNvDataFilename =
     "/var/lib/ipmi/channel_access_nv.json";
 static constexpr const char* channelVolatileDataFilename =
     "/run/ipmi/channel_access_volatile.json";
+static constexpr const char* channelNvStoreFilename =
+    "/var/lib/ipmi/channel_access_nv.bin";
+static constexpr const char* channelVolatileStoreFilename =
+    "/run/ipmi/channel_access_volatile.bin";
+static constexpr uint32_t channelStoreMagic = 0x41484349; // "ICHA"
+static constexpr uint16_t channelStoreVersion = 1;
+
+/** @struct ChannelAccessRecord
+ *
+ *  Fixed layout of the access data of a channel in the binary channel access
+ *  stores
+ */
+struct ChannelAccessRecord
+{
+    uint8_t accessMode;
+    uint8_t flags;
+    uint8_t privLimit;
+} __attribute__((packed));
+
+// ChannelAccessRecord flags
+static constexpr uint8_t userAuthDisabledFlag = 1 << 0;
+static constexpr uint8_t perMsgAuthDisabledFlag = 1 << 1;
+static constexpr uint8_t alertingDisabledFlag = 1 << 2;
+
+static void toChannelAccessRecord(const ChannelAccess& access,
+                                  ChannelAccessRecord& record)
+{
+    record.accessMode = access.accessMode;
+    record.flags = (access.userAuthDisabled ? userAuthDisabledFlag : 0) |
+                   (access.perMsgAuthDisabled ? perMsgAuthDisabledFlag : 0) |
+                   (access.alertingDisabled ? alertingDisabledFlag : 0);
+    record.privLimit = access.privLimit;
+}
+
+static void fromChannelAccessRecord(const ChannelAccessRecord& record,
+                                    ChannelAccess& access)
+{
+    access.accessMode = record.accessMode;
+    access.userAuthDisabled = record.flags & userAuthDisabledFlag;
+    access.perMsgAuthDisabled = record.flags & perMsgAuthDisabledFlag;
+    access.alertingDisabled = record.flags & alertingDisabledFlag;
+    access.privLimit = record.privLimit;
+}
 
 // TODO: Get the service name dynamically..
 static constexpr const char* networkIntfServiceName =
@@ -380,7 +425,14 @@ ChannelConfig::~ChannelConfig()
     }
 }
 
-ChannelConfig::ChannelConfig() : bus(ipmid_get_sd_bus_connection())
+ChannelConfig::ChannelConfig() :
+    nvStore(std::make_unique<RecordStore>(
+        channelNvStoreFilename, channelStoreMagic, channelStoreVersion,
+        sizeof(ChannelAccessRecord), maxIpmiChannels)),
+    volatileStore(std::make_unique<RecordStore>(
+        channelVolatileStoreFilename, channelStoreMagic, channelStoreVersion,
+        sizeof(ChannelAccessRecord), maxIpmiChannels)),
+    bus(ipmid_get_sd_bus_connection())
 {
     std::ofstream mutexCleanUpFile;
     mutexCleanUpFile.open(ipmiChMutexCleanupLockFile,
@@ -497,42 +549,36 @@ size_t ChannelConfig::getChannelMaxTransferSize(uint8_t chNum)
 
 Cc ChannelConfig::getChannelInfo(const uint8_t chNum, ChannelInfo& chInfo)
 {
-    if (!isValidChannel(chNum))
+    // the channel info doesn't depend on the access data, any table will do
+    auto snapshot = std::atomic_load(&accessSnapshot);
+    if (!snapshot)
+    {
+        snapshot = getAccessSnapshot();
+        if (!snapshot)
+        {
+            return ccUnspecifiedError;
+        }
+    }
+    if (chNum >= maxIpmiChannels || !snapshot->isChValid[chNum])
     {
         log<level::DEBUG>("Invalid channel");
         return ccInvalidFieldRequest;
     }
 
-    std::copy_n(reinterpret_cast<uint8_t*>(&channelData[chNum].chInfo),
-                sizeof(channelData[chNum].chInfo),
-                reinterpret_cast<uint8_t*>(&chInfo));
+    chInfo = snapshot->chInfo[chNum];
     return ccSuccess;
 }
 
 Cc ChannelConfig::getChannelAccessData(const uint8_t chNum,
                                        ChannelAccess& chAccessData)
 {
-    if (!isValidChannel(chNum))
-    {
-        log<level::DEBUG>("Invalid channel");
-        return ccInvalidFieldRequest;
-    }
-
-    if (getChannelSessionSupport(chNum) == EChannelSessSupported::none)
-    {
-        log<level::DEBUG>("Session-less channel doesn't have access data.");
-        return ccActionNotSupportedForChannel;
-    }
-
-    if (checkAndReloadVolatileData() != 0)
+    std::shared_ptr<const ChannelAccessSnapshot> snapshot;
+    Cc cc = getAccessSnapshot(chNum, snapshot);
+    if (cc != ccSuccess)
     {
-        return ccUnspecifiedError;
+        return cc;
     }
-
-    std::copy_n(
-        reinterpret_cast<uint8_t*>(&channelData[chNum].chAccess.chVolatileData),
-        sizeof(channelData[chNum].chAccess.chVolatileData),
-        reinterpret_cast<uint8_t*>(&chAccessData));
+    chAccessData = snapshot->chAccess[chNum].chVolatileData;
 
     return ccSuccess;
 }
@@ -611,27 +657,13 @@ Cc ChannelConfig::setChannelAccessData(const uint8_t chNum,
 Cc ChannelConfig::getChannelAccessPersistData(const uint8_t chNum,
                                               ChannelAccess& chAccessData)
 {
-    if (!isValidChannel(chNum))
+    std::shared_ptr<const ChannelAccessSnapshot> snapshot;
+    Cc cc = getAccessSnapshot(chNum, snapshot);
+    if (cc != ccSuccess)
     {
-        log<level::DEBUG>("Invalid channel");
-        return ccInvalidFieldRequest;
+        return cc;
     }
-
-    if (getChannelSessionSupport(chNum) == EChannelSessSupported::none)
-    {
-        log<level::DEBUG>("Session-less channel doesn't have access data.");
-        return ccActionNotSupportedForChannel;
-    }
-
-    if (checkAndReloadNVData() != 0)
-    {
-        return ccUnspecifiedError;
-    }
-
-    std::copy_n(reinterpret_cast<uint8_t*>(
-                    &channelData[chNum].chAccess.chNonVolatileData),
-                sizeof(channelData[chNum].chAccess.chNonVolatileData),
-                reinterpret_cast<uint8_t*>(&chAccessData));
+    chAccessData = snapshot->chAccess[chNum].chNonVolatileData;
 
     return ccSuccess;
 }
@@ -1102,7 +1134,7 @@ int ChannelConfig::loadChannelConfig()
     return 0;
 }
 
-int ChannelConfig::readChannelVolatileData()
+int ChannelConfig::importChannelVolatileData()
 {
     boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
         channelLock{*channelMutex};
@@ -1170,7 +1202,7 @@ int ChannelConfig::readChannelVolatileData()
     return 0;
 }
 
-int ChannelConfig::readChannelPersistData()
+int ChannelConfig::importChannelPersistData()
 {
     boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
         channelLock{*channelMutex};
@@ -1237,7 +1269,7 @@ int ChannelConfig::readChannelPersistData()
     return 0;
 }
 
-int ChannelConfig::writeChannelVolatileData()
+int ChannelConfig::exportChannelVolatileData()
 {
     boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
         channelLock{*channelMutex};
@@ -1286,7 +1318,7 @@ int ChannelConfig::writeChannelVolatileData()
     return 0;
 }
 
-int ChannelConfig::writeChannelPersistData()
+int ChannelConfig::exportChannelPersistData()
 {
     boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
         channelLock{*channelMutex};
@@ -1337,11 +1369,272 @@ int ChannelConfig::writeChannelPersistData()
     return 0;
 }
 
+bool ChannelConfig::createChannelAccessStore(
+    RecordStore& store, ChannelAccess ChannelAccessData::*access,
+    uint32_t& generation)
+{
+    std::array<ChannelAccessRecord, maxIpmiChannels> records;
+    for (uint8_t chNum = 0; chNum < maxIpmiChannels; chNum++)
+    {
+        toChannelAccessRecord(channelData[chNum].chAccess.*access,
+                              records[chNum]);
+    }
+    if (!store.create(records.data()))
+    {
+        return false;
+    }
+    generation = store.generation();
+    return true;
+}
+
+void ChannelConfig::loadChannelAccessStore(
+    const RecordStore& store, ChannelAccess ChannelAccessData::*access,
+    uint32_t& generation)
+{
+    // like the JSON files, only channels supporting sessions are stored
+    for (uint8_t chNum = 0; chNum < maxIpmiChannels; chNum++)
+    {
+        if (getChannelSessionSupport(chNum) != EChannelSessSupported::none)
+        {
+            auto record = reinterpret_cast<const ChannelAccessRecord*>(
+                store.record(chNum));
+            fromChannelAccessRecord(*record,
+                                    channelData[chNum].chAccess.*access);
+        }
+    }
+    generation = store.generation();
+}
+
+int ChannelConfig::updateChannelAccessStore(
+    RecordStore& store, ChannelAccess ChannelAccessData::*access,
+    uint32_t& generation)
+{
+    for (uint8_t chNum = 0; chNum < maxIpmiChannels; chNum++)
+    {
+        if (getChannelSessionSupport(chNum) != EChannelSessSupported::none)
+        {
+            ChannelAccessRecord record;
+            toChannelAccessRecord(channelData[chNum].chAccess.*access, record);
+            if (store.writeRecord(chNum, &record) != 0)
+            {
+                return -EIO;
+            }
+        }
+    }
+    generation = store.generation();
+    return 0;
+}
+
+bool ChannelConfig::channelAccessStoreChanged(RecordStore& store,
+                                              uint32_t generation)
+{
+    if (store.replaced())
+    {
+        store.close();
+        return true;
+    }
+    return store.generation() != generation;
+}
+
+int ChannelConfig::readChannelVolatileData()
+{
+    boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
+        channelLock{*channelMutex};
+
+    if (volatileStore->isOpen() || volatileStore->open())
+    {
+        loadChannelAccessStore(*volatileStore,
+                               &ChannelAccessData::chVolatileData,
+                               volatileStoreGeneration);
+        publishAccessSnapshot();
+        return 0;
+    }
+
+    // no binary store yet, import the JSON data file into a new one
+    int ret = importChannelVolatileData();
+    if (ret == 0)
+    {
+        createChannelAccessStore(*volatileStore,
+                                 &ChannelAccessData::chVolatileData,
+                                 volatileStoreGeneration);
+        publishAccessSnapshot();
+    }
+    return ret;
+}
+
+int ChannelConfig::readChannelPersistData()
+{
+    boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
+        channelLock{*channelMutex};
+
+    if (nvStore->isOpen() || nvStore->open())
+    {
+        loadChannelAccessStore(*nvStore, &ChannelAccessData::chNonVolatileData,
+                               nvStoreGeneration);
+        publishAccessSnapshot();
+        return 0;
+    }
+
+    // no binary store yet, import the JSON data file into a new one
+    int ret = importChannelPersistData();
+    if (ret == 0)
+    {
+        createChannelAccessStore(*nvStore,
+                                 &ChannelAccessData::chNonVolatileData,
+                                 nvStoreGeneration);
+        publishAccessSnapshot();
+    }
+    return ret;
+}
+
+int ChannelConfig::writeChannelVolatileData()
+{
+    boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
+        channelLock{*channelMutex};
+
+    // never replace a store that another process may have mapped, the
+    // snapshot readers don't check for it
+    int ret;
+    if (volatileStore->isOpen() || volatileStore->open())
+    {
+        ret = updateChannelAccessStore(*volatileStore,
+                                       &ChannelAccessData::chVolatileData,
+                                       volatileStoreGeneration);
+    }
+    else if (createChannelAccessStore(*volatileStore,
+                                      &ChannelAccessData::chVolatileData,
+                                      volatileStoreGeneration))
+    {
+        ret = 0;
+    }
+    else
+    {
+        // no binary store, keep the data in the JSON file
+        ret = exportChannelVolatileData();
+    }
+    publishAccessSnapshot();
+    return ret;
+}
+
+int ChannelConfig::writeChannelPersistData()
+{
+    boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
+        channelLock{*channelMutex};
+
+    // never replace a store that another process may have mapped, the
+    // snapshot readers don't check for it
+    int ret;
+    if (nvStore->isOpen() || nvStore->open())
+    {
+        ret = updateChannelAccessStore(*nvStore,
+                                       &ChannelAccessData::chNonVolatileData,
+                                       nvStoreGeneration);
+    }
+    else if (createChannelAccessStore(*nvStore,
+                                      &ChannelAccessData::chNonVolatileData,
+                                      nvStoreGeneration))
+    {
+        ret = 0;
+    }
+    else
+    {
+        // no binary store, keep the data in the JSON file
+        ret = exportChannelPersistData();
+    }
+    publishAccessSnapshot();
+    return ret;
+}
+
+void ChannelConfig::publishAccessSnapshot()
+{
+    auto snapshot = std::make_shared<ChannelAccessSnapshot>();
+    for (uint8_t chNum = 0; chNum < maxIpmiChannels; chNum++)
+    {
+        snapshot->isChValid[chNum] = channelData[chNum].isChValid;
+        snapshot->chInfo[chNum] = channelData[chNum].chInfo;
+        snapshot->chAccess[chNum] = channelData[chNum].chAccess;
+    }
+    snapshot->nvGeneration = nvStoreGeneration;
+    snapshot->volatileGeneration = volatileStoreGeneration;
+    snapshot->nvMappedGeneration = nvStore->mappedGeneration();
+    snapshot->volatileMappedGeneration = volatileStore->mappedGeneration();
+    snapshot->rebuilds = ++accessSnapshotRebuilds;
+    // only a change of the channel access data builds a table, the count
+    // stays put while the get commands are served
+    log<level::INFO>("Channel table rebuilt",
+                     entry("REBUILDS=%llu", static_cast<unsigned long long>(
+                                                snapshot->rebuilds)));
+    std::atomic_store(&accessSnapshot,
+                      std::shared_ptr<const ChannelAccessSnapshot>(snapshot));
+}
+
+std::shared_ptr<const ChannelAccessSnapshot> ChannelConfig::getAccessSnapshot()
+{
+    auto snapshot = std::atomic_load(&accessSnapshot);
+    // writers bump the mapped store generations, so comparing them detects
+    // the updates made by any process; the snapshot holds the mappings, a
+    // reload closing the stores meanwhile doesn't unmap them
+    if (snapshot && snapshot->nvMappedGeneration &&
+        snapshot->volatileMappedGeneration &&
+        snapshot->nvGeneration == *snapshot->nvMappedGeneration &&
+        snapshot->volatileGeneration == *snapshot->volatileMappedGeneration)
+    {
+        return snapshot;
+    }
+
+    if (checkAndReloadVolatileData() != 0 || checkAndReloadNVData() != 0)
+    {
+        return nullptr;
+    }
+    snapshot = std::atomic_load(&accessSnapshot);
+    if (!snapshot)
+    {
+        boost::interprocess::scoped_lock<
+            boost::interprocess::named_recursive_mutex>
+            channelLock{*channelMutex};
+        publishAccessSnapshot();
+        snapshot = std::atomic_load(&accessSnapshot);
+    }
+    return snapshot;
+}
+
+Cc ChannelConfig::getAccessSnapshot(
+    const uint8_t chNum, std::shared_ptr<const ChannelAccessSnapshot>& snapshot)
+{
+    snapshot = getAccessSnapshot();
+    if (!snapshot)
+    {
+        return ccUnspecifiedError;
+    }
+    if (chNum >= maxIpmiChannels || !snapshot->isChValid[chNum])
+    {
+        log<level::DEBUG>("Invalid channel");
+        return ccInvalidFieldRequest;
+    }
+    if (static_cast<EChannelSessSupported>(
+            snapshot->chInfo[chNum].sessionSupported) ==
+        EChannelSessSupported::none)
+    {
+        log<level::DEBUG>("Session-less channel doesn't have access data.");
+        return ccActionNotSupportedForChannel;
+    }
+    return ccSuccess;
+}
+
 int ChannelConfig::checkAndReloadNVData()
 {
-    std::time_t updateTime = getUpdatedFileTime(channelNvDataFilename);
+    bool changed;
+    if (nvStore->isOpen())
+    {
+        changed = channelAccessStoreChanged(*nvStore, nvStoreGeneration);
+    }
+    else
+    {
+        std::time_t updateTime = getUpdatedFileTime(channelNvDataFilename);
+        changed = updateTime != nvFileLastUpdatedTime || updateTime == -EIO;
+    }
     int ret = 0;
-    if (updateTime != nvFileLastUpdatedTime || updateTime == -EIO)
+    if (changed)
     {
         try
         {
@@ -1359,9 +1652,20 @@ int ChannelConfig::checkAndReloadNVData()
 
 int ChannelConfig::checkAndReloadVolatileData()
 {
-    std::time_t updateTime = getUpdatedFileTime(channelVolatileDataFilename);
+    bool changed;
+    if (volatileStore->isOpen())
+    {
+        changed =
+            channelAccessStoreChanged(*volatileStore, volatileStoreGeneration);
+    }
+    else
+    {
+        std::time_t updateTime =
+            getUpdatedFileTime(channelVolatileDataFilename);
+        changed = updateTime != voltFileLastUpdatedTime || updateTime == -EIO;
+    }
     int ret = 0;
-    if (updateTime != voltFileLastUpdatedTime || updateTime == -EIO)
+    if (changed)
     {
         try
         {
@@ -1541,13 +1845,15 @@ void ChannelConfig::initChannelPersistData()
     // If not present, load the default values
     if (readChannelVolatileData() != 0)
     {
-        // Copy default volatile data to temporary location
-        // NV file(channelNvDataFilename) must have created by now.
-        std::experimental::filesystem::copy_file(channelNvDataFilename,
-                                                 channelVolatileDataFilename);
+        // Initialize the volatile data from the NV data loaded by now
+        for (auto& channel : channelData)
+        {
+            channel.chAccess.chVolatileData =
+                channel.chAccess.chNonVolatileData;
+        }
 
-        // Load the channel access volatile data
-        if (readChannelVolatileData() != 0)
+        // Store the channel access volatile data
+        if (writeChannelVolatileData() != 0)
         {
             log<level::ERR>("Failed to read channel access volatile data");
             throw std::ios_base::failure(
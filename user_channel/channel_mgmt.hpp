@@ -22,6 +22,7 @@
 #include <boost/interprocess/sync/named_recursive_mutex.hpp>
 #include <cstdint>
 #include <ctime>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <sdbusplus/bus.hpp>
 #include <variant>
@@ -29,6 +30,8 @@
 namespace ipmi
 {
 
+class RecordStore;
+
 using Json = nlohmann::json;
 
 using DbusVariant = std::variant<std::vector<std::string>, std::string, bool>;
@@ -67,6 +70,28 @@ struct ChannelProperties
     bool isManagementNIC;
 };
 
+/** @struct ChannelAccessSnapshot
+ *
+ *  Immutable table of all the channels: whether they are valid and their
+ *  channel info, which only the channel config sets, and their access data,
+ *  along with the generations of the channel access stores it was built
+ *  from.
+ */
+struct ChannelAccessSnapshot
+{
+    std::array<bool, maxIpmiChannels> isChValid;
+    std::array<ChannelInfo, maxIpmiChannels> chInfo;
+    std::array<ChannelAccessData, maxIpmiChannels> chAccess;
+    uint32_t nvGeneration;
+    uint32_t volatileGeneration;
+    // the generations in the mappings of the stores, compared with those
+    // above without the channel mutex
+    std::shared_ptr<const uint32_t> nvMappedGeneration;
+    std::shared_ptr<const uint32_t> volatileMappedGeneration;
+    // tables built by this process, this one included
+    uint64_t rebuilds;
+};
+
 class ChannelConfig;
 
 ChannelConfig& getChannelConfigObject();
@@ -224,13 +249,15 @@ class ChannelConfig
      */
     CommandPrivilege convertToPrivLimitIndex(const std::string& value);
 
-    /** @brief function to write persistent channel configuration to config file
+    /** @brief function to write persistent channel configuration to the
+     * binary channel access store, only the channels that changed are written
      *
      *  @return 0 for success, -errno for failure.
      */
     int writeChannelPersistData();
 
-    /** @brief function to write volatile channel configuration to config file
+    /** @brief function to write volatile channel configuration to the binary
+     * channel access store, only the channels that changed are written
      *
      *  @return 0 for success, -errno for failure.
      */
@@ -251,6 +278,13 @@ class ChannelConfig
     std::array<ChannelProperties, maxIpmiChannels> channelData;
     std::time_t nvFileLastUpdatedTime;
     std::time_t voltFileLastUpdatedTime;
+    std::unique_ptr<RecordStore> nvStore;
+    std::unique_ptr<RecordStore> volatileStore;
+    uint32_t nvStoreGeneration = 0;
+    uint32_t volatileStoreGeneration = 0;
+    // published by the updates, read without locking by the get functions
+    std::shared_ptr<const ChannelAccessSnapshot> accessSnapshot;
+    uint64_t accessSnapshotRebuilds = 0;
     boost::interprocess::file_lock mutexCleanupLock;
     sdbusplus::bus::bus bus;
     bool signalHndlrObjectState = false;
@@ -261,6 +295,36 @@ class ChannelConfig
      */
     void initChannelPersistData();
 
+    /** @brief function to publish the current channel access data as a new
+     * snapshot
+     *
+     */
+    void publishAccessSnapshot();
+
+    /** @brief function to get the current channel access data
+     *
+     *  @details The snapshot is returned as is while the generations of the
+     *  mapped channel access stores match it, which needs neither a file
+     *  access nor the channel mutex. Otherwise the updated data is loaded
+     *  and published first.
+     *
+     *  @return the snapshot, nullptr if the data can't be loaded
+     */
+    std::shared_ptr<const ChannelAccessSnapshot> getAccessSnapshot();
+
+    /** @brief function to get the current snapshot for the access data of a
+     * channel
+     *
+     *  @param[in] chNum - channel number
+     *  @param[out] snapshot - the current snapshot
+     *
+     *  @return ccSuccess, or the completion code of an invalid or a
+     *  session-less channel
+     */
+    Cc getAccessSnapshot(
+        const uint8_t chNum,
+        std::shared_ptr<const ChannelAccessSnapshot>& snapshot);
+
     /** @brief function to set default channel configuration based on channel
      * number
      *
@@ -276,18 +340,89 @@ class ChannelConfig
      */
     int loadChannelConfig();
 
-    /** @brief function to read persistent channel data
+    /** @brief function to read persistent channel data, importing the JSON
+     * data file if there is no binary store yet
      *
      *  @return 0 for success, -errno for failure.
      */
     int readChannelPersistData();
 
-    /** @brief function to read volatile channel data
+    /** @brief function to read volatile channel data, importing the JSON
+     * data file if there is no binary store yet
      *
      *  @return 0 for success, -errno for failure.
      */
     int readChannelVolatileData();
 
+    /** @brief function to read persistent channel data from JSON data file
+     *
+     *  @return 0 for success, -errno for failure.
+     */
+    int importChannelPersistData();
+
+    /** @brief function to read volatile channel data from JSON data file
+     *
+     *  @return 0 for success, -errno for failure.
+     */
+    int importChannelVolatileData();
+
+    /** @brief function to write persistent channel data to JSON data file
+     *
+     *  @return 0 for success, -errno for failure.
+     */
+    int exportChannelPersistData();
+
+    /** @brief function to write volatile channel data to JSON data file
+     *
+     *  @return 0 for success, -errno for failure.
+     */
+    int exportChannelVolatileData();
+
+    /** @brief function to create a channel access store from channel data
+     *
+     *  @param[in] store - channel access store
+     *  @param[in] access - NV or volatile access data of the channels
+     *  @param[out] generation - generation of the store
+     *
+     *  @return true for success
+     */
+    bool createChannelAccessStore(RecordStore& store,
+                                  ChannelAccess ChannelAccessData::*access,
+                                  uint32_t& generation);
+
+    /** @brief function to load channel data from a channel access store
+     *
+     *  @param[in] store - channel access store
+     *  @param[in] access - NV or volatile access data of the channels
+     *  @param[out] generation - generation of the loaded data
+     */
+    void loadChannelAccessStore(const RecordStore& store,
+                                ChannelAccess ChannelAccessData::*access,
+                                uint32_t& generation);
+
+    /** @brief function to write the changed channel data to a channel access
+     * store
+     *
+     *  @param[in] store - channel access store
+     *  @param[in] access - NV or volatile access data of the channels
+     *  @param[out] generation - generation of the store
+     *
+     *  @return 0 for success, -errno for failure.
+     */
+    int updateChannelAccessStore(RecordStore& store,
+                                 ChannelAccess ChannelAccessData::*access,
+                                 uint32_t& generation);
+
+    /** @brief function to check if a channel access store was updated since
+     * the data was loaded
+     *
+     *  @param[in] store - channel access store
+     *  @param[in] generation - generation of the loaded data
+     *
+     *  @return true if the data must be loaded again
+     */
+    bool channelAccessStoreChanged(RecordStore& store, uint32_t generation);
+
     /** @brief function to check and reload persistent channel data
      *
      *  @return 0 for success, -errno for failure.
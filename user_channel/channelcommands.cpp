@@ -402,7 +402,8 @@ RspType<uint8_t> // formatVersion
 void registerChannelFunctions() __attribute__((constructor));
 void registerChannelFunctions()
 {
-    ipmiChannelInit();
+    // the channel and cipher configurations are also loaded on first use
+    defer_init([]() { ipmiChannelInit(); });
 
     registerHandler(prioOpenBmcBase, netFnApp, app::cmdSetChannelAccess,
                     Privilege::Admin, ipmiSetChannelAccess);
@@ -410,8 +411,9 @@ void registerChannelFunctions()
     registerHandler(prioOpenBmcBase, netFnApp, app::cmdGetChannelAccess,
                     Privilege::User, ipmiGetChannelAccess);
 
+    // the channel configuration is read once, so is the channel info
     registerHandler(prioOpenBmcBase, netFnApp, app::cmdGetChannelInfoCommand,
-                    Privilege::User, ipmiGetChannelInfo);
+                    Privilege::User, CachePolicy{}, ipmiGetChannelInfo);
 
     registerHandler(prioOpenBmcBase, netFnApp, app::cmdGetChannelPayloadSupport,
                     Privilege::User, ipmiGetChannelPayloadSupport);
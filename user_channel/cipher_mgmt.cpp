@@ -16,10 +16,13 @@
 #include "cipher_mgmt.hpp"
 
 #include <fcntl.h>
+#include <sys/inotify.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <array>
+#include <cerrno>
 #include <filesystem>
 #include <fstream>
 #include <phosphor-logging/log.hpp>
@@ -43,9 +46,77 @@ CipherConfig::CipherConfig(const std::string& csFileName,
     cipherSuitePrivFileName(csFileName),
     cipherSuiteDefaultPrivFileName(csDefaultFileName)
 {
+    watchCSPrivilegeFiles();
     loadCSPrivilegesToMap();
 }
 
+CipherConfig::~CipherConfig()
+{
+    if (csPrivWatchFd >= 0)
+    {
+        close(csPrivWatchFd);
+    }
+}
+
+void CipherConfig::watchCSPrivilegeFiles()
+{
+    csPrivWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (csPrivWatchFd < 0)
+    {
+        log<level::ERR>("Failed to create CS privilege inotify instance",
+                        entry("ERRNO=%d", errno));
+        return;
+    }
+    // the user file is replaced by renaming a temporary file over it, so
+    // watch the directories rather than the files themselves
+    for (const auto& file :
+         {cipherSuitePrivFileName, cipherSuiteDefaultPrivFileName})
+    {
+        std::string dir = fs::path(file).parent_path();
+        if (inotify_add_watch(csPrivWatchFd, dir.c_str(),
+                              IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0)
+        {
+            // changes can't be detected, keep the privileges read at start
+            log<level::ERR>("Failed to watch CS privilege levels file",
+                            entry("DIR=%s", dir.c_str()),
+                            entry("ERRNO=%d", errno));
+            close(csPrivWatchFd);
+            csPrivWatchFd = -1;
+            return;
+        }
+    }
+}
+
+bool CipherConfig::csPrivilegeFilesChanged()
+{
+    if (csPrivWatchFd < 0)
+    {
+        return false;
+    }
+    std::string userFile = fs::path(cipherSuitePrivFileName).filename();
+    std::string defaultFile =
+        fs::path(cipherSuiteDefaultPrivFileName).filename();
+    bool changed = false;
+    alignas(inotify_event) std::array<char, 1024> events;
+    ssize_t size;
+    while ((size = read(csPrivWatchFd, events.data(), events.size())) > 0)
+    {
+        for (ssize_t pos = 0; pos < size;)
+        {
+            auto event =
+                reinterpret_cast<const inotify_event*>(events.data() + pos);
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len &&
+                 (userFile == event->name || defaultFile == event->name)))
+            {
+                changed = true;
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
 void CipherConfig::loadCSPrivilegesToMap()
 {
     if (!fs::exists(cipherSuiteDefaultPrivFileName))
@@ -182,6 +253,11 @@ ipmi::Cc CipherConfig::getCSPrivilegeLevels(
         return ccInvalidFieldRequest;
     }
 
+    if (csPrivilegeFilesChanged())
+    {
+        csPrivilegeMap.clear();
+        loadCSPrivilegesToMap();
+    }
     for (size_t csNum = 0; csNum < maxCSRecords; ++csNum)
     {
         csPrivilegeLevels[csNum] = csPrivilegeMap[{chNum, csNum}];
@@ -237,6 +313,8 @@ ipmi::Cc CipherConfig::setCSPrivilegeLevels(
         return ccUnspecifiedError;
     }
 
+    // the map is updated in place, drop the events of our own write
+    csPrivilegeFilesChanged();
     updateCSPrivilegesMap(jsonData);
     return ccSuccess;
 }
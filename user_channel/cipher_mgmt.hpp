@@ -40,7 +40,7 @@ using privMap = std::map<ChannelNumCipherIDPair, uint4_t>;
 class CipherConfig
 {
   public:
-    ~CipherConfig() = default;
+    ~CipherConfig();
     explicit CipherConfig(const std::string& csFileName,
                           const std::string& csDefaultFileName);
     CipherConfig() = delete;
@@ -77,6 +77,8 @@ class CipherConfig
 
     privMap csPrivilegeMap;
 
+    int csPrivWatchFd = -1;
+
     /** @brief function to read json config file
      *
      *  @return nlohmann::json object
@@ -112,6 +114,18 @@ class CipherConfig
      */
     void loadCSPrivilegesToMap();
 
+    /** @brief watches the CS privilege level files, so the map is only
+     *  loaded again after one of them changed
+     */
+    void watchCSPrivilegeFiles();
+
+    /** @brief checks the pending events for a change of the CS privilege
+     *  level files
+     *
+     *  @return true if one of the files changed
+     */
+    bool csPrivilegeFilesChanged();
+
     /** @brief function to update CS privileges map from json object data,
      * jsonData
      *
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <openssl/crypto.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <sys/stat.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ipmi
+{
+
+/** @class PamVerifierCache
+ *
+ *  Verifiers of the passwords PAM accepted in the last seconds, so that
+ *  repeated logins of a user skip the PAM stack. A verifier is an HMAC of
+ *  a random salt and the password, keyed with a random key of the process;
+ *  the password itself is never kept. Only matching passwords are answered
+ *  from the cache, any other password goes through PAM and counts as a
+ *  failed attempt there, and a failed attempt drops the verifier so the next
+ *  success goes through PAM too.
+ *
+ *  A verifier also records the state of the files the password, user and
+ *  lockout changes rewrite, which is checked on every use: this works in
+ *  every process using the library, whether it handles the user manager
+ *  signals or not. The state is taken once PAM accepted the password, as
+ *  a successful login rewrites the lockout files itself.
+ */
+class PamVerifierCache
+{
+  public:
+    static constexpr std::chrono::seconds lifetime{30};
+    static constexpr size_t maxVerifiers = 64;
+
+    /** @brief constructs the cache
+     *
+     *  @param[in] root - the directory the files the verifiers depend on
+     *                    are looked up in, the root of the filesystem by
+     *                    default
+     */
+    explicit PamVerifierCache(std::string root = {}) : root(std::move(root))
+    {
+        valid = RAND_bytes(key.data(), key.size()) == 1;
+    }
+
+    ~PamVerifierCache()
+    {
+        clear();
+        OPENSSL_cleanse(key.data(), key.size());
+    }
+
+    PamVerifierCache(const PamVerifierCache&) = delete;
+    PamVerifierCache& operator=(const PamVerifierCache&) = delete;
+
+    /** @brief checks a password against the verifier of the user
+     *
+     *  @return true if PAM accepted the same password recently and nothing
+     *          changed since
+     */
+    bool verify(std::string_view username, std::string_view password)
+    {
+        FileStates states = fileStates(username);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = verifiers.find(std::string(username));
+        if (it == verifiers.end())
+        {
+            return false;
+        }
+        Verifier& verifier = it->second;
+        Mac mac;
+        if (std::chrono::steady_clock::now() >= verifier.expires ||
+            !sameFiles(verifier.files, states) ||
+            !compute(verifier.salt, password, mac))
+        {
+            erase(it);
+            return false;
+        }
+        bool match = CRYPTO_memcmp(mac.data(), verifier.mac.data(),
+                                   mac.size()) == 0;
+        OPENSSL_cleanse(mac.data(), mac.size());
+        return match;
+    }
+
+    /** @brief records a password PAM just accepted, with the state PAM
+     *         left the files in
+     */
+    void store(std::string_view username, std::string_view password)
+    {
+        Verifier verifier;
+        if (!valid ||
+            RAND_bytes(verifier.salt.data(), verifier.salt.size()) != 1 ||
+            !compute(verifier.salt, password, verifier.mac))
+        {
+            return;
+        }
+        verifier.files = fileStates(username);
+        verifier.expires = std::chrono::steady_clock::now() + lifetime;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (verifiers.size() >= maxVerifiers)
+        {
+            clearLocked();
+        }
+        verifiers.insert_or_assign(std::string(username), verifier);
+        OPENSSL_cleanse(verifier.mac.data(), verifier.mac.size());
+    }
+
+    /** @brief drops the verifier of a user */
+    void forget(std::string_view username)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = verifiers.find(std::string(username));
+        if (it != verifiers.end())
+        {
+            erase(it);
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        clearLocked();
+    }
+
+  private:
+    using Mac = std::array<uint8_t, 32>;
+    using FileStates = std::array<struct stat, 4>;
+
+    struct Verifier
+    {
+        std::array<uint8_t, 16> salt;
+        Mac mac;
+        FileStates files;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    FileStates fileStates(std::string_view username) const
+    {
+        // passwords, users and the failed attempts of pam_tally2 and
+        // pam_faillock
+        const std::string files[] = {
+            root + "/etc/passwd", root + "/etc/shadow",
+            root + "/var/log/tallylog",
+            root + "/var/run/faillock/" + std::string(username)};
+        FileStates states{};
+        for (size_t i = 0; i < states.size(); i++)
+        {
+            if (stat(files[i].c_str(), &states[i]) != 0)
+            {
+                states[i] = {};
+            }
+        }
+        return states;
+    }
+
+    static bool sameFiles(const FileStates& a, const FileStates& b)
+    {
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (a[i].st_ino != b[i].st_ino || a[i].st_size != b[i].st_size ||
+                a[i].st_mtim.tv_sec != b[i].st_mtim.tv_sec ||
+                a[i].st_mtim.tv_nsec != b[i].st_mtim.tv_nsec)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool compute(const std::array<uint8_t, 16>& salt,
+                 std::string_view password, Mac& mac) const
+    {
+        if (!valid)
+        {
+            return false;
+        }
+        std::vector<uint8_t> message(salt.begin(), salt.end());
+        message.insert(message.end(), password.begin(), password.end());
+        unsigned int macLen = 0;
+        bool ok = HMAC(EVP_sha256(), key.data(), key.size(), message.data(),
+                       message.size(), mac.data(), &macLen) != nullptr &&
+                  macLen == mac.size();
+        OPENSSL_cleanse(message.data(), message.size());
+        return ok;
+    }
+
+    void erase(std::unordered_map<std::string, Verifier>::iterator it)
+    {
+        OPENSSL_cleanse(it->second.mac.data(), it->second.mac.size());
+        verifiers.erase(it);
+    }
+
+    void clearLocked()
+    {
+        for (auto& [username, verifier] : verifiers)
+        {
+            OPENSSL_cleanse(verifier.mac.data(), verifier.mac.size());
+        }
+        verifiers.clear();
+    }
+
+    std::string root;
+    std::array<uint8_t, 32> key;
+    bool valid = false;
+    std::mutex mutex;
+    std::unordered_map<std::string, Verifier> verifiers;
+};
+
+} // namespace ipmi
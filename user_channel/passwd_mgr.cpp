@@ -23,18 +23,23 @@
 #include <openssl/rand.h>
 #include <openssl/sha.h>
 #include <string.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <array>
 #include <cerrno>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <new>
 #include <phosphor-logging/log.hpp>
 
 namespace ipmi
 {
 
+static const char* passwdFileDir = "/etc";
 static const char* passwdFileName = "/etc/ipmi_pass";
 static const char* encryptKeyFileName = "/etc/key_file";
 static const size_t maxKeySize = 8;
@@ -60,10 +65,141 @@ struct MetaPassStruct
 
 using namespace phosphor::logging;
 
+SecureBuffer::SecureBuffer(size_t size) : len(size)
+{
+    // keep room for the terminating NUL
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    mapLen = (size + 1 + pageSize - 1) / pageSize * pageSize;
+    void* addr = mmap(nullptr, mapLen, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    ptr = static_cast<uint8_t*>(addr);
+    if (mlock(ptr, mapLen) != 0)
+    {
+        log<level::DEBUG>("Failed to lock password buffer",
+                          entry("ERRNO=%d", errno));
+    }
+    madvise(ptr, mapLen, MADV_DONTDUMP);
+}
+
+SecureBuffer::~SecureBuffer()
+{
+    release();
+}
+
+SecureBuffer::SecureBuffer(SecureBuffer&& other) noexcept :
+    ptr(other.ptr), len(other.len), mapLen(other.mapLen)
+{
+    other.ptr = nullptr;
+    other.len = 0;
+    other.mapLen = 0;
+}
+
+SecureBuffer& SecureBuffer::operator=(SecureBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        ptr = other.ptr;
+        len = other.len;
+        mapLen = other.mapLen;
+        other.ptr = nullptr;
+        other.len = 0;
+        other.mapLen = 0;
+    }
+    return *this;
+}
+
+void SecureBuffer::truncate(size_t size)
+{
+    if (size < len)
+    {
+        OPENSSL_cleanse(ptr + size, len - size);
+        len = size;
+    }
+}
+
+void SecureBuffer::release()
+{
+    if (ptr)
+    {
+        OPENSSL_cleanse(ptr, mapLen);
+        munlock(ptr, mapLen);
+        munmap(ptr, mapLen);
+        ptr = nullptr;
+        len = 0;
+        mapLen = 0;
+    }
+}
+
 PasswdMgr::PasswdMgr()
 {
     restrictFilesPermission();
-    initPasswordMap();
+    watchFiles();
+}
+
+PasswdMgr::~PasswdMgr()
+{
+    if (watchFd >= 0)
+    {
+        close(watchFd);
+    }
+}
+
+void PasswdMgr::watchFiles(void)
+{
+    watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watchFd < 0)
+    {
+        log<level::ERR>("Failed to create password file inotify instance",
+                        entry("ERRNO=%d", errno));
+        return;
+    }
+    // the files are replaced by renaming a temporary file over them, so
+    // watch the directory rather than the files themselves
+    if (inotify_add_watch(watchFd, passwdFileDir,
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0)
+    {
+        log<level::ERR>("Failed to watch password file",
+                        entry("DIR=%s", passwdFileDir),
+                        entry("ERRNO=%d", errno));
+        close(watchFd);
+        watchFd = -1;
+    }
+}
+
+bool PasswdMgr::filesChanged(void)
+{
+    if (watchFd < 0)
+    {
+        return true;
+    }
+    static const std::string passwdName =
+        std::string(passwdFileName).substr(strlen(passwdFileDir) + 1);
+    static const std::string keyName =
+        std::string(encryptKeyFileName).substr(strlen(passwdFileDir) + 1);
+    bool changed = false;
+    alignas(inotify_event) std::array<char, 4096> events;
+    ssize_t size;
+    while ((size = read(watchFd, events.data(), events.size())) > 0)
+    {
+        for (ssize_t pos = 0; pos < size;)
+        {
+            auto event =
+                reinterpret_cast<const inotify_event*>(events.data() + pos);
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len &&
+                 (passwdName == event->name || keyName == event->name)))
+            {
+                changed = true;
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
 }
 
 void PasswdMgr::restrictFilesPermission(void)
@@ -95,17 +231,16 @@ std::string PasswdMgr::getPasswdByUserName(const std::string& userName)
     {
         return std::string();
     }
-    return iter->second;
+    return std::string(iter->second);
 }
 
 int PasswdMgr::updateUserEntry(const std::string& userName,
                                const std::string& newUserName)
 {
-    std::time_t updatedTime = getUpdatedFileTime();
-    // Check file time stamp to know passwdMapList is up-to-date.
-    // If not up-to-date, then updatePasswdSpecialFile will read and
-    // check the user entry existance.
-    if (fileLastUpdatedTime == updatedTime && updatedTime != -EIO)
+    checkAndReload();
+    // If passwdMapList could not be loaded, then updatePasswdSpecialFile will
+    // read and check the user entry existance.
+    if (passwdMapValid)
     {
         if (passwdMapList.find(userName) == passwdMapList.end())
         {
@@ -125,15 +260,19 @@ int PasswdMgr::updateUserEntry(const std::string& userName,
     return 0;
 }
 
+void PasswdMgr::load()
+{
+    checkAndReload();
+}
+
 void PasswdMgr::checkAndReload(void)
 {
-    //std::time_t updatedTime = getUpdatedFileTime();
-    //if (fileLastUpdatedTime != updatedTime && updatedTime != -1)
-    //{
+    // a file that can't be read is retried once it is updated
+    if (filesChanged() || !passwdMapRead)
+    {
         log<level::DEBUG>("Reloading password map list");
-        passwdMapList.clear();
         initPasswordMap();
-    //}
+    }
 }
 
 int PasswdMgr::encryptDecryptData(bool doEncrypt, const EVP_CIPHER* cipher,
@@ -228,44 +367,44 @@ int PasswdMgr::encryptDecryptData(bool doEncrypt, const EVP_CIPHER* cipher,
 void PasswdMgr::initPasswordMap(void)
 {
     // TODO  phosphor-host-ipmid#170 phosphor::user::shadow::Lock lock{};
-    std::vector<uint8_t> dataBuf;
+    passwdMapList.clear();
+    passwdData = SecureBuffer();
+    passwdMapValid = false;
+    passwdMapRead = true;
 
+    SecureBuffer dataBuf;
     if (readPasswdFileData(dataBuf) != 0)
     {
         log<level::DEBUG>("Error in reading the encrypted pass file");
         return;
     }
 
-    if (dataBuf.size() != 0)
+    // populate the user list with password, the entries point into the
+    // locked buffer so the passwords are never copied
+    std::string_view data(reinterpret_cast<const char*>(dataBuf.data()),
+                          dataBuf.size());
+    while (!data.empty())
     {
-        // populate the user list with password
-        char* outPtr = reinterpret_cast<char*>(dataBuf.data());
-        char* nToken = NULL;
-        char* linePtr = strtok_r(outPtr, "\n", &nToken);
-        size_t lineSize = 0;
-        while (linePtr != NULL)
+        size_t lineEnd = data.find('\n');
+        std::string_view line = data.substr(0, lineEnd);
+        size_t userEPos = line.find(':');
+        if (userEPos != std::string_view::npos)
         {
-            size_t userEPos = 0;
-            std::string lineStr(linePtr);
-            if ((userEPos = lineStr.find(":")) != std::string::npos)
-            {
-                lineSize = lineStr.size();
-                passwdMapList.emplace(
-                    lineStr.substr(0, userEPos),
-                    lineStr.substr(userEPos + 1, lineSize - (userEPos + 1)));
-            }
-            linePtr = strtok_r(NULL, "\n", &nToken);
+            passwdMapList.emplace(line.substr(0, userEPos),
+                                  line.substr(userEPos + 1));
         }
+        if (lineEnd == std::string_view::npos)
+        {
+            break;
+        }
+        data.remove_prefix(lineEnd + 1);
     }
-
-    // Update the timestamp
-    fileLastUpdatedTime = getUpdatedFileTime();
-    // Clear sensitive data
-    OPENSSL_cleanse(dataBuf.data(), dataBuf.size());
+    passwdData = std::move(dataBuf);
+    passwdMapValid = true;
     return;
 }
 
-int PasswdMgr::readPasswdFileData(std::vector<uint8_t>& outBytes)
+int PasswdMgr::readPasswdFileData(SecureBuffer& outBytes)
 {
     std::array<uint8_t, maxKeySize> keyBuff;
     std::ifstream keyFile(encryptKeyFileName, std::ios::in | std::ios::binary);
@@ -336,8 +475,8 @@ int PasswdMgr::readPasswdFileData(std::vector<uint8_t>& outBytes)
     size_t macLen = metaData->macSize;
 
     size_t outBytesLen = 0;
-    // Resize to actual data size
-    outBytes.resize(inBytesLen + EVP_MAX_BLOCK_LENGTH);
+    // Allocate for the actual data size
+    outBytes = SecureBuffer(inBytesLen + EVP_MAX_BLOCK_LENGTH);
     if (encryptDecryptData(false, EVP_aes_128_cbc(), key.data(), keyLen, iv,
                            ivLen, inBytes, inBytesLen, mac, &macLen,
                            outBytes.data(), &outBytesLen) != 0)
@@ -345,8 +484,8 @@ int PasswdMgr::readPasswdFileData(std::vector<uint8_t>& outBytes)
         log<level::DEBUG>("Error in decryption");
         return -EIO;
     }
-    // Resize the vector to outBytesLen
-    outBytes.resize(outBytesLen);
+    // Resize the buffer to outBytesLen
+    outBytes.truncate(outBytesLen);
 
     OPENSSL_cleanse(key.data(), keyLen);
     OPENSSL_cleanse(iv, ivLen);
@@ -363,7 +502,7 @@ int PasswdMgr::updatePasswdSpecialFile(const std::string& userName,
     size_t inBytesLen = 0;
     size_t isUsrFound = false;
     const EVP_CIPHER* cipher = EVP_aes_128_cbc();
-    std::vector<uint8_t> dataBuf;
+    SecureBuffer dataBuf;
 
     // Read the encrypted file and get the file data
     // Check user existance and return if not exist.
@@ -584,15 +723,4 @@ int PasswdMgr::updatePasswdSpecialFile(const std::string& userName,
     return 0;
 }
 
-std::time_t PasswdMgr::getUpdatedFileTime()
-{
-    struct stat fileStat = {};
-    if (stat(passwdFileName, &fileStat) != 0)
-    {
-        log<level::DEBUG>("Error - Getting passwd file time stamp");
-        return -EIO;
-    }
-    return fileStat.st_mtime;
-}
-
 } // namespace ipmi
@@ -16,28 +16,79 @@
 #pragma once
 #include <openssl/evp.h>
 
-#include <ctime>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 namespace ipmi
 {
 
+/** @class SecureBuffer
+ *
+ *  Buffer for sensitive data. The memory is locked so it is never swapped
+ *  out, is excluded from core dumps and is zeroized when it is released.
+ *  The data is always followed by a NUL byte.
+ */
+class SecureBuffer
+{
+  public:
+    SecureBuffer() = default;
+    explicit SecureBuffer(size_t size);
+    ~SecureBuffer();
+
+    SecureBuffer(const SecureBuffer&) = delete;
+    SecureBuffer& operator=(const SecureBuffer&) = delete;
+    SecureBuffer(SecureBuffer&& other) noexcept;
+    SecureBuffer& operator=(SecureBuffer&& other) noexcept;
+
+    uint8_t* data()
+    {
+        return ptr;
+    }
+
+    size_t size() const
+    {
+        return len;
+    }
+
+    /** @brief shortens the data, zeroizing the bytes dropped
+     *
+     *  @param[in] size - new size, not larger than the current one
+     */
+    void truncate(size_t size);
+
+  private:
+    void release();
+
+    uint8_t* ptr = nullptr;
+    size_t len = 0;
+    size_t mapLen = 0;
+};
+
 class PasswdMgr
 {
   public:
-    ~PasswdMgr() = default;
+    ~PasswdMgr();
     PasswdMgr(const PasswdMgr&) = delete;
     PasswdMgr& operator=(const PasswdMgr&) = delete;
     PasswdMgr(PasswdMgr&&) = delete;
     PasswdMgr& operator=(PasswdMgr&&) = delete;
 
-    /** @brief Constructs user password list
+    /** @brief Watches the password files; the password list is read and
+     *  decrypted on first use, or by load
      *
      */
     PasswdMgr();
 
+    /** @brief read the password list now, if it is not read yet or the
+     *  files were updated
+     *
+     */
+    void load();
+
     /** @brief Get password for the user
      *
      *  @param[in] userName - user name
@@ -60,16 +111,30 @@ class PasswdMgr
                         const std::string& newUserName);
 
   private:
-    using UserName = std::string;
-    using Password = std::string;
+    using UserName = std::string_view;
+    using Password = std::string_view;
+    // decrypted password file, the map entries point into it
+    SecureBuffer passwdData;
     std::unordered_map<UserName, Password> passwdMapList;
-    std::time_t fileLastUpdatedTime;
+    bool passwdMapValid = false;
+    bool passwdMapRead = false;
+    int watchFd = -1;
 
     /** @brief restrict file permission
      *
      */
     void restrictFilesPermission(void);
-    /** @brief check timestamp and reload password map if required
+    /** @brief watch the password and key files for updates
+     *
+     */
+    void watchFiles(void);
+    /** @brief check if the password or key file was updated since the last
+     *  check
+     *
+     * @return true if a file was updated or if updates can't be detected
+     */
+    bool filesChanged(void);
+    /** @brief reload password map if the password or key file was updated
      *
      */
     void checkAndReload(void);
@@ -83,11 +148,11 @@ class PasswdMgr
 
     /** @brief Function to read the encrypted password file data
      *
-     *  @param[out] outBytes - vector to hold decrypted password file data
+     *  @param[out] outBytes - buffer to hold decrypted password file data
      *
      * @return error response
      */
-    int readPasswdFileData(std::vector<uint8_t>& outBytes);
+    int readPasswdFileData(SecureBuffer& outBytes);
     /** @brief  Updates special password file by clearing the password entry
      *  for the user specified.
      *
@@ -121,12 +186,6 @@ class PasswdMgr
                            size_t ivLen, uint8_t* inBytes, size_t inBytesLen,
                            uint8_t* mac, size_t* macLen, uint8_t* outBytes,
                            size_t* outBytesLen);
-
-    /** @brief  returns updated file time of passwd file entry.
-     *
-     * @return timestamp or -1 for error.
-     */
-    std::time_t getUpdatedFileTime();
 };
 
 } // namespace ipmi
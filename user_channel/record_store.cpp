@@ -0,0 +1,166 @@
+#include "record_store.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <phosphor-logging/log.hpp>
+#include <vector>
+
+namespace ipmi
+{
+
+using namespace phosphor::logging;
+
+RecordStore::RecordStore(const std::string& path, uint32_t magic,
+                         uint16_t version, uint16_t recordSize,
+                         uint32_t recordCount) :
+    path(path),
+    magic(magic), version(version), recordSize(recordSize),
+    recordCount(recordCount)
+{
+}
+
+RecordStore::~RecordStore()
+{
+    close();
+}
+
+bool RecordStore::open()
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDWR | O_DSYNC | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) != fileSize())
+    {
+        log<level::ERR>("Invalid IPMI record store size",
+                        entry("FILE=%s", path.c_str()));
+        close();
+        return false;
+    }
+    void* addr = mmap(nullptr, fileSize(), PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        log<level::ERR>("Failed to map IPMI record store",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        close();
+        return false;
+    }
+    size_t size = fileSize();
+    map = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(addr),
+                                   [size](uint8_t* p) { munmap(p, size); });
+    inode = st.st_ino;
+
+    const Header* hdr = header();
+    if (hdr->magic != magic || hdr->version != version ||
+        hdr->recordSize != recordSize || hdr->recordCount != recordCount)
+    {
+        log<level::ERR>("IPMI record store layout mismatch",
+                        entry("FILE=%s", path.c_str()));
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool RecordStore::create(const void* records)
+{
+    close();
+
+    std::vector<uint8_t> data(fileSize());
+    Header hdr{magic, version, recordSize, recordCount, 0};
+    std::memcpy(data.data(), &hdr, sizeof(hdr));
+    std::memcpy(data.data() + sizeof(hdr), records,
+                data.size() - sizeof(hdr));
+
+    const std::string tmpFile = path + "_tmp";
+    int tmpFd = ::open(tmpFile.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_SYNC,
+                       S_IRUSR | S_IWUSR);
+    if (tmpFd < 0)
+    {
+        log<level::ERR>("Error in creating IPMI record store",
+                        entry("FILE=%s", tmpFile.c_str()));
+        return false;
+    }
+    if (write(tmpFd, data.data(), data.size()) !=
+        static_cast<ssize_t>(data.size()))
+    {
+        ::close(tmpFd);
+        log<level::ERR>("Error in writing IPMI record store",
+                        entry("FILE=%s", tmpFile.c_str()));
+        return false;
+    }
+    ::close(tmpFd);
+
+    if (std::rename(tmpFile.c_str(), path.c_str()) != 0)
+    {
+        log<level::ERR>("Error in renaming IPMI record store",
+                        entry("FILE=%s", tmpFile.c_str()));
+        return false;
+    }
+    return open();
+}
+
+void RecordStore::close()
+{
+    map.reset();
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool RecordStore::replaced() const
+{
+    struct stat st;
+    return stat(path.c_str(), &st) < 0 || st.st_ino != inode;
+}
+
+uint32_t RecordStore::generation() const
+{
+    return header()->generation;
+}
+
+const uint8_t* RecordStore::record(size_t index) const
+{
+    return map.get() + sizeof(Header) + index * recordSize;
+}
+
+int RecordStore::writeRecord(size_t index, const void* data)
+{
+    if (std::memcmp(record(index), data, recordSize) == 0)
+    {
+        return 0;
+    }
+    off_t offset = sizeof(Header) + index * recordSize;
+    if (pwrite(fd, data, recordSize, offset) != recordSize)
+    {
+        log<level::ERR>("Error in writing IPMI record store",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        return -EIO;
+    }
+    uint32_t generation = header()->generation + 1;
+    if (pwrite(fd, &generation, sizeof(generation),
+               offsetof(Header, generation)) != sizeof(generation))
+    {
+        log<level::ERR>("Error in updating IPMI record store",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        return -EIO;
+    }
+    return 0;
+}
+
+} // namespace ipmi
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ipmi
+{
+
+/** @class RecordStore
+ *
+ *  File of fixed size records, shared by all the IPMI processes through a
+ *  read only shared mapping. The file starts with a header that describes
+ *  the record layout, so a file written with another layout is rejected,
+ *  and holds a generation count that is bumped on every update so readers
+ *  find out cheaply whether their copy of the data is still current.
+ *
+ *  Updates write only the records that changed, each with a single pwrite.
+ *  Callers serialize the updates and the reads with their named mutex.
+ */
+class RecordStore
+{
+  public:
+    /** @brief constructs a store, the file is not opened
+     *
+     *  @param[in] path - store file path
+     *  @param[in] magic - identifies the kind of records in the file
+     *  @param[in] version - version of the record layout
+     *  @param[in] recordSize - size of a record in bytes
+     *  @param[in] recordCount - number of records in the file
+     */
+    RecordStore(const std::string& path, uint32_t magic, uint16_t version,
+                uint16_t recordSize, uint32_t recordCount);
+    ~RecordStore();
+
+    RecordStore(const RecordStore&) = delete;
+    RecordStore& operator=(const RecordStore&) = delete;
+
+    /** @brief maps the existing store file
+     *
+     *  @return true if the file exists and has the expected layout
+     */
+    bool open();
+
+    /** @brief replaces the store file with the given records and maps it
+     *
+     *  @param[in] records - recordCount records of recordSize bytes
+     *
+     *  @return true for success
+     */
+    bool create(const void* records);
+
+    /** @brief unmaps the store file */
+    void close();
+
+    /** @brief checks if the store file is mapped */
+    bool isOpen() const
+    {
+        return map != nullptr;
+    }
+
+    /** @brief checks if the store file was removed or replaced since it was
+     *  mapped, in which case it has to be opened again
+     */
+    bool replaced() const;
+
+    /** @brief gets the generation count of the store */
+    uint32_t generation() const;
+
+    /** @brief gets the generation count in the mapping of the store file
+     *
+     *  @details The mapping stays while the pointer is held, even once the
+     *  store is closed, so the count can be read without the named mutex.
+     *
+     *  @return the mapped count, nullptr if the store is not open
+     */
+    std::shared_ptr<const uint32_t> mappedGeneration() const
+    {
+        if (!map)
+        {
+            return nullptr;
+        }
+        return std::shared_ptr<const uint32_t>(map, &header()->generation);
+    }
+
+    /** @brief gets a record
+     *
+     *  @param[in] index - record index
+     *
+     *  @return the mapped record data
+     */
+    const uint8_t* record(size_t index) const;
+
+    /** @brief writes a record, if it changed
+     *
+     *  @param[in] index - record index
+     *  @param[in] data - record data
+     *
+     *  @return 0 for success, -errno for failure.
+     */
+    int writeRecord(size_t index, const void* data);
+
+  private:
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint32_t recordCount;
+        uint32_t generation;
+    };
+
+    size_t fileSize() const
+    {
+        return sizeof(Header) + size_t(recordSize) * recordCount;
+    }
+
+    const Header* header() const
+    {
+        return reinterpret_cast<const Header*>(map.get());
+    }
+
+    std::string path;
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t recordCount;
+    int fd = -1;
+    ino_t inode = 0;
+    // shared with the holders of mappedGeneration()
+    std::shared_ptr<uint8_t> map;
+};
+
+} // namespace ipmi
@@ -19,8 +19,12 @@
 #include "passwd_mgr.hpp"
 #include "user_mgmt.hpp"
 
+#include <algorithm>
+
 namespace
 {
+// constructed as the provider loads, the password file is only decrypted
+// by ipmiUserInit or on first use
 ipmi::PasswdMgr passwdMgr;
 }
 
@@ -30,6 +34,7 @@ namespace ipmi
 Cc ipmiUserInit()
 {
     getUserAccessObject();
+    passwdMgr.load();
     return ccSuccess;
 }
 
@@ -122,11 +127,48 @@ Cc ipmiUserGetAllCounts(uint8_t& maxChUsers, uint8_t& enabledUsers,
     return ccSuccess;
 }
 
+Cc ipmiUserGetChannelUsers(const uint8_t chNum, ChannelUsers& users)
+{
+    if (!UserAccess::isValidChannel(chNum))
+    {
+        return ccInvalidFieldRequest;
+    }
+    UsersTbl* userData = getUserAccessObject().getUsersTblPtr();
+    // user index 0 is reserved, starts with 1
+    for (size_t usrIndex = 1; usrIndex <= ipmiMaxUsers; ++usrIndex)
+    {
+        const UserInfo& userInfo = userData->user[usrIndex];
+        UserChannelAccess& user = users[usrIndex - 1];
+        user.enabled = userInfo.userEnabled;
+        user.fixedUserName = userInfo.fixedUserName;
+        user.privAccess = {};
+        user.privAccess.privilege = userInfo.userPrivAccess[chNum].privilege;
+        user.privAccess.ipmiEnabled =
+            userInfo.userPrivAccess[chNum].ipmiEnabled;
+        user.privAccess.linkAuthEnabled =
+            userInfo.userPrivAccess[chNum].linkAuthEnabled;
+        user.privAccess.accessCallback =
+            userInfo.userPrivAccess[chNum].accessCallback;
+        std::copy_n(userInfo.userName, ipmiMaxUserName, user.userName.begin());
+    }
+    return ccSuccess;
+}
+
 Cc ipmiUserUpdateEnabledState(const uint8_t userId, const bool& state)
 {
     return getUserAccessObject().setUserEnabledState(userId, state);
 }
 
+void ipmiUserBeginConfig()
+{
+    getUserAccessObject().beginUserConfig();
+}
+
+Cc ipmiUserCommitConfig()
+{
+    return getUserAccessObject().commitUserConfig();
+}
+
 Cc ipmiUserCheckEnabled(const uint8_t userId, bool& state)
 {
     if (!UserAccess::isValidUserId(userId))
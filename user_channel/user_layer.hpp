@@ -15,6 +15,7 @@
 */
 #pragma once
 
+#include <array>
 #include <bitset>
 #include <ipmid/api.hpp>
 #include <string>
@@ -63,6 +64,23 @@ struct PrivAccess
 #endif
 } __attribute__((packed));
 
+/** @struct UserChannelAccess
+ *
+ *  Structure to denote the state and the access of a user on a given
+ *  channel, as one read of the user table provides it
+ */
+struct UserChannelAccess
+{
+    bool enabled;
+    bool fixedUserName;
+    PrivAccess privAccess;
+    // NUL padded
+    std::array<uint8_t, ipmiMaxUserName> userName;
+};
+
+/** @brief the users of a channel, starting with user ID 1 */
+using ChannelUsers = std::array<UserChannelAccess, ipmiMaxUsers>;
+
 /** @struct UserPayloadAccess
  *
  *  Structure to denote payload access restrictions applicable for a
@@ -188,6 +206,16 @@ Cc ipmiUserGetUserName(const uint8_t userId, std::string& userName);
 Cc ipmiUserGetAllCounts(uint8_t& maxChUsers, uint8_t& enabledUsers,
                         uint8_t& fixedUsers);
 
+/** @brief provides the state and the access of all the users on a channel,
+ *  checking the user data for updates once
+ *
+ *  @param[in] chNum - channel number
+ *  @param[out] users - the users, starting with user ID 1
+ *
+ *  @return ccSuccess for success, others for failure.
+ */
+Cc ipmiUserGetChannelUsers(const uint8_t chNum, ChannelUsers& users);
+
 /** @brief function to update user enabled state
  *
  *  @param[in] userId - user id
@@ -197,6 +225,17 @@ Cc ipmiUserGetAllCounts(uint8_t& maxChUsers, uint8_t& enabledUsers,
  */
 Cc ipmiUserUpdateEnabledState(const uint8_t userId, const bool& state);
 
+/** @brief starts a batch of user configuration changes, the user data is
+ *  written and the user manager updated only when the batch is committed
+ */
+void ipmiUserBeginConfig();
+
+/** @brief commits a batch of user configuration changes
+ *
+ *  @return ccSuccess for success, others for failure.
+ */
+Cc ipmiUserCommitConfig();
+
 /** @brief determines whether user is enabled
  *
  *  @param[in] userId - user id
@@ -18,14 +18,19 @@
 #include "apphandler.hpp"
 #include "channel_layer.hpp"
 #include "channel_mgmt.hpp"
+#include "pam_verifier_cache.hpp"
+#include "record_store.hpp"
 
 #include <security/pam_appl.h>
+#include <sys/inotify.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include <boost/interprocess/sync/named_recursive_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
+#include <array>
 #include <cerrno>
+#include <filesystem>
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/elog-errors.hpp>
@@ -70,6 +75,9 @@ static constexpr const char* ipmiUserMutex = "ipmi_usr_mutex";
 static constexpr const char* ipmiMutexCleanupLockFile =
     "/var/lib/ipmi/ipmi_usr_mutex_cleanup";
 static constexpr const char* ipmiUserDataFile = "/var/lib/ipmi/ipmi_user.json";
+static constexpr const char* ipmiUserStoreFile = "/var/lib/ipmi/ipmi_user.bin";
+static constexpr uint32_t userStoreMagic = 0x52535549; // "IUSR"
+static constexpr uint16_t userStoreVersion = 1;
 static constexpr const char* ipmiGrpName = "ipmi";
 static constexpr size_t privNoAccess = 0xF;
 static constexpr size_t privMask = 0xF;
@@ -190,6 +198,75 @@ static std::string getUserServiceName()
     return userMgmtService;
 }
 
+/** @struct UserRecord
+ *
+ *  Fixed layout of a user in the binary user data store
+ */
+struct UserRecord
+{
+    uint8_t userName[ipmiMaxUserName];
+    uint8_t flags;
+    struct
+    {
+        uint8_t privilege;
+        uint8_t flags;
+        uint8_t stdPayloadEnables1;
+        uint8_t oemPayloadEnables1;
+    } __attribute__((packed)) channel[ipmiMaxChannels];
+} __attribute__((packed));
+
+// UserRecord flags
+static constexpr uint8_t userEnabledFlag = 1 << 0;
+static constexpr uint8_t userInSystemFlag = 1 << 1;
+static constexpr uint8_t fixedUserNameFlag = 1 << 2;
+// UserRecord channel flags
+static constexpr uint8_t ipmiEnabledFlag = 1 << 0;
+static constexpr uint8_t linkAuthEnabledFlag = 1 << 1;
+static constexpr uint8_t accessCallbackFlag = 1 << 2;
+
+static void toUserRecord(const UserInfo& userInfo, UserRecord& record)
+{
+    std::copy_n(userInfo.userName, ipmiMaxUserName, record.userName);
+    record.flags = (userInfo.userEnabled ? userEnabledFlag : 0) |
+                   (userInfo.userInSystem ? userInSystemFlag : 0) |
+                   (userInfo.fixedUserName ? fixedUserNameFlag : 0);
+    for (size_t chIndex = 0; chIndex < ipmiMaxChannels; ++chIndex)
+    {
+        const UserPrivAccess& access = userInfo.userPrivAccess[chIndex];
+        const PayloadAccess& payload = userInfo.payloadAccess[chIndex];
+        record.channel[chIndex].privilege = access.privilege;
+        record.channel[chIndex].flags =
+            (access.ipmiEnabled ? ipmiEnabledFlag : 0) |
+            (access.linkAuthEnabled ? linkAuthEnabledFlag : 0) |
+            (access.accessCallback ? accessCallbackFlag : 0);
+        record.channel[chIndex].stdPayloadEnables1 =
+            payload.stdPayloadEnables1.to_ulong();
+        record.channel[chIndex].oemPayloadEnables1 =
+            payload.oemPayloadEnables1.to_ulong();
+    }
+}
+
+static void fromUserRecord(const UserRecord& record, UserInfo& userInfo)
+{
+    std::copy_n(record.userName, ipmiMaxUserName, userInfo.userName);
+    userInfo.userEnabled = record.flags & userEnabledFlag;
+    userInfo.userInSystem = record.flags & userInSystemFlag;
+    userInfo.fixedUserName = record.flags & fixedUserNameFlag;
+    for (size_t chIndex = 0; chIndex < ipmiMaxChannels; ++chIndex)
+    {
+        UserPrivAccess& access = userInfo.userPrivAccess[chIndex];
+        PayloadAccess& payload = userInfo.payloadAccess[chIndex];
+        access.privilege = record.channel[chIndex].privilege;
+        access.ipmiEnabled = record.channel[chIndex].flags & ipmiEnabledFlag;
+        access.linkAuthEnabled =
+            record.channel[chIndex].flags & linkAuthEnabledFlag;
+        access.accessCallback =
+            record.channel[chIndex].flags & accessCallbackFlag;
+        payload.stdPayloadEnables1 = record.channel[chIndex].stdPayloadEnables1;
+        payload.oemPayloadEnables1 = record.channel[chIndex].oemPayloadEnables1;
+    }
+}
+
 UserAccess& getUserAccessObject()
 {
     static UserAccess userAccess;
@@ -451,9 +528,17 @@ UserAccess::~UserAccess()
         userPropertiesSignal.reset();
         sigHndlrLock.unlock();
     }
+    if (userDataWatchFd >= 0)
+    {
+        close(userDataWatchFd);
+    }
 }
 
-UserAccess::UserAccess() : bus(ipmid_get_sd_bus_connection())
+UserAccess::UserAccess() :
+    bus(ipmid_get_sd_bus_connection()),
+    userStore(std::make_unique<RecordStore>(ipmiUserStoreFile, userStoreMagic,
+                                            userStoreVersion,
+                                            sizeof(UserRecord), ipmiMaxUsers))
 {
     std::ofstream mutexCleanUpFile;
     mutexCleanUpFile.open(ipmiMutexCleanupLockFile,
@@ -473,6 +558,7 @@ UserAccess::UserAccess() : bus(ipmid_get_sd_bus_connection())
     userMutex = std::make_unique<boost::interprocess::named_recursive_mutex>(
         boost::interprocess::open_or_create, ipmiUserMutex);
 
+    watchUserDataFile();
     cacheUserDataFile();
     getSystemPrivAndGroups();
 }
@@ -643,6 +729,19 @@ static int pamFunctionConversation(int numMsg, const struct pam_message** msg,
     return PAM_SUCCESS;
 }
 
+#ifdef PAM_AUTH_CACHE
+namespace
+{
+
+PamVerifierCache& getPamVerifierCache()
+{
+    static PamVerifierCache pamVerifierCache;
+    return pamVerifierCache;
+}
+
+} // namespace
+#endif
+
 /** @brief Updating the PAM password
  *
  *  @param[in] username - username in string
@@ -673,11 +772,22 @@ int pamUpdatePasswd(const char* username, const char* password)
         return retval;
     }
 
+#ifdef PAM_AUTH_CACHE
+    // the new password is checked by PAM until it is accepted once
+    getPamVerifierCache().forget(username);
+#endif
     return pam_end(localAuthHandle, PAM_SUCCESS);
 }
 
-bool pamUserCheckAuthenticate(std::string_view username,
-                              std::string_view password)
+/** @brief authenticates a user with the full PAM stack
+ *
+ *  @param[in] username - username in string
+ *  @param[in] password - password in string
+ *
+ *  @return true if PAM accepted the user and the password
+ */
+static bool pamAuthenticate(std::string_view username,
+                            std::string_view password)
 {
     const struct pam_conv localConversation = {
         pamFunctionConversation, const_cast<char*>(password.data())};
@@ -717,6 +827,27 @@ bool pamUserCheckAuthenticate(std::string_view username,
     return true;
 }
 
+bool pamUserCheckAuthenticate(std::string_view username,
+                              std::string_view password)
+{
+#ifdef PAM_AUTH_CACHE
+    PamVerifierCache& cache = getPamVerifierCache();
+    if (cache.verify(username, password))
+    {
+        return true;
+    }
+    if (!pamAuthenticate(username, password))
+    {
+        cache.forget(username);
+        return false;
+    }
+    cache.store(username, password);
+    return true;
+#else
+    return pamAuthenticate(username, password);
+#endif
+}
+
 Cc UserAccess::setSpecialUserPassword(const std::string& userName,
                                       const std::string& userPassword)
 {
@@ -784,8 +915,7 @@ Cc UserAccess::setUserEnabledState(const uint8_t userId,
     if (userInfo->userEnabled != enabledState)
     {
         std::string userPath = std::string(userObjBasePath) + "/" + userName;
-        setDbusProperty(bus, getUserServiceName(), userPath, usersInterface,
-                        userEnabledProperty, enabledState);
+        setUserProperty(userPath, userEnabledProperty, enabledState);
         userInfo->userEnabled = enabledState;
         try
         {
@@ -884,8 +1014,7 @@ Cc UserAccess::setUserPrivilegeAccess(const uint8_t userId, const uint8_t chNum,
         privAccess.privilege != userInfo->userPrivAccess[syncIndex].privilege)
     {
         std::string userPath = std::string(userObjBasePath) + "/" + userName;
-        setDbusProperty(bus, getUserServiceName(), userPath, usersInterface,
-                        userPrivProperty, priv);
+        setUserProperty(userPath, userPrivProperty, priv);
     }
     userInfo->userPrivAccess[chNum].privilege = privAccess.privilege;
 
@@ -909,6 +1038,82 @@ Cc UserAccess::setUserPrivilegeAccess(const uint8_t userId, const uint8_t chNum,
     return ccSuccess;
 }
 
+void UserAccess::setUserProperty(const std::string& userPath,
+                                 const std::string& property,
+                                 const DbusUserPropVariant& value)
+{
+    if (userConfigBatch)
+    {
+        pendingUserProps[{userPath, property}] = value;
+        return;
+    }
+    setDbusProperty(bus, getUserServiceName(), userPath, usersInterface,
+                    property, value);
+}
+
+bool UserAccess::flushUserProperties()
+{
+    bool result = true;
+    for (const auto& [key, value] : pendingUserProps)
+    {
+        try
+        {
+            setDbusProperty(bus, getUserServiceName(), key.first,
+                            usersInterface, key.second, value);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            result = false;
+        }
+    }
+    pendingUserProps.clear();
+    return result;
+}
+
+void UserAccess::beginUserConfig()
+{
+    boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
+        userLock{*userMutex};
+    if (userConfigBatch)
+    {
+        return;
+    }
+    // start from the current data
+    checkAndReloadUserData();
+    userConfigBatch = true;
+    userDataDirty = false;
+}
+
+Cc UserAccess::commitUserConfig()
+{
+    boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
+        userLock{*userMutex};
+    if (!userConfigBatch)
+    {
+        return ccSuccess;
+    }
+    userConfigBatch = false;
+    Cc cc = ccSuccess;
+    if (!flushUserProperties())
+    {
+        cc = ccUnspecifiedError;
+    }
+    if (userDataDirty)
+    {
+        userDataDirty = false;
+        try
+        {
+            writeUserData();
+        }
+        catch (const std::exception& e)
+        {
+            log<level::DEBUG>("Write user data failed");
+            cc = ccUnspecifiedError;
+        }
+    }
+    return cc;
+}
+
 uint8_t UserAccess::getUserId(const std::string& userName)
 {
     boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
@@ -988,6 +1193,11 @@ Cc UserAccess::setUserName(const uint8_t userId, const std::string& userName)
 
     bool validUser = isValidUserName(userName);
     UserInfo* userInfo = getUserInfo(userId);
+    // queued property updates refer to the user objects by their old name
+    if (!flushUserProperties())
+    {
+        return ccUnspecifiedError;
+    }
     if (userName.empty() && !oldUser.empty())
     {
         // Delete existing user
@@ -1188,6 +1398,45 @@ void UserAccess::readUserData()
     boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
         userLock{*userMutex};
 
+    if (userStore->isOpen() || userStore->open())
+    {
+        UsersTbl newTbl{};
+        // user index 0 is reserved, starts with 1
+        for (size_t usrIndex = 1; usrIndex <= ipmiMaxUsers; ++usrIndex)
+        {
+            fromUserRecord(*reinterpret_cast<const UserRecord*>(
+                               userStore->record(usrIndex - 1)),
+                           newTbl.user[usrIndex]);
+        }
+        usersTbl = newTbl;
+        userDataLoaded = true;
+        userStoreGeneration = userStore->generation();
+        return;
+    }
+
+    // no binary store yet, import the JSON user data file into a new one
+    importUserData();
+    createUserStore();
+}
+
+bool UserAccess::createUserStore()
+{
+    std::array<UserRecord, ipmiMaxUsers> records;
+    // user index 0 is reserved, starts with 1
+    for (size_t usrIndex = 1; usrIndex <= ipmiMaxUsers; ++usrIndex)
+    {
+        toUserRecord(usersTbl.user[usrIndex], records[usrIndex - 1]);
+    }
+    if (!userStore->create(records.data()))
+    {
+        return false;
+    }
+    userStoreGeneration = userStore->generation();
+    return true;
+}
+
+void UserAccess::importUserData()
+{
     std::ifstream iUsrData(ipmiUserDataFile, std::ios::in | std::ios::binary);
     if (!iUsrData.good())
     {
@@ -1206,6 +1455,9 @@ void UserAccess::readUserData()
             "Corrupted IPMI user data file - invalid user count");
     }
 
+    // parse into a new table, so that a corrupted file leaves the previous
+    // user data in place
+    UsersTbl newTbl{};
     // user index 0 is reserved, starts with 1
     for (size_t usrIndex = 1; usrIndex <= ipmiMaxUsers; ++usrIndex)
     {
@@ -1218,7 +1470,7 @@ void UserAccess::readUserData()
                 "Corrupted IPMI user data file - invalid user info");
         }
         std::string userName = userInfo[jsonUserName].get<std::string>();
-        std::strncpy(reinterpret_cast<char*>(usersTbl.user[usrIndex].userName),
+        std::strncpy(reinterpret_cast<char*>(newTbl.user[usrIndex].userName),
                      userName.c_str(), ipmiMaxUserName);
 
         std::vector<std::string> privilege =
@@ -1283,26 +1535,29 @@ void UserAccess::readUserData()
         }
         for (size_t chIndex = 0; chIndex < ipmiMaxChannels; ++chIndex)
         {
-            usersTbl.user[usrIndex].userPrivAccess[chIndex].privilege =
+            newTbl.user[usrIndex].userPrivAccess[chIndex].privilege =
                 static_cast<uint8_t>(
                     convertToIPMIPrivilege(privilege[chIndex]));
-            usersTbl.user[usrIndex].userPrivAccess[chIndex].ipmiEnabled =
+            newTbl.user[usrIndex].userPrivAccess[chIndex].ipmiEnabled =
                 ipmiEnabled[chIndex];
-            usersTbl.user[usrIndex].userPrivAccess[chIndex].linkAuthEnabled =
+            newTbl.user[usrIndex].userPrivAccess[chIndex].linkAuthEnabled =
                 linkAuthEnabled[chIndex];
-            usersTbl.user[usrIndex].userPrivAccess[chIndex].accessCallback =
+            newTbl.user[usrIndex].userPrivAccess[chIndex].accessCallback =
                 accessCallback[chIndex];
         }
         updatePayloadAccessInUserInfo(stdPayload, oemPayload,
-                                      usersTbl.user[usrIndex]);
-        usersTbl.user[usrIndex].userEnabled =
+                                      newTbl.user[usrIndex]);
+        newTbl.user[usrIndex].userEnabled =
             userInfo[jsonUserEnabled].get<bool>();
-        usersTbl.user[usrIndex].userInSystem =
+        newTbl.user[usrIndex].userInSystem =
             userInfo[jsonUserInSys].get<bool>();
-        usersTbl.user[usrIndex].fixedUserName =
+        newTbl.user[usrIndex].fixedUserName =
             userInfo[jsonFixedUser].get<bool>();
     }
 
+    usersTbl = newTbl;
+    userDataLoaded = true;
+
     log<level::DEBUG>("User data read from IPMI data file");
     iUsrData.close();
     // Update the timestamp
@@ -1314,7 +1569,37 @@ void UserAccess::writeUserData()
 {
     boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
         userLock{*userMutex};
+    if (userConfigBatch)
+    {
+        userDataDirty = true;
+        return;
+    }
 
+    if (!userStore->isOpen())
+    {
+        // a new store, also export the data. The JSON file is the import
+        // format and its presence is used for the signal handler lock.
+        createUserStore();
+        exportUserData();
+        return;
+    }
+
+    // user index 0 is reserved, starts with 1
+    for (size_t usrIndex = 1; usrIndex <= ipmiMaxUsers; ++usrIndex)
+    {
+        UserRecord record;
+        toUserRecord(usersTbl.user[usrIndex], record);
+        if (userStore->writeRecord(usrIndex - 1, &record) != 0)
+        {
+            throw std::ios_base::failure("Error in writing IPMI user data");
+        }
+    }
+    userStoreGeneration = userStore->generation();
+    return;
+}
+
+void UserAccess::exportUserData()
+{
     Json jsonUsersTbl = Json::array();
     // user index 0 is reserved, starts with 1
     for (size_t usrIndex = 1; usrIndex <= ipmiMaxUsers; ++usrIndex)
@@ -1465,15 +1750,93 @@ void UserAccess::deleteUserIndex(const size_t& usrIdx)
     return;
 }
 
+void UserAccess::watchUserDataFile()
+{
+    userDataWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (userDataWatchFd < 0)
+    {
+        log<level::ERR>("Failed to create IPMI user data inotify instance",
+                        entry("ERRNO=%d", errno));
+        return;
+    }
+    // the file is replaced by renaming a temporary file over it, so watch
+    // the directory rather than the file itself
+    std::string dir = std::filesystem::path(ipmiUserDataFile).parent_path();
+    if (inotify_add_watch(userDataWatchFd, dir.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0)
+    {
+        log<level::ERR>("Failed to watch IPMI user data file",
+                        entry("DIR=%s", dir.c_str()), entry("ERRNO=%d", errno));
+        close(userDataWatchFd);
+        userDataWatchFd = -1;
+    }
+}
+
+bool UserAccess::userDataFileChanged()
+{
+    if (userDataWatchFd < 0)
+    {
+        // changes can't be detected, so always reload
+        return true;
+    }
+    std::string fileName = std::filesystem::path(ipmiUserDataFile).filename();
+    bool changed = false;
+    alignas(inotify_event) std::array<char, 4096> events;
+    ssize_t size;
+    while ((size = read(userDataWatchFd, events.data(), events.size())) > 0)
+    {
+        for (ssize_t pos = 0; pos < size;)
+        {
+            auto event =
+                reinterpret_cast<const inotify_event*>(events.data() + pos);
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len && fileName == event->name))
+            {
+                changed = true;
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
 void UserAccess::checkAndReloadUserData()
 {
-    //std::time_t updateTime = getUpdatedFileTime();
-    //if (updateTime != fileLastUpdatedTime || updateTime == -EIO)
-    //{
-        std::fill(reinterpret_cast<uint8_t*>(&usersTbl),
-                  reinterpret_cast<uint8_t*>(&usersTbl) + sizeof(usersTbl), 0);
+    boost::interprocess::scoped_lock<boost::interprocess::named_recursive_mutex>
+        userLock{*userMutex};
+    if (userConfigBatch)
+    {
+        // keep the uncommitted changes, only this process writes the store
+        return;
+    }
+    bool changed;
+    if (userStore->isOpen())
+    {
+        // writers bump the store generation while holding the user mutex
+        if (userStore->replaced())
+        {
+            userStore->close();
+            changed = true;
+        }
+        else
+        {
+            changed = userStore->generation() != userStoreGeneration;
+        }
+    }
+    else
+    {
+        // Writers rename the new file in place while holding the user mutex,
+        // and the inotify event is queued by the rename itself, so any update
+        // made by another process is visible here. This includes our own
+        // writes, which costs one extra read per update.
+        changed = userDataFileChanged();
+    }
+    if (changed || !userDataLoaded)
+    {
+        // retried on next use if the file can't be read
+        userDataLoaded = false;
         readUserData();
-    //}
+    }
     return;
 }
 
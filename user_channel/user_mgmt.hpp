@@ -20,7 +20,9 @@
 #include <boost/interprocess/sync/named_recursive_mutex.hpp>
 #include <cstdint>
 #include <ctime>
+#include <memory>
 #include <ipmid/api.hpp>
+#include <map>
 #include <sdbusplus/bus.hpp>
 #include <variant>
 
@@ -98,6 +100,7 @@ bool pamUserCheckAuthenticate(std::string_view username,
                               std::string_view password);
 
 class UserAccess;
+class RecordStore;
 
 UserAccess& getUserAccessObject();
 
@@ -257,6 +260,24 @@ class UserAccess
                               const UserPrivAccess& privAccess,
                               const bool& otherPrivUpdates);
 
+    /** @brief starts a batch of user configuration changes
+     *
+     *  @details Until the batch is committed, the user data store is not
+     *  written and the user property updates to the user manager are
+     *  queued, keeping only the last value of each property. User create,
+     *  delete and rename requests are still sent right away.
+     */
+    void beginUserConfig();
+
+    /** @brief commits a batch of user configuration changes
+     *
+     *  @details Sends the queued user property updates and writes the user
+     *  data store once. Does nothing if no batch was started.
+     *
+     *  @return ccSuccess for success, others for failure.
+     */
+    Cc commitUserConfig();
+
     /** @brief to get user payload access details from userInfo entry.
      *
      *  @param[in] userInfo    - userInfo entry in usersTbl.
@@ -306,18 +327,31 @@ class UserAccess
                             const uint8_t userId,
                             const PayloadAccess& payloadAccess);
 
-    /** @brief reads user management related data from configuration file
+    /** @brief reads user management related data from the binary user data
+     * store, importing the configuration file if there is no store yet
      *
      */
     void readUserData();
 
-    /** @brief writes user management related data to configuration file
+    /** @brief writes user management related data to the binary user data
+     * store, only the users that changed are written
      *
      */
     void writeUserData();
 
+    /** @brief reads user management related data from configuration file
+     *
+     */
+    void importUserData();
+
+    /** @brief writes user management related data to configuration file
+     *
+     */
+    void exportUserData();
+
     /** @brief Funtion which checks and reload configuration file data if
-     * needed.
+     * needed. The data is reloaded only when the configuration file was
+     * updated since it was last read.
      *
      */
     void checkAndReloadUserData();
@@ -380,6 +414,15 @@ class UserAccess
     std::vector<std::string> availableGroups;
     sdbusplus::bus::bus bus;
     std::time_t fileLastUpdatedTime;
+    std::unique_ptr<RecordStore> userStore;
+    uint32_t userStoreGeneration = 0;
+    bool userDataLoaded = false;
+    int userDataWatchFd = -1;
+    bool userConfigBatch = false;
+    bool userDataDirty = false;
+    // user property updates queued during a batch, by (object path, property)
+    std::map<std::pair<std::string, std::string>, DbusUserPropVariant>
+        pendingUserProps;
     bool signalHndlrObject = false;
     boost::interprocess::file_lock sigHndlrLock;
     boost::interprocess::file_lock mutexCleanupLock;
@@ -390,6 +433,42 @@ class UserAccess
      */
     std::time_t getUpdatedFileTime();
 
+    /** @brief function to create the binary user data store from the users
+     * table
+     *
+     *  @return true for success
+     */
+    bool createUserStore();
+
+    /** @brief function to update a user property in the user manager, or to
+     *  queue the update during a batch
+     *
+     *  @param[in] userPath - user object path
+     *  @param[in] property - property name
+     *  @param[in] value - property value
+     */
+    void setUserProperty(const std::string& userPath,
+                         const std::string& property,
+                         const DbusUserPropVariant& value);
+
+    /** @brief function to send the queued user property updates
+     *
+     *  @return true for success
+     */
+    bool flushUserProperties();
+
+    /** @brief function to watch the user configuration file for updates
+     *
+     */
+    void watchUserDataFile();
+
+    /** @brief function to check if the user configuration file was updated
+     *  since the last check
+     *
+     *  @return true if it was updated or if updates can't be detected
+     */
+    bool userDataFileChanged();
+
     /** @brief function to available system privileges and groups
      *
      */
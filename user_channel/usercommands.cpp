@@ -22,7 +22,12 @@
 
 #include <security/pam_appl.h>
 
+#include <array>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
 #include <ipmid/api.hpp>
+#include <ipmid/oemopenbmc.hpp>
+#include <memory>
 #include <phosphor-logging/log.hpp>
 #include <regex>
 
@@ -40,71 +45,6 @@ static constexpr uint8_t passwordKeySize16 = 0;
 static constexpr uint8_t enableOperation = 0x00;
 static constexpr uint8_t disableOperation = 0x01;
 
-/** @struct SetUserNameReq
- *
- *  Structure for set user name request command (refer spec sec 22.28)
- */
-struct SetUserNameReq
-{
-#if BYTE_ORDER == LITTLE_ENDIAN
-    uint8_t userId : 6;
-    uint8_t reserved1 : 2;
-#endif
-#if BYTE_ORDER == BIG_ENDIAN
-    uint8_t reserved1 : 2;
-    uint8_t userId : 6;
-#endif
-    uint8_t userName[16];
-} __attribute__((packed));
-
-/** @struct GetUserNameReq
- *
- *  Structure for get user name request command (refer spec sec 22.29)
- */
-struct GetUserNameReq
-{
-#if BYTE_ORDER == LITTLE_ENDIAN
-    uint8_t userId : 6;
-    uint8_t reserved1 : 2;
-#endif
-#if BYTE_ORDER == BIG_ENDIAN
-    uint8_t reserved1 : 2;
-    uint8_t userId : 6;
-#endif
-} __attribute__((packed));
-
-/** @struct GetUserNameResp
- *
- *  Structure for get user name response command (refer spec sec 22.29)
- */
-struct GetUserNameResp
-{
-    uint8_t userName[16];
-} __attribute__((packed));
-
-/** @struct SetUserPasswordReq
- *
- *  Structure for set user password request command (refer spec sec 22.30)
- */
-struct SetUserPasswordReq
-{
-#if BYTE_ORDER == LITTLE_ENDIAN
-    uint8_t userId : 6;
-    uint8_t reserved1 : 1;
-    uint8_t ipmi20 : 1;
-    uint8_t operation : 2;
-    uint8_t reserved2 : 6;
-#endif
-#if BYTE_ORDER == BIG_ENDIAN
-    uint8_t ipmi20 : 1;
-    uint8_t reserved1 : 1;
-    uint8_t userId : 6;
-    uint8_t reserved2 : 6;
-    uint8_t operation : 2;
-#endif
-    uint8_t userPassword[maxIpmi20PasswordSize];
-} __attribute__((packed));
-
 /** @brief implements the set user access command
  *  @param ctx - IPMI context pointer (for channel)
  *  @param channel - channel number
@@ -169,7 +109,27 @@ ipmi::RspType<> ipmiSetUserAccess(ipmi::Context::ptr ctx, uint4_t channel,
                                    privAccess, static_cast<bool>(bitsUpdate)));
 }
 
-/** @brief implements the set user access command
+/** @brief counts the users of a channel the way Get User Access reports them
+ *
+ *  @param[in] users - the users of the channel
+ *  @param[out] maxChUsers - max channel users
+ *  @param[out] enabledUsers - enabled user count
+ *  @param[out] fixedUsers - fixed user count
+ */
+static void countChannelUsers(const ChannelUsers& users, uint8_t& maxChUsers,
+                              uint8_t& enabledUsers, uint8_t& fixedUsers)
+{
+    maxChUsers = ipmiMaxUsers;
+    enabledUsers = 0;
+    fixedUsers = 0;
+    for (const UserChannelAccess& user : users)
+    {
+        enabledUsers += user.enabled ? 1 : 0;
+        fixedUsers += user.fixedUserName ? 1 : 0;
+    }
+}
+
+/** @brief implements the get user access command
  *  @param ctx - IPMI context pointer (for channel)
  *  @param channel - channel number
  *  @param reserved1 - skip 4 bits
@@ -229,31 +189,20 @@ ipmi::RspType<uint6_t, // max channel users
         return ipmi::responseParmOutOfRange();
     }
 
-    uint8_t maxChUsers = 0, enabledUsers = 0, fixedUsers = 0;
-    ipmi::Cc retStatus;
-    retStatus = ipmiUserGetAllCounts(maxChUsers, enabledUsers, fixedUsers);
-    if (retStatus != ccSuccess)
-    {
-        return ipmi::response(retStatus);
-    }
-
-    bool enabledState = false;
-    retStatus =
-        ipmiUserCheckEnabled(static_cast<uint8_t>(userId), enabledState);
+    // the counts and the user come from one read of the user table
+    ChannelUsers users;
+    ipmi::Cc retStatus = ipmiUserGetChannelUsers(chNum, users);
     if (retStatus != ccSuccess)
     {
         return ipmi::response(retStatus);
     }
+    uint8_t maxChUsers = 0, enabledUsers = 0, fixedUsers = 0;
+    countChannelUsers(users, maxChUsers, enabledUsers, fixedUsers);
 
-    uint2_t enabledStatus = enabledState ? userIdEnabledViaSetPassword
+    const UserChannelAccess& user = users[static_cast<uint8_t>(userId) - 1];
+    uint2_t enabledStatus = user.enabled ? userIdEnabledViaSetPassword
                                          : userIdDisabledViaSetPassword;
-    PrivAccess privAccess{};
-    retStatus = ipmiUserGetPrivilegeAccess(static_cast<uint8_t>(userId), chNum,
-                                           privAccess);
-    if (retStatus != ccSuccess)
-    {
-        return ipmi::response(retStatus);
-    }
+    const PrivAccess& privAccess = user.privAccess;
     constexpr uint2_t res2Bits = 0;
     return ipmi::responseSuccess(
         static_cast<uint6_t>(maxChUsers), res2Bits,
@@ -269,164 +218,156 @@ ipmi::RspType<uint6_t, // max channel users
         static_cast<uint1_t>(privAccess.reserved));
 }
 
-Cc ipmiSetUserName(ipmi_netfn_t netfn, ipmi_cmd_t cmd, ipmi_request_t request,
-                   ipmi_response_t response, ipmi_data_len_t dataLen,
-                   ipmi_context_t context)
+/** @brief implements the set user name command
+ *  @param userId - user id
+ *  @param reserved - skip 2 bits
+ *  @param name - user name, NUL padded
+ *
+ *  @returns ipmi completion code
+ */
+ipmi::RspType<>
+    ipmiSetUserName(uint6_t userId, uint2_t reserved,
+                    const std::array<uint8_t, ipmiMaxUserName>& name)
 {
-    const SetUserNameReq* req = static_cast<SetUserNameReq*>(request);
-    size_t reqLength = *dataLen;
-    *dataLen = 0;
-
-    if (reqLength != sizeof(*req))
-    {
-        log<level::DEBUG>("Set user name - Invalid Length");
-        return ccReqDataLenInvalid;
-    }
-    if (req->reserved1)
+    if (reserved)
     {
-        return ccInvalidFieldRequest;
+        return ipmi::responseInvalidFieldRequest();
     }
-    if (!ipmiUserIsValidUserId(req->userId))
+    if (!ipmiUserIsValidUserId(static_cast<uint8_t>(userId)))
     {
         log<level::DEBUG>("Set user name - Invalid user id");
-        return ccParmOutOfRange;
+        return ipmi::responseParmOutOfRange();
     }
 
-    size_t nameLen = strnlen(reinterpret_cast<const char*>(req->userName),
-                             sizeof(req->userName));
-    const std::string strUserName(reinterpret_cast<const char*>(req->userName),
+    size_t nameLen = strnlen(reinterpret_cast<const char*>(name.data()),
+                             name.size());
+    const std::string strUserName(reinterpret_cast<const char*>(name.data()),
                                   nameLen);
 
-    return ipmiUserSetUserName(req->userId, strUserName);
+    return ipmi::response(
+        ipmiUserSetUserName(static_cast<uint8_t>(userId), strUserName));
 }
 
-/** @brief implementes the get user name command
- *  @param[in] netfn - specifies netfn.
- *  @param[in] cmd   - specifies cmd number.
- *  @param[in] request - pointer to request data.
- *  @param[in, out] dataLen - specifies request data length, and returns
- * response data length.
- *  @param[in] context - ipmi context.
- *  @returns ipmi completion code.
+/** @brief implements the get user name command
+ *  @param userId - user id
+ *  @param reserved - skip 2 bits
+ *
+ *  @returns ipmi completion code plus response data
+ *   - user name, NUL padded
  */
-Cc ipmiGetUserName(ipmi_netfn_t netfn, ipmi_cmd_t cmd, ipmi_request_t request,
-                   ipmi_response_t response, ipmi_data_len_t dataLen,
-                   ipmi_context_t context)
+ipmi::RspType<std::array<uint8_t, ipmiMaxUserName>> // user name
+    ipmiGetUserName(uint6_t userId, uint2_t reserved)
 {
-    const GetUserNameReq* req = static_cast<GetUserNameReq*>(request);
-    size_t reqLength = *dataLen;
-
-    *dataLen = 0;
-
-    if (reqLength != sizeof(*req))
+    if (reserved)
     {
-        log<level::DEBUG>("Get user name - Invalid Length");
-        return ccReqDataLenInvalid;
+        return ipmi::responseInvalidFieldRequest();
     }
 
     std::string userName;
-    if (ipmiUserGetUserName(req->userId, userName) != ccSuccess)
+    if (ipmiUserGetUserName(static_cast<uint8_t>(userId), userName) !=
+        ccSuccess)
     { // Invalid User ID
         log<level::DEBUG>("User Name not found",
-                          entry("USER-ID=%d", (uint8_t)req->userId));
-        return ccParmOutOfRange;
+                          entry("USER-ID=%d", static_cast<uint8_t>(userId)));
+        return ipmi::responseParmOutOfRange();
     }
-    GetUserNameResp* resp = static_cast<GetUserNameResp*>(response);
-    std::fill(reinterpret_cast<uint8_t*>(resp),
-              reinterpret_cast<uint8_t*>(resp) + sizeof(*resp), 0);
-    userName.copy(reinterpret_cast<char*>(resp->userName),
-                  sizeof(resp->userName), 0);
-    *dataLen = sizeof(*resp);
+    std::array<uint8_t, ipmiMaxUserName> name{};
+    userName.copy(reinterpret_cast<char*>(name.data()), name.size(), 0);
 
-    return ccSuccess;
+    return ipmi::responseSuccess(name);
 }
 
-/** @brief implementes the set user password command
- *  @param[in] netfn - specifies netfn.
- *  @param[in] cmd   - specifies cmd number.
- *  @param[in] request - pointer to request data.
- *  @param[in, out] dataLen - specifies request data length, and returns
- * response data length.
- *  @param[in] context - ipmi context.
- *  @returns ipmi completion code.
+/** @brief implements the set user password command
+ *  @param userId - user id
+ *  @param reserved1 - skip 1 bit
+ *  @param ipmi20 - true for a 20 byte password, false for 16 bytes
+ *  @param operation - disable, enable, set or test password
+ *  @param reserved2 - skip 6 bits
+ *  @param userPassword - password, NUL padded, for set and test password
+ *
+ *  @returns ipmi completion code
  */
-Cc ipmiSetUserPassword(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                       ipmi_request_t request, ipmi_response_t response,
-                       ipmi_data_len_t dataLen, ipmi_context_t context)
+ipmi::RspType<> ipmiSetUserPassword(uint6_t userId, uint1_t reserved1,
+                                    uint1_t ipmi20, uint2_t operation,
+                                    uint6_t reserved2,
+                                    std::vector<uint8_t>& userPassword)
 {
-    const SetUserPasswordReq* req = static_cast<SetUserPasswordReq*>(request);
-    size_t reqLength = *dataLen;
-    // subtract 2 bytes header to know the password length - including NULL
-    uint8_t passwordLength = *dataLen - 2;
-    *dataLen = 0;
+    uint8_t id = static_cast<uint8_t>(userId);
+    uint8_t op = static_cast<uint8_t>(operation);
+    uint8_t keySize = static_cast<uint8_t>(ipmi20);
+    size_t passwordLength = userPassword.size();
+    // the password is no longer needed after the handler, whatever it answers
+    auto clear = [&userPassword]() {
+        OPENSSL_cleanse(userPassword.data(), userPassword.size());
+    };
 
     // verify input length based on operation. Required password size is 20
     // bytes as  we support only IPMI 2.0, but in order to be compatible with
     // tools, accept 16 bytes of password size too.
-    if (reqLength < 2 ||
-        // If enable / disable user, reqLength has to be >=2 & <= 22
-        ((req->operation == disableUser || req->operation == enableUser) &&
-         ((reqLength < 2) || (reqLength > sizeof(SetUserPasswordReq)))))
+    if ((op == disableUser || op == enableUser) &&
+        passwordLength > maxIpmi20PasswordSize)
     {
         log<level::DEBUG>("Invalid Length");
-        return ccReqDataLenInvalid;
+        clear();
+        return ipmi::responseReqDataLenInvalid();
     }
     // If set / test password then password length has to be 16 or 20 bytes
     // based on the password size bit.
-    if (((req->operation == setPassword) || (req->operation == testPassword)) &&
-        (((req->ipmi20 == passwordKeySize20) &&
+    if (((op == setPassword) || (op == testPassword)) &&
+        (((keySize == passwordKeySize20) &&
           (passwordLength != maxIpmi20PasswordSize)) ||
-         ((req->ipmi20 == passwordKeySize16) &&
+         ((keySize == passwordKeySize16) &&
           (passwordLength != maxIpmi15PasswordSize))))
     {
         log<level::DEBUG>("Invalid Length");
-        return ccReqDataLenInvalid;
+        clear();
+        return ipmi::responseReqDataLenInvalid();
     }
 
     std::string userName;
-    if (ipmiUserGetUserName(req->userId, userName) != ccSuccess)
+    if (ipmiUserGetUserName(id, userName) != ccSuccess)
     {
-        log<level::DEBUG>("User Name not found",
-                          entry("USER-ID=%d", (uint8_t)req->userId));
-        return ccParmOutOfRange;
+        log<level::DEBUG>("User Name not found", entry("USER-ID=%d", id));
+        clear();
+        return ipmi::responseParmOutOfRange();
     }
-    if (req->operation == setPassword)
+
+    // the password ends at the first NUL of the field
+    std::string password(
+        reinterpret_cast<const char*>(userPassword.data()),
+        strnlen(reinterpret_cast<const char*>(userPassword.data()),
+                passwordLength));
+    clear();
+
+    Cc cc = ccInvalidFieldRequest;
+    if (op == setPassword)
     {
-        return ipmiUserSetUserPassword(
-            req->userId, reinterpret_cast<const char*>(req->userPassword));
+        cc = ipmiUserSetUserPassword(id, password.c_str());
     }
-    else if (req->operation == enableUser || req->operation == disableUser)
+    else if (op == enableUser || op == disableUser)
     {
-        return ipmiUserUpdateEnabledState(req->userId,
-                                          static_cast<bool>(req->operation));
+        cc = ipmiUserUpdateEnabledState(id, static_cast<bool>(op));
     }
-    else if (req->operation == testPassword)
+    else if (op == testPassword)
     {
-        auto password = ipmiUserGetPassword(userName);
-        std::string testPassword(
-            reinterpret_cast<const char*>(req->userPassword), 0,
-            passwordLength);
+        auto current = ipmiUserGetPassword(userName);
         // Note: For security reasons password size won't be compared and
         // wrong password size completion code will not be returned if size
         // doesn't match as specified in IPMI specification.
-        if (password != testPassword)
+        cc = ccSuccess;
+        if (current != password)
         {
-            log<level::DEBUG>("Test password failed",
-                              entry("USER-ID=%d", (uint8_t)req->userId));
-            // Clear sensitive data
-            OPENSSL_cleanse(&testPassword, testPassword.length());
-            OPENSSL_cleanse(&password, password.length());
-
-            return static_cast<Cc>(
+            log<level::DEBUG>("Test password failed", entry("USER-ID=%d", id));
+            cc = static_cast<Cc>(
                 IPMISetPasswordReturnCodes::ipmiCCPasswdFailMismatch);
         }
         // Clear sensitive data
-        OPENSSL_cleanse(&testPassword, testPassword.length());
-        OPENSSL_cleanse(&password, password.length());
-
-        return ccSuccess;
+        OPENSSL_cleanse(current.data(), current.length());
     }
-    return ccInvalidFieldRequest;
+    // Clear sensitive data
+    OPENSSL_cleanse(password.data(), password.length());
+
+    return ipmi::response(cc);
 }
 
 /** @brief implements the get channel authentication command
@@ -709,9 +650,146 @@ ipmi::RspType<bool, // stdPayload0ipmiReserved
                                  res8bits);
 }
 
+// a batch left open by the requester is committed after this delay
+static constexpr std::chrono::seconds userConfigTimeout(10);
+static std::unique_ptr<boost::asio::steady_timer> userConfigTimer;
+
+/** @brief implements the begin user config OEM command
+ *
+ *  Starts a batch of user configuration changes. The user data is written
+ *  and the user manager updated once, by the commit user config command or
+ *  when the batch times out. Sending the command again restarts the timeout.
+ *
+ *  @returns IPMI completion code
+ */
+ipmi::RspType<> ipmiBeginUserConfig()
+{
+    if (!userConfigTimer)
+    {
+        userConfigTimer =
+            std::make_unique<boost::asio::steady_timer>(*getIoContext());
+    }
+    ipmiUserBeginConfig();
+    userConfigTimer->expires_after(userConfigTimeout);
+    userConfigTimer->async_wait([](const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        log<level::WARNING>("User config batch timed out, committing");
+        ipmiUserCommitConfig();
+    });
+    return ipmi::responseSuccess();
+}
+
+/** @brief implements the commit user config OEM command
+ *
+ *  @returns IPMI completion code
+ */
+ipmi::RspType<> ipmiCommitUserConfig()
+{
+    if (userConfigTimer)
+    {
+        userConfigTimer->cancel();
+    }
+    return ipmi::response(ipmiUserCommitConfig());
+}
+
+/** @brief implements the get channel user access OEM command
+ *  @param ctx - IPMI context pointer (for channel)
+ *  @param channel - channel number
+ *  @param reserved - skip 4 bits
+ *  @param firstUser - first user id of the range, 1 if not given
+ *
+ *  @returns ipmi completion code plus response data
+ *   - maxChUsers - max channel users
+ *   - enabledUsers - enabled users count
+ *   - fixedUsers - fixed users count
+ *   - count - number of user entries that follow
+ *   - users - per user: user id, state, access and name
+ */
+ipmi::RspType<uint8_t, // max channel users
+              uint8_t, // enabled users count
+              uint8_t, // fixed users count
+              uint8_t, // user entries count
+              ipmi::message::Payload>
+    ipmiGetChannelUserAccess(ipmi::Context::ptr ctx, uint4_t channel,
+                             uint4_t reserved, std::optional<uint8_t> firstUser)
+{
+    // NetFn/LUN, Cmd, CC, IANA and the counts ahead of the users
+    constexpr size_t responseOverhead = 10;
+    // user id, state and access bytes, name
+    constexpr size_t userEntrySize = 3 + ipmiMaxUserName;
+    constexpr uint8_t userEnabledBit = 0x01;
+    constexpr uint8_t fixedUserNameBit = 0x02;
+
+    uint8_t chNum =
+        convertCurrentChannelNum(static_cast<uint8_t>(channel), ctx->channel);
+    uint8_t first = firstUser.value_or(1);
+    if (reserved || !isValidChannel(chNum))
+    {
+        log<level::DEBUG>(
+            "Get channel user access - Invalid field in request");
+        return ipmi::responseInvalidFieldRequest();
+    }
+    if (getChannelSessionSupport(chNum) == EChannelSessSupported::none)
+    {
+        log<level::DEBUG>("Get channel user access - No support on channel");
+        return ipmi::response(ccActionNotSupportedForChannel);
+    }
+    if (!ipmiUserIsValidUserId(first))
+    {
+        log<level::DEBUG>("Get channel user access - Parameter out of range");
+        return ipmi::responseParmOutOfRange();
+    }
+
+    ChannelUsers users;
+    ipmi::Cc retStatus = ipmiUserGetChannelUsers(chNum, users);
+    if (retStatus != ccSuccess)
+    {
+        return ipmi::response(retStatus);
+    }
+    uint8_t maxChUsers = 0, enabledUsers = 0, fixedUsers = 0;
+    countChannelUsers(users, maxChUsers, enabledUsers, fixedUsers);
+
+    size_t maxTransfer = getChannelMaxTransferSize(ctx->channel);
+    size_t maxEntries = 0;
+    if (maxTransfer > responseOverhead)
+    {
+        maxEntries = (maxTransfer - responseOverhead) / userEntrySize;
+    }
+    if (maxEntries == 0)
+    {
+        return ipmi::responseResponseError();
+    }
+
+    ipmi::message::Payload entries;
+    uint8_t count = 0;
+    for (size_t userId = first; userId <= ipmiMaxUsers && count < maxEntries;
+         userId++, count++)
+    {
+        const UserChannelAccess& user = users[userId - 1];
+        uint8_t state = (user.enabled ? userEnabledBit : 0) |
+                        (user.fixedUserName ? fixedUserNameBit : 0);
+        const PrivAccess& privAccess = user.privAccess;
+        entries.pack(static_cast<uint8_t>(userId), state,
+                     static_cast<uint4_t>(privAccess.privilege),
+                     static_cast<uint1_t>(privAccess.ipmiEnabled),
+                     static_cast<uint1_t>(privAccess.linkAuthEnabled),
+                     static_cast<uint1_t>(privAccess.accessCallback),
+                     static_cast<uint1_t>(0), user.userName);
+    }
+
+    return ipmi::responseSuccess(maxChUsers, enabledUsers, fixedUsers, count,
+                                 entries);
+}
+
 void registerUserIpmiFunctions() __attribute__((constructor));
 void registerUserIpmiFunctions()
 {
+    // read the user table and the password file once the daemon serves
+    // requests, not while the providers load; a user command coming first
+    // reads them itself
     post_work([]() { ipmiUserInit(); });
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
                           ipmi::app::cmdSetUserAccessCommand,
@@ -721,14 +799,17 @@ void registerUserIpmiFunctions()
                           ipmi::app::cmdGetUserAccessCommand,
                           ipmi::Privilege::Operator, ipmiGetUserAccess);
 
-    ipmi_register_callback(NETFUN_APP, IPMI_CMD_GET_USER_NAME, NULL,
-                           ipmiGetUserName, PRIVILEGE_OPERATOR);
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
+                          ipmi::app::cmdGetUserNameCommand,
+                          ipmi::Privilege::Operator, ipmiGetUserName);
 
-    ipmi_register_callback(NETFUN_APP, IPMI_CMD_SET_USER_NAME, NULL,
-                           ipmiSetUserName, PRIVILEGE_ADMIN);
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
+                          ipmi::app::cmdSetUserName, ipmi::Privilege::Admin,
+                          ipmiSetUserName);
 
-    ipmi_register_callback(NETFUN_APP, IPMI_CMD_SET_USER_PASSWORD, NULL,
-                           ipmiSetUserPassword, PRIVILEGE_ADMIN);
+    ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
+                          ipmi::app::cmdSetUserPasswordCommand,
+                          ipmi::Privilege::Admin, ipmiSetUserPassword);
 
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnApp,
                           ipmi::app::cmdGetChannelAuthCapabilities,
@@ -743,6 +824,19 @@ void registerUserIpmiFunctions()
                           ipmi::app::cmdGetUserPayloadAccess,
                           ipmi::Privilege::Operator, ipmiGetUserPayloadAccess);
 
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::beginUserConfigCmd, ipmi::Privilege::Admin,
+                             ipmiBeginUserConfig);
+
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::commitUserConfigCmd, ipmi::Privilege::Admin,
+                             ipmiCommitUserConfig);
+
+    ipmi::registerOemHandler(ipmi::prioOpenBmcBase, oem::obmcOemNumber,
+                             oem::getChannelUserAccessCmd,
+                             ipmi::Privilege::Operator,
+                             ipmiGetChannelUserAccess);
+
     return;
 }
 } // namespace ipmi
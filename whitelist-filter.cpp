@@ -1,5 +1,5 @@
-#include <algorithm>
 #include <array>
+#include <chrono>
 #include <ipmid/api.hpp>
 #include <ipmid/utils.hpp>
 #include <ipmiwhitelist.hpp>
@@ -40,12 +40,16 @@ class WhitelistFilter
     ipmi::Cc filterMessage(ipmi::message::Request::ptr request);
 
     bool restrictedMode = true;
+    // rejected commands, logged at most once per rejectLogInterval
+    size_t rejectedCount = 0;
+    std::chrono::steady_clock::time_point lastRejectLog;
     std::shared_ptr<sdbusplus::asio::connection> bus;
     std::unique_ptr<settings::Objects> objects;
     std::unique_ptr<sdbusplus::bus::match::match> modeChangeMatch;
 
     static constexpr const char restrictionModeIntf[] =
         "xyz.openbmc_project.Control.Security.RestrictionMode";
+    static constexpr std::chrono::seconds rejectLogInterval{10};
 };
 
 WhitelistFilter::WhitelistFilter()
@@ -54,7 +58,9 @@ WhitelistFilter::WhitelistFilter()
 
     log<level::INFO>("Loading whitelist filter");
 
+    // only the system interface is filtered
     ipmi::registerFilter(ipmi::prioOpenBmcBase,
+                         {{std::nullopt, std::nullopt, channelSystemIface}},
                          [this](ipmi::message::Request::ptr request) {
                              return filterMessage(request);
                          });
@@ -159,13 +165,18 @@ ipmi::Cc WhitelistFilter::filterMessage(ipmi::message::Request::ptr request)
 {
     if (request->ctx->channel == ipmi::channelSystemIface && restrictedMode)
     {
-        if (!std::binary_search(
-                whitelist.cbegin(), whitelist.cend(),
-                std::make_pair(request->ctx->netFn, request->ctx->cmd)))
+        if (!isWhitelisted(whitelist, request->ctx->netFn, request->ctx->cmd))
         {
-            log<level::ERR>("Net function not whitelisted",
-                            entry("NETFN=0x%X", int(request->ctx->netFn)),
-                            entry("CMD=0x%X", int(request->ctx->cmd)));
+            rejectedCount++;
+            auto now = std::chrono::steady_clock::now();
+            if (rejectedCount == 1 || now - lastRejectLog >= rejectLogInterval)
+            {
+                log<level::ERR>("Net function not whitelisted",
+                                entry("NETFN=0x%X", int(request->ctx->netFn)),
+                                entry("CMD=0x%X", int(request->ctx->cmd)),
+                                entry("REJECTED=%zu", rejectedCount));
+                lastRejectLog = now;
+            }
             return ipmi::ccInsufficientPrivilege;
         }
     }